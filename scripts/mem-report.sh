@@ -0,0 +1,186 @@
+#!/bin/bash
+# =============================================================================
+# Static Memory Report for Vitals Monitor
+# =============================================================================
+#
+# CDSCO Class B Medical Device — Vitals Monitor
+# Target: STM32MP157F-DK2 (Cortex-A7 + Cortex-M4)
+#
+# PURPOSE:
+#   Lists how much code and static memory each module contributes, from
+#   the linker map the simulator build writes (simulator.map).  RAM is
+#   .data + .bss: the static buffers budgeted in src/core/mem_budget.h,
+#   the LVGL pool, SQLite's globals.  Flash is .text + .rodata + .data.
+#   Sorted by RAM, largest first, so the biggest offenders lead.
+#
+#   The runtime side (RSS by region, SQLite heap, LVGL pool usage) is
+#   printed by the simulator itself with its perf report (mem_report.h).
+#
+# USAGE:
+#   ./scripts/mem-report.sh [map-file] [rows]
+#
+#   map-file   Linker map (default simulator/build/simulator.map)
+#   rows       Modules to list (default 25; 0 for all)
+#
+#   Environment:
+#     SYMBOLS=BINARY   Also list the largest static symbols of BINARY (nm)
+#
+# SUPPORTED FORMATS:
+#   - GNU ld / gold / lld maps (Linux, Buildroot cross toolchain)
+#   - Apple ld64 maps (macOS simulator build)
+#
+# =============================================================================
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(cd "$SCRIPT_DIR/.." && pwd)"
+
+MAP_FILE="${1:-$PROJECT_ROOT/simulator/build/simulator.map}"
+ROWS="${2:-25}"
+
+# ---------------------------------------------------------------------------
+# Color output helpers
+# ---------------------------------------------------------------------------
+RED='\033[0;31m'
+CYAN='\033[0;36m'
+NC='\033[0m'
+
+error() { echo -e "${RED}[ERROR]${NC} $*" >&2; }
+step()  { echo -e "${CYAN}[STEP]${NC}  $*"; }
+die()   { error "$*"; exit 1; }
+
+[ -f "$MAP_FILE" ] || die "Linker map not found: $MAP_FILE (build the simulator first)"
+
+# ---------------------------------------------------------------------------
+# Map parsing: emit "module class bytes" for every input section
+# ---------------------------------------------------------------------------
+
+# Module name of an object path: LVGL and SQLite as a whole, libraries by
+# archive, application objects by source file.
+MODULE_AWK='
+function hex(s,    i, n) {                          # hex() is gawk-only
+    n = 0; s = tolower(s); sub(/^0x/, "", s)
+    for (i = 1; i <= length(s); i++) n = n * 16 + index("0123456789abcdef", substr(s, i, 1)) - 1
+    return n
+}
+function module(path,    m) {
+    if (path ~ /\/lvgl\//)   return "lvgl"
+    if (path ~ /sqlite3/)    return "sqlite3"
+    if (path ~ /\(/) {                          # libfoo.a(member.o)
+        m = path; sub(/\(.*/, "", m); sub(/.*\//, "", m); return m
+    }
+    m = path; sub(/.*\//, "", m); sub(/\.o(bj)?$/, "", m); sub(/\.c$/, "", m)
+    return m
+}
+function class(sect) {
+    if (sect ~ /^\.text/ || sect == "__text" || sect == "__stubs") return "text"
+    if (sect ~ /^\.rodata/ || sect == "__cstring" || sect == "__const" ||
+        sect == "__literal8" || sect == "__literal16")             return "rodata"
+    if (sect ~ /^\.data/ || sect == "__data")                       return "data"
+    if (sect ~ /^\.bss/ || sect ~ /^\.tbss/ || sect == "COMMON" ||
+        sect == "__bss" || sect == "__common")                      return "bss"
+    return ""
+}
+'
+
+parse_gnu() {
+    awk "$MODULE_AWK"'
+        /^Linker script and memory map/ { in_map = 1; next }
+        !in_map { next }
+        # Input section on one line: " .bss  0xADDR  0xSIZE  file"
+        /^ [.A-Z]/ && NF >= 4 && $2 ~ /^0x/ && $3 ~ /^0x/ {
+            c = class($1)
+            if (c != "") print module($4), c, hex($3)
+            pending = ""
+            next
+        }
+        # Long section names wrap: " .text.name" then "  0xADDR 0xSIZE file"
+        /^ [.A-Z]/ && NF == 1 { pending = $1; next }
+        pending != "" && NF >= 3 && $1 ~ /^0x/ && $2 ~ /^0x/ {
+            c = class(pending)
+            if (c != "") print module($3), c, hex($2)
+            pending = ""
+            next
+        }
+        { pending = "" }
+    ' "$MAP_FILE"
+}
+
+parse_ld64() {
+    awk "$MODULE_AWK"'
+        /^# Object files:/ { part = "obj"; next }
+        /^# Sections:/     { part = "sect"; next }
+        /^# Symbols:/      { part = "sym"; next }
+        /^#/               { next }
+        part == "obj" && /^\[/ {
+            idx = $0; sub(/\].*/, "", idx); sub(/\[ */, "", idx)
+            path = $0; sub(/^\[[^]]*\] */, "", path)
+            obj[idx + 0] = path
+        }
+        part == "sect" && NF >= 4 {
+            n_sect++
+            s_start[n_sect] = hex($1)
+            s_end[n_sect] = s_start[n_sect] + hex($2)
+            s_name[n_sect] = $4
+        }
+        part == "sym" && $1 ~ /^0x/ {
+            addr = hex($1)
+            idx = $0; sub(/^[^[]*\[ */, "", idx); sub(/\].*/, "", idx)
+            for (i = 1; i <= n_sect; i++) {
+                if (addr >= s_start[i] && addr < s_end[i]) {
+                    c = class(s_name[i])
+                    if (c != "" && ((idx + 0) in obj)) {
+                        print module(obj[idx + 0]), c, hex($2)
+                    }
+                    break
+                }
+            }
+        }
+    ' "$MAP_FILE"
+}
+
+# ---------------------------------------------------------------------------
+# Report
+# ---------------------------------------------------------------------------
+
+step "Static memory by module: $MAP_FILE"
+echo ""
+
+if head -1 "$MAP_FILE" | grep -q '^# Path:'; then
+    SECTIONS="$(parse_ld64)"
+else
+    SECTIONS="$(parse_gnu)"
+fi
+[ -n "$SECTIONS" ] || die "No input sections found in $MAP_FILE"
+
+printf "%-22s %10s %10s %10s %10s %10s\n" "Module" "RAM" "text" "rodata" "data" "bss"
+
+echo "$SECTIONS" | awk '
+    { size[$1, $2] += $3; mods[$1] = 1 }
+    END {
+        for (m in mods) {
+            printf "%d %s %d %d %d %d\n", size[m, "data"] + size[m, "bss"], m,
+                   size[m, "text"], size[m, "rodata"], size[m, "data"], size[m, "bss"]
+        }
+    }' | sort -k1,1nr -k2,2 | awk -v rows="$ROWS" '
+    rows == 0 || NR <= rows {
+        printf "%-22s %10d %10d %10d %10d %10d\n", $2, $1, $3, $4, $5, $6
+    }'
+
+read -r text rodata data bss < <(echo "$SECTIONS" | awk '
+    { total[$2] += $3 }
+    END { print total["text"] + 0, total["rodata"] + 0, total["data"] + 0, total["bss"] + 0 }')
+printf "%-22s %10d %10d %10d %10d %10d\n" "(all modules)" \
+       $((data + bss)) "$text" "$rodata" "$data" "$bss"
+echo ""
+echo "RAM = data + bss (bytes, resident once touched); flash = text + rodata + data"
+echo "= $((text + rodata + data)) bytes.  Budgets: src/core/mem_budget.h."
+
+# Largest static symbols, when a binary is given
+if [ -n "${SYMBOLS:-}" ]; then
+    echo ""
+    step "Largest static symbols: $SYMBOLS"
+    nm -S --size-sort -t d "$SYMBOLS" 2>/dev/null |
+        awk '$3 ~ /^[bBdD]$/ { printf "%10d  %s\n", $2, $4 }' |
+        sort -nr | awk 'NR <= 20'
+fi
@@ -0,0 +1,273 @@
+#!/bin/bash
+# =============================================================================
+# Profile-Guided Optimisation Build and Benchmark for Vitals Monitor
+# =============================================================================
+#
+# CDSCO Class B Medical Device — Vitals Monitor
+# Target: STM32MP157F-DK2 (Cortex-A7 + Cortex-M4)
+#
+# PURPOSE:
+#   Builds the simulator three ways and shows what PGO + LTO is worth:
+#     1. Baseline:      plain -O2 (what ships today)
+#     2. Instrumented:  -fprofile-generate, run on a representative workload
+#     3. Optimised:     -fprofile-use with the collected profiles, plus LTO
+#   then runs the same benchmark on the baseline and optimised binaries
+#   and prints the difference.
+#
+#   Every run is headless (SDL dummy driver, no vsync) on the virtual
+#   clock (--sim), so the workload is deterministic and runs as fast as
+#   the CPU allows: elapsed time is CPU work, not waiting.
+#
+# WORKLOAD (training and benchmark):
+#   - data:  TRAIN_HOURS / BENCH_HOURS of simulated monitoring — vitals
+#            at 1 Hz, alarm evaluation, trend storage and aggregation,
+#            purge, recovery snapshots, waveform synthesis and rendering.
+#   - ui:    a touch script (simulator/input_scripts/ui_latency.txt) —
+#            navigation, trend range switches and panning, alarm
+#            acknowledge / silence — on the same virtual clock.
+#
+# USAGE:
+#   ./scripts/pgo-build.sh [command]
+#
+#   Commands:
+#     all     Build all three stages, then benchmark (default)
+#     build   Baseline, instrumented, training run, optimised build
+#     bench   Benchmark baseline against optimised (after build)
+#     clean   Remove the PGO build directories and profiles
+#
+#   Environment:
+#     TRAIN_HOURS   Simulated hours for the training run   (default 2)
+#     BENCH_HOURS   Simulated hours per benchmark run      (default 1)
+#     BENCH_RUNS    Runs per binary; the median is reported (default 3)
+#     UI_SCRIPT     Touch script for training and benchmark
+#
+# PREREQUISITES:
+#   - SDL2 development files, CMake, GCC or Clang (as for the simulator)
+#   - Clang only: llvm-profdata (xcrun llvm-profdata on macOS)
+#
+# NOTE:
+#   The profiles come from the x86 / Apple simulator build; use them to
+#   measure the gain and to pick flags.  The target build must collect
+#   its own profiles on the board (same commands, cross toolchain).
+#
+# =============================================================================
+set -euo pipefail
+
+# ---------------------------------------------------------------------------
+# Configuration
+# ---------------------------------------------------------------------------
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(cd "$SCRIPT_DIR/.." && pwd)"
+SIM_DIR="$PROJECT_ROOT/simulator"
+BASE_BUILD="$SIM_DIR/build-o2"
+PGO_BUILD="$SIM_DIR/build-pgo"
+PROFILE_DIR="$PGO_BUILD/pgo-profile"
+WORK_DIR="$PGO_BUILD/run"
+
+TRAIN_HOURS="${TRAIN_HOURS:-2}"
+BENCH_HOURS="${BENCH_HOURS:-1}"
+BENCH_RUNS="${BENCH_RUNS:-3}"
+UI_SCRIPT="${UI_SCRIPT:-$SIM_DIR/input_scripts/ui_latency.txt}"
+
+NPROC="$(nproc 2>/dev/null || sysctl -n hw.ncpu 2>/dev/null || echo 4)"
+
+# ---------------------------------------------------------------------------
+# Color output helpers
+# ---------------------------------------------------------------------------
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+CYAN='\033[0;36m'
+NC='\033[0m'
+
+info()  { echo -e "${GREEN}[PGO]${NC}   $*"; }
+warn()  { echo -e "${YELLOW}[WARN]${NC}  $*"; }
+error() { echo -e "${RED}[ERROR]${NC} $*" >&2; }
+step()  { echo -e "${CYAN}[STEP]${NC}  $*"; }
+die()   { error "$*"; exit 1; }
+
+# ---------------------------------------------------------------------------
+# Helpers
+# ---------------------------------------------------------------------------
+
+# Configure and build the simulator in $1 with the remaining CMake options.
+build_sim() {
+    local dir="$1"
+    shift
+    cmake -S "$SIM_DIR" -B "$dir" -DCMAKE_BUILD_TYPE= "$@" >/dev/null
+    cmake --build "$dir" -j"$NPROC"
+}
+
+# Run the simulator binary $1 with the remaining arguments in a fresh
+# working directory (databases and snapshots start empty every time).
+# Output goes to $WORK_DIR/last.log; prints the elapsed seconds.
+run_sim() {
+    local bin="$1"
+    shift
+    rm -rf "$WORK_DIR"
+    mkdir -p "$WORK_DIR"
+    local TIMEFORMAT=%R
+    { time (cd "$WORK_DIR" && "$bin" --headless "$@" >last.log 2>&1); } 2>&1
+}
+
+# Training workload: data path, then UI interactions.
+run_workload() {
+    local bin="$1"
+    info "  Data workload: $TRAIN_HOURS simulated hours"
+    run_sim "$bin" --sim "$TRAIN_HOURS" >/dev/null
+    info "  UI workload: $(basename "$UI_SCRIPT")"
+    run_sim "$bin" --sim --script "$UI_SCRIPT" >/dev/null
+}
+
+# Clang writes raw profiles that must be merged before use.
+merge_profiles() {
+    if ! ls "$PROFILE_DIR"/*.profraw >/dev/null 2>&1; then
+        return 0
+    fi
+    local profdata="llvm-profdata"
+    if ! command -v "$profdata" >/dev/null 2>&1; then
+        if command -v xcrun >/dev/null 2>&1; then
+            profdata="xcrun llvm-profdata"
+        else
+            die "llvm-profdata not found (needed to merge Clang profiles)"
+        fi
+    fi
+    $profdata merge -output="$PROFILE_DIR/default.profdata" "$PROFILE_DIR"/*.profraw
+}
+
+# Median of the numbers on stdin.
+median() {
+    sort -n | awk '{ v[NR] = $1 } END { if (NR) print v[int((NR + 1) / 2)] }'
+}
+
+# Field $2 (e.g. "p95") of the last "[$1] $3 ..." latency line in the log.
+hist_field() {
+    awk -v tag="[$1]" -v name="$3" -v field="$2" '
+        $1 == tag && $2 == name {
+            for (i = 3; i < NF; i++) if ($i == field) v = $(i + 1)
+        }
+        END { print (v == "" ? "-" : v) }' "$WORK_DIR/last.log"
+}
+
+# ---------------------------------------------------------------------------
+# Commands
+# ---------------------------------------------------------------------------
+
+cmd_build() {
+    [ -f "$UI_SCRIPT" ] || die "Touch script not found: $UI_SCRIPT"
+
+    step "1/4 Baseline build (-O2)"
+    build_sim "$BASE_BUILD" -DVM_PGO=OFF -DVM_LTO=OFF
+
+    step "2/4 Instrumented build"
+    rm -rf "$PROFILE_DIR"
+    mkdir -p "$PROFILE_DIR"
+    build_sim "$PGO_BUILD" -DVM_PGO=GENERATE -DVM_PGO_DIR="$PROFILE_DIR" -DVM_LTO=OFF
+
+    step "3/4 Training run"
+    run_workload "$PGO_BUILD/simulator"
+    merge_profiles
+    info "  Profiles in $PROFILE_DIR"
+
+    # Same build directory: the profile names follow the object paths
+    step "4/4 Optimised build (PGO + LTO)"
+    build_sim "$PGO_BUILD" -DVM_PGO=USE -DVM_PGO_DIR="$PROFILE_DIR" -DVM_LTO=ON
+
+    info "Baseline:  $BASE_BUILD/simulator"
+    info "Optimised: $PGO_BUILD/simulator"
+}
+
+# Benchmark one binary; prints "data_s ui_s frame_p50 frame_p95 input_p95".
+bench_one() {
+    local bin="$1"
+    local data_s=() ui_s=() f50=() f95=() i95=()
+    for _ in $(seq 1 "$BENCH_RUNS"); do
+        data_s+=("$(run_sim "$bin" --sim "$BENCH_HOURS")")
+        f50+=("$(hist_field perf p50 frame)")
+        f95+=("$(hist_field perf p95 frame)")
+        ui_s+=("$(run_sim "$bin" --sim --script "$UI_SCRIPT")")
+        i95+=("$(awk '$1 == "[input]" { for (i = 3; i < NF; i++) if ($i == "p95") print $(i + 1) }' \
+                 "$WORK_DIR/last.log" | median)")
+    done
+    echo "$(printf '%s\n' "${data_s[@]}" | median)" \
+         "$(printf '%s\n' "${ui_s[@]}" | median)" \
+         "$(printf '%s\n' "${f50[@]}" | median)" \
+         "$(printf '%s\n' "${f95[@]}" | median)" \
+         "$(printf '%s\n' "${i95[@]}" | median)"
+}
+
+cmd_bench() {
+    [ -x "$BASE_BUILD/simulator" ] || die "No baseline build (run '$0 build' first)"
+    [ -x "$PGO_BUILD/simulator" ]  || die "No optimised build (run '$0 build' first)"
+
+    step "Benchmark: $BENCH_RUNS run(s) of $BENCH_HOURS h data + UI script per binary"
+    info "  Baseline..."
+    local base
+    base="$(bench_one "$BASE_BUILD/simulator")"
+    info "  Optimised..."
+    local opt
+    opt="$(bench_one "$PGO_BUILD/simulator")"
+
+    echo ""
+    echo "$base" "$opt" | awk '
+        function row(name, unit, b, o) {
+            if (b == "-" || o == "-" || b == "" || o == "" || b + 0 == 0) {
+                printf "%-26s %10s %10s %9s\n", name " (" unit ")", b, o, "-"
+            } else {
+                printf "%-26s %10.2f %10.2f %+8.1f%%\n", name " (" unit ")",
+                       b, o, (o - b) * 100.0 / b
+            }
+        }
+        {
+            printf "%-26s %10s %10s %9s\n", "Metric (median)", "-O2", "PGO+LTO", "change"
+            row("data workload",    "s",  $1, $6)
+            row("UI workload",      "s",  $2, $7)
+            row("frame p50",        "ms", $3, $8)
+            row("frame p95",        "ms", $4, $9)
+            row("touch p95, median label", "ms", $5, $10)
+        }'
+    echo ""
+    info "Negative change is faster.  Workload times are CPU time under the"
+    info "virtual clock; frame and touch latency are real time per frame."
+}
+
+cmd_clean() {
+    step "Removing $BASE_BUILD and $PGO_BUILD"
+    rm -rf "$BASE_BUILD" "$PGO_BUILD"
+    info "Clean complete."
+}
+
+# ---------------------------------------------------------------------------
+# Main entry point
+# ---------------------------------------------------------------------------
+COMMAND="${1:-all}"
+
+case "$COMMAND" in
+    all)
+        cmd_build
+        cmd_bench
+        ;;
+    build)
+        cmd_build
+        ;;
+    bench)
+        cmd_bench
+        ;;
+    clean)
+        cmd_clean
+        ;;
+    -h|--help|help)
+        echo "Usage: $0 [command]"
+        echo ""
+        echo "Commands:"
+        echo "  all     Build all stages, then benchmark (default)"
+        echo "  build   Baseline, instrumented, training run, optimised build"
+        echo "  bench   Benchmark baseline against optimised"
+        echo "  clean   Remove PGO build directories and profiles"
+        echo "  help    Show this help message"
+        ;;
+    *)
+        die "Unknown command: $COMMAND (run '$0 help' for usage)"
+        ;;
+esac
@@ -0,0 +1,144 @@
+/**
+ * @file input_player.c
+ * @brief Scripted touch input and touch-to-photon latency for the simulator
+ *
+ * Script time is application time (vclock_mono_ms), so scripts play the
+ * same under --sim; latency is real time.  One interaction is measured at
+ * a time: a trigger records t0, the next RENDER_START arms it and the
+ * following FLUSH_FINISH completes it.  A trigger that arrives while the
+ * previous one is still waiting for its flush replaces it and counts as
+ * unmeasured.
+ *
+ * That first frame is the complete response only where the handler
+ * changes the screen synchronously; for results delivered later (trend
+ * queries, data-thread alarm actions) it is the press feedback, and
+ * scripts label such interactions *_press_feedback.
+ */
+
+#include "input_player.h"
+#include "input_script.h"
+#include "latency_hist.h"
+#include "vclock.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Script and input device */
+static input_script_t script;
+static lv_indev_t    *indev = NULL;
+static bool           active = false;
+
+/* Per-interaction latency */
+typedef struct {
+    char           label[INPUT_SCRIPT_LABEL_MAX];
+    latency_hist_t hist;
+} interaction_t;
+
+static interaction_t interactions[INPUT_PLAYER_MAX_LABELS];
+static int           interaction_count = 0;
+static unsigned      unmeasured = 0;
+
+/* Measurement in flight */
+static int      pending = -1;           /* Interaction index, -1: none */
+static uint64_t pending_t0_us = 0;
+static bool     pending_armed = false;  /* A render started after the trigger */
+
+/**
+ * @brief Histogram index for a label, adding it if new (-1 if table full)
+ */
+static int interaction_index(const char *label) {
+    for (int i = 0; i < interaction_count; i++) {
+        if (strcmp(interactions[i].label, label) == 0) return i;
+    }
+    if (interaction_count >= INPUT_PLAYER_MAX_LABELS) return -1;
+    interaction_t *it = &interactions[interaction_count];
+    snprintf(it->label, sizeof(it->label), "%s", label);
+    latency_hist_reset(&it->hist);
+    return interaction_count++;
+}
+
+/**
+ * @brief Pointer read callback: the script's state at application time
+ */
+static void player_read_cb(lv_indev_t *dev, lv_indev_data_t *data) {
+    (void)dev;
+
+    input_point_t p;
+    const char *trigger = NULL;
+    bool more = input_script_sample(&script, vclock_mono_ms(), &p, &trigger);
+
+    data->point.x = p.x;
+    data->point.y = p.y;
+    data->state = p.pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+
+    if (trigger) {
+        if (pending >= 0) unmeasured++;
+        pending = interaction_index(trigger);
+        pending_t0_us = vclock_real_us();
+        pending_armed = false;
+    }
+    if (!more && active) {
+        active = false;
+        printf("[input_player] Script finished\n");
+    }
+}
+
+/**
+ * @brief Display events: arm on render start, complete on flush finish
+ */
+static void player_display_cb(lv_event_t *e) {
+    if (pending < 0) return;
+
+    if (lv_event_get_code(e) == LV_EVENT_RENDER_START) {
+        pending_armed = true;
+    } else if (pending_armed) {
+        latency_hist_add(&interactions[pending].hist,
+                         (uint32_t)(vclock_real_us() - pending_t0_us));
+        pending = -1;
+        pending_armed = false;
+    }
+}
+
+/**
+ * @brief Load a script and start playing it
+ */
+bool input_player_start(const char *path) {
+    if (!input_script_load(&script, path)) return false;
+
+    indev = lv_indev_create();
+    if (!indev) {
+        fprintf(stderr, "[input_player] Cannot create input device\n");
+        return false;
+    }
+    lv_indev_set_type(indev, LV_INDEV_TYPE_POINTER);
+    lv_indev_set_read_cb(indev, player_read_cb);
+
+    lv_display_t *disp = lv_display_get_default();
+    lv_display_add_event_cb(disp, player_display_cb, LV_EVENT_RENDER_START, NULL);
+    lv_display_add_event_cb(disp, player_display_cb, LV_EVENT_FLUSH_FINISH, NULL);
+
+    input_script_start(&script, vclock_mono_ms());
+    active = true;
+    printf("[input_player] Playing %s\n", path);
+    return true;
+}
+
+/**
+ * @brief True once the script has finished and its last flush was timed
+ */
+bool input_player_is_done(void) {
+    return indev && !active && pending < 0;
+}
+
+/**
+ * @brief Print p50/p95/p99 per interaction
+ */
+void input_player_report(void) {
+    if (!indev) return;
+    for (int i = 0; i < interaction_count; i++) {
+        latency_hist_print(&interactions[i].hist, "input", interactions[i].label);
+    }
+    if (unmeasured || pending >= 0) {
+        printf("[input] %u interaction(s) without a flush\n",
+               unmeasured + (pending >= 0 ? 1u : 0u));
+    }
+}
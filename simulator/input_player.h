@@ -0,0 +1,44 @@
+/**
+ * @file input_player.h
+ * @brief Scripted touch input and touch-to-photon latency for the simulator
+ *
+ * Plays an input_script through its own LVGL pointer device, beside the
+ * SDL mouse, and times every labelled interaction from the indev read that
+ * delivered it to the end of the first flush rendered after it — the
+ * frame that can contain the visual response.  Results go into one
+ * latency histogram per label.  Render thread only.
+ */
+
+#ifndef INPUT_PLAYER_H
+#define INPUT_PLAYER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "lvgl.h"
+#include <stdbool.h>
+
+#define INPUT_PLAYER_MAX_LABELS  16
+
+/**
+ * @brief Load a script and start playing it (after lv_init and the display)
+ * @return false if the script cannot be loaded or the indev created
+ */
+bool input_player_start(const char *path);
+
+/**
+ * @brief True once the script has finished and its last flush was timed
+ */
+bool input_player_is_done(void);
+
+/**
+ * @brief Print p50/p95/p99 per interaction
+ */
+void input_player_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INPUT_PLAYER_H */
@@ -20,6 +20,10 @@
    MEMORY SETTINGS
  *=========================*/
 
+/* LVGL's heap is ui_heap (src/ui/lv_mem_ui_heap.c): TLSF with allocations
+ * tagged by screen, and optional per-screen arenas */
+#define LV_USE_STDLIB_MALLOC LV_STDLIB_CUSTOM
+
 /* Size of the memory available for LVGL's internal management purposes */
 #define LV_MEM_SIZE (256 * 1024U)  /* 256KB - increased for trend charts + overlays */
 
@@ -39,6 +43,15 @@
 /* Dot Per Inch: used to initialize default sizes such as widgets sized, style paddings, etc. */
 #define LV_DPI_DEF 130     /* Common value for 4" displays */
 
+/*====================
+   OPERATING SYSTEM
+ *====================*/
+
+/* Rendering and data processing run on separate threads (see
+ * data_thread.h): lv_timer_handler() takes lv_lock() itself, and the
+ * render loop holds it while applying data-thread messages to widgets */
+#define LV_USE_OS LV_OS_PTHREAD
+
 /*=================
    FONT SETTINGS
  *=================*/
@@ -10,6 +10,40 @@
  * - Waveform generator synthesizing samples every frame
  * - Alarm color coding based on threshold evaluation
  * - Navigation bar with placeholder screens
+ *
+ * Threads (see data_thread.h):
+ *
+ *   render (CPU 0)            data (CPU 1)              job_pool workers
+ *   SDL input                 vitals 1 Hz -> trend_db   purge, aggregation,
+ *   lv_timer_handler()        alarm evaluation          queries, snapshots
+ *   apply ui_queue  <-------  waveform synthesis 30 Hz
+ *   ack / silence   ------->  recovery snapshots
+ *
+ * Build with -DVM_DATA_THREAD=OFF to run the data tasks inline between
+ * frames instead; the frame-time and latency histograms printed every
+ * minute and at exit then show the single-thread baseline.  The same
+ * report lists memory: RSS by region, SQLite heap and the LVGL pool
+ * per screen (mem_report.h, ui_heap.h); scripts/mem-report.sh lists
+ * static sizes per module.  -DVM_UI_ARENAS=ON gives each screen its own
+ * LVGL heap arena.  -DVM_GLYPH_CACHE=OFF rasterizes every glyph every
+ * frame; compare the glyphs-per-frame line of the two builds.
+ *
+ * Time comes from vclock.  `simulator --sim [HOURS]` runs on a virtual
+ * clock starting at SIM_START_WALL_S: the main loop advances time to the
+ * next due timer instead of sleeping, so hours of monitoring run as fast
+ * as the CPU allows and repeat sample for sample.  With HOURS the
+ * simulator exits after that much virtual time (soak runs).
+ *
+ * `simulator --script FILE` plays a touch script (see input_script.h)
+ * and exits when it ends, printing touch-to-photon latency percentiles
+ * per interaction.  It combines with --sim.
+ *
+ * `--headless` renders without a window or vsync (see sdl_display.h), for
+ * training and benchmark runs on build machines (scripts/pgo-build.sh).
+ *
+ * `--stream [PORT]` serves a read-only remote view of the screen on
+ * localhost (screen_stream.h); watch it with `stream_viewer`.  The perf
+ * report then adds capture time per frame and bandwidth.
  */
 
 #include "lvgl.h"
@@ -27,6 +61,7 @@
 #include "screen_settings.h"
 #include "vitals_provider.h"
 #include "trend_db.h"
+#include "trend_cache.h"
 #include "waveform_gen.h"
 #include "screen_login.h"
 #include "screen_audit_log.h"
@@ -37,23 +72,79 @@
 #include "audit_log.h"
 #include "network_manager.h"
 #include "sync_queue.h"
+#include "fhir_client.h"
+#include "job_pool.h"
 #include "service_manager.h"
+#include "status_board.h"
+#include "db_backup.h"
+#include "startup.h"
+#include "recovery.h"
+#include "data_thread.h"
+#include "msg_queue.h"
+#include "latency_hist.h"
+#include "vclock.h"
+#include "input_player.h"
+#include "mem_report.h"
+#include "mem_budget.h"
+#include "screen_stream.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <signal.h>
 #include <stdbool.h>
+#include <string.h>
 #include <time.h>
 
 static bool running = true;
-static lv_timer_t *purge_timer = NULL;
+static lv_timer_t *sync_timer = NULL;
+static lv_timer_t *backup_timer = NULL;
+static lv_timer_t *perf_timer = NULL;
+
+/* 1: data tasks on their own thread; 0: inline between frames */
+#ifndef VM_DATA_THREAD
+#define VM_DATA_THREAD          1
+#endif
+
+/* 1: each screen allocates from its own LVGL heap arena (ui_heap.h) */
+#ifndef VM_UI_ARENAS
+#define VM_UI_ARENAS            0
+#endif
+
+/* 1: value fonts and static labels come from the glyph cache (theme_vitals.h) */
+#ifndef VM_GLYPH_CACHE
+#define VM_GLYPH_CACHE          1
+#endif
+
+#define PERF_REPORT_MS          60000
+
+/* Virtual clock start for --sim: 2026-01-01 00:00:00 UTC */
+#define SIM_START_WALL_S        1767225600
+
+/* Backup copy of the database (a secondary partition on the target) */
+#ifndef DB_BACKUP_DEST
+#define DB_BACKUP_DEST          "vitals_trends.bak.db"
+#endif
+#define DB_BACKUP_INTERVAL_MS   (6 * 3600 * 1000)
+
+/* Shared by trend_db and the other SQLite modules */
+#define DB_PATH                 "vitals_trends.db"
+
+/* Alarm state and partial minutes for crash recovery */
+#define RECOVERY_SNAPSHOT_PATH  "vitals_state.snap"
+
+/* Remote view: local viewers only; the station reaches it through a tunnel */
+#define STREAM_LISTEN_ADDR      "127.0.0.1"
+
+static screen_stream_t stream;
+static uint16_t stream_port = 0;        /* --stream; 0: off */
+static bool stream_on = false;
+MEM_BUDGET_ASSERT(screen_stream, sizeof(stream), MEM_BUDGET_SCREEN_STREAM);
 
 /* ── Waveform generators ──────────────────────────────────── */
 
 static waveform_gen_t ecg_gen;
 static waveform_gen_t pleth_gen;
-static lv_timer_t *waveform_timer = NULL;
 
 /*
  * Waveform sample rate:
@@ -63,7 +154,7 @@ static lv_timer_t *waveform_timer = NULL;
  */
 #define WAVEFORM_SAMPLES_PER_SEC   128
 #define WAVEFORM_SAMPLES_PER_FRAME 4
-#define WAVEFORM_TIMER_PERIOD_MS   33
+#define WAVEFORM_TASK_PERIOD_MS   33
 
 /* ── Signal handler ────────────────────────────────────────── */
 
@@ -73,40 +164,173 @@ static void signal_handler(int signum) {
     running = false;
 }
 
-/* ── Waveform timer callback ──────────────────────────────── */
+/* ── Data thread -> render thread messages ─────────────────── */
+
+typedef enum {
+    UI_MSG_VITALS = 0,      /* Evaluated vitals and alarm banner */
+    UI_MSG_WAVE,            /* One frame of waveform samples */
+} ui_msg_kind_t;
+
+typedef struct {
+    ui_msg_kind_t kind;
+    uint64_t      due_us;   /* When the producing task was due */
+    union {
+        struct {
+            vitals_data_t data;
+            uint8_t       severity;         /* vm_alarm_severity_t */
+            char          message[48];      /* Banner text */
+        } vitals;
+        struct {
+            int32_t ecg[WAVEFORM_SAMPLES_PER_FRAME];
+            int32_t pleth[WAVEFORM_SAMPLES_PER_FRAME];
+        } wave;
+    } u;
+} ui_msg_t;
+
+#define UI_QUEUE_LEN            32      /* ~1 s of waveform frames */
+
+static msg_queue_t ui_queue;
+static ui_msg_t    ui_queue_buf[UI_QUEUE_LEN];
+
+/* ── Latency histograms ────────────────────────────────────── */
+
+/* Data thread: vitals due -> alarm evaluation finished */
+static latency_hist_t eval_hist;
+
+/* Render thread: vitals due -> applied to widgets (application time);
+ * time per frame (real time, also under a virtual clock) */
+static latency_hist_t screen_hist;
+static latency_hist_t frame_hist;
+static uint64_t       frame_start_us = 0;
+
+static void frame_event_cb(lv_event_t *e) {
+    if (lv_event_get_code(e) == LV_EVENT_RENDER_START) {
+        frame_start_us = vclock_real_us();
+    } else if (frame_start_us) {
+        latency_hist_add(&frame_hist, (uint32_t)(vclock_real_us() - frame_start_us));
+        frame_start_us = 0;
+    }
+}
+
+/** Flush hook: changed tiles to the remote viewer. */
+static void stream_flush_hook(const uint32_t *fb, uint32_t stride,
+                              const lv_area_t *area, bool last) {
+    screen_stream_capture(&stream, fb, stride, area->x1, area->y1, area->x2, area->y2);
+    if (last) screen_stream_frame_end(&stream, fb, stride);
+}
+
+/** Render thread: RSS by region, SQLite heap, the LVGL pool per screen. */
+static void mem_report_render(void) {
+    mem_report_t r;
+    mem_report_sample(&r);
+    mem_report_print(&r, "mem");
+
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    printf("[mem] LVGL pool %u/%u KB used, peak %u KB, %u%% fragmented\n",
+           (unsigned)((mon.total_size - mon.free_size) / 1024),
+           (unsigned)(mon.total_size / 1024),
+           (unsigned)(mon.max_used / 1024), (unsigned)mon.frag_pct);
+    screen_manager_print_mem("mem");
+}
+
+/** Render thread: frame/vitals->screen latency, trend cache, memory. */
+static void perf_report_render(void) {
+    latency_hist_print(&frame_hist, "perf", "frame");
+    latency_hist_print(&screen_hist, "perf", "vitals->screen");
+    msg_queue_stats_t q = msg_queue_get_stats(&ui_queue);
+    printf("[perf] ui_queue pushed %u dropped %u high-water %u\n",
+           q.pushed, q.dropped, q.high_water);
+    trend_cache_stats_t tc = trend_cache_get_stats();
+    printf("[perf] trend_cache hits %u misses %u evictions %u stale %u "
+           "(%u entries, %u KB)\n", tc.hits, tc.misses, tc.evictions,
+           tc.stale_stores, tc.entries, tc.bytes_used / 1024);
+    theme_vitals_print_glyph_stats("perf", frame_hist.count);
+    if (stream_on) screen_stream_print(&stream, "perf");
+    mem_report_render();
+}
 
-static void waveform_timer_cb(lv_timer_t *timer) {
+/** Data thread: alarm evaluation latency and task timing. */
+static void perf_report_data(void) {
+    latency_hist_print(&eval_hist, "perf", "alarm eval");
+    for (int i = 0; i < data_thread_task_count(); i++) {
+        data_task_stats_t st;
+        if (!data_thread_get_task_stats(i, &st)) continue;
+        printf("[perf] task %-10s runs %-6u skipped %-4u max run %.2f ms  "
+               "max late %.2f ms\n", st.name, st.runs, st.skipped,
+               st.max_run_us / 1000.0, st.max_late_us / 1000.0);
+    }
+}
+
+static void perf_timer_cb(lv_timer_t *timer) {
     (void)timer;
+    perf_report_render();
+}
+
+static void perf_task(uint64_t due_us) {
+    (void)due_us;
+    perf_report_data();
+}
 
-    /* Only generate waveforms when main vitals screen is active */
-    if (screen_manager_get_active() != SCREEN_ID_MAIN_VITALS) return;
+static void perf_report_call(void *arg) {
+    (void)arg;
+    perf_report_data();
+}
+
+/* ── Waveform task (data thread) ───────────────────────────── */
+
+static void waveform_task(uint64_t due_us) {
+    ui_msg_t m;
+    m.kind = UI_MSG_WAVE;
+    m.due_us = due_us;
 
-    /* Push multiple samples per frame for smooth sweep */
+    /* Multiple samples per frame for smooth sweep */
     for (int i = 0; i < WAVEFORM_SAMPLES_PER_FRAME; i++) {
-        int32_t ecg_val  = waveform_gen_next_sample(&ecg_gen);
-        int32_t pleth_val = waveform_gen_next_sample(&pleth_gen);
-        screen_main_vitals_push_ecg_sample(ecg_val);
-        screen_main_vitals_push_pleth_sample(pleth_val);
+        m.u.wave.ecg[i]   = waveform_gen_next_sample(&ecg_gen);
+        m.u.wave.pleth[i] = waveform_gen_next_sample(&pleth_gen);
     }
-
-    /* Single chart refresh after all samples pushed (efficient) */
-    screen_main_vitals_refresh_waveforms();
+    msg_queue_push(&ui_queue, &m);
 }
 
-/* ── Vitals data callback ──────────────────────────────────── */
+/* ── Alarm event recording ─────────────────────────────────── */
 
-static void on_vitals_update(const vitals_data_t *data, void *user_data) {
-    (void)user_data;
+/* Slot and time of the vitals being evaluated; acks and silences from
+ * the UI are recorded against the last ones */
+static uint8_t  alarm_slot = 0;
+static uint32_t alarm_now_s = 0;
 
-    /* Update vital sign displays */
-    screen_main_vitals_update_hr(data->hr);
-    screen_main_vitals_update_spo2(data->spo2);
-    screen_main_vitals_update_temp(data->temp);
-    screen_main_vitals_update_rr(data->rr);
+/* Logged-in operator, published by the render thread for attribution */
+static int32_t  session_user_id = 0;    /* __atomic */
 
-    if (data->nibp_fresh) {
-        screen_main_vitals_update_nibp(data->nibp_sys, data->nibp_dia, data->nibp_map);
+static void publish_session_user(void) {
+    const auth_session_t *session = auth_manager_get_session();
+    int32_t id = (session && session->logged_in) ? session->user.id : 0;
+    __atomic_store_n(&session_user_id, id, __ATOMIC_RELAXED);
+}
+
+static void on_alarm_event(const alarm_event_t *evt, void *user_data) {
+    (void)user_data;
+    alarm_event_t e = *evt;
+    if (e.kind == ALARM_EVT_ACK || e.kind == ALARM_EVT_SILENCE) {
+        e.user_id = __atomic_load_n(&session_user_id, __ATOMIC_RELAXED);
     }
+    trend_db_insert_alarm(alarm_slot, alarm_now_s, &e);
+}
+
+/* ── Vitals (data thread) ──────────────────────────────────── */
+
+/* Due time of the vitals task whose sample is being evaluated */
+static uint64_t vitals_due_us = 0;
+
+static void vitals_task(uint64_t due_us) {
+    vitals_due_us = due_us;
+    vitals_provider_tick();
+    vitals_due_us = 0;
+}
+
+static void on_vitals_update(const vitals_data_t *data, void *user_data) {
+    (void)user_data;
+    uint64_t due_us = vitals_due_us ? vitals_due_us : vclock_mono_us();
 
     /* Update waveform generators with current heart rate */
     waveform_gen_set_hr(&ecg_gen,  data->hr, WAVEFORM_SAMPLES_PER_SEC);
@@ -114,66 +338,142 @@ static void on_vitals_update(const vitals_data_t *data, void *user_data) {
 
     /* Evaluate alarms via alarm engine */
     uint32_t now_s = (uint32_t)(data->timestamp_ms / 1000);
+    alarm_slot = data->patient_slot;
+    alarm_now_s = now_s;
     alarm_engine_evaluate(data, now_s);
+    latency_hist_add(&eval_hist, (uint32_t)(vclock_mono_us() - due_us));
 
     const alarm_engine_state_t *alarm_state = alarm_engine_get_state();
 
-    /* Get current time string */
-    time_t now = time(NULL);
-    struct tm *tm_info = localtime(&now);
-    char time_buf[8];
-    snprintf(time_buf, sizeof(time_buf), "%02d:%02d", tm_info->tm_hour, tm_info->tm_min);
+    /* Mirror current state onto the status board for other consumers.
+       The simulator does not run sensor-/alarm-service, so this thread is
+       the one writer of the vitals and alarm records. */
+    status_vitals_t board_vitals;
+    status_alarms_t board_alarms;
+    status_board_vitals_from_data(data, &board_vitals);
+    status_board_alarms_from_engine(alarm_state, now_s, &board_alarms);
+    status_board_write_vitals(data->patient_slot, &board_vitals);
+    status_board_write_alarms(data->patient_slot, &board_alarms);
+
+    /* Hand the displays their values */
+    ui_msg_t m;
+    memset(&m, 0, sizeof(m));
+    m.kind = UI_MSG_VITALS;
+    m.due_us = due_us;
+    m.u.vitals.data = *data;
+    if (alarm_state->highest_active != ALARM_SEV_NONE && alarm_state->highest_message) {
+        m.u.vitals.severity = alarm_state->highest_active;
+        snprintf(m.u.vitals.message, sizeof(m.u.vitals.message), "%s",
+                 alarm_state->highest_message);
+    }
+    msg_queue_push(&ui_queue, &m);
+}
+
+/* ── Apply messages (render thread, under lv_lock) ─────────── */
+
+static void apply_vitals(const ui_msg_t *m) {
+    const vitals_data_t *data = &m->u.vitals.data;
+
+    /* Update vital sign displays */
+    screen_main_vitals_update_hr(data->hr);
+    screen_main_vitals_update_spo2(data->spo2);
+    screen_main_vitals_update_temp(data->temp);
+    screen_main_vitals_update_rr(data->rr);
 
-    /* Log alarm transitions via alarm engine (check for new active alarms) */
-    static alarm_severity_t prev_highest = ALARM_SEV_NONE;
-    if (alarm_state->highest_active != prev_highest &&
-        alarm_state->highest_active != ALARM_SEV_NONE &&
-        alarm_state->highest_message) {
-        vitals_alarm_severity_t sev = (vitals_alarm_severity_t)alarm_state->highest_active;
-        vitals_provider_log_alarm(sev, alarm_state->highest_message, time_buf);
-        trend_db_insert_alarm(now_s, (vm_alarm_severity_t)alarm_state->highest_active,
-                              alarm_state->highest_message);
+    if (data->nibp_fresh) {
+        screen_main_vitals_update_nibp(data->nibp_sys, data->nibp_dia, data->nibp_map);
     }
-    prev_highest = alarm_state->highest_active;
 
     /* Update alarm banner */
-    if (alarm_state->highest_active != ALARM_SEV_NONE && alarm_state->highest_message) {
-        screen_main_vitals_set_alarm((vm_alarm_severity_t)alarm_state->highest_active,
-                                      alarm_state->highest_message);
+    if (m->u.vitals.severity != VM_ALARM_NONE) {
+        screen_main_vitals_set_alarm((vm_alarm_severity_t)m->u.vitals.severity,
+                                      m->u.vitals.message);
     } else {
         screen_main_vitals_set_alarm(VM_ALARM_NONE, NULL);
     }
 
+    /* Get current time string */
+    time_t now = (time_t)vclock_wall_s();
+    struct tm *tm_info = localtime(&now);
+    char time_buf[8];
+    snprintf(time_buf, sizeof(time_buf), "%02d:%02d", tm_info->tm_hour, tm_info->tm_min);
+
     /* Update clock */
     screen_main_vitals_update_time(time_buf);
+
+    latency_hist_add(&screen_hist, (uint32_t)(vclock_mono_us() - m->due_us));
+    startup_mark("first_vitals");
 }
 
-/* ── Trend database purge timer ────────────────────────────── */
+static void drain_ui_queue(void) {
+    bool waves = false;
+    bool on_main = screen_manager_get_active() == SCREEN_ID_MAIN_VITALS;
+    ui_msg_t m;
+
+    while (msg_queue_pop(&ui_queue, &m)) {
+        if (m.kind == UI_MSG_VITALS) {
+            apply_vitals(&m);
+        } else if (on_main) {
+            /* Waveforms only draw on the main vitals screen */
+            for (int i = 0; i < WAVEFORM_SAMPLES_PER_FRAME; i++) {
+                screen_main_vitals_push_ecg_sample(m.u.wave.ecg[i]);
+                screen_main_vitals_push_pleth_sample(m.u.wave.pleth[i]);
+            }
+            waves = true;
+        }
+    }
 
-static void trend_purge_timer_cb(lv_timer_t *timer) {
-    (void)timer;
+    /* Single chart refresh after all samples pushed (efficient) */
+    if (waves) screen_main_vitals_refresh_waveforms();
+}
+
+/* ── Trend database purge (data thread) ────────────────────── */
+
+/** Worker thread: chunked purge, size cap and incremental vacuum. */
+static void trend_purge_job_run(void *arg) {
+    trend_db_maintain((uint32_t)(uintptr_t)arg);
+}
+
+static void trend_purge_task(uint64_t due_us) {
+    (void)due_us;
     const vitals_data_t *d = vitals_provider_get_current(0);
     if (d) {
-        trend_db_purge_old((uint32_t)(d->timestamp_ms / 1000));
+        void *now_s = (void *)(uintptr_t)(d->timestamp_ms / 1000);
+        if (!job_pool_submit(JOB_PRIO_LOW, trend_purge_job_run, NULL, now_s)) {
+            trend_purge_job_run(now_s);
+        }
     }
 }
 
-/* ── Main ──────────────────────────────────────────────────── */
+/* ── Database backup timer ─────────────────────────────────── */
 
-int main(int argc, char **argv) {
-    (void)argc;
-    (void)argv;
+static void backup_timer_cb(lv_timer_t *timer) {
+    (void)timer;
+    if (!db_backup_busy()) {
+        db_backup_start(DB_PATH, DB_BACKUP_DEST,
+                        DB_BACKUP_DEFAULT_BPS, NULL, NULL);
+    }
+}
 
-    printf("========================================\n");
-    printf("  Bedside Vitals Monitor - Simulator\n");
-    printf("  Phase 4: Full Application\n");
-    printf("========================================\n\n");
+/* ── Crash recovery (data thread) ──────────────────────────── */
 
-    /* Signal handlers for clean exit */
-    signal(SIGINT, signal_handler);
-    signal(SIGTERM, signal_handler);
+static void recovery_task(uint64_t due_us) {
+    (void)due_us;
+    recovery_tick();
+}
+
+/* ── Sync queue timer ──────────────────────────────────────── */
 
-    /* Initialize LVGL */
+static void sync_timer_cb(lv_timer_t *timer) {
+    (void)timer;
+    if (network_manager_is_connected() && !sync_queue_batch_in_flight()) {
+        sync_queue_process_async(8);
+    }
+}
+
+/* ── Init steps ────────────────────────────────────────────── */
+
+static bool boot_display(void) {
     lv_init();
     printf("LVGL initialized (version %d.%d.%d)\n",
            lv_version_major(), lv_version_minor(), lv_version_patch());
@@ -181,59 +481,111 @@ int main(int argc, char **argv) {
     /* Initialize SDL display (must be before lv_tick_set_cb since SDL needs init first) */
     if (!sdl_display_init(VM_SCREEN_WIDTH, VM_SCREEN_HEIGHT)) {
         fprintf(stderr, "Failed to initialize SDL display\n");
-        return 1;
+        return false;
     }
 
-    /* Provide SDL tick as LVGL's time source (SDL must be initialized first) */
-    lv_tick_set_cb(SDL_GetTicks);
+    /* LVGL runs on application time, real or virtual */
+    lv_tick_set_cb(vclock_mono_ms);
+
+    /* Frame-time distribution */
+    lv_display_t *disp = lv_display_get_default();
+    lv_display_add_event_cb(disp, frame_event_cb, LV_EVENT_RENDER_START, NULL);
+    lv_display_add_event_cb(disp, frame_event_cb, LV_EVENT_RENDER_READY, NULL);
+    perf_timer = lv_timer_create(perf_timer_cb, PERF_REPORT_MS, NULL);
+
+    /* Remote view */
+    if (stream_port) {
+        stream_on = screen_stream_init(&stream, VM_SCREEN_WIDTH, VM_SCREEN_HEIGHT) &&
+                    screen_stream_listen(&stream, STREAM_LISTEN_ADDR, stream_port);
+        if (stream_on) sdl_display_set_flush_hook(stream_flush_hook);
+    }
 
     /* Initialize SDL input */
     if (!sdl_input_init()) {
         fprintf(stderr, "Failed to initialize SDL input\n");
         sdl_display_deinit();
-        return 1;
+        return false;
     }
+    return true;
+}
 
-    /* Initialize theme */
+static bool boot_screens(void) {
     theme_vitals_init();
-
-    /* Initialize screen manager */
+    theme_vitals_set_glyph_cache(VM_GLYPH_CACHE);
     screen_manager_init();
 
     /* Register all screens */
-    screen_reg_t registrations[] = {
-        { SCREEN_ID_MAIN_VITALS, screen_main_vitals_create, screen_main_vitals_destroy, "Main Vitals" },
-        { SCREEN_ID_TRENDS,      screen_trends_create,      screen_trends_destroy,      "Trends" },
-        { SCREEN_ID_ALARMS,      screen_alarms_create,      screen_alarms_destroy,      "Alarms" },
-        { SCREEN_ID_PATIENT,     screen_patient_create,      screen_patient_destroy,      "Patient" },
-        { SCREEN_ID_SETTINGS,    screen_settings_create,    screen_settings_destroy,    "Settings" },
-        { SCREEN_ID_LOGIN,       screen_login_create,       screen_login_destroy,       "Login" },
-        { SCREEN_ID_AUDIT_LOG,   screen_audit_log_create,   screen_audit_log_destroy,   "Audit Log" },
+    static const screen_reg_t registrations[] = {
+        { SCREEN_ID_MAIN_VITALS, screen_main_vitals_create, screen_main_vitals_destroy, "Main Vitals", 64 * 1024 },
+        { SCREEN_ID_TRENDS,      screen_trends_create,      screen_trends_destroy,      "Trends",      64 * 1024 },
+        { SCREEN_ID_ALARMS,      screen_alarms_create,      screen_alarms_destroy,      "Alarms",      32 * 1024 },
+        { SCREEN_ID_PATIENT,     screen_patient_create,      screen_patient_destroy,      "Patient",     24 * 1024 },
+        { SCREEN_ID_SETTINGS,    screen_settings_create,    screen_settings_destroy,    "Settings",    24 * 1024 },
+        { SCREEN_ID_LOGIN,       screen_login_create,       screen_login_destroy,       "Login",       24 * 1024 },
+        { SCREEN_ID_AUDIT_LOG,   screen_audit_log_create,   screen_audit_log_destroy,   "Audit Log",   32 * 1024 },
     };
     for (int i = 0; i < (int)(sizeof(registrations) / sizeof(registrations[0])); i++) {
         screen_manager_register(&registrations[i]);
     }
+    screen_manager_set_arenas(VM_UI_ARENAS);
 
     /* Navigate to main vitals screen */
     screen_manager_push(SCREEN_ID_MAIN_VITALS);
 
     /* Auto-return to main vitals after 2 minutes of inactivity */
     screen_manager_set_auto_return(120000);
+    return true;
+}
+
+static bool boot_status_board(void) {
+    /* Shared with external tools when /dev/shm is usable */
+    return status_board_open(STATUS_BOARD_SHM_NAME, true) ||
+           status_board_open(NULL, true);
+}
+
+static bool boot_job_pool(void) {
+    /* Background workers for purge, aggregation, queries and sync */
+    return job_pool_init(JOB_POOL_WORKERS);
+}
+
+static bool boot_trend_db(void) {
+    return trend_db_init(DB_PATH);
+}
 
-    /* Initialize all data modules */
-    trend_db_init("vitals_trends.db");
+static bool boot_alarm_engine(void) {
     alarm_engine_init();
-    patient_data_init("vitals_trends.db");    /* Shares DB with trend_db */
-    settings_store_init("vitals_trends.db");  /* Shares DB with trend_db */
-    auth_manager_init("vitals_trends.db");    /* Shares DB with trend_db */
-    audit_log_init("vitals_trends.db");       /* Shares DB with trend_db */
-    network_manager_init();
-    sync_queue_init("vitals_trends.db");      /* Shares DB with trend_db */
+    alarm_engine_set_event_callback(on_alarm_event, NULL);
+    return true;
+}
+
+static bool boot_patient_data(void) {
+    return patient_data_init(DB_PATH);
+}
+
+static bool boot_trend_slots(void) {
+    /* Record each slot's trends under its admitted patient */
+    for (uint8_t slot = 0; slot < TREND_DB_SLOTS; slot++) {
+        const patient_t *pt = patient_data_get_active(slot);
+        trend_db_bind_slot(slot, pt ? pt->id : 0);
+    }
+    return true;
+}
+
+static bool boot_recovery(void) {
+    /* Restore what an unclean stop lost before vitals start flowing */
+    bool ok = recovery_init(RECOVERY_SNAPSHOT_PATH);
+    data_thread_add_task("recovery", RECOVERY_TICK_MS, recovery_task);
+    return ok;
+}
 
-    /* Initialize and start vitals provider (uses mock implementation for simulator) */
-    vitals_provider_init();
+static bool boot_vitals(void) {
+    /* Vitals provider (mock implementation for simulator) */
+    if (vitals_provider_init() != 0) return false;
     vitals_provider_set_vitals_callback(on_vitals_update, NULL);
-    vitals_provider_start(1000);  /* 1 second interval */
+    vitals_provider_start(0);     /* Ticked by the data thread */
+    msg_queue_init(&ui_queue, ui_queue_buf, sizeof(ui_msg_t), UI_QUEUE_LEN);
+    data_thread_add_task("vitals", 1000, vitals_task);   /* 1 second interval */
+    data_thread_add_task("perf", PERF_REPORT_MS, perf_task);
 
     /* Initialize waveform generators */
     waveform_gen_init(&ecg_gen,  WAVEFORM_ECG,  180, 200);  /* scaled to chart Y range [0..400] */
@@ -243,15 +595,166 @@ int main(int argc, char **argv) {
     waveform_gen_set_hr(&ecg_gen,  72, WAVEFORM_SAMPLES_PER_SEC);
     waveform_gen_set_hr(&pleth_gen, 72, WAVEFORM_SAMPLES_PER_SEC);
 
-    /* Start waveform timer (fires each frame) */
-    waveform_timer = lv_timer_create(waveform_timer_cb, WAVEFORM_TIMER_PERIOD_MS, NULL);
+    /* Waveform task (one packet per frame) */
+    data_thread_add_task("waveform", WAVEFORM_TASK_PERIOD_MS, waveform_task);
     printf("Waveform generators started (%d samples/sec, %d per frame)\n",
            WAVEFORM_SAMPLES_PER_SEC, WAVEFORM_SAMPLES_PER_FRAME);
+    return true;
+}
+
+/* Deferred: APIs of these modules are no-ops until their step has run */
+
+static bool boot_settings(void) {
+    return settings_store_init(DB_PATH);
+}
 
-    /* Purge old trend data every 5 minutes */
-    purge_timer = lv_timer_create(trend_purge_timer_cb, 300000, NULL);
+static bool boot_auth(void) {
+    return auth_manager_init(DB_PATH);
+}
 
+static bool boot_audit(void) {
+    if (!audit_log_init(DB_PATH)) return false;
     audit_log_record(AUDIT_EVENT_SYSTEM_START, "system", "Simulator started");
+    return true;
+}
+
+static bool boot_network(void) {
+    network_manager_init();
+    fhir_client_init();
+    return true;
+}
+
+static bool boot_sync_queue(void) {
+    if (!sync_queue_init(DB_PATH)) return false;
+
+    /* Export pending sync items every 30 seconds */
+    sync_timer = lv_timer_create(sync_timer_cb, 30000, NULL);
+    return true;
+}
+
+static bool boot_maintenance(void) {
+    /* Purge and vacuum trend data every 5 minutes */
+    data_thread_add_task("purge", 300000, trend_purge_task);
+
+    /* Online backup of the database every 6 hours */
+    backup_timer = lv_timer_create(backup_timer_cb, DB_BACKUP_INTERVAL_MS, NULL);
+    return true;
+}
+
+enum {
+    BOOT_DISPLAY = 0, BOOT_SCREENS, BOOT_STATUS_BOARD, BOOT_JOB_POOL,
+    BOOT_TREND_DB, BOOT_ALARM_ENGINE, BOOT_PATIENT_DATA, BOOT_TREND_SLOTS,
+    BOOT_RECOVERY, BOOT_VITALS, BOOT_SETTINGS, BOOT_AUTH, BOOT_AUDIT, BOOT_NETWORK,
+    BOOT_SYNC_QUEUE, BOOT_MAINTENANCE, BOOT_STEP_COUNT
+};
+
+#define FIRST   STARTUP_STAGE_FIRST_FRAME
+#define LATER   STARTUP_STAGE_DEFERRED
+#define DEP     STARTUP_DEP
+
+/*
+ * Everything the main vitals screen needs runs before the first frame;
+ * the rest runs one step per main-loop pass afterwards.  Deferred steps
+ * stay on the render thread: none of these modules lock their state.
+ * Data tasks registered here start with the data thread, after the
+ * first-frame stage.
+ */
+static const startup_step_t boot_steps[BOOT_STEP_COUNT] = {
+    [BOOT_DISPLAY]      = { "display",       boot_display,      0, FIRST },
+    [BOOT_SCREENS]      = { "screens",       boot_screens,      DEP(BOOT_DISPLAY), FIRST },
+    [BOOT_STATUS_BOARD] = { "status_board",  boot_status_board, 0, FIRST },
+    [BOOT_JOB_POOL]     = { "job_pool",      boot_job_pool,     0, FIRST },
+    [BOOT_TREND_DB]     = { "trend_db",      boot_trend_db,     0, FIRST },
+    [BOOT_ALARM_ENGINE] = { "alarm_engine",  boot_alarm_engine, 0, FIRST },
+    [BOOT_PATIENT_DATA] = { "patient_data",  boot_patient_data, DEP(BOOT_TREND_DB), FIRST },
+    [BOOT_TREND_SLOTS]  = { "trend_slots",   boot_trend_slots,
+                            DEP(BOOT_TREND_DB) | DEP(BOOT_PATIENT_DATA), FIRST },
+    [BOOT_RECOVERY]     = { "recovery",      boot_recovery,
+                            DEP(BOOT_JOB_POOL) | DEP(BOOT_ALARM_ENGINE) |
+                            DEP(BOOT_TREND_SLOTS), FIRST },
+    [BOOT_VITALS]       = { "vitals",        boot_vitals,
+                            DEP(BOOT_SCREENS) | DEP(BOOT_ALARM_ENGINE) |
+                            DEP(BOOT_TREND_SLOTS), FIRST },
+    [BOOT_SETTINGS]     = { "settings",      boot_settings,     DEP(BOOT_TREND_DB), LATER },
+    [BOOT_AUTH]         = { "auth_manager",  boot_auth,         DEP(BOOT_TREND_DB), LATER },
+    [BOOT_AUDIT]        = { "audit_log",     boot_audit,        DEP(BOOT_TREND_DB), LATER },
+    [BOOT_NETWORK]      = { "network",       boot_network,      0, LATER },
+    [BOOT_SYNC_QUEUE]   = { "sync_queue",    boot_sync_queue,
+                            DEP(BOOT_TREND_DB) | DEP(BOOT_NETWORK), LATER },
+    [BOOT_MAINTENANCE]  = { "maintenance",   boot_maintenance,
+                            DEP(BOOT_JOB_POOL) | DEP(BOOT_TREND_DB), LATER },
+};
+
+/* ── Main ──────────────────────────────────────────────────── */
+
+int main(int argc, char **argv) {
+    /* --sim [HOURS]: virtual clock, optionally stopping after HOURS;
+     * --script FILE: scripted touch input, stopping when it ends;
+     * --headless: no window, no vsync;
+     * --stream [PORT]: remote view */
+    bool sim = false;
+    double sim_hours = 0;
+    const char *script_path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--sim") == 0) {
+            sim = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                sim_hours = atof(argv[++i]);
+            }
+        } else if (strcmp(argv[i], "--script") == 0 && i + 1 < argc) {
+            script_path = argv[++i];
+        } else if (strcmp(argv[i], "--headless") == 0) {
+            sdl_display_set_headless(true);
+        } else if (strcmp(argv[i], "--stream") == 0) {
+            stream_port = SCREEN_STREAM_DEFAULT_PORT;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                stream_port = (uint16_t)atoi(argv[++i]);
+            }
+        } else {
+            fprintf(stderr, "Usage: %s [--sim [HOURS]] [--script FILE] [--headless] "
+                    "[--stream [PORT]]\n", argv[0]);
+            return 1;
+        }
+    }
+    uint64_t sim_end_us = 0;
+    vclock_init(sim ? VCLOCK_VIRTUAL : VCLOCK_REAL, SIM_START_WALL_S);
+    if (sim_hours > 0) {
+        sim_end_us = vclock_mono_us() + (uint64_t)(sim_hours * 3600.0 * 1e6);
+    }
+
+    printf("========================================\n");
+    printf("  Bedside Vitals Monitor - Simulator\n");
+    printf("  Phase 4: Full Application\n");
+    printf("========================================\n\n");
+
+    /* Signal handlers for clean exit */
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    /* SQLite memory counters (before any connection is opened) */
+    mem_report_track_sqlite();
+
+    /* Time every init step from here to the first vitals */
+    if (!startup_begin(boot_steps, BOOT_STEP_COUNT)) {
+        fprintf(stderr, "Invalid startup step table\n");
+        return 1;
+    }
+    if (startup_run_stage(STARTUP_STAGE_FIRST_FRAME) > 0 &&
+        startup_step_state(BOOT_DISPLAY) != STARTUP_STEP_OK) {
+        return 1;
+    }
+    if (script_path && !input_player_start(script_path)) {
+        return 1;
+    }
+    bool boot_reported = false;
+
+    /* Rendering on one core, data tasks on the other.  Pinned after the
+     * job_pool workers exist, which would otherwise inherit CPU 0. */
+    data_thread_pin_current(DATA_THREAD_RENDER_CPU);
+    if (!data_thread_start(VM_DATA_THREAD) && !data_thread_start(false)) {
+        fprintf(stderr, "Cannot start data tasks\n");
+        return 1;
+    }
 
     printf("\nSimulator running. Press Ctrl+C to exit.\n");
     printf("Window size: %dx%d (matching target hardware)\n\n",
@@ -265,33 +768,85 @@ int main(int argc, char **argv) {
             break;
         }
 
-        /* Handle LVGL tasks */
+        /* Apply finished background jobs and data-thread messages */
+        lv_lock();
+        job_pool_dispatch_completions();
+        drain_ui_queue();
+        publish_session_user();
+        lv_unlock();
+
+        /* Handle LVGL tasks (takes lv_lock itself) */
         uint32_t time_till_next = lv_timer_handler();
 
-        /* Sleep for a short time */
-        usleep(time_till_next * 1000);
+        /* Inline mode only: data tasks that are due */
+        uint32_t data_next = data_thread_poll();
+        if (data_next < time_till_next) time_till_next = data_next;
+
+        /* After the first frame: one deferred init step per pass */
+        if (!boot_reported && startup_milestone_ms("first_frame") >= 0) {
+            if (startup_run_next()) {
+                time_till_next = 0;
+            } else if (startup_milestone_ms("first_vitals") >= 0) {
+                startup_report();
+                boot_reported = true;
+            }
+        }
+
+        /* Sleep for a short time (virtual clock: jump ahead instead) */
+        vclock_sleep_ms(time_till_next);
+
+        if (sim_end_us && vclock_mono_us() >= sim_end_us) {
+            printf("\nSimulated time elapsed, stopping.\n");
+            running = false;
+        }
+        if (script_path && input_player_is_done()) {
+            printf("\nInput script finished, stopping.\n");
+            running = false;
+        }
     }
 
     /* Cleanup */
     printf("Cleaning up...\n");
+
+    /* Final report, then no data task runs past here */
+    perf_report_render();
+    input_player_report();
+    data_thread_call(perf_report_call, NULL);
+    data_thread_stop();
+    msg_queue_destroy(&ui_queue);
+
     audit_log_record(AUDIT_EVENT_SYSTEM_SHUTDOWN, "system", "Simulator shutdown");
+    if (sync_timer) {
+        lv_timer_delete(sync_timer);
+        sync_timer = NULL;
+    }
+    if (backup_timer) {
+        lv_timer_delete(backup_timer);
+        backup_timer = NULL;
+    }
+    if (perf_timer) {
+        lv_timer_delete(perf_timer);
+        perf_timer = NULL;
+    }
+    if (stream_on) {
+        sdl_display_set_flush_hook(NULL);
+        screen_stream_close(&stream);
+        stream_on = false;
+    }
+    db_backup_cancel();     /* Keeps the previous backup, drops the partial */
+    job_pool_deinit();      /* Finish queued jobs before closing their DBs */
     sync_queue_close();
+    fhir_client_deinit();
     network_manager_deinit();
     audit_log_close();
     auth_manager_close();
     settings_store_close();
     patient_data_close();
+    recovery_shutdown();    /* Other connections closed: WAL can truncate */
     alarm_engine_deinit();
-    if (purge_timer) {
-        lv_timer_delete(purge_timer);
-        purge_timer = NULL;
-    }
-    if (waveform_timer) {
-        lv_timer_delete(waveform_timer);
-        waveform_timer = NULL;
-    }
     vitals_provider_deinit();  /* This internally calls stop() */
     trend_db_close();
+    status_board_close();
     sdl_display_deinit();
 
     printf("Simulator exited cleanly.\n");
@@ -3,9 +3,15 @@
  * @brief SDL2 display driver for LVGL 9
  *
  * Simple SDL2 integration for LVGL v9.x simulator on Mac
+ *
+ * Headless mode (sdl_display_set_headless) uses SDL's dummy video driver
+ * and software renderer without vsync: nothing is shown, but LVGL renders
+ * and flushes every frame exactly as with a window, so scripted runs and
+ * benchmarks work on build machines without a display.
  */
 
 #include "sdl_display.h"
+#include "startup.h"
 #include <stdlib.h>
 
 /* SDL and LVGL globals */
@@ -15,10 +21,30 @@ static SDL_Texture *texture;
 static lv_display_t *disp;
 static uint32_t *fb;
 
+/* No window, no vsync (see sdl_display_set_headless) */
+static bool headless = false;
+
+/* Flush observer (see sdl_display_set_flush_hook) */
+static sdl_display_flush_hook_t flush_hook = NULL;
+
 /* Display dimensions */
 static uint32_t hor_res = 800;
 static uint32_t ver_res = 480;
 
+/**
+ * @brief Select headless mode (call before sdl_display_init)
+ */
+void sdl_display_set_headless(bool enable) {
+    headless = enable;
+}
+
+/**
+ * @brief Observe flushes
+ */
+void sdl_display_set_flush_hook(sdl_display_flush_hook_t hook) {
+    flush_hook = hook;
+}
+
 /**
  * @brief Initialize SDL2 and create window
  */
@@ -27,6 +53,9 @@ bool sdl_display_init(uint32_t width, uint32_t height) {
     ver_res = height;
 
     /* Initialize SDL */
+    if (headless) {
+        SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+    }
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         SDL_Log("SDL initialization failed: %s", SDL_GetError());
         return false;
@@ -38,7 +67,7 @@ bool sdl_display_init(uint32_t width, uint32_t height) {
         SDL_WINDOWPOS_CENTERED,
         SDL_WINDOWPOS_CENTERED,
         hor_res, ver_res,
-        SDL_WINDOW_SHOWN
+        headless ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN
     );
 
     if (!window) {
@@ -51,7 +80,8 @@ bool sdl_display_init(uint32_t width, uint32_t height) {
     renderer = SDL_CreateRenderer(
         window,
         -1,
-        SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC
+        headless ? SDL_RENDERER_SOFTWARE
+                 : SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC
     );
 
     if (!renderer) {
@@ -104,7 +134,8 @@ bool sdl_display_init(uint32_t width, uint32_t height) {
     lv_display_set_flush_cb(disp, sdl_display_flush);
     lv_display_set_buffers(disp, fb, NULL, hor_res * ver_res * sizeof(uint32_t), LV_DISPLAY_RENDER_MODE_DIRECT);
 
-    SDL_Log("SDL display initialized: %dx%d", hor_res, ver_res);
+    SDL_Log("SDL display initialized: %dx%d%s", hor_res, ver_res,
+            headless ? " (headless)" : "");
     return true;
 }
 
@@ -112,8 +143,11 @@ bool sdl_display_init(uint32_t width, uint32_t height) {
  * @brief Flush callback - copy framebuffer to SDL texture and render
  */
 void sdl_display_flush(lv_display_t *disp_drv, const lv_area_t *area, uint8_t *color_p) {
-    (void)disp_drv;  /* Unused */
-    (void)area;      /* Unused in direct mode */
+    (void)color_p;   /* Direct mode: LVGL drew straight into fb */
+
+    if (flush_hook) {
+        flush_hook(fb, hor_res, area, lv_display_flush_is_last(disp_drv));
+    }
 
     /* Update texture with framebuffer */
     SDL_UpdateTexture(texture, NULL, fb, hor_res * sizeof(uint32_t));
@@ -123,6 +157,12 @@ void sdl_display_flush(lv_display_t *disp_drv, const lv_area_t *area, uint8_t *c
     SDL_RenderCopy(renderer, texture, NULL, NULL);
     SDL_RenderPresent(renderer);
 
+    static bool presented = false;
+    if (!presented) {
+        presented = true;
+        startup_mark("first_frame");
+    }
+
     /* Tell LVGL we're done */
     lv_display_flush_ready(disp_drv);
 }
@@ -14,6 +14,19 @@ extern "C" {
 #include <SDL2/SDL.h>
 #include <stdbool.h>
 
+/**
+ * @brief Called at each flush with the XRGB8888 framebuffer and the area
+ *        LVGL redrew; `last` is set on the final area of a frame.
+ */
+typedef void (*sdl_display_flush_hook_t)(const uint32_t *fb, uint32_t stride,
+                                         const lv_area_t *area, bool last);
+
+/**
+ * @brief Render without a window: dummy video driver, software renderer,
+ *        no vsync.  Call before sdl_display_init().
+ */
+void sdl_display_set_headless(bool enable);
+
 /**
  * @brief Initialize SDL2 display
  * @param width Display width in pixels
@@ -22,6 +35,11 @@ extern "C" {
  */
 bool sdl_display_init(uint32_t width, uint32_t height);
 
+/**
+ * @brief Observe flushes (e.g. the remote view), NULL to stop
+ */
+void sdl_display_set_flush_hook(sdl_display_flush_hook_t hook);
+
 /**
  * @brief LVGL flush callback
  */
@@ -0,0 +1,179 @@
+/**
+ * @file stream_viewer.c
+ * @brief Remote view client: shows a monitor's screen streamed by screen_stream
+ *
+ *   stream_viewer [HOST [PORT]]      (default 127.0.0.1 5990)
+ *
+ * Connects to a simulator started with --stream, keeps an RGB565 copy of
+ * the screen that each FRAME message patches, and shows it in a window.
+ * Read-only: nothing is sent to the monitor.  Reconnects every second
+ * while the monitor is not reachable.
+ */
+
+#include "screen_stream.h"
+#include <SDL2/SDL.h>
+#include <netdb.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define RECONNECT_MS    1000
+#define POLL_MS         20
+
+static uint8_t  msg[SCREEN_STREAM_OUT_BYTES];
+static size_t   msg_len;
+static uint16_t *screen;
+static uint16_t width, height;
+
+static SDL_Window   *window;
+static SDL_Renderer *renderer;
+static SDL_Texture  *texture;
+
+/* ── Connection ──────────────────────────────────────────── */
+
+static int connect_to(const char *host, const char *port) {
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host, port, &hints, &res) != 0) return -1;
+
+    int fd = -1;
+    for (struct addrinfo *a = res; a; a = a->ai_next) {
+        fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (fd < 0) continue;
+        if (connect(fd, a->ai_addr, a->ai_addrlen) == 0) break;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+    return fd;
+}
+
+/* ── Display ─────────────────────────────────────────────── */
+
+/** (Re)create the window's texture for a new screen size. */
+static bool set_size(uint16_t w, uint16_t h) {
+    if (w == width && h == height && screen) return true;
+    free(screen);
+    screen = calloc((size_t)w * h, sizeof(uint16_t));
+    if (!screen) return false;
+    width = w;
+    height = h;
+
+    if (texture) SDL_DestroyTexture(texture);
+    texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGB565,
+                                SDL_TEXTUREACCESS_STREAMING, w, h);
+    SDL_SetWindowSize(window, w, h);
+    return texture != NULL;
+}
+
+static void present(void) {
+    SDL_UpdateTexture(texture, NULL, screen, width * sizeof(uint16_t));
+    SDL_RenderClear(renderer);
+    SDL_RenderCopy(renderer, texture, NULL, NULL);
+    SDL_RenderPresent(renderer);
+}
+
+/* ── Messages ────────────────────────────────────────────── */
+
+/**
+ * Apply every whole message in the buffer.
+ * @return false if the stream is malformed.
+ */
+static bool handle_messages(void) {
+    size_t off = 0;
+    bool frame = false;
+    while (msg_len - off >= SCREEN_STREAM_HDR_BYTES) {
+        uint8_t type;
+        uint32_t len;
+        if (!screen_stream_parse_header(msg + off, &type, &len)) return false;
+        if (msg_len - off < SCREEN_STREAM_HDR_BYTES + len) break;
+
+        const uint8_t *p = msg + off + SCREEN_STREAM_HDR_BYTES;
+        if (type == SCREEN_STREAM_MSG_HELLO) {
+            uint16_t w, h;
+            if (!screen_stream_parse_hello(p, len, &w, &h) || !set_size(w, h)) return false;
+            printf("[viewer] Screen %ux%u\n", w, h);
+        } else if (type == SCREEN_STREAM_MSG_FRAME) {
+            if (!screen || screen_stream_apply_frame(p, len, screen, width, height) < 0) {
+                return false;
+            }
+            frame = true;
+        }
+        off += SCREEN_STREAM_HDR_BYTES + len;
+    }
+    memmove(msg, msg + off, msg_len - off);
+    msg_len -= off;
+    if (frame) present();
+    return true;
+}
+
+/* ── Main ────────────────────────────────────────────────── */
+
+int main(int argc, char **argv) {
+    const char *host = argc > 1 ? argv[1] : "127.0.0.1";
+    char port[8];
+    if (argc > 2) snprintf(port, sizeof(port), "%s", argv[2]);
+    else snprintf(port, sizeof(port), "%u", SCREEN_STREAM_DEFAULT_PORT);
+    if (argc > 3) {
+        fprintf(stderr, "Usage: %s [HOST [PORT]]\n", argv[0]);
+        return 1;
+    }
+
+    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+        fprintf(stderr, "SDL initialization failed: %s\n", SDL_GetError());
+        return 1;
+    }
+    window = SDL_CreateWindow("Vitals Monitor - Remote View", SDL_WINDOWPOS_CENTERED,
+                              SDL_WINDOWPOS_CENTERED, 800, 480, SDL_WINDOW_SHOWN);
+    renderer = window ? SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED) : NULL;
+    if (!renderer) {
+        fprintf(stderr, "Window creation failed: %s\n", SDL_GetError());
+        SDL_Quit();
+        return 1;
+    }
+
+    int fd = -1;
+    uint32_t next_attempt = 0;
+    bool running = true;
+    while (running) {
+        SDL_Event e;
+        while (SDL_PollEvent(&e)) {
+            if (e.type == SDL_QUIT) running = false;
+        }
+
+        if (fd < 0) {
+            if (SDL_GetTicks() >= next_attempt) {
+                fd = connect_to(host, port);
+                next_attempt = SDL_GetTicks() + RECONNECT_MS;
+                msg_len = 0;
+                if (fd >= 0) printf("[viewer] Connected to %s:%s\n", host, port);
+            }
+            SDL_Delay(POLL_MS);
+            continue;
+        }
+
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        if (poll(&pfd, 1, POLL_MS) <= 0) continue;
+
+        ssize_t n = recv(fd, msg + msg_len, sizeof(msg) - msg_len, 0);
+        if (n > 0) msg_len += (size_t)n;
+        if (n <= 0 || !handle_messages()) {
+            printf("[viewer] Disconnected\n");
+            close(fd);
+            fd = -1;
+        }
+    }
+
+    if (fd >= 0) close(fd);
+    free(screen);
+    if (texture) SDL_DestroyTexture(texture);
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+    SDL_Quit();
+    return 0;
+}
@@ -15,6 +15,7 @@
 
 #include "ipc_transport.h"
 #include "ipc_messages.h"
+#include "../../core/mem_budget.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -31,6 +32,10 @@
 
 static bool transport_initialized = false;
 
+/* Every subscriber carries its receive buffer */
+MEM_BUDGET_ASSERT(ipc_subscriber, sizeof(ipc_subscriber_t),
+                  MEM_BUDGET_IPC_SUBSCRIBER);
+
 /* ── Transport lifecycle ─────────────────────────────────── */
 
 ipc_error_t ipc_transport_init(void) {
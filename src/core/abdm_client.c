@@ -16,9 +16,9 @@
  */
 
 #include "abdm_client.h"
+#include "vclock.h"
 #include <stdio.h>
 #include <string.h>
-#include <time.h>
 
 /* ── Module tag for printf logging ───────────────────────── */
 
@@ -36,11 +36,7 @@ static int            mock_txn_counter = 5000;
 /* ── Helper: get current epoch ms ────────────────────────── */
 
 static uint64_t now_ms(void) {
-    struct timespec ts;
-    if (clock_gettime(CLOCK_REALTIME, &ts) == 0) {
-        return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
-    }
-    return (uint64_t)time(NULL) * 1000;
+    return vclock_wall_ms();
 }
 
 /* ── Lifecycle ───────────────────────────────────────────── */
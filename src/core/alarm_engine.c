@@ -60,6 +60,18 @@ static alarm_limits_t       limits[ALARM_PARAM_COUNT];
 static bool                 initialized = false;
 static uint32_t             current_time = 0;  /* Cached from last evaluate() */
 
+/* Last reading and the limit it crossed, for transition events */
+static int32_t              cur_value[ALARM_PARAM_COUNT];
+static int32_t              cur_threshold[ALARM_PARAM_COUNT];
+static bool                 cur_crossed[ALARM_PARAM_COUNT];  /* Limit known */
+
+static alarm_event_cb_t     event_cb = NULL;
+static void                *event_cb_data = NULL;
+
+/* Set by alarm_engine_restore(): saved times are relative to this */
+static bool                 rebase_pending = false;
+static uint32_t             rebase_from_s = 0;
+
 /* ── Default thresholds ──────────────────────────────────── */
 
 /* HR: critical >150/<40, warning >120/<50 */
@@ -133,14 +145,23 @@ static alarm_severity_t check_thresholds(alarm_param_t param, int value);
 static void set_state(alarm_param_t param, alarm_state_t new_state);
 static void build_message(alarm_param_t param, alarm_severity_t sev, int value, bool high_side);
 static void update_highest(void);
+static void rebase_times(uint32_t now_s);
+static int32_t crossed_limit(alarm_param_t param, alarm_severity_t sev,
+                             bool high_side);
+static void emit(alarm_param_t param, alarm_event_kind_t kind,
+                 alarm_severity_t sev, uint32_t duration_s);
 
 /* ── Lifecycle ───────────────────────────────────────────── */
 
 void alarm_engine_init(void) {
     memset(&engine_state, 0, sizeof(engine_state));
+    memset(cur_value, 0, sizeof(cur_value));
+    memset(cur_threshold, 0, sizeof(cur_threshold));
+    memset(cur_crossed, 0, sizeof(cur_crossed));
     alarm_engine_reset_defaults();
     initialized = true;
     current_time = 0;
+    rebase_pending = false;
     printf("[alarm_engine] Initialized with default thresholds\n");
 }
 
@@ -156,6 +177,7 @@ void alarm_engine_evaluate(const vitals_data_t *data, uint32_t current_time_s) {
     if (!initialized || !data) return;
 
     current_time = current_time_s;
+    if (rebase_pending) rebase_times(current_time_s);
 
     /* Check audio pause expiry */
     if (engine_state.audio_paused && current_time_s >= engine_state.audio_pause_until_s) {
@@ -197,6 +219,7 @@ bool alarm_engine_acknowledge(alarm_param_t param) {
 
     set_state(param, ALARM_STATE_ACKNOWLEDGED);
     s->ack_time_s = current_time;
+    emit(param, ALARM_EVT_ACK, s->severity, 0);
     update_highest();
     return true;
 }
@@ -221,6 +244,7 @@ bool alarm_engine_silence(alarm_param_t param, uint32_t duration_s) {
 
     set_state(param, ALARM_STATE_SILENCED);
     s->silence_until_s = current_time + duration_s;
+    emit(param, ALARM_EVT_SILENCE, s->severity, duration_s);
     update_highest();
     return true;
 }
@@ -280,6 +304,8 @@ static void evaluate_param(alarm_param_t param, int value, uint32_t time_s) {
     /* Skip disabled parameters */
     if (!lim->enabled) {
         if (s->state != ALARM_STATE_INACTIVE) {
+            emit(param, ALARM_EVT_CLEAR, s->severity,
+                 time_s - s->trigger_time_s);
             set_state(param, ALARM_STATE_INACTIVE);
             s->severity = ALARM_SEV_NONE;
             s->message[0] = '\0';
@@ -302,6 +328,11 @@ static void evaluate_param(alarm_param_t param, int value, uint32_t time_s) {
             high_side = (value > lim->warning_high);
         }
     }
+    cur_value[param] = value;
+    cur_threshold[param] = crossed_limit(param, new_sev, high_side);
+    cur_crossed[param] = new_sev == ALARM_SEV_HIGH || new_sev == ALARM_SEV_MEDIUM;
+    alarm_severity_t old_sev = s->severity;
+    uint32_t active_s = time_s - s->trigger_time_s;
 
     /* State machine transitions */
     switch (s->state) {
@@ -315,21 +346,24 @@ static void evaluate_param(alarm_param_t param, int value, uint32_t time_s) {
             s->silence_until_s = 0;
             build_message(param, new_sev, value, high_side);
             set_state(param, ALARM_STATE_ACTIVE);
+            emit(param, ALARM_EVT_ONSET, new_sev, 0);
         }
         break;
 
     case ALARM_STATE_ACTIVE:
         if (new_sev == ALARM_SEV_NONE) {
             /* ACTIVE -> INACTIVE: vital returned to normal */
+            emit(param, ALARM_EVT_CLEAR, old_sev, active_s);
             s->severity = ALARM_SEV_NONE;
             s->message[0] = '\0';
             set_state(param, ALARM_STATE_INACTIVE);
         } else {
             /* Still active: update severity if it changed (escalation or de-escalation) */
             if (new_sev != s->severity) {
-                alarm_severity_t old_sev = s->severity;
                 s->severity = new_sev;
                 build_message(param, new_sev, value, high_side);
+                emit(param, new_sev > old_sev ? ALARM_EVT_ESCALATE
+                                              : ALARM_EVT_DEESCALATE, new_sev, 0);
                 printf("[alarm_engine] %s severity changed: %s -> %s\n",
                        param_names[param],
                        severity_names[old_sev],
@@ -341,15 +375,17 @@ static void evaluate_param(alarm_param_t param, int value, uint32_t time_s) {
     case ALARM_STATE_ACKNOWLEDGED:
         if (new_sev == ALARM_SEV_NONE) {
             /* ACKNOWLEDGED -> INACTIVE: vital returned to normal */
+            emit(param, ALARM_EVT_CLEAR, old_sev, active_s);
             s->severity = ALARM_SEV_NONE;
             s->message[0] = '\0';
             set_state(param, ALARM_STATE_INACTIVE);
         } else {
             /* Still violated: update severity and message */
             if (new_sev != s->severity) {
-                alarm_severity_t old_sev = s->severity;
                 s->severity = new_sev;
                 build_message(param, new_sev, value, high_side);
+                emit(param, new_sev > old_sev ? ALARM_EVT_ESCALATE
+                                              : ALARM_EVT_DEESCALATE, new_sev, 0);
 
                 /* Escalation to higher severity resets to ACTIVE (re-alert) */
                 if (new_sev > old_sev) {
@@ -368,6 +404,7 @@ static void evaluate_param(alarm_param_t param, int value, uint32_t time_s) {
     case ALARM_STATE_SILENCED:
         if (new_sev == ALARM_SEV_NONE) {
             /* SILENCED -> INACTIVE: vital returned to normal */
+            emit(param, ALARM_EVT_CLEAR, old_sev, active_s);
             s->severity = ALARM_SEV_NONE;
             s->message[0] = '\0';
             s->silence_until_s = 0;
@@ -380,12 +417,17 @@ static void evaluate_param(alarm_param_t param, int value, uint32_t time_s) {
             s->silence_until_s = 0;
             build_message(param, new_sev, value, high_side);
             set_state(param, ALARM_STATE_ACTIVE);
+            emit(param, ALARM_EVT_REALERT, new_sev, 0);
             printf("[alarm_engine] %s silence expired, re-alerting (%s)\n",
                    param_names[param], severity_names[new_sev]);
         } else {
             /* Still silenced: quietly update severity for when silence ends */
             s->severity = new_sev;
             build_message(param, new_sev, value, high_side);
+            if (new_sev != old_sev) {
+                emit(param, new_sev > old_sev ? ALARM_EVT_ESCALATE
+                                              : ALARM_EVT_DEESCALATE, new_sev, 0);
+            }
         }
         break;
     }
@@ -446,6 +488,176 @@ static void build_message(alarm_param_t param, alarm_severity_t sev,
     snprintf(s->message, sizeof(s->message), "%s %s", name, level);
 }
 
+/* ── Transition events ───────────────────────────────────── */
+
+void alarm_engine_set_event_callback(alarm_event_cb_t cb, void *user_data) {
+    event_cb = cb;
+    event_cb_data = user_data;
+}
+
+/** The limit a reading on `high_side` of `param` crossed for `sev`. */
+static int32_t crossed_limit(alarm_param_t param, alarm_severity_t sev,
+                             bool high_side) {
+    const alarm_limits_t *lim = &limits[param];
+    if (sev == ALARM_SEV_HIGH) {
+        return high_side ? lim->critical_high : lim->critical_low;
+    }
+    if (sev == ALARM_SEV_MEDIUM) {
+        return high_side ? lim->warning_high : lim->warning_low;
+    }
+    return 0;
+}
+
+static void emit(alarm_param_t param, alarm_event_kind_t kind,
+                 alarm_severity_t sev, uint32_t duration_s) {
+    if (!event_cb) return;
+    alarm_event_t evt = {
+        .time_s      = current_time,
+        .param       = param,
+        .severity    = sev,
+        .kind        = kind,
+        .value       = cur_value[param],
+        .threshold   = kind == ALARM_EVT_CLEAR ? 0 : cur_threshold[param],
+        .has_reading = kind != ALARM_EVT_CLEAR && cur_crossed[param],
+        .user_id     = 0,
+        .duration_s  = duration_s,
+    };
+    event_cb(&evt, event_cb_data);
+}
+
+/* ── Event text (rendered on display, never stored) ──────── */
+
+/* Appended after "<param> <level>[ <reading>]", indexed by kind */
+static const char *const kind_suffix[ALARM_EVT_KIND_COUNT] = {
+    "",                     /* ONSET */
+    ", escalated",
+    ", de-escalated",
+    " acknowledged",
+    " silenced",
+    ", silence expired",
+    " cleared",
+};
+
+static const char *const level_names[][2] = {
+    /* low side, high side */
+    { "",         ""          },    /* NONE */
+    { "Low",      "High"      },    /* LOW (advisory) */
+    { "Low",      "High"      },    /* MEDIUM */
+    { "Very Low", "Very High" },    /* HIGH */
+};
+
+/* Level when the reading is unknown (converted rows), by severity */
+static const char *const severity_labels[] = {
+    "", "Advisory", "Warning", "Critical",
+};
+
+const char *alarm_engine_param_name(alarm_param_t param) {
+    return (unsigned)param < ALARM_PARAM_COUNT ? param_names[param] : "Alarm";
+}
+
+/** "165" or, for temperature, "38.5" (sign kept: -5 is "-0.5"). */
+static void format_reading(alarm_param_t param, int32_t v, char *buf,
+                           size_t size) {
+    if (param == ALARM_PARAM_TEMP) {
+        int32_t mag = v < 0 ? -v : v;
+        snprintf(buf, size, "%s%d.%d", v < 0 ? "-" : "", (int)(mag / 10),
+                 (int)(mag % 10));
+    } else {
+        snprintf(buf, size, "%d", (int)v);
+    }
+}
+
+int alarm_engine_format_event(const alarm_event_t *evt, char *buf,
+                              size_t size) {
+    if (!evt || !buf || size == 0) return 0;
+    const char *name = alarm_engine_param_name(evt->param);
+    unsigned kind = (unsigned)evt->kind;
+    const char *suffix = kind < ALARM_EVT_KIND_COUNT ? kind_suffix[kind] : "";
+
+    if (evt->kind == ALARM_EVT_CLEAR) {
+        if (evt->duration_s == 0) {
+            return snprintf(buf, size, "%s alarm cleared", name);
+        }
+        return snprintf(buf, size, "%s alarm cleared after %u s", name,
+                        (unsigned)evt->duration_s);
+    }
+
+    /* Level from the reading's side of the limit, else the severity */
+    unsigned sev = (unsigned)evt->severity <= ALARM_SEV_HIGH
+                 ? (unsigned)evt->severity : ALARM_SEV_NONE;
+    const char *level = severity_labels[sev];
+    char reading[32] = "";
+    if (evt->has_reading) {
+        bool high = evt->value > evt->threshold;
+        char v[12], t[12];
+        level = level_names[sev][high];
+        format_reading(evt->param, evt->value, v, sizeof(v));
+        format_reading(evt->param, evt->threshold, t, sizeof(t));
+        snprintf(reading, sizeof(reading), " %s (%c%s)", v, high ? '>' : '<', t);
+    }
+
+    switch (evt->kind) {
+    case ALARM_EVT_ACK:
+        return snprintf(buf, size, "%s %s%s", name, level, suffix);
+    case ALARM_EVT_SILENCE:
+        return snprintf(buf, size, "%s %s%s for %u s", name, level, suffix,
+                        (unsigned)evt->duration_s);
+    default:
+        return snprintf(buf, size, "%s %s%s%s", name, level, reading, suffix);
+    }
+}
+
+/* ── Persistence ─────────────────────────────────────────── */
+
+void alarm_engine_save(alarm_engine_snapshot_t *out) {
+    memset(out, 0, sizeof(*out));
+    memcpy(out->params, engine_state.params, sizeof(out->params));
+    memcpy(out->limits, limits, sizeof(out->limits));
+    out->audio_paused = engine_state.audio_paused;
+    out->audio_pause_until_s = engine_state.audio_pause_until_s;
+    out->time_s = current_time;
+}
+
+void alarm_engine_restore(const alarm_engine_snapshot_t *snap,
+                          uint32_t elapsed_s) {
+    if (!initialized || !snap) return;
+
+    memcpy(engine_state.params, snap->params, sizeof(engine_state.params));
+    memcpy(limits, snap->limits, sizeof(limits));
+    engine_state.audio_paused = snap->audio_paused;
+    engine_state.audio_pause_until_s = snap->audio_pause_until_s;
+    for (int i = 0; i < ALARM_PARAM_COUNT; i++) {
+        char *msg = engine_state.params[i].message;
+        msg[sizeof(engine_state.params[i].message) - 1] = '\0';
+    }
+
+    rebase_pending = true;
+    rebase_from_s = snap->time_s + elapsed_s;
+    update_highest();
+    printf("[alarm_engine] Restored state (%us outage)\n", (unsigned)elapsed_s);
+}
+
+/* ── Private: move restored times onto the current time base ── */
+
+static uint32_t shift_time(uint32_t t, int64_t delta) {
+    if (t == 0) return 0;               /* "Not set" stays unset */
+    int64_t v = (int64_t)t + delta;
+    return v > 0 ? (uint32_t)v : 1;     /* Before the new base: expired */
+}
+
+static void rebase_times(uint32_t now_s) {
+    int64_t delta = (int64_t)now_s - (int64_t)rebase_from_s;
+    for (int i = 0; i < ALARM_PARAM_COUNT; i++) {
+        alarm_status_t *s = &engine_state.params[i];
+        s->trigger_time_s  = shift_time(s->trigger_time_s, delta);
+        s->ack_time_s      = shift_time(s->ack_time_s, delta);
+        s->silence_until_s = shift_time(s->silence_until_s, delta);
+    }
+    engine_state.audio_pause_until_s =
+        shift_time(engine_state.audio_pause_until_s, delta);
+    rebase_pending = false;
+}
+
 /* ── Private: recompute highest_active and highest_any ───── */
 
 static void update_highest(void) {
@@ -24,6 +24,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "vitals_provider.h"    /* vitals_data_t (no LVGL dependency) */
 
 #ifdef __cplusplus
@@ -173,6 +174,78 @@ void alarm_engine_pause_audio(uint32_t duration_s);
 /** Check if alarm audio is currently paused. */
 bool alarm_engine_is_audio_paused(void);
 
+/* ── Transition events ───────────────────────────────────── */
+
+/* Stored as integers in the trend database: append only */
+typedef enum {
+    ALARM_EVT_ONSET = 0,         /* INACTIVE -> ACTIVE                         */
+    ALARM_EVT_ESCALATE,          /* Severity raised while active/acknowledged  */
+    ALARM_EVT_DEESCALATE,        /* Severity lowered while active/acknowledged */
+    ALARM_EVT_ACK,               /* ACTIVE -> ACKNOWLEDGED                     */
+    ALARM_EVT_SILENCE,           /* -> SILENCED                                */
+    ALARM_EVT_REALERT,           /* Silence expired, condition still present   */
+    ALARM_EVT_CLEAR,             /* Returned to normal, or param disabled      */
+    ALARM_EVT_KIND_COUNT
+} alarm_event_kind_t;
+
+/** One state-machine transition.  No text: see alarm_engine_format_event(). */
+typedef struct {
+    uint32_t           time_s;       /* Engine time of the transition          */
+    alarm_param_t      param;        /* ALARM_PARAM_COUNT: unknown (old rows)  */
+    alarm_severity_t   severity;     /* Severity after the transition (CLEAR:
+                                        the severity that cleared)             */
+    alarm_event_kind_t kind;
+    int32_t            value;        /* Measured value, temp x10               */
+    int32_t            threshold;    /* Limit crossed, temp x10                */
+    bool               has_reading;  /* value/threshold valid; false on CLEAR,
+                                        advisories and pre-flag rows           */
+    int32_t            user_id;      /* ACK/SILENCE: operator (0 = none)       */
+    uint32_t           duration_s;   /* SILENCE: length; CLEAR: time since
+                                        onset or the last re-alert         */
+} alarm_event_t;
+
+typedef void (*alarm_event_cb_t)(const alarm_event_t *evt, void *user_data);
+
+/**
+ * Receive every transition as it happens (one callback; NULL removes it).
+ * Called from inside evaluate/acknowledge/silence, on their thread.
+ */
+void alarm_engine_set_event_callback(alarm_event_cb_t cb, void *user_data);
+
+/**
+ * Render an event as display text, e.g. "HR Very High 165 (>150)".
+ * Reads only constant tables, so it is safe from any thread.
+ * @return Length written (snprintf semantics).
+ */
+int alarm_engine_format_event(const alarm_event_t *evt, char *buf,
+                              size_t size);
+
+/** Short parameter name ("SpO2"), or "Alarm" if unknown. */
+const char *alarm_engine_param_name(alarm_param_t param);
+
+/* ── Persistence (crash recovery) ────────────────────────── */
+
+/** Everything needed to resume alarm handling after a restart. */
+typedef struct {
+    alarm_status_t params[ALARM_PARAM_COUNT];
+    alarm_limits_t limits[ALARM_PARAM_COUNT];
+    bool           audio_paused;
+    uint32_t       audio_pause_until_s;
+    uint32_t       time_s;            /* Engine time when saved */
+} alarm_engine_snapshot_t;
+
+/** Copy the current alarm states, limits and audio pause. */
+void alarm_engine_save(alarm_engine_snapshot_t *out);
+
+/**
+ * Resume from a snapshot taken before a restart.  The engine's time base
+ * may restart from zero, so the saved times are moved onto the new one at
+ * the next alarm_engine_evaluate(); `elapsed_s` (the outage) counts
+ * against running silence and audio-pause timers.
+ */
+void alarm_engine_restore(const alarm_engine_snapshot_t *snap,
+                          uint32_t elapsed_s);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,280 @@
+/**
+ * @file alarm_history.c
+ * @brief Paged, newest-first view of a patient's alarm events
+ *
+ * bookmark[k] is the position of the last (oldest) event of page k, so
+ * page k + 1 is "older than bookmark[k]" and page 0 is "older than
+ * TREND_ALARM_CURSOR_NEWEST".  Cache slots are replaced least recently
+ * used first.
+ *
+ * Reads go through one static job on job_pool (as trend_query does).
+ * Requests that arrive while it runs are noted in want_* and started by
+ * its completion, which is also where results enter the view.  Every open
+ * and close bumps `generation`, so a job started for an earlier view is
+ * dropped when it completes.
+ */
+
+#include "alarm_history.h"
+#include "job_pool.h"
+#include <string.h>
+
+/* ── Internal types ──────────────────────────────────────── */
+
+typedef struct {
+    int           page;         /* -1: empty */
+    int           rows;
+    uint32_t      last_used;
+    alarm_event_t events[ALARM_HISTORY_PAGE_ROWS];
+} history_page_t;
+
+typedef struct {
+    uint32_t             generation;
+    bool                 poll;          /* Newest page for poll_new() */
+    int                  page;          /* Else: page number read */
+    int32_t              patient_id;
+    trend_alarm_cursor_t before;
+    int                  rows;          /* -1: read failed */
+    alarm_event_t        events[ALARM_HISTORY_PAGE_ROWS];
+    trend_alarm_cursor_t cursors[ALARM_HISTORY_PAGE_ROWS];
+} history_job_t;
+
+/* ── Module state ────────────────────────────────────────── */
+
+static int32_t              patient = 0;
+static bool                 is_open = false;
+static int                  pages = 0;          /* Pages read so far */
+static int                  count = 0;          /* Events in those pages */
+static bool                 more = false;
+static trend_alarm_cursor_t newest;             /* First event when opened */
+static trend_alarm_cursor_t bookmark[ALARM_HISTORY_MAX_PAGES];
+static history_page_t       cache[ALARM_HISTORY_CACHE_PAGES];
+static uint32_t             use_clock = 0;
+static alarm_history_stats_t stats;
+static int                  fresh = 0;          /* From the last poll */
+
+static history_job_t        job;
+static bool                 job_running = false;
+static uint32_t             generation = 0;
+static bool                 want_more = false;
+static int                  want_page = -1;
+static bool                 want_poll = false;
+
+static alarm_history_cb_t   update_cb = NULL;
+static void                *update_cb_data = NULL;
+
+/* ── Helpers ─────────────────────────────────────────────── */
+
+static bool cursor_after(const trend_alarm_cursor_t *a,
+                         const trend_alarm_cursor_t *b) {
+    return a->timestamp_s > b->timestamp_s ||
+           (a->timestamp_s == b->timestamp_s && a->id > b->id);
+}
+
+static history_page_t *find_page(int page) {
+    for (int i = 0; i < ALARM_HISTORY_CACHE_PAGES; i++) {
+        if (cache[i].page == page) {
+            cache[i].last_used = ++use_clock;
+            return &cache[i];
+        }
+    }
+    return NULL;
+}
+
+/** Copy the job's rows for `page` into the least recently used slot. */
+static void store_page(int page) {
+    history_page_t *slot = &cache[0];
+    for (int i = 1; i < ALARM_HISTORY_CACHE_PAGES; i++) {
+        if (cache[i].last_used < slot->last_used) slot = &cache[i];
+    }
+    slot->page = page;
+    slot->rows = job.rows;
+    slot->last_used = ++use_clock;
+    memcpy(slot->events, job.events, (size_t)job.rows * sizeof(job.events[0]));
+}
+
+/* ── Worker ──────────────────────────────────────────────── */
+
+static void history_job_run(void *arg) {
+    history_job_t *j = (history_job_t *)arg;
+    j->rows = trend_db_query_alarm_page(j->patient_id, &j->before,
+                                        ALARM_HISTORY_PAGE_ROWS, j->events,
+                                        j->cursors);
+}
+
+/* ── Completion (LVGL thread) ────────────────────────────── */
+
+static void start_next(void);
+
+/** Fold a finished read into the view. @return true if the view changed. */
+static bool apply_job(void) {
+    if (job.poll) {
+        int n = 0;
+        while (n < job.rows && (count == 0 ||
+                                cursor_after(&job.cursors[n], &newest))) {
+            n++;
+        }
+        bool changed = job.rows >= 0 && n != fresh;
+        if (job.rows >= 0) fresh = n;
+        return changed;
+    }
+
+    stats.page_reads++;
+    if (job.rows < 0) return false;         /* Failed: `more` stays set */
+
+    if (job.page < pages) {                 /* Re-read of a known page */
+        store_page(job.page);
+        return true;
+    }
+    if (job.rows == 0) {                    /* Read to the end */
+        more = false;
+        return true;
+    }
+    bookmark[job.page] = job.cursors[job.rows - 1];
+    if (job.page == 0) newest = job.cursors[0];
+    store_page(job.page);
+    pages++;
+    count += job.rows;
+    if (job.rows < ALARM_HISTORY_PAGE_ROWS) more = false;
+    return true;
+}
+
+static void history_job_done(void *arg) {
+    (void)arg;
+    job_running = false;
+    bool changed = job.generation == generation && is_open && apply_job();
+    start_next();
+    if (changed && update_cb) update_cb(update_cb_data);
+}
+
+/** Launch the most urgent wanted read, if the job is free. */
+static void start_next(void) {
+    if (job_running || !is_open) return;
+
+    int page = want_page;
+    want_page = -1;
+    if (page >= 0 && page < pages && !find_page(page)) {
+        job.poll = false;
+        job.page = page;
+    } else if (want_more && more && pages < ALARM_HISTORY_MAX_PAGES) {
+        want_more = false;
+        job.poll = false;
+        job.page = pages;
+    } else if (want_poll) {
+        want_poll = false;
+        job.poll = true;
+        job.page = 0;
+    } else {
+        want_more = false;
+        return;
+    }
+
+    job.generation = generation;
+    job.patient_id = patient;
+    job.before = (job.poll || job.page == 0) ? TREND_ALARM_CURSOR_NEWEST
+                                             : bookmark[job.page - 1];
+    job_running = true;
+    if (!job_pool_submit(JOB_PRIO_HIGH, history_job_run, history_job_done,
+                         &job)) {
+        if (job_pool_is_running()) {
+            /* Pool full: keep the request for the next call */
+            job_running = false;
+            if (job.poll) {
+                want_poll = true;
+            } else if (job.page < pages) {
+                want_page = job.page;
+            } else {
+                want_more = true;
+            }
+            return;
+        }
+        /* Pool unavailable: run inline (blocks, but stays correct) */
+        history_job_run(&job);
+        history_job_done(&job);
+    }
+}
+
+/* ── Public API ──────────────────────────────────────────── */
+
+void alarm_history_set_callback(alarm_history_cb_t cb, void *user_data) {
+    update_cb = cb;
+    update_cb_data = user_data;
+}
+
+void alarm_history_open(int32_t patient_id) {
+    alarm_history_close();
+    patient = patient_id;
+    is_open = true;
+    more = true;
+    alarm_history_load_more();
+}
+
+void alarm_history_close(void) {
+    generation++;
+    is_open = false;
+    pages = 0;
+    count = 0;
+    more = false;
+    fresh = 0;
+    use_clock = 0;
+    want_more = false;
+    want_page = -1;
+    want_poll = false;
+    memset(&newest, 0, sizeof(newest));
+    memset(&stats, 0, sizeof(stats));
+    for (int i = 0; i < ALARM_HISTORY_CACHE_PAGES; i++) {
+        cache[i].page = -1;
+        cache[i].rows = 0;
+        cache[i].last_used = 0;
+    }
+}
+
+int alarm_history_count(void) {
+    return count;
+}
+
+bool alarm_history_has_more(void) {
+    return more;
+}
+
+bool alarm_history_load_more(void) {
+    if (!is_open || !more) return false;
+    if (pages >= ALARM_HISTORY_MAX_PAGES) {
+        more = false;
+        return false;
+    }
+    if (job_running && !job.poll && job.page == pages) return true;
+    want_more = true;
+    start_next();
+    return true;
+}
+
+const alarm_event_t *alarm_history_get(int index) {
+    if (!is_open || index < 0 || index >= count) return NULL;
+    int page = index / ALARM_HISTORY_PAGE_ROWS;
+    int row  = index % ALARM_HISTORY_PAGE_ROWS;
+
+    history_page_t *p = find_page(page);
+    if (p) {
+        stats.cache_hits++;
+    } else {
+        want_page = page;
+        start_next();
+        p = find_page(page);            /* Present if the read ran inline */
+    }
+    return (p && row < p->rows) ? &p->events[row] : NULL;
+}
+
+int alarm_history_poll_new(void) {
+    if (!is_open) return 0;
+    want_poll = true;
+    start_next();
+    return fresh;
+}
+
+bool alarm_history_busy(void) {
+    return job_running;
+}
+
+alarm_history_stats_t alarm_history_get_stats(void) {
+    return stats;
+}
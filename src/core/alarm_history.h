@@ -0,0 +1,111 @@
+/**
+ * @file alarm_history.h
+ * @brief Paged, newest-first view of a patient's alarm events
+ *
+ * The alarms screen scrolls through up to 72 hours of alarm_events.  This
+ * module answers "event number i, counting back from the newest" without
+ * holding the history in memory:
+ *
+ *   - Pages of ALARM_HISTORY_PAGE_ROWS events are read with
+ *     trend_db_query_alarm_page(), each starting from the (timestamp, id)
+ *     bookmark where the previous page ended.  A page deep in the history
+ *     costs the same single index seek as the first one (no OFFSET scan).
+ *   - One bookmark per page is kept, so a page seen before is re-read
+ *     directly when scrolled back to.  The last ALARM_HISTORY_CACHE_PAGES
+ *     pages read stay decoded.
+ *   - The history grows one page at a time as the reader asks for more,
+ *     up to ALARM_HISTORY_MAX_PAGES.
+ *
+ * Memory is fixed (about 12 KB) however long the history is.  Events
+ * recorded after alarm_history_open() are not in the view: poll for them
+ * with alarm_history_poll_new() and reopen.
+ *
+ * Reads run on job_pool, one at a time, so a page never holds up the LVGL
+ * thread behind trend queries or an export on the reader lock.  Calls
+ * return at once with what is already in the view; a read's result is
+ * applied on the LVGL thread from job_pool_dispatch_completions(), which
+ * then invokes the alarm_history_set_callback() callback.  A read that
+ * fails changes nothing and is retried on the next call that wants it.
+ * Without a running pool reads run inline and results are there on return.
+ *
+ * Call from the LVGL thread.
+ */
+
+#ifndef ALARM_HISTORY_H
+#define ALARM_HISTORY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "trend_db.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ── Constants ─────────────────────────────────────────────── */
+
+#define ALARM_HISTORY_PAGE_ROWS    32
+#define ALARM_HISTORY_MAX_PAGES    512     /* 16384 events */
+#define ALARM_HISTORY_CACHE_PAGES  2
+
+/* ── Types ─────────────────────────────────────────────────── */
+
+/** The view grew, a page arrived, or the poll_new() count changed. */
+typedef void (*alarm_history_cb_t)(void *user_data);
+
+typedef struct {
+    uint32_t page_reads;        /* trend_db page queries since open */
+    uint32_t cache_hits;        /* alarm_history_get() without a query */
+} alarm_history_stats_t;
+
+/* ── API ───────────────────────────────────────────────────── */
+
+/** Callback for completed reads (LVGL thread).  NULL to stop. */
+void alarm_history_set_callback(alarm_history_cb_t cb, void *user_data);
+
+/** Start a view of `patient_id`'s history and request its newest page. */
+void alarm_history_open(int32_t patient_id);
+
+/** Forget the view (alarm_history_count() returns 0 until reopened). */
+void alarm_history_close(void);
+
+/** Events in the pages read so far. */
+int alarm_history_count(void);
+
+/** True while older events may exist beyond alarm_history_count(). */
+bool alarm_history_has_more(void);
+
+/**
+ * Request the next older page.  alarm_history_has_more() turns false only
+ * once a read comes back short; a failed read leaves it set.
+ * @return false at the end of the history or at ALARM_HISTORY_MAX_PAGES.
+ */
+bool alarm_history_load_more(void);
+
+/**
+ * Event `index` (0 = newest when opened).  A page not cached is requested
+ * and the callback fires when it arrives.  The pointer is valid until the
+ * next call into this module or completion.
+ * @return NULL if index is outside [0, alarm_history_count()), its page is
+ *         still being read, or the event has since been purged.
+ */
+const alarm_event_t *alarm_history_get(int index);
+
+/**
+ * Number of events recorded since alarm_history_open() (at most
+ * ALARM_HISTORY_PAGE_ROWS) as of the last completed poll, without changing
+ * the view.  Starts another poll.
+ */
+int alarm_history_poll_new(void);
+
+/** True while a read is queued or running. */
+bool alarm_history_busy(void);
+
+/** Query counters since the last open. */
+alarm_history_stats_t alarm_history_get_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ALARM_HISTORY_H */
@@ -10,11 +10,12 @@
  */
 
 #include "audit_log.h"
+#include "db_schema.h"
+#include "vclock.h"
 #include "sqlite3.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdarg.h>
-#include <time.h>
 
 /* ── Retention ───────────────────────────────────────────── */
 
@@ -145,12 +146,8 @@ bool audit_log_init(const char *db_path) {
     sqlite3_exec(db, "PRAGMA journal_mode=WAL;", NULL, NULL, NULL);
     sqlite3_exec(db, "PRAGMA synchronous=NORMAL;", NULL, NULL, NULL);
 
-    /* Create tables and indexes */
-    char *err_msg = NULL;
-    rc = sqlite3_exec(db, SCHEMA_SQL, NULL, NULL, &err_msg);
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "[audit_log] Schema creation failed: %s\n", err_msg);
-        sqlite3_free(err_msg);
+    /* Create tables and indexes (skipped once the file is stamped current) */
+    if (!db_schema_ensure(db, DB_SCHEMA_AUDIT, SCHEMA_SQL, "audit_log")) {
         sqlite3_close(db);
         db = NULL;
         return false;
@@ -219,7 +216,7 @@ void audit_log_record(audit_event_t event, const char *username,
     const char *user = username ? username : "system";
     const char *msg  = message  ? message  : "";
 
-    uint32_t ts = (uint32_t)time(NULL);
+    uint32_t ts = (uint32_t)vclock_wall_s();
 
     sqlite3_reset(stmt_insert);
     sqlite3_bind_int(stmt_insert, 1, (int)event);
@@ -313,7 +310,7 @@ void audit_log_purge_old(uint32_t max_age_s) {
     if (!db || !stmt_purge) return;
 
     uint32_t age = (max_age_s > 0) ? max_age_s : AUDIT_DEFAULT_RETENTION_S;
-    uint32_t now = (uint32_t)time(NULL);
+    uint32_t now = (uint32_t)vclock_wall_s();
     uint32_t cutoff = (now > age) ? now - age : 0;
 
     sqlite3_reset(stmt_purge);
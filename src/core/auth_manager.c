@@ -11,6 +11,7 @@
  */
 
 #include "auth_manager.h"
+#include "db_schema.h"
 #include "sqlite3.h"
 #include <stdio.h>
 #include <string.h>
@@ -276,12 +277,8 @@ bool auth_manager_init(const char *db_path) {
     sqlite3_exec(db, "PRAGMA journal_mode=WAL;", NULL, NULL, NULL);
     sqlite3_exec(db, "PRAGMA synchronous=NORMAL;", NULL, NULL, NULL);
 
-    /* Create tables */
-    char *err_msg = NULL;
-    rc = sqlite3_exec(db, SCHEMA_SQL, NULL, NULL, &err_msg);
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "[auth_manager] Schema creation failed: %s\n", err_msg);
-        sqlite3_free(err_msg);
+    /* Create tables (skipped once the file is stamped current) */
+    if (!db_schema_ensure(db, DB_SCHEMA_AUTH, SCHEMA_SQL, "auth_manager")) {
         sqlite3_close(db);
         db = NULL;
         return false;
@@ -0,0 +1,329 @@
+/**
+ * @file data_thread.c
+ * @brief Data thread — periodic task loop, call queue, CPU pinning
+ *
+ * `lock` guards the task table and the wake/stop flags; it is released
+ * while a task or call runs, so data_thread_add_task() and
+ * data_thread_call() never wait behind a slow SQLite write.  Tasks are
+ * only ever appended, so an index stays valid while the lock is dropped.
+ *
+ * A task that overruns its period is not run back to back to catch up:
+ * the missed periods are counted in `skipped` and the next run is
+ * scheduled on the original grid.
+ *
+ * Scheduling follows vclock application time; run times are measured on
+ * the real clock.  Sleeping uses a condition variable so a queued call
+ * wakes the thread at once.  The timed wait is computed from monotonic
+ * deadlines but expressed in CLOCK_REALTIME, which every pthread
+ * implementation supports for pthread_cond_timedwait().  That wait is
+ * real time, so under a virtual clock tasks run inline only.
+ */
+
+#define _GNU_SOURCE             /* pthread_setaffinity_np, CPU_SET */
+#include "data_thread.h"
+#include "msg_queue.h"
+#include "vclock.h"
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* ── Internal types ──────────────────────────────────────── */
+
+typedef struct {
+    data_task_fn_t    fn;
+    uint64_t          next_due_us;
+    data_task_stats_t stats;
+} task_t;
+
+typedef struct {
+    data_call_fn_t fn;
+    void          *arg;
+} call_t;
+
+/* ── Module state ────────────────────────────────────────── */
+
+static pthread_mutex_t lock    = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  wake_cv = PTHREAD_COND_INITIALIZER;
+
+static task_t      tasks[DATA_THREAD_MAX_TASKS];
+static int         task_count = 0;
+
+static msg_queue_t calls;
+static call_t      call_buf[DATA_THREAD_MAX_CALLS];
+
+static bool        running = false;
+static bool        threaded = false;
+static bool        stopping = false;
+static bool        wake_pending = false;
+static pthread_t   thread;
+
+/* Thread currently running tasks (the data thread, or a poll() caller) */
+static pthread_t   runner;
+static bool        runner_set = false;
+
+/* ── Helpers ─────────────────────────────────────────────── */
+
+/** Absolute CLOCK_REALTIME time `wait_us` from now. */
+static struct timespec realtime_in(uint64_t wait_us) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    uint64_t ns = (uint64_t)ts.tv_nsec + (wait_us % 1000000ULL) * 1000ULL;
+    ts.tv_sec += (time_t)(wait_us / 1000000ULL + ns / 1000000000ULL);
+    ts.tv_nsec = (long)(ns % 1000000000ULL);
+    return ts;
+}
+
+static void run_calls(void) {
+    call_t c;
+    while (msg_queue_pop(&calls, &c)) {
+        c.fn(c.arg);
+    }
+}
+
+/**
+ * Run queued calls, then every task that is due.
+ * @return Monotonic time the next task is due (UINT64_MAX: no tasks).
+ */
+static uint64_t run_due(void) {
+    run_calls();
+
+    pthread_mutex_lock(&lock);
+    for (int i = 0; i < task_count; i++) {
+        task_t *t = &tasks[i];
+        uint64_t t0 = vclock_mono_us();
+        if (t0 < t->next_due_us) continue;
+
+        uint64_t due = t->next_due_us;
+        data_task_fn_t fn = t->fn;
+        pthread_mutex_unlock(&lock);
+        uint64_t r0 = vclock_real_us();
+        fn(due);
+        uint32_t run = (uint32_t)(vclock_real_us() - r0);
+        uint64_t t1 = vclock_mono_us();
+        pthread_mutex_lock(&lock);
+
+        uint32_t late = (uint32_t)(t0 - due);
+        t->stats.runs++;
+        if (run > t->stats.max_run_us) t->stats.max_run_us = run;
+        if (late > t->stats.max_late_us) t->stats.max_late_us = late;
+
+        /* Stay on the original grid; skip periods already missed */
+        uint64_t period = (uint64_t)t->stats.period_ms * 1000ULL;
+        t->next_due_us = due + period;
+        if (t->next_due_us <= t1) {
+            uint64_t missed = (t1 - t->next_due_us) / period + 1;
+            t->stats.skipped += (uint32_t)missed;
+            t->next_due_us += missed * period;
+        }
+    }
+
+    uint64_t next = UINT64_MAX;
+    for (int i = 0; i < task_count; i++) {
+        if (tasks[i].next_due_us < next) next = tasks[i].next_due_us;
+    }
+    pthread_mutex_unlock(&lock);
+    return next;
+}
+
+/* ── Data thread ─────────────────────────────────────────── */
+
+static void set_runner(bool set) {
+    pthread_mutex_lock(&lock);
+    runner = pthread_self();
+    runner_set = set;
+    pthread_mutex_unlock(&lock);
+}
+
+static void *thread_main(void *arg) {
+    (void)arg;
+    set_runner(true);
+    data_thread_pin_current(DATA_THREAD_CPU);
+
+    for (;;) {
+        uint64_t next = run_due();
+
+        pthread_mutex_lock(&lock);
+        while (!stopping && !wake_pending) {
+            uint64_t now = vclock_mono_us();
+            if (now >= next) break;
+            struct timespec ts = realtime_in(next - now);
+            if (pthread_cond_timedwait(&wake_cv, &lock, &ts) == ETIMEDOUT) {
+                break;
+            }
+        }
+        wake_pending = false;
+        bool stop = stopping;
+        pthread_mutex_unlock(&lock);
+        if (stop) break;
+    }
+    return NULL;
+}
+
+/* ── Setup ───────────────────────────────────────────────── */
+
+int data_thread_add_task(const char *name, uint32_t period_ms,
+                         data_task_fn_t fn) {
+    if (!fn || period_ms == 0) return -1;
+
+    pthread_mutex_lock(&lock);
+    if (task_count >= DATA_THREAD_MAX_TASKS) {
+        pthread_mutex_unlock(&lock);
+        fprintf(stderr, "[data_thread] Task table full, '%s' not added\n",
+                name ? name : "?");
+        return -1;
+    }
+    int id = task_count++;
+    task_t *t = &tasks[id];
+    memset(t, 0, sizeof(*t));
+    t->fn = fn;
+    t->stats.name = name ? name : "?";
+    t->stats.period_ms = period_ms;
+    t->next_due_us = vclock_mono_us() + (uint64_t)period_ms * 1000ULL;
+    wake_pending = true;        /* Sleep may now be too long */
+    pthread_cond_signal(&wake_cv);
+    pthread_mutex_unlock(&lock);
+    return id;
+}
+
+bool data_thread_start(bool own_thread) {
+    if (running) return true;
+    if (own_thread && vclock_is_virtual()) {
+        printf("[data_thread] Virtual clock: running inline\n");
+        own_thread = false;
+    }
+
+    msg_queue_init(&calls, call_buf, sizeof(call_t), DATA_THREAD_MAX_CALLS);
+
+    pthread_mutex_lock(&lock);
+    uint64_t now = vclock_mono_us();
+    for (int i = 0; i < task_count; i++) {
+        tasks[i].next_due_us = now + (uint64_t)tasks[i].stats.period_ms * 1000ULL;
+    }
+    stopping = false;
+    wake_pending = false;
+    threaded = own_thread;
+    running = true;
+    pthread_mutex_unlock(&lock);
+
+    if (own_thread) {
+        if (pthread_create(&thread, NULL, thread_main, NULL) != 0) {
+            fprintf(stderr, "[data_thread] Cannot create thread\n");
+            running = false;
+            msg_queue_destroy(&calls);
+            return false;
+        }
+    }
+    printf("[data_thread] Started (%s, %d tasks)\n",
+           own_thread ? "own thread" : "inline", task_count);
+    return true;
+}
+
+void data_thread_stop(void) {
+    if (!running) return;
+
+    if (threaded) {
+        pthread_mutex_lock(&lock);
+        stopping = true;
+        pthread_cond_signal(&wake_cv);
+        pthread_mutex_unlock(&lock);
+        pthread_join(thread, NULL);
+    }
+    set_runner(false);
+    run_calls();
+
+    pthread_mutex_lock(&lock);
+    running = false;
+    threaded = false;
+    task_count = 0;
+    pthread_mutex_unlock(&lock);
+    msg_queue_destroy(&calls);
+    printf("[data_thread] Stopped\n");
+}
+
+bool data_thread_is_running(void) {
+    return running;
+}
+
+bool data_thread_is_current(void) {
+    pthread_mutex_lock(&lock);
+    bool current = runner_set && pthread_equal(pthread_self(), runner);
+    pthread_mutex_unlock(&lock);
+    return current;
+}
+
+/* ── Inline mode ─────────────────────────────────────────── */
+
+uint32_t data_thread_poll(void) {
+    if (!running || threaded) return UINT32_MAX;
+
+    set_runner(true);
+    uint64_t next = run_due();
+    set_runner(false);
+
+    uint64_t now = vclock_mono_us();
+    if (next <= now) return 0;
+    uint64_t ms = (next - now + 999) / 1000;
+    return ms > UINT32_MAX ? UINT32_MAX : (uint32_t)ms;
+}
+
+/* ── Messages ────────────────────────────────────────────── */
+
+bool data_thread_call(data_call_fn_t fn, void *arg) {
+    if (!running || !fn) return false;
+    call_t c = { .fn = fn, .arg = arg };
+    if (!msg_queue_push(&calls, &c)) {
+        fprintf(stderr, "[data_thread] Call queue full\n");
+        return false;
+    }
+    pthread_mutex_lock(&lock);
+    wake_pending = true;
+    pthread_cond_signal(&wake_cv);
+    pthread_mutex_unlock(&lock);
+    return true;
+}
+
+/* ── Threads and cores ───────────────────────────────────── */
+
+bool data_thread_pin_current(int cpu) {
+#ifdef __linux__
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpu < 0 || cpu >= cpus) {
+        printf("[data_thread] No CPU %d to pin to (%ld online)\n", cpu, cpus);
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (rc != 0) {
+        fprintf(stderr, "[data_thread] Cannot pin to CPU %d (%s)\n",
+                cpu, strerror(rc));
+        return false;
+    }
+    return true;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+/* ── Statistics ──────────────────────────────────────────── */
+
+bool data_thread_get_task_stats(int id, data_task_stats_t *out) {
+    pthread_mutex_lock(&lock);
+    bool ok = id >= 0 && id < task_count;
+    if (ok && out) *out = tasks[id].stats;
+    pthread_mutex_unlock(&lock);
+    return ok;
+}
+
+int data_thread_task_count(void) {
+    pthread_mutex_lock(&lock);
+    int n = task_count;
+    pthread_mutex_unlock(&lock);
+    return n;
+}
@@ -0,0 +1,144 @@
+/**
+ * @file data_thread.h
+ * @brief Data thread: vitals, alarms and storage beside the render thread
+ *
+ * The two Cortex-A7 cores are split by role:
+ *
+ *   - Render thread (DATA_THREAD_RENDER_CPU): input, lv_timer_handler()
+ *     and the display.  LVGL is built with LV_USE_OS = LV_OS_PTHREAD;
+ *     lv_timer_handler() holds lv_lock() while it runs, and any other code
+ *     that touches LVGL objects must hold it too.  Only this thread does.
+ *   - Data thread (DATA_THREAD_CPU): periodic tasks registered with
+ *     data_thread_add_task() — vitals acquisition, alarm evaluation, trend
+ *     storage, waveform synthesis, crash-recovery snapshots.  It never
+ *     touches LVGL, so a slow frame cannot delay an alarm and a slow
+ *     SQLite write cannot drop a frame.
+ *
+ * The threads share no mutable state; they exchange messages:
+ *
+ *   - render -> data: data_thread_call() queues a function to run on the
+ *     data thread (alarm acknowledge / silence), which wakes it at once.
+ *   - data -> render: tasks push results into a msg_queue the render loop
+ *     drains once per pass (see main.c), as with job_pool completions.
+ *   - Current values (latest vitals, alarm summary) are read from
+ *     status_board, whose seqlocked records the data thread writes.
+ *
+ * job_pool workers are not pinned and run wherever a core is idle.
+ *
+ * Inline mode: data_thread_start(false) runs no thread.  Tasks and calls
+ * then run from data_thread_poll() on the caller, i.e. between frames as
+ * LVGL timers did before the split; the simulator builds that way with
+ * VM_DATA_THREAD=OFF for before/after timing, and always runs inline
+ * under a virtual clock (see vclock.h).
+ *
+ * Static allocation: task table and call queue are fixed-size.
+ * No LVGL dependency.
+ */
+
+#ifndef DATA_THREAD_H
+#define DATA_THREAD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ── Constants ─────────────────────────────────────────────── */
+
+#define DATA_THREAD_MAX_TASKS   8
+#define DATA_THREAD_MAX_CALLS   16      /* Queued data_thread_call()s */
+#define DATA_THREAD_RENDER_CPU  0
+#define DATA_THREAD_CPU         1
+
+/* ── Types ─────────────────────────────────────────────────── */
+
+/**
+ * Periodic task body.  `due_us` is the vclock_mono_us() time it was
+ * scheduled for; now minus due_us is how late it started.
+ */
+typedef void (*data_task_fn_t)(uint64_t due_us);
+
+/** Function run on the data thread by data_thread_call(). */
+typedef void (*data_call_fn_t)(void *arg);
+
+typedef struct {
+    const char *name;
+    uint32_t    period_ms;
+    uint32_t    runs;
+    uint32_t    skipped;        /* Periods missed because a run overran */
+    uint32_t    max_run_us;
+    uint32_t    max_late_us;    /* Start after due time */
+} data_task_stats_t;
+
+/* ── Setup ─────────────────────────────────────────────────── */
+
+/**
+ * Register a task running every `period_ms`, first one period from now
+ * (or from data_thread_start() if it is not running yet).  Any thread.
+ * @return Task id, or -1 if the table is full or an argument is invalid.
+ */
+int data_thread_add_task(const char *name, uint32_t period_ms,
+                         data_task_fn_t fn);
+
+/**
+ * Start running tasks.
+ * @param own_thread  true: spawn the data thread pinned to DATA_THREAD_CPU.
+ *                    false: inline mode, call data_thread_poll().
+ *                    Inline regardless under a virtual clock.
+ * @return false if the thread cannot be created.
+ */
+bool data_thread_start(bool own_thread);
+
+/**
+ * Stop the thread (after its current task) and join it, then run any
+ * calls still queued on the caller.  Registered tasks are forgotten.
+ * Call from the render thread.
+ */
+void data_thread_stop(void);
+
+/** True between data_thread_start() and data_thread_stop(). */
+bool data_thread_is_running(void);
+
+/** True on the data thread (or, in inline mode, inside data_thread_poll()). */
+bool data_thread_is_current(void);
+
+/* ── Inline mode ───────────────────────────────────────────── */
+
+/**
+ * Run queued calls and every task that is due.  No-op when the data
+ * thread is running.
+ * @return Milliseconds until the next task is due (for the caller's sleep).
+ */
+uint32_t data_thread_poll(void);
+
+/* ── Messages (render -> data) ─────────────────────────────── */
+
+/**
+ * Queue fn(arg) to run on the data thread after the task in progress.
+ * @return false if not running or DATA_THREAD_MAX_CALLS are waiting.
+ */
+bool data_thread_call(data_call_fn_t fn, void *arg);
+
+/* ── Threads and cores ─────────────────────────────────────── */
+
+/**
+ * Pin the calling thread to `cpu` (Linux; a no-op elsewhere).
+ * @return false if the core does not exist or pinning is unsupported.
+ */
+bool data_thread_pin_current(int cpu);
+
+/* ── Statistics ────────────────────────────────────────────── */
+
+/** Counters of task `id`.  @return false for an unknown id. */
+bool data_thread_get_task_stats(int id, data_task_stats_t *out);
+
+/** Number of registered tasks. */
+int data_thread_task_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DATA_THREAD_H */
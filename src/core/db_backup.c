@@ -0,0 +1,364 @@
+/**
+ * @file db_backup.c
+ * @brief Online database backup — sqlite3_backup in job_pool slices
+ *
+ * One run at a time.  The source and destination connections and the
+ * sqlite3_backup handle live in module state and are used by one slice
+ * at a time; a slice is only queued by the previous slice's completion,
+ * so they are never touched by two threads at once.  The LVGL thread
+ * only touches `status` (under status_lock) and the request flags.
+ *
+ * Slice lifecycle:
+ *   start -> slice (open, snapshot, step...) -> done() -> next slice ...
+ *         -> last slice (verify, rename) -> done() -> callback
+ *
+ * Pausing ends the source read transaction, so the snapshot no longer
+ * pins the WAL.  The first slice after resume takes a new one; if the
+ * source changed in between, SQLite resets the source pager and with it
+ * the backup, which then copies again from the first page.
+ */
+
+#include "db_backup.h"
+#include "job_pool.h"
+#include "vclock.h"
+#include "sqlite3.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#define BUSY_WAIT_US  5000      /* Back-off when the source is locked */
+
+/* ── Internal types ──────────────────────────────────────── */
+
+typedef enum {
+    PHASE_COPY = 0,             /* Slices still to run */
+    PHASE_FINISHED,             /* `result` holds the outcome */
+} backup_phase_t;
+
+typedef struct {
+    char                src[DB_BACKUP_PATH_MAX];
+    char                dest[DB_BACKUP_PATH_MAX];
+    char                part[DB_BACKUP_PATH_MAX + 8];
+    uint32_t            budget_bps;
+    db_backup_done_cb_t cb;
+    void               *user_data;
+    /* Worker side */
+    sqlite3            *src_db;
+    sqlite3            *dest_db;
+    sqlite3_backup     *bk;
+    int                 page_size;
+    bool                snapshot;   /* Source read transaction open */
+    backup_phase_t      phase;
+    db_backup_state_t   result;
+} backup_run_t;
+
+/* ── Module state ────────────────────────────────────────── */
+
+static backup_run_t run;
+static bool         run_active = false;     /* start .. callback */
+static bool         slice_queued = false;
+static bool         pause_requested = false;
+static bool         cancel_requested = false;
+
+static pthread_mutex_t    status_lock = PTHREAD_MUTEX_INITIALIZER;
+static db_backup_status_t status;
+
+/* ── Helpers ─────────────────────────────────────────────── */
+
+static void set_state(db_backup_state_t state) {
+    pthread_mutex_lock(&status_lock);
+    status.state = state;
+    pthread_mutex_unlock(&status_lock);
+}
+
+static void publish_progress(backup_run_t *r) {
+    int total = sqlite3_backup_pagecount(r->bk);
+    int left  = sqlite3_backup_remaining(r->bk);
+
+    pthread_mutex_lock(&status_lock);
+    if (total > 0) {
+        status.pages_total = (uint32_t)total;
+        status.pages_done  = (uint32_t)(total - left);
+        status.percent = (uint8_t)((uint64_t)status.pages_done * 100 /
+                                   (uint32_t)total);
+    }
+    status.slices++;
+    pthread_mutex_unlock(&status_lock);
+}
+
+/** End the source read transaction, letting checkpoints pass it. */
+static void release_snapshot(backup_run_t *r) {
+    if (r->snapshot) {
+        sqlite3_exec(r->src_db, "COMMIT;", NULL, NULL, NULL);
+        r->snapshot = false;
+    }
+}
+
+/** Release both connections; the source read snapshot ends here. */
+static void close_run(backup_run_t *r) {
+    if (r->bk) {
+        sqlite3_backup_finish(r->bk);
+        r->bk = NULL;
+    }
+    if (r->src_db) {
+        release_snapshot(r);
+        sqlite3_close(r->src_db);
+        r->src_db = NULL;
+    }
+    if (r->dest_db) {
+        sqlite3_close(r->dest_db);
+        r->dest_db = NULL;
+    }
+}
+
+static void finish(backup_run_t *r, db_backup_state_t result) {
+    close_run(r);
+    if (result != DB_BACKUP_DONE) unlink(r->part);
+    r->result = result;
+    r->phase = PHASE_FINISHED;
+}
+
+/* ── Worker ──────────────────────────────────────────────── */
+
+/**
+ * Pin the source snapshot.  A read transaction held on the source
+ * connection keeps every step reading the same version of the file, so
+ * commits from other connections never restart the copy.
+ */
+static bool take_snapshot(backup_run_t *r) {
+    /* BEGIN is deferred: the first read is what takes the snapshot */
+    r->snapshot = sqlite3_exec(r->src_db,
+                               "BEGIN; SELECT COUNT(*) FROM sqlite_master;",
+                               NULL, NULL, NULL) == SQLITE_OK;
+    if (!r->snapshot) {
+        fprintf(stderr, "[db_backup] Cannot read %s: %s\n", r->src,
+                sqlite3_errmsg(r->src_db));
+        sqlite3_exec(r->src_db, "ROLLBACK;", NULL, NULL, NULL);
+    }
+    return r->snapshot;
+}
+
+/** Open both databases and take the first snapshot. */
+static bool open_run(backup_run_t *r) {
+    unlink(r->part);
+    if (sqlite3_open_v2(r->src, &r->src_db, SQLITE_OPEN_READONLY, NULL)
+            != SQLITE_OK) {
+        fprintf(stderr, "[db_backup] Cannot open %s: %s\n", r->src,
+                sqlite3_errmsg(r->src_db));
+        return false;
+    }
+    if (sqlite3_open(r->part, &r->dest_db) != SQLITE_OK) {
+        fprintf(stderr, "[db_backup] Cannot create %s: %s\n", r->part,
+                sqlite3_errmsg(r->dest_db));
+        return false;
+    }
+    sqlite3_busy_timeout(r->src_db, 1000);
+    if (!take_snapshot(r)) return false;
+
+    sqlite3_stmt *st = NULL;
+    bool ok = sqlite3_prepare_v2(r->src_db, "PRAGMA page_size;", -1, &st,
+                                 NULL) == SQLITE_OK &&
+              sqlite3_step(st) == SQLITE_ROW;
+    r->page_size = ok ? sqlite3_column_int(st, 0) : 0;
+    sqlite3_finalize(st);
+    if (!ok || r->page_size <= 0) {
+        fprintf(stderr, "[db_backup] Cannot read %s: %s\n", r->src,
+                sqlite3_errmsg(r->src_db));
+        return false;
+    }
+
+    r->bk = sqlite3_backup_init(r->dest_db, "main", r->src_db, "main");
+    if (!r->bk) {
+        fprintf(stderr, "[db_backup] Backup init failed: %s\n",
+                sqlite3_errmsg(r->dest_db));
+        return false;
+    }
+    return true;
+}
+
+/** After the last page: check the copy, then replace the old backup. */
+static db_backup_state_t verify_and_publish(backup_run_t *r) {
+    sqlite3_backup_finish(r->bk);
+    r->bk = NULL;
+
+    /* A NULL result (e.g. out of memory) counts as a failed check */
+    sqlite3_stmt *st = NULL;
+    const char *verdict = NULL;
+    if (sqlite3_prepare_v2(r->dest_db, "PRAGMA integrity_check;", -1,
+                           &st, NULL) == SQLITE_OK &&
+        sqlite3_step(st) == SQLITE_ROW) {
+        verdict = (const char *)sqlite3_column_text(st, 0);
+    }
+    bool ok = verdict && strcmp(verdict, "ok") == 0;
+    sqlite3_finalize(st);
+    close_run(r);
+
+    if (!ok) {
+        fprintf(stderr, "[db_backup] Integrity check failed on %s\n", r->part);
+        return DB_BACKUP_FAILED;
+    }
+    if (rename(r->part, r->dest) != 0) {
+        fprintf(stderr, "[db_backup] Cannot replace %s\n", r->dest);
+        return DB_BACKUP_FAILED;
+    }
+    return DB_BACKUP_DONE;
+}
+
+static void slice_run(void *arg) {
+    backup_run_t *r = (backup_run_t *)arg;
+
+    if (!r->bk && !open_run(r)) {
+        finish(r, DB_BACKUP_FAILED);
+        return;
+    }
+    /* Resumed after a pause */
+    if (!r->snapshot && !take_snapshot(r)) {
+        finish(r, DB_BACKUP_FAILED);
+        return;
+    }
+
+    uint64_t deadline = vclock_real_us() + (uint64_t)DB_BACKUP_SLICE_MS * 1000;
+    uint64_t step_us = (uint64_t)DB_BACKUP_STEP_PAGES * (uint64_t)r->page_size *
+                       1000000ULL / r->budget_bps;
+
+    while (vclock_real_us() < deadline) {
+        if (__atomic_load_n(&cancel_requested, __ATOMIC_ACQUIRE)) {
+            finish(r, DB_BACKUP_CANCELLED);
+            return;
+        }
+
+        uint64_t t0 = vclock_real_us();
+        int rc = sqlite3_backup_step(r->bk, DB_BACKUP_STEP_PAGES);
+        if (rc == SQLITE_DONE) {
+            publish_progress(r);
+            db_backup_state_t result = verify_and_publish(r);
+            finish(r, result);
+            return;
+        }
+        if (rc == SQLITE_BUSY || rc == SQLITE_LOCKED) {
+            usleep(BUSY_WAIT_US);
+            continue;
+        }
+        if (rc != SQLITE_OK) {
+            fprintf(stderr, "[db_backup] Step failed: %s\n",
+                    sqlite3_errstr(rc));
+            finish(r, DB_BACKUP_FAILED);
+            return;
+        }
+
+        /* Pace to the I/O budget */
+        uint64_t spent = vclock_real_us() - t0;
+        if (spent < step_us) usleep((useconds_t)(step_us - spent));
+    }
+    publish_progress(r);
+}
+
+/* ── Completion (LVGL thread) ────────────────────────────── */
+
+static void slice_done(void *arg);
+
+static bool queue_slice(void) {
+    slice_queued = job_pool_submit(JOB_PRIO_LOW, slice_run, slice_done, &run);
+    return slice_queued;
+}
+
+static void slice_done(void *arg) {
+    backup_run_t *r = (backup_run_t *)arg;
+    slice_queued = false;
+
+    if (r->phase == PHASE_COPY) {
+        if (pause_requested || !queue_slice()) {
+            /* A full or stopped pool pauses the run as well.  No slice
+             * is queued, so the connection is ours to use here. */
+            release_snapshot(r);
+            set_state(DB_BACKUP_PAUSED);
+            printf("[db_backup] Paused\n");
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&status_lock);
+    status.state = r->result;
+    db_backup_status_t final = status;
+    pthread_mutex_unlock(&status_lock);
+
+    run_active = false;
+    printf("[db_backup] %s: %u pages in %u slices (%s)\n",
+           r->result == DB_BACKUP_DONE ? "Done" :
+           r->result == DB_BACKUP_CANCELLED ? "Cancelled" : "Failed",
+           (unsigned)final.pages_total, (unsigned)final.slices, r->dest);
+    if (r->cb) r->cb(&final, r->user_data);
+}
+
+/* ── Public API ──────────────────────────────────────────── */
+
+bool db_backup_start(const char *src_path, const char *dest_path,
+                     uint32_t budget_bps, db_backup_done_cb_t cb,
+                     void *user_data) {
+    if (run_active || !src_path || !dest_path) return false;
+    if (strlen(src_path) >= DB_BACKUP_PATH_MAX ||
+        strlen(dest_path) >= DB_BACKUP_PATH_MAX) return false;
+
+    memset(&run, 0, sizeof(run));
+    strcpy(run.src, src_path);
+    strcpy(run.dest, dest_path);
+    snprintf(run.part, sizeof(run.part), "%s.part", dest_path);
+    run.budget_bps = budget_bps ? budget_bps : DB_BACKUP_DEFAULT_BPS;
+    run.cb = cb;
+    run.user_data = user_data;
+    run.phase = PHASE_COPY;
+
+    pthread_mutex_lock(&status_lock);
+    memset(&status, 0, sizeof(status));
+    status.state = DB_BACKUP_RUNNING;
+    strcpy(status.dest, dest_path);
+    pthread_mutex_unlock(&status_lock);
+
+    pause_requested = false;
+    __atomic_store_n(&cancel_requested, false, __ATOMIC_RELEASE);
+
+    if (!queue_slice()) {
+        set_state(DB_BACKUP_IDLE);
+        return false;
+    }
+    run_active = true;
+    printf("[db_backup] Backing up %s to %s (%u B/s)\n",
+           src_path, dest_path, (unsigned)run.budget_bps);
+    return true;
+}
+
+void db_backup_pause(void) {
+    if (run_active) pause_requested = true;
+}
+
+bool db_backup_resume(void) {
+    pause_requested = false;
+    if (!run_active) return false;
+    if (slice_queued) return true;      /* Pause not reached yet */
+    if (!queue_slice()) return false;
+    set_state(DB_BACKUP_RUNNING);
+    printf("[db_backup] Resumed\n");
+    return true;
+}
+
+void db_backup_cancel(void) {
+    if (!run_active) return;
+    __atomic_store_n(&cancel_requested, true, __ATOMIC_RELEASE);
+    /* A paused run has no slice to notice the flag */
+    if (!slice_queued) {
+        finish(&run, DB_BACKUP_CANCELLED);
+        slice_done(&run);
+    }
+}
+
+bool db_backup_busy(void) {
+    return run_active;
+}
+
+db_backup_status_t db_backup_get_status(void) {
+    pthread_mutex_lock(&status_lock);
+    db_backup_status_t s = status;
+    pthread_mutex_unlock(&status_lock);
+    return s;
+}
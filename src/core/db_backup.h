@@ -0,0 +1,107 @@
+/**
+ * @file db_backup.h
+ * @brief Online backup of the data partition's SQLite database
+ *
+ * Copies a live WAL database to a second file (secondary partition or USB
+ * stick) with sqlite3_backup_step(), without stopping the writers:
+ *
+ *   - The copy reads through its own read-only connection, which holds a
+ *     single read snapshot for the whole run.  Writers on other
+ *     connections are never blocked and never force the copy to restart;
+ *     the backup reflects the database as of its first slice.
+ *   - Work is done in job_pool slices of at most DB_BACKUP_SLICE_MS.  The
+ *     worker is released between slices, so trend queries (JOB_PRIO_HIGH)
+ *     are never stuck behind a backup.
+ *   - Pages are copied DB_BACKUP_STEP_PAGES at a time and paced to an I/O
+ *     budget in bytes per second.
+ *   - A run can be paused and resumed.  A paused run holds no snapshot,
+ *     so checkpoints reset the WAL as usual however long the pause.  On
+ *     resume the copy continues where it left off if the database is
+ *     unchanged, and starts again from a new snapshot if it was written
+ *     to meanwhile.
+ *   - The copy is written to "<dest>.part", checked with
+ *     PRAGMA integrity_check and only then renamed over <dest>, so the
+ *     previous good backup survives a cancelled, failed or interrupted run.
+ *
+ * While a backup runs, WAL checkpoints cannot move past its snapshot, so
+ * the WAL grows by whatever is written in that time.  Pick the budget so
+ * a run takes minutes, not hours.
+ */
+
+#ifndef DB_BACKUP_H
+#define DB_BACKUP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ── Constants ─────────────────────────────────────────────── */
+
+#define DB_BACKUP_PATH_MAX      128
+#define DB_BACKUP_STEP_PAGES    16      /* Pages per sqlite3_backup_step */
+#define DB_BACKUP_SLICE_MS      200     /* Worker time per slice */
+#define DB_BACKUP_DEFAULT_BPS   (512u * 1024u)
+
+/* ── Types ─────────────────────────────────────────────────── */
+
+typedef enum {
+    DB_BACKUP_IDLE = 0,
+    DB_BACKUP_RUNNING,
+    DB_BACKUP_PAUSED,
+    DB_BACKUP_DONE,
+    DB_BACKUP_CANCELLED,
+    DB_BACKUP_FAILED,
+} db_backup_state_t;
+
+typedef struct {
+    db_backup_state_t state;
+    uint8_t  percent;
+    uint32_t pages_done;
+    uint32_t pages_total;           /* 0 until the first slice has run */
+    uint32_t slices;
+    char     dest[DB_BACKUP_PATH_MAX];
+} db_backup_status_t;
+
+/** Completion callback (LVGL thread). */
+typedef void (*db_backup_done_cb_t)(const db_backup_status_t *status,
+                                    void *user_data);
+
+/* ── API (LVGL thread) ─────────────────────────────────────── */
+
+/**
+ * Start backing up `src_path` to `dest_path`.
+ * @param budget_bps  I/O budget in bytes per second (0 = default).
+ * @return false if a backup is already running or paused, the arguments
+ *         are invalid or the job pool is not running.  Errors opening
+ *         either database are reported as DB_BACKUP_FAILED.
+ */
+bool db_backup_start(const char *src_path, const char *dest_path,
+                     uint32_t budget_bps, db_backup_done_cb_t cb,
+                     void *user_data);
+
+/** Stop queuing slices; the run becomes PAUSED after the current one. */
+void db_backup_pause(void);
+
+/**
+ * Continue a paused run, from a new snapshot.
+ * @return false if nothing is paused.
+ */
+bool db_backup_resume(void);
+
+/** Abandon the run after the current slice; <dest> is left untouched. */
+void db_backup_cancel(void);
+
+/** True from start until the completion callback has run. */
+bool db_backup_busy(void);
+
+/** Snapshot of the current (or last finished) run.  Any thread. */
+db_backup_status_t db_backup_get_status(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DB_BACKUP_H */
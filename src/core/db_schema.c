@@ -0,0 +1,79 @@
+/**
+ * @file db_schema.c
+ * @brief Schema stamp for the shared SQLite database file
+ *
+ * Each module calls in from its own connection during init.  The stamp is
+ * read-modified-written inside BEGIN IMMEDIATE, so two connections marking
+ * different bits cannot lose each other's update.
+ */
+
+#include "db_schema.h"
+#include <stdio.h>
+
+#define PART_MASK       0xFFFFu
+#define VERSION_SHIFT   16
+
+/* ── Helpers ─────────────────────────────────────────────── */
+
+static bool read_stamp(sqlite3 *db, uint32_t *out) {
+    sqlite3_stmt *st = NULL;
+    bool ok = sqlite3_prepare_v2(db, "PRAGMA user_version;", -1, &st,
+                                 NULL) == SQLITE_OK &&
+              sqlite3_step(st) == SQLITE_ROW;
+    if (ok) *out = (uint32_t)sqlite3_column_int64(st, 0);
+    sqlite3_finalize(st);
+    return ok;
+}
+
+/** Module bits of `stamp`, or 0 if it belongs to another version. */
+static uint32_t current_parts(uint32_t stamp) {
+    if ((stamp >> VERSION_SHIFT) != DB_SCHEMA_VERSION) return 0;
+    return stamp & PART_MASK;
+}
+
+/* ── Public API ──────────────────────────────────────────── */
+
+bool db_schema_is_current(sqlite3 *db, db_schema_part_t part) {
+    uint32_t stamp;
+    if (!db || !read_stamp(db, &stamp)) return false;
+    return (current_parts(stamp) & (uint32_t)part) != 0;
+}
+
+bool db_schema_mark_current(sqlite3 *db, db_schema_part_t part) {
+    if (!db) return false;
+    if (sqlite3_exec(db, "BEGIN IMMEDIATE;", NULL, NULL, NULL) != SQLITE_OK) {
+        return false;
+    }
+
+    uint32_t stamp = 0;
+    bool ok = read_stamp(db, &stamp);
+    if (ok) {
+        uint32_t parts = current_parts(stamp) | (uint32_t)part;
+        char sql[48];
+        snprintf(sql, sizeof(sql), "PRAGMA user_version=%u;",
+                 (unsigned)(((uint32_t)DB_SCHEMA_VERSION << VERSION_SHIFT) |
+                            parts));
+        ok = sqlite3_exec(db, sql, NULL, NULL, NULL) == SQLITE_OK;
+    }
+    if (!ok || sqlite3_exec(db, "COMMIT;", NULL, NULL, NULL) != SQLITE_OK) {
+        sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
+        return false;
+    }
+    return true;
+}
+
+bool db_schema_ensure(sqlite3 *db, db_schema_part_t part, const char *ddl,
+                      const char *tag) {
+    if (db_schema_is_current(db, part)) return true;
+
+    char *err_msg = NULL;
+    if (sqlite3_exec(db, ddl, NULL, NULL, &err_msg) != SQLITE_OK) {
+        fprintf(stderr, "[%s] Schema creation failed: %s\n", tag,
+                err_msg ? err_msg : sqlite3_errmsg(db));
+        sqlite3_free(err_msg);
+        return false;
+    }
+    /* An unwritten stamp only means the script runs again next boot */
+    db_schema_mark_current(db, part);
+    return true;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file db_schema.h
+ * @brief Schema stamp for the shared SQLite database file
+ *
+ * trend_db, patient_data, settings_store, auth_manager, audit_log and
+ * sync_queue each create their own tables in the same file.  Running every
+ * module's CREATE ... IF NOT EXISTS script on every boot costs a parse and
+ * a write transaction per module, so the file's PRAGMA user_version records
+ * which modules' schemas are already in place:
+ *
+ *   bits  0..15   one bit per module (db_schema_part_t)
+ *   bits 16..30   DB_SCHEMA_VERSION the bits refer to
+ *
+ * A module skips its DDL (and any one-off upgrades that come with it) when
+ * its bit is set for the current version, and sets the bit once its
+ * schema is complete.  A file stamped by a different DB_SCHEMA_VERSION has
+ * all bits treated as clear, so every module re-runs its script.
+ *
+ * Bump DB_SCHEMA_VERSION whenever any module's schema changes.
+ *
+ * No LVGL dependency (pure data layer).
+ */
+
+#ifndef DB_SCHEMA_H
+#define DB_SCHEMA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sqlite3.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ── Constants ─────────────────────────────────────────────── */
+
+#define DB_SCHEMA_VERSION   3
+
+/* ── Types ─────────────────────────────────────────────────── */
+
+/** Owner bits in the user_version stamp. */
+typedef enum {
+    DB_SCHEMA_TREND    = 1u << 0,
+    DB_SCHEMA_PATIENT  = 1u << 1,
+    DB_SCHEMA_SETTINGS = 1u << 2,
+    DB_SCHEMA_AUTH     = 1u << 3,
+    DB_SCHEMA_AUDIT    = 1u << 4,
+    DB_SCHEMA_SYNC     = 1u << 5,
+} db_schema_part_t;
+
+/* ── API ───────────────────────────────────────────────────── */
+
+/** True if `part`'s schema is stamped as current in `db`'s file. */
+bool db_schema_is_current(sqlite3 *db, db_schema_part_t part);
+
+/**
+ * Record that `part`'s schema is complete.  Keeps the other modules' bits
+ * if the stamp is for the current version, clears them otherwise.
+ * @return false if the stamp could not be written.
+ */
+bool db_schema_mark_current(sqlite3 *db, db_schema_part_t part);
+
+/**
+ * Run `ddl` unless `part` is already current, then stamp it.
+ * @param tag  Log prefix of the calling module, e.g. "settings".
+ * @return false if the DDL failed (the error is logged under `tag`).
+ */
+bool db_schema_ensure(sqlite3 *db, db_schema_part_t part, const char *ddl,
+                      const char *tag);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DB_SCHEMA_H */
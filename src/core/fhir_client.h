@@ -18,7 +18,9 @@
  *   BP Systolic:   8480-6
  *   BP Diastolic:  8462-4
  *
- * Thread safety: All calls are single-threaded (LVGL main loop).
+ * Thread safety: Single-threaded (LVGL main loop), except that exports
+ * issued by sync_queue_process_async() run on one job_pool worker at a
+ * time.
  */
 
 #ifndef FHIR_CLIENT_H
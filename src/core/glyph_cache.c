@@ -0,0 +1,196 @@
+/**
+ * @file glyph_cache.c
+ * @brief Rasterized text cache — hash buckets, LRU list, tlsf storage
+ *
+ * One tlsf block per entry: caller space, then the bitmap, then the key.
+ * Unused entries are chained through `chain` from free_head.
+ * Only evictable entries are on the LRU list: pinned ones never join it
+ * and referenced ones leave it until their last unref, so eviction always
+ * takes the tail.
+ */
+
+#include "glyph_cache.h"
+#include <string.h>
+
+#define NONE        (-1)
+#define ALIGN8(x)   (((x) + 7) & ~(size_t)7)
+
+/* ── Helpers ─────────────────────────────────────────────── */
+
+static uint32_t hash_key(uint32_t font_id, const char *key) {
+    uint32_t h = 2166136261u ^ font_id;         /* FNV-1a */
+    for (const char *p = key; *p; p++) {
+        h ^= (uint8_t)*p;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static int16_t index_of(const glyph_cache_t *c, const glyph_bitmap_t *bm) {
+    return (int16_t)((const glyph_cache_entry_t *)bm - c->entries);
+}
+
+static void lru_unlink(glyph_cache_t *c, int16_t i) {
+    glyph_cache_entry_t *e = &c->entries[i];
+    if (e->lru_prev != NONE) c->entries[e->lru_prev].lru_next = e->lru_next;
+    else if (c->lru_head == i) c->lru_head = e->lru_next;
+    if (e->lru_next != NONE) c->entries[e->lru_next].lru_prev = e->lru_prev;
+    else if (c->lru_tail == i) c->lru_tail = e->lru_prev;
+    e->lru_prev = e->lru_next = NONE;
+}
+
+static void lru_push_head(glyph_cache_t *c, int16_t i) {
+    glyph_cache_entry_t *e = &c->entries[i];
+    e->lru_prev = NONE;
+    e->lru_next = c->lru_head;
+    if (c->lru_head != NONE) c->entries[c->lru_head].lru_prev = i;
+    c->lru_head = i;
+    if (c->lru_tail == NONE) c->lru_tail = i;
+}
+
+static bool on_lru(const glyph_cache_entry_t *e) {
+    return !e->pinned && e->refs == 0;
+}
+
+static void evict(glyph_cache_t *c, int16_t i) {
+    glyph_cache_entry_t *e = &c->entries[i];
+    if (c->on_evict) c->on_evict(&e->bm, c->user_data);
+
+    lru_unlink(c, i);
+    int16_t *link = &c->buckets[e->hash & (GLYPH_CACHE_BUCKETS - 1)];
+    while (*link != i) link = &c->entries[*link].chain;
+    *link = e->chain;
+
+    tlsf_free(&c->pool, e->block);
+    memset(e, 0, sizeof(*e));
+    e->chain = c->free_head;
+    c->free_head = i;
+    c->stats.entries--;
+    c->stats.evictions++;
+}
+
+/** Unused entry off the free list, or NONE. */
+static int16_t free_slot(glyph_cache_t *c) {
+    int16_t i = c->free_head;
+    if (i != NONE) c->free_head = c->entries[i].chain;
+    return i;
+}
+
+/* ── Public API ──────────────────────────────────────────── */
+
+bool glyph_cache_init(glyph_cache_t *c, void *mem, size_t bytes,
+                      glyph_cache_evict_cb_t on_evict, void *user_data) {
+    memset(c, 0, sizeof(*c));
+    if (!tlsf_init(&c->pool, mem, bytes)) return false;
+    for (int i = 0; i < GLYPH_CACHE_BUCKETS; i++) c->buckets[i] = NONE;
+    for (int i = 0; i < GLYPH_CACHE_MAX_ENTRIES; i++) {
+        c->entries[i].chain = (int16_t)(i + 1 < GLYPH_CACHE_MAX_ENTRIES ? i + 1 : NONE);
+    }
+    c->free_head = 0;
+    c->lru_head = c->lru_tail = NONE;
+    c->on_evict = on_evict;
+    c->user_data = user_data;
+    c->stats.capacity = c->pool.capacity;
+    return true;
+}
+
+glyph_bitmap_t *glyph_cache_find(glyph_cache_t *c, uint32_t font_id, const char *key) {
+    uint32_t h = hash_key(font_id, key);
+    for (int16_t i = c->buckets[h & (GLYPH_CACHE_BUCKETS - 1)]; i != NONE;
+         i = c->entries[i].chain) {
+        glyph_cache_entry_t *e = &c->entries[i];
+        if (e->hash == h && e->font_id == font_id && strcmp(e->key, key) == 0) {
+            if (on_lru(e)) {
+                lru_unlink(c, i);
+                lru_push_head(c, i);
+            }
+            c->stats.hits++;
+            return &e->bm;
+        }
+    }
+    c->stats.misses++;
+    return NULL;
+}
+
+glyph_bitmap_t *glyph_cache_add(glyph_cache_t *c, uint32_t font_id, const char *key,
+                                uint16_t w, uint16_t h, size_t user_bytes,
+                                uint8_t flags) {
+    size_t key_len = strlen(key) + 1;
+    if (key_len > GLYPH_CACHE_KEY_MAX) {
+        c->stats.rejected++;
+        return NULL;
+    }
+
+    size_t user = ALIGN8(user_bytes);
+    size_t bitmap = (size_t)w * h;
+    size_t need = user + bitmap + key_len;
+
+    /* Room for the entry, then for its memory */
+    int16_t slot = free_slot(c);
+    while (slot == NONE && c->lru_tail != NONE) {
+        evict(c, c->lru_tail);
+        slot = free_slot(c);
+    }
+    void *block = slot != NONE ? tlsf_malloc(&c->pool, need, 0) : NULL;
+    while (!block && slot != NONE && c->lru_tail != NONE) {
+        evict(c, c->lru_tail);
+        block = tlsf_malloc(&c->pool, need, 0);
+    }
+    if (!block) {
+        if (slot != NONE) {
+            c->entries[slot].chain = c->free_head;
+            c->free_head = slot;
+        }
+        c->stats.rejected++;
+        return NULL;
+    }
+
+    uint8_t *base = block;
+    memset(base, 0, user + bitmap);
+    memcpy(base + user + bitmap, key, key_len);
+
+    glyph_cache_entry_t *e = &c->entries[slot];
+    e->bm.w = w;
+    e->bm.h = h;
+    e->bm.stride = w;
+    e->bm.data = base + user;
+    e->bm.user = user_bytes ? base : NULL;
+    e->key = (const char *)(base + user + bitmap);
+    e->font_id = font_id;
+    e->hash = hash_key(font_id, key);
+    e->refs = 0;
+    e->used = true;
+    e->pinned = (flags & GLYPH_CACHE_PIN) != 0;
+    e->block = block;
+    e->lru_prev = e->lru_next = NONE;
+
+    int16_t *bucket = &c->buckets[e->hash & (GLYPH_CACHE_BUCKETS - 1)];
+    e->chain = *bucket;
+    *bucket = slot;
+
+    if (e->pinned) c->stats.pinned++;
+    else lru_push_head(c, slot);
+    c->stats.entries++;
+    return &e->bm;
+}
+
+void glyph_cache_ref(glyph_cache_t *c, glyph_bitmap_t *bm) {
+    int16_t i = index_of(c, bm);
+    glyph_cache_entry_t *e = &c->entries[i];
+    if (on_lru(e)) lru_unlink(c, i);
+    e->refs++;
+}
+
+void glyph_cache_unref(glyph_cache_t *c, glyph_bitmap_t *bm) {
+    int16_t i = index_of(c, bm);
+    glyph_cache_entry_t *e = &c->entries[i];
+    if (e->refs == 0) return;
+    e->refs--;
+    if (on_lru(e)) lru_push_head(c, i);
+}
+
+glyph_cache_stats_t glyph_cache_get_stats(const glyph_cache_t *c) {
+    glyph_cache_stats_t s = c->stats;
+    s.bytes = c->pool.used;
+    return s;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file glyph_cache.h
+ * @brief Rasterized text cache: A8 bitmaps with LRU eviction in a fixed budget
+ *
+ * Holds pre-rendered 8-bit coverage bitmaps keyed by (font, string): single
+ * glyphs of the large numeric fonts, and whole static labels — for scripts
+ * such as Devanagari, the label after shaping, so neither shaping nor
+ * rasterization is repeated.  theme_vitals.h fills and uses it.
+ *
+ * Storage is a caller-supplied buffer managed by tlsf; when an entry does
+ * not fit, least recently used entries are evicted until it does.  Two
+ * kinds of entry are never evicted:
+ *   - pinned entries (GLYPH_CACHE_PIN), e.g. numerals rendered at startup;
+ *   - referenced entries (glyph_cache_ref()), e.g. a label bitmap an image
+ *     on screen points to, until the matching glyph_cache_unref().
+ *
+ * Lookup is a hash probe; add and evict are O(1) apart from the bitmap
+ * allocation.  Not thread-safe (render thread).  No LVGL dependency.
+ */
+
+#ifndef GLYPH_CACHE_H
+#define GLYPH_CACHE_H
+
+#include "tlsf.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ── Configuration ─────────────────────────────────────────── */
+
+#define GLYPH_CACHE_MAX_ENTRIES     256
+#define GLYPH_CACHE_BUCKETS         128     /* Power of two */
+#define GLYPH_CACHE_KEY_MAX         96      /* Bytes of UTF-8, with the NUL */
+
+#define GLYPH_CACHE_PIN             0x01    /* glyph_cache_add() flag */
+
+/* ── Types ─────────────────────────────────────────────────── */
+
+/** A cached bitmap.  `data` and `user` stay valid until it is evicted. */
+typedef struct {
+    uint16_t w;
+    uint16_t h;
+    uint16_t stride;                /* Bytes per row */
+    uint8_t *data;                  /* A8 coverage, stride * h bytes */
+    void    *user;                  /* user_bytes of caller space */
+} glyph_bitmap_t;
+
+typedef struct glyph_cache_entry glyph_cache_entry_t;
+
+/** Called before an entry's memory is reused (drop references to it). */
+typedef void (*glyph_cache_evict_cb_t)(glyph_bitmap_t *bm, void *user_data);
+
+struct glyph_cache_entry {
+    glyph_bitmap_t bm;              /* First: handles cast back to entries */
+    const char    *key;
+    uint32_t       font_id;
+    uint32_t       hash;
+    int16_t        lru_prev;        /* Toward most recent; -1: none */
+    int16_t        lru_next;
+    int16_t        chain;           /* Next in the hash bucket or free list */
+    uint16_t       refs;
+    bool           used;
+    bool           pinned;
+    void          *block;           /* tlsf allocation */
+};
+
+typedef struct {
+    uint32_t entries;
+    uint32_t pinned;
+    size_t   bytes;                 /* Pool bytes in use */
+    size_t   capacity;
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+    uint32_t rejected;              /* Adds that could not be made to fit */
+} glyph_cache_stats_t;
+
+/** Cache state; treat as opaque. */
+typedef struct {
+    tlsf_t                 pool;
+    glyph_cache_entry_t    entries[GLYPH_CACHE_MAX_ENTRIES];
+    int16_t                buckets[GLYPH_CACHE_BUCKETS];
+    int16_t                lru_head;        /* Most recently used */
+    int16_t                lru_tail;
+    int16_t                free_head;       /* Unused entries */
+    glyph_cache_evict_cb_t on_evict;
+    void                  *user_data;
+    glyph_cache_stats_t    stats;
+} glyph_cache_t;
+
+/* ── API ───────────────────────────────────────────────────── */
+
+/**
+ * Set up an empty cache storing bitmaps in `mem` (owned by the caller).
+ * @param on_evict  Optional; see glyph_cache_evict_cb_t.
+ * @return false if `mem` is too small for tlsf.
+ */
+bool glyph_cache_init(glyph_cache_t *c, void *mem, size_t bytes,
+                      glyph_cache_evict_cb_t on_evict, void *user_data);
+
+/**
+ * Look up a bitmap and mark it most recently used.
+ * @return NULL on a miss.
+ */
+glyph_bitmap_t *glyph_cache_find(glyph_cache_t *c, uint32_t font_id, const char *key);
+
+/**
+ * Add an entry with a zeroed w x h bitmap and `user_bytes` of caller
+ * space (8-byte aligned), evicting as needed.  The key must not be
+ * present already.
+ * @param flags  GLYPH_CACHE_PIN or 0.
+ * @return NULL if it cannot fit (key too long, or the budget is taken by
+ *         pinned and referenced entries).
+ */
+glyph_bitmap_t *glyph_cache_add(glyph_cache_t *c, uint32_t font_id, const char *key,
+                                uint16_t w, uint16_t h, size_t user_bytes,
+                                uint8_t flags);
+
+/** Keep `bm` from being evicted while something displays it. */
+void glyph_cache_ref(glyph_cache_t *c, glyph_bitmap_t *bm);
+
+/** Drop a reference taken with glyph_cache_ref(). */
+void glyph_cache_unref(glyph_cache_t *c, glyph_bitmap_t *bm);
+
+/** Counters and occupancy. */
+glyph_cache_stats_t glyph_cache_get_stats(const glyph_cache_t *c);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GLYPH_CACHE_H */
@@ -0,0 +1,199 @@
+/**
+ * @file gzip_writer.c
+ * @brief Streaming gzip (RFC 1952) compressor with bounded memory
+ */
+
+#include "gzip_writer.h"
+#include "crc32.h"
+#include <string.h>
+
+#define HASH_SIZE   (1 << GZIP_WRITER_HASH_BITS)
+#define NO_POS      0xFFFF
+#define MIN_MATCH   3
+#define MAX_MATCH   258
+#define MAX_CHAIN   16          /* Candidates tried per position */
+
+/* ── Deflate tables (RFC 1951 3.2.5) ─────────────────────── */
+
+static const uint16_t LEN_BASE[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t LEN_EXTRA[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t DIST_BASE[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+    8193, 12289, 16385, 24577
+};
+static const uint8_t DIST_EXTRA[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+/* ── Output ──────────────────────────────────────────────── */
+
+static void flush_out(gzip_writer_t *g) {
+    if (g->out_len == 0) return;
+    if (g->ok && !g->sink(g->out, g->out_len, g->ctx)) g->ok = false;
+    g->bytes_out += g->out_len;
+    g->out_len = 0;
+}
+
+static void put_byte(gzip_writer_t *g, uint8_t b) {
+    if (g->out_len == GZIP_WRITER_OUT) flush_out(g);
+    g->out[g->out_len++] = b;
+}
+
+/** Append `n` bits of `value`, least significant first. */
+static void put_bits(gzip_writer_t *g, uint32_t value, int n) {
+    g->bitbuf |= value << g->bitcnt;
+    g->bitcnt += n;
+    while (g->bitcnt >= 8) {
+        put_byte(g, (uint8_t)g->bitbuf);
+        g->bitbuf >>= 8;
+        g->bitcnt -= 8;
+    }
+}
+
+/** Huffman codes are defined most significant bit first. */
+static void put_code(gzip_writer_t *g, uint32_t code, int len) {
+    uint32_t rev = 0;
+    for (int i = 0; i < len; i++) {
+        rev = (rev << 1) | (code & 1);
+        code >>= 1;
+    }
+    put_bits(g, rev, len);
+}
+
+static void put_litlen(gzip_writer_t *g, int sym) {
+    if (sym < 144)      put_code(g, 0x30 + (uint32_t)sym, 8);
+    else if (sym < 256) put_code(g, 0x190 + (uint32_t)(sym - 144), 9);
+    else if (sym < 280) put_code(g, (uint32_t)(sym - 256), 7);
+    else                put_code(g, 0xC0 + (uint32_t)(sym - 280), 8);
+}
+
+static void put_match(gzip_writer_t *g, int len, int dist) {
+    int li = 28;
+    while (LEN_BASE[li] > len) li--;
+    put_litlen(g, 257 + li);
+    put_bits(g, (uint32_t)(len - LEN_BASE[li]), LEN_EXTRA[li]);
+
+    int di = 29;
+    while (DIST_BASE[di] > dist) di--;
+    put_code(g, (uint32_t)di, 5);
+    put_bits(g, (uint32_t)(dist - DIST_BASE[di]), DIST_EXTRA[di]);
+}
+
+/* ── Block compression ───────────────────────────────────── */
+
+static uint32_t hash3(const uint8_t *p) {
+    uint32_t v = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+    return (v * 2654435761u) >> (32 - GZIP_WRITER_HASH_BITS);
+}
+
+static void insert_pos(gzip_writer_t *g, size_t i) {
+    uint32_t h = hash3(g->in + i);
+    g->prev[i] = g->head[h];
+    g->head[h] = (uint16_t)i;
+}
+
+/** Emit the buffered input as one fixed-Huffman deflate block. */
+static void compress_block(gzip_writer_t *g, bool final) {
+    const uint8_t *in = g->in;
+    size_t n = g->in_len;
+
+    put_bits(g, final ? 1 : 0, 1);
+    put_bits(g, 1, 2);                      /* BTYPE 01: fixed codes */
+    memset(g->head, 0xFF, sizeof(g->head));
+
+    size_t i = 0;
+    while (i < n) {
+        int best_len = 0;
+        size_t best_pos = 0;
+
+        if (i + MIN_MATCH <= n) {
+            size_t limit = n - i;
+            if (limit > MAX_MATCH) limit = MAX_MATCH;
+
+            uint16_t cand = g->head[hash3(in + i)];
+            for (int chain = 0; cand != NO_POS && chain < MAX_CHAIN; chain++) {
+                size_t l = 0;
+                while (l < limit && in[cand + l] == in[i + l]) l++;
+                if ((int)l > best_len) {
+                    best_len = (int)l;
+                    best_pos = cand;
+                    if (l == limit) break;
+                }
+                cand = g->prev[cand];
+            }
+            insert_pos(g, i);
+        }
+
+        if (best_len >= MIN_MATCH) {
+            put_match(g, best_len, (int)(i - best_pos));
+            for (size_t k = i + 1; k < i + (size_t)best_len; k++) {
+                if (k + MIN_MATCH <= n) insert_pos(g, k);
+            }
+            i += (size_t)best_len;
+        } else {
+            put_litlen(g, in[i]);
+            i++;
+        }
+    }
+    put_litlen(g, 256);                     /* End of block */
+    g->in_len = 0;
+}
+
+/* ── API ─────────────────────────────────────────────────── */
+
+bool gzip_writer_init(gzip_writer_t *g, gzip_sink_fn_t sink, void *ctx) {
+    static const uint8_t header[10] = {
+        0x1F, 0x8B, 8, 0,           /* magic, deflate, no flags */
+        0, 0, 0, 0,                 /* no mtime */
+        0, 3                        /* no extra flags, Unix */
+    };
+
+    g->sink = sink;
+    g->ctx = ctx;
+    g->ok = (sink != NULL);
+    g->crc = 0;
+    g->isize = 0;
+    g->bytes_out = 0;
+    g->bitbuf = 0;
+    g->bitcnt = 0;
+    g->in_len = 0;
+    g->out_len = 0;
+
+    for (size_t i = 0; i < sizeof(header); i++) put_byte(g, header[i]);
+    return g->ok;
+}
+
+bool gzip_writer_write(gzip_writer_t *g, const void *data, size_t len) {
+    const uint8_t *p = (const uint8_t *)data;
+    g->crc = crc32_update(g->crc, p, len);
+    g->isize += (uint32_t)len;
+
+    while (len > 0 && g->ok) {
+        size_t n = GZIP_WRITER_BLOCK - g->in_len;
+        if (n > len) n = len;
+        memcpy(g->in + g->in_len, p, n);
+        g->in_len += n;
+        p += n;
+        len -= n;
+        if (g->in_len == GZIP_WRITER_BLOCK) compress_block(g, false);
+    }
+    return g->ok;
+}
+
+bool gzip_writer_finish(gzip_writer_t *g) {
+    compress_block(g, true);
+    if (g->bitcnt > 0) put_bits(g, 0, 8 - g->bitcnt);
+
+    for (int i = 0; i < 4; i++) put_byte(g, (uint8_t)(g->crc >> (8 * i)));
+    for (int i = 0; i < 4; i++) put_byte(g, (uint8_t)(g->isize >> (8 * i)));
+    flush_out(g);
+    return g->ok;
+}
@@ -0,0 +1,72 @@
+/**
+ * @file gzip_writer.h
+ * @brief Streaming gzip (RFC 1952) compressor with bounded memory
+ *
+ * Input is collected in GZIP_WRITER_BLOCK-byte blocks; each full block is
+ * LZ77-matched (hash chains within the block) and emitted as one deflate
+ * block with the fixed Huffman code.  Compressed bytes are handed to a
+ * sink callback in GZIP_WRITER_OUT-byte pieces.  All state lives in the
+ * gzip_writer_t (about 60 KB), so the caller decides where that memory
+ * comes from and no allocation happens.
+ *
+ * Fixed codes and block-local matching trade some ratio for simplicity;
+ * repetitive text such as CSV trend exports still shrinks several-fold.
+ *
+ * No LVGL or SQLite dependency.
+ */
+
+#ifndef GZIP_WRITER_H
+#define GZIP_WRITER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ── Constants ─────────────────────────────────────────────── */
+
+#define GZIP_WRITER_BLOCK     16384     /* Input bytes per deflate block */
+#define GZIP_WRITER_OUT       4096      /* Output staging buffer */
+#define GZIP_WRITER_HASH_BITS 12
+
+/* ── Types ─────────────────────────────────────────────────── */
+
+/** Receives compressed output; return false to abort (e.g. disk full). */
+typedef bool (*gzip_sink_fn_t)(const uint8_t *data, size_t len, void *ctx);
+
+typedef struct {
+    gzip_sink_fn_t sink;
+    void          *ctx;
+    bool           ok;              /* False once the sink has failed */
+    uint32_t       crc;             /* CRC-32 of the uncompressed data */
+    uint32_t       isize;           /* Uncompressed length mod 2^32 */
+    uint64_t       bytes_out;       /* Compressed bytes passed to the sink */
+    uint32_t       bitbuf;
+    int            bitcnt;
+    size_t         in_len;
+    size_t         out_len;
+    uint8_t        in[GZIP_WRITER_BLOCK];
+    uint8_t        out[GZIP_WRITER_OUT];
+    uint16_t       head[1 << GZIP_WRITER_HASH_BITS];
+    uint16_t       prev[GZIP_WRITER_BLOCK];
+} gzip_writer_t;
+
+/* ── API ───────────────────────────────────────────────────── */
+
+/** Start a gzip member (writes the 10-byte header). */
+bool gzip_writer_init(gzip_writer_t *g, gzip_sink_fn_t sink, void *ctx);
+
+/** Compress `len` bytes.  False once the sink has failed. */
+bool gzip_writer_write(gzip_writer_t *g, const void *data, size_t len);
+
+/** Flush the last block and write the CRC/length trailer. */
+bool gzip_writer_finish(gzip_writer_t *g);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GZIP_WRITER_H */
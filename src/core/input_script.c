@@ -0,0 +1,260 @@
+/**
+ * @file input_script.c
+ * @brief Input script — parser and pull-based playback
+ *
+ * Each step expands into phases, each with a minimum length:
+ *
+ *   wait:  up (ms)
+ *   tap:   down (PRESS_MS), up (GAP_MS)                trigger: up
+ *   drag:  down (PRESS_MS), move (ms), up (GAP_MS)     trigger: first move
+ *
+ * A phase ends once it has been sampled at least once and its length has
+ * passed; the next phase starts at that sample's time.
+ */
+
+#include "input_script.h"
+#include <stdio.h>
+#include <string.h>
+
+/* ── Phases ──────────────────────────────────────────────── */
+
+static int phase_count(const input_step_t *st) {
+    switch (st->kind) {
+    case INPUT_STEP_TAP:  return 2;
+    case INPUT_STEP_DRAG: return 3;
+    default:              return 1;
+    }
+}
+
+static uint32_t phase_ms(const input_step_t *st, int phase) {
+    switch (st->kind) {
+    case INPUT_STEP_TAP:
+        return phase == 0 ? INPUT_SCRIPT_PRESS_MS : INPUT_SCRIPT_GAP_MS;
+    case INPUT_STEP_DRAG:
+        if (phase == 0) return INPUT_SCRIPT_PRESS_MS;
+        return phase == 1 ? st->ms : INPUT_SCRIPT_GAP_MS;
+    default:
+        return st->ms;
+    }
+}
+
+/** Pointer state `elapsed` ms into a phase. */
+static input_point_t phase_point(const input_step_t *st, int phase,
+                                 uint32_t elapsed, input_point_t last) {
+    input_point_t p = last;
+    switch (st->kind) {
+    case INPUT_STEP_TAP:
+        p.x = st->x0;
+        p.y = st->y0;
+        p.pressed = (phase == 0);
+        break;
+    case INPUT_STEP_DRAG:
+        if (phase == 0) {
+            p.x = st->x0;
+            p.y = st->y0;
+            p.pressed = true;
+        } else if (phase == 1) {
+            uint32_t t = elapsed < st->ms ? elapsed : st->ms;
+            int32_t dx = (int32_t)st->x1 - st->x0;
+            int32_t dy = (int32_t)st->y1 - st->y0;
+            p.x = (int16_t)(st->x0 + (st->ms ? dx * (int32_t)t / (int32_t)st->ms : dx));
+            p.y = (int16_t)(st->y0 + (st->ms ? dy * (int32_t)t / (int32_t)st->ms : dy));
+            p.pressed = true;
+        } else {
+            p.x = st->x1;
+            p.y = st->y1;
+            p.pressed = false;
+        }
+        break;
+    default:
+        p.pressed = false;
+        break;
+    }
+    return p;
+}
+
+/** True if the sample `p` delivers the input the step acts on. */
+static bool is_trigger(const input_step_t *st, int phase, input_point_t p) {
+    if (st->label[0] == '\0') return false;
+    if (st->kind == INPUT_STEP_TAP) return phase == 1;
+    if (st->kind == INPUT_STEP_DRAG) {
+        return phase == 1 && (p.x != st->x0 || p.y != st->y0);
+    }
+    return false;
+}
+
+/* ── Loading ─────────────────────────────────────────────── */
+
+/** Parse one non-blank line.  @return false on a syntax error. */
+static bool parse_line(input_script_t *s, const char *line) {
+    char cmd[16];
+    int  n = 0;
+    if (sscanf(line, "%15s%n", cmd, &n) != 1) return true;
+    const char *rest = line + n;
+
+    if (strcmp(cmd, "repeat") == 0) {
+        int count;
+        if (sscanf(rest, "%d", &count) != 1 || count < 1) return false;
+        s->repeat = count;
+        return true;
+    }
+
+    if (s->step_count >= INPUT_SCRIPT_MAX_STEPS) {
+        printf("[input_script] More than %d steps\n", INPUT_SCRIPT_MAX_STEPS);
+        return false;
+    }
+    input_step_t st;
+    memset(&st, 0, sizeof(st));
+    char label[INPUT_SCRIPT_LABEL_MAX] = "";
+    int  x0, y0, x1, y1, ms;
+
+    if (strcmp(cmd, "wait") == 0) {
+        if (sscanf(rest, "%d", &ms) != 1 || ms < 0) return false;
+        st.kind = INPUT_STEP_WAIT;
+        st.ms = (uint32_t)ms;
+    } else if (strcmp(cmd, "tap") == 0) {
+        int got = sscanf(rest, "%d %d %31s", &x0, &y0, label);
+        if (got < 2) return false;
+        st.kind = INPUT_STEP_TAP;
+        st.x0 = (int16_t)x0;
+        st.y0 = (int16_t)y0;
+    } else if (strcmp(cmd, "drag") == 0) {
+        int got = sscanf(rest, "%d %d %d %d %d %31s",
+                         &x0, &y0, &x1, &y1, &ms, label);
+        if (got < 5 || ms < 0) return false;
+        st.kind = INPUT_STEP_DRAG;
+        st.x0 = (int16_t)x0;
+        st.y0 = (int16_t)y0;
+        st.x1 = (int16_t)x1;
+        st.y1 = (int16_t)y1;
+        st.ms = (uint32_t)ms;
+    } else {
+        return false;
+    }
+    memcpy(st.label, label, sizeof(st.label));
+    s->steps[s->step_count++] = st;
+    return true;
+}
+
+bool input_script_parse(input_script_t *s, const char *text, int *err_line) {
+    memset(s, 0, sizeof(*s));
+    s->repeat = 1;
+    if (err_line) *err_line = 0;
+    if (!text) return false;
+
+    int line_no = 0;
+    const char *p = text;
+    while (*p) {
+        const char *end = strchr(p, '\n');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        line_no++;
+
+        char line[128];
+        if (len >= sizeof(line)) len = sizeof(line) - 1;
+        memcpy(line, p, len);
+        line[len] = '\0';
+        char *hash = strchr(line, '#');
+        if (hash && (hash == line || hash[-1] == ' ' || hash[-1] == '\t')) {
+            *hash = '\0';
+        }
+
+        if (!parse_line(s, line)) {
+            if (err_line) *err_line = line_no;
+            s->step_count = 0;
+            return false;
+        }
+        if (!end) break;
+        p = end + 1;
+    }
+    return true;
+}
+
+bool input_script_load(input_script_t *s, const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        printf("[input_script] Cannot open %s\n", path);
+        return false;
+    }
+    static char buf[INPUT_SCRIPT_MAX_BYTES + 1];
+    size_t n = fread(buf, 1, INPUT_SCRIPT_MAX_BYTES, f);
+    bool truncated = !feof(f);
+    fclose(f);
+    if (truncated) {
+        printf("[input_script] %s is larger than %d bytes\n",
+               path, INPUT_SCRIPT_MAX_BYTES);
+        return false;
+    }
+    buf[n] = '\0';
+
+    int err_line = 0;
+    if (!input_script_parse(s, buf, &err_line)) {
+        printf("[input_script] %s:%d: invalid step\n", path, err_line);
+        return false;
+    }
+    printf("[input_script] Loaded %s (%d steps x %d)\n",
+           path, s->step_count, s->repeat);
+    return true;
+}
+
+/* ── Playback ────────────────────────────────────────────── */
+
+void input_script_start(input_script_t *s, uint32_t now_ms) {
+    s->running = s->step_count > 0;
+    s->pc = 0;
+    s->phase = 0;
+    s->pass = 0;
+    s->phase_start_ms = now_ms;
+    s->observed = false;
+    s->triggered = false;
+    memset(&s->last, 0, sizeof(s->last));
+}
+
+/** Move to the next phase, step or pass. */
+static void advance(input_script_t *s, uint32_t now_ms) {
+    s->phase_start_ms = now_ms;
+    s->observed = false;
+    s->triggered = false;
+    if (++s->phase < phase_count(&s->steps[s->pc])) return;
+
+    s->phase = 0;
+    if (++s->pc < s->step_count) return;
+
+    s->pc = 0;
+    if (++s->pass >= s->repeat) s->running = false;
+}
+
+bool input_script_sample(input_script_t *s, uint32_t now_ms,
+                         input_point_t *out, const char **trigger) {
+    if (trigger) *trigger = NULL;
+
+    while (s->running) {
+        const input_step_t *st = &s->steps[s->pc];
+        if (!s->observed ||
+            now_ms - s->phase_start_ms < phase_ms(st, s->phase)) {
+            break;
+        }
+        advance(s, now_ms);
+    }
+
+    if (!s->running) {
+        s->last.pressed = false;
+        if (out) *out = s->last;
+        return false;
+    }
+
+    const input_step_t *st = &s->steps[s->pc];
+    input_point_t p = phase_point(st, s->phase,
+                                  now_ms - s->phase_start_ms, s->last);
+    if (!s->triggered && is_trigger(st, s->phase, p)) {
+        s->triggered = true;
+        if (trigger) *trigger = st->label;
+    }
+    s->observed = true;
+    s->last = p;
+    if (out) *out = p;
+    return true;
+}
+
+bool input_script_done(const input_script_t *s) {
+    return !s->running;
+}
@@ -0,0 +1,118 @@
+/**
+ * @file input_script.h
+ * @brief Scripted touch sequences for unattended UI runs
+ *
+ * A script is plain text, one step per line:
+ *
+ *   # Comment
+ *   repeat 20                      Run the whole script 20 times
+ *   wait 500                       Pointer up for 500 ms
+ *   tap 352 456 open_trends        Press and release at (352, 456)
+ *   drag 400 200 200 200 300 pan   Press, move over 300 ms, release
+ *
+ * The last word of tap and drag is an optional label naming the
+ * interaction; only labelled interactions are reported as triggers.
+ *
+ * Playback is pull-based: the pointer driver calls input_script_sample()
+ * from its read callback and hands the result to LVGL.  Every press,
+ * move and release is returned by at least one sample before the script
+ * moves on, so a slow frame stretches the script instead of losing a tap.
+ * A sample that delivers the input an interaction acts on (a tap's
+ * release, a drag's first movement) reports the label as its trigger,
+ * which is where touch-to-photon latency is measured from.
+ *
+ * Times are milliseconds on any monotonic clock (vclock_mono_ms()).
+ * Static allocation; no LVGL dependency.
+ */
+
+#ifndef INPUT_SCRIPT_H
+#define INPUT_SCRIPT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ── Constants ─────────────────────────────────────────────── */
+
+#define INPUT_SCRIPT_MAX_STEPS   128
+#define INPUT_SCRIPT_LABEL_MAX   32
+#define INPUT_SCRIPT_MAX_BYTES   16384   /* Largest script file */
+#define INPUT_SCRIPT_PRESS_MS    60      /* Pointer down before release / move */
+#define INPUT_SCRIPT_GAP_MS      60      /* Pointer up after release */
+
+/* ── Types ─────────────────────────────────────────────────── */
+
+typedef enum {
+    INPUT_STEP_WAIT = 0,
+    INPUT_STEP_TAP,
+    INPUT_STEP_DRAG,
+} input_step_kind_t;
+
+typedef struct {
+    input_step_kind_t kind;
+    int16_t  x0, y0;            /* Tap point / drag start */
+    int16_t  x1, y1;            /* Drag end */
+    uint32_t ms;                /* Wait length / drag duration */
+    char     label[INPUT_SCRIPT_LABEL_MAX];
+} input_step_t;
+
+typedef struct {
+    int16_t x;
+    int16_t y;
+    bool    pressed;
+} input_point_t;
+
+typedef struct {
+    input_step_t  steps[INPUT_SCRIPT_MAX_STEPS];
+    int           step_count;
+    int           repeat;       /* Passes through the steps */
+
+    /* Playback */
+    bool          running;
+    int           pc;           /* Current step */
+    int           phase;        /* Press / move / release within the step */
+    int           pass;
+    uint32_t      phase_start_ms;
+    bool          observed;     /* Current phase returned by a sample */
+    bool          triggered;    /* Current phase reported its trigger */
+    input_point_t last;
+} input_script_t;
+
+/* ── Loading ───────────────────────────────────────────────── */
+
+/**
+ * Parse script text into `s` (replacing its contents).
+ * @param err_line  Set to the 1-based line of the first error. May be NULL.
+ * @return false on a syntax error or too many steps.
+ */
+bool input_script_parse(input_script_t *s, const char *text, int *err_line);
+
+/** Read and parse a script file.  @return false if unreadable or invalid. */
+bool input_script_load(input_script_t *s, const char *path);
+
+/* ── Playback ──────────────────────────────────────────────── */
+
+/** Start (or restart) playback at `now_ms`. */
+void input_script_start(input_script_t *s, uint32_t now_ms);
+
+/**
+ * Pointer state at `now_ms`.
+ * @param out      Pointer position and button state to report.
+ * @param trigger  Set to the interaction label if this sample delivers
+ *                 the input it acts on, else NULL.  May be NULL.
+ * @return false once the script has finished (pointer released).
+ */
+bool input_script_sample(input_script_t *s, uint32_t now_ms,
+                         input_point_t *out, const char **trigger);
+
+/** True after the last step of the last pass. */
+bool input_script_done(const input_script_t *s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INPUT_SCRIPT_H */
@@ -0,0 +1,266 @@
+/**
+ * @file job_pool.c
+ * @brief Background worker pool — pthread implementation
+ *
+ * A single pool mutex guards the job slots, the per-worker queues and the
+ * completion ring.  With two workers and jobs that each run for
+ * milliseconds, lock contention is negligible and one lock keeps stealing
+ * and shutdown trivially correct.
+ *
+ * Job lifecycle:
+ *   free slot -> queues[worker][prio] -> running on a worker
+ *             -> completed ring -> done() on LVGL thread -> free slot
+ */
+
+#include "job_pool.h"
+#include "vclock.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+/* ── Internal types ──────────────────────────────────────── */
+
+typedef struct {
+    job_run_fn_t  run;
+    job_done_fn_t done;
+    void         *arg;
+    int           next_free;    /* Free-list link, -1 = end */
+} job_slot_t;
+
+/* FIFO of slot indices; capacity covers every slot so it never overflows */
+typedef struct {
+    int buf[JOB_POOL_MAX_JOBS];
+    int head;
+    int count;
+} job_ring_t;
+
+/* ── Module state ────────────────────────────────────────── */
+
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  work_cv   = PTHREAD_COND_INITIALIZER;
+
+static pthread_t  threads[JOB_POOL_WORKERS];
+static int        worker_count = 0;
+static bool       running  = false;
+static bool       stopping = false;
+
+static job_slot_t slots[JOB_POOL_MAX_JOBS];
+static int        free_head = -1;
+
+static job_ring_t queues[JOB_POOL_WORKERS][JOB_PRIO_COUNT];
+static job_ring_t completed;
+
+static int        next_target = 0;
+static int        outstanding = 0;
+static job_pool_stats_t stats;
+
+/* ── Ring helpers (pool_lock held) ───────────────────────── */
+
+static void ring_push(job_ring_t *r, int idx) {
+    r->buf[(r->head + r->count) % JOB_POOL_MAX_JOBS] = idx;
+    r->count++;
+}
+
+static int ring_pop(job_ring_t *r) {
+    int idx = r->buf[r->head];
+    r->head = (r->head + 1) % JOB_POOL_MAX_JOBS;
+    r->count--;
+    return idx;
+}
+
+/* ── Scheduling (pool_lock held) ─────────────────────────── */
+
+/**
+ * Pick the next job for worker `self`.  Priority wins over locality: all
+ * HIGH queues (own first, then peers) are checked before any LOW queue.
+ */
+static bool take_job(int self, int *out_idx) {
+    for (int p = 0; p < JOB_PRIO_COUNT; p++) {
+        for (int k = 0; k < worker_count; k++) {
+            int w = (self + k) % worker_count;
+            if (queues[w][p].count > 0) {
+                *out_idx = ring_pop(&queues[w][p]);
+                if (w != self) stats.stolen++;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/* ── Worker thread ───────────────────────────────────────── */
+
+static void *worker_main(void *param) {
+    int self = (int)(intptr_t)param;
+
+    pthread_mutex_lock(&pool_lock);
+    for (;;) {
+        int idx;
+        if (take_job(self, &idx)) {
+            job_slot_t job = slots[idx];
+            pthread_mutex_unlock(&pool_lock);
+
+            uint64_t t0 = vclock_real_us();
+            job.run(job.arg);
+            uint32_t elapsed = (uint32_t)(vclock_real_us() - t0);
+
+            pthread_mutex_lock(&pool_lock);
+            if (elapsed > stats.max_run_us) stats.max_run_us = elapsed;
+            ring_push(&completed, idx);
+            continue;
+        }
+        if (stopping) break;
+        pthread_cond_wait(&work_cv, &pool_lock);
+    }
+    pthread_mutex_unlock(&pool_lock);
+    return NULL;
+}
+
+/* ── Lifecycle ───────────────────────────────────────────── */
+
+bool job_pool_init(int workers) {
+    if (running) return true;
+
+    if (workers <= 0 || workers > JOB_POOL_WORKERS) workers = JOB_POOL_WORKERS;
+
+    pthread_mutex_lock(&pool_lock);
+    memset(queues, 0, sizeof(queues));
+    memset(&completed, 0, sizeof(completed));
+    memset(&stats, 0, sizeof(stats));
+    for (int i = 0; i < JOB_POOL_MAX_JOBS; i++) {
+        slots[i].run = NULL;
+        slots[i].done = NULL;
+        slots[i].arg = NULL;
+        slots[i].next_free = (i + 1 < JOB_POOL_MAX_JOBS) ? i + 1 : -1;
+    }
+    free_head = 0;
+    next_target = 0;
+    outstanding = 0;
+    stopping = false;
+    worker_count = 0;
+    pthread_mutex_unlock(&pool_lock);
+
+    for (int i = 0; i < workers; i++) {
+        if (pthread_create(&threads[i], NULL, worker_main,
+                           (void *)(intptr_t)i) != 0) {
+            fprintf(stderr, "[job_pool] Failed to start worker %d\n", i);
+            break;
+        }
+        worker_count++;
+    }
+
+    if (worker_count == 0) return false;
+
+    running = true;
+    printf("[job_pool] Initialized: %d workers, %d job slots\n",
+           worker_count, JOB_POOL_MAX_JOBS);
+    return true;
+}
+
+void job_pool_deinit(void) {
+    if (!running) return;
+
+    pthread_mutex_lock(&pool_lock);
+    stopping = true;
+    pthread_cond_broadcast(&work_cv);
+    pthread_mutex_unlock(&pool_lock);
+
+    for (int i = 0; i < worker_count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    running = false;
+    worker_count = 0;
+
+    /* Deliver results of jobs that finished during shutdown */
+    job_pool_dispatch_completions();
+
+    printf("[job_pool] Stopped (%u jobs completed, %u stolen, "
+           "longest %u us)\n",
+           stats.completed, stats.stolen, stats.max_run_us);
+}
+
+bool job_pool_is_running(void) {
+    return running;
+}
+
+/* ── Submission ──────────────────────────────────────────── */
+
+bool job_pool_submit(job_prio_t prio, job_run_fn_t run, job_done_fn_t done,
+                     void *arg) {
+    if (!run || prio < 0 || prio >= JOB_PRIO_COUNT) return false;
+
+    pthread_mutex_lock(&pool_lock);
+
+    if (!running || stopping || free_head < 0) {
+        stats.rejected++;
+        pthread_mutex_unlock(&pool_lock);
+        if (running) {
+            printf("[job_pool] Pool full, rejecting job\n");
+        }
+        return false;
+    }
+
+    int idx = free_head;
+    free_head = slots[idx].next_free;
+    slots[idx].run = run;
+    slots[idx].done = done;
+    slots[idx].arg = arg;
+    slots[idx].next_free = -1;
+
+    ring_push(&queues[next_target][prio], idx);
+    next_target = (next_target + 1) % worker_count;
+    outstanding++;
+    stats.submitted++;
+
+    pthread_cond_signal(&work_cv);
+    pthread_mutex_unlock(&pool_lock);
+    return true;
+}
+
+/* ── Completion ──────────────────────────────────────────── */
+
+int job_pool_dispatch_completions(void) {
+    job_done_fn_t done[JOB_POOL_MAX_JOBS];
+    void         *args[JOB_POOL_MAX_JOBS];
+    int n = 0;
+
+    /* Copy out and release slots first so done() may resubmit */
+    pthread_mutex_lock(&pool_lock);
+    while (completed.count > 0) {
+        int idx = ring_pop(&completed);
+        done[n] = slots[idx].done;
+        args[n] = slots[idx].arg;
+        n++;
+
+        slots[idx].run = NULL;
+        slots[idx].done = NULL;
+        slots[idx].arg = NULL;
+        slots[idx].next_free = free_head;
+        free_head = idx;
+        outstanding--;
+        stats.completed++;
+    }
+    pthread_mutex_unlock(&pool_lock);
+
+    for (int i = 0; i < n; i++) {
+        if (done[i]) done[i](args[i]);
+    }
+    return n;
+}
+
+/* ── Queries ─────────────────────────────────────────────── */
+
+int job_pool_outstanding(void) {
+    pthread_mutex_lock(&pool_lock);
+    int n = outstanding;
+    pthread_mutex_unlock(&pool_lock);
+    return n;
+}
+
+job_pool_stats_t job_pool_get_stats(void) {
+    pthread_mutex_lock(&pool_lock);
+    job_pool_stats_t s = stats;
+    pthread_mutex_unlock(&pool_lock);
+    return s;
+}
@@ -0,0 +1,125 @@
+/**
+ * @file job_pool.h
+ * @brief Background worker pool for non-real-time work
+ *
+ * Purges, minute aggregation, trend queries and FHIR JSON builds are too
+ * slow to run inline on the LVGL thread without dropping frames.  This
+ * module runs them on a small pool of worker threads and hands the result
+ * back to the LVGL thread through a completion callback.
+ *
+ * Scheduling:
+ *   - One worker per spare A7 core (JOB_POOL_WORKERS = 2 on STM32MP157).
+ *   - Each worker owns a FIFO queue per priority.  Submissions are spread
+ *     round-robin; an idle worker steals from its peer's queue before
+ *     sleeping, so one long job never strands the jobs queued behind it.
+ *   - A worker always drains JOB_PRIO_HIGH (UI-visible: trend queries)
+ *     from every queue before touching JOB_PRIO_LOW (maintenance: purge,
+ *     aggregation, sync).
+ *
+ * Completion:
+ *   run() executes on a worker thread and must not touch LVGL objects.
+ *   done() executes on the LVGL thread from job_pool_dispatch_completions(),
+ *   which the render loop calls once per iteration under lv_lock().  done()
+ *   is where results are applied to widgets.  Jobs may be submitted from
+ *   any thread (the data thread submits aggregation, purge and recovery
+ *   snapshots); a job submitted there that needs no widget passes no
+ *   done(), since it would run on the render thread.
+ *
+ * Static allocation: job slots and queues are fixed-size arrays.
+ * No LVGL dependency.
+ */
+
+#ifndef JOB_POOL_H
+#define JOB_POOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ── Constants ─────────────────────────────────────────────── */
+
+#define JOB_POOL_WORKERS      2     /* Dual Cortex-A7 */
+#define JOB_POOL_MAX_JOBS     32    /* Queued + running + awaiting done() */
+
+/* ── Priorities ────────────────────────────────────────────── */
+
+typedef enum {
+    JOB_PRIO_HIGH = 0,      /* User is waiting (trend screen queries) */
+    JOB_PRIO_LOW,           /* Maintenance (purge, aggregation, sync) */
+    JOB_PRIO_COUNT
+} job_prio_t;
+
+/* ── Callbacks ─────────────────────────────────────────────── */
+
+/** Work function, runs on a worker thread. */
+typedef void (*job_run_fn_t)(void *arg);
+
+/** Completion, runs on the LVGL thread after run() returns. */
+typedef void (*job_done_fn_t)(void *arg);
+
+/* ── Statistics ────────────────────────────────────────────── */
+
+typedef struct {
+    uint32_t submitted;
+    uint32_t completed;
+    uint32_t rejected;          /* Pool full or not running */
+    uint32_t stolen;            /* Jobs run by a worker other than the target */
+    uint32_t max_run_us;        /* Longest single run() */
+} job_pool_stats_t;
+
+/* ── Lifecycle ─────────────────────────────────────────────── */
+
+/**
+ * Start the worker threads.
+ * @param workers  Number of workers (1..JOB_POOL_WORKERS); 0 = default.
+ * @return true on success.
+ */
+bool job_pool_init(int workers);
+
+/**
+ * Stop the pool.  Queued jobs still run, then workers are joined and all
+ * outstanding completions are dispatched on the calling thread.
+ */
+void job_pool_deinit(void);
+
+/** Check whether the pool is running. */
+bool job_pool_is_running(void);
+
+/* ── Submission (any thread) ───────────────────────────────── */
+
+/**
+ * Queue a job.
+ * @param prio  Scheduling priority.
+ * @param run   Work function (worker thread). Required.
+ * @param done  Completion (LVGL thread). May be NULL.
+ * @param arg   Passed to both callbacks; must outlive done().
+ * @return false if the pool is not running or all job slots are in use.
+ */
+bool job_pool_submit(job_prio_t prio, job_run_fn_t run, job_done_fn_t done,
+                     void *arg);
+
+/* ── Completion (LVGL thread) ──────────────────────────────── */
+
+/**
+ * Invoke done() for every job that has finished since the last call.
+ * Call once per main-loop iteration.
+ * @return Number of completions dispatched.
+ */
+int job_pool_dispatch_completions(void);
+
+/* ── Queries ───────────────────────────────────────────────── */
+
+/** Jobs queued, running, or awaiting dispatch. */
+int job_pool_outstanding(void);
+
+/** Snapshot of pool counters. */
+job_pool_stats_t job_pool_get_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JOB_POOL_H */
@@ -0,0 +1,88 @@
+/**
+ * @file latency_hist.c
+ * @brief Fixed-size latency histogram — log-linear buckets
+ *
+ * Bucket layout: values 0..3 get a bucket each.  From 4 up, a value with
+ * its top bit at position m (m >= 2) falls in one of four buckets for
+ * that octave, picked by the two bits below the top one:
+ *
+ *   index = 4 * (m - 1) + ((v >> (m - 2)) & 3)
+ *
+ * so [4,5) -> 4, [5,6) -> 5 ... [8,10) -> 8, [10,12) -> 9, and so on up
+ * to index 123 for the top octave of a uint32_t.
+ */
+
+#include "latency_hist.h"
+#include <stdio.h>
+#include <string.h>
+
+/* ── Bucket mapping ──────────────────────────────────────── */
+
+static int top_bit(uint32_t v) {
+    int m = 0;
+    while (v >>= 1) m++;
+    return m;
+}
+
+static int bucket_of(uint32_t us) {
+    if (us < 4) return (int)us;
+    int m = top_bit(us);
+    return 4 * (m - 1) + (int)((us >> (m - 2)) & 3u);
+}
+
+/** Exclusive upper bound of bucket `idx`. */
+static uint64_t bucket_end(int idx) {
+    if (idx < 4) return (uint64_t)idx + 1;
+    int m = idx / 4 + 1;
+    uint64_t sub = (uint64_t)(idx % 4);
+    return (4 + sub + 1) << (m - 2);
+}
+
+/* ── API ─────────────────────────────────────────────────── */
+
+void latency_hist_reset(latency_hist_t *h) {
+    memset(h, 0, sizeof(*h));
+}
+
+void latency_hist_add(latency_hist_t *h, uint32_t us) {
+    if (h->count == 0 || us < h->min_us) h->min_us = us;
+    if (us > h->max_us) h->max_us = us;
+    h->count++;
+    h->sum_us += us;
+    h->buckets[bucket_of(us)]++;
+}
+
+uint32_t latency_hist_percentile(const latency_hist_t *h, unsigned pct) {
+    if (h->count == 0) return 0;
+    if (pct > 100) pct = 100;
+
+    /* Rank of the sample at pct (1-based, rounded up) */
+    uint64_t rank = ((uint64_t)h->count * pct + 99) / 100;
+    if (rank == 0) rank = 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+        seen += h->buckets[i];
+        if (seen >= rank) {
+            uint64_t v = bucket_end(i) - 1;
+            return v > h->max_us ? h->max_us : (uint32_t)v;
+        }
+    }
+    return h->max_us;
+}
+
+uint32_t latency_hist_mean(const latency_hist_t *h) {
+    return h->count ? (uint32_t)(h->sum_us / h->count) : 0;
+}
+
+void latency_hist_print(const latency_hist_t *h, const char *tag,
+                        const char *name) {
+    printf("[%s] %-14s n=%-6u mean %7.2f  p50 %7.2f  p95 %7.2f  "
+           "p99 %7.2f  max %7.2f ms\n",
+           tag, name, h->count,
+           latency_hist_mean(h) / 1000.0,
+           latency_hist_percentile(h, 50) / 1000.0,
+           latency_hist_percentile(h, 95) / 1000.0,
+           latency_hist_percentile(h, 99) / 1000.0,
+           h->max_us / 1000.0);
+}
@@ -0,0 +1,71 @@
+/**
+ * @file latency_hist.h
+ * @brief Fixed-size latency histogram with percentile report
+ *
+ * Records durations in microseconds into log-linear buckets: four per
+ * power of two, so a percentile is reported within 25 % of the true
+ * value from 4 us up to 71 minutes.  Min, max and mean are exact.
+ * Adding a sample is a few instructions and never allocates, so it can
+ * sit on the render path and in the data thread's 1 Hz loop.
+ *
+ * Used for the frame-time distribution and alarm-evaluation latency the
+ * simulator reports (see main.c).  A histogram is written by one thread;
+ * read it from that thread, or after the writer has stopped.
+ *
+ * No LVGL dependency.
+ */
+
+#ifndef LATENCY_HIST_H
+#define LATENCY_HIST_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ── Constants ─────────────────────────────────────────────── */
+
+#define LATENCY_HIST_BUCKETS  124   /* 0-3 us, then 4 per octave to 2^32 */
+
+/* ── Types ─────────────────────────────────────────────────── */
+
+typedef struct {
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint32_t buckets[LATENCY_HIST_BUCKETS];
+} latency_hist_t;
+
+/* ── API ───────────────────────────────────────────────────── */
+
+/** Empty the histogram. */
+void latency_hist_reset(latency_hist_t *h);
+
+/** Record one duration. */
+void latency_hist_add(latency_hist_t *h, uint32_t us);
+
+/**
+ * Duration at or below which `pct` percent of samples fall (0..100),
+ * rounded up to its bucket's upper bound and capped at the maximum.
+ * @return 0 when the histogram is empty.
+ */
+uint32_t latency_hist_percentile(const latency_hist_t *h, unsigned pct);
+
+/** Mean in microseconds (0 when empty). */
+uint32_t latency_hist_mean(const latency_hist_t *h);
+
+/**
+ * Print one line: count, mean, p50, p95, p99 and max in milliseconds.
+ * @param tag  Module tag, e.g. "perf".
+ * @param name What was measured, e.g. "frame".
+ */
+void latency_hist_print(const latency_hist_t *h, const char *tag,
+                        const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LATENCY_HIST_H */
@@ -0,0 +1,62 @@
+/**
+ * @file mem_budget.h
+ * @brief Memory budgets: large static buffers per module, and the process
+ *
+ * Each large static buffer is checked against its budget where it is
+ * declared:
+ *
+ *   static tile_t tiles[TREND_VIEWPORT_TILES];
+ *   MEM_BUDGET_ASSERT(trend_viewport, sizeof(tiles), MEM_BUDGET_TREND_VIEWPORT);
+ *
+ * Growing a buffer past its budget fails the build, so an increase is
+ * made here, where every budget sits next to the process limit.  Sizes
+ * are those of the 64-bit simulator build, the larger of the two; the
+ * 32-bit target needs no more.
+ *
+ * scripts/mem-report.sh lists static sizes per module from the linker
+ * map; mem_report.h samples RSS by region at run time.
+ */
+
+#ifndef MEM_BUDGET_H
+#define MEM_BUDGET_H
+
+/* ── Compile-time check ────────────────────────────────────── */
+
+/**
+ * Fail the build if `bytes` exceeds `limit` (negative array size).
+ * `name` must be unique within the translation unit.
+ */
+#define MEM_BUDGET_ASSERT(name, bytes, limit) \
+    typedef char mem_budget_##name##_exceeded[((bytes) <= (limit)) ? 1 : -1]
+
+/* ── Process ───────────────────────────────────────────────── */
+
+/* MemoryMax of deploy/systemd/vitals-ui.service */
+#define MEM_BUDGET_PROCESS_KB           (128 * 1024)
+
+/* RSS share that mem_report_print() flags as close to the limit */
+#define MEM_BUDGET_WARN_PCT             75
+
+/* ── Static buffers (bytes) ────────────────────────────────── */
+
+#define MEM_BUDGET_LVGL_POOL            (256 * 1024)   /* LV_MEM_SIZE */
+#define MEM_BUDGET_TREND_CACHE          (272 * 1024)   /* Chunk pool + index */
+#define MEM_BUDGET_VITALS_HISTORY       (128 * 1024)   /* One vitals_history_t */
+#define MEM_BUDGET_TREND_VIEWPORT       (96 * 1024)    /* Query tiles */
+#define MEM_BUDGET_TREND_EXPORT         (88 * 1024)    /* gzip state + row chunks */
+#define MEM_BUDGET_SYNC_QUEUE           (72 * 1024)    /* One send batch */
+#define MEM_BUDGET_TREND_QUERY          (52 * 1024)    /* Job + result set */
+#define MEM_BUDGET_TREND_LAYERS         (36 * 1024)    /* Cached chart grid strips */
+#define MEM_BUDGET_GLYPH_CACHE          (88 * 1024)    /* Text bitmaps + index */
+#define MEM_BUDGET_SCREEN_STREAM        (64 * 1024)    /* Tile hashes + one frame */
+#define MEM_BUDGET_IPC_SUBSCRIBER       (4 * 1024)     /* One ipc_subscriber_t */
+
+/* Sum of the budgets above (two vitals histories per provider) */
+#define MEM_BUDGET_STATIC_TOTAL \
+    (MEM_BUDGET_LVGL_POOL + MEM_BUDGET_TREND_CACHE + \
+     2 * MEM_BUDGET_VITALS_HISTORY + MEM_BUDGET_TREND_VIEWPORT + \
+     MEM_BUDGET_TREND_EXPORT + MEM_BUDGET_SYNC_QUEUE + \
+     MEM_BUDGET_TREND_QUERY + MEM_BUDGET_TREND_LAYERS + \
+     MEM_BUDGET_GLYPH_CACHE + MEM_BUDGET_SCREEN_STREAM)
+
+#endif /* MEM_BUDGET_H */
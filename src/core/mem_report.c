@@ -0,0 +1,167 @@
+/**
+ * @file mem_report.c
+ * @brief Runtime memory report — smaps parser and SQLite counters
+ *
+ * The .bss of the executable is not file-backed: it is the anonymous
+ * mapping that starts where the executable's last writable mapping ends,
+ * so such a mapping counts as static rather than anon.
+ */
+
+#include "mem_report.h"
+#include "mem_budget.h"
+#include "sqlite3.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/* ── Module state ────────────────────────────────────────── */
+
+static bool sqlite_tracked = false;
+
+static const char *REGION_NAMES[MEM_REGION_COUNT] = {
+    "image", "static", "heap", "anon", "stack", "libs", "shm", "other"
+};
+
+/* ── SQLite ──────────────────────────────────────────────── */
+
+bool mem_report_track_sqlite(void) {
+    if (sqlite_tracked) return true;
+    if (sqlite3_config(SQLITE_CONFIG_MEMSTATUS, 1) != SQLITE_OK) {
+        printf("[mem_report] SQLite already initialised, memory not tracked\n");
+        return false;
+    }
+    sqlite_tracked = true;
+    return true;
+}
+
+static void sample_sqlite(mem_report_t *out) {
+    out->sqlite_used = -1;
+    out->sqlite_peak = -1;
+    if (!sqlite_tracked) return;
+
+    sqlite3_int64 cur = 0, peak = 0;
+    if (sqlite3_status64(SQLITE_STATUS_MEMORY_USED, &cur, &peak, 0) == SQLITE_OK) {
+        out->sqlite_used = cur;
+        out->sqlite_peak = peak;
+    }
+}
+
+/* ── smaps ───────────────────────────────────────────────── */
+
+/** Region of a mapping from its path and permissions. */
+static mem_region_t classify(const char *path, const char *perms,
+                             const char *exe_path, bool follows_exe_data) {
+    if (path[0] == '\0') {
+        return follows_exe_data ? MEM_REGION_STATIC : MEM_REGION_ANON;
+    }
+    if (exe_path && strcmp(path, exe_path) == 0) {
+        return perms[1] == 'w' ? MEM_REGION_STATIC : MEM_REGION_IMAGE;
+    }
+    if (strcmp(path, "[heap]") == 0) return MEM_REGION_HEAP;
+    if (strcmp(path, "[stack]") == 0) return MEM_REGION_STACK;
+    if (path[0] == '[') return MEM_REGION_OTHER;        /* vdso, vvar */
+    if (strncmp(path, "/dev/shm/", 9) == 0 || strncmp(path, "/SYSV", 5) == 0) {
+        return MEM_REGION_SHM;
+    }
+    if (strstr(path, ".so")) return MEM_REGION_LIBS;
+    return MEM_REGION_OTHER;
+}
+
+bool mem_report_parse(const char *smaps_path, const char *status_path,
+                      const char *exe_path, mem_report_t *out) {
+    memset(out->rss_kb, 0, sizeof(out->rss_kb));
+    out->rss_total_kb = 0;
+    out->rss_peak_kb = 0;
+
+    FILE *f = fopen(smaps_path, "r");
+    if (!f) return false;
+
+    char line[512];
+    mem_region_t region = MEM_REGION_OTHER;
+    unsigned long prev_end = 0;
+    bool prev_exe_data = false;
+
+    while (fgets(line, sizeof(line), f)) {
+        unsigned long start, end;
+        char perms[8];
+        int path_at = 0;
+
+        /* Mapping header: "start-end perms offset dev inode [path]" */
+        if (sscanf(line, "%lx-%lx %7s %*s %*s %*s %n",
+                   &start, &end, perms, &path_at) == 3 && path_at > 0) {
+            char *path = line + path_at;
+            path[strcspn(path, "\n")] = '\0';
+            char *deleted = strstr(path, " (deleted)");
+            if (deleted) *deleted = '\0';
+
+            region = classify(path, perms, exe_path,
+                              prev_exe_data && start == prev_end);
+            prev_exe_data = (region == MEM_REGION_STATIC);
+            prev_end = end;
+            continue;
+        }
+
+        unsigned kb;
+        if (sscanf(line, "Rss: %u kB", &kb) == 1) {
+            out->rss_kb[region] += kb;
+            out->rss_total_kb += kb;
+        }
+    }
+    fclose(f);
+
+    f = status_path ? fopen(status_path, "r") : NULL;
+    if (f) {
+        while (fgets(line, sizeof(line), f)) {
+            unsigned kb;
+            if (sscanf(line, "VmHWM: %u kB", &kb) == 1) {
+                out->rss_peak_kb = kb;
+                break;
+            }
+        }
+        fclose(f);
+    }
+    return true;
+}
+
+bool mem_report_sample(mem_report_t *out) {
+    sample_sqlite(out);
+
+    char exe[256];
+    ssize_t n = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+    exe[n > 0 ? n : 0] = '\0';
+    return mem_report_parse("/proc/self/smaps", "/proc/self/status",
+                            n > 0 ? exe : NULL, out);
+}
+
+/* ── Report ──────────────────────────────────────────────── */
+
+const char *mem_report_region_name(mem_region_t region) {
+    if ((unsigned)region >= MEM_REGION_COUNT) return "?";
+    return REGION_NAMES[region];
+}
+
+void mem_report_print(const mem_report_t *r, const char *tag) {
+    if (r->rss_total_kb > 0) {
+        printf("[%s] RSS %u KB:", tag, r->rss_total_kb);
+        for (int i = 0; i < MEM_REGION_COUNT; i++) {
+            if (r->rss_kb[i] == 0) continue;
+            printf(" %s %u", REGION_NAMES[i], r->rss_kb[i]);
+        }
+        printf("\n");
+
+        uint32_t peak = r->rss_peak_kb > r->rss_total_kb ? r->rss_peak_kb
+                                                         : r->rss_total_kb;
+        unsigned pct = (unsigned)((uint64_t)peak * 100 / MEM_BUDGET_PROCESS_KB);
+        printf("[%s] Peak %u KB, %u%% of %u KB budget%s\n", tag, peak, pct,
+               (unsigned)MEM_BUDGET_PROCESS_KB,
+               pct >= MEM_BUDGET_WARN_PCT ? "  ** near limit **" : "");
+    } else {
+        printf("[%s] RSS not available on this platform\n", tag);
+    }
+
+    if (r->sqlite_used >= 0) {
+        printf("[%s] SQLite %lld KB, peak %lld KB\n", tag,
+               (long long)(r->sqlite_used / 1024),
+               (long long)(r->sqlite_peak / 1024));
+    }
+}
@@ -0,0 +1,97 @@
+/**
+ * @file mem_report.h
+ * @brief Runtime memory report: RSS by region, peak, SQLite heap
+ *
+ * Reads /proc/self/smaps and /proc/self/status (Linux) and sums resident
+ * memory by where it comes from:
+ *
+ *   image    executable code and read-only data
+ *   static   executable .data and .bss: the static buffers in
+ *            mem_budget.h, the LVGL pool (LV_MEM_SIZE)
+ *   heap     [heap]: the main malloc arena (SQLite page cache, SDL)
+ *   anon     anonymous mappings: thread stacks, other malloc arenas,
+ *            large allocations
+ *   stack    main thread stack
+ *   libs     shared libraries
+ *   shm      shared memory (status_board)
+ *   other    other file mappings (SQLite WAL index, device memory)
+ *
+ * SQLite's own counters need memory statistics, which the build turns
+ * off by default (SQLITE_DEFAULT_MEMSTATUS=0); mem_report_track_sqlite()
+ * turns them back on before the first connection is opened.
+ *
+ * Thresholds come from mem_budget.h.  The LVGL pool is reported by the
+ * caller (lv_mem_monitor()); this module has no LVGL dependency.
+ */
+
+#ifndef MEM_REPORT_H
+#define MEM_REPORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ── Types ─────────────────────────────────────────────────── */
+
+typedef enum {
+    MEM_REGION_IMAGE = 0,
+    MEM_REGION_STATIC,
+    MEM_REGION_HEAP,
+    MEM_REGION_ANON,
+    MEM_REGION_STACK,
+    MEM_REGION_LIBS,
+    MEM_REGION_SHM,
+    MEM_REGION_OTHER,
+    MEM_REGION_COUNT
+} mem_region_t;
+
+typedef struct {
+    uint32_t rss_kb[MEM_REGION_COUNT];
+    uint32_t rss_total_kb;      /* 0: not available on this platform */
+    uint32_t rss_peak_kb;       /* VmHWM */
+    int64_t  sqlite_used;       /* Bytes; -1 if not tracked */
+    int64_t  sqlite_peak;       /* Bytes; -1 if not tracked */
+} mem_report_t;
+
+/* ── API ───────────────────────────────────────────────────── */
+
+/**
+ * Turn on SQLite memory statistics.  Call before any connection is
+ * opened (sqlite3_config() is refused after SQLite initialises).
+ * @return false if SQLite was already initialised.
+ */
+bool mem_report_track_sqlite(void);
+
+/**
+ * Sum the Rss of every mapping in an smaps file by region, and read the
+ * peak from a status file.
+ * @param exe_path  Path of the executable, to tell its mappings apart.
+ * @return false if the smaps file cannot be read.
+ */
+bool mem_report_parse(const char *smaps_path, const char *status_path,
+                      const char *exe_path, mem_report_t *out);
+
+/**
+ * Sample the current process (/proc/self) and SQLite.
+ * @return false where /proc is not available; SQLite fields are still set.
+ */
+bool mem_report_sample(mem_report_t *out);
+
+/** Region name for reports ("image", "static", ...). */
+const char *mem_report_region_name(mem_region_t region);
+
+/**
+ * Print RSS by region, the peak against MEM_BUDGET_PROCESS_KB (flagged
+ * above MEM_BUDGET_WARN_PCT) and SQLite memory.
+ * @param tag  Module tag, e.g. "mem".
+ */
+void mem_report_print(const mem_report_t *r, const char *tag);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MEM_REPORT_H */
@@ -10,10 +10,13 @@
 
 #include "mock_data.h"
 #include "trend_db.h"
+#include "job_pool.h"
+#include "vclock.h"
+#include "mem_budget.h"
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
-#include <time.h>
 
 /* ── Simulation parameters ─────────────────────────────────── */
 
@@ -61,10 +64,13 @@ static mock_history_internal_t history_internal;
 
 /* vitals_history_t compatible wrapper (with zeros for extra fields) */
 static vitals_history_t history_wrapper;
+MEM_BUDGET_ASSERT(mock_history, sizeof(history_wrapper),
+                  MEM_BUDGET_VITALS_HISTORY);
 
 /* Alarm log (uses vitals_provider.h types) */
 static vitals_alarm_log_t alarm_log;
-static uint32_t tick_counter_s = 0;  /* Seconds since mock_data_init */
+static uint32_t tick_counter_s = 0;  /* Ticks since mock_data_init */
+static uint32_t last_minute_ts = 0;  /* Minute of the previous sample */
 
 /* LVGL timer and callback */
 static lv_timer_t   *data_timer = NULL;
@@ -73,6 +79,7 @@ static mock_data_cb_t user_callback = NULL;
 /* ── Forward declarations ──────────────────────────────────── */
 
 static void timer_cb(lv_timer_t *timer);
+static void aggregate_job_run(void *arg);
 static int  step_int(int_sim_t *sim);
 static float step_float(float_sim_t *sim);
 static int  clamp_int(int val, int lo, int hi);
@@ -81,7 +88,8 @@ static float clamp_float(float val, float lo, float hi);
 /* ── Public API ────────────────────────────────────────────── */
 
 void mock_data_init(void) {
-    srand((unsigned int)time(NULL));
+    /* Seeded from the clock: a virtual clock with a fixed start replays */
+    srand((unsigned int)vclock_wall_s());
 
     /* Initialize current data with base values */
     current_data.hr       = hr_sim.base;
@@ -100,6 +108,7 @@ void mock_data_init(void) {
     memset(&history_wrapper, 0, sizeof(history_wrapper));
     memset(&alarm_log, 0, sizeof(alarm_log));
     tick_counter_s = 0;
+    last_minute_ts = 0;
 
     printf("[mock_data] Initialized (HR=%d, SpO2=%d, Temp=%.1f, RR=%d, NIBP=%d/%d)\n",
            current_data.hr, current_data.spo2, (double)current_data.temp,
@@ -109,6 +118,11 @@ void mock_data_init(void) {
 void mock_data_start(uint32_t update_interval_ms) {
     if (data_timer) {
         lv_timer_delete(data_timer);
+        data_timer = NULL;
+    }
+    if (update_interval_ms == 0) {
+        printf("[mock_data] Started (externally ticked)\n");
+        return;
     }
     data_timer = lv_timer_create(timer_cb, update_interval_ms, NULL);
     printf("[mock_data] Started (interval=%u ms)\n", update_interval_ms);
@@ -132,9 +146,17 @@ void mock_data_set_callback(mock_data_cb_t cb) {
 
 /* ── Private helpers ───────────────────────────────────────── */
 
+/** Worker thread: roll the raw samples of one minute into vitals_1min. */
+static void aggregate_job_run(void *arg) {
+    trend_db_aggregate_minute((uint32_t)(uintptr_t)arg);
+}
+
 static void timer_cb(lv_timer_t *timer) {
     (void)timer;
+    mock_data_tick();
+}
 
+void mock_data_tick(void) {
     /* Step continuous parameters */
     current_data.hr   = step_int(&hr_sim);
     current_data.spo2 = step_int(&spo2_sim);
@@ -164,21 +186,29 @@ static void timer_cb(lv_timer_t *timer) {
     history_internal.count++;
 
     tick_counter_s++;
-    current_data.timestamp_ms = (uint64_t)tick_counter_s * 1000;
+    uint32_t now_s = (uint32_t)vclock_wall_s();
+    current_data.timestamp_ms = (uint64_t)now_s * 1000;
 
     /* Insert into trend database (SQLite) */
-    trend_db_insert_sample(tick_counter_s, current_data.hr, current_data.spo2,
+    trend_db_insert_sample(current_data.patient_slot, now_s,
+                           current_data.hr, current_data.spo2,
                            current_data.rr, current_data.temp);
 
     if (current_data.nibp_fresh) {
-        trend_db_insert_nibp(tick_counter_s, current_data.nibp_sys,
-                             current_data.nibp_dia, current_data.nibp_map);
+        trend_db_insert_nibp(current_data.patient_slot, now_s,
+                             current_data.nibp_sys, current_data.nibp_dia,
+                             current_data.nibp_map);
     }
 
-    /* Aggregate 1-minute summary every 60 seconds */
-    if (tick_counter_s > 0 && tick_counter_s % 60 == 0) {
-        trend_db_aggregate_minute(tick_counter_s);
+    /* First sample of a new minute: aggregate the one that ended (background job) */
+    uint32_t minute_ts = now_s - now_s % 60;
+    if (last_minute_ts != 0 && minute_ts != last_minute_ts) {
+        void *minute = (void *)(uintptr_t)minute_ts;
+        if (!job_pool_submit(JOB_PRIO_LOW, aggregate_job_run, NULL, minute)) {
+            aggregate_job_run(minute);
+        }
     }
+    last_minute_ts = minute_ts;
 
     /* Notify callback */
     if (user_callback) {
@@ -296,6 +326,10 @@ int vitals_provider_start(uint32_t vitals_interval_ms) {
     return 0;
 }
 
+void vitals_provider_tick(void) {
+    mock_data_tick();
+}
+
 void vitals_provider_stop(void) {
     mock_data_stop();
     provider_running = false;
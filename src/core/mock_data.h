@@ -3,8 +3,13 @@
  * @brief Mock sensor data generator for simulator development
  *
  * Produces realistic vital sign values using random walk with mean-reversion.
- * Uses LVGL timer for periodic updates. In production (Phase 6+), this module
- * is replaced by IPC subscriptions, but the callback interface is identical.
+ * Updates come from an LVGL timer, or from mock_data_tick() when the caller
+ * drives the rate (the simulator's data thread).  In production (Phase 6+),
+ * this module is replaced by IPC subscriptions, but the callback interface
+ * is identical.
+ *
+ * The generator state and current snapshot belong to the thread that ticks;
+ * other threads read current values from status_board.
  *
  * NOTE: This header uses types from vitals_provider.h as the canonical source.
  */
@@ -25,9 +30,15 @@ typedef void (*mock_data_cb_t)(const vitals_data_t *data);
 /** Initialize the mock data generator (seeds RNG). */
 void mock_data_init(void);
 
-/** Start generating data at update_interval_ms (creates LVGL timer). */
+/**
+ * Start generating data at update_interval_ms (creates LVGL timer).
+ * 0: create no timer; the caller calls mock_data_tick() instead.
+ */
 void mock_data_start(uint32_t update_interval_ms);
 
+/** Generate one sample, store it and notify the callback. */
+void mock_data_tick(void);
+
 /** Stop generating data (deletes LVGL timer). */
 void mock_data_stop(void);
 
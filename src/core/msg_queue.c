@@ -0,0 +1,79 @@
+/**
+ * @file msg_queue.c
+ * @brief Bounded queue of fixed-size messages — mutex-guarded ring
+ *
+ * The copy in or out happens under the lock.  Messages are small (a few
+ * hundred bytes at most) and arrive at tens per second, so the lock is
+ * held for well under a microsecond.
+ */
+
+#include "msg_queue.h"
+#include <string.h>
+
+bool msg_queue_init(msg_queue_t *q, void *storage, size_t msg_size,
+                    uint16_t capacity) {
+    if (!q || !storage || msg_size == 0 || capacity == 0) return false;
+    memset(q, 0, sizeof(*q));
+    pthread_mutex_init(&q->lock, NULL);
+    q->buf = (uint8_t *)storage;
+    q->msg_size = msg_size;
+    q->capacity = capacity;
+    return true;
+}
+
+void msg_queue_destroy(msg_queue_t *q) {
+    if (!q || !q->buf) return;
+    pthread_mutex_destroy(&q->lock);
+    q->buf = NULL;
+    q->count = 0;
+}
+
+bool msg_queue_push(msg_queue_t *q, const void *msg) {
+    if (!q || !q->buf || !msg) return false;
+    pthread_mutex_lock(&q->lock);
+    if (q->count == q->capacity) {
+        q->stats.dropped++;
+        pthread_mutex_unlock(&q->lock);
+        return false;
+    }
+    uint16_t tail = (uint16_t)((q->head + q->count) % q->capacity);
+    memcpy(q->buf + (size_t)tail * q->msg_size, msg, q->msg_size);
+    q->count++;
+    q->stats.pushed++;
+    if (q->count > q->stats.high_water) q->stats.high_water = q->count;
+    pthread_mutex_unlock(&q->lock);
+    return true;
+}
+
+bool msg_queue_pop(msg_queue_t *q, void *out) {
+    if (!q || !q->buf || !out) return false;
+    pthread_mutex_lock(&q->lock);
+    if (q->count == 0) {
+        pthread_mutex_unlock(&q->lock);
+        return false;
+    }
+    memcpy(out, q->buf + (size_t)q->head * q->msg_size, q->msg_size);
+    q->head = (uint16_t)((q->head + 1) % q->capacity);
+    q->count--;
+    q->stats.popped++;
+    pthread_mutex_unlock(&q->lock);
+    return true;
+}
+
+int msg_queue_count(msg_queue_t *q) {
+    if (!q || !q->buf) return 0;
+    pthread_mutex_lock(&q->lock);
+    int n = q->count;
+    pthread_mutex_unlock(&q->lock);
+    return n;
+}
+
+msg_queue_stats_t msg_queue_get_stats(msg_queue_t *q) {
+    msg_queue_stats_t s;
+    memset(&s, 0, sizeof(s));
+    if (!q || !q->buf) return s;
+    pthread_mutex_lock(&q->lock);
+    s = q->stats;
+    pthread_mutex_unlock(&q->lock);
+    return s;
+}
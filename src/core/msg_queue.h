@@ -0,0 +1,86 @@
+/**
+ * @file msg_queue.h
+ * @brief Bounded queue of fixed-size messages between threads
+ *
+ * Carries requests from the render thread to the data thread and results
+ * back (see data_thread.h).  Messages are copied in and out by value, so
+ * sender and receiver never share a buffer.  Any number of threads may
+ * push; one thread pops.
+ *
+ * A full queue rejects the push (counted in the stats) instead of
+ * blocking: the data thread must never wait on a stalled renderer, nor
+ * the renderer on storage.  Size queues for the longest stall to ride
+ * out and check `dropped`.
+ *
+ * Storage is supplied by the caller, so queues are statically allocated.
+ * No LVGL dependency.
+ */
+
+#ifndef MSG_QUEUE_H
+#define MSG_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ── Types ─────────────────────────────────────────────────── */
+
+typedef struct {
+    uint32_t pushed;
+    uint32_t popped;
+    uint32_t dropped;           /* Pushes rejected because the queue was full */
+    uint16_t high_water;        /* Most messages waiting at once */
+} msg_queue_stats_t;
+
+/** Queue state; treat as opaque. */
+typedef struct {
+    pthread_mutex_t   lock;
+    uint8_t          *buf;
+    size_t            msg_size;
+    uint16_t          capacity;
+    uint16_t          head;
+    uint16_t          count;
+    msg_queue_stats_t stats;
+} msg_queue_t;
+
+/* ── API ───────────────────────────────────────────────────── */
+
+/**
+ * Set up an empty queue over `storage` (capacity * msg_size bytes, owned
+ * by the caller and outliving the queue).
+ * @return false if an argument is zero or NULL.
+ */
+bool msg_queue_init(msg_queue_t *q, void *storage, size_t msg_size,
+                    uint16_t capacity);
+
+/** Release the lock; queued messages are discarded. */
+void msg_queue_destroy(msg_queue_t *q);
+
+/**
+ * Copy `msg` (msg_size bytes) onto the tail.  Any thread.
+ * @return false if the queue is full (the message is dropped).
+ */
+bool msg_queue_push(msg_queue_t *q, const void *msg);
+
+/**
+ * Copy the head message into `out` and remove it.  Consumer thread only.
+ * @return false if the queue is empty.
+ */
+bool msg_queue_pop(msg_queue_t *q, void *out);
+
+/** Messages waiting. */
+int msg_queue_count(msg_queue_t *q);
+
+/** Counters since msg_queue_init(). */
+msg_queue_stats_t msg_queue_get_stats(msg_queue_t *q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MSG_QUEUE_H */
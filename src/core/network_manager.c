@@ -9,9 +9,9 @@
  */
 
 #include "network_manager.h"
+#include "vclock.h"
 #include <stdio.h>
 #include <string.h>
-#include <time.h>
 
 /* ── Module state ────────────────────────────────────────── */
 
@@ -91,7 +91,7 @@ bool network_manager_wifi_connect(const char *ssid, const char *password) {
     strncpy(state.ip_address, "192.168.1.42", sizeof(state.ip_address) - 1);
     state.ip_address[sizeof(state.ip_address) - 1] = '\0';
     state.internet_reachable = true;
-    state.last_connected_ts  = (uint32_t)time(NULL);
+    state.last_connected_ts  = (uint32_t)vclock_wall_s();
 
     printf("[network_manager] Connected to '%s' (mock)\n", state.ssid);
     return true;
@@ -119,7 +119,7 @@ void network_manager_set_mock_status(net_status_t status_val) {
     if (status_val == NET_STATUS_CONNECTED) {
         state.internet_reachable = true;
         state.signal_strength    = -50;
-        state.last_connected_ts  = (uint32_t)time(NULL);
+        state.last_connected_ts  = (uint32_t)vclock_wall_s();
         if (state.ip_address[0] == '\0') {
             strncpy(state.ip_address, "192.168.1.42",
                     sizeof(state.ip_address) - 1);
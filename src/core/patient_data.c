@@ -9,10 +9,11 @@
  */
 
 #include "patient_data.h"
+#include "db_schema.h"
+#include "vclock.h"
 #include "sqlite3.h"
 #include <stdio.h>
 #include <string.h>
-#include <time.h>
 
 /* ── Stringification helpers (for LIMIT clause) ──────────────── */
 
@@ -193,7 +194,7 @@ static void seed_default_patient(void) {
     strncpy(def.allergies,  "Penicillin, Sulfonamides",           PATIENT_NOTES_MAX - 1);
     strncpy(def.diagnosis,  "Post-operative cardiac monitoring",  PATIENT_NOTES_MAX - 1);
     strncpy(def.notes,      "Stable condition, continue monitoring", PATIENT_NOTES_MAX - 1);
-    def.admitted_ts  = (uint32_t)time(NULL);
+    def.admitted_ts  = (uint32_t)vclock_wall_s();
     def.active       = true;
     def.monitor_slot = 0;
 
@@ -220,12 +221,8 @@ bool patient_data_init(const char *db_path) {
     sqlite3_exec(db, "PRAGMA journal_mode=WAL;", NULL, NULL, NULL);
     sqlite3_exec(db, "PRAGMA synchronous=NORMAL;", NULL, NULL, NULL);
 
-    /* Create table */
-    char *err_msg = NULL;
-    rc = sqlite3_exec(db, SCHEMA_SQL, NULL, NULL, &err_msg);
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "[patient_data] Schema creation failed: %s\n", err_msg);
-        sqlite3_free(err_msg);
+    /* Create table (skipped once the file is stamped current) */
+    if (!db_schema_ensure(db, DB_SCHEMA_PATIENT, SCHEMA_SQL, "patient_data")) {
         sqlite3_close(db);
         db = NULL;
         return false;
@@ -537,7 +534,7 @@ void patient_data_create_default(patient_t *out) {
 bool patient_data_admit(patient_t *patient) {
     if (!patient) return false;
 
-    patient->admitted_ts   = (uint32_t)time(NULL);
+    patient->admitted_ts   = (uint32_t)vclock_wall_s();
     patient->discharged_ts = 0;
     patient->active        = true;
 
@@ -554,7 +551,7 @@ bool patient_data_discharge(int32_t patient_id) {
         return false;
     }
 
-    p.discharged_ts = (uint32_t)time(NULL);
+    p.discharged_ts = (uint32_t)vclock_wall_s();
     p.active        = false;
 
     /* Clear from monitor slot cache */
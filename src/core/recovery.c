@@ -0,0 +1,203 @@
+/**
+ * @file recovery.c
+ * @brief Crash recovery: bounded WAL, clean-shutdown marker, state snapshot
+ *
+ * The snapshot is captured on the data thread (the alarm engine is not
+ * thread-safe) into `job_snap`, which the worker then owns until it
+ * clears `job_busy`.  One write is in flight at a time, so the worker
+ * and recovery_save_now() never share the temporary file.  `job_busy` is
+ * cleared by the worker itself rather than a completion, which would only
+ * run on the render thread.
+ */
+
+#include "recovery.h"
+#include "job_pool.h"
+#include "crc32.h"
+#include "vclock.h"
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/* ── Module state ────────────────────────────────────────── */
+
+static char              snap_path[RECOVERY_PATH_MAX];
+static char              tmp_path[RECOVERY_PATH_MAX + 8];
+static bool              active = false;
+static uint32_t          seq = 0;
+static recovery_report_t report;
+
+/* Captured on the data thread, written by the worker */
+static recovery_snapshot_t job_snap;
+static bool                job_busy = false;     /* __atomic */
+
+/* ── Helpers ─────────────────────────────────────────────── */
+
+static uint32_t snapshot_crc(const recovery_snapshot_t *s) {
+    return crc32_update(0, s, offsetof(recovery_snapshot_t, crc));
+}
+
+static void capture(recovery_snapshot_t *s, uint16_t flags) {
+    memset(s, 0, sizeof(*s));
+    s->magic   = RECOVERY_MAGIC;
+    s->version = RECOVERY_VERSION;
+    s->flags   = flags;
+    s->size    = (uint32_t)sizeof(*s);
+    s->seq     = ++seq;
+    s->wall_s  = vclock_wall_s();
+    alarm_engine_save(&s->alarms);
+    for (uint8_t slot = 0; slot < TREND_DB_SLOTS; slot++) {
+        trend_db_get_pending(slot, &s->pending[slot]);
+    }
+    s->crc = snapshot_crc(s);
+}
+
+/** Replace the snapshot file: write a temporary copy, fsync, rename. */
+static bool write_snapshot(const recovery_snapshot_t *s) {
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "[recovery] Cannot create %s\n", tmp_path);
+        return false;
+    }
+    bool ok = write(fd, s, sizeof(*s)) == (ssize_t)sizeof(*s) &&
+              fsync(fd) == 0;
+    close(fd);
+    if (!ok || rename(tmp_path, snap_path) != 0) {
+        fprintf(stderr, "[recovery] Cannot write %s\n", snap_path);
+        unlink(tmp_path);
+        return false;
+    }
+    return true;
+}
+
+static bool read_snapshot(recovery_snapshot_t *s) {
+    FILE *f = fopen(snap_path, "rb");
+    if (!f) return false;
+    size_t n = fread(s, 1, sizeof(*s), f);
+    fclose(f);
+
+    if (n != sizeof(*s) || s->magic != RECOVERY_MAGIC ||
+        s->version != RECOVERY_VERSION || s->size != sizeof(*s) ||
+        s->crc != snapshot_crc(s)) {
+        fprintf(stderr, "[recovery] Ignoring invalid snapshot %s\n",
+                snap_path);
+        return false;
+    }
+    return true;
+}
+
+/** PASSIVE checkpoint, or TRUNCATE once the WAL is over its bound. */
+static void bound_wal(void) {
+    trend_db_storage_t st;
+    if (!trend_db_get_storage(&st)) return;
+    trend_db_checkpoint(st.wal_bytes > RECOVERY_WAL_MAX_BYTES);
+}
+
+/* ── Periodic job ────────────────────────────────────────── */
+
+static void tick_run(void *arg) {
+    (void)arg;
+    write_snapshot(&job_snap);
+    bound_wal();
+    __atomic_store_n(&job_busy, false, __ATOMIC_RELEASE);
+}
+
+static bool busy(void) {
+    return __atomic_load_n(&job_busy, __ATOMIC_ACQUIRE);
+}
+
+/* ── Public API ──────────────────────────────────────────── */
+
+bool recovery_init(const char *snapshot_path) {
+    uint64_t t0 = vclock_real_us();
+    memset(&report, 0, sizeof(report));
+    active = false;
+    if (!snapshot_path || strlen(snapshot_path) >= RECOVERY_PATH_MAX) {
+        return false;
+    }
+    strcpy(snap_path, snapshot_path);
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", snapshot_path);
+
+    trend_db_storage_t st;
+    if (trend_db_get_storage(&st)) report.wal_bytes = st.wal_bytes;
+
+    static recovery_snapshot_t prev;
+    if (read_snapshot(&prev)) {
+        report.found = true;
+        report.clean = (prev.flags & RECOVERY_FLAG_CLEAN) != 0;
+        int64_t age = vclock_wall_s() - prev.wall_s;
+        report.outage_s = age <= 0 ? 0 :
+                          age > (int64_t)UINT32_MAX ? UINT32_MAX : (uint32_t)age;
+
+        if (!report.clean) {
+            for (int s = 0; s < TREND_DB_SLOTS; s++) {
+                if (trend_db_restore_pending(&prev.pending[s])) {
+                    report.minutes_restored++;
+                }
+            }
+            if (report.outage_s <= RECOVERY_MAX_OUTAGE_S) {
+                alarm_engine_restore(&prev.alarms, report.outage_s);
+                report.alarms_restored = true;
+            }
+        }
+    }
+
+    /* From here on, a crash leaves a snapshot without the clean flag */
+    seq = 0;
+    active = true;
+    static recovery_snapshot_t cur;
+    capture(&cur, 0);
+    bool ok = write_snapshot(&cur);
+
+    report.restore_us = (uint32_t)(vclock_real_us() - t0);
+    if (!report.found) {
+        printf("[recovery] No snapshot, fresh start\n");
+    } else if (report.clean) {
+        printf("[recovery] Clean shutdown %us ago, WAL %llu KB\n",
+               (unsigned)report.outage_s,
+               (unsigned long long)(report.wal_bytes / 1024));
+    } else {
+        printf("[recovery] Unclean stop %us ago: WAL %llu KB, %d minute(s) "
+               "and %s restored in %u us\n",
+               (unsigned)report.outage_s,
+               (unsigned long long)(report.wal_bytes / 1024),
+               report.minutes_restored,
+               report.alarms_restored ? "alarm state" : "no alarm state",
+               (unsigned)report.restore_us);
+    }
+    return ok;
+}
+
+void recovery_tick(void) {
+    if (!active || busy()) return;
+    capture(&job_snap, 0);
+    __atomic_store_n(&job_busy, true, __ATOMIC_RELAXED);
+    if (!job_pool_submit(JOB_PRIO_LOW, tick_run, NULL, NULL)) {
+        __atomic_store_n(&job_busy, false, __ATOMIC_RELAXED);
+    }
+}
+
+bool recovery_save_now(void) {
+    if (!active || busy()) return false;
+    static recovery_snapshot_t snap;
+    capture(&snap, 0);
+    return write_snapshot(&snap);
+}
+
+void recovery_shutdown(void) {
+    if (!active) return;
+    trend_db_checkpoint(true);
+
+    static recovery_snapshot_t snap;
+    capture(&snap, RECOVERY_FLAG_CLEAN);
+    if (write_snapshot(&snap)) {
+        printf("[recovery] Clean shutdown recorded\n");
+    }
+    active = false;
+    __atomic_store_n(&job_busy, false, __ATOMIC_RELAXED);
+}
+
+const recovery_report_t *recovery_get_report(void) {
+    return &report;
+}
@@ -0,0 +1,112 @@
+/**
+ * @file recovery.h
+ * @brief Crash recovery: bounded WAL, clean-shutdown marker, state snapshot
+ *
+ * With synchronous=NORMAL a power cut loses nothing that was committed,
+ * but whatever sits in the WAL is replayed on the next open, so an
+ * unbounded WAL means an unbounded boot delay.  State that only lives in
+ * memory (alarm engine, the partial raw minute per slot) is lost outright.
+ * This module bounds the first and saves the second:
+ *
+ *   - Every RECOVERY_TICK_MS, recovery_tick() captures a small snapshot
+ *     (alarm states, limits and timers; each slot's partial minute) and
+ *     a job_pool worker writes it atomically (tmp file, fsync, rename) and
+ *     checkpoints the WAL: PASSIVE normally, TRUNCATE once it has grown
+ *     past RECOVERY_WAL_MAX_BYTES.
+ *   - recovery_shutdown() truncates the WAL and writes the snapshot with
+ *     the clean flag set.  Any other snapshot on disk means the previous
+ *     run did not shut down cleanly.
+ *   - recovery_init() reads the snapshot at boot.  After an unclean stop
+ *     it writes the saved partial minutes back into trend_db and, if the
+ *     outage was no longer than RECOVERY_MAX_OUTAGE_S, restores the alarm
+ *     engine, instead of rebuilding either from the tables.  It then
+ *     marks the new run as not yet cleanly stopped.
+ *
+ * At most RECOVERY_TICK_MS of samples and alarm actions are lost.
+ *
+ * Call everything from the thread that runs the alarm engine (the data
+ * thread, see data_thread.h), after trend_db_init(), alarm_engine_init()
+ * and the slot bindings.
+ */
+
+#ifndef RECOVERY_H
+#define RECOVERY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "alarm_engine.h"
+#include "trend_db.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ── Constants ─────────────────────────────────────────────── */
+
+#define RECOVERY_PATH_MAX       128
+#define RECOVERY_TICK_MS        5000
+#define RECOVERY_WAL_MAX_BYTES  (256u * 1024u)
+
+/* Longer outages start with default alarm state (IEC 60601-1-8 keeps
+ * alarm settings across interruptions of 30 s or less) */
+#define RECOVERY_MAX_OUTAGE_S   30
+
+#define RECOVERY_MAGIC          0x43524D56u     /* "VMRC" */
+#define RECOVERY_VERSION        1
+#define RECOVERY_FLAG_CLEAN     0x0001u
+
+/* ── Types ─────────────────────────────────────────────────── */
+
+/** Snapshot file layout (host byte order; bump RECOVERY_VERSION on change). */
+typedef struct {
+    uint32_t                magic;
+    uint16_t                version;
+    uint16_t                flags;
+    uint32_t                size;           /* sizeof(recovery_snapshot_t) */
+    uint32_t                seq;            /* Snapshots written this run */
+    int64_t                 wall_s;         /* time() when written */
+    alarm_engine_snapshot_t alarms;
+    trend_db_pending_t      pending[TREND_DB_SLOTS];
+    uint32_t                crc;            /* CRC-32 of everything above */
+} recovery_snapshot_t;
+
+/** What recovery_init() found and did. */
+typedef struct {
+    bool     found;             /* A valid snapshot was read */
+    bool     clean;             /* ...written by a clean shutdown */
+    uint32_t outage_s;          /* Snapshot age at boot */
+    bool     alarms_restored;
+    int      minutes_restored;  /* Partial minutes written back */
+    uint64_t wal_bytes;         /* WAL size at recovery_init() */
+    uint32_t restore_us;        /* Time spent in recovery_init() */
+} recovery_report_t;
+
+/* ── API (alarm engine's thread) ───────────────────────────── */
+
+/**
+ * Read `snapshot_path`, restore after an unclean stop, then write a
+ * snapshot of the current state without the clean flag.
+ * @return false if the new snapshot cannot be written.
+ */
+bool recovery_init(const char *snapshot_path);
+
+/** Periodic snapshot and checkpoint (from a RECOVERY_TICK_MS timer). */
+void recovery_tick(void);
+
+/** Write a snapshot now, on the calling thread.  @return false on error. */
+bool recovery_save_now(void);
+
+/**
+ * Truncate the WAL and write the clean-shutdown snapshot.  Call after
+ * job_pool_deinit() and before trend_db_close().
+ */
+void recovery_shutdown(void);
+
+/** Result of the last recovery_init(). */
+const recovery_report_t *recovery_get_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RECOVERY_H */
@@ -0,0 +1,379 @@
+/**
+ * @file screen_stream.c
+ * @brief Remote view — tile hashes, dirty bitmap, non-blocking TCP sender
+ *
+ * hash[] holds, per tile, the hash of the pixels last packed for the
+ * viewer.  capture() marks tiles of the redrawn area whose hash now
+ * differs; frame_end() packs marked tiles (rehashing them) into out[]
+ * starting at a rotating cursor, so a frame that does not fit leaves the
+ * rest for the next one without starving any part of the screen.
+ */
+
+#include "screen_stream.h"
+#include "vclock.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0          /* macOS: SO_NOSIGPIPE is set instead */
+#endif
+
+/* Per tile in a FRAME: column, row, length */
+#define TILE_HDR_BYTES  4
+#define FRAME_HDR_BYTES 6
+
+/* ── Helpers ─────────────────────────────────────────────── */
+
+static uint8_t *put16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    return p + 2;
+}
+
+static uint8_t *put32(uint8_t *p, uint32_t v) {
+    p = put16(p, (uint16_t)v);
+    return put16(p, (uint16_t)(v >> 16));
+}
+
+static uint16_t get16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get32(const uint8_t *p) {
+    return get16(p) | ((uint32_t)get16(p + 2) << 16);
+}
+
+static bool is_dirty(const screen_stream_t *s, uint32_t i) {
+    return (s->dirty[i / 8] >> (i % 8)) & 1;
+}
+
+static void set_dirty(screen_stream_t *s, uint32_t i, bool on) {
+    if (on) s->dirty[i / 8] |= (uint8_t)(1u << (i % 8));
+    else s->dirty[i / 8] &= (uint8_t)~(1u << (i % 8));
+}
+
+static int tile_w(const screen_stream_t *s, uint32_t col) {
+    int w = s->width - (int)col * TILE_SIZE;
+    return w < TILE_SIZE ? w : TILE_SIZE;
+}
+
+static int tile_h(const screen_stream_t *s, uint32_t row) {
+    int h = s->height - (int)row * TILE_SIZE;
+    return h < TILE_SIZE ? h : TILE_SIZE;
+}
+
+/** FNV-1a over a tile's pixels. */
+static uint32_t hash_tile(const screen_stream_t *s, const uint32_t *fb, size_t stride,
+                          uint32_t col, uint32_t row) {
+    const uint32_t *px = fb + (size_t)row * TILE_SIZE * stride + col * TILE_SIZE;
+    int w = tile_w(s, col);
+    int h = tile_h(s, row);
+    uint32_t hash = 2166136261u;
+    for (int y = 0; y < h; y++, px += stride) {
+        for (int x = 0; x < w; x++) {
+            hash ^= px[x];
+            hash *= 16777619u;
+        }
+    }
+    return hash;
+}
+
+static void set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags >= 0) fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+#ifdef SO_NOSIGPIPE
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+}
+
+static uint8_t *put_header(uint8_t *p, uint8_t type, uint32_t payload_len) {
+    p = put16(p, SCREEN_STREAM_MAGIC);
+    *p++ = type;
+    *p++ = 0;
+    return put32(p, payload_len);
+}
+
+static void detach(screen_stream_t *s) {
+    if (s->client_fd < 0) return;
+    close(s->client_fd);
+    s->client_fd = -1;
+    s->out_len = s->out_sent = 0;
+    s->stats.connected_us += vclock_real_us() - s->attached_at_us;
+    printf("[screen_stream] Viewer disconnected\n");
+}
+
+/** Write what the socket takes; false if the viewer is gone. */
+static bool send_pending(screen_stream_t *s) {
+    while (s->out_sent < s->out_len) {
+        ssize_t n = send(s->client_fd, s->out + s->out_sent, s->out_len - s->out_sent,
+                         MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n > 0) {
+            s->out_sent += (size_t)n;
+            s->stats.bytes_sent += (uint64_t)n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true;
+        } else {
+            return false;
+        }
+    }
+    s->out_len = s->out_sent = 0;
+    return true;
+}
+
+/** Discard input; false once the viewer has closed its end. */
+static bool drain_input(screen_stream_t *s) {
+    uint8_t buf[256];
+    for (;;) {
+        ssize_t n = recv(s->client_fd, buf, sizeof(buf), MSG_DONTWAIT);
+        if (n > 0) continue;
+        if (n == 0) return false;
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+}
+
+/** Pack marked tiles into one FRAME message. */
+static void pack_frame(screen_stream_t *s, const uint32_t *fb, size_t stride) {
+    uint32_t total = (uint32_t)s->cols * s->rows;
+    uint8_t *p = s->out + SCREEN_STREAM_HDR_BYTES + FRAME_HDR_BYTES;
+    uint8_t *end = s->out + sizeof(s->out);
+    uint16_t tiles = 0;
+    uint32_t i = s->pack_next;
+
+    for (uint32_t n = 0; n < total; n++, i = (i + 1) % total) {
+        if (!is_dirty(s, i)) continue;
+        if (end - p < (ptrdiff_t)(TILE_HDR_BYTES + TILE_CODEC_MAX_BYTES)) break;
+
+        uint32_t col = i % s->cols;
+        uint32_t row = i / s->cols;
+        const uint32_t *px = fb + (size_t)row * TILE_SIZE * stride + col * TILE_SIZE;
+        size_t len = tile_encode(px, stride, tile_w(s, col), tile_h(s, row),
+                                 p + TILE_HDR_BYTES);
+        p[0] = (uint8_t)col;
+        p[1] = (uint8_t)row;
+        put16(p + 2, (uint16_t)len);
+        p += TILE_HDR_BYTES + len;
+
+        s->hash[i] = hash_tile(s, fb, stride, col, row);
+        set_dirty(s, i, false);
+        tiles++;
+    }
+    s->pack_next = i;
+    if (tiles == 0) return;
+
+    size_t payload = (size_t)(p - s->out) - SCREEN_STREAM_HDR_BYTES;
+    uint8_t *h = put_header(s->out, SCREEN_STREAM_MSG_FRAME, (uint32_t)payload);
+    h = put32(h, s->frame);
+    put16(h, tiles);
+    s->out_len = (size_t)(p - s->out);
+    s->out_sent = 0;
+    s->stats.frames_sent++;
+    s->stats.tiles_sent += tiles;
+}
+
+/* ── Sender API ──────────────────────────────────────────── */
+
+bool screen_stream_init(screen_stream_t *s, uint16_t width, uint16_t height) {
+    memset(s, 0, sizeof(*s));
+    s->listen_fd = s->client_fd = -1;
+    if (width == 0 || height == 0 ||
+        width > SCREEN_STREAM_MAX_WIDTH || height > SCREEN_STREAM_MAX_HEIGHT) {
+        return false;
+    }
+    s->width = width;
+    s->height = height;
+    s->cols = (uint16_t)((width + TILE_SIZE - 1) / TILE_SIZE);
+    s->rows = (uint16_t)((height + TILE_SIZE - 1) / TILE_SIZE);
+    latency_hist_reset(&s->capture_hist);
+    return true;
+}
+
+bool screen_stream_listen(screen_stream_t *s, const char *addr, uint16_t port) {
+    struct sockaddr_in sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(port);
+    if (inet_pton(AF_INET, addr, &sa.sin_addr) != 1) {
+        printf("[screen_stream] Bad address %s\n", addr);
+        return false;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(fd, (struct sockaddr *)&sa, sizeof(sa)) < 0 || listen(fd, 1) < 0) {
+        printf("[screen_stream] Cannot listen on %s:%u: %s\n", addr, port, strerror(errno));
+        close(fd);
+        return false;
+    }
+    set_nonblocking(fd);
+    s->listen_fd = fd;
+    printf("[screen_stream] Remote view on %s:%u\n", addr, port);
+    return true;
+}
+
+void screen_stream_attach(screen_stream_t *s, int fd) {
+    detach(s);
+    set_nonblocking(fd);
+    s->client_fd = fd;
+    s->attached_at_us = vclock_real_us();
+    s->stats.connects++;
+
+    /* Everything is new to this viewer */
+    memset(s->dirty, 0, sizeof(s->dirty));
+    for (uint32_t i = 0; i < (uint32_t)s->cols * s->rows; i++) set_dirty(s, i, true);
+
+    uint8_t *p = put_header(s->out, SCREEN_STREAM_MSG_HELLO, SCREEN_STREAM_HELLO_BYTES);
+    p = put16(p, s->width);
+    p = put16(p, s->height);
+    *p++ = TILE_SIZE;
+    *p++ = SCREEN_STREAM_PIXEL_RGB565;
+    s->out_len = (size_t)(p - s->out);
+    s->out_sent = 0;
+    if (!send_pending(s)) detach(s);
+}
+
+void screen_stream_capture(screen_stream_t *s, const uint32_t *fb, size_t stride,
+                           int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
+    if (s->client_fd < 0) return;
+    uint64_t t0 = vclock_real_us();
+
+    if (x1 < 0) x1 = 0;
+    if (y1 < 0) y1 = 0;
+    if (x2 >= s->width) x2 = s->width - 1;
+    if (y2 >= s->height) y2 = s->height - 1;
+
+    for (int32_t row = y1 / TILE_SIZE; row <= y2 / TILE_SIZE && y1 <= y2; row++) {
+        for (int32_t col = x1 / TILE_SIZE; col <= x2 / TILE_SIZE && x1 <= x2; col++) {
+            uint32_t i = (uint32_t)row * s->cols + (uint32_t)col;
+            if (is_dirty(s, i)) continue;
+            if (hash_tile(s, fb, stride, (uint32_t)col, (uint32_t)row) != s->hash[i]) {
+                set_dirty(s, i, true);
+            }
+        }
+    }
+    s->frame_us += vclock_real_us() - t0;
+}
+
+void screen_stream_frame_end(screen_stream_t *s, const uint32_t *fb, size_t stride) {
+    uint64_t t0 = vclock_real_us();
+
+    if (s->listen_fd >= 0) {
+        int fd = accept(s->listen_fd, NULL, NULL);
+        if (fd >= 0) {
+            printf("[screen_stream] Viewer connected\n");
+            screen_stream_attach(s, fd);
+        }
+    }
+    if (s->client_fd < 0) {
+        s->frame_us = 0;
+        return;
+    }
+
+    s->frame++;
+    s->stats.frames++;
+    if (!drain_input(s) || !send_pending(s)) {
+        detach(s);
+        s->frame_us = 0;
+        return;
+    }
+
+    /* Previous frame gone: pack this one, repairing a few tiles */
+    if (s->out_len == 0) {
+        uint32_t total = (uint32_t)s->cols * s->rows;
+        for (int k = 0; k < SCREEN_STREAM_REFRESH_TILES; k++) {
+            set_dirty(s, s->refresh_next, true);
+            s->refresh_next = (s->refresh_next + 1) % total;
+        }
+        pack_frame(s, fb, stride);
+        if (!send_pending(s)) detach(s);
+    }
+
+    uint64_t us = s->frame_us + (vclock_real_us() - t0);
+    latency_hist_add(&s->capture_hist, (uint32_t)us);
+    if (us > SCREEN_STREAM_BUDGET_US) s->stats.over_budget++;
+    s->frame_us = 0;
+}
+
+bool screen_stream_connected(const screen_stream_t *s) {
+    return s->client_fd >= 0;
+}
+
+screen_stream_stats_t screen_stream_get_stats(const screen_stream_t *s) {
+    screen_stream_stats_t st = s->stats;
+    if (s->client_fd >= 0) st.connected_us += vclock_real_us() - s->attached_at_us;
+    return st;
+}
+
+void screen_stream_print(const screen_stream_t *s, const char *tag) {
+    screen_stream_stats_t st = screen_stream_get_stats(s);
+    latency_hist_print(&s->capture_hist, tag, "stream capture");
+
+    double secs = st.connected_us / 1e6;
+    printf("[%s] stream %u frames sent, %.1f tiles/frame, %.1f KB/s, "
+           "%u over %u us budget, %u connects\n", tag,
+           (unsigned)st.frames_sent,
+           st.frames_sent ? (double)st.tiles_sent / st.frames_sent : 0.0,
+           secs > 0 ? st.bytes_sent / 1024.0 / secs : 0.0,
+           (unsigned)st.over_budget, (unsigned)SCREEN_STREAM_BUDGET_US,
+           (unsigned)st.connects);
+}
+
+void screen_stream_close(screen_stream_t *s) {
+    detach(s);
+    if (s->listen_fd >= 0) {
+        close(s->listen_fd);
+        s->listen_fd = -1;
+    }
+}
+
+/* ── Viewer API ──────────────────────────────────────────── */
+
+bool screen_stream_parse_header(const uint8_t *hdr, uint8_t *type, uint32_t *payload_len) {
+    if (get16(hdr) != SCREEN_STREAM_MAGIC) return false;
+    *type = hdr[2];
+    *payload_len = get32(hdr + 4);
+    return *payload_len <= SCREEN_STREAM_OUT_BYTES - SCREEN_STREAM_HDR_BYTES;
+}
+
+bool screen_stream_parse_hello(const uint8_t *p, size_t len,
+                               uint16_t *width, uint16_t *height) {
+    if (len != SCREEN_STREAM_HELLO_BYTES) return false;
+    if (p[4] != TILE_SIZE || p[5] != SCREEN_STREAM_PIXEL_RGB565) return false;
+    *width = get16(p);
+    *height = get16(p + 2);
+    return *width > 0 && *height > 0 &&
+           *width <= SCREEN_STREAM_MAX_WIDTH && *height <= SCREEN_STREAM_MAX_HEIGHT;
+}
+
+int screen_stream_apply_frame(const uint8_t *p, size_t len, uint16_t *fb,
+                              uint16_t width, uint16_t height) {
+    if (len < FRAME_HDR_BYTES) return -1;
+    uint16_t tiles = get16(p + 4);
+    const uint8_t *end = p + len;
+    p += FRAME_HDR_BYTES;
+
+    for (uint16_t t = 0; t < tiles; t++) {
+        if (end - p < TILE_HDR_BYTES) return -1;
+        int x = p[0] * TILE_SIZE;
+        int y = p[1] * TILE_SIZE;
+        uint16_t n = get16(p + 2);
+        p += TILE_HDR_BYTES;
+        if (x >= width || y >= height || end - p < n) return -1;
+
+        int w = width - x < TILE_SIZE ? width - x : TILE_SIZE;
+        int h = height - y < TILE_SIZE ? height - y : TILE_SIZE;
+        if (!tile_decode(p, n, w, h, fb + (size_t)y * width + x, width)) return -1;
+        p += n;
+    }
+    return p == end ? tiles : -1;
+}
@@ -0,0 +1,176 @@
+/**
+ * @file screen_stream.h
+ * @brief Read-only remote view: changed screen tiles streamed over TCP
+ *
+ * Lets a charge nurse watch a bed's screen from the station.  At each
+ * flush the display driver reports the area LVGL redrew; the stream
+ * hashes the 16x16 tiles of that area and marks those that differ from
+ * what the viewer last received.  At the end of the frame the marked
+ * tiles are compressed (tile_codec.h) into one message and written to
+ * the viewer without blocking.  Static parts of the screen cost nothing
+ * once sent, so steady-state traffic is the waveform strips and the
+ * values that change.
+ *
+ * Backpressure: a frame is only packed once the previous one has left
+ * the socket; tiles that change meanwhile stay marked and go out with
+ * the next frame, so a slow link drops intermediate frames, never tiles.
+ * Tiles are also re-sent round-robin (SCREEN_STREAM_REFRESH_TILES per
+ * frame), which repairs a tile whose change a hash collision hid.
+ *
+ * The viewer cannot send anything back: bytes it sends are discarded.
+ * One viewer at a time; a new connection replaces the old one.
+ *
+ * Capture time (hashing, encoding, sending) is recorded per frame in a
+ * latency histogram; frames above SCREEN_STREAM_BUDGET_US are counted.
+ *
+ * Wire format (little-endian), each message an 8-byte header
+ *   u16 magic SCREEN_STREAM_MAGIC, u8 type, u8 0, u32 payload bytes
+ * followed by its payload:
+ *   HELLO  u16 width, u16 height, u8 TILE_SIZE, u8 SCREEN_STREAM_PIXEL_RGB565
+ *   FRAME  u32 frame number, u16 tile count, then per tile
+ *          u8 column, u8 row, u16 bytes, tile_encode() output
+ *
+ * Render thread only.  No LVGL dependency.
+ */
+
+#ifndef SCREEN_STREAM_H
+#define SCREEN_STREAM_H
+
+#include "tile_codec.h"
+#include "latency_hist.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ── Configuration ─────────────────────────────────────────── */
+
+#define SCREEN_STREAM_MAX_WIDTH     1024
+#define SCREEN_STREAM_MAX_HEIGHT    608
+#define SCREEN_STREAM_MAX_TILES     ((SCREEN_STREAM_MAX_WIDTH / TILE_SIZE) * \
+                                     (SCREEN_STREAM_MAX_HEIGHT / TILE_SIZE))
+#define SCREEN_STREAM_OUT_BYTES     (48 * 1024)     /* One frame message */
+#define SCREEN_STREAM_REFRESH_TILES 1               /* Re-sent per frame */
+#define SCREEN_STREAM_BUDGET_US     1000            /* Capture per frame */
+#define SCREEN_STREAM_DEFAULT_PORT  5990
+
+/* ── Wire format ───────────────────────────────────────────── */
+
+#define SCREEN_STREAM_MAGIC         0x5356          /* "VS" */
+#define SCREEN_STREAM_HDR_BYTES     8
+#define SCREEN_STREAM_HELLO_BYTES   6
+#define SCREEN_STREAM_PIXEL_RGB565  1
+
+typedef enum {
+    SCREEN_STREAM_MSG_HELLO = 1,
+    SCREEN_STREAM_MSG_FRAME = 2
+} screen_stream_msg_t;
+
+/* ── Types ─────────────────────────────────────────────────── */
+
+typedef struct {
+    uint32_t connects;
+    uint32_t frames;            /* Frames captured with a viewer attached */
+    uint32_t frames_sent;
+    uint32_t tiles_sent;
+    uint32_t over_budget;       /* Frames above SCREEN_STREAM_BUDGET_US */
+    uint64_t bytes_sent;
+    uint64_t connected_us;      /* Time with a viewer attached */
+} screen_stream_stats_t;
+
+/** Stream state; treat as opaque. */
+typedef struct {
+    uint16_t              width;
+    uint16_t              height;
+    uint16_t              cols;
+    uint16_t              rows;
+    int                   listen_fd;
+    int                   client_fd;
+    uint32_t              hash[SCREEN_STREAM_MAX_TILES];  /* As the viewer has it */
+    uint8_t               dirty[(SCREEN_STREAM_MAX_TILES + 7) / 8];
+    uint32_t              pack_next;                      /* Round-robin cursors */
+    uint32_t              refresh_next;
+    uint32_t              frame;
+    uint8_t               out[SCREEN_STREAM_OUT_BYTES];
+    size_t                out_len;
+    size_t                out_sent;
+    uint64_t              frame_us;                       /* Capture time so far */
+    uint64_t              attached_at_us;
+    latency_hist_t        capture_hist;
+    screen_stream_stats_t stats;
+} screen_stream_t;
+
+/* ── Sender ────────────────────────────────────────────────── */
+
+/**
+ * Set up a stream for a width x height XRGB8888 screen, not listening.
+ * @return false if the screen is larger than the SCREEN_STREAM_MAX_* sizes.
+ */
+bool screen_stream_init(screen_stream_t *s, uint16_t width, uint16_t height);
+
+/**
+ * Accept viewers on a TCP address, e.g. "127.0.0.1" (local viewer only).
+ * @return false if the socket cannot be bound.
+ */
+bool screen_stream_listen(screen_stream_t *s, const char *addr, uint16_t port);
+
+/**
+ * Send to an already connected socket (the stream owns it from now on),
+ * replacing any viewer.  Sends HELLO and then the whole screen.
+ */
+void screen_stream_attach(screen_stream_t *s, int fd);
+
+/**
+ * Report that LVGL redrew an area (inclusive coordinates).  Call from
+ * the flush callback, before the frame is shown.
+ * @param stride  Pixels per framebuffer row.
+ */
+void screen_stream_capture(screen_stream_t *s, const uint32_t *fb, size_t stride,
+                           int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+
+/**
+ * End of a rendered frame: accept a waiting viewer, pack the changed
+ * tiles and send what the socket takes.
+ */
+void screen_stream_frame_end(screen_stream_t *s, const uint32_t *fb, size_t stride);
+
+/** True while a viewer is attached. */
+bool screen_stream_connected(const screen_stream_t *s);
+
+/** Counters since screen_stream_init(). */
+screen_stream_stats_t screen_stream_get_stats(const screen_stream_t *s);
+
+/** Print capture time per frame and bandwidth. */
+void screen_stream_print(const screen_stream_t *s, const char *tag);
+
+/** Close the viewer and listening sockets. */
+void screen_stream_close(screen_stream_t *s);
+
+/* ── Viewer ────────────────────────────────────────────────── */
+
+/**
+ * Check a message header.
+ * @return false if the magic is wrong or the payload would not fit
+ *         SCREEN_STREAM_OUT_BYTES.
+ */
+bool screen_stream_parse_header(const uint8_t *hdr, uint8_t *type, uint32_t *payload_len);
+
+/** Screen size from a HELLO payload. */
+bool screen_stream_parse_hello(const uint8_t *p, size_t len,
+                               uint16_t *width, uint16_t *height);
+
+/**
+ * Apply a FRAME payload to an RGB565 copy of the screen.
+ * @return Tiles applied, or -1 if the payload is malformed.
+ */
+int screen_stream_apply_frame(const uint8_t *p, size_t len, uint16_t *fb,
+                              uint16_t width, uint16_t height);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SCREEN_STREAM_H */
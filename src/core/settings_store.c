@@ -9,6 +9,7 @@
  */
 
 #include "settings_store.h"
+#include "db_schema.h"
 #include "sqlite3.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -100,12 +101,8 @@ bool settings_store_init(const char *db_path) {
     sqlite3_exec(db, "PRAGMA journal_mode=WAL;", NULL, NULL, NULL);
     sqlite3_exec(db, "PRAGMA synchronous=NORMAL;", NULL, NULL, NULL);
 
-    /* Create table */
-    char *err_msg = NULL;
-    rc = sqlite3_exec(db, SCHEMA_SQL, NULL, NULL, &err_msg);
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "[settings] Schema creation failed: %s\n", err_msg);
-        sqlite3_free(err_msg);
+    /* Create table (skipped once the file is stamped current) */
+    if (!db_schema_ensure(db, DB_SCHEMA_SETTINGS, SCHEMA_SQL, "settings")) {
         sqlite3_close(db);
         db = NULL;
         return false;
@@ -0,0 +1,225 @@
+/**
+ * @file startup.c
+ * @brief Boot sequencing: dependency-ordered init steps and a startup timeline
+ *
+ * Steps are resolved by repeated passes over the table: a pass runs every
+ * pending step whose dependencies are all OK and skips every step with a
+ * failed or skipped dependency.  Passes stop when one makes no progress;
+ * whatever is still pending then belongs to a dependency cycle and is
+ * skipped.
+ */
+
+#include "startup.h"
+#include "vclock.h"
+#include <stdio.h>
+#include <string.h>
+
+/* ── Module state ────────────────────────────────────────── */
+
+static const startup_step_t *steps = NULL;
+static int                   step_count = 0;
+static startup_step_state_t  step_state[STARTUP_MAX_STEPS];
+static bool                  first_stage_run = false;
+
+static startup_event_t events[STARTUP_MAX_EVENTS];
+static int             event_count = 0;
+static uint64_t        t0_us = 0;
+
+/* ── Helpers ─────────────────────────────────────────────── */
+
+static uint32_t since_begin_us(void) {
+    return (uint32_t)(vclock_real_us() - t0_us);
+}
+
+static void add_event(const char *name, uint32_t start_us, uint32_t dur_us,
+                      startup_step_state_t state, bool milestone) {
+    if (event_count >= STARTUP_MAX_EVENTS) return;
+    startup_event_t *e = &events[event_count++];
+    e->name = name;
+    e->start_us = start_us;
+    e->dur_us = dur_us;
+    e->state = state;
+    e->milestone = milestone;
+}
+
+/** Mask of steps in any of the given states. */
+static uint32_t steps_in(startup_step_state_t a, startup_step_state_t b) {
+    uint32_t mask = 0;
+    for (int i = 0; i < step_count; i++) {
+        if (step_state[i] == a || step_state[i] == b) mask |= STARTUP_DEP(i);
+    }
+    return mask;
+}
+
+static void run_step(int i) {
+    uint32_t start = since_begin_us();
+    bool ok = steps[i].init ? steps[i].init() : true;
+    uint32_t dur = since_begin_us() - start;
+
+    step_state[i] = ok ? STARTUP_STEP_OK : STARTUP_STEP_FAILED;
+    add_event(steps[i].name, start, dur, step_state[i], false);
+    if (!ok) {
+        fprintf(stderr, "[startup] %s failed\n", steps[i].name);
+    }
+}
+
+static void skip_step(int i, const char *why) {
+    step_state[i] = STARTUP_STEP_SKIPPED;
+    add_event(steps[i].name, since_begin_us(), 0, STARTUP_STEP_SKIPPED, false);
+    fprintf(stderr, "[startup] %s skipped (%s)\n", steps[i].name, why);
+}
+
+/**
+ * One pass over the pending steps of `stage`.  With `single`, stops after
+ * the first step that ran.  @return Number of steps resolved.
+ */
+static int run_pass(startup_stage_t stage, bool single) {
+    int resolved = 0;
+    for (int i = 0; i < step_count; i++) {
+        if (steps[i].stage != stage || step_state[i] != STARTUP_STEP_PENDING) {
+            continue;
+        }
+        uint32_t bad = steps_in(STARTUP_STEP_FAILED, STARTUP_STEP_SKIPPED);
+        uint32_t ok  = steps_in(STARTUP_STEP_OK, STARTUP_STEP_OK);
+        if (steps[i].deps & bad) {
+            skip_step(i, "dependency failed");
+            resolved++;
+        } else if ((steps[i].deps & ok) == steps[i].deps) {
+            run_step(i);
+            resolved++;
+            if (single) break;
+        }
+    }
+    return resolved;
+}
+
+/** Skip whatever of `stage` no pass could resolve. */
+static void skip_cycles(startup_stage_t stage) {
+    for (int i = 0; i < step_count; i++) {
+        if (steps[i].stage == stage && step_state[i] == STARTUP_STEP_PENDING) {
+            skip_step(i, "dependency cycle");
+        }
+    }
+}
+
+/* ── Public API ──────────────────────────────────────────── */
+
+bool startup_begin(const startup_step_t *table, int count) {
+    t0_us = vclock_real_us();
+    event_count = 0;
+    first_stage_run = false;
+    steps = NULL;
+    step_count = 0;
+    memset(step_state, 0, sizeof(step_state));
+
+    if (!table || count < 0 || count > STARTUP_MAX_STEPS) return false;
+    for (int i = 0; i < count; i++) {
+        uint32_t deps = table[i].deps;
+        if (deps & STARTUP_DEP(i)) return false;
+        if ((deps >> count) != 0) return false;
+        for (int d = 0; d < count; d++) {
+            if ((deps & STARTUP_DEP(d)) &&
+                table[i].stage == STARTUP_STAGE_FIRST_FRAME &&
+                table[d].stage == STARTUP_STAGE_DEFERRED) {
+                return false;
+            }
+        }
+    }
+    steps = table;
+    step_count = count;
+    return true;
+}
+
+int startup_run_stage(startup_stage_t stage) {
+    if (stage == STARTUP_STAGE_DEFERRED && !first_stage_run) {
+        startup_run_stage(STARTUP_STAGE_FIRST_FRAME);
+    }
+    while (run_pass(stage, false) > 0) {}
+    skip_cycles(stage);
+    if (stage == STARTUP_STAGE_FIRST_FRAME) first_stage_run = true;
+
+    int failed = 0;
+    for (int i = 0; i < step_count; i++) {
+        if (steps[i].stage == stage && step_state[i] != STARTUP_STEP_OK) {
+            failed++;
+        }
+    }
+    return failed;
+}
+
+bool startup_run_next(void) {
+    if (!first_stage_run) return false;
+    for (;;) {
+        int before = event_count;
+        int resolved = run_pass(STARTUP_STAGE_DEFERRED, true);
+        if (resolved == 0) {
+            skip_cycles(STARTUP_STAGE_DEFERRED);
+            return false;
+        }
+        /* Skips alone do not count as this call's step */
+        for (int e = before; e < event_count; e++) {
+            if (events[e].state != STARTUP_STEP_SKIPPED) return true;
+        }
+    }
+}
+
+bool startup_done(void) {
+    if (!first_stage_run) return false;
+    for (int i = 0; i < step_count; i++) {
+        if (step_state[i] == STARTUP_STEP_PENDING) return false;
+    }
+    return true;
+}
+
+startup_step_state_t startup_step_state(int index) {
+    if (index < 0 || index >= step_count) return STARTUP_STEP_PENDING;
+    return step_state[index];
+}
+
+void startup_mark(const char *milestone) {
+    if (!milestone || startup_milestone_ms(milestone) >= 0) return;
+    add_event(milestone, since_begin_us(), 0, STARTUP_STEP_OK, true);
+}
+
+int32_t startup_milestone_ms(const char *name) {
+    for (int e = 0; e < event_count; e++) {
+        if (events[e].milestone && strcmp(events[e].name, name) == 0) {
+            return (int32_t)(events[e].start_us / 1000);
+        }
+    }
+    return -1;
+}
+
+uint32_t startup_elapsed_ms(void) {
+    return since_begin_us() / 1000;
+}
+
+int startup_events(const startup_event_t **out) {
+    if (out) *out = events;
+    return event_count;
+}
+
+void startup_report(void) {
+    static const char *state_names[] = { "pending", "ok", "FAILED", "skipped" };
+
+    printf("[startup] Timeline (ms since start):\n");
+    for (int e = 0; e < event_count; e++) {
+        const startup_event_t *ev = &events[e];
+        if (ev->milestone) {
+            printf("[startup]   %8.1f            * %s\n",
+                   ev->start_us / 1000.0, ev->name);
+        } else {
+            printf("[startup]   %8.1f  %7.1f   %s%s%s\n",
+                   ev->start_us / 1000.0, ev->dur_us / 1000.0, ev->name,
+                   ev->state == STARTUP_STEP_OK ? "" : " ",
+                   ev->state == STARTUP_STEP_OK ? "" : state_names[ev->state]);
+        }
+    }
+
+    int32_t vitals = startup_milestone_ms("first_vitals");
+    if (vitals >= 0) {
+        printf("[startup] First vitals at %d ms (budget %d ms)%s\n",
+               (int)vitals, STARTUP_FIRST_VITALS_BUDGET_MS,
+               vitals > STARTUP_FIRST_VITALS_BUDGET_MS ? " - OVER BUDGET" : "");
+    }
+}
@@ -0,0 +1,129 @@
+/**
+ * @file startup.h
+ * @brief Boot sequencing: dependency-ordered init steps and a startup timeline
+ *
+ * main() describes its initialisation as a table of steps.  Each step names
+ * the steps it depends on and a stage:
+ *
+ *   STARTUP_STAGE_FIRST_FRAME  Needed before vitals can be shown (display,
+ *                              trend_db, alarm engine, vitals provider).
+ *                              Run together by startup_run_stage().
+ *   STARTUP_STAGE_DEFERRED     Not needed for the first frame (audit log,
+ *                              auth users, sync queue, network).  Run one
+ *                              per startup_run_next() call from the main
+ *                              loop, so the UI keeps drawing in between.
+ *
+ * A step runs only once all its dependencies have succeeded; if one
+ * failed, the step is skipped and counts as failed for its own dependents.
+ * A first-frame step may not depend on a deferred one.
+ *
+ * Every step and every startup_mark() milestone ("first_frame",
+ * "first_vitals") is timed against startup_begin() and kept in a fixed
+ * table; startup_report() prints the timeline and the first-vitals time
+ * against STARTUP_FIRST_VITALS_BUDGET_MS.
+ *
+ * Single-threaded (LVGL main loop).  No heap, no LVGL dependency.
+ */
+
+#ifndef STARTUP_H
+#define STARTUP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ── Constants ─────────────────────────────────────────────── */
+
+#define STARTUP_MAX_STEPS       24
+#define STARTUP_MAX_EVENTS      32
+
+/* Power-on to first vitals on screen */
+#ifndef STARTUP_FIRST_VITALS_BUDGET_MS
+#define STARTUP_FIRST_VITALS_BUDGET_MS  2000
+#endif
+
+/** Dependency bit for step index `i` of the table. */
+#define STARTUP_DEP(i)          (1u << (i))
+
+/* ── Types ─────────────────────────────────────────────────── */
+
+typedef enum {
+    STARTUP_STAGE_FIRST_FRAME = 0,
+    STARTUP_STAGE_DEFERRED,
+} startup_stage_t;
+
+typedef enum {
+    STARTUP_STEP_PENDING = 0,
+    STARTUP_STEP_OK,
+    STARTUP_STEP_FAILED,
+    STARTUP_STEP_SKIPPED,       /* A dependency failed */
+} startup_step_state_t;
+
+/** One init step.  `init` returns false on failure. */
+typedef struct {
+    const char      *name;
+    bool           (*init)(void);
+    uint32_t         deps;      /* STARTUP_DEP() bits of other steps */
+    startup_stage_t  stage;
+} startup_step_t;
+
+/** One timeline entry: a finished step or a milestone. */
+typedef struct {
+    const char *name;
+    uint32_t    start_us;       /* Since startup_begin() */
+    uint32_t    dur_us;         /* 0 for milestones */
+    startup_step_state_t state; /* STARTUP_STEP_OK for milestones */
+    bool        milestone;
+} startup_event_t;
+
+/* ── API ───────────────────────────────────────────────────── */
+
+/**
+ * Start the clock and take the step table (kept by reference).
+ * @return false if the table is too long or a dependency is invalid
+ *         (out of range, itself, or a first-frame step on a deferred one).
+ */
+bool startup_begin(const startup_step_t *steps, int count);
+
+/**
+ * Run every pending step of `stage` whose dependencies allow it, in
+ * dependency order.  For the deferred stage this runs all that remain.
+ * @return Number of steps that failed or were skipped.
+ */
+int startup_run_stage(startup_stage_t stage);
+
+/**
+ * Run the next pending deferred step (only after the first-frame stage).
+ * @return false once no deferred step is left.
+ */
+bool startup_run_next(void);
+
+/** True once every step has run, failed or been skipped. */
+bool startup_done(void);
+
+/** State of step `index` of the table. */
+startup_step_state_t startup_step_state(int index);
+
+/** Record a named milestone (first one of each name wins). */
+void startup_mark(const char *milestone);
+
+/** Time of milestone `name` in ms since startup_begin(), or -1. */
+int32_t startup_milestone_ms(const char *name);
+
+/** Milliseconds since startup_begin(). */
+uint32_t startup_elapsed_ms(void);
+
+/** The timeline so far.  @return Number of entries in *out. */
+int startup_events(const startup_event_t **out);
+
+/** Print the timeline as "[startup] ..." lines. */
+void startup_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STARTUP_H */
@@ -0,0 +1,408 @@
+/**
+ * @file status_board.c
+ * @brief Cross-process shared-memory status blackboard implementation
+ *
+ * Region layout (all records 64-byte aligned):
+ *
+ *   ┌────────────────────────────┐
+ *   │ header: magic/version/size │
+ *   ├────────────────────────────┤
+ *   │ vitals[STATUS_BOARD_SLOTS] │  seq + status_vitals_t
+ *   │ alarms[STATUS_BOARD_SLOTS] │  seq + status_alarms_t
+ *   │ services[STATUS_SVC_COUNT] │  seq + status_service_t
+ *   └────────────────────────────┘
+ *
+ * Seqlock protocol (single writer per record):
+ *   writer: seq -> odd, release fence, copy payload, seq -> even (release)
+ *   reader: load seq (acquire); odd = retry; copy payload; acquire fence;
+ *           reload seq; equal = consistent copy, else retry
+ *
+ * seq == 0 means the record has never been written.
+ *
+ * Single writer is enforced per process: the first process to write a
+ * record stores its pid in the record's owner field (CAS), and writes from
+ * any other process are refused while that pid is alive.  A dead owner
+ * cannot be part-way through a copy, so its record is taken over (a seq
+ * it left odd is completed by the next write).
+ *
+ * The region is initialised only by the process that created it
+ * (O_EXCL).  Every other opener waits for the creator's header and
+ * refuses a mismatching layout rather than wiping live records.
+ */
+
+#include "status_board.h"
+#include "ipc_messages.h"       /* ipc_sensor_type_t, ipc_sensor_state_t */
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* ── Tunables ────────────────────────────────────────────── */
+
+#define CACHE_LINE          64
+#define READ_MAX_RETRIES    64     /* Writer holds a record for ~100 ns */
+#define INIT_WAIT_TRIES     100    /* x 10 ms for the creator's header */
+
+/* ── Region layout ───────────────────────────────────────── */
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t slots;
+    uint32_t size;
+    uint32_t service_count;
+} __attribute__((aligned(CACHE_LINE))) board_header_t;
+
+typedef struct {
+    uint32_t        seq;
+    int32_t         owner;     /* Writing pid, 0 = none yet */
+    status_vitals_t data;
+} __attribute__((aligned(CACHE_LINE))) vitals_rec_t;
+
+typedef struct {
+    uint32_t        seq;
+    int32_t         owner;     /* Writing pid, 0 = none yet */
+    status_alarms_t data;
+} __attribute__((aligned(CACHE_LINE))) alarms_rec_t;
+
+typedef struct {
+    uint32_t         seq;
+    int32_t          owner;    /* Writing pid, 0 = none yet */
+    status_service_t data;
+} __attribute__((aligned(CACHE_LINE))) service_rec_t;
+
+typedef struct {
+    board_header_t hdr;
+    vitals_rec_t   vitals[STATUS_BOARD_SLOTS];
+    alarms_rec_t   alarms[STATUS_BOARD_SLOTS];
+    service_rec_t  services[STATUS_SVC_COUNT];
+} status_region_t;
+
+/* Record index -> service name (matches deploy/systemd unit names) */
+static const char *service_names[STATUS_SVC_COUNT] = {
+    "sensor-service",
+    "alarm-service",
+    "network-service",
+    "vitals-ui",
+    "watchdog-monitor",
+};
+
+/* ── Module state ────────────────────────────────────────── */
+
+static status_region_t *region   = NULL;
+static bool             writable = false;
+
+/* ── Seqlock primitives ──────────────────────────────────── */
+
+/**
+ * Make this process the record's writer unless a live process already is.
+ * @return false if another process owns the record.
+ */
+static bool claim_record(int32_t *owner) {
+    int32_t me = (int32_t)getpid();
+    int32_t cur = __atomic_load_n(owner, __ATOMIC_ACQUIRE);
+    while (cur != me) {
+        if (cur != 0 && (kill(cur, 0) == 0 || errno != ESRCH)) {
+            return false;                   /* Owner alive */
+        }
+        if (__atomic_compare_exchange_n(owner, &cur, me, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+    }
+    return true;
+}
+
+static void seq_write(uint32_t *seq, void *dst, const void *src, size_t len) {
+    /* Already odd only if a dead owner stopped mid-copy */
+    uint32_t odd = __atomic_load_n(seq, __ATOMIC_RELAXED) | 1u;
+    __atomic_store_n(seq, odd, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    memcpy(dst, src, len);
+
+    /* Skip 0 on wrap so a written record never looks "never written" */
+    uint32_t next = odd + 1;
+    if (next == 0) next = 2;
+    __atomic_store_n(seq, next, __ATOMIC_RELEASE);
+}
+
+static bool seq_read(const uint32_t *seq, void *dst, const void *src, size_t len) {
+    for (int attempt = 0; attempt < READ_MAX_RETRIES; attempt++) {
+        uint32_t s1 = __atomic_load_n(seq, __ATOMIC_ACQUIRE);
+        if (s1 == 0) return false;          /* Never written */
+        if (s1 & 1u) continue;              /* Write in progress */
+
+        memcpy(dst, src, len);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        uint32_t s2 = __atomic_load_n(seq, __ATOMIC_RELAXED);
+        if (s1 == s2) return true;
+    }
+    return false;
+}
+
+/* ── Header helpers ──────────────────────────────────────── */
+
+static bool header_valid(const status_region_t *r) {
+    return __atomic_load_n(&r->hdr.magic, __ATOMIC_ACQUIRE) == STATUS_BOARD_MAGIC &&
+           r->hdr.version       == STATUS_BOARD_VERSION &&
+           r->hdr.slots         == STATUS_BOARD_SLOTS &&
+           r->hdr.size          == (uint32_t)sizeof(status_region_t) &&
+           r->hdr.service_count == STATUS_SVC_COUNT;
+}
+
+static void header_init(status_region_t *r) {
+    /* Clear magic first so readers detach from a stale layout */
+    __atomic_store_n(&r->hdr.magic, 0u, __ATOMIC_RELEASE);
+    memset((uint8_t *)r + sizeof(board_header_t), 0,
+           sizeof(status_region_t) - sizeof(board_header_t));
+    r->hdr.version       = STATUS_BOARD_VERSION;
+    r->hdr.slots         = STATUS_BOARD_SLOTS;
+    r->hdr.size          = (uint32_t)sizeof(status_region_t);
+    r->hdr.service_count = STATUS_SVC_COUNT;
+    __atomic_store_n(&r->hdr.magic, STATUS_BOARD_MAGIC, __ATOMIC_RELEASE);
+}
+
+/**
+ * Wait for the region's creator to stamp the header.
+ * @return false on a different layout, or if none appears in time.
+ */
+static bool wait_for_header(const status_region_t *r) {
+    for (int i = 0; i < INIT_WAIT_TRIES; i++) {
+        if (header_valid(r)) return true;
+        if (__atomic_load_n(&r->hdr.magic, __ATOMIC_ACQUIRE) != 0) {
+            return false;                   /* Stamped, other layout */
+        }
+        usleep(10000);
+    }
+    return header_valid(r);
+}
+
+/* ── Lifecycle ───────────────────────────────────────────── */
+
+bool status_board_open(const char *shm_name, bool writer) {
+    if (region) status_board_close();
+
+    size_t size = sizeof(status_region_t);
+
+    if (!shm_name) {
+        /* Process-local region (simulator / unit tests) */
+        void *p = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            fprintf(stderr, "[status_board] mmap failed: %s\n", strerror(errno));
+            return false;
+        }
+        region   = (status_region_t *)p;
+        writable = true;
+        header_init(region);
+        printf("[status_board] Opened (in-process, %zu bytes)\n", size);
+        return true;
+    }
+
+    /* Only the process that creates the region sizes and stamps it */
+    bool created = false;
+    int fd;
+    if (writer) {
+        fd = shm_open(shm_name, O_RDWR | O_CREAT | O_EXCL, 0660);
+        created = (fd >= 0);
+        if (fd < 0 && errno == EEXIST) fd = shm_open(shm_name, O_RDWR, 0);
+    } else {
+        fd = shm_open(shm_name, O_RDONLY, 0);
+    }
+    if (fd < 0) {
+        fprintf(stderr, "[status_board] shm_open('%s') failed: %s\n",
+                shm_name, strerror(errno));
+        return false;
+    }
+
+    if (created && ftruncate(fd, (off_t)size) != 0) {
+        fprintf(stderr, "[status_board] ftruncate failed: %s\n", strerror(errno));
+        close(fd);
+        shm_unlink(shm_name);
+        return false;
+    }
+
+    /* A region just created by another process may not be sized yet */
+    struct stat st;
+    for (int i = 0;; i++) {
+        if (fstat(fd, &st) != 0) {
+            fprintf(stderr, "[status_board] fstat failed: %s\n", strerror(errno));
+            close(fd);
+            return false;
+        }
+        if ((size_t)st.st_size >= size || i >= INIT_WAIT_TRIES) break;
+        usleep(10000);
+    }
+    if ((size_t)st.st_size != size) {
+        fprintf(stderr, "[status_board] '%s' has size %lld, expected %zu "
+                "(stale region? status_board_unlink it)\n",
+                shm_name, (long long)st.st_size, size);
+        close(fd);
+        return false;
+    }
+
+    int prot = writer ? (PROT_READ | PROT_WRITE) : PROT_READ;
+    void *p = mmap(NULL, size, prot, MAP_SHARED, fd, 0);
+    close(fd);  /* Mapping keeps the object alive */
+    if (p == MAP_FAILED) {
+        fprintf(stderr, "[status_board] mmap failed: %s\n", strerror(errno));
+        return false;
+    }
+
+    region   = (status_region_t *)p;
+    writable = writer;
+
+    if (created) {
+        header_init(region);
+        printf("[status_board] Initialised layout v%d in '%s'\n",
+               STATUS_BOARD_VERSION, shm_name);
+    } else if (!wait_for_header(region)) {
+        fprintf(stderr, "[status_board] '%s' has incompatible layout\n", shm_name);
+        munmap(p, size);
+        region   = NULL;
+        writable = false;
+        return false;
+    }
+
+    printf("[status_board] Opened '%s' (%s, %zu bytes)\n",
+           shm_name, writer ? "rw" : "ro", size);
+    return true;
+}
+
+void status_board_close(void) {
+    if (!region) return;
+    munmap(region, sizeof(status_region_t));
+    region   = NULL;
+    writable = false;
+    printf("[status_board] Closed\n");
+}
+
+void status_board_unlink(const char *shm_name) {
+    if (shm_name) shm_unlink(shm_name);
+}
+
+bool status_board_is_open(void) {
+    return region != NULL;
+}
+
+/* ── Writers ─────────────────────────────────────────────── */
+
+bool status_board_write_vitals(uint8_t slot, const status_vitals_t *v) {
+    if (!region || !writable || !v || slot >= STATUS_BOARD_SLOTS) return false;
+    vitals_rec_t *rec = &region->vitals[slot];
+    if (!claim_record(&rec->owner)) return false;
+    seq_write(&rec->seq, &rec->data, v, sizeof(*v));
+    return true;
+}
+
+bool status_board_write_alarms(uint8_t slot, const status_alarms_t *a) {
+    if (!region || !writable || !a || slot >= STATUS_BOARD_SLOTS) return false;
+    alarms_rec_t *rec = &region->alarms[slot];
+    if (!claim_record(&rec->owner)) return false;
+    seq_write(&rec->seq, &rec->data, a, sizeof(*a));
+    return true;
+}
+
+bool status_board_write_service(status_service_id_t id,
+                                const status_service_t *s) {
+    if (!region || !writable || !s || id >= STATUS_SVC_COUNT) return false;
+    service_rec_t *rec = &region->services[id];
+    if (!claim_record(&rec->owner)) return false;
+    seq_write(&rec->seq, &rec->data, s, sizeof(*s));
+    return true;
+}
+
+/* ── Readers ─────────────────────────────────────────────── */
+
+bool status_board_read_vitals(uint8_t slot, status_vitals_t *out) {
+    if (!region || !out || slot >= STATUS_BOARD_SLOTS) return false;
+    const vitals_rec_t *rec = &region->vitals[slot];
+    return seq_read(&rec->seq, out, &rec->data, sizeof(*out));
+}
+
+bool status_board_read_alarms(uint8_t slot, status_alarms_t *out) {
+    if (!region || !out || slot >= STATUS_BOARD_SLOTS) return false;
+    const alarms_rec_t *rec = &region->alarms[slot];
+    return seq_read(&rec->seq, out, &rec->data, sizeof(*out));
+}
+
+bool status_board_read_service(status_service_id_t id, status_service_t *out) {
+    if (!region || !out || id >= STATUS_SVC_COUNT) return false;
+    const service_rec_t *rec = &region->services[id];
+    return seq_read(&rec->seq, out, &rec->data, sizeof(*out));
+}
+
+uint32_t status_board_vitals_seq(uint8_t slot) {
+    if (!region || slot >= STATUS_BOARD_SLOTS) return 0;
+    return __atomic_load_n(&region->vitals[slot].seq, __ATOMIC_ACQUIRE);
+}
+
+uint32_t status_board_alarms_seq(uint8_t slot) {
+    if (!region || slot >= STATUS_BOARD_SLOTS) return 0;
+    return __atomic_load_n(&region->alarms[slot].seq, __ATOMIC_ACQUIRE);
+}
+
+/* ── Conversion helpers ──────────────────────────────────── */
+
+void status_board_vitals_from_data(const vitals_data_t *data,
+                                   status_vitals_t *out) {
+    if (!data || !out) return;
+    memset(out, 0, sizeof(*out));
+    out->hr           = (int16_t)data->hr;
+    out->spo2         = (int16_t)data->spo2;
+    out->rr           = (int16_t)data->rr;
+    out->temp_x10     = (int16_t)(data->temp * 10.0f + 0.5f);
+    out->nibp_sys     = (int16_t)data->nibp_sys;
+    out->nibp_dia     = (int16_t)data->nibp_dia;
+    out->nibp_map     = (int16_t)data->nibp_map;
+    out->hr_quality   = data->hr_quality;
+    out->spo2_quality = data->spo2_quality;
+    out->ecg_lead_off = data->ecg_lead_off;
+    out->timestamp_ms = data->timestamp_ms;
+
+    /* As far as a reading shows: lead-off is an ECG fault, an invalid
+       (zero) value with no signal quality means nothing is attached */
+    out->sensor_state[IPC_SENSOR_ECG] =
+        data->ecg_lead_off ? IPC_SENSOR_ERROR
+        : (data->hr > 0 || data->hr_quality > 0) ? IPC_SENSOR_CONNECTED
+                                                 : IPC_SENSOR_DISCONNECTED;
+    out->sensor_state[IPC_SENSOR_SPO2] =
+        (data->spo2 > 0 || data->spo2_quality > 0) ? IPC_SENSOR_CONNECTED
+                                                   : IPC_SENSOR_DISCONNECTED;
+    out->sensor_state[IPC_SENSOR_NIBP] =
+        data->nibp_sys > 0 ? IPC_SENSOR_CONNECTED : IPC_SENSOR_DISCONNECTED;
+    out->sensor_state[IPC_SENSOR_TEMP] =
+        data->temp != 0.0f ? IPC_SENSOR_CONNECTED : IPC_SENSOR_DISCONNECTED;
+}
+
+void status_board_alarms_from_engine(const alarm_engine_state_t *state,
+                                     uint32_t now_s, status_alarms_t *out) {
+    if (!state || !out) return;
+    memset(out, 0, sizeof(*out));
+    for (int i = 0; i < ALARM_PARAM_COUNT; i++) {
+        out->state[i]    = (uint8_t)state->params[i].state;
+        out->severity[i] = (uint8_t)state->params[i].severity;
+    }
+    out->highest_active = (uint8_t)state->highest_active;
+    out->highest_any    = (uint8_t)state->highest_any;
+    out->audio_paused   = state->audio_paused ? 1 : 0;
+    if (state->highest_message) {
+        strncpy(out->highest_message, state->highest_message,
+                sizeof(out->highest_message) - 1);
+    }
+    out->updated_s = now_s;
+}
+
+status_service_id_t status_board_service_id(const char *name) {
+    if (!name) return STATUS_SVC_COUNT;
+    for (int i = 0; i < STATUS_SVC_COUNT; i++) {
+        if (strcmp(service_names[i], name) == 0) return (status_service_id_t)i;
+    }
+    return STATUS_SVC_COUNT;
+}
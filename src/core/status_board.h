@@ -0,0 +1,183 @@
+/**
+ * @file status_board.h
+ * @brief Cross-process shared-memory status blackboard
+ *
+ * A fixed-layout, versioned region in POSIX shared memory that holds the
+ * latest "current state" of the monitor:
+ *   - per patient slot: vitals snapshot      (owner: sensor-service)
+ *   - per patient slot: alarm state summary  (owner: alarm-service)
+ *   - per service:      health / heartbeat   (owner: that service)
+ *
+ * Consumers that only need the current state (UI status bar, watchdog,
+ * network-service) read a record in constant time without subscribing to
+ * the IPC streams, waking up, or decoding messages.
+ *
+ * Concurrency:
+ *   Every record is protected by a seqlock.  Each record has exactly one
+ *   writer process: the first to write it claims it, and writes from any
+ *   other process fail while the owner is alive.  Within the owner, one
+ *   thread writes a given record.  Readers never block the writer and
+ *   retry if they observe an odd sequence number or a sequence change
+ *   across the copy.  Records are cache-line aligned so writers of
+ *   different records do not share lines.
+ *
+ * Layout versioning:
+ *   The region starts with a magic / version / size header, written once
+ *   by the process that creates the region.  Any other opener (writer or
+ *   reader) refuses to attach to a mismatching header; remove a stale
+ *   region with status_board_unlink().  Bump STATUS_BOARD_VERSION on any
+ *   layout change.
+ *
+ * In-process mode:
+ *   Passing NULL as the region name maps an anonymous private region, so
+ *   the simulator and unit tests can use the same API without /dev/shm.
+ *
+ * Static allocation: the region is a fixed-size mmap; no heap is used.
+ * No LVGL dependency (pure data layer).
+ */
+
+#ifndef STATUS_BOARD_H
+#define STATUS_BOARD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "vitals_provider.h"    /* vitals_data_t */
+#include "alarm_engine.h"       /* alarm_engine_state_t, ALARM_PARAM_COUNT */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ── Constants ─────────────────────────────────────────────── */
+
+#define STATUS_BOARD_SHM_NAME     "/vitals-monitor-status"
+#define STATUS_BOARD_MAGIC        0x564D5342u   /* "VMSB" */
+#define STATUS_BOARD_VERSION      2
+#define STATUS_BOARD_SLOTS        2             /* Dual-patient mode */
+#define STATUS_BOARD_SENSORS      4             /* ECG, SpO2, NIBP, Temp */
+#define STATUS_BOARD_NAME_MAX     32
+
+/* ── Service identifiers (fixed record index per service) ─── */
+
+typedef enum {
+    STATUS_SVC_SENSOR = 0,
+    STATUS_SVC_ALARM,
+    STATUS_SVC_NETWORK,
+    STATUS_SVC_UI,
+    STATUS_SVC_WATCHDOG,
+    STATUS_SVC_COUNT
+} status_service_id_t;
+
+/* ── Record payloads (plain data, copied under the seqlock) ─ */
+
+typedef struct {
+    int16_t  hr;                /* bpm, 0 = invalid */
+    int16_t  spo2;              /* %, 0 = invalid */
+    int16_t  rr;                /* breaths/min, 0 = invalid */
+    int16_t  temp_x10;          /* Celsius x10, 0 = invalid */
+    int16_t  nibp_sys;          /* mmHg, 0 = invalid */
+    int16_t  nibp_dia;
+    int16_t  nibp_map;
+    uint8_t  hr_quality;        /* 0-100 */
+    uint8_t  spo2_quality;      /* 0-100 */
+    uint8_t  ecg_lead_off;      /* Bitmask: bit0=LA, bit1=RA, bit2=LL */
+    uint8_t  sensor_state[STATUS_BOARD_SENSORS];  /* ipc_sensor_state_t */
+    uint8_t  reserved;
+    uint64_t timestamp_ms;      /* Sample time */
+} status_vitals_t;
+
+typedef struct {
+    uint8_t  state[ALARM_PARAM_COUNT];      /* alarm_state_t */
+    uint8_t  severity[ALARM_PARAM_COUNT];   /* alarm_severity_t */
+    uint8_t  highest_active;                /* alarm_severity_t */
+    uint8_t  highest_any;                   /* alarm_severity_t */
+    uint8_t  audio_paused;
+    uint8_t  reserved;
+    char     highest_message[48];
+    uint32_t updated_s;                     /* Evaluation time */
+} status_alarms_t;
+
+typedef struct {
+    char     name[STATUS_BOARD_NAME_MAX];
+    uint8_t  state;             /* service_state_t */
+    uint8_t  reserved[3];
+    int32_t  pid;
+    uint32_t start_time_s;
+    uint32_t restart_count;
+    uint32_t last_heartbeat_s;
+} status_service_t;
+
+/* ── Lifecycle ─────────────────────────────────────────────── */
+
+/**
+ * Attach to the status board.
+ * @param shm_name  POSIX shm name (e.g. STATUS_BOARD_SHM_NAME), or NULL
+ *                  for a process-local anonymous region.
+ * @param writer    true to map read/write (creating and initialising the
+ *                  region if it does not exist yet); false to map
+ *                  read-only.
+ * @return true on success.
+ */
+bool status_board_open(const char *shm_name, bool writer);
+
+/** Detach from the status board (the shared region itself persists). */
+void status_board_close(void);
+
+/** Remove a named region from the system (tests / factory reset). */
+void status_board_unlink(const char *shm_name);
+
+/** Check whether the board is attached. */
+bool status_board_is_open(void);
+
+/* ── Writers (one owner per record) ────────────────────────── */
+
+/*
+ * @return false if not attached writable, the index is out of range, or
+ *         another live process owns the record.
+ */
+bool status_board_write_vitals(uint8_t slot, const status_vitals_t *v);
+bool status_board_write_alarms(uint8_t slot, const status_alarms_t *a);
+bool status_board_write_service(status_service_id_t id,
+                                const status_service_t *s);
+
+/* ── Readers (constant time, never block the writer) ───────── */
+
+/**
+ * Read the latest record into *out.
+ * @return false if not attached, the index is out of range, the record
+ *         has never been written, or a consistent copy could not be taken
+ *         within a bounded number of retries.
+ */
+bool status_board_read_vitals(uint8_t slot, status_vitals_t *out);
+bool status_board_read_alarms(uint8_t slot, status_alarms_t *out);
+bool status_board_read_service(status_service_id_t id, status_service_t *out);
+
+/**
+ * Sequence number of a record (even, increments by 2 per write).
+ * Lets a consumer skip work when nothing changed since its last read.
+ */
+uint32_t status_board_vitals_seq(uint8_t slot);
+uint32_t status_board_alarms_seq(uint8_t slot);
+
+/* ── Conversion helpers ────────────────────────────────────── */
+
+/** Fill a vitals record from the canonical vitals_data_t. */
+void status_board_vitals_from_data(const vitals_data_t *data,
+                                   status_vitals_t *out);
+
+/** Fill an alarm record from the alarm engine state. */
+void status_board_alarms_from_engine(const alarm_engine_state_t *state,
+                                     uint32_t now_s, status_alarms_t *out);
+
+/**
+ * Map a service name (systemd unit / service_manager name, e.g.
+ * "alarm-service") to its record index.
+ * @return Record index, or STATUS_SVC_COUNT if the name is unknown.
+ */
+status_service_id_t status_board_service_id(const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STATUS_BOARD_H */
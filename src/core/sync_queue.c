@@ -10,20 +10,29 @@
  * process() will mark every pending item as SENT.
  *
  * Uses prepared statements for all hot-path operations.
- * All database access is single-threaded (LVGL main loop).
+ * All database access is single-threaded (LVGL main loop).  The
+ * background variant, sync_queue_process_async(), only moves the FHIR
+ * JSON build and export onto a job_pool worker; fetching and status
+ * updates stay on the calling thread.
  */
 
 #include "sync_queue.h"
 #include "fhir_client.h"
+#include "job_pool.h"
+#include "db_schema.h"
+#include "vclock.h"
+#include "mem_budget.h"
 #include "sqlite3.h"
 #include <stdio.h>
 #include <string.h>
-#include <time.h>
 
 /* ── Default retry limit ─────────────────────────────────── */
 
 #define DEFAULT_MAX_RETRIES  5
 
+/* Items fetched per processing pass */
+#define SYNC_BATCH_MAX       16
+
 /* ── Module state ────────────────────────────────────────── */
 
 static sqlite3 *db = NULL;
@@ -37,6 +46,14 @@ static sqlite3_stmt *stmt_purge_sent     = NULL;
 static sqlite3_stmt *stmt_retry_failed   = NULL;
 static sqlite3_stmt *stmt_count_total    = NULL;
 
+/* Background batch (owned by the worker between submit and completion) */
+static sync_queue_item_t batch_items[SYNC_BATCH_MAX];
+static bool              batch_success[SYNC_BATCH_MAX];
+static int               batch_count = 0;
+static bool              batch_in_flight = false;
+
+MEM_BUDGET_ASSERT(sync_queue, sizeof(batch_items), MEM_BUDGET_SYNC_QUEUE);
+
 /* ── Schema ──────────────────────────────────────────────── */
 
 static const char *SCHEMA_SQL =
@@ -91,17 +108,17 @@ bool sync_queue_init(const char *db_path) {
     sqlite3_exec(db, "PRAGMA journal_mode=WAL;", NULL, NULL, NULL);
     sqlite3_exec(db, "PRAGMA synchronous=NORMAL;", NULL, NULL, NULL);
 
-    /* Create tables */
-    char *err_msg = NULL;
-    rc = sqlite3_exec(db, SCHEMA_SQL, NULL, NULL, &err_msg);
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "[sync_queue] Schema creation failed: %s\n", err_msg);
-        sqlite3_free(err_msg);
+    /* Create tables (skipped once the file is stamped current) */
+    if (!db_schema_ensure(db, DB_SCHEMA_SYNC, SCHEMA_SQL, "sync_queue")) {
         sqlite3_close(db);
         db = NULL;
         return false;
     }
 
+    /* Items left SENDING by an interrupted batch go back to RETRY */
+    sqlite3_exec(db, "UPDATE sync_queue SET status = 4 WHERE status = 1;",
+                 NULL, NULL, NULL);
+
     /* Prepare all statements */
     bool ok = true;
 
@@ -173,7 +190,7 @@ bool sync_queue_push(sync_item_type_t type, const char *json_payload) {
         return false;
     }
 
-    uint32_t now = (uint32_t)time(NULL);
+    uint32_t now = (uint32_t)vclock_wall_s();
 
     sqlite3_reset(stmt_push);
     sqlite3_bind_int(stmt_push, 1, (int)type);
@@ -255,7 +272,7 @@ static void update_item_status(int32_t id, sync_status_t status,
                                 int retry_count) {
     if (!db || !stmt_update_status) return;
 
-    uint32_t now = (uint32_t)time(NULL);
+    uint32_t now = (uint32_t)vclock_wall_s();
 
     sqlite3_reset(stmt_update_status);
     sqlite3_bind_int(stmt_update_status, 1, id);
@@ -265,41 +282,43 @@ static void update_item_status(int32_t id, sync_status_t status,
     sqlite3_step(stmt_update_status);
 }
 
+/**
+ * Record the outcome of a send attempt: SENT, or RETRY/FAILED depending
+ * on the remaining retry budget.  Returns true if the item was sent.
+ */
+static bool finish_item(sync_queue_item_t *item, bool success) {
+    item->retry_count++;
+
+    if (success) {
+        update_item_status(item->id, SYNC_STATUS_SENT, item->retry_count);
+        printf("[sync_queue] Item id=%d sent successfully\n", item->id);
+        return true;
+    }
+
+    sync_status_t new_status;
+    if (item->retry_count >= item->max_retries) {
+        new_status = SYNC_STATUS_FAILED;
+        printf("[sync_queue] Item id=%d failed permanently "
+               "(%d/%d retries)\n",
+               item->id, item->retry_count, item->max_retries);
+    } else {
+        new_status = SYNC_STATUS_RETRY;
+        printf("[sync_queue] Item id=%d will retry "
+               "(%d/%d retries)\n",
+               item->id, item->retry_count, item->max_retries);
+    }
+    update_item_status(item->id, new_status, item->retry_count);
+    return false;
+}
+
 int sync_queue_process(int max_items) {
     if (!db || !stmt_get_pending || max_items <= 0) return 0;
 
-    /* Fetch pending items */
-    sqlite3_reset(stmt_get_pending);
-    sqlite3_bind_int(stmt_get_pending, 1, max_items);
-
     /* Collect items into a local buffer first (to avoid holding the
      * SELECT cursor open while we UPDATE) */
-    sync_queue_item_t items[16];
-    int count = 0;
-    int max_fetch = max_items > 16 ? 16 : max_items;
-
-    while (sqlite3_step(stmt_get_pending) == SQLITE_ROW && count < max_fetch) {
-        sync_queue_item_t *item = &items[count];
-
-        item->id           = sqlite3_column_int(stmt_get_pending, 0);
-        item->type         = (sync_item_type_t)sqlite3_column_int(stmt_get_pending, 1);
-        item->status       = (sync_status_t)sqlite3_column_int(stmt_get_pending, 2);
-        item->created_ts   = (uint32_t)sqlite3_column_int(stmt_get_pending, 4);
-        item->last_attempt_ts = (uint32_t)sqlite3_column_int(stmt_get_pending, 5);
-        item->retry_count  = sqlite3_column_int(stmt_get_pending, 6);
-        item->max_retries  = sqlite3_column_int(stmt_get_pending, 7);
-
-        /* Copy payload */
-        const char *payload = (const char *)sqlite3_column_text(stmt_get_pending, 3);
-        if (payload) {
-            strncpy(item->payload, payload, SYNC_PAYLOAD_MAX - 1);
-            item->payload[SYNC_PAYLOAD_MAX - 1] = '\0';
-        } else {
-            item->payload[0] = '\0';
-        }
-
-        count++;
-    }
+    sync_queue_item_t items[SYNC_BATCH_MAX];
+    int max_fetch = max_items > SYNC_BATCH_MAX ? SYNC_BATCH_MAX : max_items;
+    int count = sync_queue_get_pending(items, max_fetch);
 
     if (count == 0) return 0;
 
@@ -314,27 +333,8 @@ int sync_queue_process(int max_items) {
         update_item_status(item->id, SYNC_STATUS_SENDING, item->retry_count);
 
         /* Attempt export */
-        bool success = attempt_send(item);
-        item->retry_count++;
-
-        if (success) {
-            update_item_status(item->id, SYNC_STATUS_SENT, item->retry_count);
+        if (finish_item(item, attempt_send(item))) {
             sent_count++;
-            printf("[sync_queue] Item id=%d sent successfully\n", item->id);
-        } else {
-            sync_status_t new_status;
-            if (item->retry_count >= item->max_retries) {
-                new_status = SYNC_STATUS_FAILED;
-                printf("[sync_queue] Item id=%d failed permanently "
-                       "(%d/%d retries)\n",
-                       item->id, item->retry_count, item->max_retries);
-            } else {
-                new_status = SYNC_STATUS_RETRY;
-                printf("[sync_queue] Item id=%d will retry "
-                       "(%d/%d retries)\n",
-                       item->id, item->retry_count, item->max_retries);
-            }
-            update_item_status(item->id, new_status, item->retry_count);
         }
     }
 
@@ -344,6 +344,64 @@ int sync_queue_process(int max_items) {
     return sent_count;
 }
 
+/* ── Background processing ───────────────────────────────── */
+
+/** Worker thread: build FHIR JSON and export. Touches no SQLite state. */
+static void batch_run(void *arg) {
+    (void)arg;
+    for (int i = 0; i < batch_count; i++) {
+        batch_success[i] = attempt_send(&batch_items[i]);
+    }
+}
+
+/** Calling thread: write final statuses for the batch. */
+static void batch_done(void *arg) {
+    (void)arg;
+
+    int sent_count = 0;
+    for (int i = 0; i < batch_count; i++) {
+        if (finish_item(&batch_items[i], batch_success[i])) {
+            sent_count++;
+        }
+    }
+
+    printf("[sync_queue] Processed %d/%d items successfully (background)\n",
+           sent_count, batch_count);
+
+    batch_count = 0;
+    batch_in_flight = false;
+}
+
+bool sync_queue_process_async(int max_items) {
+    if (!db || !stmt_get_pending || max_items <= 0 || batch_in_flight) {
+        return false;
+    }
+
+    int max_fetch = max_items > SYNC_BATCH_MAX ? SYNC_BATCH_MAX : max_items;
+    batch_count = sync_queue_get_pending(batch_items, max_fetch);
+    if (batch_count == 0) return false;
+
+    for (int i = 0; i < batch_count; i++) {
+        update_item_status(batch_items[i].id, SYNC_STATUS_SENDING,
+                           batch_items[i].retry_count);
+    }
+
+    printf("[sync_queue] Processing %d pending items (background)\n",
+           batch_count);
+
+    batch_in_flight = true;
+    if (!job_pool_submit(JOB_PRIO_LOW, batch_run, batch_done, NULL)) {
+        /* Pool unavailable: run the batch inline */
+        batch_run(NULL);
+        batch_done(NULL);
+    }
+    return true;
+}
+
+bool sync_queue_batch_in_flight(void) {
+    return batch_in_flight;
+}
+
 /* ── Queries ─────────────────────────────────────────────── */
 
 sync_queue_stats_t sync_queue_get_stats(void) {
@@ -413,7 +471,7 @@ int sync_queue_get_pending(sync_queue_item_t *out, int max_count) {
 void sync_queue_purge_sent(uint32_t max_age_s) {
     if (!db || !stmt_purge_sent) return;
 
-    uint32_t cutoff = (uint32_t)time(NULL);
+    uint32_t cutoff = (uint32_t)vclock_wall_s();
     if (cutoff > max_age_s) {
         cutoff -= max_age_s;
     } else {
@@ -17,7 +17,8 @@
  * In the simulator build, fhir_client export always succeeds,
  * so process() will mark all pending items as SENT.
  *
- * Thread safety: All calls are single-threaded (LVGL main loop).
+ * Thread safety: All calls are single-threaded (LVGL main loop); only the
+ * export step of sync_queue_process_async() runs on a worker.
  */
 
 #ifndef SYNC_QUEUE_H
@@ -111,6 +112,21 @@ bool sync_queue_push(sync_item_type_t type, const char *json_payload);
  */
 int sync_queue_process(int max_items);
 
+/**
+ * Process pending items without blocking the caller on FHIR JSON builds.
+ * Items are fetched and marked SENDING immediately; the JSON build and
+ * export run as a JOB_PRIO_LOW job_pool job, and final statuses are
+ * written from the job's completion on the calling (LVGL) thread.
+ * Falls back to inline processing if the pool is not running.
+ * @param max_items  Maximum number of items in the batch.
+ * @return true if a batch was started; false if the queue is empty or a
+ *         batch is already in flight.
+ */
+bool sync_queue_process_async(int max_items);
+
+/** Check whether a background batch is still being exported. */
+bool sync_queue_batch_in_flight(void);
+
 /* ── Queries ───────────────────────────────────────────────── */
 
 /** Get summary statistics for all items in the queue. */
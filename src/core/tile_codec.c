@@ -0,0 +1,160 @@
+/**
+ * @file tile_codec.c
+ * @brief Tile compression — palette and run-length sizing, then encode
+ *
+ * The tile is converted to RGB565 once; one pass then counts colours (up
+ * to TILE_PALETTE_MAX + 1) and runs, which gives the size of every
+ * encoding before any is written.
+ */
+
+#include "tile_codec.h"
+#include <string.h>
+
+/* ── Helpers ─────────────────────────────────────────────── */
+
+static uint8_t *put16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    return p + 2;
+}
+
+static uint16_t get16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+/** Index bits for a palette of n colours. */
+static int index_bits(int n) {
+    return n <= 2 ? 1 : n <= 4 ? 2 : 4;
+}
+
+static size_t index_bytes(int pixels, int bits) {
+    return ((size_t)pixels * bits + 7) / 8;
+}
+
+/* ── Public API ──────────────────────────────────────────── */
+
+size_t tile_encode(const uint32_t *px, size_t stride, int w, int h, uint8_t *out) {
+    uint16_t pix[TILE_PIXELS];
+    uint16_t palette[TILE_PALETTE_MAX];
+    uint8_t  index[TILE_PIXELS];
+    int n = 0;                      /* Colours; TILE_PALETTE_MAX + 1: too many */
+    int runs = 0;
+    int count = w * h;
+
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            int i = y * w + x;
+            uint16_t c = tile_rgb565(px[(size_t)y * stride + x]);
+            pix[i] = c;
+            if (i == 0 || c != pix[i - 1]) runs++;
+
+            if (n > TILE_PALETTE_MAX) continue;
+            int k = 0;
+            while (k < n && palette[k] != c) k++;
+            if (k == n) {
+                if (n < TILE_PALETTE_MAX) palette[k] = c;
+                n++;
+            }
+            index[i] = (uint8_t)k;
+        }
+    }
+
+    if (n == 1) {
+        out[0] = TILE_ENC_SOLID;
+        put16(out + 1, pix[0]);
+        return 3;
+    }
+
+    /* A run fits its u8 length: a tile has TILE_PIXELS = 256 pixels */
+    size_t raw = (size_t)count * 2;
+    size_t rle = (size_t)runs * 3;
+    size_t pal = n <= TILE_PALETTE_MAX
+               ? 1 + (size_t)n * 2 + index_bytes(count, index_bits(n)) : raw + 1;
+
+    uint8_t *p = out + 1;
+    if (pal <= rle && pal <= raw) {
+        out[0] = TILE_ENC_PALETTE;
+        *p++ = (uint8_t)n;
+        for (int k = 0; k < n; k++) p = put16(p, palette[k]);
+        int bits = index_bits(n);
+        size_t bytes = index_bytes(count, bits);
+        memset(p, 0, bytes);
+        for (int i = 0; i < count; i++) {
+            size_t bit = (size_t)i * bits;
+            p[bit / 8] |= (uint8_t)(index[i] << (bit % 8));
+        }
+        p += bytes;
+    } else if (rle <= raw) {
+        out[0] = TILE_ENC_RLE;
+        int i = 0;
+        while (i < count) {
+            int run = 1;
+            while (i + run < count && pix[i + run] == pix[i]) run++;
+            *p++ = (uint8_t)(run - 1);
+            p = put16(p, pix[i]);
+            i += run;
+        }
+    } else {
+        out[0] = TILE_ENC_RAW;
+        for (int i = 0; i < count; i++) p = put16(p, pix[i]);
+    }
+    return (size_t)(p - out);
+}
+
+bool tile_decode(const uint8_t *in, size_t len, int w, int h,
+                 uint16_t *out, size_t stride) {
+    if (len < 1 || w < 1 || h < 1 || w > TILE_SIZE || h > TILE_SIZE) return false;
+    int count = w * h;
+    const uint8_t *p = in + 1;
+    const uint8_t *end = in + len;
+
+#define PUT(i, c) (out[(size_t)((i) / w) * stride + (size_t)((i) % w)] = (c))
+
+    switch (in[0]) {
+    case TILE_ENC_SOLID: {
+        if (len != 3) return false;
+        uint16_t c = get16(p);
+        for (int i = 0; i < count; i++) PUT(i, c);
+        return true;
+    }
+    case TILE_ENC_PALETTE: {
+        if (end - p < 1) return false;
+        int n = *p++;
+        if (n < 2 || n > TILE_PALETTE_MAX) return false;
+        int bits = index_bits(n);
+        if ((size_t)(end - p) != (size_t)n * 2 + index_bytes(count, bits)) return false;
+        uint16_t palette[TILE_PALETTE_MAX];
+        for (int k = 0; k < n; k++, p += 2) palette[k] = get16(p);
+        for (int i = 0; i < count; i++) {
+            size_t bit = (size_t)i * bits;
+            int k = (p[bit / 8] >> (bit % 8)) & ((1 << bits) - 1);
+            if (k >= n) return false;
+            PUT(i, palette[k]);
+        }
+        return true;
+    }
+    case TILE_ENC_RLE: {
+        int i = 0;
+        while (p < end) {
+            if (end - p < 3) return false;
+            int run = *p + 1;
+            uint16_t c = get16(p + 1);
+            p += 3;
+            if (i + run > count) return false;
+            while (run--) {
+                PUT(i, c);
+                i++;
+            }
+        }
+        return i == count;
+    }
+    case TILE_ENC_RAW: {
+        if ((size_t)(end - p) != (size_t)count * 2) return false;
+        for (int i = 0; i < count; i++, p += 2) PUT(i, get16(p));
+        return true;
+    }
+    default:
+        return false;
+    }
+#undef PUT
+}
@@ -0,0 +1,78 @@
+/**
+ * @file tile_codec.h
+ * @brief Compression of 16x16 framebuffer tiles for the remote view
+ *
+ * A tile is encoded as RGB565 (the panel's depth) in whichever of these
+ * is smallest:
+ *
+ *   SOLID    one colour                  u16 colour
+ *   PALETTE  2..16 colours               u8 count, count x u16 colours,
+ *                                        1/2/4-bit indices (LSB first)
+ *   RLE      runs of one colour          (u8 run - 1, u16 colour) ...
+ *   RAW      anything else               w*h x u16
+ *
+ * preceded by one byte naming the encoding.  Values are little-endian,
+ * pixels row-major without padding.  The monitor's screen is flat colour
+ * and anti-aliased text, so almost every tile is SOLID or PALETTE.
+ *
+ * Pure functions; no allocation.  screen_stream.h frames the tiles.
+ */
+
+#ifndef TILE_CODEC_H
+#define TILE_CODEC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ── Configuration ─────────────────────────────────────────── */
+
+#define TILE_SIZE               16
+#define TILE_PIXELS             (TILE_SIZE * TILE_SIZE)
+#define TILE_PALETTE_MAX        16
+
+/* Largest encoding of one tile (RAW) */
+#define TILE_CODEC_MAX_BYTES    (1 + TILE_PIXELS * 2)
+
+typedef enum {
+    TILE_ENC_SOLID = 0,
+    TILE_ENC_PALETTE,
+    TILE_ENC_RLE,
+    TILE_ENC_RAW,
+    TILE_ENC_COUNT
+} tile_enc_t;
+
+/* ── API ───────────────────────────────────────────────────── */
+
+/** XRGB8888 to RGB565. */
+static inline uint16_t tile_rgb565(uint32_t xrgb) {
+    return (uint16_t)(((xrgb >> 8) & 0xF800) | ((xrgb >> 5) & 0x07E0) |
+                      ((xrgb >> 3) & 0x001F));
+}
+
+/**
+ * Encode a w x h tile (1..TILE_SIZE each) of XRGB8888 pixels.
+ * @param stride  Pixels per framebuffer row.
+ * @param out     At least TILE_CODEC_MAX_BYTES.
+ * @return Bytes written (the first is the tile_enc_t).
+ */
+size_t tile_encode(const uint32_t *px, size_t stride, int w, int h, uint8_t *out);
+
+/**
+ * Decode one tile into RGB565 pixels.
+ * @param len     Exact length of the encoding.
+ * @param stride  Pixels per row of `out`.
+ * @return false if the data is malformed or does not match w x h.
+ */
+bool tile_decode(const uint8_t *in, size_t len, int w, int h,
+                 uint16_t *out, size_t stride);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TILE_CODEC_H */
@@ -0,0 +1,338 @@
+/**
+ * @file tlsf.c
+ * @brief Two-level segregated fit allocator — bitmaps and boundary tags
+ *
+ * Pool layout: blocks back to back, each a header followed by its payload,
+ * ending in a zero-size sentinel that is always in use.  The header holds
+ * the previous block's address, so free can reach both neighbours; a free
+ * block keeps its list links at the start of its payload.  No two free
+ * blocks are ever adjacent.
+ */
+
+#include "tlsf.h"
+#include <string.h>
+
+/* ── Block layout ────────────────────────────────────────── */
+
+struct tlsf_block {
+    tlsf_block_t *prev_phys;
+    uint32_t      size;             /* Payload bytes; bit 0: free */
+    uint16_t      tag;
+    uint16_t      reserved;
+};
+
+/* Free-list links, in the payload of free blocks */
+typedef struct {
+    tlsf_block_t *next;
+    tlsf_block_t *prev;
+} free_links_t;
+
+#define ALIGN_UP(x)     (((x) + (TLSF_ALIGN - 1)) & ~(size_t)(TLSF_ALIGN - 1))
+#define ALIGN_LOG2      3
+#define HDR             ALIGN_UP(sizeof(tlsf_block_t))
+#define MIN_PAYLOAD     ALIGN_UP(sizeof(free_links_t))
+#define BLOCK_FREE      1u
+
+#define FL_SHIFT        (TLSF_SL_LOG2 + ALIGN_LOG2)
+#define SMALL_BLOCK     ((size_t)1 << FL_SHIFT)
+#define MAX_POOL        ((size_t)1 << TLSF_MAX_LOG2)
+
+#if (1 << ALIGN_LOG2) != TLSF_ALIGN
+#error "ALIGN_LOG2 does not match TLSF_ALIGN"
+#endif
+
+static inline size_t block_size(const tlsf_block_t *b) {
+    return b->size & ~BLOCK_FREE;
+}
+
+static inline bool block_is_free(const tlsf_block_t *b) {
+    return (b->size & BLOCK_FREE) != 0;
+}
+
+static inline uint8_t *payload(const tlsf_block_t *b) {
+    return (uint8_t *)b + HDR;
+}
+
+static inline tlsf_block_t *from_payload(const void *p) {
+    return (tlsf_block_t *)((uint8_t *)p - HDR);
+}
+
+static inline tlsf_block_t *next_phys(const tlsf_block_t *b) {
+    return (tlsf_block_t *)(payload(b) + block_size(b));
+}
+
+static inline free_links_t *links(const tlsf_block_t *b) {
+    return (free_links_t *)payload(b);
+}
+
+/* ── Size classes ────────────────────────────────────────── */
+
+static inline int fls_size(size_t x) {
+    return 31 - __builtin_clz((uint32_t)x);
+}
+
+/** List of a block of exactly `size` bytes. */
+static void mapping_insert(size_t size, int *fl, int *sl) {
+    if (size < SMALL_BLOCK) {
+        *fl = 0;
+        *sl = (int)(size / (SMALL_BLOCK / TLSF_SL_COUNT));
+    } else {
+        int f = fls_size(size);
+        *sl = (int)(size >> (f - TLSF_SL_LOG2)) ^ TLSF_SL_COUNT;
+        *fl = f - (FL_SHIFT - 1);
+    }
+}
+
+/** First list whose every block can hold `size` bytes. */
+static void mapping_search(size_t size, int *fl, int *sl) {
+    if (size >= SMALL_BLOCK) {
+        size += ((size_t)1 << (fls_size(size) - TLSF_SL_LOG2)) - 1;
+    }
+    mapping_insert(size, fl, sl);
+}
+
+/* ── Free lists ──────────────────────────────────────────── */
+
+static void insert_free(tlsf_t *t, tlsf_block_t *b) {
+    int fl, sl;
+    mapping_insert(block_size(b), &fl, &sl);
+    tlsf_block_t *head = t->heads[fl][sl];
+    links(b)->prev = NULL;
+    links(b)->next = head;
+    if (head) links(head)->prev = b;
+    t->heads[fl][sl] = b;
+    t->fl_bitmap |= 1u << fl;
+    t->sl_bitmap[fl] |= 1u << sl;
+}
+
+static void remove_free(tlsf_t *t, tlsf_block_t *b) {
+    int fl, sl;
+    mapping_insert(block_size(b), &fl, &sl);
+    free_links_t *l = links(b);
+    if (l->next) links(l->next)->prev = l->prev;
+    if (l->prev) {
+        links(l->prev)->next = l->next;
+    } else {
+        t->heads[fl][sl] = l->next;
+        if (!l->next) {
+            t->sl_bitmap[fl] &= ~(1u << sl);
+            if (!t->sl_bitmap[fl]) t->fl_bitmap &= ~(1u << fl);
+        }
+    }
+}
+
+static tlsf_block_t *find_suitable(const tlsf_t *t, int fl, int sl) {
+    uint32_t sl_map = t->sl_bitmap[fl] & (~0u << sl);
+    if (!sl_map) {
+        uint32_t fl_map = t->fl_bitmap & (~0u << (fl + 1));
+        if (!fl_map) return NULL;
+        fl = __builtin_ctz(fl_map);
+        sl_map = t->sl_bitmap[fl];
+    }
+    return t->heads[fl][__builtin_ctz(sl_map)];
+}
+
+/* ── Split and merge ─────────────────────────────────────── */
+
+/** Request size as stored: aligned, room for the free links. */
+static size_t adjust_size(size_t size) {
+    size_t a = ALIGN_UP(size);
+    return a < MIN_PAYLOAD ? MIN_PAYLOAD : a;
+}
+
+/**
+ * Cut a used block down to `size`, returning the tail to the free lists
+ * (merged with a free block after it).
+ */
+static void trim_used(tlsf_t *t, tlsf_block_t *b, size_t size) {
+    size_t have = block_size(b);
+    if (have < size + HDR + MIN_PAYLOAD) return;
+
+    tlsf_block_t *rest = (tlsf_block_t *)(payload(b) + size);
+    rest->prev_phys = b;
+    rest->size = (uint32_t)(have - size - HDR);
+    rest->tag = 0;
+    b->size = (uint32_t)size;
+
+    tlsf_block_t *next = next_phys(rest);
+    if (block_is_free(next)) {
+        remove_free(t, next);
+        rest->size += (uint32_t)(HDR + block_size(next));
+    }
+    rest->size |= BLOCK_FREE;
+    next_phys(rest)->prev_phys = rest;
+    insert_free(t, rest);
+}
+
+static void count_used(tlsf_t *t, size_t before, size_t after) {
+    t->used = t->used - before + after;
+    if (t->used > t->used_peak) t->used_peak = t->used;
+}
+
+/* ── Public API ──────────────────────────────────────────── */
+
+bool tlsf_init(tlsf_t *t, void *mem, size_t bytes) {
+    if (!t || !mem) return false;
+    memset(t, 0, sizeof(*t));
+
+    uintptr_t start = ((uintptr_t)mem + TLSF_ALIGN - 1) & ~(uintptr_t)(TLSF_ALIGN - 1);
+    uintptr_t end = ((uintptr_t)mem + bytes) & ~(uintptr_t)(TLSF_ALIGN - 1);
+    if (end <= start || end - start < 2 * HDR + MIN_PAYLOAD) return false;
+    if (end - start >= MAX_POOL) return false;
+
+    tlsf_block_t *b = (tlsf_block_t *)start;
+    b->prev_phys = NULL;
+    b->size = (uint32_t)((end - start) - 2 * HDR);
+    b->tag = 0;
+
+    tlsf_block_t *sentinel = next_phys(b);
+    sentinel->prev_phys = b;
+    sentinel->size = 0;
+    sentinel->tag = 0;
+
+    t->start = (uint8_t *)start;
+    t->end = (uint8_t *)end;
+    t->capacity = block_size(b);
+    b->size |= BLOCK_FREE;
+    insert_free(t, b);
+    return true;
+}
+
+void *tlsf_malloc(tlsf_t *t, size_t size, uint16_t tag) {
+    if (!t || size == 0 || size > t->capacity) return NULL;
+
+    size_t want = adjust_size(size);
+    int fl, sl;
+    mapping_search(want, &fl, &sl);
+    if (fl >= TLSF_FL_COUNT) return NULL;
+
+    tlsf_block_t *b = find_suitable(t, fl, sl);
+    if (!b) return NULL;
+
+    remove_free(t, b);
+    b->size &= ~BLOCK_FREE;
+    next_phys(b)->prev_phys = b;
+    trim_used(t, b, want);
+    b->tag = tag;
+
+    t->used_blocks++;
+    count_used(t, 0, block_size(b));
+    return payload(b);
+}
+
+void tlsf_free(tlsf_t *t, void *p) {
+    if (!t || !p) return;
+
+    tlsf_block_t *b = from_payload(p);
+    count_used(t, block_size(b), 0);
+    t->used_blocks--;
+
+    tlsf_block_t *prev = b->prev_phys;
+    if (prev && block_is_free(prev)) {
+        remove_free(t, prev);
+        prev->size = (uint32_t)(block_size(prev) + HDR + block_size(b));
+        b = prev;
+    }
+    tlsf_block_t *next = next_phys(b);
+    if (block_is_free(next)) {
+        remove_free(t, next);
+        b->size = (uint32_t)(block_size(b) + HDR + block_size(next));
+    }
+    b->size |= BLOCK_FREE;
+    next_phys(b)->prev_phys = b;
+    insert_free(t, b);
+}
+
+void *tlsf_realloc(tlsf_t *t, void *p, size_t size) {
+    if (!t) return NULL;
+    if (!p) return tlsf_malloc(t, size, 0);
+    if (size == 0) {
+        tlsf_free(t, p);
+        return NULL;
+    }
+    if (size > t->capacity) return NULL;
+
+    tlsf_block_t *b = from_payload(p);
+    size_t have = block_size(b);
+    size_t want = adjust_size(size);
+
+    /* Grow into a free neighbour */
+    if (want > have) {
+        tlsf_block_t *next = next_phys(b);
+        if (!block_is_free(next) || have + HDR + block_size(next) < want) {
+            void *moved = tlsf_malloc(t, size, b->tag);
+            if (!moved) return NULL;
+            memcpy(moved, p, have);
+            tlsf_free(t, p);
+            return moved;
+        }
+        remove_free(t, next);
+        b->size = (uint32_t)(have + HDR + block_size(next));
+        next_phys(b)->prev_phys = b;
+    }
+
+    trim_used(t, b, want);
+    count_used(t, have, block_size(b));
+    return p;
+}
+
+size_t tlsf_size_of(const void *p) {
+    return p ? block_size(from_payload(p)) : 0;
+}
+
+uint16_t tlsf_tag_of(const void *p) {
+    return p ? from_payload(p)->tag : 0;
+}
+
+bool tlsf_owns(const tlsf_t *t, const void *p) {
+    return t && t->start && (const uint8_t *)p >= t->start &&
+           (const uint8_t *)p < t->end;
+}
+
+void tlsf_get_stats(const tlsf_t *t, tlsf_stats_t *out) {
+    memset(out, 0, sizeof(*out));
+    if (!t || !t->start) return;
+
+    for (const tlsf_block_t *b = (const tlsf_block_t *)t->start;
+         block_size(b) > 0; b = next_phys(b)) {
+        if (block_is_free(b)) {
+            out->free += block_size(b);
+            out->free_blocks++;
+            if (block_size(b) > out->largest_free) out->largest_free = block_size(b);
+        }
+    }
+    out->capacity = t->capacity;
+    out->used = t->used;
+    out->used_peak = t->used_peak;
+    out->used_blocks = t->used_blocks;
+    out->frag_pct = out->free ? (uint8_t)(100 - out->largest_free * 100 / out->free) : 0;
+}
+
+bool tlsf_check(const tlsf_t *t) {
+    if (!t || !t->start) return false;
+
+    const tlsf_block_t *prev = NULL;
+    const tlsf_block_t *b = (const tlsf_block_t *)t->start;
+    size_t used = 0;
+    uint32_t used_blocks = 0;
+
+    for (;;) {
+        if ((const uint8_t *)b < t->start || (const uint8_t *)b + HDR > t->end) return false;
+        if (b->prev_phys != prev) return false;
+        if (block_size(b) == 0) break;                  /* Sentinel */
+
+        if (block_is_free(b)) {
+            if (prev && block_is_free(prev)) return false;
+            int fl, sl;
+            mapping_insert(block_size(b), &fl, &sl);
+            if (!(t->sl_bitmap[fl] & (1u << sl))) return false;
+        } else {
+            used += block_size(b);
+            used_blocks++;
+        }
+        prev = b;
+        b = next_phys(b);
+    }
+    if ((const uint8_t *)b + HDR != t->end) return false;
+    return used == t->used && used_blocks == t->used_blocks;
+}
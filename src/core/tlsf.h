@@ -0,0 +1,114 @@
+/**
+ * @file tlsf.h
+ * @brief Two-level segregated fit allocator over a caller-supplied pool
+ *
+ * Free blocks are kept in lists indexed by a first level (power of two)
+ * and a second level (TLSF_SL_COUNT linear steps within it), with a
+ * bitmap per level.  Allocation finds the first non-empty list that is
+ * large enough with two bit scans; free merges with both physical
+ * neighbours through boundary tags.  Both are O(1), independent of how
+ * many blocks the pool holds, and good fit keeps fragmentation bounded
+ * over long uptimes where a first-fit heap slowly splinters.
+ *
+ * Every block carries a 16-bit tag chosen by the caller at allocation
+ * (ui_heap.h tags LVGL allocations with the active screen).
+ *
+ * Not thread-safe; the caller serialises access.  No LVGL dependency.
+ */
+
+#ifndef TLSF_H
+#define TLSF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ── Configuration ─────────────────────────────────────────── */
+
+#define TLSF_ALIGN          8       /* Payload alignment, bytes */
+#define TLSF_SL_LOG2        4       /* 16 second-level lists per power of two */
+#define TLSF_MAX_LOG2       28      /* Pools up to 256 MB */
+
+#define TLSF_SL_COUNT       (1 << TLSF_SL_LOG2)
+#define TLSF_FL_COUNT       (TLSF_MAX_LOG2 - TLSF_SL_LOG2 - 3 + 1)
+
+/* ── Types ─────────────────────────────────────────────────── */
+
+typedef struct tlsf_block tlsf_block_t;
+
+/** Allocator state; treat as opaque. */
+typedef struct {
+    uint32_t      fl_bitmap;
+    uint32_t      sl_bitmap[TLSF_FL_COUNT];
+    tlsf_block_t *heads[TLSF_FL_COUNT][TLSF_SL_COUNT];
+    uint8_t      *start;
+    uint8_t      *end;
+    size_t        capacity;         /* Payload bytes of the empty pool */
+    size_t        used;             /* Payload bytes in allocated blocks */
+    size_t        used_peak;
+    uint32_t      used_blocks;
+} tlsf_t;
+
+typedef struct {
+    size_t   capacity;              /* Payload bytes of the empty pool */
+    size_t   used;
+    size_t   used_peak;
+    size_t   free;                  /* Sum of free payloads */
+    size_t   largest_free;          /* Largest single allocation possible */
+    uint32_t used_blocks;
+    uint32_t free_blocks;
+    uint8_t  frag_pct;              /* 100 - largest_free / free, in % */
+} tlsf_stats_t;
+
+/* ── API ───────────────────────────────────────────────────── */
+
+/**
+ * Set up an empty allocator over `mem` (owned by the caller and outliving
+ * the allocator).  Each block costs a header of 16 bytes.
+ * @return false if the pool is too small or too large (TLSF_MAX_LOG2).
+ */
+bool tlsf_init(tlsf_t *t, void *mem, size_t bytes);
+
+/**
+ * Allocate `size` bytes aligned to TLSF_ALIGN.
+ * @return NULL if `size` is 0 or no free block is large enough.
+ */
+void *tlsf_malloc(tlsf_t *t, size_t size, uint16_t tag);
+
+/** Free a block of this allocator.  NULL is ignored. */
+void tlsf_free(tlsf_t *t, void *p);
+
+/**
+ * Resize in place when the block or its free neighbour allows, else move
+ * within the pool.  The tag is kept.
+ * @return NULL on failure, with the original block left untouched.
+ */
+void *tlsf_realloc(tlsf_t *t, void *p, size_t size);
+
+/** Usable size of an allocated block (at least the size requested). */
+size_t tlsf_size_of(const void *p);
+
+/** Tag given to the block at allocation. */
+uint16_t tlsf_tag_of(const void *p);
+
+/** Whether `p` lies inside this allocator's pool. */
+bool tlsf_owns(const tlsf_t *t, const void *p);
+
+/** Usage and fragmentation.  Walks every block: for reports, not hot paths. */
+void tlsf_get_stats(const tlsf_t *t, tlsf_stats_t *out);
+
+/**
+ * Verify block links, free lists and bitmaps.
+ * @return false on corruption (a write past the end of a block).
+ */
+bool tlsf_check(const tlsf_t *t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TLSF_H */
@@ -0,0 +1,256 @@
+/**
+ * @file trend_cache.c
+ * @brief LRU cache of decoded trend query results — static arena
+ *
+ * The budget is carved into chunks of TREND_CACHE_CHUNK_POINTS points.
+ * Each entry owns a singly linked list of chunks, so entries of any size
+ * share the arena without fragmentation.  Recency is a global use stamp;
+ * with at most TREND_CACHE_MAX_ENTRIES entries a linear scan for the
+ * oldest is cheaper than maintaining a list.
+ */
+
+#include "trend_cache.h"
+#include "mem_budget.h"
+#include <pthread.h>
+#include <string.h>
+
+/* ── Internal types ──────────────────────────────────────── */
+
+typedef struct {
+    uint32_t timestamp_s[TREND_CACHE_CHUNK_POINTS];
+    int32_t  value[TREND_CACHE_CHUNK_POINTS];
+    int32_t  value_min[TREND_CACHE_CHUNK_POINTS];
+    int32_t  value_max[TREND_CACHE_CHUNK_POINTS];
+} cache_chunk_t;
+
+#define CHUNK_COUNT  (TREND_CACHE_BUDGET_BYTES / (int)sizeof(cache_chunk_t))
+
+typedef struct {
+    bool              valid;
+    trend_cache_key_t key;
+    int               count;        /* Points */
+    uint32_t          bucket_s;     /* As returned by the query */
+    int               first_chunk;  /* -1 when count == 0 */
+    int               n_chunks;
+    uint32_t          last_used;
+} cache_entry_t;
+
+/* ── Module state ────────────────────────────────────────── */
+
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static cache_chunk_t chunks[CHUNK_COUNT];
+static int           chunk_next[CHUNK_COUNT];
+static int           free_head = -1;
+static int           free_chunks = 0;
+static bool          arena_ready = false;
+
+static cache_entry_t entries[TREND_CACHE_MAX_ENTRIES];
+static uint32_t      use_clock = 0;
+static uint32_t      generation = 0;    /* Bumped by invalidate / clear */
+
+MEM_BUDGET_ASSERT(trend_cache,
+                  sizeof(chunks) + sizeof(chunk_next) + sizeof(entries),
+                  MEM_BUDGET_TREND_CACHE);
+
+static trend_cache_stats_t stats;
+
+/* ── Arena helpers (cache_lock held) ─────────────────────── */
+
+static void arena_init(void) {
+    for (int i = 0; i < CHUNK_COUNT; i++) {
+        chunk_next[i] = (i + 1 < CHUNK_COUNT) ? i + 1 : -1;
+    }
+    free_head = 0;
+    free_chunks = CHUNK_COUNT;
+    memset(entries, 0, sizeof(entries));
+    arena_ready = true;
+}
+
+static void release_entry(cache_entry_t *e) {
+    int c = e->first_chunk;
+    while (c >= 0) {
+        int next = chunk_next[c];
+        chunk_next[c] = free_head;
+        free_head = c;
+        free_chunks++;
+        c = next;
+    }
+    stats.bytes_used -= (uint32_t)e->n_chunks * sizeof(cache_chunk_t);
+    stats.entries--;
+    e->valid = false;
+    e->first_chunk = -1;
+    e->n_chunks = 0;
+}
+
+static cache_entry_t *find_entry(const trend_cache_key_t *key) {
+    for (int i = 0; i < TREND_CACHE_MAX_ENTRIES; i++) {
+        cache_entry_t *e = &entries[i];
+        if (e->valid &&
+            e->key.patient_id == key->patient_id &&
+            e->key.param      == key->param &&
+            e->key.tier       == key->tier &&
+            e->key.range_s    == key->range_s &&
+            e->key.bucket_s   == key->bucket_s &&
+            e->key.end_ts     == key->end_ts &&
+            e->key.max_points == key->max_points &&
+            e->key.ds         == key->ds) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static cache_entry_t *oldest_entry(void) {
+    cache_entry_t *oldest = NULL;
+    for (int i = 0; i < TREND_CACHE_MAX_ENTRIES; i++) {
+        cache_entry_t *e = &entries[i];
+        if (e->valid && (!oldest || e->last_used < oldest->last_used)) {
+            oldest = e;
+        }
+    }
+    return oldest;
+}
+
+static cache_entry_t *free_entry(void) {
+    for (int i = 0; i < TREND_CACHE_MAX_ENTRIES; i++) {
+        if (!entries[i].valid) return &entries[i];
+    }
+    return NULL;
+}
+
+/* ── Public API ──────────────────────────────────────────── */
+
+bool trend_cache_lookup(const trend_cache_key_t *key,
+                        trend_query_result_t *result, uint32_t *generation_out) {
+    if (!key || !result) return false;
+
+    pthread_mutex_lock(&cache_lock);
+    if (generation_out) *generation_out = generation;
+    cache_entry_t *e = arena_ready ? find_entry(key) : NULL;
+    if (!e) {
+        stats.misses++;
+        pthread_mutex_unlock(&cache_lock);
+        return false;
+    }
+
+    int i = 0;
+    for (int c = e->first_chunk; c >= 0; c = chunk_next[c]) {
+        int n = e->count - i;
+        if (n > TREND_CACHE_CHUNK_POINTS) n = TREND_CACHE_CHUNK_POINTS;
+        memcpy(&result->timestamp_s[i], chunks[c].timestamp_s, n * sizeof(uint32_t));
+        memcpy(&result->value[i],       chunks[c].value,       n * sizeof(int32_t));
+        memcpy(&result->value_min[i],   chunks[c].value_min,   n * sizeof(int32_t));
+        memcpy(&result->value_max[i],   chunks[c].value_max,   n * sizeof(int32_t));
+        i += n;
+    }
+    result->count = e->count;
+    result->bucket_s = e->bucket_s;
+
+    e->last_used = ++use_clock;
+    stats.hits++;
+    pthread_mutex_unlock(&cache_lock);
+    return true;
+}
+
+bool trend_cache_store(const trend_cache_key_t *key,
+                       const trend_query_result_t *result,
+                       uint32_t read_generation) {
+    if (!key || !result || result->count < 0 ||
+        result->count > TREND_DB_MAX_POINTS) {
+        return false;
+    }
+
+    int need = (result->count + TREND_CACHE_CHUNK_POINTS - 1)
+               / TREND_CACHE_CHUNK_POINTS;
+    if (need > CHUNK_COUNT) return false;
+
+    pthread_mutex_lock(&cache_lock);
+    if (read_generation != generation) {
+        /* Read may predate an invalidation that ran during it */
+        stats.stale_stores++;
+        pthread_mutex_unlock(&cache_lock);
+        return false;
+    }
+    if (!arena_ready) arena_init();
+
+    cache_entry_t *e = find_entry(key);
+    if (e) release_entry(e);
+
+    /* Evict least-recently-used entries until the result fits */
+    while (free_chunks < need || !(e = free_entry())) {
+        cache_entry_t *victim = oldest_entry();
+        if (!victim) break;
+        release_entry(victim);
+        stats.evictions++;
+    }
+    if (!e || free_chunks < need) {
+        pthread_mutex_unlock(&cache_lock);
+        return false;
+    }
+
+    /* Copy points into a chain of chunks */
+    e->first_chunk = -1;
+    int tail = -1;
+    for (int k = 0, i = 0; k < need; k++, i += TREND_CACHE_CHUNK_POINTS) {
+        int c = free_head;
+        free_head = chunk_next[c];
+        free_chunks--;
+        chunk_next[c] = -1;
+        if (tail < 0) e->first_chunk = c;
+        else chunk_next[tail] = c;
+        tail = c;
+
+        int n = result->count - i;
+        if (n > TREND_CACHE_CHUNK_POINTS) n = TREND_CACHE_CHUNK_POINTS;
+        memcpy(chunks[c].timestamp_s, &result->timestamp_s[i], n * sizeof(uint32_t));
+        memcpy(chunks[c].value,       &result->value[i],       n * sizeof(int32_t));
+        memcpy(chunks[c].value_min,   &result->value_min[i],   n * sizeof(int32_t));
+        memcpy(chunks[c].value_max,   &result->value_max[i],   n * sizeof(int32_t));
+    }
+
+    e->valid = true;
+    e->key = *key;
+    e->count = result->count;
+    e->bucket_s = result->bucket_s;
+    e->n_chunks = need;
+    e->last_used = ++use_clock;
+
+    stats.stores++;
+    stats.entries++;
+    stats.bytes_used += (uint32_t)need * sizeof(cache_chunk_t);
+    pthread_mutex_unlock(&cache_lock);
+    return true;
+}
+
+void trend_cache_invalidate_range(uint32_t from_ts, uint32_t to_ts) {
+    pthread_mutex_lock(&cache_lock);
+    generation++;
+    for (int i = 0; i < TREND_CACHE_MAX_ENTRIES; i++) {
+        cache_entry_t *e = &entries[i];
+        if (!e->valid) continue;
+        uint32_t start = (e->key.end_ts > e->key.range_s)
+                         ? e->key.end_ts - e->key.range_s : 0;
+        if (start <= to_ts && e->key.end_ts >= from_ts) {
+            release_entry(e);
+            stats.invalidations++;
+        }
+    }
+    pthread_mutex_unlock(&cache_lock);
+}
+
+void trend_cache_clear(void) {
+    pthread_mutex_lock(&cache_lock);
+    generation++;
+    for (int i = 0; i < TREND_CACHE_MAX_ENTRIES; i++) {
+        if (entries[i].valid) release_entry(&entries[i]);
+    }
+    pthread_mutex_unlock(&cache_lock);
+}
+
+trend_cache_stats_t trend_cache_get_stats(void) {
+    pthread_mutex_lock(&cache_lock);
+    trend_cache_stats_t s = stats;
+    pthread_mutex_unlock(&cache_lock);
+    return s;
+}
@@ -0,0 +1,108 @@
+/**
+ * @file trend_cache.h
+ * @brief LRU cache of decoded trend query results
+ *
+ * Users flip between trend ranges repeatedly; without a cache every flip
+ * re-runs the same bucketed SQLite scans.  trend_query consults this cache
+ * per parameter before touching the database.
+ *
+ * Keys are (param, tier, range, bucket width, end time, point limit,
+ * downsampling mode).  trend_query aligns end times to the minute, so a
+ * view requested again within the same minute maps to the same key.
+ * Aggregated tiers only change when a new minute aggregate is written,
+ * and trend_db invalidates overlapping entries at that point (and on
+ * purge); nothing else expires entries.  Every invalidation or clear
+ * bumps a generation counter: a miss reports the generation, and a
+ * store made with an older one is skipped, so a scan that ran across an
+ * invalidation cannot re-cache data from before it.
+ *
+ * Storage is a static arena of fixed-size point chunks sized by
+ * TREND_CACHE_BUDGET_BYTES.  An entry holds only as many chunks as it has
+ * points; least-recently-used entries are evicted to make room.
+ *
+ * Thread safety: all functions may be called from any thread.
+ */
+
+#ifndef TREND_CACHE_H
+#define TREND_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "trend_db.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ── Constants ─────────────────────────────────────────────── */
+
+#ifndef TREND_CACHE_BUDGET_BYTES
+#define TREND_CACHE_BUDGET_BYTES  (256 * 1024)
+#endif
+
+#define TREND_CACHE_MAX_ENTRIES   64
+#define TREND_CACHE_CHUNK_POINTS  32
+
+/* ── Key ───────────────────────────────────────────────────── */
+
+typedef struct {
+    int32_t            patient_id;  /* trend_db partition */
+    trend_param_t      param;
+    trend_tier_t       tier;        /* Resolved tier (never AUTO) */
+    uint32_t           range_s;
+    uint32_t           bucket_s;    /* AVG bucket width for the range */
+    uint32_t           end_ts;
+    int                max_points;  /* Row limit the result was fetched with */
+    trend_downsample_t ds;
+} trend_cache_key_t;
+
+/* ── Statistics ────────────────────────────────────────────── */
+
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t stores;
+    uint32_t evictions;         /* Entries dropped for space */
+    uint32_t invalidations;     /* Entries dropped by new data or purge */
+    uint32_t stale_stores;      /* Stores skipped: invalidated since the miss */
+    uint32_t entries;           /* Currently cached */
+    uint32_t bytes_used;        /* Chunk bytes held by entries */
+} trend_cache_stats_t;
+
+/* ── API ───────────────────────────────────────────────────── */
+
+/**
+ * Look up a result.
+ * @param generation  If non-NULL, receives the cache generation to pass
+ *                    to trend_cache_store() for the result read on a miss.
+ * @return true and fill `result` on a hit; false on a miss.
+ */
+bool trend_cache_lookup(const trend_cache_key_t *key,
+                        trend_query_result_t *result, uint32_t *generation);
+
+/**
+ * Store a result, replacing any entry with the same key and evicting
+ * least-recently-used entries as needed.
+ * @param generation  As reported by the trend_cache_lookup() miss that
+ *                    preceded the read.
+ * @return false if the cache was invalidated since that miss, or the
+ *         result cannot fit in the budget.
+ */
+bool trend_cache_store(const trend_cache_key_t *key,
+                       const trend_query_result_t *result,
+                       uint32_t generation);
+
+/** Drop every entry whose [end - range, end] overlaps [from_ts, to_ts]. */
+void trend_cache_invalidate_range(uint32_t from_ts, uint32_t to_ts);
+
+/** Drop all entries (statistics are kept). */
+void trend_cache_clear(void);
+
+/** Snapshot of cache counters. */
+trend_cache_stats_t trend_cache_get_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TREND_CACHE_H */
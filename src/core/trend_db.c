@@ -2,86 +2,589 @@
  * @file trend_db.c
  * @brief SQLite-backed trend storage implementation
  *
- * All database access is single-threaded (LVGL main loop).
+ * Inserts run on the data thread; purges, aggregation and trend queries
+ * run on job_pool workers.  Writes share one connection and every write
+ * entry point holds db_lock for the duration of its SQLite calls.  Purges
+ * delete in small chunks and release the lock between chunks so a 1 Hz
+ * insert never waits behind a large delete.
+ *
+ * Queries use a second, read-only connection (db_ro, guarded by ro_lock).
+ * Under WAL a reader never blocks the writer, so a 72 h query cannot hold
+ * off inserts.  Trend screen scans have a third one (db_scan, scan_lock),
+ * the only connection trend_db_interrupt_scans() aborts: exports and
+ * alarm history pages on db_ro always run to their last row.  In-memory
+ * databases cannot be shared between connections; there both fall back
+ * to the write connection.  A read that stops before SQLITE_DONE is an
+ * error (-1), never a short result.
+ *
+ * Every trend table is partitioned by patient: rows are clustered on
+ * (patient_id, ts), so a patient's range scan or purge touches only that
+ * patient's pages.  Each monitor slot writes into the partition bound to
+ * it (slot_partition); an unbound slot writes into its own anonymous
+ * partition.  trend_partitions lists the partitions that exist and
+ * whether their patient has been discharged.
+ *
+ * Raw samples are packed one row per minute (vitals_raw_min, see
+ * trend_raw_pack.h).  Each slot's current minute is collected in
+ * raw_cur[slot] under db_lock and written once when its last second
+ * arrives, when a sample for another minute arrives, or before that
+ * minute is aggregated.  Raw-tier queries decode the blobs and include a
+ * copy of raw_cur, so the unflushed minute is visible immediately.
+ *
+ * Writes that change aggregated history (minute aggregation, purge,
+ * segment import) invalidate the overlapping trend_cache entries.
+ *
+ * Storage stays bounded: the file uses incremental auto_vacuum, and
+ * trend_db_maintain() purges, enforces the size cap by purging the oldest
+ * hour early, then vacuums a chunk of free pages at a time with db_lock
+ * released between chunks, like the purge.
+ *
+ * Bed transfers move a partition as a trend_segment.h segment: export
+ * streams each table from one read snapshot into the caller's buffer,
+ * import replays the rows through the prepared insert statements inside
+ * a single transaction.
+ *
  * Uses pre-compiled prepared statements for performance.
  * Static result buffers avoid heap allocation in query paths.
  */
 
 #include "trend_db.h"
+#include "trend_cache.h"
+#include "trend_lttb.h"
+#include "trend_raw_pack.h"
+#include "trend_segment.h"
+#include "db_schema.h"
 #include "sqlite3.h"
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#include <pthread.h>
+#include <sys/stat.h>
 
 /* ── Retention limits (seconds) ─────────────────────────── */
 
-#define RAW_RETAIN_S     (4 * 3600)    /* 4 hours for raw 1-sec data */
+#define RAW_RETAIN_S     TREND_DB_RAW_RETAIN_S  /* 4 hours for raw 1-sec data */
 #define AGG_RETAIN_S     (72 * 3600)   /* 72 hours for 1-min aggregates */
 
+/* Rows deleted per purge statement before db_lock is released */
+#define PURGE_CHUNK_ROWS 256
+
+/* ── Storage limits ─────────────────────────────────────── */
+
+#define VACUUM_CHUNK_PAGES   64        /* Pages freed per db_lock hold */
+#define VACUUM_MAX_PAGES     4096      /* Per maintenance run */
+#define EARLY_PURGE_STEP_S   3600      /* History dropped per cap pass */
+#define CAP_LOW_WATER_PCT    90        /* Early purge stops below this */
+#define WAL_SIZE_LIMIT       (1024 * 1024)
+
 /* ── Module state ────────────────────────────────────────── */
 
 static sqlite3 *db = NULL;
+static pthread_mutex_t db_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Read-only query connection (NULL for in-memory databases) */
+static sqlite3 *db_ro = NULL;
+static pthread_mutex_t ro_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Trend screen scan connection (NULL for in-memory databases).  scan_lock
+ * is held for a whole scan; interrupt_lock only guards the pointer, so
+ * trend_db_interrupt_scans() can reach a scan without waiting for it and
+ * trend_db_close() cannot free the handle under it. */
+static sqlite3 *db_scan = NULL;
+static pthread_mutex_t scan_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t interrupt_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Partition receiving each slot's writes, and the raw minute being
+ * filled for it (guarded by db_lock) */
+static int32_t            slot_partition[TREND_DB_SLOTS];
+static trend_raw_minute_t raw_cur[TREND_DB_SLOTS];
+
+static uint64_t size_cap = TREND_DB_SIZE_CAP_BYTES;
 
 /* Prepared statements */
 static sqlite3_stmt *stmt_insert_raw    = NULL;
 static sqlite3_stmt *stmt_insert_1min   = NULL;
+static sqlite3_stmt *stmt_insert_1hour  = NULL;
 static sqlite3_stmt *stmt_insert_nibp   = NULL;
 static sqlite3_stmt *stmt_insert_alarm  = NULL;
+static sqlite3_stmt *stmt_insert_alarm_text = NULL;    /* Old segments */
 static sqlite3_stmt *stmt_query_raw     = NULL;
 static sqlite3_stmt *stmt_query_1min    = NULL;
 static sqlite3_stmt *stmt_query_nibp    = NULL;
-static sqlite3_stmt *stmt_query_alarm   = NULL;
+static sqlite3_stmt *stmt_query_alarm[4];  /* Bit 0: by param, 1: severity */
+static sqlite3_stmt *stmt_alarm_page    = NULL;
+static sqlite3_stmt *stmt_read_minutes  = NULL;
+static sqlite3_stmt *stmt_scan_nibp     = NULL;    /* On db_scan */
+static sqlite3_stmt *stmt_scan_alarm    = NULL;
 static sqlite3_stmt *stmt_purge_raw     = NULL;
 static sqlite3_stmt *stmt_purge_1min    = NULL;
+static sqlite3_stmt *stmt_purge_1hour   = NULL;
 static sqlite3_stmt *stmt_purge_nibp    = NULL;
 static sqlite3_stmt *stmt_purge_alarm   = NULL;
 
-/* Aggregation helper */
-static sqlite3_stmt *stmt_agg_select    = NULL;
+/* Raw minute lookup (write connection) */
+static sqlite3_stmt *stmt_load_raw      = NULL;
+
+/* Aggregation helpers */
+static sqlite3_stmt *stmt_agg_hour      = NULL;
+
+/* Partition catalogue */
+static sqlite3_stmt *stmt_part_bind     = NULL;
+static sqlite3_stmt *stmt_part_archive  = NULL;
+static sqlite3_stmt *stmt_part_next     = NULL;
+static sqlite3_stmt *stmt_part_has_data = NULL;
+static sqlite3_stmt *stmt_part_remove   = NULL;
+static sqlite3_stmt *stmt_part_oldest   = NULL;
 
 /* ── Schema creation ─────────────────────────────────────── */
 
+#define AGG_COLS \
+    "hr_avg, hr_min, hr_max, spo2_avg, spo2_min, spo2_max, " \
+    "rr_avg, rr_min, rr_max, temp_avg_x10, temp_min_x10, temp_max_x10"
+
 static const char *SCHEMA_SQL =
-    "CREATE TABLE IF NOT EXISTS vitals_raw ("
-    "  timestamp_s INTEGER PRIMARY KEY,"
-    "  hr INTEGER NOT NULL,"
-    "  spo2 INTEGER NOT NULL,"
-    "  rr INTEGER NOT NULL,"
-    "  temp_x10 INTEGER NOT NULL"
-    ");"
+    "CREATE TABLE IF NOT EXISTS vitals_raw_min ("
+    "  patient_id INTEGER NOT NULL,"
+    "  minute_ts INTEGER NOT NULL,"
+    "  hr BLOB NOT NULL,"
+    "  spo2 BLOB NOT NULL,"
+    "  rr BLOB NOT NULL,"
+    "  temp_x10 BLOB NOT NULL,"
+    "  PRIMARY KEY (patient_id, minute_ts)"
+    ") WITHOUT ROWID;"
     "CREATE TABLE IF NOT EXISTS vitals_1min ("
-    "  minute_ts INTEGER PRIMARY KEY,"
+    "  patient_id INTEGER NOT NULL,"
+    "  minute_ts INTEGER NOT NULL,"
     "  hr_avg INTEGER, hr_min INTEGER, hr_max INTEGER,"
     "  spo2_avg INTEGER, spo2_min INTEGER, spo2_max INTEGER,"
     "  rr_avg INTEGER, rr_min INTEGER, rr_max INTEGER,"
-    "  temp_avg_x10 INTEGER, temp_min_x10 INTEGER, temp_max_x10 INTEGER"
-    ");"
+    "  temp_avg_x10 INTEGER, temp_min_x10 INTEGER, temp_max_x10 INTEGER,"
+    "  PRIMARY KEY (patient_id, minute_ts)"
+    ") WITHOUT ROWID;"
+    "CREATE TABLE IF NOT EXISTS vitals_1hour ("
+    "  patient_id INTEGER NOT NULL,"
+    "  hour_ts INTEGER NOT NULL,"
+    "  hr_avg INTEGER, hr_min INTEGER, hr_max INTEGER,"
+    "  spo2_avg INTEGER, spo2_min INTEGER, spo2_max INTEGER,"
+    "  rr_avg INTEGER, rr_min INTEGER, rr_max INTEGER,"
+    "  temp_avg_x10 INTEGER, temp_min_x10 INTEGER, temp_max_x10 INTEGER,"
+    "  PRIMARY KEY (patient_id, hour_ts)"
+    ") WITHOUT ROWID;"
     "CREATE TABLE IF NOT EXISTS nibp_measurements ("
-    "  timestamp_s INTEGER PRIMARY KEY,"
+    "  patient_id INTEGER NOT NULL,"
+    "  timestamp_s INTEGER NOT NULL,"
     "  sys INTEGER NOT NULL,"
     "  dia INTEGER NOT NULL,"
-    "  map_val INTEGER NOT NULL"
-    ");"
+    "  map_val INTEGER NOT NULL,"
+    "  PRIMARY KEY (patient_id, timestamp_s)"
+    ") WITHOUT ROWID;"
     "CREATE TABLE IF NOT EXISTS alarm_events ("
-    "  id INTEGER PRIMARY KEY AUTOINCREMENT,"
+    "  id INTEGER PRIMARY KEY,"
+    "  patient_id INTEGER NOT NULL DEFAULT 0,"
     "  timestamp_s INTEGER NOT NULL,"
+    "  param INTEGER NOT NULL,"
     "  severity INTEGER NOT NULL,"
-    "  message TEXT NOT NULL"
+    "  kind INTEGER NOT NULL,"
+    "  value INTEGER NOT NULL DEFAULT 0,"
+    "  threshold INTEGER NOT NULL DEFAULT 0,"
+    "  user_id INTEGER NOT NULL DEFAULT 0,"
+    "  duration_s INTEGER NOT NULL DEFAULT 0,"
+    "  has_reading INTEGER NOT NULL DEFAULT 0"
     ");"
-    "CREATE INDEX IF NOT EXISTS idx_alarm_ts ON alarm_events(timestamp_s);";
+    "CREATE INDEX IF NOT EXISTS idx_alarm_patient_ts "
+    "  ON alarm_events(patient_id, timestamp_s);"
+    "CREATE INDEX IF NOT EXISTS idx_alarm_param_ts "
+    "  ON alarm_events(patient_id, param, timestamp_s);"
+    "CREATE INDEX IF NOT EXISTS idx_alarm_severity_ts "
+    "  ON alarm_events(patient_id, severity, timestamp_s);"
+    "CREATE TABLE IF NOT EXISTS trend_partitions ("
+    "  patient_id INTEGER PRIMARY KEY,"
+    "  archived INTEGER NOT NULL DEFAULT 0"
+    ");";
+
+/*
+ * alarm_param_t of an alarm message written by an older build, which
+ * stored text ("SpO2 Low") instead of structured events.
+ * ALARM_PARAM_COUNT (6) when the text names no known parameter.
+ */
+#define LEGACY_ALARM_PARAM(msg) \
+    "CASE WHEN " msg " LIKE 'HR%' THEN 0 WHEN " msg " LIKE 'SpO2%' THEN 1 " \
+    "WHEN " msg " LIKE 'RR%' THEN 2 WHEN " msg " LIKE 'Temp%' THEN 3 " \
+    "WHEN " msg " LIKE 'NIBP Sys%' THEN 4 " \
+    "WHEN " msg " LIKE 'NIBP Dia%' THEN 5 ELSE 6 END"
+
+#define ALARM_COLS \
+    "param, severity, kind, value, threshold, user_id, duration_s, has_reading"
+
+/**
+ * Partitioned tables with the time column that follows patient_id, the
+ * columns carried over from an unpartitioned (older) layout and the
+ * expressions that read them there (NULL: the same columns).
+ */
+typedef struct {
+    const char *table;
+    const char *ts_col;
+    const char *legacy_cols;
+    const char *legacy_select;
+} part_table_t;
+
+static const part_table_t PART_TABLES[] = {
+    { "vitals_raw_min",    "minute_ts",
+      "minute_ts, hr, spo2, rr, temp_x10", NULL },
+    { "vitals_1min",       "minute_ts",   "minute_ts, " AGG_COLS, NULL },
+    { "vitals_1hour",      "hour_ts",     "hour_ts, " AGG_COLS, NULL },
+    { "nibp_measurements", "timestamp_s", "timestamp_s, sys, dia, map_val",
+      NULL },
+    { "alarm_events",      "timestamp_s",
+      "id, timestamp_s, severity, param, kind",
+      "id, timestamp_s, severity, " LEGACY_ALARM_PARAM("message") ", 0" },
+};
+
+#define PART_TABLE_COUNT  (int)(sizeof(PART_TABLES) / sizeof(PART_TABLES[0]))
 
 /* ── Helper: prepare a single statement ──────────────────── */
 
-static bool prepare(sqlite3_stmt **out, const char *sql) {
-    int rc = sqlite3_prepare_v2(db, sql, -1, out, NULL);
+static bool prepare_on(sqlite3 *conn, sqlite3_stmt **out, const char *sql) {
+    int rc = sqlite3_prepare_v2(conn, sql, -1, out, NULL);
     if (rc != SQLITE_OK) {
         fprintf(stderr, "[trend_db] prepare failed: %s\n  SQL: %s\n",
-                sqlite3_errmsg(db), sql);
+                sqlite3_errmsg(conn), sql);
         return false;
     }
     return true;
 }
 
+static bool prepare(sqlite3_stmt **out, const char *sql) {
+    return prepare_on(db, out, sql);
+}
+
+/* ── Helper: query connection and its lock ───────────────── */
+
+static sqlite3 *query_conn(void) {
+    return db_ro ? db_ro : db;
+}
+
+static pthread_mutex_t *query_lock(void) {
+    return db_ro ? &ro_lock : &db_lock;
+}
+
+static sqlite3 *scan_conn(void) {
+    return db_scan ? db_scan : query_conn();
+}
+
+static pthread_mutex_t *scan_lock_of(void) {
+    return db_scan ? &scan_lock : query_lock();
+}
+
+/**
+ * Whether a row loop ended cleanly: at SQLITE_DONE, or on a row it chose
+ * not to read (its own limit).
+ */
+static bool read_ok(int rc, const char *what) {
+    if (rc == SQLITE_DONE || rc == SQLITE_ROW) return true;
+    if (rc != SQLITE_INTERRUPT) {
+        fprintf(stderr, "[trend_db] %s read failed: %s\n", what,
+                sqlite3_errstr(rc));
+    }
+    return false;
+}
+
+/** Open a read-only connection on a file database; NULL on failure. */
+static sqlite3 *open_reader(const char *path) {
+    sqlite3 *conn = NULL;
+    if (sqlite3_open_v2(path, &conn, SQLITE_OPEN_READONLY, NULL) == SQLITE_OK) {
+        sqlite3_exec(conn, "PRAGMA cache_size=200;", NULL, NULL, NULL);
+        return conn;
+    }
+    fprintf(stderr, "[trend_db] Reader open failed (%s), "
+            "queries share the write connection\n", sqlite3_errmsg(conn));
+    sqlite3_close(conn);
+    return NULL;
+}
+
+/* ── Raw minute buffer (db_lock held) ────────────────────── */
+
+/** Write one packed row for `m` into `partition`. */
+static void raw_write_locked(int32_t partition, const trend_raw_minute_t *m) {
+    if (m->count == 0 || !stmt_insert_raw) return;
+
+    uint8_t blob[TREND_RAW_CHANNELS][TREND_RAW_BLOB_BYTES];
+    sqlite3_reset(stmt_insert_raw);
+    sqlite3_bind_int(stmt_insert_raw, 1, (int)partition);
+    sqlite3_bind_int(stmt_insert_raw, 2, (int)m->minute_ts);
+    for (int c = 0; c < TREND_RAW_CHANNELS; c++) {
+        trend_raw_encode(m->v[c], blob[c]);
+        sqlite3_bind_blob(stmt_insert_raw, c + 3, blob[c],
+                          TREND_RAW_BLOB_BYTES, SQLITE_TRANSIENT);
+    }
+    sqlite3_step(stmt_insert_raw);
+}
+
+/** Write a slot's raw minute as one packed row and retire it. */
+static void raw_flush_locked(int slot) {
+    trend_raw_minute_t *m = &raw_cur[slot];
+    if (!m->active) return;
+    m->active = false;
+    raw_write_locked(slot_partition[slot], m);
+}
+
+/** Read a partition's stored row for minute `key`.  False if none. */
+static bool raw_load_locked(int32_t partition, uint32_t key,
+                            trend_raw_minute_t *out) {
+    if (!stmt_load_raw) return false;
+
+    sqlite3_reset(stmt_load_raw);
+    sqlite3_bind_int(stmt_load_raw, 1, (int)partition);
+    sqlite3_bind_int(stmt_load_raw, 2, (int)key);
+    if (sqlite3_step(stmt_load_raw) != SQLITE_ROW) return false;
+
+    out->active = true;
+    out->minute_ts = key;
+    for (int c = 0; c < TREND_RAW_CHANNELS; c++) {
+        int n = trend_raw_decode(sqlite3_column_blob(stmt_load_raw, c),
+                                 sqlite3_column_bytes(stmt_load_raw, c),
+                                 out->v[c]);
+        if (c == 0) out->count = n;
+    }
+    sqlite3_reset(stmt_load_raw);
+    return true;
+}
+
+static void raw_put_locked(int slot, uint32_t ts,
+                           const int32_t values[TREND_RAW_CHANNELS]) {
+    trend_raw_minute_t *m = &raw_cur[slot];
+    uint32_t key = trend_raw_minute_key(ts);
+
+    if (!m->active || m->minute_ts != key) {
+        raw_flush_locked(slot);
+        /* Late or repeated samples merge into an already stored minute */
+        if (!raw_load_locked(slot_partition[slot], key, m)) {
+            trend_raw_minute_reset(m, key);
+        }
+    }
+    trend_raw_minute_put(m, ts, values);
+
+    /* Last second of the minute: one write covers all 60 samples */
+    if (ts == key) raw_flush_locked(slot);
+}
+
+/* ── Partitions (db_lock held) ───────────────────────────── */
+
+/** Route a slot's writes to `partition`, recording it in the catalogue. */
+static void bind_slot_locked(int slot, int32_t partition) {
+    raw_flush_locked(slot);
+    slot_partition[slot] = partition;
+
+    if (!stmt_part_bind) return;
+    sqlite3_reset(stmt_part_bind);
+    sqlite3_bind_int(stmt_part_bind, 1, (int)partition);
+    sqlite3_step(stmt_part_bind);
+}
+
+/** Return any slot bound to `partition` to its anonymous partition. */
+static void unbind_partition_locked(int32_t partition) {
+    for (int s = 0; s < TREND_DB_SLOTS; s++) {
+        if (slot_partition[s] == partition &&
+            partition != TREND_DB_ANON_PATIENT(s)) {
+            bind_slot_locked(s, TREND_DB_ANON_PATIENT(s));
+        }
+    }
+}
+
+/* ── Schema upgrades ─────────────────────────────────────── */
+
+static bool table_exists(const char *name) {
+    sqlite3_stmt *st = NULL;
+    bool found = false;
+    if (sqlite3_prepare_v2(db,
+            "SELECT 1 FROM sqlite_master WHERE type='table' AND name=?1",
+            -1, &st, NULL) == SQLITE_OK) {
+        sqlite3_bind_text(st, 1, name, -1, SQLITE_STATIC);
+        found = (sqlite3_step(st) == SQLITE_ROW);
+    }
+    sqlite3_finalize(st);
+    return found;
+}
+
+static bool has_column(const char *table, const char *col) {
+    char sql[128];
+    sqlite3_stmt *st = NULL;
+    snprintf(sql, sizeof(sql), "SELECT %s FROM %s LIMIT 0", col, table);
+    bool ok = (sqlite3_prepare_v2(db, sql, -1, &st, NULL) == SQLITE_OK);
+    sqlite3_finalize(st);
+    return ok;
+}
+
+static int pragma_int(sqlite3 *conn, const char *sql) {
+    sqlite3_stmt *st = NULL;
+    int v = -1;
+    if (sqlite3_prepare_v2(conn, sql, -1, &st, NULL) == SQLITE_OK &&
+        sqlite3_step(st) == SQLITE_ROW) {
+        v = sqlite3_column_int(st, 0);
+    }
+    sqlite3_finalize(st);
+    return v;
+}
+
+/**
+ * Switch a database created without auto_vacuum to incremental mode.
+ * That takes a full VACUUM, so it happens once, at startup, before any
+ * other module has the file open.  New files get the mode from the
+ * pragma in trend_db_init().
+ */
+static bool enable_incremental_vacuum(void) {
+    if (pragma_int(db, "PRAGMA auto_vacuum;") == 2) return true;
+    sqlite3_exec(db, "PRAGMA auto_vacuum=INCREMENTAL;", NULL, NULL, NULL);
+    if (sqlite3_exec(db, "VACUUM;", NULL, NULL, NULL) != SQLITE_OK) {
+        fprintf(stderr, "[trend_db] auto_vacuum conversion failed: %s\n",
+                sqlite3_errmsg(db));
+        return false;
+    }
+    printf("[trend_db] Converted to incremental auto_vacuum\n");
+    return true;
+}
+
+/**
+ * Move trend tables without a patient_id column aside so SCHEMA_SQL can
+ * create the partitioned layout.  Runs before SCHEMA_SQL.
+ */
+static void set_aside_unpartitioned(void) {
+    char sql[160];
+    for (int i = 0; i < PART_TABLE_COUNT; i++) {
+        const char *t = PART_TABLES[i].table;
+        if (!table_exists(t) || has_column(t, "patient_id")) continue;
+        snprintf(sql, sizeof(sql),
+                 "ALTER TABLE %s RENAME TO %s_unpartitioned;", t, t);
+        sqlite3_exec(db, sql, NULL, NULL, NULL);
+    }
+}
+
+/**
+ * Copy tables set aside by set_aside_unpartitioned() into slot 0's
+ * anonymous partition, then drop them.  One transaction per table.
+ */
+static void adopt_unpartitioned(void) {
+    char old[64], sql[1024];
+    for (int i = 0; i < PART_TABLE_COUNT; i++) {
+        const part_table_t *pt = &PART_TABLES[i];
+        snprintf(old, sizeof(old), "%s_unpartitioned", pt->table);
+        if (!table_exists(old)) continue;
+
+        snprintf(sql, sizeof(sql),
+                 "BEGIN;"
+                 "INSERT OR REPLACE INTO %s (patient_id, %s) "
+                 "SELECT %d, %s FROM %s;"
+                 "DROP TABLE %s;"
+                 "COMMIT;",
+                 pt->table, pt->legacy_cols, (int)TREND_DB_ANON_PATIENT(0),
+                 pt->legacy_select ? pt->legacy_select : pt->legacy_cols,
+                 old, old);
+        char *err = NULL;
+        if (sqlite3_exec(db, sql, NULL, NULL, &err) != SQLITE_OK) {
+            fprintf(stderr, "[trend_db] Partitioning %s failed: %s\n",
+                    pt->table, err ? err : "?");
+            sqlite3_free(err);
+            sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
+            continue;
+        }
+        printf("[trend_db] Moved %s into partition %d\n",
+               pt->table, (int)TREND_DB_ANON_PATIENT(0));
+    }
+}
+
+/**
+ * Move a partitioned alarm_events table with a message column (older
+ * builds) aside, with its index, so SCHEMA_SQL can create the structured
+ * one.  Runs before SCHEMA_SQL, after set_aside_unpartitioned().
+ */
+static void set_aside_text_alarms(void) {
+    if (!table_exists("alarm_events") ||
+        !has_column("alarm_events", "message")) {
+        return;
+    }
+    sqlite3_exec(db, "DROP INDEX IF EXISTS idx_alarm_patient_ts;"
+                     "ALTER TABLE alarm_events RENAME TO alarm_events_text;",
+                 NULL, NULL, NULL);
+}
+
+/**
+ * Copy the table set aside by set_aside_text_alarms() into the structured
+ * layout as onset events, parameter taken from the message, then drop it.
+ */
+static void convert_text_alarms(void) {
+    if (!table_exists("alarm_events_text")) return;
+
+    char *err = NULL;
+    if (sqlite3_exec(db,
+            "BEGIN;"
+            "INSERT OR REPLACE INTO alarm_events "
+            "(id, patient_id, timestamp_s, severity, param, kind) "
+            "SELECT id, patient_id, timestamp_s, severity, "
+            LEGACY_ALARM_PARAM("message") ", 0 FROM alarm_events_text;"
+            "DROP TABLE alarm_events_text;"
+            "COMMIT;", NULL, NULL, &err) != SQLITE_OK) {
+        fprintf(stderr, "[trend_db] Alarm event conversion failed: %s\n",
+                err ? err : "?");
+        sqlite3_free(err);
+        sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
+        return;
+    }
+    printf("[trend_db] Converted alarm messages to structured events\n");
+}
+
+/**
+ * Add has_reading to a structured alarm_events table written before it
+ * existed, where a zero value or threshold meant "unknown".  Runs after
+ * SCHEMA_SQL, before the statements that name the column are prepared.
+ */
+static void add_alarm_reading_flag(void) {
+    if (has_column("alarm_events", "has_reading")) return;
+
+    char *err = NULL;
+    if (sqlite3_exec(db,
+            "BEGIN;"
+            "ALTER TABLE alarm_events "
+            "ADD COLUMN has_reading INTEGER NOT NULL DEFAULT 0;"
+            "UPDATE alarm_events SET has_reading = 1 "
+            "WHERE value != 0 AND threshold != 0;"
+            "COMMIT;", NULL, NULL, &err) != SQLITE_OK) {
+        fprintf(stderr, "[trend_db] Alarm reading flag upgrade failed: %s\n",
+                err ? err : "?");
+        sqlite3_free(err);
+        sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
+    }
+}
+
+/**
+ * Convert a per-second vitals_raw table left by an older build into
+ * packed minutes of slot 0's partition, then drop it.  No-op when the
+ * table does not exist.
+ */
+static void migrate_legacy_raw(void) {
+    sqlite3_stmt *st = NULL;
+    if (sqlite3_prepare_v2(db,
+            "SELECT timestamp_s, hr, spo2, rr, temp_x10 FROM vitals_raw "
+            "ORDER BY timestamp_s", -1, &st, NULL) != SQLITE_OK) {
+        return;
+    }
+
+    int moved = 0;
+    sqlite3_exec(db, "BEGIN;", NULL, NULL, NULL);
+    while (sqlite3_step(st) == SQLITE_ROW) {
+        int32_t values[TREND_RAW_CHANNELS];
+        for (int c = 0; c < TREND_RAW_CHANNELS; c++) {
+            values[c] = sqlite3_column_int(st, c + 1);
+        }
+        raw_put_locked(0, (uint32_t)sqlite3_column_int64(st, 0), values);
+        moved++;
+    }
+    sqlite3_finalize(st);
+    raw_flush_locked(0);
+    sqlite3_exec(db, "DROP TABLE vitals_raw; COMMIT;", NULL, NULL, NULL);
+
+    printf("[trend_db] Migrated %d raw samples to packed minutes\n", moved);
+}
+
 /* ── Lifecycle ───────────────────────────────────────────── */
 
 bool trend_db_init(const char *db_path) {
@@ -94,69 +597,175 @@ bool trend_db_init(const char *db_path) {
         return false;
     }
 
+    /* Takes effect on a new file; older files are converted below */
+    sqlite3_exec(db, "PRAGMA auto_vacuum=INCREMENTAL;", NULL, NULL, NULL);
+
     /* Performance pragmas */
     sqlite3_exec(db, "PRAGMA journal_mode=WAL;", NULL, NULL, NULL);
     sqlite3_exec(db, "PRAGMA synchronous=NORMAL;", NULL, NULL, NULL);
     sqlite3_exec(db, "PRAGMA cache_size=200;", NULL, NULL, NULL);
 
-    /* Create tables */
-    char *err_msg = NULL;
-    rc = sqlite3_exec(db, SCHEMA_SQL, NULL, NULL, &err_msg);
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "[trend_db] Schema creation failed: %s\n", err_msg);
-        sqlite3_free(err_msg);
-        sqlite3_close(db);
-        db = NULL;
-        return false;
+    /* Truncate the WAL back to this size after each checkpoint reset */
+    char wal_limit[48];
+    snprintf(wal_limit, sizeof(wal_limit), "PRAGMA journal_size_limit=%d;",
+             WAL_SIZE_LIMIT);
+    sqlite3_exec(db, wal_limit, NULL, NULL, NULL);
+
+    /* Create tables (older unpartitioned ones are moved aside first).
+     * A file already stamped current skips this and the upgrades below. */
+    bool upgrade = !db_schema_is_current(db, DB_SCHEMA_TREND);
+    if (upgrade) {
+        set_aside_unpartitioned();
+        set_aside_text_alarms();
+        char *err_msg = NULL;
+        rc = sqlite3_exec(db, SCHEMA_SQL, NULL, NULL, &err_msg);
+        if (rc != SQLITE_OK) {
+            fprintf(stderr, "[trend_db] Schema creation failed: %s\n", err_msg);
+            sqlite3_free(err_msg);
+            sqlite3_close(db);
+            db = NULL;
+            return false;
+        }
+        add_alarm_reading_flag();
     }
 
     /* Prepare all statements */
     bool ok = true;
     ok = ok && prepare(&stmt_insert_raw,
-        "INSERT OR REPLACE INTO vitals_raw (timestamp_s, hr, spo2, rr, temp_x10) "
-        "VALUES (?1, ?2, ?3, ?4, ?5)");
+        "INSERT OR REPLACE INTO vitals_raw_min "
+        "(patient_id, minute_ts, hr, spo2, rr, temp_x10) "
+        "VALUES (?1, ?2, ?3, ?4, ?5, ?6)");
+
+    ok = ok && prepare(&stmt_load_raw,
+        "SELECT hr, spo2, rr, temp_x10 FROM vitals_raw_min "
+        "WHERE patient_id = ?1 AND minute_ts = ?2");
 
     ok = ok && prepare(&stmt_insert_1min,
         "INSERT OR REPLACE INTO vitals_1min "
-        "(minute_ts, hr_avg, hr_min, hr_max, spo2_avg, spo2_min, spo2_max, "
-        "rr_avg, rr_min, rr_max, temp_avg_x10, temp_min_x10, temp_max_x10) "
-        "VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11, ?12, ?13)");
+        "(patient_id, minute_ts, " AGG_COLS ") "
+        "VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11, ?12, ?13, ?14)");
+
+    ok = ok && prepare(&stmt_insert_1hour,
+        "INSERT OR REPLACE INTO vitals_1hour "
+        "(patient_id, hour_ts, " AGG_COLS ") "
+        "VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11, ?12, ?13, ?14)");
 
     ok = ok && prepare(&stmt_insert_nibp,
-        "INSERT OR REPLACE INTO nibp_measurements (timestamp_s, sys, dia, map_val) "
-        "VALUES (?1, ?2, ?3, ?4)");
+        "INSERT OR REPLACE INTO nibp_measurements "
+        "(patient_id, timestamp_s, sys, dia, map_val) "
+        "VALUES (?1, ?2, ?3, ?4, ?5)");
 
     ok = ok && prepare(&stmt_insert_alarm,
-        "INSERT INTO alarm_events (timestamp_s, severity, message) "
-        "VALUES (?1, ?2, ?3)");
-
-    ok = ok && prepare(&stmt_agg_select,
-        "SELECT AVG(hr), MIN(hr), MAX(hr), "
-        "AVG(spo2), MIN(spo2), MAX(spo2), "
-        "AVG(rr), MIN(rr), MAX(rr), "
-        "AVG(temp_x10), MIN(temp_x10), MAX(temp_x10) "
-        "FROM vitals_raw WHERE timestamp_s > ?1 AND timestamp_s <= ?2");
+        "INSERT INTO alarm_events (patient_id, timestamp_s, " ALARM_COLS ") "
+        "VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10)");
+    ok = ok && prepare(&stmt_insert_alarm_text,
+        "INSERT INTO alarm_events (patient_id, timestamp_s, severity, "
+        "param, kind) VALUES (?1, ?2, ?3, " LEGACY_ALARM_PARAM("?4") ", 0)");
+
+    ok = ok && prepare(&stmt_agg_hour,
+        "SELECT AVG(hr_avg), MIN(hr_min), MAX(hr_max), "
+        "AVG(spo2_avg), MIN(spo2_min), MAX(spo2_max), "
+        "AVG(rr_avg), MIN(rr_min), MAX(rr_max), "
+        "AVG(temp_avg_x10), MIN(temp_min_x10), MAX(temp_max_x10) "
+        "FROM vitals_1min "
+        "WHERE patient_id = ?1 AND minute_ts > ?2 AND minute_ts <= ?3");
+
+    ok = ok && prepare(&stmt_part_bind,
+        "INSERT OR REPLACE INTO trend_partitions (patient_id, archived) "
+        "VALUES (?1, 0)");
+    ok = ok && prepare(&stmt_part_archive,
+        "UPDATE trend_partitions SET archived = 1 WHERE patient_id = ?1");
+    ok = ok && prepare(&stmt_part_next,
+        "SELECT patient_id, archived FROM trend_partitions "
+        "WHERE patient_id > ?1 ORDER BY patient_id LIMIT 1");
+    ok = ok && prepare(&stmt_part_has_data,
+        "SELECT EXISTS (SELECT 1 FROM vitals_raw_min WHERE patient_id = ?1) "
+        "OR EXISTS (SELECT 1 FROM vitals_1min WHERE patient_id = ?1) "
+        "OR EXISTS (SELECT 1 FROM vitals_1hour WHERE patient_id = ?1) "
+        "OR EXISTS (SELECT 1 FROM nibp_measurements WHERE patient_id = ?1) "
+        "OR EXISTS (SELECT 1 FROM alarm_events WHERE patient_id = ?1)");
+    ok = ok && prepare(&stmt_part_remove,
+        "DELETE FROM trend_partitions WHERE patient_id = ?1");
+    ok = ok && prepare(&stmt_part_oldest,
+        "SELECT MIN(minute_ts) FROM vitals_1min WHERE patient_id = ?1");
+
+    /* Read-only query and scan connections (file databases only) */
+    if (strcmp(path, ":memory:") != 0) {
+        db_ro = open_reader(path);
+        if (db_ro) {
+            sqlite3 *scan = open_reader(path);
+            pthread_mutex_lock(&interrupt_lock);
+            db_scan = scan;
+            pthread_mutex_unlock(&interrupt_lock);
+        }
+    }
 
     /* Query statements use dynamic SQL via sqlite3_exec, not prepared.
      * But for the common raw/1min queries we prepare templates. */
-    ok = ok && prepare(&stmt_query_nibp,
+    ok = ok && prepare_on(query_conn(), &stmt_query_nibp,
         "SELECT timestamp_s, sys, dia, map_val FROM nibp_measurements "
-        "WHERE timestamp_s >= ?1 AND timestamp_s <= ?2 "
-        "ORDER BY timestamp_s LIMIT ?3");
+        "WHERE patient_id = ?1 AND timestamp_s >= ?2 AND timestamp_s <= ?3 "
+        "ORDER BY timestamp_s LIMIT ?4");
+
+    /* One statement per filter, each matching an index exactly */
+    static const char *const alarm_filter_sql[4] = {
+        "",
+        "AND param = ?5 ",
+        "AND severity = ?6 ",
+        "AND param = ?5 AND severity = ?6 ",
+    };
+    for (int f = 0; f < 4; f++) {
+        char sql[320];
+        snprintf(sql, sizeof(sql),
+                 "SELECT timestamp_s, " ALARM_COLS " FROM alarm_events "
+                 "WHERE patient_id = ?1 AND timestamp_s >= ?2 "
+                 "AND timestamp_s <= ?3 %s"
+                 "ORDER BY timestamp_s, id LIMIT ?4", alarm_filter_sql[f]);
+        ok = ok && prepare_on(query_conn(), &stmt_query_alarm[f], sql);
+        if (f == 0 && db_scan) {
+            ok = ok && prepare_on(db_scan, &stmt_scan_alarm, sql);
+        }
+    }
+    if (db_scan) {
+        ok = ok && prepare_on(db_scan, &stmt_scan_nibp,
+            "SELECT timestamp_s, sys, dia, map_val FROM nibp_measurements "
+            "WHERE patient_id = ?1 AND timestamp_s >= ?2 AND timestamp_s <= ?3 "
+            "ORDER BY timestamp_s LIMIT ?4");
+    }
+
+    /* (patient_id, timestamp_s) index, whose entries end in the rowid */
+    ok = ok && prepare_on(query_conn(), &stmt_alarm_page,
+        "SELECT id, timestamp_s, " ALARM_COLS " FROM alarm_events "
+        "WHERE patient_id = ?1 AND timestamp_s <= ?2 "
+        "AND (timestamp_s < ?2 OR id < ?3) "
+        "ORDER BY timestamp_s DESC, id DESC LIMIT ?4");
 
-    ok = ok && prepare(&stmt_query_alarm,
-        "SELECT timestamp_s, severity, message FROM alarm_events "
-        "WHERE timestamp_s >= ?1 AND timestamp_s <= ?2 "
-        "ORDER BY timestamp_s LIMIT ?3");
+    ok = ok && prepare_on(query_conn(), &stmt_read_minutes,
+        "SELECT minute_ts, " AGG_COLS " FROM vitals_1min "
+        "WHERE patient_id = ?1 AND minute_ts >= ?2 AND minute_ts <= ?3 "
+        "ORDER BY minute_ts LIMIT ?4");
 
+    /* Purges walk one partition's clustered key range at a time */
     ok = ok && prepare(&stmt_purge_raw,
-        "DELETE FROM vitals_raw WHERE timestamp_s < ?1");
+        "DELETE FROM vitals_raw_min WHERE patient_id = ?1 AND minute_ts IN "
+        "(SELECT minute_ts FROM vitals_raw_min "
+        "WHERE patient_id = ?1 AND minute_ts < ?2 LIMIT ?3)");
     ok = ok && prepare(&stmt_purge_1min,
-        "DELETE FROM vitals_1min WHERE minute_ts < ?1");
+        "DELETE FROM vitals_1min WHERE patient_id = ?1 AND minute_ts IN "
+        "(SELECT minute_ts FROM vitals_1min "
+        "WHERE patient_id = ?1 AND minute_ts < ?2 LIMIT ?3)");
+    ok = ok && prepare(&stmt_purge_1hour,
+        "DELETE FROM vitals_1hour WHERE patient_id = ?1 AND hour_ts IN "
+        "(SELECT hour_ts FROM vitals_1hour "
+        "WHERE patient_id = ?1 AND hour_ts < ?2 LIMIT ?3)");
     ok = ok && prepare(&stmt_purge_nibp,
-        "DELETE FROM nibp_measurements WHERE timestamp_s < ?1");
+        "DELETE FROM nibp_measurements WHERE patient_id = ?1 AND timestamp_s IN "
+        "(SELECT timestamp_s FROM nibp_measurements "
+        "WHERE patient_id = ?1 AND timestamp_s < ?2 LIMIT ?3)");
     ok = ok && prepare(&stmt_purge_alarm,
-        "DELETE FROM alarm_events WHERE timestamp_s < ?1");
+        "DELETE FROM alarm_events WHERE id IN "
+        "(SELECT id FROM alarm_events "
+        "WHERE patient_id = ?1 AND timestamp_s < ?2 LIMIT ?3)");
 
     if (!ok) {
         fprintf(stderr, "[trend_db] Statement preparation failed\n");
@@ -164,6 +773,24 @@ bool trend_db_init(const char *db_path) {
         return false;
     }
 
+    if (upgrade) {
+        adopt_unpartitioned();
+        convert_text_alarms();
+    }
+
+    /* Slots start unbound, each writing to its anonymous partition */
+    for (int s = 0; s < TREND_DB_SLOTS; s++) {
+        raw_cur[s].active = false;
+        bind_slot_locked(s, TREND_DB_ANON_PATIENT(s));
+    }
+    if (upgrade) {
+        migrate_legacy_raw();
+        if (enable_incremental_vacuum()) {
+            db_schema_mark_current(db, DB_SCHEMA_TREND);
+        }
+    }
+
+    trend_cache_clear();
     printf("[trend_db] Initialized: %s\n", path);
     return true;
 }
@@ -176,101 +803,283 @@ static void finalize_stmt(sqlite3_stmt **s) {
 }
 
 void trend_db_close(void) {
+    pthread_mutex_lock(&db_lock);
+    for (int s = 0; s < TREND_DB_SLOTS; s++) {
+        raw_flush_locked(s);    /* Keep the partial minute */
+    }
     finalize_stmt(&stmt_insert_raw);
+    finalize_stmt(&stmt_load_raw);
     finalize_stmt(&stmt_insert_1min);
+    finalize_stmt(&stmt_insert_1hour);
     finalize_stmt(&stmt_insert_nibp);
     finalize_stmt(&stmt_insert_alarm);
-    finalize_stmt(&stmt_agg_select);
+    finalize_stmt(&stmt_insert_alarm_text);
+    finalize_stmt(&stmt_agg_hour);
     finalize_stmt(&stmt_query_raw);
     finalize_stmt(&stmt_query_1min);
     finalize_stmt(&stmt_query_nibp);
-    finalize_stmt(&stmt_query_alarm);
+    for (int f = 0; f < 4; f++) finalize_stmt(&stmt_query_alarm[f]);
+    finalize_stmt(&stmt_alarm_page);
+    finalize_stmt(&stmt_read_minutes);
+    finalize_stmt(&stmt_scan_nibp);
+    finalize_stmt(&stmt_scan_alarm);
     finalize_stmt(&stmt_purge_raw);
     finalize_stmt(&stmt_purge_1min);
+    finalize_stmt(&stmt_purge_1hour);
     finalize_stmt(&stmt_purge_nibp);
     finalize_stmt(&stmt_purge_alarm);
+    finalize_stmt(&stmt_part_bind);
+    finalize_stmt(&stmt_part_archive);
+    finalize_stmt(&stmt_part_next);
+    finalize_stmt(&stmt_part_has_data);
+    finalize_stmt(&stmt_part_remove);
+    finalize_stmt(&stmt_part_oldest);
+
+    pthread_mutex_lock(&ro_lock);
+    if (db_ro) {
+        sqlite3_close(db_ro);
+        db_ro = NULL;
+    }
+    pthread_mutex_unlock(&ro_lock);
+
+    pthread_mutex_lock(&scan_lock);
+    pthread_mutex_lock(&interrupt_lock);
+    if (db_scan) {
+        sqlite3_close(db_scan);
+        db_scan = NULL;
+    }
+    pthread_mutex_unlock(&interrupt_lock);
+    pthread_mutex_unlock(&scan_lock);
 
     if (db) {
         sqlite3_close(db);
         db = NULL;
         printf("[trend_db] Closed\n");
     }
+    pthread_mutex_unlock(&db_lock);
+
+    trend_cache_clear();
 }
 
 /* ── Insertion ───────────────────────────────────────────── */
 
-void trend_db_insert_sample(uint32_t timestamp_s, int hr, int spo2,
-                             int rr, float temp) {
-    if (!db || !stmt_insert_raw) return;
+void trend_db_insert_sample(uint8_t slot, uint32_t timestamp_s, int hr,
+                             int spo2, int rr, float temp) {
+    if (slot >= TREND_DB_SLOTS) return;
 
-    sqlite3_reset(stmt_insert_raw);
-    sqlite3_bind_int(stmt_insert_raw, 1, (int)timestamp_s);
-    sqlite3_bind_int(stmt_insert_raw, 2, hr);
-    sqlite3_bind_int(stmt_insert_raw, 3, spo2);
-    sqlite3_bind_int(stmt_insert_raw, 4, rr);
-    sqlite3_bind_int(stmt_insert_raw, 5, (int)roundf(temp * 10.0f));
-    sqlite3_step(stmt_insert_raw);
+    pthread_mutex_lock(&db_lock);
+    if (!db || !stmt_insert_raw) {
+        pthread_mutex_unlock(&db_lock);
+        return;
+    }
+
+    int32_t values[TREND_RAW_CHANNELS] = {
+        hr, spo2, rr, (int32_t)roundf(temp * 10.0f)
+    };
+    raw_put_locked(slot, timestamp_s, values);
+    pthread_mutex_unlock(&db_lock);
 }
 
-void trend_db_insert_nibp(uint32_t timestamp_s, int sys, int dia,
-                           int map_val) {
-    if (!db || !stmt_insert_nibp) return;
+void trend_db_insert_nibp(uint8_t slot, uint32_t timestamp_s, int sys,
+                           int dia, int map_val) {
+    if (slot >= TREND_DB_SLOTS) return;
+
+    pthread_mutex_lock(&db_lock);
+    if (!db || !stmt_insert_nibp) {
+        pthread_mutex_unlock(&db_lock);
+        return;
+    }
 
     sqlite3_reset(stmt_insert_nibp);
-    sqlite3_bind_int(stmt_insert_nibp, 1, (int)timestamp_s);
-    sqlite3_bind_int(stmt_insert_nibp, 2, sys);
-    sqlite3_bind_int(stmt_insert_nibp, 3, dia);
-    sqlite3_bind_int(stmt_insert_nibp, 4, map_val);
+    sqlite3_bind_int(stmt_insert_nibp, 1, (int)slot_partition[slot]);
+    sqlite3_bind_int(stmt_insert_nibp, 2, (int)timestamp_s);
+    sqlite3_bind_int(stmt_insert_nibp, 3, sys);
+    sqlite3_bind_int(stmt_insert_nibp, 4, dia);
+    sqlite3_bind_int(stmt_insert_nibp, 5, map_val);
     sqlite3_step(stmt_insert_nibp);
+    pthread_mutex_unlock(&db_lock);
 }
 
-void trend_db_insert_alarm(uint32_t timestamp_s,
-                            vm_alarm_severity_t severity,
-                            const char *message) {
-    if (!db || !stmt_insert_alarm) return;
+void trend_db_insert_alarm(uint8_t slot, uint32_t timestamp_s,
+                           const alarm_event_t *evt) {
+    if (slot >= TREND_DB_SLOTS || !evt) return;
+
+    pthread_mutex_lock(&db_lock);
+    if (!db || !stmt_insert_alarm) {
+        pthread_mutex_unlock(&db_lock);
+        return;
+    }
 
     sqlite3_reset(stmt_insert_alarm);
-    sqlite3_bind_int(stmt_insert_alarm, 1, (int)timestamp_s);
-    sqlite3_bind_int(stmt_insert_alarm, 2, (int)severity);
-    sqlite3_bind_text(stmt_insert_alarm, 3, message, -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt_insert_alarm, 1, (int)slot_partition[slot]);
+    sqlite3_bind_int(stmt_insert_alarm, 2, (int)timestamp_s);
+    sqlite3_bind_int(stmt_insert_alarm, 3, (int)evt->param);
+    sqlite3_bind_int(stmt_insert_alarm, 4, (int)evt->severity);
+    sqlite3_bind_int(stmt_insert_alarm, 5, (int)evt->kind);
+    sqlite3_bind_int(stmt_insert_alarm, 6, (int)evt->value);
+    sqlite3_bind_int(stmt_insert_alarm, 7, (int)evt->threshold);
+    sqlite3_bind_int(stmt_insert_alarm, 8, (int)evt->user_id);
+    sqlite3_bind_int64(stmt_insert_alarm, 9, (int64_t)evt->duration_s);
+    sqlite3_bind_int(stmt_insert_alarm, 10, evt->has_reading ? 1 : 0);
     sqlite3_step(stmt_insert_alarm);
+    pthread_mutex_unlock(&db_lock);
 }
 
 /* ── Aggregation ─────────────────────────────────────────── */
 
+/** Roll a partition's 60 one-minute rows ending at hour_ts into vitals_1hour. */
+static void aggregate_hour_locked(int32_t partition, uint32_t hour_ts) {
+    if (!stmt_agg_hour || !stmt_insert_1hour) return;
+
+    sqlite3_reset(stmt_agg_hour);
+    sqlite3_bind_int(stmt_agg_hour, 1, (int)partition);
+    sqlite3_bind_int(stmt_agg_hour, 2, (int)(hour_ts - 3600));
+    sqlite3_bind_int(stmt_agg_hour, 3, (int)hour_ts);
+
+    bool have = sqlite3_step(stmt_agg_hour) == SQLITE_ROW &&
+                sqlite3_column_type(stmt_agg_hour, 0) != SQLITE_NULL;
+    if (have) {
+        sqlite3_reset(stmt_insert_1hour);
+        sqlite3_bind_int(stmt_insert_1hour, 1, (int)partition);
+        sqlite3_bind_int(stmt_insert_1hour, 2, (int)hour_ts);
+        for (int c = 0; c < 12; c++) {
+            sqlite3_bind_int(stmt_insert_1hour, c + 3,
+                             sqlite3_column_int(stmt_agg_hour, c));
+        }
+    }
+    /* An unfinished SELECT keeps a read lock that stops the WAL restarting */
+    sqlite3_reset(stmt_agg_hour);
+    if (have) sqlite3_step(stmt_insert_1hour);
+}
+
+/** Roll a partition's stored raw minute into vitals_1min (and 1hour). */
+static void aggregate_partition_locked(int32_t partition,
+                                       uint32_t minute_boundary_ts) {
+    trend_raw_minute_t m;
+    if (!raw_load_locked(partition, minute_boundary_ts, &m) || m.count == 0) {
+        return;
+    }
+
+    sqlite3_reset(stmt_insert_1min);
+    sqlite3_bind_int(stmt_insert_1min, 1, (int)partition);
+    sqlite3_bind_int(stmt_insert_1min, 2, (int)minute_boundary_ts);
+    /* HR, SpO2, RR, Temp: avg, min, max */
+    for (int c = 0; c < TREND_RAW_CHANNELS; c++) {
+        trend_raw_stats_t st = trend_raw_channel_stats(m.v[c]);
+        sqlite3_bind_int(stmt_insert_1min, 3 * c + 3, st.avg);
+        sqlite3_bind_int(stmt_insert_1min, 3 * c + 4, st.min);
+        sqlite3_bind_int(stmt_insert_1min, 3 * c + 5, st.max);
+    }
+    sqlite3_step(stmt_insert_1min);
+
+    /* Hourly rollup once the last minute of an hour is in */
+    if (minute_boundary_ts % 3600 == 0) {
+        aggregate_hour_locked(partition, minute_boundary_ts);
+    }
+}
+
+/** Aggregate one slot's minute into the partition bound to it. */
+static void aggregate_minute_locked(int slot, uint32_t minute_boundary_ts) {
+    if (!db || !stmt_insert_1min) return;
+
+    /* The blob for key M holds exactly (M - 60, M] */
+    if (raw_cur[slot].active && raw_cur[slot].minute_ts <= minute_boundary_ts) {
+        raw_flush_locked(slot);
+    }
+    aggregate_partition_locked(slot_partition[slot], minute_boundary_ts);
+}
+
 void trend_db_aggregate_minute(uint32_t minute_boundary_ts) {
-    if (!db || !stmt_agg_select || !stmt_insert_1min) return;
-
-    uint32_t start = minute_boundary_ts - 59;
-
-    sqlite3_reset(stmt_agg_select);
-    sqlite3_bind_int(stmt_agg_select, 1, (int)(start - 1));
-    sqlite3_bind_int(stmt_agg_select, 2, (int)minute_boundary_ts);
-
-    if (sqlite3_step(stmt_agg_select) == SQLITE_ROW) {
-        /* Check if any data exists (AVG returns NULL if no rows) */
-        if (sqlite3_column_type(stmt_agg_select, 0) == SQLITE_NULL) return;
-
-        sqlite3_reset(stmt_insert_1min);
-        sqlite3_bind_int(stmt_insert_1min, 1, (int)minute_boundary_ts);
-        /* HR: avg, min, max */
-        sqlite3_bind_int(stmt_insert_1min, 2, sqlite3_column_int(stmt_agg_select, 0));
-        sqlite3_bind_int(stmt_insert_1min, 3, sqlite3_column_int(stmt_agg_select, 1));
-        sqlite3_bind_int(stmt_insert_1min, 4, sqlite3_column_int(stmt_agg_select, 2));
-        /* SpO2: avg, min, max */
-        sqlite3_bind_int(stmt_insert_1min, 5, sqlite3_column_int(stmt_agg_select, 3));
-        sqlite3_bind_int(stmt_insert_1min, 6, sqlite3_column_int(stmt_agg_select, 4));
-        sqlite3_bind_int(stmt_insert_1min, 7, sqlite3_column_int(stmt_agg_select, 5));
-        /* RR: avg, min, max */
-        sqlite3_bind_int(stmt_insert_1min, 8, sqlite3_column_int(stmt_agg_select, 6));
-        sqlite3_bind_int(stmt_insert_1min, 9, sqlite3_column_int(stmt_agg_select, 7));
-        sqlite3_bind_int(stmt_insert_1min, 10, sqlite3_column_int(stmt_agg_select, 8));
-        /* Temp: avg, min, max */
-        sqlite3_bind_int(stmt_insert_1min, 11, sqlite3_column_int(stmt_agg_select, 9));
-        sqlite3_bind_int(stmt_insert_1min, 12, sqlite3_column_int(stmt_agg_select, 10));
-        sqlite3_bind_int(stmt_insert_1min, 13, sqlite3_column_int(stmt_agg_select, 11));
-        sqlite3_step(stmt_insert_1min);
+    pthread_mutex_lock(&db_lock);
+    for (int s = 0; s < TREND_DB_SLOTS; s++) {
+        aggregate_minute_locked(s, minute_boundary_ts);
+    }
+    pthread_mutex_unlock(&db_lock);
+
+    /* Cached views covering this minute predate its aggregate */
+    trend_cache_invalidate_range(minute_boundary_ts - 59, UINT32_MAX);
+}
+
+/* ── Partitions ──────────────────────────────────────────── */
+
+bool trend_db_bind_slot(uint8_t slot, int32_t patient_id) {
+    if (slot >= TREND_DB_SLOTS) return false;
+    int32_t partition = (patient_id > 0) ? patient_id
+                                         : TREND_DB_ANON_PATIENT(slot);
+
+    pthread_mutex_lock(&db_lock);
+    if (!db) {
+        pthread_mutex_unlock(&db_lock);
+        return false;
+    }
+    /* A patient is monitored on one slot at a time */
+    if (patient_id > 0) unbind_partition_locked(partition);
+    bind_slot_locked(slot, partition);
+    pthread_mutex_unlock(&db_lock);
+
+    printf("[trend_db] Slot %d -> partition %d\n", (int)slot, (int)partition);
+    return true;
+}
+
+int32_t trend_db_slot_patient(uint8_t slot) {
+    if (slot >= TREND_DB_SLOTS) return TREND_DB_ANON_PATIENT(0);
+
+    pthread_mutex_lock(&db_lock);
+    int32_t partition = slot_partition[slot];
+    pthread_mutex_unlock(&db_lock);
+    return partition;
+}
+
+bool trend_db_archive_patient(int32_t patient_id) {
+    if (patient_id <= 0) return false;
+
+    pthread_mutex_lock(&db_lock);
+    if (!db || !stmt_part_archive) {
+        pthread_mutex_unlock(&db_lock);
+        return false;
+    }
+    unbind_partition_locked(patient_id);
+    sqlite3_reset(stmt_part_archive);
+    sqlite3_bind_int(stmt_part_archive, 1, (int)patient_id);
+    bool ok = (sqlite3_step(stmt_part_archive) == SQLITE_DONE);
+    pthread_mutex_unlock(&db_lock);
+
+    printf("[trend_db] Archived partition %d\n", (int)patient_id);
+    return ok;
+}
+
+bool trend_db_drop_patient(int32_t patient_id) {
+    if (patient_id <= 0) return false;
+
+    pthread_mutex_lock(&db_lock);
+    if (!db || !stmt_part_remove) {
+        pthread_mutex_unlock(&db_lock);
+        return false;
+    }
+    unbind_partition_locked(patient_id);
+
+    /* One transaction: the partition disappears from every table at once */
+    bool ok = (sqlite3_exec(db, "BEGIN;", NULL, NULL, NULL) == SQLITE_OK);
+    char sql[96];
+    for (int i = 0; ok && i < PART_TABLE_COUNT; i++) {
+        snprintf(sql, sizeof(sql), "DELETE FROM %s WHERE patient_id = %d;",
+                 PART_TABLES[i].table, (int)patient_id);
+        ok = (sqlite3_exec(db, sql, NULL, NULL, NULL) == SQLITE_OK);
+    }
+    if (ok) {
+        sqlite3_reset(stmt_part_remove);
+        sqlite3_bind_int(stmt_part_remove, 1, (int)patient_id);
+        ok = (sqlite3_step(stmt_part_remove) == SQLITE_DONE);
     }
+    sqlite3_exec(db, ok ? "COMMIT;" : "ROLLBACK;", NULL, NULL, NULL);
+    pthread_mutex_unlock(&db_lock);
+
+    /* Cached series of that patient are gone with it */
+    if (ok) trend_cache_invalidate_range(0, UINT32_MAX);
+
+    printf("[trend_db] Dropped partition %d%s\n", (int)patient_id,
+           ok ? "" : " (failed)");
+    return ok;
 }
 
 /* ── Queries ─────────────────────────────────────────────── */
@@ -289,156 +1098,1168 @@ static const char *param_col_raw(trend_param_t p) {
     }
 }
 
-int trend_db_query_param(trend_param_t param, uint32_t start_ts,
-                          uint32_t end_ts, int max_points,
-                          trend_query_result_t *result) {
-    if (!db || !result) return 0;
-    result->count = 0;
-
+/**
+ * Table, timestamp column and base resolution of each storage tier.
+ */
+typedef struct {
+    const char *table;
+    const char *ts_col;
+    int         base_s;
+} tier_info_t;
+
+static const tier_info_t TIER_INFO[] = {
+    [TREND_TIER_RAW]   = { "vitals_raw_min", "minute_ts", 1    },
+    [TREND_TIER_1MIN]  = { "vitals_1min",    "minute_ts", 60   },
+    [TREND_TIER_1HOUR] = { "vitals_1hour",   "hour_ts",   3600 },
+};
+
+uint32_t trend_db_bucket_width(uint32_t range_s, int max_points,
+                               trend_tier_t *tier) {
     if (max_points > TREND_DB_MAX_POINTS) max_points = TREND_DB_MAX_POINTS;
+    if (max_points < 1) max_points = 1;
 
-    uint32_t range = end_ts - start_ts;
-    const char *col = param_col_raw(param);
+    if (*tier == TREND_TIER_AUTO) {
+        *tier = (range_s <= 7200) ? TREND_TIER_RAW : TREND_TIER_1MIN;
+    }
 
-    char sql[512];
+    /* Whole multiples of the tier resolution */
+    uint32_t base_s = (uint32_t)TIER_INFO[*tier].base_s;
+    uint32_t group_interval = (range_s / base_s) / (uint32_t)max_points;
+    if (group_interval < 1) group_interval = 1;
+    return group_interval * base_s;
+}
 
-    if (range <= 7200) {
-        /* Short range (≤2h): query vitals_raw with GROUP BY for downsampling */
-        int group_interval = (int)range / max_points;
-        if (group_interval < 1) group_interval = 1;
+/** Avg/min/max column names of a parameter in a tier. */
+typedef struct {
+    char avg[24];
+    char min[24];
+    char max[24];
+} param_cols_t;
 
-        snprintf(sql, sizeof(sql),
-            "SELECT (timestamp_s / %d) * %d AS ts, "
-            "AVG(%s) AS val, MIN(%s) AS vmin, MAX(%s) AS vmax "
-            "FROM vitals_raw "
-            "WHERE timestamp_s >= %u AND timestamp_s <= %u "
-            "GROUP BY ts ORDER BY ts LIMIT %d",
-            group_interval, group_interval,
-            col, col, col,
-            (unsigned)start_ts, (unsigned)end_ts, max_points);
+static void param_cols(trend_param_t param, trend_tier_t tier,
+                       param_cols_t *pc) {
+    const char *col = param_col_raw(param);
+
+    (void)tier;     /* Both aggregate tiers share column names */
+
+    if (param == TREND_PARAM_TEMP) {
+        /* Column names in the aggregate tiers differ for temp */
+        snprintf(pc->avg, sizeof(pc->avg), "temp_avg_x10");
+        snprintf(pc->min, sizeof(pc->min), "temp_min_x10");
+        snprintf(pc->max, sizeof(pc->max), "temp_max_x10");
     } else {
-        /* Long range (>2h): query vitals_1min with GROUP BY */
-        int group_interval = (int)(range / 60) / max_points;
-        if (group_interval < 1) group_interval = 1;
-
-        /* Column names in vitals_1min differ for temp */
-        const char *avg_col, *min_col, *max_col;
-        if (param == TREND_PARAM_TEMP) {
-            avg_col = "temp_avg_x10";
-            min_col = "temp_min_x10";
-            max_col = "temp_max_x10";
-        } else {
-            static char abuf[32], nbuf[32], xbuf[32];
-            snprintf(abuf, sizeof(abuf), "%s_avg", col);
-            snprintf(nbuf, sizeof(nbuf), "%s_min", col);
-            snprintf(xbuf, sizeof(xbuf), "%s_max", col);
-            avg_col = abuf;
-            min_col = nbuf;
-            max_col = xbuf;
+        snprintf(pc->avg, sizeof(pc->avg), "%s_avg", col);
+        snprintf(pc->min, sizeof(pc->min), "%s_min", col);
+        snprintf(pc->max, sizeof(pc->max), "%s_max", col);
+    }
+}
+
+/* ── Raw tier: decode packed minutes ─────────────────────── */
+
+/** Downsampling target for decoded raw samples. */
+typedef struct {
+    trend_downsample_t    ds;
+    trend_lttb_t          lttb;
+    trend_query_result_t *result;
+    int                   max_points;
+    uint32_t              bucket_s;
+    uint32_t              start_ts;
+    uint32_t              end_ts;
+    /* TREND_DS_AVG: bucket being accumulated */
+    uint32_t              cur_ts;
+    int64_t               sum;
+    int                   n;
+    int32_t               vmin;
+    int32_t               vmax;
+} raw_sink_t;
+
+static void raw_sink_close_bucket(raw_sink_t *k) {
+    trend_query_result_t *r = k->result;
+    if (k->n == 0) return;
+    if (r->count < k->max_points) {
+        r->timestamp_s[r->count] = k->cur_ts;
+        r->value[r->count]       = (int32_t)(k->sum / k->n);
+        r->value_min[r->count]   = k->vmin;
+        r->value_max[r->count]   = k->vmax;
+        r->count++;
+    }
+    k->sum = 0;
+    k->n = 0;
+}
+
+static void raw_sink_push(raw_sink_t *k, uint32_t ts, int32_t v) {
+    if (k->ds == TREND_DS_LTTB) {
+        trend_lttb_push(&k->lttb, ts, v, v, v);
+        return;
+    }
+
+    /* Same bucketing as the SQL path: (ts / bucket) * bucket */
+    uint32_t b = (ts / k->bucket_s) * k->bucket_s;
+    if (k->n > 0 && b != k->cur_ts) raw_sink_close_bucket(k);
+    if (k->n == 0) {
+        k->cur_ts = b;
+        k->vmin = k->vmax = v;
+    }
+    k->sum += v;
+    k->n++;
+    if (v < k->vmin) k->vmin = v;
+    if (v > k->vmax) k->vmax = v;
+}
+
+static void raw_sink_minute(raw_sink_t *k, uint32_t key,
+                            const int16_t v[TREND_RAW_SAMPLES]) {
+    for (int i = 0; i < TREND_RAW_SAMPLES; i++) {
+        uint32_t ts = trend_raw_slot_ts(key, i);
+        if (ts < k->start_ts || ts > k->end_ts) continue;
+        if (v[i] == TREND_RAW_MISSING) continue;
+        raw_sink_push(k, ts, v[i]);
+    }
+}
+
+/**
+ * Raw-tier query: read the packed minutes overlapping the range in time
+ * order and feed their samples to the AVG bucketer or trend_lttb.
+ * `pending` is a copy of the partition's unflushed minute; it replaces
+ * any stored row with the same key.
+ */
+static int query_raw_locked(sqlite3 *conn, int32_t partition,
+                            trend_param_t param, uint32_t start_ts, uint32_t end_ts,
+                            int max_points, uint32_t bucket_s,
+                            trend_downsample_t ds,
+                            const trend_raw_minute_t *pending,
+                            trend_query_result_t *result) {
+    char sql[192];
+    snprintf(sql, sizeof(sql),
+        "SELECT minute_ts, %s FROM vitals_raw_min "
+        "WHERE patient_id = %d AND minute_ts >= %u AND minute_ts <= %llu "
+        "ORDER BY minute_ts",
+        param_col_raw(param), (int)partition, (unsigned)start_ts,
+        (unsigned long long)end_ts + (TREND_RAW_SAMPLES - 1));
+
+    sqlite3_stmt *stmt = NULL;
+    if (sqlite3_prepare_v2(conn, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "[trend_db] query_raw prepare failed: %s\n",
+                sqlite3_errmsg(conn));
+        return -1;
+    }
+
+    raw_sink_t k;
+    memset(&k, 0, sizeof(k));
+    k.ds         = ds;
+    k.result     = result;
+    k.max_points = max_points;
+    k.bucket_s   = bucket_s;
+    k.start_ts   = start_ts;
+    k.end_ts     = end_ts;
+    if (ds == TREND_DS_LTTB) {
+        trend_lttb_init(&k.lttb, start_ts, end_ts, max_points,
+                        result->timestamp_s, result->value,
+                        result->value_min, result->value_max);
+    }
+
+    bool pending_done = !(pending && pending->active && pending->count > 0);
+    int16_t v[TREND_RAW_SAMPLES];
+
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        uint32_t key = (uint32_t)sqlite3_column_int64(stmt, 0);
+        if (!pending_done && pending->minute_ts <= key) {
+            raw_sink_minute(&k, pending->minute_ts, pending->v[param]);
+            pending_done = true;
+            if (pending->minute_ts == key) continue;
         }
+        trend_raw_decode(sqlite3_column_blob(stmt, 1),
+                         sqlite3_column_bytes(stmt, 1), v);
+        raw_sink_minute(&k, key, v);
+    }
+    sqlite3_finalize(stmt);
+    if (!read_ok(rc, "query_raw")) {
+        result->count = 0;
+        return -1;
+    }
+    if (!pending_done) {
+        raw_sink_minute(&k, pending->minute_ts, pending->v[param]);
+    }
 
-        snprintf(sql, sizeof(sql),
-            "SELECT (minute_ts / %d) * %d AS ts, "
-            "AVG(%s) AS val, MIN(%s) AS vmin, MAX(%s) AS vmax "
-            "FROM vitals_1min "
-            "WHERE minute_ts >= %u AND minute_ts <= %u "
-            "GROUP BY ts ORDER BY ts LIMIT %d",
-            group_interval * 60, group_interval * 60,
-            avg_col, min_col, max_col,
-            (unsigned)start_ts, (unsigned)end_ts, max_points);
+    if (ds == TREND_DS_LTTB) {
+        result->count = trend_lttb_finish(&k.lttb);
+        result->bucket_s = k.lttb.bucket_s;
+    } else {
+        raw_sink_close_bucket(&k);
+        result->bucket_s = bucket_s;
+    }
+    return result->count;
+}
+
+/**
+ * Copy the partition's unflushed raw minute if the request resolves to
+ * the raw tier, so queries see samples that have not been written yet.
+ */
+static void raw_snapshot(int32_t partition, uint32_t range_s, int max_points,
+                         trend_tier_t tier, trend_raw_minute_t *out) {
+    out->active = false;
+    trend_db_bucket_width(range_s, max_points, &tier);
+    if (tier != TREND_TIER_RAW) return;
+
+    pthread_mutex_lock(&db_lock);
+    for (int s = 0; s < TREND_DB_SLOTS; s++) {
+        if (slot_partition[s] == partition) *out = raw_cur[s];
+    }
+    pthread_mutex_unlock(&db_lock);
+}
+
+/* ── Aggregate tiers ─────────────────────────────────────── */
+
+static int query_param_locked(sqlite3 *conn, int32_t partition,
+                              trend_param_t param,
+                              uint32_t start_ts, uint32_t end_ts,
+                              int max_points, trend_tier_t tier,
+                              const trend_raw_minute_t *pending,
+                              trend_query_result_t *result) {
+    if (!conn || !result) return 0;
+    result->count = 0;
+    result->bucket_s = 0;
+
+    if (max_points > TREND_DB_MAX_POINTS) max_points = TREND_DB_MAX_POINTS;
+    if (max_points < 1) return 0;
+
+    int bucket_s = (int)trend_db_bucket_width(end_ts - start_ts, max_points,
+                                              &tier);
+    if (tier == TREND_TIER_RAW) {
+        return query_raw_locked(conn, partition, param, start_ts, end_ts,
+                                max_points, (uint32_t)bucket_s, TREND_DS_AVG,
+                                pending, result);
     }
+    const tier_info_t *ti = &TIER_INFO[tier];
+
+    char sql[512];
+    param_cols_t pc;
+    param_cols(param, tier, &pc);
+
+    snprintf(sql, sizeof(sql),
+        "SELECT (%s / %d) * %d AS ts, "
+        "AVG(%s) AS val, MIN(%s) AS vmin, MAX(%s) AS vmax "
+        "FROM %s "
+        "WHERE patient_id = %d AND %s >= %u AND %s <= %u "
+        "GROUP BY ts ORDER BY ts LIMIT %d",
+        ti->ts_col, bucket_s, bucket_s,
+        pc.avg, pc.min, pc.max,
+        ti->table, (int)partition,
+        ti->ts_col, (unsigned)start_ts, ti->ts_col, (unsigned)end_ts,
+        max_points);
 
     sqlite3_stmt *stmt = NULL;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+    if (sqlite3_prepare_v2(conn, sql, -1, &stmt, NULL) != SQLITE_OK) {
         fprintf(stderr, "[trend_db] query_param prepare failed: %s\n",
-                sqlite3_errmsg(db));
-        return 0;
+                sqlite3_errmsg(conn));
+        return -1;
     }
 
-    int i = 0;
-    while (sqlite3_step(stmt) == SQLITE_ROW && i < max_points) {
+    int i = 0, rc = SQLITE_DONE;
+    while (i < max_points && (rc = sqlite3_step(stmt)) == SQLITE_ROW) {
         result->timestamp_s[i] = (uint32_t)sqlite3_column_int(stmt, 0);
         result->value[i]       = sqlite3_column_int(stmt, 1);
         result->value_min[i]   = sqlite3_column_int(stmt, 2);
         result->value_max[i]   = sqlite3_column_int(stmt, 3);
         i++;
     }
+    sqlite3_finalize(stmt);
+    if (!read_ok(rc, "query_param")) return -1;
+
     result->count = i;
+    result->bucket_s = (uint32_t)bucket_s;
+    return i;
+}
+
+/**
+ * LTTB variant: stream the tier's rows in time order through trend_lttb.
+ * Reads every row in range but keeps the ones that shape the curve.
+ */
+static int query_param_lttb_locked(sqlite3 *conn, int32_t partition,
+                                   trend_param_t param,
+                                   uint32_t start_ts, uint32_t end_ts,
+                                   int max_points, trend_tier_t tier,
+                                   const trend_raw_minute_t *pending,
+                                   trend_query_result_t *result) {
+    if (!conn || !result) return 0;
+    result->count = 0;
+    result->bucket_s = 0;
+
+    if (max_points > TREND_DB_MAX_POINTS) max_points = TREND_DB_MAX_POINTS;
+    if (max_points < 1) return 0;
+
+    trend_db_bucket_width(end_ts - start_ts, max_points, &tier);
+    if (tier == TREND_TIER_RAW) {
+        return query_raw_locked(conn, partition, param, start_ts, end_ts,
+                                max_points, 1, TREND_DS_LTTB, pending,
+                                result);
+    }
+    const tier_info_t *ti = &TIER_INFO[tier];
+
+    char sql[512];
+    param_cols_t pc;
+    param_cols(param, tier, &pc);
+
+    snprintf(sql, sizeof(sql),
+        "SELECT %s, %s, %s, %s FROM %s "
+        "WHERE patient_id = %d AND %s >= %u AND %s <= %u ORDER BY %s",
+        ti->ts_col, pc.avg, pc.min, pc.max, ti->table, (int)partition,
+        ti->ts_col, (unsigned)start_ts, ti->ts_col, (unsigned)end_ts,
+        ti->ts_col);
 
+    sqlite3_stmt *stmt = NULL;
+    if (sqlite3_prepare_v2(conn, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "[trend_db] query_param_lttb prepare failed: %s\n",
+                sqlite3_errmsg(conn));
+        return -1;
+    }
+
+    trend_lttb_t lttb;
+    trend_lttb_init(&lttb, start_ts, end_ts, max_points,
+                    result->timestamp_s, result->value,
+                    result->value_min, result->value_max);
+
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        if (sqlite3_column_type(stmt, 1) == SQLITE_NULL) continue;
+        trend_lttb_push(&lttb, (uint32_t)sqlite3_column_int(stmt, 0),
+                        sqlite3_column_int(stmt, 1),
+                        sqlite3_column_int(stmt, 2),
+                        sqlite3_column_int(stmt, 3));
+    }
     sqlite3_finalize(stmt);
-    return i;
+    if (!read_ok(rc, "query_param_lttb")) return -1;
+
+    result->count = trend_lttb_finish(&lttb);
+    result->bucket_s = lttb.bucket_s;
+    return result->count;
+}
+
+int trend_db_query_param(int32_t patient_id, trend_param_t param,
+                          uint32_t start_ts, uint32_t end_ts, int max_points,
+                          trend_query_result_t *result) {
+    return trend_db_query_param_tier(patient_id, param, start_ts, end_ts,
+                                     max_points, TREND_TIER_AUTO, result);
+}
+
+int trend_db_query_param_tier(int32_t patient_id, trend_param_t param,
+                               uint32_t start_ts, uint32_t end_ts,
+                               int max_points, trend_tier_t tier,
+                               trend_query_result_t *result) {
+    if (tier < TREND_TIER_AUTO || tier > TREND_TIER_1HOUR) return 0;
+
+    trend_raw_minute_t pending;
+    raw_snapshot(patient_id, end_ts - start_ts, max_points, tier, &pending);
+
+    pthread_mutex_t *lock = query_lock();
+    pthread_mutex_lock(lock);
+    int n = query_param_locked(query_conn(), patient_id, param, start_ts,
+                               end_ts, max_points, tier, &pending, result);
+    pthread_mutex_unlock(lock);
+    return n;
+}
+
+int trend_db_scan_param(int32_t patient_id, trend_param_t param,
+                        uint32_t start_ts, uint32_t end_ts, int max_points,
+                        trend_tier_t tier, trend_downsample_t ds,
+                        trend_query_result_t *result) {
+    if (tier < TREND_TIER_AUTO || tier > TREND_TIER_1HOUR) return 0;
+
+    trend_raw_minute_t pending;
+    raw_snapshot(patient_id, end_ts - start_ts, max_points, tier, &pending);
+
+    pthread_mutex_t *lock = scan_lock_of();
+    pthread_mutex_lock(lock);
+    int n = (ds == TREND_DS_LTTB)
+        ? query_param_lttb_locked(scan_conn(), patient_id, param, start_ts,
+                                  end_ts, max_points, tier, &pending, result)
+        : query_param_locked(scan_conn(), patient_id, param, start_ts,
+                             end_ts, max_points, tier, &pending, result);
+    pthread_mutex_unlock(lock);
+    return n;
+}
+
+int trend_db_query_param_lttb(int32_t patient_id, trend_param_t param,
+                               uint32_t start_ts, uint32_t end_ts,
+                               int max_points, trend_tier_t tier,
+                               trend_query_result_t *result) {
+    if (tier < TREND_TIER_AUTO || tier > TREND_TIER_1HOUR) return 0;
+
+    trend_raw_minute_t pending;
+    raw_snapshot(patient_id, end_ts - start_ts, max_points, tier, &pending);
+
+    pthread_mutex_t *lock = query_lock();
+    pthread_mutex_lock(lock);
+    int n = query_param_lttb_locked(query_conn(), patient_id, param,
+                                    start_ts, end_ts, max_points, tier,
+                                    &pending, result);
+    pthread_mutex_unlock(lock);
+    return n;
+}
+
+int trend_db_read_minutes(int32_t patient_id, uint32_t start_ts,
+                          uint32_t end_ts, trend_minute_row_t *rows,
+                          int max_rows) {
+    pthread_mutex_t *lock = query_lock();
+    pthread_mutex_lock(lock);
+    if (!db || !stmt_read_minutes || !rows || max_rows < 1) {
+        pthread_mutex_unlock(lock);
+        return 0;
+    }
+
+    sqlite3_reset(stmt_read_minutes);
+    sqlite3_bind_int(stmt_read_minutes, 1, (int)patient_id);
+    sqlite3_bind_int(stmt_read_minutes, 2, (int)start_ts);
+    sqlite3_bind_int(stmt_read_minutes, 3, (int)end_ts);
+    sqlite3_bind_int(stmt_read_minutes, 4, max_rows);
+
+    int n = 0, rc = SQLITE_DONE;
+    while (n < max_rows && (rc = sqlite3_step(stmt_read_minutes)) == SQLITE_ROW) {
+        trend_minute_row_t *r = &rows[n++];
+        r->minute_ts = (uint32_t)sqlite3_column_int64(stmt_read_minutes, 0);
+        /* AGG_COLS order: avg, min, max per parameter */
+        for (int p = 0; p < TREND_PARAM_COUNT; p++) {
+            r->avg[p] = sqlite3_column_int(stmt_read_minutes, 3 * p + 1);
+            r->min[p] = sqlite3_column_int(stmt_read_minutes, 3 * p + 2);
+            r->max[p] = sqlite3_column_int(stmt_read_minutes, 3 * p + 3);
+        }
+    }
+    /* Resetting ends the statement's read snapshot */
+    sqlite3_reset(stmt_read_minutes);
+    pthread_mutex_unlock(lock);
+    return read_ok(rc, "read_minutes") ? n : -1;
 }
 
-int trend_db_query_nibp(uint32_t start_ts, uint32_t end_ts,
-                         trend_nibp_result_t *result) {
-    if (!db || !stmt_query_nibp || !result) return 0;
+void trend_db_interrupt_scans(void) {
+    /* Never the shared reader or the write connection */
+    pthread_mutex_lock(&interrupt_lock);
+    if (db_scan) sqlite3_interrupt(db_scan);
+    pthread_mutex_unlock(&interrupt_lock);
+}
+
+static int query_nibp_locked(sqlite3_stmt *st, int32_t patient_id,
+                             uint32_t start_ts, uint32_t end_ts,
+                             trend_nibp_result_t *result) {
+    if (!db || !st || !result) return 0;
     result->count = 0;
 
-    sqlite3_reset(stmt_query_nibp);
-    sqlite3_bind_int(stmt_query_nibp, 1, (int)start_ts);
-    sqlite3_bind_int(stmt_query_nibp, 2, (int)end_ts);
-    sqlite3_bind_int(stmt_query_nibp, 3, TREND_DB_MAX_POINTS);
-
-    int i = 0;
-    while (sqlite3_step(stmt_query_nibp) == SQLITE_ROW && i < TREND_DB_MAX_POINTS) {
-        result->timestamp_s[i] = (uint32_t)sqlite3_column_int(stmt_query_nibp, 0);
-        result->sys[i]         = sqlite3_column_int(stmt_query_nibp, 1);
-        result->dia[i]         = sqlite3_column_int(stmt_query_nibp, 2);
-        result->map_val[i]     = sqlite3_column_int(stmt_query_nibp, 3);
+    sqlite3_reset(st);
+    sqlite3_bind_int(st, 1, (int)patient_id);
+    sqlite3_bind_int(st, 2, (int)start_ts);
+    sqlite3_bind_int(st, 3, (int)end_ts);
+    sqlite3_bind_int(st, 4, TREND_DB_MAX_POINTS);
+
+    int i = 0, rc = SQLITE_DONE;
+    while (i < TREND_DB_MAX_POINTS && (rc = sqlite3_step(st)) == SQLITE_ROW) {
+        result->timestamp_s[i] = (uint32_t)sqlite3_column_int(st, 0);
+        result->sys[i]         = sqlite3_column_int(st, 1);
+        result->dia[i]         = sqlite3_column_int(st, 2);
+        result->map_val[i]     = sqlite3_column_int(st, 3);
         i++;
     }
+    sqlite3_reset(st);      /* Release the read snapshot */
+    if (!read_ok(rc, "query_nibp")) return -1;
     result->count = i;
     return i;
 }
 
-int trend_db_query_alarms(uint32_t start_ts, uint32_t end_ts,
-                           trend_alarm_result_t *result) {
-    if (!db || !stmt_query_alarm || !result) return 0;
-    result->count = 0;
+int trend_db_query_nibp(int32_t patient_id, uint32_t start_ts,
+                         uint32_t end_ts, trend_nibp_result_t *result) {
+    pthread_mutex_t *lock = query_lock();
+    pthread_mutex_lock(lock);
+    int n = query_nibp_locked(stmt_query_nibp, patient_id, start_ts, end_ts,
+                              result);
+    pthread_mutex_unlock(lock);
+    return n;
+}
 
-    sqlite3_reset(stmt_query_alarm);
-    sqlite3_bind_int(stmt_query_alarm, 1, (int)start_ts);
-    sqlite3_bind_int(stmt_query_alarm, 2, (int)end_ts);
-    sqlite3_bind_int(stmt_query_alarm, 3, TREND_DB_MAX_POINTS);
-
-    int i = 0;
-    while (sqlite3_step(stmt_query_alarm) == SQLITE_ROW && i < TREND_DB_MAX_POINTS) {
-        result->timestamp_s[i] = (uint32_t)sqlite3_column_int(stmt_query_alarm, 0);
-        result->severity[i]    = sqlite3_column_int(stmt_query_alarm, 1);
-        const char *msg = (const char *)sqlite3_column_text(stmt_query_alarm, 2);
-        if (msg) {
-            strncpy(result->message[i], msg, 47);
-            result->message[i][47] = '\0';
-        } else {
-            result->message[i][0] = '\0';
-        }
+int trend_db_scan_nibp(int32_t patient_id, uint32_t start_ts,
+                       uint32_t end_ts, trend_nibp_result_t *result) {
+    pthread_mutex_t *lock = scan_lock_of();
+    pthread_mutex_lock(lock);
+    int n = query_nibp_locked(db_scan ? stmt_scan_nibp : stmt_query_nibp,
+                              patient_id, start_ts, end_ts, result);
+    pthread_mutex_unlock(lock);
+    return n;
+}
+
+/** `st`: the statement matching the filter (stmt_query_alarm[by]). */
+static int query_alarms_locked(sqlite3_stmt *st, int32_t patient_id,
+                               uint32_t start_ts, uint32_t end_ts,
+                               const trend_alarm_filter_t *f,
+                               trend_alarm_result_t *result) {
+    if (!result) return 0;
+    result->count = 0;
+    if (!db || !st) return 0;
+
+    int by = 0;
+    if (f && f->param >= 0) by |= 1;
+    if (f && f->severity >= 0) by |= 2;
+
+    sqlite3_reset(st);
+    sqlite3_bind_int(st, 1, (int)patient_id);
+    sqlite3_bind_int(st, 2, (int)start_ts);
+    sqlite3_bind_int(st, 3, (int)end_ts);
+    sqlite3_bind_int(st, 4, TREND_DB_MAX_POINTS);
+    if (by & 1) sqlite3_bind_int(st, 5, f->param);
+    if (by & 2) sqlite3_bind_int(st, 6, f->severity);
+
+    int i = 0, rc = SQLITE_DONE;
+    while (i < TREND_DB_MAX_POINTS && (rc = sqlite3_step(st)) == SQLITE_ROW) {
+        result->timestamp_s[i] = (uint32_t)sqlite3_column_int64(st, 0);
+        result->param[i]       = (uint8_t)sqlite3_column_int(st, 1);
+        result->severity[i]    = (uint8_t)sqlite3_column_int(st, 2);
+        result->kind[i]        = (uint8_t)sqlite3_column_int(st, 3);
+        result->value[i]       = (int16_t)sqlite3_column_int(st, 4);
+        result->threshold[i]   = (int16_t)sqlite3_column_int(st, 5);
+        result->user_id[i]     = sqlite3_column_int(st, 6);
+        result->duration_s[i]  = (uint32_t)sqlite3_column_int64(st, 7);
+        result->has_reading[i] = (uint8_t)sqlite3_column_int(st, 8);
         i++;
     }
+    sqlite3_reset(st);      /* Release the read snapshot */
+    if (!read_ok(rc, "query_alarms")) return -1;
     result->count = i;
     return i;
 }
 
+int trend_db_query_alarms(int32_t patient_id, uint32_t start_ts,
+                           uint32_t end_ts, trend_alarm_result_t *result) {
+    return trend_db_query_alarms_filtered(patient_id, start_ts, end_ts,
+                                          NULL, result);
+}
+
+int trend_db_query_alarms_filtered(int32_t patient_id, uint32_t start_ts,
+                                   uint32_t end_ts,
+                                   const trend_alarm_filter_t *filter,
+                                   trend_alarm_result_t *result) {
+    int by = 0;
+    if (filter && filter->param >= 0) by |= 1;
+    if (filter && filter->severity >= 0) by |= 2;
+
+    pthread_mutex_t *lock = query_lock();
+    pthread_mutex_lock(lock);
+    int n = query_alarms_locked(stmt_query_alarm[by], patient_id, start_ts,
+                                end_ts, filter, result);
+    pthread_mutex_unlock(lock);
+    return n;
+}
+
+int trend_db_scan_alarms(int32_t patient_id, uint32_t start_ts,
+                         uint32_t end_ts, trend_alarm_result_t *result) {
+    pthread_mutex_t *lock = scan_lock_of();
+    pthread_mutex_lock(lock);
+    int n = query_alarms_locked(db_scan ? stmt_scan_alarm : stmt_query_alarm[0],
+                                patient_id, start_ts, end_ts, NULL, result);
+    pthread_mutex_unlock(lock);
+    return n;
+}
+
+void trend_db_alarm_event(const trend_alarm_result_t *result, int i,
+                          alarm_event_t *out) {
+    memset(out, 0, sizeof(*out));
+    if (!result || i < 0 || i >= result->count) return;
+    out->time_s     = result->timestamp_s[i];
+    out->param      = (alarm_param_t)result->param[i];
+    out->severity   = (alarm_severity_t)result->severity[i];
+    out->kind       = (alarm_event_kind_t)result->kind[i];
+    out->value      = result->value[i];
+    out->threshold  = result->threshold[i];
+    out->user_id    = result->user_id[i];
+    out->duration_s = result->duration_s[i];
+    out->has_reading = result->has_reading[i] != 0;
+}
+
+int trend_db_query_alarm_page(int32_t patient_id,
+                              const trend_alarm_cursor_t *before,
+                              int max_rows, alarm_event_t *events,
+                              trend_alarm_cursor_t *cursors) {
+    if (!before || !events || !cursors || max_rows <= 0) return 0;
+
+    pthread_mutex_t *lock = query_lock();
+    pthread_mutex_lock(lock);
+    sqlite3_stmt *st = stmt_alarm_page;
+    if (!db || !st) {
+        pthread_mutex_unlock(lock);
+        return 0;
+    }
+    sqlite3_reset(st);
+    sqlite3_bind_int(st, 1, (int)patient_id);
+    sqlite3_bind_int64(st, 2, (int64_t)before->timestamp_s);
+    sqlite3_bind_int64(st, 3, before->id);
+    sqlite3_bind_int(st, 4, max_rows);
+
+    int n = 0, rc = SQLITE_DONE;
+    while (n < max_rows && (rc = sqlite3_step(st)) == SQLITE_ROW) {
+        alarm_event_t *e = &events[n];
+        cursors[n].id          = sqlite3_column_int64(st, 0);
+        cursors[n].timestamp_s = (uint32_t)sqlite3_column_int64(st, 1);
+        e->time_s     = cursors[n].timestamp_s;
+        e->param      = (alarm_param_t)sqlite3_column_int(st, 2);
+        e->severity   = (alarm_severity_t)sqlite3_column_int(st, 3);
+        e->kind       = (alarm_event_kind_t)sqlite3_column_int(st, 4);
+        e->value      = sqlite3_column_int(st, 5);
+        e->threshold  = sqlite3_column_int(st, 6);
+        e->user_id    = sqlite3_column_int(st, 7);
+        e->duration_s = (uint32_t)sqlite3_column_int64(st, 8);
+        e->has_reading = sqlite3_column_int(st, 9) != 0;
+        n++;
+    }
+    sqlite3_reset(st);      /* Release the read snapshot */
+    pthread_mutex_unlock(lock);
+    return read_ok(rc, "alarm_page") ? n : -1;
+}
+
+/* ── Segment transfer ────────────────────────────────────── */
+
+/* Rows of each section, in the order they are written */
+static const char *EXPORT_RAW_SQL =
+    "SELECT minute_ts, hr, spo2, rr, temp_x10 FROM vitals_raw_min "
+    "WHERE patient_id = ?1 ORDER BY minute_ts";
+
+typedef struct {
+    uint8_t     id;
+    int         cols;           /* Integer columns */
+    const char *sql;
+} export_section_t;
+
+static const export_section_t EXPORT_SECTIONS[] = {
+    { TREND_SEG_1MIN, 13,
+      "SELECT minute_ts, " AGG_COLS " FROM vitals_1min "
+      "WHERE patient_id = ?1 ORDER BY minute_ts" },
+    { TREND_SEG_1HOUR, 13,
+      "SELECT hour_ts, " AGG_COLS " FROM vitals_1hour "
+      "WHERE patient_id = ?1 ORDER BY hour_ts" },
+    { TREND_SEG_NIBP, 4,
+      "SELECT timestamp_s, sys, dia, map_val FROM nibp_measurements "
+      "WHERE patient_id = ?1 ORDER BY timestamp_s" },
+    { TREND_SEG_ALARM_EVT, 9,
+      "SELECT timestamp_s, " ALARM_COLS " FROM alarm_events "
+      "WHERE patient_id = ?1 ORDER BY timestamp_s, id" },
+};
+
+#define EXPORT_SECTION_COUNT \
+    (int)(sizeof(EXPORT_SECTIONS) / sizeof(EXPORT_SECTIONS[0]))
+
+/** First and last timestamp written to a segment. */
+typedef struct {
+    uint32_t first;
+    uint32_t last;
+} ts_span_t;
+
+static void span_add(ts_span_t *span, uint32_t ts) {
+    if (ts < span->first) span->first = ts;
+    if (ts > span->last) span->last = ts;
+}
+
+static void export_raw_minute(trend_seg_writer_t *w, uint32_t key,
+                              const int16_t v[TREND_RAW_CHANNELS][TREND_RAW_SAMPLES]) {
+    int64_t row[1] = { key };
+    trend_seg_put_row(w, row);
+    for (int c = 0; c < TREND_RAW_CHANNELS; c++) {
+        trend_seg_put_series(w, v[c], TREND_RAW_SAMPLES);
+    }
+}
+
+/**
+ * Raw section: stored minutes decoded to samples, with `pending` (the
+ * unflushed minute) in place of any stored row with the same key.
+ */
+static bool export_raw(sqlite3 *conn, trend_seg_writer_t *w,
+                       int32_t partition, const trend_raw_minute_t *pending,
+                       ts_span_t *span) {
+    sqlite3_stmt *st = NULL;
+    if (!prepare_on(conn, &st, EXPORT_RAW_SQL)) return false;
+    sqlite3_bind_int(st, 1, (int)partition);
+
+    bool have_pending = pending->active && pending->count > 0;
+    int16_t v[TREND_RAW_CHANNELS][TREND_RAW_SAMPLES];
+    trend_seg_begin_section(w, TREND_SEG_RAW, 1);
+
+    int rc;
+    while ((rc = sqlite3_step(st)) == SQLITE_ROW) {
+        uint32_t key = (uint32_t)sqlite3_column_int64(st, 0);
+        if (have_pending && key == pending->minute_ts) continue;
+        for (int c = 0; c < TREND_RAW_CHANNELS; c++) {
+            trend_raw_decode(sqlite3_column_blob(st, c + 1),
+                             sqlite3_column_bytes(st, c + 1), v[c]);
+        }
+        export_raw_minute(w, key, (const int16_t (*)[TREND_RAW_SAMPLES])v);
+        span_add(span, key - (TREND_RAW_SAMPLES - 1));
+        span_add(span, key);
+    }
+    sqlite3_finalize(st);
+
+    if (have_pending) {
+        export_raw_minute(w, pending->minute_ts, pending->v);
+        span_add(span, pending->minute_ts);
+    }
+    return rc == SQLITE_DONE;
+}
+
+static bool export_section(sqlite3 *conn, trend_seg_writer_t *w,
+                           int32_t partition, const export_section_t *es,
+                           ts_span_t *span) {
+    sqlite3_stmt *st = NULL;
+    if (!prepare_on(conn, &st, es->sql)) return false;
+    sqlite3_bind_int(st, 1, (int)partition);
+
+    int64_t row[TREND_SEG_MAX_COLS];
+    trend_seg_begin_section(w, es->id, es->cols);
+
+    int rc;
+    while ((rc = sqlite3_step(st)) == SQLITE_ROW) {
+        for (int c = 0; c < es->cols; c++) {
+            row[c] = sqlite3_column_int64(st, c);
+        }
+        trend_seg_put_row(w, row);
+        span_add(span, (uint32_t)row[0]);
+    }
+    sqlite3_finalize(st);
+    return rc == SQLITE_DONE;
+}
+
+size_t trend_db_export_patient(int32_t patient_id, uint8_t *buf, size_t cap) {
+    /* The minute still being filled travels with the stored ones */
+    trend_raw_minute_t pending;
+    pending.active = false;
+    pthread_mutex_lock(&db_lock);
+    if (!db) {
+        pthread_mutex_unlock(&db_lock);
+        return 0;
+    }
+    for (int s = 0; s < TREND_DB_SLOTS; s++) {
+        if (slot_partition[s] == patient_id) pending = raw_cur[s];
+    }
+    pthread_mutex_unlock(&db_lock);
+
+    trend_seg_writer_t w;
+    trend_seg_writer_init(&w, buf, cap);
+    ts_span_t span = { UINT32_MAX, 0 };
+
+    pthread_mutex_t *lock = query_lock();
+    pthread_mutex_lock(lock);
+    sqlite3 *conn = query_conn();
+    if (!conn) {                            /* Closed meanwhile */
+        pthread_mutex_unlock(lock);
+        return 0;
+    }
+
+    /* One read transaction, so every section comes from the same snapshot */
+    sqlite3_exec(conn, "BEGIN;", NULL, NULL, NULL);
+    bool ok = export_raw(conn, &w, patient_id, &pending, &span);
+    for (int i = 0; ok && i < EXPORT_SECTION_COUNT; i++) {
+        ok = export_section(conn, &w, patient_id, &EXPORT_SECTIONS[i], &span);
+    }
+    sqlite3_exec(conn, "COMMIT;", NULL, NULL, NULL);
+    pthread_mutex_unlock(lock);
+
+    if (span.first > span.last) span.first = span.last = 0;
+    size_t len = ok ? trend_seg_finish(&w, patient_id, span.first, span.last)
+                    : 0;
+    if (len == 0) {
+        fprintf(stderr, "[trend_db] Export of partition %d failed%s\n",
+                (int)patient_id, w.overflow ? " (buffer too small)" : "");
+        return 0;
+    }
+    printf("[trend_db] Exported partition %d: %zu bytes\n",
+           (int)patient_id, len);
+    return len;
+}
+
+/** Bulk-load one known section through the insert statements. */
+static bool import_section_locked(trend_seg_reader_t *r, uint8_t id,
+                                  int cols, int32_t partition) {
+    int64_t row[TREND_SEG_MAX_COLS];
+    sqlite3_stmt *st;
+    int want;
+
+    switch (id) {
+        case TREND_SEG_RAW:   st = stmt_insert_raw;   want = 1;  break;
+        case TREND_SEG_1MIN:  st = stmt_insert_1min;  want = 13; break;
+        case TREND_SEG_1HOUR: st = stmt_insert_1hour; want = 13; break;
+        case TREND_SEG_NIBP:  st = stmt_insert_nibp;  want = 4;  break;
+        case TREND_SEG_ALARM: st = stmt_insert_alarm_text; want = 2; break;
+        case TREND_SEG_ALARM_EVT: st = stmt_insert_alarm; want = 9; break;
+        default:              return true;    /* Newer section: skipped */
+    }
+    /* Alarm events from before has_reading: derived from the reading */
+    bool flagless = id == TREND_SEG_ALARM_EVT && cols == want - 1;
+    if (!st || (cols != want && !flagless)) return false;
+
+    while (trend_seg_get_row(r, row)) {
+        sqlite3_reset(st);
+        sqlite3_bind_int(st, 1, (int)partition);
+        for (int c = 0; c < cols; c++) {
+            sqlite3_bind_int64(st, c + 2, row[c]);
+        }
+        if (flagless) sqlite3_bind_int(st, 10, row[4] != 0 && row[5] != 0);
+
+        if (id == TREND_SEG_RAW) {
+            int16_t v[TREND_RAW_SAMPLES];
+            uint8_t blob[TREND_RAW_BLOB_BYTES];
+            for (int c = 0; c < TREND_RAW_CHANNELS; c++) {
+                if (!trend_seg_get_series(r, v, TREND_RAW_SAMPLES)) return false;
+                trend_raw_encode(v, blob);
+                sqlite3_bind_blob(st, c + 3, blob, TREND_RAW_BLOB_BYTES,
+                                  SQLITE_TRANSIENT);
+            }
+        } else if (id == TREND_SEG_ALARM) {
+            const uint8_t *text;
+            size_t n = trend_seg_get_bytes(r, &text);
+            if (r->error) return false;
+            sqlite3_bind_text(st, 4, n ? (const char *)text : "", (int)n,
+                              SQLITE_TRANSIENT);
+        }
+        if (sqlite3_step(st) != SQLITE_DONE) return false;
+    }
+    return !r->error;
+}
+
+bool trend_db_import_patient(int32_t patient_id, const uint8_t *buf,
+                             size_t len) {
+    trend_seg_reader_t r;
+    trend_seg_header_t hdr;
+    if (patient_id <= 0) return false;
+    if (!trend_seg_reader_init(&r, buf, len, &hdr)) {
+        fprintf(stderr, "[trend_db] Import rejected: invalid segment\n");
+        return false;
+    }
+
+    pthread_mutex_lock(&db_lock);
+    if (!db || !stmt_part_bind) {
+        pthread_mutex_unlock(&db_lock);
+        return false;
+    }
+    /* A slot already recording this patient must not clobber imported
+     * minutes later; its next sample reloads and merges instead */
+    for (int s = 0; s < TREND_DB_SLOTS; s++) {
+        if (slot_partition[s] == patient_id) raw_flush_locked(s);
+    }
+
+    bool ok = (sqlite3_exec(db, "BEGIN;", NULL, NULL, NULL) == SQLITE_OK);
+    uint8_t id;
+    int cols;
+    uint32_t rows;
+    while (ok && trend_seg_next_section(&r, &id, &cols, &rows)) {
+        ok = import_section_locked(&r, id, cols, patient_id);
+    }
+    ok = ok && !r.error;
+    if (ok) {
+        sqlite3_reset(stmt_part_bind);
+        sqlite3_bind_int(stmt_part_bind, 1, (int)patient_id);
+        ok = (sqlite3_step(stmt_part_bind) == SQLITE_DONE);
+    }
+    sqlite3_exec(db, ok ? "COMMIT;" : "ROLLBACK;", NULL, NULL, NULL);
+    pthread_mutex_unlock(&db_lock);
+
+    if (ok) trend_cache_invalidate_range(hdr.first_ts, UINT32_MAX);
+
+    printf("[trend_db] Imported segment of patient %d into partition %d%s\n",
+           (int)hdr.patient_id, (int)patient_id, ok ? "" : " (failed)");
+    return ok;
+}
+
 /* ── Maintenance ─────────────────────────────────────────── */
 
+/**
+ * Run one chunked purge statement over a partition to completion,
+ * releasing db_lock between chunks.  Returns total rows deleted.
+ */
+static int purge_chunked(sqlite3_stmt **stmt, int32_t partition,
+                         uint32_t cutoff) {
+    int total = 0;
+    for (;;) {
+        pthread_mutex_lock(&db_lock);
+        if (!db || !*stmt) {
+            pthread_mutex_unlock(&db_lock);
+            break;
+        }
+        sqlite3_reset(*stmt);
+        sqlite3_bind_int(*stmt, 1, (int)partition);
+        sqlite3_bind_int(*stmt, 2, (int)cutoff);
+        sqlite3_bind_int(*stmt, 3, PURGE_CHUNK_ROWS);
+        int rc = sqlite3_step(*stmt);
+        int deleted = (rc == SQLITE_DONE) ? sqlite3_changes(db) : 0;
+        pthread_mutex_unlock(&db_lock);
+
+        total += deleted;
+        if (deleted < PURGE_CHUNK_ROWS) break;
+    }
+    return total;
+}
+
+/**
+ * Next partition after `after` in the catalogue.  Drops the catalogue
+ * entry of an archived partition once retention has emptied it.
+ */
+static bool next_partition(int32_t after, int32_t *out, bool *archived) {
+    pthread_mutex_lock(&db_lock);
+    bool found = false;
+    if (db && stmt_part_next) {
+        sqlite3_reset(stmt_part_next);
+        sqlite3_bind_int(stmt_part_next, 1, (int)after);
+        if (sqlite3_step(stmt_part_next) == SQLITE_ROW) {
+            *out = (int32_t)sqlite3_column_int(stmt_part_next, 0);
+            *archived = sqlite3_column_int(stmt_part_next, 1) != 0;
+            found = true;
+        }
+        sqlite3_reset(stmt_part_next);
+    }
+    pthread_mutex_unlock(&db_lock);
+    return found;
+}
+
+static void forget_if_empty(int32_t partition) {
+    pthread_mutex_lock(&db_lock);
+    if (db && stmt_part_has_data && stmt_part_remove) {
+        sqlite3_reset(stmt_part_has_data);
+        sqlite3_bind_int(stmt_part_has_data, 1, (int)partition);
+        bool has_data = sqlite3_step(stmt_part_has_data) == SQLITE_ROW &&
+                        sqlite3_column_int(stmt_part_has_data, 0) != 0;
+        sqlite3_reset(stmt_part_has_data);
+        if (!has_data) {
+            sqlite3_reset(stmt_part_remove);
+            sqlite3_bind_int(stmt_part_remove, 1, (int)partition);
+            sqlite3_step(stmt_part_remove);
+        }
+    }
+    pthread_mutex_unlock(&db_lock);
+}
+
+/** Delete rows older than the cutoffs from every partition. */
+static void purge_before(uint32_t raw_cutoff, uint32_t agg_cutoff) {
+    /* Partition by partition: each delete is a range on (patient, ts) */
+    int32_t part = INT32_MIN;
+    bool archived = false;
+    while (next_partition(part, &part, &archived)) {
+        purge_chunked(&stmt_purge_raw,   part, raw_cutoff);
+        purge_chunked(&stmt_purge_1min,  part, agg_cutoff);
+        purge_chunked(&stmt_purge_1hour, part, agg_cutoff);
+        purge_chunked(&stmt_purge_nibp,  part, agg_cutoff);
+        purge_chunked(&stmt_purge_alarm, part, agg_cutoff);
+        if (archived) forget_if_empty(part);
+    }
+}
+
 void trend_db_purge_old(uint32_t current_ts) {
     if (!db) return;
 
     uint32_t raw_cutoff = (current_ts > RAW_RETAIN_S) ? current_ts - RAW_RETAIN_S : 0;
     uint32_t agg_cutoff = (current_ts > AGG_RETAIN_S) ? current_ts - AGG_RETAIN_S : 0;
 
-    sqlite3_reset(stmt_purge_raw);
-    sqlite3_bind_int(stmt_purge_raw, 1, (int)raw_cutoff);
-    sqlite3_step(stmt_purge_raw);
+    purge_before(raw_cutoff, agg_cutoff);
+
+    /*
+     * Raw-tier views span at most 2 h and never reach raw_cutoff with a
+     * current end time, so only views reaching agg_cutoff are affected.
+     */
+    trend_cache_invalidate_range(0, agg_cutoff);
+}
+
+/* ── Storage ─────────────────────────────────────────────── */
+
+bool trend_db_get_storage(trend_db_storage_t *out) {
+    memset(out, 0, sizeof(*out));
+    pthread_mutex_lock(&db_lock);
+    if (!db) {
+        pthread_mutex_unlock(&db_lock);
+        return false;
+    }
+    int page_size = pragma_int(db, "PRAGMA page_size;");
+    int pages     = pragma_int(db, "PRAGMA page_count;");
+    int free_pg   = pragma_int(db, "PRAGMA freelist_count;");
+    const char *file = sqlite3_db_filename(db, "main");
+    char wal[256] = "";
+    if (file && file[0]) snprintf(wal, sizeof(wal), "%s-wal", file);
+    pthread_mutex_unlock(&db_lock);
+
+    out->page_size      = (page_size > 0) ? (uint32_t)page_size : 0;
+    out->page_count     = (pages > 0) ? (uint32_t)pages : 0;
+    out->freelist_count = (free_pg > 0) ? (uint32_t)free_pg : 0;
+    out->used_bytes = (uint64_t)(out->page_count - out->freelist_count) *
+                      out->page_size;
+
+    struct stat st;
+    if (wal[0] && stat(wal, &st) == 0) out->wal_bytes = (uint64_t)st.st_size;
+    return true;
+}
+
+int trend_db_vacuum_step(int max_pages) {
+    char sql[48];
+    snprintf(sql, sizeof(sql), "PRAGMA incremental_vacuum(%d);", max_pages);
+
+    pthread_mutex_lock(&db_lock);
+    if (!db) {
+        pthread_mutex_unlock(&db_lock);
+        return -1;
+    }
+    int before = pragma_int(db, "PRAGMA freelist_count;");
+    int rc = sqlite3_exec(db, sql, NULL, NULL, NULL);
+    int after = pragma_int(db, "PRAGMA freelist_count;");
+    pthread_mutex_unlock(&db_lock);
+
+    if (rc != SQLITE_OK || before < 0 || after < 0) return -1;
+    return before - after;
+}
+
+void trend_db_set_size_cap(uint64_t bytes) {
+    size_cap = bytes ? bytes : TREND_DB_SIZE_CAP_BYTES;
+}
+
+/** Oldest 1-minute row over all partitions; false if there is none. */
+static bool oldest_minute(uint32_t *out) {
+    bool found = false;
+    int32_t part = INT32_MIN;
+    bool archived = false;
+    while (next_partition(part, &part, &archived)) {
+        pthread_mutex_lock(&db_lock);
+        if (db && stmt_part_oldest) {
+            sqlite3_reset(stmt_part_oldest);
+            sqlite3_bind_int(stmt_part_oldest, 1, (int)part);
+            if (sqlite3_step(stmt_part_oldest) == SQLITE_ROW &&
+                sqlite3_column_type(stmt_part_oldest, 0) != SQLITE_NULL) {
+                uint32_t ts = (uint32_t)sqlite3_column_int64(stmt_part_oldest, 0);
+                if (!found || ts < *out) *out = ts;
+                found = true;
+            }
+            sqlite3_reset(stmt_part_oldest);
+        }
+        pthread_mutex_unlock(&db_lock);
+    }
+    return found;
+}
+
+/**
+ * Purge the oldest history an hour at a time until live data is back
+ * under the low-water mark, stopping at TREND_DB_MIN_RETAIN_S.
+ */
+static void enforce_size_cap(uint32_t current_ts) {
+    uint64_t low_water = size_cap / 100 * CAP_LOW_WATER_PCT;
+    uint32_t floor_ts = (current_ts > TREND_DB_MIN_RETAIN_S)
+                        ? current_ts - TREND_DB_MIN_RETAIN_S : 0;
+    trend_db_storage_t st;
+
+    if (!trend_db_get_storage(&st) || st.used_bytes <= size_cap) return;
+
+    uint32_t cutoff = 0;
+    while (st.used_bytes > low_water) {
+        uint32_t oldest;
+        if (!oldest_minute(&oldest) || oldest >= floor_ts) {
+            fprintf(stderr, "[trend_db] Size cap: %llu KB live with only "
+                    "minimum retention left\n",
+                    (unsigned long long)(st.used_bytes / 1024));
+            break;
+        }
+        cutoff = oldest - (oldest % EARLY_PURGE_STEP_S) + EARLY_PURGE_STEP_S;
+        if (cutoff > floor_ts) cutoff = floor_ts;
+        purge_before(cutoff, cutoff);
+        if (!trend_db_get_storage(&st)) break;
+    }
+
+    if (cutoff > 0) {
+        trend_cache_invalidate_range(0, cutoff);
+        printf("[trend_db] Size cap: purged history before %u early\n",
+               (unsigned)cutoff);
+    }
+}
+
+void trend_db_maintain(uint32_t current_ts) {
+    if (!db) return;
+
+    trend_db_purge_old(current_ts);
+    enforce_size_cap(current_ts);
+
+    /* Hand free pages back a chunk at a time; inserts slot in between */
+    int freed = 0;
+    while (freed < VACUUM_MAX_PAGES) {
+        int n = trend_db_vacuum_step(VACUUM_CHUNK_PAGES);
+        if (n <= 0) break;
+        freed += n;
+    }
+
+    /* Copy the vacuumed pages back so the file itself shrinks */
+    if (freed > 0) {
+        pthread_mutex_lock(&db_lock);
+        if (db) {
+            sqlite3_wal_checkpoint_v2(db, NULL, SQLITE_CHECKPOINT_PASSIVE,
+                                      NULL, NULL);
+        }
+        pthread_mutex_unlock(&db_lock);
+    }
+
+    trend_db_storage_t st;
+    if (trend_db_get_storage(&st)) {
+        printf("[trend_db] Storage: %u pages (%u free), %llu KB live, "
+               "WAL %llu KB, %d pages vacuumed\n",
+               (unsigned)st.page_count, (unsigned)st.freelist_count,
+               (unsigned long long)(st.used_bytes / 1024),
+               (unsigned long long)(st.wal_bytes / 1024), freed);
+    }
+}
+
+/* ── Crash recovery ──────────────────────────────────────── */
 
-    sqlite3_reset(stmt_purge_1min);
-    sqlite3_bind_int(stmt_purge_1min, 1, (int)agg_cutoff);
-    sqlite3_step(stmt_purge_1min);
+bool trend_db_get_pending(uint8_t slot, trend_db_pending_t *out) {
+    if (slot >= TREND_DB_SLOTS) return false;
+    pthread_mutex_lock(&db_lock);
+    out->partition = slot_partition[slot];
+    out->minute = raw_cur[slot];
+    pthread_mutex_unlock(&db_lock);
+    return true;
+}
+
+bool trend_db_restore_pending(const trend_db_pending_t *p) {
+    if (!p->minute.active || p->minute.count == 0) return false;
+    uint32_t key = p->minute.minute_ts;
+
+    pthread_mutex_lock(&db_lock);
+    if (!db || !stmt_insert_1min) {
+        pthread_mutex_unlock(&db_lock);
+        return false;
+    }
+
+    /* Samples already in the buffer or on disk fill the saved gaps */
+    trend_raw_minute_t merged = p->minute;
+    trend_raw_minute_t stored;
+    for (int s = 0; s < TREND_DB_SLOTS; s++) {
+        if (raw_cur[s].active && raw_cur[s].minute_ts == key &&
+            slot_partition[s] == p->partition) {
+            raw_flush_locked(s);
+        }
+    }
+    if (raw_load_locked(p->partition, key, &stored)) {
+        merged.count = 0;
+        for (int i = 0; i < TREND_RAW_SAMPLES; i++) {
+            if (merged.v[0][i] == TREND_RAW_MISSING) {
+                for (int c = 0; c < TREND_RAW_CHANNELS; c++) {
+                    merged.v[c][i] = stored.v[c][i];
+                }
+            }
+            if (merged.v[0][i] != TREND_RAW_MISSING) merged.count++;
+        }
+    }
+    raw_write_locked(p->partition, &merged);
+    aggregate_partition_locked(p->partition, key);
+    pthread_mutex_unlock(&db_lock);
 
-    sqlite3_reset(stmt_purge_nibp);
-    sqlite3_bind_int(stmt_purge_nibp, 1, (int)agg_cutoff);
-    sqlite3_step(stmt_purge_nibp);
+    trend_cache_invalidate_range(key - 59, UINT32_MAX);
+    return true;
+}
 
-    sqlite3_reset(stmt_purge_alarm);
-    sqlite3_bind_int(stmt_purge_alarm, 1, (int)agg_cutoff);
-    sqlite3_step(stmt_purge_alarm);
+int64_t trend_db_checkpoint(bool truncate) {
+    pthread_mutex_lock(&db_lock);
+    if (!db) {
+        pthread_mutex_unlock(&db_lock);
+        return -1;
+    }
+    sqlite3_wal_checkpoint_v2(db, NULL,
+                              truncate ? SQLITE_CHECKPOINT_TRUNCATE
+                                       : SQLITE_CHECKPOINT_PASSIVE,
+                              NULL, NULL);
+    pthread_mutex_unlock(&db_lock);
+
+    trend_db_storage_t st;
+    if (!trend_db_get_storage(&st)) return -1;
+    return (int64_t)st.wal_bytes;
 }
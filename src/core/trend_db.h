@@ -2,11 +2,34 @@
  * @file trend_db.h
  * @brief SQLite-backed trend storage for 72-hour vital sign history
  *
- * Two-tier storage:
- *   - vitals_raw: 1-second resolution, retained 4 hours (short-range queries)
+ * Tiered storage:
+ *   - vitals_raw_min: 1-second samples packed one row per minute, retained
+ *     4 hours (short-range queries; decoded transparently)
  *   - vitals_1min: 1-minute aggregates, retained 72 hours (long-range queries)
+ *   - vitals_1hour: 1-hour rollups, retained 72 hours (coarse previews)
  *   - nibp_measurements: discrete NIBP events
- *   - alarm_events: alarm timeline markers
+ *   - alarm_events: structured alarm transitions (parameter, severity,
+ *     kind, value, limit, operator, duration); text is rendered on
+ *     display with alarm_engine_format_event(), never stored
+ *
+ * Partitioning: every table is keyed by (patient_id, timestamp), so each
+ * patient's history is a contiguous key range.  Writes name a monitor
+ * slot and land in the partition bound to it with trend_db_bind_slot();
+ * an unbound slot writes to its anonymous partition
+ * TREND_DB_ANON_PATIENT(slot).  Queries name the partition to read.
+ * Discharge either archives a partition (kept until retention expires)
+ * or drops it outright.  On a bed transfer a partition is exported as a
+ * binary segment and imported on the receiving monitor.
+ *
+ * Storage: the database uses incremental auto_vacuum.  Periodic
+ * maintenance (trend_db_maintain) purges expired rows, purges the oldest
+ * history early when the live data outgrows the size cap, and returns
+ * free pages to the filesystem a few at a time, so the file tracks the
+ * data it holds instead of its high-water mark.
+ *
+ * Thread safety: all functions may be called from the render thread, the
+ * data thread or a job_pool worker; access to the shared connection is serialised
+ * internally.  Result buffers are owned by the caller.
  */
 
 #ifndef TREND_DB_H
@@ -14,11 +37,33 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "theme_vitals.h"
+#include "trend_raw_pack.h"
+#include "alarm_engine.h"
 
 /* Maximum data points returned from a single query */
 #define TREND_DB_MAX_POINTS  480
 
+/* Monitor slots that can record at the same time (dual-patient mode) */
+#define TREND_DB_SLOTS       2
+
+/* Live data (file pages in use) above which the oldest history is purged
+ * early; change at run time with trend_db_set_size_cap() */
+#ifndef TREND_DB_SIZE_CAP_BYTES
+#define TREND_DB_SIZE_CAP_BYTES  (64u * 1024u * 1024u)
+#endif
+
+/* Raw 1-second samples are kept this long (seconds) */
+#define TREND_DB_RAW_RETAIN_S    (4 * 3600)
+
+/* History an early purge never removes, whatever the cap (seconds) */
+#define TREND_DB_MIN_RETAIN_S    (4 * 3600)
+
+/* Partition of a slot with no bound patient: 0 for slot 0, -1 for slot 1.
+ * Real patient ids are > 0, so the two never collide. */
+#define TREND_DB_ANON_PATIENT(slot)  (-(int32_t)(slot))
+
 /* ── Time range presets (seconds) ────────────────────────── */
 
 typedef enum {
@@ -40,16 +85,41 @@ typedef enum {
     TREND_PARAM_COUNT
 } trend_param_t;
 
+/* ── Storage tiers ───────────────────────────────────────── */
+
+typedef enum {
+    TREND_TIER_AUTO = 0,        /* raw for <=2h ranges, else 1min */
+    TREND_TIER_RAW,
+    TREND_TIER_1MIN,
+    TREND_TIER_1HOUR,
+} trend_tier_t;
+
+/* ── Downsampling modes ──────────────────────────────────── */
+
+typedef enum {
+    TREND_DS_AVG = 0,           /* GROUP BY bucket, AVG/MIN/MAX */
+    TREND_DS_LTTB,              /* Largest-triangle-three-buckets */
+} trend_downsample_t;
+
 /* ── Query result structures (static buffers, no malloc) ─── */
 
 typedef struct {
-    uint32_t timestamp_s[TREND_DB_MAX_POINTS];
-    int32_t  value[TREND_DB_MAX_POINTS];       /* avg values; temp stored as x10 */
+    uint32_t timestamp_s[TREND_DB_MAX_POINTS]; /* Bucket start (LTTB: sample time) */
+    int32_t  value[TREND_DB_MAX_POINTS];       /* avg (LTTB: sample); temp x10 */
     int32_t  value_min[TREND_DB_MAX_POINTS];
     int32_t  value_max[TREND_DB_MAX_POINTS];
+    uint32_t bucket_s;                         /* Seconds covered per point */
     int      count;
 } trend_query_result_t;
 
+/** One row of the 1-minute tier, all parameters (temp x10). */
+typedef struct {
+    uint32_t minute_ts;
+    int32_t  avg[TREND_PARAM_COUNT];
+    int32_t  min[TREND_PARAM_COUNT];
+    int32_t  max[TREND_PARAM_COUNT];
+} trend_minute_row_t;
+
 typedef struct {
     uint32_t timestamp_s[TREND_DB_MAX_POINTS];
     int      sys[TREND_DB_MAX_POINTS];
@@ -58,13 +128,36 @@ typedef struct {
     int      count;
 } trend_nibp_result_t;
 
+/** Alarm events, one alarm_event_t per index (see trend_db_alarm_event). */
 typedef struct {
     uint32_t timestamp_s[TREND_DB_MAX_POINTS];
-    int      severity[TREND_DB_MAX_POINTS];
-    char     message[TREND_DB_MAX_POINTS][48];
+    uint8_t  param[TREND_DB_MAX_POINTS];       /* alarm_param_t */
+    uint8_t  severity[TREND_DB_MAX_POINTS];    /* alarm_severity_t */
+    uint8_t  kind[TREND_DB_MAX_POINTS];        /* alarm_event_kind_t */
+    int16_t  value[TREND_DB_MAX_POINTS];       /* temp x10 */
+    int16_t  threshold[TREND_DB_MAX_POINTS];
+    int32_t  user_id[TREND_DB_MAX_POINTS];
+    uint32_t duration_s[TREND_DB_MAX_POINTS];
+    uint8_t  has_reading[TREND_DB_MAX_POINTS];  /* value/threshold known */
     int      count;
 } trend_alarm_result_t;
 
+/** Position of one alarm event in (timestamp, id) order, for paging. */
+typedef struct {
+    uint32_t timestamp_s;
+    int64_t  id;
+} trend_alarm_cursor_t;
+
+/* Before every event: start of a newest-first history */
+#define TREND_ALARM_CURSOR_NEWEST \
+    ((trend_alarm_cursor_t){ UINT32_MAX, INT64_MAX })
+
+/** Alarm event query filter; -1 in a field matches every value. */
+typedef struct {
+    int param;                  /* alarm_param_t */
+    int severity;               /* alarm_severity_t, exact */
+} trend_alarm_filter_t;
+
 /* ── Lifecycle ───────────────────────────────────────────── */
 
 /** Open (or create) the trend database. Pass NULL for in-memory DB. */
@@ -73,41 +166,255 @@ bool trend_db_init(const char *db_path);
 /** Close the database and finalize all prepared statements. */
 void trend_db_close(void);
 
+/* ── Partitions ──────────────────────────────────────────── */
+
+/**
+ * Route a slot's future writes to a patient's partition.  patient_id <= 0
+ * returns the slot to its anonymous partition.  A patient bound to the
+ * other slot is moved off it first.
+ */
+bool trend_db_bind_slot(uint8_t slot, int32_t patient_id);
+
+/** Partition currently receiving a slot's writes. */
+int32_t trend_db_slot_patient(uint8_t slot);
+
+/**
+ * Discharge: unbind the patient and mark the partition archived.  Its
+ * rows stay queryable by patient id until retention purges them.
+ */
+bool trend_db_archive_patient(int32_t patient_id);
+
+/** Discharge: unbind the patient and delete the partition in one transaction. */
+bool trend_db_drop_patient(int32_t patient_id);
+
 /* ── Insertion (called from mock_data timer, main thread) ── */
 
-void trend_db_insert_sample(uint32_t timestamp_s, int hr, int spo2,
-                             int rr, float temp);
+void trend_db_insert_sample(uint8_t slot, uint32_t timestamp_s, int hr,
+                             int spo2, int rr, float temp);
 
-void trend_db_insert_nibp(uint32_t timestamp_s, int sys, int dia,
-                           int map_val);
+void trend_db_insert_nibp(uint8_t slot, uint32_t timestamp_s, int sys,
+                           int dia, int map_val);
 
-void trend_db_insert_alarm(uint32_t timestamp_s,
-                            vm_alarm_severity_t severity,
-                            const char *message);
+/** Record an alarm transition (evt->time_s is ignored). */
+void trend_db_insert_alarm(uint8_t slot, uint32_t timestamp_s,
+                           const alarm_event_t *evt);
 
 /* ── Aggregation ─────────────────────────────────────────── */
 
-/** Compute and store 1-minute summary for the minute ending at minute_boundary_ts. */
+/**
+ * Compute and store 1-minute summary for the minute ending at
+ * minute_boundary_ts, for every slot's current partition.  On an hour
+ * boundary the hourly rollup is written too.
+ */
 void trend_db_aggregate_minute(uint32_t minute_boundary_ts);
 
-/* ── Queries (called from trends screen) ─────────────────── */
+/* ── Queries (exports, alarm history, tools) ─────────────── */
 
-/** Query a single vital parameter over a time range. Returns point count. */
-int trend_db_query_param(trend_param_t param, uint32_t start_ts,
-                          uint32_t end_ts, int max_points,
+/*
+ * Queries read through a shared read-only connection.  A statement that
+ * stops before its last row (SQLITE_BUSY, I/O error) makes the query
+ * return -1 with an empty result, never a short count.
+ */
+
+/**
+ * Query a single vital parameter of one patient's partition over a time
+ * range.  Returns point count.
+ */
+int trend_db_query_param(int32_t patient_id, trend_param_t param,
+                          uint32_t start_ts, uint32_t end_ts, int max_points,
                           trend_query_result_t *result);
 
-/** Query NIBP measurements over a time range. */
-int trend_db_query_nibp(uint32_t start_ts, uint32_t end_ts,
-                         trend_nibp_result_t *result);
+/**
+ * Query a single vital parameter from a specific storage tier.
+ * TREND_TIER_1HOUR gives a cheap coarse preview of long ranges.
+ */
+int trend_db_query_param_tier(int32_t patient_id, trend_param_t param,
+                               uint32_t start_ts, uint32_t end_ts,
+                               int max_points, trend_tier_t tier,
+                               trend_query_result_t *result);
+
+/**
+ * Query one parameter with LTTB downsampling: source rows of the tier are
+ * streamed through trend_lttb, keeping real samples (peaks and troughs at
+ * their true time) instead of bucket averages.  value_min/value_max hold
+ * each bucket's envelope.  Same tier selection as the AVG query.
+ */
+int trend_db_query_param_lttb(int32_t patient_id, trend_param_t param,
+                               uint32_t start_ts, uint32_t end_ts,
+                               int max_points, trend_tier_t tier,
+                               trend_query_result_t *result);
+
+/**
+ * Bucket width an AVG parameter query would use, without running it.
+ * @param tier  In: requested tier; out: resolved tier (AUTO is replaced).
+ * @return Seconds per returned point.
+ */
+uint32_t trend_db_bucket_width(uint32_t range_s, int max_points,
+                               trend_tier_t *tier);
+
+/** Query a patient's NIBP measurements over a time range. */
+int trend_db_query_nibp(int32_t patient_id, uint32_t start_ts,
+                         uint32_t end_ts, trend_nibp_result_t *result);
 
-/** Query alarm events over a time range. */
-int trend_db_query_alarms(uint32_t start_ts, uint32_t end_ts,
-                           trend_alarm_result_t *result);
+/** Query a patient's alarm events over a time range. */
+int trend_db_query_alarms(int32_t patient_id, uint32_t start_ts,
+                           uint32_t end_ts, trend_alarm_result_t *result);
+
+/**
+ * Alarm events of one parameter and/or severity ("all SpO2 criticals in
+ * the last 24 h"), answered from the (patient, param, time) or
+ * (patient, severity, time) index.  NULL filter: all events.
+ */
+int trend_db_query_alarms_filtered(int32_t patient_id, uint32_t start_ts,
+                                   uint32_t end_ts,
+                                   const trend_alarm_filter_t *filter,
+                                   trend_alarm_result_t *result);
+
+/** Event `i` of an alarm query result, time_s = its timestamp. */
+void trend_db_alarm_event(const trend_alarm_result_t *result, int i,
+                          alarm_event_t *out);
+
+/**
+ * One page of a patient's alarm history, newest first: up to max_rows
+ * events strictly older than `before` (keyset pagination, so every page
+ * costs one index seek however deep it is).  cursors[i] is the position
+ * of events[i]; pass cursors[n - 1] to get the next page.
+ * @return Events written (0 at the end of the history), or -1 if the read
+ *         failed.
+ */
+int trend_db_query_alarm_page(int32_t patient_id,
+                              const trend_alarm_cursor_t *before,
+                              int max_rows, alarm_event_t *events,
+                              trend_alarm_cursor_t *cursors);
+
+/**
+ * Read a patient's 1-minute rows in [start_ts, end_ts], oldest first, at
+ * most max_rows.  Each call is one short statement, so a bulk reader that
+ * walks history chunk by chunk never holds a read snapshot for long.
+ */
+int trend_db_read_minutes(int32_t patient_id, uint32_t start_ts,
+                          uint32_t end_ts, trend_minute_row_t *rows,
+                          int max_rows);
+
+/* ── Trend screen scans (trend_query only) ───────────────── */
+
+/**
+ * Parameter query for trend_query, on a read connection of its own so
+ * that trend_db_interrupt_scans() reaches nothing else.  In-memory
+ * databases share the query connection and cannot be interrupted.
+ * @param ds  TREND_DS_AVG as trend_db_query_param_tier(), TREND_DS_LTTB
+ *            as trend_db_query_param_lttb().
+ * @return Point count, or -1 if interrupted or the read failed.
+ */
+int trend_db_scan_param(int32_t patient_id, trend_param_t param,
+                        uint32_t start_ts, uint32_t end_ts, int max_points,
+                        trend_tier_t tier, trend_downsample_t ds,
+                        trend_query_result_t *result);
+
+/** trend_db_query_nibp() on the scan connection. */
+int trend_db_scan_nibp(int32_t patient_id, uint32_t start_ts,
+                       uint32_t end_ts, trend_nibp_result_t *result);
+
+/** trend_db_query_alarms() on the scan connection. */
+int trend_db_scan_alarms(int32_t patient_id, uint32_t start_ts,
+                         uint32_t end_ts, trend_alarm_result_t *result);
+
+/**
+ * Abort the scan currently running (it returns -1).  Exports and alarm
+ * history pages on the shared reader are unaffected.  Safe to call from
+ * any thread.
+ */
+void trend_db_interrupt_scans(void);
+
+/* ── Transfer between monitors ───────────────────────────── */
+
+/* Buffer size that holds a full 72 h segment with room to spare */
+#define TREND_DB_SEGMENT_MAX_BYTES  (256 * 1024)
+
+/**
+ * Serialise a patient's partition (raw minutes, 1-min and 1-hour
+ * aggregates, NIBP, alarm events) into a trend_segment.h segment in
+ * `buf`, read from one snapshot.  Intended to run as a job_pool job.
+ * @return Segment length, or 0 on failure or if `cap` is too small.
+ */
+size_t trend_db_export_patient(int32_t patient_id, uint8_t *buf, size_t cap);
+
+/**
+ * Load a segment from another monitor into `patient_id`'s partition (the
+ * patient's id on this monitor) in one transaction.  The segment is
+ * validated first; a bad or partially applied segment changes nothing.
+ */
+bool trend_db_import_patient(int32_t patient_id, const uint8_t *buf,
+                             size_t len);
 
 /* ── Maintenance ─────────────────────────────────────────── */
 
-/** Delete data older than retention limits (raw: 4h, aggregates: 72h). */
+/** Database file usage (main database plus its WAL). */
+typedef struct {
+    uint32_t page_size;
+    uint32_t page_count;        /* Pages in the database */
+    uint32_t freelist_count;    /* Unused pages not yet vacuumed */
+    uint64_t used_bytes;        /* (page_count - freelist_count) * page_size */
+    uint64_t wal_bytes;         /* Size of the -wal file, 0 if none */
+} trend_db_storage_t;
+
+/**
+ * Delete data older than retention limits (raw: 4h, aggregates: 72h),
+ * one partition at a time.  Archived partitions left empty are forgotten.
+ * Deletes in small chunks so concurrent inserts are never held off for
+ * long; intended to run as a JOB_PRIO_LOW job.
+ */
 void trend_db_purge_old(uint32_t current_ts);
 
+/** Read page counts and WAL size.  @return false if the DB is not open. */
+bool trend_db_get_storage(trend_db_storage_t *out);
+
+/**
+ * Return up to `max_pages` free pages to the filesystem
+ * (PRAGMA incremental_vacuum).  Holds the write lock for this call only.
+ * @return Pages released, or -1 on error.
+ */
+int trend_db_vacuum_step(int max_pages);
+
+/** Set the live-data cap enforced by trend_db_maintain (0 = default). */
+void trend_db_set_size_cap(uint64_t bytes);
+
+/**
+ * Periodic maintenance; intended to run as a JOB_PRIO_LOW job:
+ *   1. trend_db_purge_old(current_ts)
+ *   2. while live data exceeds the size cap, purge the oldest hour of
+ *      history (never the last TREND_DB_MIN_RETAIN_S)
+ *   3. incremental vacuum in short steps, then a passive checkpoint so
+ *      the freed pages leave the file
+ * Logs a storage summary line when done.
+ */
+void trend_db_maintain(uint32_t current_ts);
+
+/* ── Crash recovery ──────────────────────────────────────── */
+
+/** A slot's partial raw minute, held in memory until the minute ends. */
+typedef struct {
+    int32_t            partition;
+    trend_raw_minute_t minute;      /* minute.active == false: none held */
+} trend_db_pending_t;
+
+/** Copy the partial minute being filled for `slot`. */
+bool trend_db_get_pending(uint8_t slot, trend_db_pending_t *out);
+
+/**
+ * Write a partial minute saved before a crash back into its partition,
+ * merged with any row already stored for that minute, and aggregate it.
+ * @return false if the DB is not open or `p` holds nothing.
+ */
+bool trend_db_restore_pending(const trend_db_pending_t *p);
+
+/**
+ * Checkpoint the WAL, which every connection to the file shares.
+ * Without `truncate` this is PASSIVE: it copies what it can and never
+ * waits.  With `truncate` it also resets the WAL to zero bytes when no
+ * reader is using it (otherwise it falls back to PASSIVE).
+ * @return WAL size in bytes afterwards, or -1 if the DB is not open.
+ */
+int64_t trend_db_checkpoint(bool truncate);
+
 #endif /* TREND_DB_H */
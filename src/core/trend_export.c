@@ -0,0 +1,424 @@
+/**
+ * @file trend_export.c
+ * @brief Streaming CSV/NDJSON export — job_pool implementation
+ *
+ * One export runs at a time, in one static job.  The worker owns the
+ * file and every buffer below; the LVGL thread only touches `status`
+ * (under status_lock) and the cancel flag.
+ *
+ * Per chunk the worker reads up to an hour of 1-minute rows, NIBP and
+ * alarms, merges the three time-ordered lists and formats one line per
+ * record into the output (plain stdio, or gzip_writer with a stdio sink).
+ * A chunk whose NIBP or alarm list fills its TREND_DB_MAX_POINTS result
+ * may have been cut short, so it is exported as two half chunks instead.
+ * A chunk whose reads keep failing fails the export: a file with an hour
+ * missing is never reported as done.
+ */
+
+#include "trend_export.h"
+#include "trend_db.h"
+#include "gzip_writer.h"
+#include "job_pool.h"
+#include "mem_budget.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+/* ── Internal types ──────────────────────────────────────── */
+
+#define CHUNK_ROWS      (TREND_EXPORT_CHUNK_S / 60)
+#define READ_ATTEMPTS   3           /* Per chunk, e.g. past SQLITE_BUSY */
+#define READ_RETRY_US   50000
+
+typedef struct {
+    int32_t                patient_id;
+    uint32_t               start_ts;
+    uint32_t               end_ts;
+    trend_export_format_t  format;
+    bool                   gzip;
+    char                   path[TREND_EXPORT_PATH_MAX];
+    trend_export_done_cb_t cb;
+    void                  *user_data;
+    /* Worker side */
+    FILE                  *fp;
+    bool                   write_ok;
+    uint32_t               records;
+    uint64_t               plain_bytes;
+    trend_export_state_t   result;
+} export_job_t;
+
+/* ── Module state ────────────────────────────────────────── */
+
+static export_job_t job;
+static bool         job_running = false;
+static bool         cancel_requested = false;
+
+static pthread_mutex_t       status_lock = PTHREAD_MUTEX_INITIALIZER;
+static trend_export_status_t status;
+
+/* Worker buffers: fixed size regardless of the range exported */
+static trend_minute_row_t   chunk_minutes[CHUNK_ROWS];
+static trend_nibp_result_t  chunk_nibp;
+static trend_alarm_result_t chunk_alarms;
+static gzip_writer_t        gz;
+static char                 line[512];
+
+MEM_BUDGET_ASSERT(trend_export,
+                  sizeof(chunk_minutes) + sizeof(chunk_nibp) +
+                  sizeof(chunk_alarms) + sizeof(gz) + sizeof(line),
+                  MEM_BUDGET_TREND_EXPORT);
+
+static const char *CSV_HEADER =
+    "record,timestamp_s,time_utc,"
+    "hr,hr_min,hr_max,spo2,spo2_min,spo2_max,rr,rr_min,rr_max,"
+    "temp_c,temp_min_c,temp_max_c,"
+    "nibp_sys,nibp_dia,nibp_map,alarm_severity,alarm_message\n";
+
+static const char *SEVERITY_NAMES[] = { "none", "low", "medium", "high" };
+
+/* ── Output ──────────────────────────────────────────────── */
+
+static bool file_sink(const uint8_t *data, size_t len, void *ctx) {
+    return fwrite(data, 1, len, (FILE *)ctx) == len;
+}
+
+static void emit(export_job_t *j, const char *text, int len) {
+    if (len <= 0 || !j->write_ok) return;
+    if (j->gzip) {
+        j->write_ok = gzip_writer_write(&gz, text, (size_t)len);
+    } else {
+        j->write_ok = (fwrite(text, 1, (size_t)len, j->fp) == (size_t)len);
+        j->plain_bytes += (uint64_t)len;
+    }
+}
+
+static uint64_t bytes_written(const export_job_t *j) {
+    return j->gzip ? gz.bytes_out + gz.out_len : j->plain_bytes;
+}
+
+/* ── Formatting ──────────────────────────────────────────── */
+
+static void fmt_time(char *out, size_t size, uint32_t ts) {
+    time_t t = (time_t)ts;
+    struct tm tm;
+    gmtime_r(&t, &tm);
+    strftime(out, size, "%Y-%m-%dT%H:%M:%SZ", &tm);
+}
+
+/** Temperature x10 as a decimal string. */
+static void fmt_x10(char *out, size_t size, int32_t v) {
+    int32_t a = (v < 0) ? -v : v;
+    snprintf(out, size, "%s%d.%d", (v < 0) ? "-" : "",
+             (int)(a / 10), (int)(a % 10));
+}
+
+static const char *severity_name(int sev) {
+    return (sev >= 0 && sev <= 3) ? SEVERITY_NAMES[sev] : "unknown";
+}
+
+/** Quote a CSV field, doubling embedded quotes. */
+static void csv_quote(char *out, size_t size, const char *s) {
+    size_t o = 0;
+    out[o++] = '"';
+    for (; *s && o + 3 < size; s++) {
+        if (*s == '"') out[o++] = '"';
+        out[o++] = *s;
+    }
+    out[o++] = '"';
+    out[o] = '\0';
+}
+
+/** JSON string body: quotes, backslashes and control characters escaped. */
+static void json_escape(char *out, size_t size, const char *s) {
+    size_t o = 0;
+    for (; *s && o + 7 < size; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            out[o++] = '\\';
+            out[o++] = (char)c;
+        } else if (c < 0x20) {
+            o += (size_t)snprintf(out + o, size - o, "\\u%04x", c);
+        } else {
+            out[o++] = (char)c;
+        }
+    }
+    out[o] = '\0';
+}
+
+static int format_vitals(const export_job_t *j, const trend_minute_row_t *r) {
+    char tm[24], t[3][12];
+    fmt_time(tm, sizeof(tm), r->minute_ts);
+    fmt_x10(t[0], sizeof(t[0]), r->avg[TREND_PARAM_TEMP]);
+    fmt_x10(t[1], sizeof(t[1]), r->min[TREND_PARAM_TEMP]);
+    fmt_x10(t[2], sizeof(t[2]), r->max[TREND_PARAM_TEMP]);
+
+    if (j->format == TREND_EXPORT_CSV) {
+        return snprintf(line, sizeof(line),
+            "vitals,%u,%s,%d,%d,%d,%d,%d,%d,%d,%d,%d,%s,%s,%s,,,,,\n",
+            (unsigned)r->minute_ts, tm,
+            (int)r->avg[TREND_PARAM_HR], (int)r->min[TREND_PARAM_HR],
+            (int)r->max[TREND_PARAM_HR],
+            (int)r->avg[TREND_PARAM_SPO2], (int)r->min[TREND_PARAM_SPO2],
+            (int)r->max[TREND_PARAM_SPO2],
+            (int)r->avg[TREND_PARAM_RR], (int)r->min[TREND_PARAM_RR],
+            (int)r->max[TREND_PARAM_RR],
+            t[0], t[1], t[2]);
+    }
+    return snprintf(line, sizeof(line),
+        "{\"type\":\"vitals\",\"ts\":%u,\"time\":\"%s\","
+        "\"hr\":%d,\"hr_min\":%d,\"hr_max\":%d,"
+        "\"spo2\":%d,\"spo2_min\":%d,\"spo2_max\":%d,"
+        "\"rr\":%d,\"rr_min\":%d,\"rr_max\":%d,"
+        "\"temp_c\":%s,\"temp_min_c\":%s,\"temp_max_c\":%s}\n",
+        (unsigned)r->minute_ts, tm,
+        (int)r->avg[TREND_PARAM_HR], (int)r->min[TREND_PARAM_HR],
+        (int)r->max[TREND_PARAM_HR],
+        (int)r->avg[TREND_PARAM_SPO2], (int)r->min[TREND_PARAM_SPO2],
+        (int)r->max[TREND_PARAM_SPO2],
+        (int)r->avg[TREND_PARAM_RR], (int)r->min[TREND_PARAM_RR],
+        (int)r->max[TREND_PARAM_RR],
+        t[0], t[1], t[2]);
+}
+
+static int format_nibp(const export_job_t *j, int i) {
+    char tm[24];
+    uint32_t ts = chunk_nibp.timestamp_s[i];
+    fmt_time(tm, sizeof(tm), ts);
+
+    if (j->format == TREND_EXPORT_CSV) {
+        return snprintf(line, sizeof(line),
+            "nibp,%u,%s,,,,,,,,,,,,,%d,%d,%d,,\n",
+            (unsigned)ts, tm, chunk_nibp.sys[i], chunk_nibp.dia[i],
+            chunk_nibp.map_val[i]);
+    }
+    return snprintf(line, sizeof(line),
+        "{\"type\":\"nibp\",\"ts\":%u,\"time\":\"%s\","
+        "\"sys\":%d,\"dia\":%d,\"map\":%d}\n",
+        (unsigned)ts, tm, chunk_nibp.sys[i], chunk_nibp.dia[i],
+        chunk_nibp.map_val[i]);
+}
+
+static int format_alarm(const export_job_t *j, int i) {
+    char tm[24], text[96], msg[300];
+    uint32_t ts = chunk_alarms.timestamp_s[i];
+    const char *sev = severity_name(chunk_alarms.severity[i]);
+    fmt_time(tm, sizeof(tm), ts);
+
+    alarm_event_t evt;
+    trend_db_alarm_event(&chunk_alarms, i, &evt);
+    alarm_engine_format_event(&evt, text, sizeof(text));
+
+    if (j->format == TREND_EXPORT_CSV) {
+        csv_quote(msg, sizeof(msg), text);
+        return snprintf(line, sizeof(line),
+            "alarm,%u,%s,,,,,,,,,,,,,,,,%s,%s\n",
+            (unsigned)ts, tm, sev, msg);
+    }
+    json_escape(msg, sizeof(msg), text);
+    return snprintf(line, sizeof(line),
+        "{\"type\":\"alarm\",\"ts\":%u,\"time\":\"%s\","
+        "\"severity\":\"%s\",\"message\":\"%s\"}\n",
+        (unsigned)ts, tm, sev, msg);
+}
+
+/* ── Worker ──────────────────────────────────────────────── */
+
+static bool is_cancelled(void) {
+    return __atomic_load_n(&cancel_requested, __ATOMIC_ACQUIRE);
+}
+
+static void publish_progress(export_job_t *j, uint64_t done_to) {
+    uint64_t span = (uint64_t)j->end_ts - j->start_ts + 1;
+    uint64_t done = done_to - j->start_ts;
+
+    pthread_mutex_lock(&status_lock);
+    status.percent = (uint8_t)((done >= span) ? 100 : done * 100 / span);
+    status.records = j->records;
+    status.bytes   = bytes_written(j);
+    pthread_mutex_unlock(&status_lock);
+}
+
+/**
+ * Merge one chunk's three time-ordered lists into the output.
+ * @return false if the chunk could not be read completely.
+ */
+static bool export_chunk(export_job_t *j, uint32_t from, uint32_t to) {
+    int nm = -1, nn = -1, na = -1;
+    for (int a = 0; a < READ_ATTEMPTS; a++) {
+        if (a > 0) usleep(READ_RETRY_US);
+        nm = trend_db_read_minutes(j->patient_id, from, to,
+                                   chunk_minutes, CHUNK_ROWS);
+        nn = trend_db_query_nibp(j->patient_id, from, to, &chunk_nibp);
+        na = trend_db_query_alarms(j->patient_id, from, to, &chunk_alarms);
+        if (nm >= 0 && nn >= 0 && na >= 0) break;
+    }
+    if (nm < 0 || nn < 0 || na < 0) {
+        fprintf(stderr, "[trend_export] Read of %u..%u failed\n",
+                (unsigned)from, (unsigned)to);
+        return false;
+    }
+
+    /* A full list may be truncated: re-read in halves, down to 1 s */
+    if (nn == TREND_DB_MAX_POINTS || na == TREND_DB_MAX_POINTS) {
+        if (from == to) {
+            fprintf(stderr, "[trend_export] Over %d records at %u\n",
+                    TREND_DB_MAX_POINTS, (unsigned)from);
+            return false;
+        }
+        uint32_t mid = from + (to - from) / 2;
+        return export_chunk(j, from, mid) && export_chunk(j, mid + 1, to);
+    }
+
+    int im = 0, in = 0, ia = 0;
+    while (j->write_ok && (im < nm || in < nn || ia < na)) {
+        uint32_t tm = (im < nm) ? chunk_minutes[im].minute_ts : UINT32_MAX;
+        uint32_t tn = (in < nn) ? chunk_nibp.timestamp_s[in] : UINT32_MAX;
+        uint32_t ta = (ia < na) ? chunk_alarms.timestamp_s[ia] : UINT32_MAX;
+
+        int len;
+        if (im < nm && tm <= tn && tm <= ta) {
+            len = format_vitals(j, &chunk_minutes[im++]);
+        } else if (in < nn && tn <= ta) {
+            len = format_nibp(j, in++);
+        } else {
+            len = format_alarm(j, ia++);
+        }
+        if (len >= (int)sizeof(line)) len = (int)sizeof(line) - 1;
+        emit(j, line, len);
+        j->records++;
+    }
+    return true;
+}
+
+static void export_job_run(void *arg) {
+    export_job_t *j = (export_job_t *)arg;
+    j->records = 0;
+    j->plain_bytes = 0;
+    j->result = TREND_EXPORT_FAILED;
+
+    j->fp = fopen(j->path, "wb");
+    if (!j->fp) {
+        fprintf(stderr, "[trend_export] Cannot create %s\n", j->path);
+        return;
+    }
+    j->write_ok = j->gzip ? gzip_writer_init(&gz, file_sink, j->fp) : true;
+    if (j->format == TREND_EXPORT_CSV) {
+        emit(j, CSV_HEADER, (int)strlen(CSV_HEADER));
+    }
+
+    bool cancelled = false;
+    for (uint64_t from = j->start_ts; from <= j->end_ts && j->write_ok;
+         from += TREND_EXPORT_CHUNK_S) {
+        if (is_cancelled()) {
+            cancelled = true;
+            break;
+        }
+        uint64_t to = from + TREND_EXPORT_CHUNK_S - 1;
+        if (to > j->end_ts) to = j->end_ts;
+        if (!export_chunk(j, (uint32_t)from, (uint32_t)to)) {
+            j->write_ok = false;
+            break;
+        }
+        publish_progress(j, to + 1);
+    }
+
+    if (j->gzip && !cancelled) j->write_ok = gzip_writer_finish(&gz) && j->write_ok;
+    /* Removable media: make sure the data is on the stick before "done" */
+    bool ok = j->write_ok && !cancelled &&
+              fflush(j->fp) == 0 && fsync(fileno(j->fp)) == 0;
+    if (fclose(j->fp) != 0) ok = false;
+    j->fp = NULL;
+
+    if (ok) {
+        j->result = TREND_EXPORT_DONE;
+        publish_progress(j, (uint64_t)j->end_ts + 1);
+    } else {
+        j->result = cancelled ? TREND_EXPORT_CANCELLED : TREND_EXPORT_FAILED;
+        unlink(j->path);
+    }
+}
+
+/* ── Completion (LVGL thread) ────────────────────────────── */
+
+static void export_job_done(void *arg) {
+    export_job_t *j = (export_job_t *)arg;
+
+    pthread_mutex_lock(&status_lock);
+    status.state = j->result;
+    trend_export_status_t final = status;
+    pthread_mutex_unlock(&status_lock);
+
+    job_running = false;
+    printf("[trend_export] %s: %u records, %llu bytes (%s)\n",
+           j->result == TREND_EXPORT_DONE ? "Done" :
+           j->result == TREND_EXPORT_CANCELLED ? "Cancelled" : "Failed",
+           (unsigned)final.records, (unsigned long long)final.bytes,
+           j->path);
+    if (j->cb) j->cb(&final, j->user_data);
+}
+
+/* ── Public API ──────────────────────────────────────────── */
+
+bool trend_export_start(int32_t patient_id, uint32_t start_ts,
+                        uint32_t end_ts, trend_export_format_t format,
+                        bool gzip, const char *path,
+                        trend_export_done_cb_t cb, void *user_data) {
+    if (job_running || !path || end_ts < start_ts) return false;
+    if (strlen(path) >= TREND_EXPORT_PATH_MAX) return false;
+
+    job.patient_id = patient_id;
+    job.start_ts   = start_ts;
+    job.end_ts     = end_ts;
+    job.format     = format;
+    job.gzip       = gzip;
+    job.cb         = cb;
+    job.user_data  = user_data;
+    strcpy(job.path, path);
+
+    pthread_mutex_lock(&status_lock);
+    memset(&status, 0, sizeof(status));
+    status.state = TREND_EXPORT_RUNNING;
+    strcpy(status.path, path);
+    pthread_mutex_unlock(&status_lock);
+
+    __atomic_store_n(&cancel_requested, false, __ATOMIC_RELEASE);
+    job_running = true;
+
+    /* Never run inline: a 72 h export would stall the LVGL loop */
+    if (!job_pool_submit(JOB_PRIO_LOW, export_job_run, export_job_done, &job)) {
+        job_running = false;
+        pthread_mutex_lock(&status_lock);
+        status.state = TREND_EXPORT_FAILED;
+        pthread_mutex_unlock(&status_lock);
+        return false;
+    }
+    printf("[trend_export] Exporting patient %d to %s\n", (int)patient_id, path);
+    return true;
+}
+
+void trend_export_cancel(void) {
+    if (job_running) __atomic_store_n(&cancel_requested, true, __ATOMIC_RELEASE);
+}
+
+bool trend_export_busy(void) {
+    return job_running;
+}
+
+trend_export_status_t trend_export_get_status(void) {
+    pthread_mutex_lock(&status_lock);
+    trend_export_status_t s = status;
+    pthread_mutex_unlock(&status_lock);
+    return s;
+}
+
+bool trend_export_make_path(char *out, int out_size, const char *dir,
+                            int32_t patient_id, uint32_t end_ts,
+                            trend_export_format_t format, bool gzip) {
+    int n = snprintf(out, (size_t)out_size, "%s/trends_%d_%u.%s%s",
+                     dir, (int)patient_id, (unsigned)end_ts,
+                     format == TREND_EXPORT_NDJSON ? "ndjson" : "csv",
+                     gzip ? ".gz" : "");
+    return n > 0 && n < out_size;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file trend_export.h
+ * @brief Streaming CSV/NDJSON export of trend history to removable media
+ *
+ * Writes one patient's 1-minute vitals, NIBP measurements and alarm
+ * events over a time range to a file (typically on a mounted USB stick),
+ * merged in time order.  The export runs as a single JOB_PRIO_LOW job:
+ *
+ *   - History is read one hour at a time.  Every chunk is a few short
+ *     trend_db statements, so no read snapshot outlives its chunk and WAL
+ *     checkpoints are never held off by an export in progress.
+ *   - Memory is fixed: one hour of rows, a line buffer and, with
+ *     compression on, one gzip_writer_t.  Output is streamed as it is
+ *     produced.
+ *   - Progress is published after each chunk; the UI polls it with
+ *     trend_export_get_status().  Cancellation is checked between chunks.
+ *
+ * A cancelled or failed export removes its partial file.  The completion
+ * callback runs on the LVGL thread.
+ */
+
+#ifndef TREND_EXPORT_H
+#define TREND_EXPORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ── Constants ─────────────────────────────────────────────── */
+
+#define TREND_EXPORT_PATH_MAX  128
+#define TREND_EXPORT_CHUNK_S   3600     /* History read per chunk */
+
+/* Mount point of the removable drive on the target */
+#ifndef TREND_EXPORT_USB_DIR
+#define TREND_EXPORT_USB_DIR   "/media/usb0"
+#endif
+
+/* ── Types ─────────────────────────────────────────────────── */
+
+typedef enum {
+    TREND_EXPORT_CSV = 0,
+    TREND_EXPORT_NDJSON,
+} trend_export_format_t;
+
+typedef enum {
+    TREND_EXPORT_IDLE = 0,
+    TREND_EXPORT_RUNNING,
+    TREND_EXPORT_DONE,
+    TREND_EXPORT_CANCELLED,
+    TREND_EXPORT_FAILED,
+} trend_export_state_t;
+
+typedef struct {
+    trend_export_state_t state;
+    uint8_t  percent;               /* Of the time range processed */
+    uint32_t records;               /* Lines written, header excluded */
+    uint64_t bytes;                 /* Bytes written to the file */
+    char     path[TREND_EXPORT_PATH_MAX];
+} trend_export_status_t;
+
+/** Completion callback (LVGL thread). */
+typedef void (*trend_export_done_cb_t)(const trend_export_status_t *status,
+                                       void *user_data);
+
+/* ── API (LVGL thread) ─────────────────────────────────────── */
+
+/**
+ * Start exporting [start_ts, end_ts] of a patient's partition to `path`.
+ * The file is created on the worker; failure to create or write it is
+ * reported through the callback as TREND_EXPORT_FAILED.
+ * @param gzip  Compress on the fly (the caller picks the file name).
+ * @return false if an export is already running, the arguments are
+ *         invalid or the job pool is not running.
+ */
+bool trend_export_start(int32_t patient_id, uint32_t start_ts,
+                        uint32_t end_ts, trend_export_format_t format,
+                        bool gzip, const char *path,
+                        trend_export_done_cb_t cb, void *user_data);
+
+/** Stop the running export after its current chunk. */
+void trend_export_cancel(void);
+
+/** True from start until the completion callback has run. */
+bool trend_export_busy(void);
+
+/** Snapshot of the running (or last finished) export.  Any thread. */
+trend_export_status_t trend_export_get_status(void);
+
+/**
+ * Build "<dir>/trends_<patient>_<end_ts>.<csv|ndjson>[.gz]".
+ * @return false if the result does not fit `out`.
+ */
+bool trend_export_make_path(char *out, int out_size, const char *dir,
+                            int32_t patient_id, uint32_t end_ts,
+                            trend_export_format_t format, bool gzip);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TREND_EXPORT_H */
@@ -0,0 +1,175 @@
+/**
+ * @file trend_lttb.c
+ * @brief Streaming LTTB downsampler implementation
+ *
+ * Sample flow:
+ *   push -> held (one-sample delay, so the final sample is kept verbatim)
+ *        -> current bucket -> pending bucket -> one emitted point
+ *
+ * A pending bucket is decided when the current bucket closes, using the
+ * last emitted point (A) and the current bucket's average (C):
+ *   area(P) ~ |(A.x - C.x)(P.y - A.y) - (A.x - P.x)(C.y - A.y)|
+ */
+
+#include "trend_lttb.h"
+#include <string.h>
+
+/* ── Helpers ─────────────────────────────────────────────── */
+
+static void bucket_reset(trend_lttb_bucket_t *b) {
+    b->index = -1;
+    b->count = 0;
+    b->sum_ts = 0;
+    b->sum_value = 0;
+    b->n_total = 0;
+    b->env_min = INT32_MAX;
+    b->env_max = INT32_MIN;
+}
+
+static void emit(trend_lttb_t *s, trend_lttb_sample_t p,
+                 int32_t vmin, int32_t vmax) {
+    if (s->out_count < s->out_cap) {
+        s->out_ts[s->out_count]    = p.ts;
+        s->out_value[s->out_count] = p.value;
+        s->out_min[s->out_count]   = vmin;
+        s->out_max[s->out_count]   = vmax;
+        s->out_count++;
+    }
+    s->anchor = p;
+    s->have_anchor = true;
+}
+
+/** Keep only the min- and max-valued samples, in time order. */
+static void bucket_compact(trend_lttb_bucket_t *b) {
+    int lo = 0, hi = 0;
+    for (int i = 1; i < b->count; i++) {
+        if (b->samples[i].value < b->samples[lo].value) lo = i;
+        if (b->samples[i].value > b->samples[hi].value) hi = i;
+    }
+    trend_lttb_sample_t a = b->samples[lo < hi ? lo : hi];
+    trend_lttb_sample_t c = b->samples[lo < hi ? hi : lo];
+    b->samples[0] = a;
+    b->samples[1] = c;
+    b->count = (lo == hi) ? 1 : 2;
+}
+
+static void bucket_add(trend_lttb_t *s, trend_lttb_bucket_t *b,
+                       trend_lttb_sample_t p, int32_t vmin, int32_t vmax) {
+    if (b->count == TREND_LTTB_BUCKET_CAP) bucket_compact(b);
+    b->samples[b->count++] = p;
+    b->sum_ts += (int64_t)(p.ts - s->start_ts);
+    b->sum_value += p.value;
+    b->n_total++;
+    if (vmin < b->env_min) b->env_min = vmin;
+    if (vmax > b->env_max) b->env_max = vmax;
+}
+
+/** Emit the sample of `b` with the largest triangle against A and (cx, cy). */
+static void bucket_select(trend_lttb_t *s, const trend_lttb_bucket_t *b,
+                          int64_t cx, int64_t cy) {
+    int64_t ax = (int64_t)(s->anchor.ts - s->start_ts);
+    int64_t ay = s->anchor.value;
+    int64_t best_area = -1;
+    int best = 0;
+
+    for (int i = 0; i < b->count; i++) {
+        int64_t px = (int64_t)(b->samples[i].ts - s->start_ts);
+        int64_t py = b->samples[i].value;
+        int64_t area = (ax - cx) * (py - ay) - (ax - px) * (cy - ay);
+        if (area < 0) area = -area;
+        if (area > best_area) {
+            best_area = area;
+            best = i;
+        }
+    }
+    emit(s, b->samples[best], b->env_min, b->env_max);
+}
+
+/** Decide the pending bucket using `next` as the third vertex. */
+static void decide_pending(trend_lttb_t *s, int64_t cx, int64_t cy) {
+    trend_lttb_bucket_t *pend = &s->bucket[s->pending];
+    if (pend->count > 0) bucket_select(s, pend, cx, cy);
+    bucket_reset(pend);
+}
+
+/** Route a sample into its time bucket, deciding buckets it closes. */
+static void route_sample(trend_lttb_t *s, trend_lttb_sample_t p,
+                         int32_t vmin, int32_t vmax) {
+    int idx = (p.ts > s->start_ts)
+              ? (int)((p.ts - s->start_ts) / s->bucket_s) : 0;
+    if (idx >= s->n_buckets) idx = s->n_buckets - 1;
+
+    trend_lttb_bucket_t *cur = &s->bucket[s->pending ^ 1];
+    if (cur->count > 0 && cur->index != idx) {
+        /* Current bucket closed: it supplies C for the pending one */
+        decide_pending(s, cur->sum_ts / cur->n_total,
+                       cur->sum_value / cur->n_total);
+        s->pending ^= 1;
+        cur = &s->bucket[s->pending ^ 1];
+    }
+    cur->index = idx;
+    bucket_add(s, cur, p, vmin, vmax);
+}
+
+/* ── Public API ──────────────────────────────────────────── */
+
+void trend_lttb_init(trend_lttb_t *s, uint32_t start_ts, uint32_t end_ts,
+                     int max_points, uint32_t *out_ts, int32_t *out_value,
+                     int32_t *out_min, int32_t *out_max) {
+    memset(s, 0, sizeof(*s));
+    s->out_ts    = out_ts;
+    s->out_value = out_value;
+    s->out_min   = out_min;
+    s->out_max   = out_max;
+    s->out_cap   = (max_points > 0) ? max_points : 0;
+
+    s->start_ts  = start_ts;
+    s->n_buckets = (max_points > 3) ? max_points - 2 : 1;
+
+    uint32_t span = (end_ts > start_ts) ? end_ts - start_ts + 1 : 1;
+    s->bucket_s = (span + (uint32_t)s->n_buckets - 1) / (uint32_t)s->n_buckets;
+    if (s->bucket_s < 1) s->bucket_s = 1;
+
+    bucket_reset(&s->bucket[0]);
+    bucket_reset(&s->bucket[1]);
+    s->pending = 0;
+}
+
+void trend_lttb_push(trend_lttb_t *s, uint32_t ts, int32_t value,
+                     int32_t vmin, int32_t vmax) {
+    trend_lttb_sample_t p = { ts, value };
+
+    if (!s->have_anchor) {
+        emit(s, p, vmin, vmax);             /* First sample is kept */
+        return;
+    }
+    if (s->have_held) {
+        route_sample(s, s->held, s->held_min, s->held_max);
+    }
+    s->held = p;
+    s->held_min = vmin;
+    s->held_max = vmax;
+    s->have_held = true;
+}
+
+int trend_lttb_finish(trend_lttb_t *s) {
+    trend_lttb_bucket_t *cur = &s->bucket[s->pending ^ 1];
+
+    if (cur->count > 0) {
+        decide_pending(s, cur->sum_ts / cur->n_total,
+                       cur->sum_value / cur->n_total);
+
+        /* Last bucket: the held final sample is the third vertex */
+        int64_t cx = s->have_held ? (int64_t)(s->held.ts - s->start_ts)
+                                  : cur->sum_ts / cur->n_total;
+        int64_t cy = s->have_held ? s->held.value
+                                  : cur->sum_value / cur->n_total;
+        bucket_select(s, cur, cx, cy);
+        bucket_reset(cur);
+    }
+    if (s->have_held) {
+        emit(s, s->held, s->held_min, s->held_max);
+        s->have_held = false;
+    }
+    return s->out_count;
+}
@@ -0,0 +1,113 @@
+/**
+ * @file trend_lttb.h
+ * @brief Streaming largest-triangle-three-buckets (LTTB) downsampler
+ *
+ * GROUP BY averaging flattens a 30 s desaturation or tachycardia run into
+ * its neighbours and moves it to the bucket start.  LTTB instead keeps,
+ * per bucket, the real sample that forms the largest triangle with the
+ * previously kept sample and the average of the next bucket, so peaks
+ * and troughs survive at their true time.
+ *
+ * Buckets are fixed time slices of [start_ts, end_ts] rather than fixed
+ * row counts, so the row count need not be known up front and gaps in
+ * the data stay gaps.  Samples are pushed in timestamp order; each bucket
+ * is decided once the following bucket is complete.  O(n) time, no
+ * allocation: the state holds two bucket buffers and writes into
+ * caller-owned output arrays.
+ *
+ * Each output point also carries the min/max envelope of its bucket.
+ * The first and last samples are always kept.
+ *
+ * No LVGL or SQLite dependency.
+ */
+
+#ifndef TREND_LTTB_H
+#define TREND_LTTB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ── Constants ─────────────────────────────────────────────── */
+
+/*
+ * Samples retained per bucket.  Trend views see 8-15 rows per bucket;
+ * beyond the cap a bucket is compacted to its min and max samples
+ * (averages and envelope stay exact).
+ */
+#define TREND_LTTB_BUCKET_CAP  64
+
+/* ── Types ─────────────────────────────────────────────────── */
+
+typedef struct {
+    uint32_t ts;
+    int32_t  value;
+} trend_lttb_sample_t;
+
+typedef struct {
+    int                 index;      /* Bucket number, -1 = unused */
+    int                 count;
+    trend_lttb_sample_t samples[TREND_LTTB_BUCKET_CAP];
+    int64_t             sum_ts;     /* Relative to start_ts */
+    int64_t             sum_value;
+    int                 n_total;    /* Samples seen, including compacted */
+    int32_t             env_min;
+    int32_t             env_max;
+} trend_lttb_bucket_t;
+
+typedef struct {
+    /* Output (caller-owned, out_cap entries each) */
+    uint32_t *out_ts;
+    int32_t  *out_value;
+    int32_t  *out_min;
+    int32_t  *out_max;
+    int       out_cap;
+    int       out_count;
+
+    /* Bucketing */
+    uint32_t  start_ts;
+    uint32_t  bucket_s;
+    int       n_buckets;
+
+    /* Streaming state */
+    bool                have_anchor;
+    trend_lttb_sample_t anchor;     /* Last point emitted */
+    bool                have_held;
+    trend_lttb_sample_t held;       /* Newest sample, held back */
+    int32_t             held_min;
+    int32_t             held_max;
+    trend_lttb_bucket_t bucket[2];  /* Pending + current */
+    int                 pending;    /* Index into bucket[] */
+} trend_lttb_t;
+
+/* ── API ───────────────────────────────────────────────────── */
+
+/**
+ * Prepare a downsampling pass over [start_ts, end_ts].
+ * @param max_points  Output capacity (>= 3); max_points - 2 buckets.
+ */
+void trend_lttb_init(trend_lttb_t *s, uint32_t start_ts, uint32_t end_ts,
+                     int max_points, uint32_t *out_ts, int32_t *out_value,
+                     int32_t *out_min, int32_t *out_max);
+
+/**
+ * Feed one source row (timestamps non-decreasing).  For aggregate rows
+ * pass the row's min/max; for raw samples pass value for both.
+ */
+void trend_lttb_push(trend_lttb_t *s, uint32_t ts, int32_t value,
+                     int32_t vmin, int32_t vmax);
+
+/**
+ * Flush the remaining buckets and the last sample.
+ * @return Number of output points.
+ */
+int trend_lttb_finish(trend_lttb_t *s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TREND_LTTB_H */
@@ -0,0 +1,276 @@
+/**
+ * @file trend_query.c
+ * @brief Asynchronous trend queries — job_pool implementation
+ *
+ * One static job (with its result set) is ever in flight.  A request that
+ * arrives while it runs bumps the ticket, interrupts the scan connection
+ * (trend_db_scan_*, which nothing else reads through) and is parked in
+ * `pending`; the cancelled job's completion then launches it.  This keeps
+ * a single set of result buffers and never runs two trend scans at once.
+ *
+ * Parameter series go through trend_cache: the worker serves a hit from
+ * memory and stores each miss that read to the end.  A read that fails
+ * without a cancellation (e.g. SQLITE_BUSY) is retried; if it keeps
+ * failing the series is left empty rather than shown short.
+ */
+
+#include "trend_query.h"
+#include "trend_cache.h"
+#include "job_pool.h"
+#include "mem_budget.h"
+#include <string.h>
+
+/* ── Internal types ──────────────────────────────────────── */
+
+typedef struct {
+    uint32_t         ticket;
+    int              max_points;
+    trend_tier_t     tier;          /* Full-resolution tier (resolved) */
+    bool             progressive;
+    bool             cancelled;
+    trend_query_cb_t cb;
+    void            *user_data;
+    trend_query_set_t set;
+} query_job_t;
+
+typedef struct {
+    bool             valid;
+    uint32_t         ticket;
+    int32_t          patient_id;
+    uint32_t         start_ts;
+    uint32_t         end_ts;
+    int              max_points;
+    trend_tier_t     tier;
+    bool             progressive;
+    trend_query_cb_t cb;
+    void            *user_data;
+} pending_req_t;
+
+/* Slot whose patient the trends screen shows */
+#define TREND_QUERY_SLOT  0
+
+/* Tries per read before its series is left empty */
+#define READ_ATTEMPTS     3
+
+/* ── Module state ────────────────────────────────────────── */
+
+static query_job_t   job;
+static bool          job_running = false;
+static pending_req_t pending;
+
+MEM_BUDGET_ASSERT(trend_query, sizeof(job), MEM_BUDGET_TREND_QUERY);
+
+/* Per-parameter downsampling, copied into each job at launch */
+static trend_downsample_t param_ds[TREND_PARAM_COUNT];
+
+/* Latest ticket; read by the worker to detect cancellation */
+static uint32_t      current_ticket = 0;
+
+/* ── Forward declarations ────────────────────────────────── */
+
+static void start_job(void);
+
+/* ── Helpers ─────────────────────────────────────────────── */
+
+static bool is_cancelled(const query_job_t *j) {
+    return j->ticket != __atomic_load_n(&current_ticket, __ATOMIC_ACQUIRE);
+}
+
+static uint32_t next_ticket(void) {
+    uint32_t t = __atomic_add_fetch(&current_ticket, 1, __ATOMIC_ACQ_REL);
+    if (t == 0) t = __atomic_add_fetch(&current_ticket, 1, __ATOMIC_ACQ_REL);
+    return t;
+}
+
+/** Load a request into the job slot (job must not be running). */
+static void load_job(uint32_t ticket, int32_t patient_id,
+                     uint32_t start_ts, uint32_t end_ts,
+                     int max_points, trend_tier_t tier, bool progressive,
+                     trend_query_cb_t cb, void *user_data) {
+    job.ticket       = ticket;
+    job.max_points   = max_points;
+    job.tier         = tier;
+    job.progressive  = progressive;
+    job.cb           = cb;
+    job.user_data    = user_data;
+    job.set.patient_id = patient_id;
+    job.set.start_ts = start_ts;
+    job.set.end_ts   = end_ts;
+    job.set.stage    = progressive ? TREND_STAGE_COARSE : TREND_STAGE_FULL;
+    memcpy(job.set.ds, param_ds, sizeof(job.set.ds));
+    job.set.nibp.count   = 0;
+    job.set.alarms.count = 0;
+}
+
+/** Coarse tier: one step above what the full query reads. */
+static trend_tier_t coarse_tier(trend_tier_t full) {
+    return (full == TREND_TIER_RAW) ? TREND_TIER_1MIN : TREND_TIER_1HOUR;
+}
+
+/* ── Worker ──────────────────────────────────────────────── */
+
+/** One parameter series: from trend_cache, else from trend_db. */
+static void fetch_param(query_job_t *j, trend_param_t p, trend_tier_t tier) {
+    trend_query_set_t *set = &j->set;
+    trend_cache_key_t key;
+
+    key.patient_id = set->patient_id;
+    key.param      = p;
+    key.tier       = tier;
+    key.range_s    = set->end_ts - set->start_ts;
+    key.bucket_s   = trend_db_bucket_width(key.range_s, j->max_points,
+                                           &key.tier);
+    key.end_ts     = set->end_ts;
+    key.max_points = j->max_points;
+    key.ds         = set->ds[p];
+
+    uint32_t generation;
+    if (trend_cache_lookup(&key, &set->param[p], &generation)) return;
+
+    for (int a = 0; a < READ_ATTEMPTS && !is_cancelled(j); a++) {
+        if (trend_db_scan_param(set->patient_id, p, set->start_ts,
+                                set->end_ts, j->max_points, key.tier, key.ds,
+                                &set->param[p]) >= 0) {
+            trend_cache_store(&key, &set->param[p], generation);
+            return;
+        }
+    }
+    set->param[p].count = 0;
+}
+
+/** NIBP and alarms, retried like a parameter read. */
+static void fetch_events(query_job_t *j) {
+    trend_query_set_t *set = &j->set;
+    int32_t pid = set->patient_id;
+    uint32_t s = set->start_ts, e = set->end_ts;
+
+    for (int a = 0; a < READ_ATTEMPTS && !is_cancelled(j); a++) {
+        if (trend_db_scan_nibp(pid, s, e, &set->nibp) >= 0) break;
+    }
+    for (int a = 0; a < READ_ATTEMPTS && !is_cancelled(j); a++) {
+        if (trend_db_scan_alarms(pid, s, e, &set->alarms) >= 0) break;
+    }
+}
+
+static void query_job_run(void *arg) {
+    query_job_t *j = (query_job_t *)arg;
+    trend_query_set_t *set = &j->set;
+    bool coarse = (set->stage == TREND_STAGE_COARSE);
+    trend_tier_t tier = coarse ? coarse_tier(j->tier) : j->tier;
+
+    for (int p = 0; p < TREND_PARAM_COUNT; p++) {
+        if (is_cancelled(j)) {
+            j->cancelled = true;
+            return;
+        }
+        fetch_param(j, (trend_param_t)p, tier);
+    }
+
+    /* Sparse series are cheap: fetch once, in the first stage */
+    if (coarse || !j->progressive) fetch_events(j);
+
+    /* An interrupted read left its series empty */
+    if (is_cancelled(j)) j->cancelled = true;
+}
+
+/* ── Completion (LVGL thread) ────────────────────────────── */
+
+static void query_job_done(void *arg) {
+    query_job_t *j = (query_job_t *)arg;
+    job_running = false;
+
+    if (!j->cancelled && !is_cancelled(j)) {
+        if (j->cb) j->cb(&j->set, j->user_data);
+
+        /* The callback may itself have issued a new request */
+        if (job_running) return;
+
+        /* Still current after the callback: refine */
+        if (j->set.stage == TREND_STAGE_COARSE && !is_cancelled(j)) {
+            j->set.stage = TREND_STAGE_FULL;
+            start_job();
+            return;
+        }
+    }
+
+    if (pending.valid) {
+        pending.valid = false;
+        if (pending.ticket == __atomic_load_n(&current_ticket, __ATOMIC_ACQUIRE)) {
+            load_job(pending.ticket, pending.patient_id,
+                     pending.start_ts, pending.end_ts,
+                     pending.max_points, pending.tier, pending.progressive,
+                     pending.cb, pending.user_data);
+            start_job();
+        }
+    }
+}
+
+static void start_job(void) {
+    job.cancelled = false;
+    job_running = true;
+
+    if (!job_pool_submit(JOB_PRIO_HIGH, query_job_run, query_job_done, &job)) {
+        /* Pool unavailable: run inline (blocks, but stays correct) */
+        query_job_run(&job);
+        query_job_done(&job);
+    }
+}
+
+/* ── Public API ──────────────────────────────────────────── */
+
+uint32_t trend_query_request(uint32_t start_ts, uint32_t end_ts,
+                             int max_points, trend_tier_t tier,
+                             bool progressive,
+                             trend_query_cb_t cb, void *user_data) {
+    uint32_t ticket = next_ticket();
+    int32_t patient_id = trend_db_slot_patient(TREND_QUERY_SLOT);
+
+    if (max_points > TREND_DB_MAX_POINTS) max_points = TREND_DB_MAX_POINTS;
+
+    /* Minute-aligned window: repeat views map to the same cache keys */
+    uint32_t range_s = end_ts - start_ts;
+    end_ts -= end_ts % 60;
+    start_ts = (end_ts > range_s) ? end_ts - range_s : 0;
+    trend_db_bucket_width(range_s, max_points, &tier);     /* Resolve AUTO */
+
+    if (job_running) {
+        /* Park the request; the cancelled job launches it on completion */
+        pending.valid       = true;
+        pending.ticket      = ticket;
+        pending.patient_id  = patient_id;
+        pending.start_ts    = start_ts;
+        pending.end_ts      = end_ts;
+        pending.max_points  = max_points;
+        pending.tier        = tier;
+        pending.progressive = progressive;
+        pending.cb          = cb;
+        pending.user_data   = user_data;
+        trend_db_interrupt_scans();
+        return ticket;
+    }
+
+    load_job(ticket, patient_id, start_ts, end_ts, max_points, tier,
+             progressive, cb, user_data);
+    start_job();
+    return ticket;
+}
+
+void trend_query_cancel(void) {
+    next_ticket();
+    pending.valid = false;
+    if (job_running) trend_db_interrupt_scans();
+}
+
+void trend_query_set_downsample(trend_param_t param, trend_downsample_t ds) {
+    if (param < 0 || param >= TREND_PARAM_COUNT) return;
+    param_ds[param] = ds;
+}
+
+trend_downsample_t trend_query_get_downsample(trend_param_t param) {
+    if (param < 0 || param >= TREND_PARAM_COUNT) return TREND_DS_AVG;
+    return param_ds[param];
+}
+
+bool trend_query_busy(void) {
+    return job_running || pending.valid;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file trend_query.h
+ * @brief Asynchronous trend queries with progressive refinement
+ *
+ * Front end over trend_db for the trends screen.  A request runs on a
+ * job_pool worker against trend_db's read-only WAL connection, so the
+ * LVGL thread never waits on SQLite.
+ *
+ * Progressive requests complete in two stages:
+ *   1. COARSE — parameters from the tier above the requested one (1-min
+ *      rows over raw, hourly rollups over 1-min rows), plus NIBP and
+ *      alarms.  A 72 h view is ~72 rows per parameter and arrives within
+ *      a frame or two.
+ *   2. FULL   — parameters from the requested tier; NIBP and alarms
+ *      carried over from stage 1.
+ *
+ * Only the latest request matters: issuing a new one (or calling
+ * trend_query_cancel) cancels the one in flight.  The worker checks for
+ * cancellation between queries and the running SQLite statement is
+ * interrupted, so a range switch never waits for a stale 72 h query.
+ *
+ * Windows are aligned down to the minute (the granularity at which
+ * aggregated history changes) and parameter series are served from
+ * trend_cache where possible, so flipping between ranges is a memory copy.
+ *
+ * Callbacks run on the LVGL thread (from job_pool_dispatch_completions)
+ * and may touch widgets.  The result set is only valid for the duration
+ * of the callback.
+ */
+
+#ifndef TREND_QUERY_H
+#define TREND_QUERY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "trend_db.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ── Result stages ─────────────────────────────────────────── */
+
+typedef enum {
+    TREND_STAGE_COARSE = 0,
+    TREND_STAGE_FULL
+} trend_stage_t;
+
+/* ── Result set ────────────────────────────────────────────── */
+
+typedef struct {
+    int32_t              patient_id;    /* trend_db partition queried */
+    uint32_t             start_ts;
+    uint32_t             end_ts;
+    trend_stage_t        stage;
+    trend_downsample_t   ds[TREND_PARAM_COUNT];
+    trend_query_result_t param[TREND_PARAM_COUNT];
+    trend_nibp_result_t  nibp;
+    trend_alarm_result_t alarms;
+} trend_query_set_t;
+
+/** Result callback (LVGL thread). */
+typedef void (*trend_query_cb_t)(const trend_query_set_t *set,
+                                 void *user_data);
+
+/* ── API (LVGL thread) ─────────────────────────────────────── */
+
+/**
+ * Request all trend series for [start_ts, end_ts] of the patient bound to
+ * slot 0 (the trends screen's slot) at the time of the request.
+ * The window is shifted back to the last minute boundary; the result set
+ * carries the window actually queried.  Cancels any request in flight.
+ * @param max_points   Points per parameter (<= TREND_DB_MAX_POINTS).
+ * @param tier         Full-resolution tier; TREND_TIER_AUTO picks raw
+ *                     rows up to 2 h and 1-min rows beyond.
+ * @param progressive  true: COARSE then FULL callback; false: FULL only
+ *                     (periodic refresh of a view already on screen).
+ * @return Request ticket (non-zero).
+ */
+uint32_t trend_query_request(uint32_t start_ts, uint32_t end_ts,
+                             int max_points, trend_tier_t tier,
+                             bool progressive,
+                             trend_query_cb_t cb, void *user_data);
+
+/** Cancel the current request; its callbacks will not fire. */
+void trend_query_cancel(void);
+
+/**
+ * Select how a parameter is reduced to max_points (default TREND_DS_AVG).
+ * Takes effect from the next request.
+ */
+void trend_query_set_downsample(trend_param_t param, trend_downsample_t ds);
+
+/** Current downsampling mode of a parameter. */
+trend_downsample_t trend_query_get_downsample(trend_param_t param);
+
+/** Check whether a request is queued or running. */
+bool trend_query_busy(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TREND_QUERY_H */
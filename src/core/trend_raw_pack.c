@@ -0,0 +1,97 @@
+/**
+ * @file trend_raw_pack.c
+ * @brief Per-minute packing of 1 Hz vital samples
+ */
+
+#include "trend_raw_pack.h"
+
+/* ── Keys ────────────────────────────────────────────────── */
+
+uint32_t trend_raw_minute_key(uint32_t ts) {
+    /* Round up: (M - 60, M] -> M */
+    uint32_t rem = ts % TREND_RAW_SAMPLES;
+    return rem ? ts + (TREND_RAW_SAMPLES - rem) : ts;
+}
+
+int trend_raw_slot(uint32_t ts) {
+    return (TREND_RAW_SAMPLES - 1)
+           - (int)(trend_raw_minute_key(ts) - ts);
+}
+
+uint32_t trend_raw_slot_ts(uint32_t key, int slot) {
+    return key - (uint32_t)((TREND_RAW_SAMPLES - 1) - slot);
+}
+
+/* ── Minute buffer ───────────────────────────────────────── */
+
+void trend_raw_minute_reset(trend_raw_minute_t *m, uint32_t key) {
+    m->active = true;
+    m->minute_ts = key;
+    m->count = 0;
+    for (int c = 0; c < TREND_RAW_CHANNELS; c++) {
+        for (int i = 0; i < TREND_RAW_SAMPLES; i++) {
+            m->v[c][i] = TREND_RAW_MISSING;
+        }
+    }
+}
+
+static int16_t clamp16(int32_t x) {
+    if (x <= TREND_RAW_MISSING) return TREND_RAW_MISSING + 1;
+    if (x > INT16_MAX) return INT16_MAX;
+    return (int16_t)x;
+}
+
+void trend_raw_minute_put(trend_raw_minute_t *m, uint32_t ts,
+                          const int32_t values[TREND_RAW_CHANNELS]) {
+    int slot = trend_raw_slot(ts);
+    if (m->v[0][slot] == TREND_RAW_MISSING) m->count++;
+    for (int c = 0; c < TREND_RAW_CHANNELS; c++) {
+        m->v[c][slot] = clamp16(values[c]);
+    }
+}
+
+/* ── Blob encoding ───────────────────────────────────────── */
+
+void trend_raw_encode(const int16_t v[TREND_RAW_SAMPLES], uint8_t *out) {
+    for (int i = 0; i < TREND_RAW_SAMPLES; i++) {
+        uint16_t u = (uint16_t)v[i];
+        out[2 * i]     = (uint8_t)(u & 0xFF);
+        out[2 * i + 1] = (uint8_t)(u >> 8);
+    }
+}
+
+int trend_raw_decode(const void *blob, int bytes,
+                     int16_t v[TREND_RAW_SAMPLES]) {
+    const uint8_t *in = (const uint8_t *)blob;
+    int avail = (in && bytes > 0) ? bytes / 2 : 0;
+    int present = 0;
+
+    for (int i = 0; i < TREND_RAW_SAMPLES; i++) {
+        if (i < avail) {
+            v[i] = (int16_t)(uint16_t)(in[2 * i] | (in[2 * i + 1] << 8));
+            if (v[i] != TREND_RAW_MISSING) present++;
+        } else {
+            v[i] = TREND_RAW_MISSING;
+        }
+    }
+    return present;
+}
+
+trend_raw_stats_t trend_raw_channel_stats(const int16_t v[TREND_RAW_SAMPLES]) {
+    trend_raw_stats_t st = { 0, 0, INT16_MAX, INT16_MIN };
+    int32_t sum = 0;
+
+    for (int i = 0; i < TREND_RAW_SAMPLES; i++) {
+        if (v[i] == TREND_RAW_MISSING) continue;
+        sum += v[i];
+        if (v[i] < st.min) st.min = v[i];
+        if (v[i] > st.max) st.max = v[i];
+        st.n++;
+    }
+    if (st.n == 0) {
+        st.min = st.max = 0;
+        return st;
+    }
+    st.avg = sum / st.n;
+    return st;
+}
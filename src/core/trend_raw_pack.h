@@ -0,0 +1,97 @@
+/**
+ * @file trend_raw_pack.h
+ * @brief Per-minute packing of 1 Hz vital samples
+ *
+ * The raw trend tier stores one row per minute instead of one per second:
+ * each parameter's 60 samples are packed into a fixed 120-byte blob of
+ * little-endian int16 values, with TREND_RAW_MISSING marking seconds that
+ * had no sample.  Samples are collected in a trend_raw_minute_t buffer and
+ * written once when the minute completes.
+ *
+ * Minute keys follow the 1-min aggregate convention: key M covers the
+ * samples with timestamps (M - 60, M], so slot 0 is M - 59 and slot 59 is
+ * M itself.  The blob for key M therefore holds exactly the samples that
+ * trend_db_aggregate_minute(M) summarises.
+ *
+ * No LVGL or SQLite dependency.
+ */
+
+#ifndef TREND_RAW_PACK_H
+#define TREND_RAW_PACK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ── Constants ─────────────────────────────────────────────── */
+
+#define TREND_RAW_SAMPLES     60
+#define TREND_RAW_CHANNELS    4       /* HR, SpO2, RR, Temp x10 */
+#define TREND_RAW_BLOB_BYTES  (TREND_RAW_SAMPLES * 2)
+#define TREND_RAW_MISSING     INT16_MIN
+
+/* ── Types ─────────────────────────────────────────────────── */
+
+/** One minute of samples for all channels. */
+typedef struct {
+    bool     active;
+    uint32_t minute_ts;             /* Key: last second of the minute */
+    int      count;                 /* Seconds with a sample */
+    int16_t  v[TREND_RAW_CHANNELS][TREND_RAW_SAMPLES];
+} trend_raw_minute_t;
+
+/** Summary of one channel over a minute. */
+typedef struct {
+    int     n;                      /* Samples present (0 = no data) */
+    int32_t avg;                    /* Truncated mean */
+    int32_t min;
+    int32_t max;
+} trend_raw_stats_t;
+
+/* ── Keys ──────────────────────────────────────────────────── */
+
+/** Minute key (a multiple of 60) for a sample timestamp. */
+uint32_t trend_raw_minute_key(uint32_t ts);
+
+/** Slot (0..59) of a sample timestamp within its minute. */
+int trend_raw_slot(uint32_t ts);
+
+/** Timestamp of a slot within the minute `key`. */
+uint32_t trend_raw_slot_ts(uint32_t key, int slot);
+
+/* ── Minute buffer ─────────────────────────────────────────── */
+
+/** Start an empty minute for `key` (all slots missing). */
+void trend_raw_minute_reset(trend_raw_minute_t *m, uint32_t key);
+
+/**
+ * Store one sample (ts must map to m->minute_ts).  Values are clamped to
+ * the int16 range.  A repeated timestamp overwrites its slot.
+ */
+void trend_raw_minute_put(trend_raw_minute_t *m, uint32_t ts,
+                          const int32_t values[TREND_RAW_CHANNELS]);
+
+/* ── Blob encoding ─────────────────────────────────────────── */
+
+/** Pack one channel's 60 samples into TREND_RAW_BLOB_BYTES bytes. */
+void trend_raw_encode(const int16_t v[TREND_RAW_SAMPLES], uint8_t *out);
+
+/**
+ * Unpack a channel blob.  Short or missing blobs leave the remaining
+ * slots TREND_RAW_MISSING.
+ * @return Number of samples present.
+ */
+int trend_raw_decode(const void *blob, int bytes,
+                     int16_t v[TREND_RAW_SAMPLES]);
+
+/** Average/min/max of the samples present in one channel. */
+trend_raw_stats_t trend_raw_channel_stats(const int16_t v[TREND_RAW_SAMPLES]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TREND_RAW_PACK_H */
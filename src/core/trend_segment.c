@@ -0,0 +1,259 @@
+/**
+ * @file trend_segment.c
+ * @brief Compact binary segment format for moving trend history
+ */
+
+#include "trend_segment.h"
+#include "crc32.h"
+#include <string.h>
+
+#define SEG_MAGIC          "VMTS"
+#define SEG_SECTION_BYTES  10      /* id, cols, rows u32, bytes u32 */
+#define SEG_CRC_OFFSET     24
+
+/* ── Little-endian and varint helpers ────────────────────── */
+
+static void store_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void store_u32(uint8_t *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint16_t load_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t load_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t zigzag(int64_t d) {
+    return ((uint64_t)d << 1) ^ (uint64_t)(d >> 63);
+}
+
+static int64_t unzigzag(uint64_t z) {
+    return (int64_t)(z >> 1) ^ -(int64_t)(z & 1);
+}
+
+/* ── Writer ──────────────────────────────────────────────── */
+
+static bool reserve(trend_seg_writer_t *w, size_t n) {
+    if (w->overflow || w->pos + n > w->cap) {
+        w->overflow = true;
+        return false;
+    }
+    return true;
+}
+
+static void put_byte(trend_seg_writer_t *w, uint8_t b) {
+    if (reserve(w, 1)) w->buf[w->pos++] = b;
+}
+
+static void put_varint(trend_seg_writer_t *w, uint64_t v) {
+    while (v >= 0x80) {
+        put_byte(w, (uint8_t)(v | 0x80));
+        v >>= 7;
+    }
+    put_byte(w, (uint8_t)v);
+}
+
+static void end_section(trend_seg_writer_t *w) {
+    if (w->sec_start == 0) return;
+    if (!w->overflow) {
+        uint8_t *s = w->buf + w->sec_start;
+        store_u32(s + 2, w->rows);
+        store_u32(s + 6, (uint32_t)(w->pos - w->sec_start - SEG_SECTION_BYTES));
+    }
+    w->sec_start = 0;
+    w->sections++;
+}
+
+void trend_seg_writer_init(trend_seg_writer_t *w, uint8_t *buf, size_t cap) {
+    memset(w, 0, sizeof(*w));
+    w->buf = buf;
+    w->cap = cap;
+    w->pos = TREND_SEG_HEADER_BYTES;
+    w->overflow = (buf == NULL || cap < TREND_SEG_HEADER_BYTES);
+}
+
+bool trend_seg_begin_section(trend_seg_writer_t *w, uint8_t id, int cols) {
+    if (cols < 0 || cols > TREND_SEG_MAX_COLS) return false;
+    end_section(w);
+    if (!reserve(w, SEG_SECTION_BYTES)) return false;
+
+    w->sec_start = w->pos;
+    w->buf[w->pos]     = id;
+    w->buf[w->pos + 1] = (uint8_t)cols;
+    memset(w->buf + w->pos + 2, 0, 8);      /* rows, bytes: patched later */
+    w->pos += SEG_SECTION_BYTES;
+
+    w->rows = 0;
+    w->cols = cols;
+    memset(w->prev, 0, sizeof(w->prev));
+    return true;
+}
+
+void trend_seg_put_row(trend_seg_writer_t *w, const int64_t *values) {
+    if (w->sec_start == 0) return;
+    for (int c = 0; c < w->cols; c++) {
+        put_varint(w, zigzag((int64_t)((uint64_t)values[c] -
+                                       (uint64_t)w->prev[c])));
+        w->prev[c] = values[c];
+    }
+    w->rows++;
+}
+
+void trend_seg_put_bytes(trend_seg_writer_t *w, const void *data, size_t len) {
+    put_varint(w, len);
+    if (len > 0 && reserve(w, len)) {
+        memcpy(w->buf + w->pos, data, len);
+        w->pos += len;
+    }
+}
+
+void trend_seg_put_series(trend_seg_writer_t *w, const int16_t *v, int n) {
+    int32_t prev = 0;
+    for (int i = 0; i < n; i++) {
+        put_varint(w, zigzag((int64_t)v[i] - prev));
+        prev = v[i];
+    }
+}
+
+size_t trend_seg_finish(trend_seg_writer_t *w, int32_t patient_id,
+                        uint32_t first_ts, uint32_t last_ts) {
+    end_section(w);
+    if (w->overflow) return 0;
+
+    uint8_t *h = w->buf;
+    memcpy(h, SEG_MAGIC, 4);
+    store_u16(h + 4, TREND_SEG_VERSION);
+    store_u16(h + 6, w->sections);
+    store_u32(h + 8, (uint32_t)patient_id);
+    store_u32(h + 12, first_ts);
+    store_u32(h + 16, last_ts);
+    store_u32(h + 20, (uint32_t)(w->pos - TREND_SEG_HEADER_BYTES));
+
+    uint32_t crc = crc32_update(0, h, SEG_CRC_OFFSET);
+    crc = crc32_update(crc, h + TREND_SEG_HEADER_BYTES,
+                          w->pos - TREND_SEG_HEADER_BYTES);
+    store_u32(h + SEG_CRC_OFFSET, crc);
+    return w->pos;
+}
+
+/* ── Reader ──────────────────────────────────────────────── */
+
+static bool get_varint(trend_seg_reader_t *r, uint64_t *out) {
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (r->pos >= r->sec_end) break;
+        uint8_t b = r->buf[r->pos++];
+        v |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *out = v;
+            return true;
+        }
+    }
+    r->error = true;
+    return false;
+}
+
+bool trend_seg_reader_init(trend_seg_reader_t *r, const uint8_t *buf,
+                           size_t len, trend_seg_header_t *hdr) {
+    memset(r, 0, sizeof(*r));
+    r->error = true;
+    if (!buf || len < TREND_SEG_HEADER_BYTES) return false;
+    if (memcmp(buf, SEG_MAGIC, 4) != 0) return false;
+
+    uint16_t version = load_u16(buf + 4);
+    if (version == 0 || version > TREND_SEG_VERSION) return false;
+
+    uint32_t payload = load_u32(buf + 20);
+    if (payload > len - TREND_SEG_HEADER_BYTES) return false;
+
+    uint32_t crc = crc32_update(0, buf, SEG_CRC_OFFSET);
+    crc = crc32_update(crc, buf + TREND_SEG_HEADER_BYTES, payload);
+    if (crc != load_u32(buf + SEG_CRC_OFFSET)) return false;
+
+    if (hdr) {
+        hdr->sections      = load_u16(buf + 6);
+        hdr->patient_id    = (int32_t)load_u32(buf + 8);
+        hdr->first_ts      = load_u32(buf + 12);
+        hdr->last_ts       = load_u32(buf + 16);
+        hdr->payload_bytes = payload;
+    }
+    r->buf = buf;
+    r->len = TREND_SEG_HEADER_BYTES + payload;
+    r->pos = TREND_SEG_HEADER_BYTES;
+    r->sec_end = r->pos;
+    r->error = false;
+    return true;
+}
+
+bool trend_seg_next_section(trend_seg_reader_t *r, uint8_t *id, int *cols,
+                            uint32_t *rows) {
+    if (r->error) return false;
+    r->pos = r->sec_end;
+    if (r->pos >= r->len) return false;
+    if (r->len - r->pos < SEG_SECTION_BYTES) {
+        r->error = true;
+        return false;
+    }
+
+    const uint8_t *s = r->buf + r->pos;
+    uint32_t bytes = load_u32(s + 6);
+    if (s[1] > TREND_SEG_MAX_COLS ||
+        bytes > r->len - r->pos - SEG_SECTION_BYTES) {
+        r->error = true;
+        return false;
+    }
+    r->cols = s[1];
+    r->rows_left = load_u32(s + 2);
+    r->pos += SEG_SECTION_BYTES;
+    r->sec_end = r->pos + bytes;
+    memset(r->prev, 0, sizeof(r->prev));
+
+    *id = s[0];
+    *cols = r->cols;
+    *rows = r->rows_left;
+    return true;
+}
+
+bool trend_seg_get_row(trend_seg_reader_t *r, int64_t *values) {
+    if (r->error || r->rows_left == 0) return false;
+    for (int c = 0; c < r->cols; c++) {
+        uint64_t z;
+        if (!get_varint(r, &z)) return false;
+        r->prev[c] = (int64_t)((uint64_t)r->prev[c] + (uint64_t)unzigzag(z));
+        values[c] = r->prev[c];
+    }
+    r->rows_left--;
+    return true;
+}
+
+size_t trend_seg_get_bytes(trend_seg_reader_t *r, const uint8_t **data) {
+    uint64_t len;
+    *data = NULL;
+    if (r->error || !get_varint(r, &len)) return 0;
+    if (len > r->sec_end - r->pos) {
+        r->error = true;
+        return 0;
+    }
+    *data = r->buf + r->pos;
+    r->pos += (size_t)len;
+    return (size_t)len;
+}
+
+bool trend_seg_get_series(trend_seg_reader_t *r, int16_t *v, int n) {
+    int64_t prev = 0;
+    for (int i = 0; i < n; i++) {
+        uint64_t z;
+        if (r->error || !get_varint(r, &z)) return false;
+        prev += unzigzag(z);
+        v[i] = (int16_t)prev;
+    }
+    return true;
+}
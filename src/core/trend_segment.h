@@ -0,0 +1,147 @@
+/**
+ * @file trend_segment.h
+ * @brief Compact binary segment format for moving trend history
+ *
+ * A segment carries one patient's trend history between monitors (bed or
+ * ward transfer).  Layout, all integers little-endian:
+ *
+ *   header   "VMTS", version u16, section count u16, patient id i32,
+ *            first/last timestamp u32, payload length u32, CRC-32 u32
+ *   payload  sections, each: id u8, columns u8, rows u32, bytes u32,
+ *            then the rows
+ *
+ * Rows are a fixed number of integer columns, each stored as the zigzag
+ * varint of its difference from the same column in the previous row, so
+ * 1-minute timestamps and slowly changing vitals take about one byte per
+ * value.  A row may be followed by byte strings (older alarm text) and sample
+ * series (raw minutes, delta-coded sample to sample).  The section byte
+ * length lets a reader skip sections it does not know; the CRC covers the
+ * header fields before it and the whole payload.
+ *
+ * The writer fills a caller-supplied buffer and reports overflow instead
+ * of growing it.  No LVGL or SQLite dependency.
+ */
+
+#ifndef TREND_SEGMENT_H
+#define TREND_SEGMENT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ── Constants ─────────────────────────────────────────────── */
+
+#define TREND_SEG_VERSION       1
+#define TREND_SEG_HEADER_BYTES  28
+#define TREND_SEG_MAX_COLS      16
+
+/* Section identifiers (unknown ids are skipped on import) */
+typedef enum {
+    TREND_SEG_RAW    = 1,       /* minute_ts + 4 sample series */
+    TREND_SEG_1MIN   = 2,       /* minute_ts + 12 aggregate columns */
+    TREND_SEG_1HOUR  = 3,       /* hour_ts + 12 aggregate columns */
+    TREND_SEG_NIBP   = 4,       /* timestamp_s, sys, dia, map */
+    TREND_SEG_ALARM  = 5,       /* timestamp_s, severity + message bytes
+                                   (older builds; import only) */
+    TREND_SEG_ALARM_EVT = 6,    /* timestamp_s, param, severity, kind, value,
+                                   threshold, user_id, duration_s,
+                                   has_reading (absent in older segments) */
+} trend_seg_section_t;
+
+/* ── Types ─────────────────────────────────────────────────── */
+
+typedef struct {
+    int32_t  patient_id;
+    uint32_t first_ts;
+    uint32_t last_ts;
+    uint16_t sections;
+    uint32_t payload_bytes;
+} trend_seg_header_t;
+
+typedef struct {
+    uint8_t *buf;
+    size_t   cap;
+    size_t   pos;
+    bool     overflow;
+    uint16_t sections;
+    /* Open section */
+    size_t   sec_start;
+    uint32_t rows;
+    int      cols;
+    int64_t  prev[TREND_SEG_MAX_COLS];
+} trend_seg_writer_t;
+
+typedef struct {
+    const uint8_t *buf;
+    size_t   len;
+    size_t   pos;
+    bool     error;
+    /* Current section */
+    size_t   sec_end;
+    uint32_t rows_left;
+    int      cols;
+    int64_t  prev[TREND_SEG_MAX_COLS];
+} trend_seg_reader_t;
+
+/* ── Writer ────────────────────────────────────────────────── */
+
+/** Start a segment in `buf`; space for the header is reserved. */
+void trend_seg_writer_init(trend_seg_writer_t *w, uint8_t *buf, size_t cap);
+
+/** Open a section of `cols` integer columns (closes any open one). */
+bool trend_seg_begin_section(trend_seg_writer_t *w, uint8_t id, int cols);
+
+/** Append a row of `cols` values to the open section. */
+void trend_seg_put_row(trend_seg_writer_t *w, const int64_t *values);
+
+/** Append a length-prefixed byte string to the current row. */
+void trend_seg_put_bytes(trend_seg_writer_t *w, const void *data, size_t len);
+
+/** Append `n` int16 samples, each coded as a delta from the previous one. */
+void trend_seg_put_series(trend_seg_writer_t *w, const int16_t *v, int n);
+
+/**
+ * Close the open section and write the header.
+ * @return Total segment length, or 0 if the buffer overflowed.
+ */
+size_t trend_seg_finish(trend_seg_writer_t *w, int32_t patient_id,
+                        uint32_t first_ts, uint32_t last_ts);
+
+/* ── Reader ────────────────────────────────────────────────── */
+
+/**
+ * Validate magic, version, length and CRC.  Nothing is read from an
+ * invalid segment.
+ */
+bool trend_seg_reader_init(trend_seg_reader_t *r, const uint8_t *buf,
+                           size_t len, trend_seg_header_t *hdr);
+
+/**
+ * Advance to the next section (skipping any unread rows of the current
+ * one).  False at the end of the payload or on a malformed section.
+ */
+bool trend_seg_next_section(trend_seg_reader_t *r, uint8_t *id, int *cols,
+                            uint32_t *rows);
+
+/** Read the next row of the current section into `values[cols]`. */
+bool trend_seg_get_row(trend_seg_reader_t *r, int64_t *values);
+
+/**
+ * Read a byte string of the current row.  *data points into the segment
+ * buffer (not NUL-terminated).  @return Length; a malformed string
+ * returns 0 and sets r->error.
+ */
+size_t trend_seg_get_bytes(trend_seg_reader_t *r, const uint8_t **data);
+
+/** Read `n` samples written by trend_seg_put_series(). */
+bool trend_seg_get_series(trend_seg_reader_t *r, int16_t *v, int n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TREND_SEGMENT_H */
@@ -0,0 +1,527 @@
+/**
+ * @file trend_viewport.c
+ * @brief Zoomable, pannable trend window — tile store and renderer
+ *
+ * Positions are computed in 64-bit signed chart points relative to the
+ * window start, so samples of a tile partly off screen clip cleanly.
+ * Rendering walks tiles in priority order and lets each one paint only
+ * the chart points no earlier tile's window covers: a tile of the current
+ * span always wins over the stretched samples of an older zoom level.
+ */
+
+#include "trend_viewport.h"
+#include "mem_budget.h"
+#include <string.h>
+
+/* ── Internal types ──────────────────────────────────────── */
+
+typedef struct {
+    uint32_t           bucket_s;
+    int                count;
+    trend_downsample_t ds;
+    uint32_t           ts[TREND_VIEWPORT_POINTS];
+    int16_t            value[TREND_VIEWPORT_POINTS];  /* All fit; temp x10 */
+} tile_series_t;
+
+typedef struct {
+    bool                  valid;
+    bool                  expired;
+    uint32_t              start_ts;
+    uint32_t              end_ts;
+    trend_stage_t         stage;
+    uint32_t              fetched_at;   /* Viewport clock when stored */
+    uint32_t              last_used;
+    tile_series_t         param[TREND_PARAM_COUNT];
+    int                   nibp_count;
+    uint32_t              nibp_ts[TREND_VIEWPORT_POINTS];
+    int16_t               sys[TREND_VIEWPORT_POINTS];
+    int16_t               dia[TREND_VIEWPORT_POINTS];
+    int                   mark_count;
+    trend_viewport_mark_t marks[TREND_VIEWPORT_TILE_MARKS];
+} tile_t;
+
+/* Zoom levels a gesture settles on (all whole minutes) */
+static const uint32_t zoom_levels[] = {
+    600, 900, 1800, 3600, 7200, 14400, 28800, 43200, 86400, 172800, 259200
+};
+#define ZOOM_LEVEL_COUNT  (int)(sizeof(zoom_levels) / sizeof(zoom_levels[0]))
+
+/* ── Module state ────────────────────────────────────────── */
+
+static uint32_t span_s   = TREND_RANGE_1H;
+static uint32_t end_ts   = TREND_RANGE_1H;
+static uint32_t now_ts   = 0;
+static bool     live     = true;
+static bool     settled  = true;        /* span_s is a zoom level */
+static int32_t  patient  = 0;
+
+static tile_t   tiles[TREND_VIEWPORT_TILES];
+static uint32_t use_clock = 0;
+
+/* Scratch for one render */
+static bool     owned[TREND_VIEWPORT_POINTS];
+
+MEM_BUDGET_ASSERT(trend_viewport, sizeof(tiles) + sizeof(owned),
+                  MEM_BUDGET_TREND_VIEWPORT);
+
+/* ── Window ──────────────────────────────────────────────── */
+
+/** Keep the window inside the last MAX_SPAN_S; live pins it to now. */
+static void clamp_window(void) {
+    uint32_t upper = (now_ts > span_s) ? now_ts : span_s;
+    uint32_t lower = (now_ts > TREND_VIEWPORT_MAX_SPAN_S)
+                     ? now_ts - TREND_VIEWPORT_MAX_SPAN_S + span_s : span_s;
+    if (lower > upper) lower = upper;
+
+    if (live || end_ts > upper) end_ts = upper;
+    if (end_ts < lower) end_ts = lower;
+    live = (end_ts == upper);
+}
+
+static uint32_t clamp_span(uint32_t s) {
+    if (s < TREND_VIEWPORT_MIN_SPAN_S) return TREND_VIEWPORT_MIN_SPAN_S;
+    if (s > TREND_VIEWPORT_MAX_SPAN_S) return TREND_VIEWPORT_MAX_SPAN_S;
+    return s;
+}
+
+/** Place a window of the current span starting at `start` (may be < 0). */
+static void set_start(int64_t start) {
+    if (start < 0) start = 0;
+    end_ts = (uint32_t)(start + span_s);
+    live = false;
+    clamp_window();
+}
+
+void trend_viewport_reset(uint32_t span, uint32_t now) {
+    span_s  = clamp_span(span);
+    now_ts  = now;
+    live    = true;
+    settled = true;
+    clamp_window();
+}
+
+void trend_viewport_set_now(uint32_t now) {
+    now_ts = now;
+    clamp_window();
+}
+
+void trend_viewport_set_patient(int32_t patient_id) {
+    if (patient_id == patient) return;
+    patient = patient_id;
+    memset(tiles, 0, sizeof(tiles));
+}
+
+void trend_viewport_pan(int32_t delta_s) {
+    if (delta_s == 0) return;
+    set_start((int64_t)end_ts - span_s + delta_s);
+}
+
+void trend_viewport_zoom(uint32_t span, uint32_t anchor_ts) {
+    span = clamp_span(span);
+    if (span == span_s) return;
+    settled = false;
+
+    if (live) {
+        span_s = span;
+        clamp_window();
+        return;
+    }
+    int64_t start = (int64_t)end_ts - span_s;
+    int64_t from_start = (int64_t)anchor_ts - start;
+    int64_t new_start = (int64_t)anchor_ts - from_start * span / span_s;
+    span_s = span;
+    set_start(new_start);
+}
+
+uint32_t trend_viewport_settle(void) {
+    /* Nearest level by ratio: a/b < c/d  <=>  a*d < c*b */
+    int best = 0;
+    uint64_t best_hi = 0, best_lo = 1;
+    for (int i = 0; i < ZOOM_LEVEL_COUNT; i++) {
+        uint64_t hi = zoom_levels[i] > span_s ? zoom_levels[i] : span_s;
+        uint64_t lo = zoom_levels[i] > span_s ? span_s : zoom_levels[i];
+        if (i == 0 || hi * best_lo < best_hi * lo) {
+            best = i;
+            best_hi = hi;
+            best_lo = lo;
+        }
+    }
+
+    uint32_t level = zoom_levels[best];
+    settled = true;
+    if (level != span_s) {
+        if (live) {
+            span_s = level;
+            clamp_window();
+        } else {
+            int64_t centre = (int64_t)end_ts - span_s / 2;
+            span_s = level;
+            set_start(centre - level / 2);
+        }
+    }
+    return span_s;
+}
+
+void trend_viewport_get_window(uint32_t *start, uint32_t *end) {
+    if (start) *start = end_ts - span_s;
+    if (end)   *end   = end_ts;
+}
+
+uint32_t trend_viewport_span(void) {
+    return span_s;
+}
+
+bool trend_viewport_is_live(void) {
+    return live;
+}
+
+/* ── Tiers ───────────────────────────────────────────────── */
+
+trend_tier_t trend_viewport_tier(uint32_t span, uint32_t start_ts,
+                                 uint32_t now) {
+    uint32_t raw_floor = (now > TREND_DB_RAW_RETAIN_S)
+                         ? now - TREND_DB_RAW_RETAIN_S : 0;
+
+    if (span < 60u * TREND_VIEWPORT_POINTS && start_ts >= raw_floor) {
+        return TREND_TIER_RAW;
+    }
+    if (span < 3600u * TREND_VIEWPORT_POINTS) return TREND_TIER_1MIN;
+    return TREND_TIER_1HOUR;
+}
+
+/**
+ * Points to request so the tier's buckets cover the whole tile: the
+ * bucket width is rounded down to whole rows, so asking for
+ * TREND_VIEWPORT_POINTS over 1 h of raw rows would give 7 s buckets and
+ * leave the last 4 minutes out.  Every zoom level divides evenly.
+ */
+static int tile_points(uint32_t span, trend_tier_t tier) {
+    uint32_t base_s = (tier == TREND_TIER_RAW)  ? 1u :
+                      (tier == TREND_TIER_1MIN) ? 60u : 3600u;
+    uint32_t rows = span / base_s;
+    uint32_t group = (rows + TREND_VIEWPORT_POINTS - 1) /
+                     TREND_VIEWPORT_POINTS;
+    if (group == 0) return 1;
+    return (int)(rows / group);
+}
+
+/* ── Tiles ───────────────────────────────────────────────── */
+
+static tile_t *find_tile(uint32_t start, uint32_t end) {
+    for (int i = 0; i < TREND_VIEWPORT_TILES; i++) {
+        if (tiles[i].valid && tiles[i].start_ts == start &&
+            tiles[i].end_ts == end) {
+            return &tiles[i];
+        }
+    }
+    return NULL;
+}
+
+static bool tile_stale(const tile_t *t) {
+    if (t->expired) return true;
+    return t->end_ts > t->fetched_at &&
+           now_ts >= t->fetched_at + TREND_VIEWPORT_REFRESH_S;
+}
+
+static bool in_window(const tile_t *t) {
+    return t->start_ts < end_ts && t->end_ts > end_ts - span_s;
+}
+
+/** Free slot, else the least useful tile: other spans, off screen, oldest. */
+static tile_t *victim(void) {
+    tile_t *best = NULL;
+    int best_rank = 0;
+    for (int i = 0; i < TREND_VIEWPORT_TILES; i++) {
+        tile_t *t = &tiles[i];
+        if (!t->valid) return t;
+        int rank = (t->end_ts - t->start_ts == span_s ? 2 : 0) +
+                   (in_window(t) ? 1 : 0);
+        if (!best || rank < best_rank ||
+            (rank == best_rank && t->last_used < best->last_used)) {
+            best = t;
+            best_rank = rank;
+        }
+    }
+    return best;
+}
+
+bool trend_viewport_next_fetch(trend_viewport_fetch_t *out) {
+    if (!settled) return false;
+
+    uint32_t start = end_ts - span_s;
+    uint32_t k0 = start / span_s;
+    uint32_t k1 = (end_ts - 1) / span_s;
+    uint32_t floor_ts = (now_ts > TREND_VIEWPORT_MAX_SPAN_S)
+                        ? now_ts - TREND_VIEWPORT_MAX_SPAN_S : 0;
+
+    /* Window first, then the neighbours either side */
+    uint32_t cand[4];
+    bool     vis[4];
+    int      n = 0;
+    for (uint32_t k = k0; k <= k1 && n < 2; k++) {
+        cand[n] = k;
+        vis[n++] = true;
+    }
+    if (k0 > 0 && k0 * span_s > floor_ts) {
+        cand[n] = k0 - 1;
+        vis[n++] = false;
+    }
+    if ((k1 + 1) * span_s < now_ts) {
+        cand[n] = k1 + 1;
+        vis[n++] = false;
+    }
+
+    for (int i = 0; i < n; i++) {
+        uint32_t s = cand[i] * span_s;
+        if (s > now_ts) continue;
+        const tile_t *t = find_tile(s, s + span_s);
+        if (t && t->stage == TREND_STAGE_FULL && !tile_stale(t)) continue;
+
+        out->start_ts = s;
+        out->end_ts   = s + span_s;
+        out->tier     = trend_viewport_tier(span_s, s, now_ts);
+        out->points   = tile_points(span_s, out->tier);
+        out->visible  = vis[i];
+        out->refresh  = (t && t->stage == TREND_STAGE_FULL);
+        return true;
+    }
+    return false;
+}
+
+void trend_viewport_store(const trend_query_set_t *set) {
+    if (set->patient_id != patient || set->end_ts <= set->start_ts) return;
+
+    tile_t *t = find_tile(set->start_ts, set->end_ts);
+    if (t && t->stage == TREND_STAGE_FULL &&
+        set->stage == TREND_STAGE_COARSE) {
+        return;
+    }
+    if (!t) t = victim();
+
+    t->valid      = true;
+    t->expired    = false;
+    t->start_ts   = set->start_ts;
+    t->end_ts     = set->end_ts;
+    t->stage      = set->stage;
+    t->fetched_at = now_ts;
+    t->last_used  = ++use_clock;
+
+    for (int p = 0; p < TREND_PARAM_COUNT; p++) {
+        const trend_query_result_t *r = &set->param[p];
+        tile_series_t *ts = &t->param[p];
+        ts->bucket_s = r->bucket_s ? r->bucket_s : 1;
+        ts->ds       = set->ds[p];
+        ts->count    = r->count;
+        for (int i = 0; i < r->count; i++) {
+            ts->ts[i]    = r->timestamp_s[i];
+            ts->value[i] = (int16_t)r->value[i];
+        }
+    }
+
+    t->nibp_count = set->nibp.count;
+    for (int i = 0; i < set->nibp.count; i++) {
+        t->nibp_ts[i] = set->nibp.timestamp_s[i];
+        t->sys[i]     = (int16_t)set->nibp.sys[i];
+        t->dia[i]     = (int16_t)set->nibp.dia[i];
+    }
+
+    /* Mark where alarms sounded, not acks, silences or clears */
+    t->mark_count = 0;
+    for (int i = 0; i < set->alarms.count &&
+                    t->mark_count < TREND_VIEWPORT_TILE_MARKS; i++) {
+        uint8_t kind = set->alarms.kind[i];
+        if (kind != ALARM_EVT_ONSET && kind != ALARM_EVT_ESCALATE &&
+            kind != ALARM_EVT_REALERT) {
+            continue;
+        }
+        t->marks[t->mark_count].timestamp_s = set->alarms.timestamp_s[i];
+        t->marks[t->mark_count].severity    = set->alarms.severity[i];
+        t->mark_count++;
+    }
+}
+
+void trend_viewport_expire(void) {
+    for (int i = 0; i < TREND_VIEWPORT_TILES; i++) tiles[i].expired = true;
+}
+
+/* ── Rendering ───────────────────────────────────────────── */
+
+/** Chart point of `ts`; negative or >= points when off screen. */
+static int64_t to_point(uint32_t ts, int points) {
+    int64_t num = ((int64_t)ts - (int64_t)(end_ts - span_s)) * points;
+    return num >= 0 ? num / span_s : -((-num + span_s - 1) / span_s);
+}
+
+/**
+ * Valid tiles in paint order: current span at full resolution, then its
+ * coarse previews, then other spans finest first; newest first within.
+ */
+static int render_order(const tile_t **order) {
+    int n = 0;
+    int rank[TREND_VIEWPORT_TILES];
+    for (int i = 0; i < TREND_VIEWPORT_TILES; i++) {
+        const tile_t *t = &tiles[i];
+        if (!t->valid || !in_window(t)) continue;
+        int r = (t->end_ts - t->start_ts == span_s ? 0 : 2) +
+                (t->stage == TREND_STAGE_FULL ? 0 : 1);
+
+        int j = n++;
+        while (j > 0) {
+            const tile_t *o = order[j - 1];
+            uint32_t ts_span = t->end_ts - t->start_ts;
+            uint32_t os_span = o->end_ts - o->start_ts;
+            bool before = r < rank[j - 1] ||
+                          (r == rank[j - 1] &&
+                           (ts_span < os_span ||
+                            (ts_span == os_span &&
+                             t->last_used > o->last_used)));
+            if (!before) break;
+            order[j] = order[j - 1];
+            rank[j] = rank[j - 1];
+            j--;
+        }
+        order[j] = t;
+        rank[j] = r;
+    }
+    return n;
+}
+
+/** Mark a tile's window as painted so later tiles leave it alone. */
+static void claim(const tile_t *t, int points) {
+    int64_t q0 = to_point(t->start_ts, points);
+    int64_t q1 = to_point(t->end_ts, points);
+    if (q0 < 0) q0 = 0;
+    if (q1 > points) q1 = points;
+    for (int64_t p = q0; p < q1; p++) owned[p] = true;
+}
+
+static void put(int32_t *y, int points, int64_t p, int32_t v) {
+    if (p >= 0 && p < points && !owned[p]) y[p] = v;
+}
+
+/**
+ * LTTB: real samples, joined by interpolation unless more than two
+ * buckets apart (a gap in the data).  The first and last sample are held
+ * to the tile edge when that close to it, so adjacent tiles meet.
+ */
+static void paint_lttb(const tile_t *t, const tile_series_t *s,
+                       int32_t *y, int points) {
+    uint32_t gap = 2 * s->bucket_s;
+    int64_t prev_p = 0;
+
+    for (int i = 0; i < s->count; i++) {
+        int64_t p = to_point(s->ts[i], points);
+        int32_t v = s->value[i];
+
+        if (i == 0) {
+            if (s->ts[0] >= t->start_ts && s->ts[0] - t->start_ts <= gap) {
+                int64_t q = to_point(t->start_ts, points);
+                for (int64_t x = q < 0 ? 0 : q; x < p && x < points; x++) {
+                    put(y, points, x, v);
+                }
+            }
+        } else if (s->ts[i] - s->ts[i - 1] <= gap && p > prev_p) {
+            int32_t v0 = s->value[i - 1];
+            int64_t x = prev_p + 1 < 0 ? 0 : prev_p + 1;
+            for (; x < p && x < points; x++) {
+                put(y, points, x, v0 + (int32_t)((int64_t)(v - v0) *
+                                                 (x - prev_p) / (p - prev_p)));
+            }
+        }
+        put(y, points, p, v);
+        prev_p = p;
+    }
+
+    if (s->count > 0) {
+        uint32_t edge = t->end_ts < t->fetched_at ? t->end_ts : t->fetched_at;
+        uint32_t last = s->ts[s->count - 1];
+        if (edge > last && edge - last <= gap) {
+            int64_t q = to_point(edge, points);
+            for (int64_t x = prev_p + 1 < 0 ? 0 : prev_p + 1;
+                 x < q && x < points; x++) {
+                put(y, points, x, s->value[s->count - 1]);
+            }
+        }
+    }
+}
+
+/** AVG: each bucket spans bucket_s seconds from its start. */
+static void paint_avg(const tile_series_t *s, int32_t *y, int points) {
+    for (int i = 0; i < s->count; i++) {
+        int64_t p0 = to_point(s->ts[i], points);
+        int64_t p1 = to_point(s->ts[i] + s->bucket_s, points);
+        if (p1 <= p0) p1 = p0 + 1;
+        if (p1 <= 0 || p0 >= points) continue;
+        for (int64_t x = p0 < 0 ? 0 : p0; x < p1 && x < points; x++) {
+            put(y, points, x, s->value[i]);
+        }
+    }
+}
+
+void trend_viewport_render(trend_param_t param, int32_t *y, int points,
+                           int32_t none) {
+    if (points > TREND_VIEWPORT_POINTS) points = TREND_VIEWPORT_POINTS;
+    for (int i = 0; i < points; i++) y[i] = none;
+    if (param < 0 || param >= TREND_PARAM_COUNT || points <= 0) return;
+
+    const tile_t *order[TREND_VIEWPORT_TILES];
+    int n = render_order(order);
+    memset(owned, 0, sizeof(owned));
+
+    for (int i = 0; i < n; i++) {
+        const tile_series_t *s = &order[i]->param[param];
+        if (s->ds == TREND_DS_LTTB) {
+            paint_lttb(order[i], s, y, points);
+        } else {
+            paint_avg(s, y, points);
+        }
+        claim(order[i], points);
+    }
+}
+
+void trend_viewport_render_nibp(int32_t *sys, int32_t *dia, int points,
+                                int32_t none) {
+    if (points > TREND_VIEWPORT_POINTS) points = TREND_VIEWPORT_POINTS;
+    for (int i = 0; i < points; i++) {
+        sys[i] = none;
+        dia[i] = none;
+    }
+
+    const tile_t *order[TREND_VIEWPORT_TILES];
+    int n = render_order(order);
+    memset(owned, 0, sizeof(owned));
+
+    for (int i = 0; i < n; i++) {
+        const tile_t *t = order[i];
+        for (int j = 0; j < t->nibp_count; j++) {
+            int64_t p = to_point(t->nibp_ts[j], points);
+            if (p < 0 || p >= points || owned[p]) continue;
+            sys[p] = t->sys[j];
+            dia[p] = t->dia[j];
+        }
+        claim(t, points);
+    }
+}
+
+int trend_viewport_marks(trend_viewport_mark_t *out, int max) {
+    const tile_t *order[TREND_VIEWPORT_TILES];
+    int n = render_order(order);
+    uint32_t start = end_ts - span_s;
+    int count = 0;
+
+    for (int i = 0; i < n; i++) {
+        const tile_t *t = order[i];
+        for (int j = 0; j < t->mark_count && count < max; j++) {
+            uint32_t ts = t->marks[j].timestamp_s;
+            if (ts < start || ts >= end_ts) continue;
+
+            /* Leave it to the earlier tile that covers it */
+            bool covered = false;
+            for (int k = 0; k < i && !covered; k++) {
+                covered = ts >= order[k]->start_ts && ts < order[k]->end_ts;
+            }
+            if (!covered) out[count++] = t->marks[j];
+        }
+    }
+    return count;
+}
@@ -0,0 +1,166 @@
+/**
+ * @file trend_viewport.h
+ * @brief Zoomable, pannable trend window backed by cached query tiles
+ *
+ * The trends screen shows one time window of up to 72 hours.  The user
+ * drags it along the history and zooms it in or out; every frame of the
+ * gesture is drawn from samples already in memory, never from SQLite.
+ *
+ * Tiles: history is cut into windows of the current span aligned to
+ * multiples of the span ([k * span, (k + 1) * span]).  A view touches at
+ * most two tiles.  Each tile is fetched once through trend_query (on a
+ * worker) and kept here as compact samples; up to TREND_VIEWPORT_TILES
+ * are held.  trend_viewport_render() maps whatever tiles cover the
+ * window onto chart points: tiles of the current span at full resolution
+ * first, then their coarse previews, then tiles of earlier zoom levels.
+ * After a zoom the old samples are stretched to the new window until the
+ * new tiles arrive.
+ *
+ * Fetch order (trend_viewport_next_fetch): the tiles under the window,
+ * then the neighbours either side, so a pan onto them is already loaded.
+ * Tiles that ended in the future when fetched are refetched every
+ * TREND_VIEWPORT_REFRESH_S while on screen.
+ *
+ * Tier per tile: the coarsest storage tier that still gives every chart
+ * point its own source row (raw below 8 h spans, 1-minute rows above),
+ * falling back to 1-minute rows where raw samples have aged out.
+ *
+ * While the window's right edge is at "now" the view is live and follows
+ * new data; panning back leaves live mode, panning to the end rejoins it.
+ *
+ * Tiles take about 95 KB of static memory.
+ *
+ * Pure logic: no LVGL.  Single-threaded: call from the LVGL thread.
+ */
+
+#ifndef TREND_VIEWPORT_H
+#define TREND_VIEWPORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "trend_db.h"
+#include "trend_query.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ── Constants ─────────────────────────────────────────────── */
+
+#define TREND_VIEWPORT_POINTS       TREND_DB_MAX_POINTS   /* Per tile */
+#define TREND_VIEWPORT_MIN_SPAN_S   (10u * 60u)
+#define TREND_VIEWPORT_MAX_SPAN_S   (72u * 3600u)
+#define TREND_VIEWPORT_TILES        6
+#define TREND_VIEWPORT_TILE_MARKS   32      /* Alarm markers per tile */
+#define TREND_VIEWPORT_REFRESH_S    10
+
+/* ── Types ─────────────────────────────────────────────────── */
+
+/** One tile to fetch. */
+typedef struct {
+    uint32_t     start_ts;
+    uint32_t     end_ts;
+    trend_tier_t tier;          /* Full-resolution tier for this tile */
+    int          points;        /* Whole buckets that exactly cover it */
+    bool         visible;       /* Under the window (not a prefetch) */
+    bool         refresh;       /* Held at full resolution; new data only */
+} trend_viewport_fetch_t;
+
+/** An alarm that sounded (onset, escalation or re-alert) in the window. */
+typedef struct {
+    uint32_t timestamp_s;
+    uint8_t  severity;          /* alarm_severity_t */
+} trend_viewport_mark_t;
+
+/* ── Window (LVGL thread) ──────────────────────────────────── */
+
+/** Live window of `span_s` ending at `now_ts`.  Held tiles are kept. */
+void trend_viewport_reset(uint32_t span_s, uint32_t now_ts);
+
+/** Advance the clock; a live window moves with it. */
+void trend_viewport_set_now(uint32_t now_ts);
+
+/**
+ * Show `patient_id`'s history.  Tiles of any other patient are dropped
+ * and their results ignored from then on.
+ */
+void trend_viewport_set_patient(int32_t patient_id);
+
+/** Move the window by `delta_s` (positive: later), within the history. */
+void trend_viewport_pan(int32_t delta_s);
+
+/**
+ * Change the span (clamped to MIN/MAX_SPAN_S) keeping `anchor_ts` at the
+ * same position on screen; a live window keeps its end at "now" instead.
+ * Any span is allowed during a gesture.
+ */
+void trend_viewport_zoom(uint32_t span_s, uint32_t anchor_ts);
+
+/**
+ * End of gesture: snap the span to the nearest zoom level, keeping the
+ * window's centre (or its end, when live).
+ * @return The new span.
+ */
+uint32_t trend_viewport_settle(void);
+
+/** Current window. */
+void trend_viewport_get_window(uint32_t *start_ts, uint32_t *end_ts);
+
+uint32_t trend_viewport_span(void);
+bool     trend_viewport_is_live(void);
+
+/* ── Tiers ─────────────────────────────────────────────────── */
+
+/**
+ * Tier for a tile of `span_s` starting at `start_ts`, given the current
+ * time: raw when 1-minute rows would leave chart points empty and the
+ * tile is within raw retention, else 1-minute, else hourly.
+ */
+trend_tier_t trend_viewport_tier(uint32_t span_s, uint32_t start_ts,
+                                 uint32_t now_ts);
+
+/* ── Tiles ─────────────────────────────────────────────────── */
+
+/**
+ * Next tile worth fetching, or false when the window and its neighbours
+ * are held at full resolution and up to date (or a gesture has not been
+ * settled yet).
+ */
+bool trend_viewport_next_fetch(trend_viewport_fetch_t *out);
+
+/**
+ * Keep a trend_query result as the tile it covers.  COARSE results never
+ * replace a tile held at full resolution.
+ */
+void trend_viewport_store(const trend_query_set_t *set);
+
+/**
+ * Refetch every tile, still drawing the held samples until the new ones
+ * arrive (e.g. after a downsampling mode change).
+ */
+void trend_viewport_expire(void);
+
+/* ── Rendering (no queries) ────────────────────────────────── */
+
+/**
+ * Map a parameter onto `points` chart points spanning the window.
+ * Points with no data are set to `none`.
+ */
+void trend_viewport_render(trend_param_t param, int32_t *y, int points,
+                           int32_t none);
+
+/** NIBP systolic/diastolic onto `points` chart points (sparse). */
+void trend_viewport_render_nibp(int32_t *sys, int32_t *dia, int points,
+                                int32_t none);
+
+/**
+ * Alarm markers inside the window, each from one tile only.
+ * @return Number written (at most `max`).
+ */
+int trend_viewport_marks(trend_viewport_mark_t *out, int max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TREND_VIEWPORT_H */
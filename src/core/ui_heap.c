@@ -0,0 +1,244 @@
+/**
+ * @file ui_heap.c
+ * @brief LVGL heap — tag accounting and arena routing over tlsf
+ *
+ * An arena is a block of the pool tagged UI_HEAP_TAG_ARENA with its own
+ * tlsf_t inside.  Frees find their allocator by address: the pool unless
+ * the block lies in an arena, a range check per slot.
+ */
+
+#include "ui_heap.h"
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#define UI_HEAP_TAG_ARENA   0xFFFF  /* The arena regions themselves */
+
+typedef struct {
+    bool     in_use;
+    bool     open;
+    uint16_t tag;
+    void    *mem;                   /* Block of the pool */
+    tlsf_t   tlsf;
+} arena_t;
+
+/* ── Module state ────────────────────────────────────────── */
+
+static pthread_mutex_t     lock = PTHREAD_MUTEX_INITIALIZER;
+static tlsf_t              pool;
+static uint16_t            cur_tag = UI_HEAP_TAG_SHARED;
+static ui_heap_tag_stats_t tags[UI_HEAP_MAX_TAGS];
+static arena_t             arenas[UI_HEAP_MAX_ARENAS];
+static uint32_t            arenas_opened = 0;
+static uint32_t            arenas_released = 0;
+static uint32_t            arenas_failed = 0;
+
+/* ── Helpers (under lock) ────────────────────────────────── */
+
+static arena_t *open_arena_of(uint16_t tag) {
+    for (int i = 0; i < UI_HEAP_MAX_ARENAS; i++) {
+        if (arenas[i].in_use && arenas[i].open && arenas[i].tag == tag) {
+            return &arenas[i];
+        }
+    }
+    return NULL;
+}
+
+/** Allocator holding `p`: an arena's or the pool's. */
+static tlsf_t *owner_of(const void *p, arena_t **arena) {
+    for (int i = 0; i < UI_HEAP_MAX_ARENAS; i++) {
+        if (arenas[i].in_use && tlsf_owns(&arenas[i].tlsf, p)) {
+            *arena = &arenas[i];
+            return &arenas[i].tlsf;
+        }
+    }
+    *arena = NULL;
+    return &pool;
+}
+
+static void release_if_drained(arena_t *a) {
+    if (!a || a->open || a->tlsf.used_blocks > 0) return;
+    tlsf_free(&pool, a->mem);
+    memset(a, 0, sizeof(*a));
+    arenas_released++;
+}
+
+static void account(uint16_t tag, size_t before, size_t after, int blocks) {
+    if (tag >= UI_HEAP_MAX_TAGS) return;
+    ui_heap_tag_stats_t *s = &tags[tag];
+    s->bytes = s->bytes - before + after;
+    s->blocks = (uint32_t)((int)s->blocks + blocks);
+    if (s->bytes > s->peak) s->peak = s->bytes;
+}
+
+static void *alloc_tagged(uint16_t tag, size_t size) {
+    void *p = NULL;
+    arena_t *a = open_arena_of(tag);
+    if (a) {
+        p = tlsf_malloc(&a->tlsf, size, tag);
+        if (!p && tag < UI_HEAP_MAX_TAGS) tags[tag].spilled++;
+    }
+    if (!p) p = tlsf_malloc(&pool, size, tag);
+    if (p) account(tag, 0, tlsf_size_of(p), 1);
+    return p;
+}
+
+static void free_locked(void *p) {
+    arena_t *a;
+    tlsf_t *t = owner_of(p, &a);
+    account(tlsf_tag_of(p), tlsf_size_of(p), 0, -1);
+    tlsf_free(t, p);
+    release_if_drained(a);
+}
+
+/* ── Public API ──────────────────────────────────────────── */
+
+bool ui_heap_init(void *mem, size_t bytes) {
+    pthread_mutex_lock(&lock);
+    memset(tags, 0, sizeof(tags));
+    memset(arenas, 0, sizeof(arenas));
+    cur_tag = UI_HEAP_TAG_SHARED;
+    arenas_opened = arenas_released = arenas_failed = 0;
+    bool ok = tlsf_init(&pool, mem, bytes);
+    pthread_mutex_unlock(&lock);
+    if (!ok) printf("[ui_heap] Pool of %zu bytes unusable\n", bytes);
+    return ok;
+}
+
+void *ui_heap_alloc(size_t size) {
+    pthread_mutex_lock(&lock);
+    void *p = alloc_tagged(cur_tag, size);
+    pthread_mutex_unlock(&lock);
+    return p;
+}
+
+void *ui_heap_realloc(void *p, size_t size) {
+    if (!p) return ui_heap_alloc(size);
+    if (size == 0) {
+        ui_heap_free(p);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&lock);
+    arena_t *a;
+    tlsf_t *t = owner_of(p, &a);
+    uint16_t tag = tlsf_tag_of(p);
+    size_t before = tlsf_size_of(p);
+
+    void *q = tlsf_realloc(t, p, size);
+    if (q) {
+        account(tag, before, tlsf_size_of(q), 0);
+    } else {
+        /* The block's own allocator is full: move to wherever its tag goes */
+        q = alloc_tagged(tag, size);
+        if (q) {
+            memcpy(q, p, before < size ? before : size);
+            free_locked(p);
+        }
+    }
+    pthread_mutex_unlock(&lock);
+    return q;
+}
+
+void ui_heap_free(void *p) {
+    if (!p) return;
+    pthread_mutex_lock(&lock);
+    free_locked(p);
+    pthread_mutex_unlock(&lock);
+}
+
+void ui_heap_set_tag(uint16_t tag) {
+    if (tag >= UI_HEAP_MAX_TAGS) return;
+    pthread_mutex_lock(&lock);
+    cur_tag = tag;
+    pthread_mutex_unlock(&lock);
+}
+
+uint16_t ui_heap_get_tag(void) {
+    pthread_mutex_lock(&lock);
+    uint16_t tag = cur_tag;
+    pthread_mutex_unlock(&lock);
+    return tag;
+}
+
+bool ui_heap_arena_open(uint16_t tag, size_t bytes) {
+    if (tag >= UI_HEAP_MAX_TAGS || bytes == 0) return false;
+
+    pthread_mutex_lock(&lock);
+    arena_t *slot = NULL;
+    for (int i = 0; i < UI_HEAP_MAX_ARENAS && !slot; i++) {
+        if (!arenas[i].in_use) slot = &arenas[i];
+    }
+
+    bool ok = false;
+    if (slot && !open_arena_of(tag)) {
+        void *mem = tlsf_malloc(&pool, bytes, UI_HEAP_TAG_ARENA);
+        if (mem && tlsf_init(&slot->tlsf, mem, tlsf_size_of(mem))) {
+            slot->in_use = true;
+            slot->open = true;
+            slot->tag = tag;
+            slot->mem = mem;
+            arenas_opened++;
+            ok = true;
+        } else if (mem) {
+            tlsf_free(&pool, mem);
+        }
+    }
+    if (!ok) arenas_failed++;
+    pthread_mutex_unlock(&lock);
+    return ok;
+}
+
+void ui_heap_arena_close(uint16_t tag) {
+    pthread_mutex_lock(&lock);
+    arena_t *a = open_arena_of(tag);
+    if (a) {
+        a->open = false;
+        release_if_drained(a);
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+bool ui_heap_get_tag_stats(uint16_t tag, ui_heap_tag_stats_t *out) {
+    if (tag >= UI_HEAP_MAX_TAGS || !out) return false;
+    pthread_mutex_lock(&lock);
+    *out = tags[tag];
+    pthread_mutex_unlock(&lock);
+    return true;
+}
+
+bool ui_heap_get_arena(int index, ui_heap_arena_info_t *out) {
+    if (index < 0 || index >= UI_HEAP_MAX_ARENAS || !out) return false;
+    pthread_mutex_lock(&lock);
+    const arena_t *a = &arenas[index];
+    bool in_use = a->in_use;
+    if (in_use) {
+        out->tag = a->tag;
+        out->open = a->open;
+        out->capacity = a->tlsf.capacity;
+        out->used = a->tlsf.used;
+        out->used_peak = a->tlsf.used_peak;
+        out->blocks = a->tlsf.used_blocks;
+    }
+    pthread_mutex_unlock(&lock);
+    return in_use;
+}
+
+void ui_heap_get_stats(ui_heap_stats_t *out) {
+    pthread_mutex_lock(&lock);
+    tlsf_get_stats(&pool, &out->pool);
+    out->arenas_opened = arenas_opened;
+    out->arenas_released = arenas_released;
+    out->arenas_failed = arenas_failed;
+    pthread_mutex_unlock(&lock);
+}
+
+bool ui_heap_check(void) {
+    pthread_mutex_lock(&lock);
+    bool ok = tlsf_check(&pool);
+    for (int i = 0; i < UI_HEAP_MAX_ARENAS && ok; i++) {
+        if (arenas[i].in_use) ok = tlsf_check(&arenas[i].tlsf);
+    }
+    pthread_mutex_unlock(&lock);
+    return ok;
+}
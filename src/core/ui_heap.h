@@ -0,0 +1,121 @@
+/**
+ * @file ui_heap.h
+ * @brief LVGL heap: TLSF pool with per-screen accounting and arenas
+ *
+ * Backs LVGL's allocator (LV_STDLIB_CUSTOM, see src/ui/lv_mem_ui_heap.c).
+ * screen_manager sets the tag to the active screen before creating it, so
+ * every allocation is charged to a screen; frees are charged to the tag
+ * the block was allocated under.  Per tag: bytes and blocks now, peak.
+ *
+ * Arena mode: a screen may open an arena, a region carved from the pool
+ * that serves all of its allocations.  Closing the arena (screen
+ * destroyed) stops new allocations; once LVGL has freed the last block in
+ * it — the old screen is deleted after the transition — the region goes
+ * back to the pool in one piece.  Objects with screen lifetime then never
+ * interleave with long-lived ones, which is where fragmentation comes
+ * from.  An arena that is full spills to the shared pool (counted as
+ * `spilled`); one that something outliving the screen still holds stays
+ * until that is freed (`pinned`).
+ *
+ * All calls are thread-safe.  No LVGL dependency.
+ */
+
+#ifndef UI_HEAP_H
+#define UI_HEAP_H
+
+#include "tlsf.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ── Configuration ─────────────────────────────────────────── */
+
+#define UI_HEAP_MAX_TAGS    16
+#define UI_HEAP_MAX_ARENAS  4       /* Open plus draining */
+
+#define UI_HEAP_TAG_SHARED  0       /* Outside any screen: display, theme */
+
+/* ── Types ─────────────────────────────────────────────────── */
+
+typedef struct {
+    size_t   bytes;                 /* Payload bytes held now */
+    size_t   peak;                  /* High-water mark of `bytes` */
+    uint32_t blocks;
+    uint32_t spilled;               /* Allocations an open arena could not hold */
+} ui_heap_tag_stats_t;
+
+typedef struct {
+    uint16_t tag;
+    bool     open;                  /* false: closed, waiting for its blocks */
+    size_t   capacity;
+    size_t   used;
+    size_t   used_peak;
+    uint32_t blocks;
+} ui_heap_arena_info_t;
+
+typedef struct {
+    tlsf_stats_t pool;              /* Arenas count as used blocks here */
+    uint32_t     arenas_opened;
+    uint32_t     arenas_released;
+    uint32_t     arenas_failed;     /* Opens refused: no slot or no room */
+} ui_heap_stats_t;
+
+/* ── API ───────────────────────────────────────────────────── */
+
+/**
+ * Manage `mem` (owned by the caller).  Resets tags and arenas.
+ * @return false if the pool is unusable (tlsf_init()).
+ */
+bool ui_heap_init(void *mem, size_t bytes);
+
+/** Allocate under the current tag: from its arena if open, else the pool. */
+void *ui_heap_alloc(size_t size);
+
+/** Resize, keeping the block's tag and, if possible, its arena. */
+void *ui_heap_realloc(void *p, size_t size);
+
+/** Free a block from the pool or any arena.  NULL is ignored. */
+void ui_heap_free(void *p);
+
+/** Tag for following allocations (< UI_HEAP_MAX_TAGS). */
+void ui_heap_set_tag(uint16_t tag);
+
+uint16_t ui_heap_get_tag(void);
+
+/**
+ * Give `tag` an arena of `bytes` from the pool.
+ * @return false if no slot is free, the pool has no room or `tag` already
+ *         has an open arena; its allocations then use the pool.
+ */
+bool ui_heap_arena_open(uint16_t tag, size_t bytes);
+
+/**
+ * Close the open arena of `tag`.  It is released as soon as it is empty,
+ * which may be now.
+ */
+void ui_heap_arena_close(uint16_t tag);
+
+/** Accounting for one tag. */
+bool ui_heap_get_tag_stats(uint16_t tag, ui_heap_tag_stats_t *out);
+
+/**
+ * Arena slot `index` (< UI_HEAP_MAX_ARENAS).
+ * @return false if the slot is not in use.
+ */
+bool ui_heap_get_arena(int index, ui_heap_arena_info_t *out);
+
+/** Pool usage, fragmentation and arena counters. */
+void ui_heap_get_stats(ui_heap_stats_t *out);
+
+/** tlsf_check() of the pool and every arena. */
+bool ui_heap_check(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UI_HEAP_H */
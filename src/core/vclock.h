@@ -0,0 +1,97 @@
+/**
+ * @file vclock.h
+ * @brief Clock service: real, application and wall time for every module
+ *
+ * Three readings, each for one purpose:
+ *
+ *   - vclock_real_us():  CLOCK_MONOTONIC, whatever the mode.  Measures how
+ *     long work took: boot steps, job run times, frame time, backup pacing.
+ *   - vclock_mono_us() / vclock_mono_ms():  application time, monotonic.
+ *     Schedules work: data-thread tasks, LVGL's tick.
+ *   - vclock_wall_s() / vclock_wall_ms():  seconds since the epoch.  Stamps
+ *     records: trend samples, alarm events, audit and sync rows, admissions.
+ *
+ * Modes:
+ *
+ *   - VCLOCK_REAL (default): application time is CLOCK_MONOTONIC and wall
+ *     time is CLOCK_REALTIME.
+ *   - VCLOCK_VIRTUAL: both stand still until vclock_advance_us() or
+ *     vclock_sleep_ms() moves them, and wall time is the start time given
+ *     to vclock_init() plus the virtual time elapsed.  A loop that advances
+ *     to its next deadline instead of sleeping runs as fast as the CPU
+ *     allows, and with a fixed start time the same run stamps the same
+ *     records.  Anything that waits on a real timeout (the data thread's
+ *     condition variable) must run inline instead; data_thread_start()
+ *     does so by itself.
+ *
+ * All functions may be called from any thread; virtual time is a single
+ * atomic 64-bit counter.  No LVGL dependency.
+ */
+
+#ifndef VCLOCK_H
+#define VCLOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ── Types ─────────────────────────────────────────────────── */
+
+typedef enum {
+    VCLOCK_REAL = 0,
+    VCLOCK_VIRTUAL,
+} vclock_mode_t;
+
+/* ── Setup ─────────────────────────────────────────────────── */
+
+/**
+ * Select the time source.  Call once at startup, before other modules
+ * read the clock.
+ * @param start_wall_s  VCLOCK_VIRTUAL: wall time at the start, in seconds
+ *                      since the epoch (0: the current real time).
+ *                      Ignored for VCLOCK_REAL.
+ */
+void vclock_init(vclock_mode_t mode, int64_t start_wall_s);
+
+/** Current mode. */
+vclock_mode_t vclock_get_mode(void);
+
+/** True in VCLOCK_VIRTUAL mode. */
+bool vclock_is_virtual(void);
+
+/* ── Readings ──────────────────────────────────────────────── */
+
+/** Real CLOCK_MONOTONIC microseconds, in every mode. */
+uint64_t vclock_real_us(void);
+
+/** Application time in microseconds (monotonic). */
+uint64_t vclock_mono_us(void);
+
+/** Application time in milliseconds, wrapping (LVGL tick callback). */
+uint32_t vclock_mono_ms(void);
+
+/** Wall time in seconds since the epoch. */
+int64_t vclock_wall_s(void);
+
+/** Wall time in milliseconds since the epoch. */
+uint64_t vclock_wall_ms(void);
+
+/* ── Advancing ─────────────────────────────────────────────── */
+
+/**
+ * Move virtual time forward by `us`.
+ * @return false in VCLOCK_REAL mode, where time cannot be moved.
+ */
+bool vclock_advance_us(uint64_t us);
+
+/** Sleep `ms` of application time: usleep() when real, advance when virtual. */
+void vclock_sleep_ms(uint32_t ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VCLOCK_H */
@@ -112,7 +112,8 @@ int vitals_provider_init(void);
  * Start the vitals provider.
  * After this call, registered callbacks will start receiving data.
  *
- * @param vitals_interval_ms  Interval for vitals updates (typically 1000)
+ * @param vitals_interval_ms  Interval for vitals updates (typically 1000),
+ *                            or 0 to be driven by vitals_provider_tick()
  * @return 0 on success, negative error code on failure
  */
 int vitals_provider_start(uint32_t vitals_interval_ms);
@@ -123,6 +124,14 @@ int vitals_provider_start(uint32_t vitals_interval_ms);
  */
 void vitals_provider_stop(void);
 
+/**
+ * Produce one vitals update on the calling thread.
+ * For providers started with an interval of 0, whose caller drives the
+ * rate (the simulator's data thread).  The IPC provider receives on its
+ * own threads and ignores this.
+ */
+void vitals_provider_tick(void);
+
 /**
  * Shutdown and cleanup the vitals provider.
  */
@@ -14,6 +14,7 @@
  */
 
 #include "vitals_provider.h"
+#include "mem_budget.h"
 #include "../common/ipc/ipc_messages.h"
 #include <string.h>
 #include <stdio.h>
@@ -36,6 +37,8 @@ static void               *g_waveform_user_data = NULL;
 
 static vitals_data_t g_current_vitals[2];
 static vitals_history_t g_history[2];
+MEM_BUDGET_ASSERT(ipc_history, sizeof(g_history),
+                  2 * MEM_BUDGET_VITALS_HISTORY);
 
 #ifdef USE_NANOMSG
 static int g_vitals_socket = -1;
@@ -184,6 +187,10 @@ void vitals_provider_set_waveform_callback(waveform_callback_t callback, void *u
     g_waveform_user_data = user_data;
 }
 
+void vitals_provider_tick(void) {
+    /* Updates arrive on the receiver threads */
+}
+
 const vitals_data_t *vitals_provider_get_current(uint8_t slot) {
     if (slot > 1) {
         return NULL;
@@ -9,6 +9,7 @@
 #include "vitals_provider.h"
 #include "mock_data.h"
 #include "waveform_gen.h"
+#include "mem_budget.h"
 #include "lvgl.h"
 #include <string.h>
 #include <stdio.h>
@@ -32,6 +33,8 @@ static lv_timer_t *g_waveform_timer = NULL;
 
 /* History (using mock_data's history for now) */
 static vitals_history_t g_history[2];
+MEM_BUDGET_ASSERT(mock_history, sizeof(g_history),
+                  2 * MEM_BUDGET_VITALS_HISTORY);
 
 /* Alarm log */
 static vitals_alarm_log_t g_alarm_log;
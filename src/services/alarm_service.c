@@ -18,6 +18,7 @@
 
 #include "alarm_service.h"
 #include "alarm_engine.h"
+#include "status_board.h"
 #include "vitals_provider.h"
 #include <stdio.h>
 #include <string.h>
@@ -88,6 +89,11 @@ void alarm_service_tick(uint32_t current_time_s)
     /* Evaluate all alarm thresholds against current values */
     alarm_engine_evaluate(vitals, current_time_s);
 
+    /* Publish the slot's alarm summary for current-state consumers */
+    status_alarms_t rec;
+    status_board_alarms_from_engine(alarm_engine_get_state(), current_time_s, &rec);
+    status_board_write_alarms(0, &rec);
+
     /*
      * In simulator mode the UI reads alarm state directly from
      * alarm_engine_get_state() since everything shares the same
@@ -134,6 +140,7 @@ void alarm_service_deinit(void)
  *    - Deserialise ipc_msg_vitals_t into vitals_data_t
  *    - alarm_engine_evaluate(&vitals, current_time_s)
  *    - If alarm state changed, build ipc_msg_alarm_t and nn_send()
+ *    - status_board_write_alarms() with the per-slot alarm summary
  *    - Drive buzzer GPIO based on alarm_engine_get_state()->highest_active
  *    - Log alarm events via trend_db_insert_alarm()
  *    - sd_notify(0, "WATCHDOG=1") for systemd watchdog
@@ -16,6 +16,7 @@
  */
 
 #include "sensor_service.h"
+#include "status_board.h"
 #include "vitals_provider.h"
 #include <stdio.h>
 #include <string.h>
@@ -90,8 +91,16 @@ void sensor_service_tick(uint32_t current_time_s)
     /*
      * In simulator mode the actual data generation is driven by the LVGL
      * timer in mock_data.c, so there is nothing to poll here.  The tick
-     * just keeps the heartbeat alive for the service manager.
+     * keeps the heartbeat alive and mirrors each slot's latest snapshot
+     * onto the status board (this service owns the vitals records).
      */
+    for (uint8_t slot = 0; slot < STATUS_BOARD_SLOTS; slot++) {
+        const vitals_data_t *vitals = vitals_provider_get_current(slot);
+        if (!vitals) continue;
+        status_vitals_t rec;
+        status_board_vitals_from_data(vitals, &rec);
+        status_board_write_vitals(slot, &rec);
+    }
 }
 
 void sensor_service_deinit(void)
@@ -130,6 +139,8 @@ void sensor_service_deinit(void)
  * 3. sensor_service_tick():
  *    - Poll each sensor HAL for latest readings
  *    - Build ipc_msg_vitals_t from sensor readings and nn_send()
+ *    - status_board_write_vitals() with the per-slot snapshot and
+ *      sensor connection states
  *    - Forward waveform callback data as ipc_msg_waveform_t via nn_send()
  *    - Detect sensor connect/disconnect and publish status messages
  *    - Feed sd_notify(0, "WATCHDOG=1") for systemd watchdog
@@ -8,8 +8,10 @@
  */
 
 #include "service_manager.h"
+#include "status_board.h"
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
 
 /* ── Internal service entry ───────────────────────────────── */
 
@@ -103,6 +105,28 @@ static void stop_entry(service_entry_t *entry)
     printf("[service_manager] '%s' is STOPPED\n", name);
 }
 
+/**
+ * Publish an entry's health record on the status board (no-op if the
+ * board is not attached or the service has no fixed record index).
+ */
+static void publish_health(const service_entry_t *entry)
+{
+    if (!status_board_is_open()) return;
+
+    status_service_id_t id = status_board_service_id(entry->reg.name);
+    if (id >= STATUS_SVC_COUNT) return;
+
+    status_service_t rec;
+    memset(&rec, 0, sizeof(rec));
+    strncpy(rec.name, entry->info.name, sizeof(rec.name) - 1);
+    rec.state            = (uint8_t)entry->info.state;
+    rec.pid              = (int32_t)getpid();
+    rec.start_time_s     = entry->info.start_time_s;
+    rec.restart_count    = entry->info.restart_count;
+    rec.last_heartbeat_s = entry->info.last_heartbeat_s;
+    status_board_write_service(id, &rec);
+}
+
 /* ── Public API ───────────────────────────────────────────── */
 
 void service_manager_init(void)
@@ -281,6 +305,11 @@ void service_manager_tick(uint32_t current_time_s)
             }
         }
     }
+
+    /* ── Status board ─────────────────────────────────────── */
+    for (int i = 0; i < s_service_count; i++) {
+        if (s_services[i].in_use) publish_health(&s_services[i]);
+    }
 }
 
 /* ── Status queries ───────────────────────────────────────── */
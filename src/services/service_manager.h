@@ -73,7 +73,7 @@ typedef void (*service_start_fn)(void);
 typedef void (*service_stop_fn)(void);
 
 /** Periodic tick called from main loop.
- *  @param current_time_s  Monotonic seconds (e.g., SDL_GetTicks/1000). */
+ *  @param current_time_s  Monotonic seconds (e.g., vclock_mono_ms() / 1000). */
 typedef void (*service_tick_fn)(uint32_t current_time_s);
 
 /** Release all resources. */
@@ -0,0 +1,70 @@
+/**
+ * @file lv_mem_ui_heap.c
+ * @brief LVGL memory core on ui_heap (LV_USE_STDLIB_MALLOC = LV_STDLIB_CUSTOM)
+ *
+ * Replaces LVGL's built-in core with the same LV_MEM_SIZE static pool
+ * managed by ui_heap, which adds the screen tags and arenas (ui_heap.h).
+ * ui_heap locks internally, so these need no lv_lock().
+ */
+
+#include "lvgl.h"
+
+#if LV_USE_STDLIB_MALLOC == LV_STDLIB_CUSTOM
+
+#include "ui_heap.h"
+#include "mem_budget.h"
+#include <stdio.h>
+
+static uint64_t pool[LV_MEM_SIZE / sizeof(uint64_t)];
+MEM_BUDGET_ASSERT(lvgl_pool, sizeof(pool), MEM_BUDGET_LVGL_POOL);
+
+void lv_mem_init(void) {
+    ui_heap_init(pool, sizeof(pool));
+}
+
+void lv_mem_deinit(void) {
+}
+
+lv_mem_pool_t lv_mem_add_pool(void *mem, size_t bytes) {
+    /* One pool; LVGL only adds pools with LV_MEM_POOL_EXPAND */
+    (void)mem;
+    printf("[ui_heap] Extra pool of %zu bytes ignored\n", bytes);
+    return NULL;
+}
+
+void lv_mem_remove_pool(lv_mem_pool_t p) {
+    (void)p;
+}
+
+void *lv_malloc_core(size_t size) {
+    return ui_heap_alloc(size);
+}
+
+void *lv_realloc_core(void *p, size_t new_size) {
+    return ui_heap_realloc(p, new_size);
+}
+
+void lv_free_core(void *p) {
+    ui_heap_free(p);
+}
+
+void lv_mem_monitor_core(lv_mem_monitor_t *mon_p) {
+    ui_heap_stats_t st;
+    ui_heap_get_stats(&st);
+
+    mon_p->total_size = st.pool.capacity;
+    mon_p->free_size = st.pool.free;
+    mon_p->free_biggest_size = st.pool.largest_free;
+    mon_p->free_cnt = st.pool.free_blocks;
+    mon_p->used_cnt = st.pool.used_blocks;
+    mon_p->max_used = st.pool.used_peak;
+    mon_p->used_pct = (uint8_t)(st.pool.capacity
+                                ? st.pool.used * 100 / st.pool.capacity : 0);
+    mon_p->frag_pct = st.pool.frag_pct;
+}
+
+lv_result_t lv_mem_test_core(void) {
+    return ui_heap_check() ? LV_RESULT_OK : LV_RESULT_INVALID;
+}
+
+#endif /* LV_USE_STDLIB_MALLOC == LV_STDLIB_CUSTOM */
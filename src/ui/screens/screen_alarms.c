@@ -2,6 +2,13 @@
  * @file screen_alarms.c
  * @brief Alarms screen -- alarm history log, live engine state, and editable limits
  *
+ * The history is the patient's alarm_events in trend_db, newest first,
+ * read a page at a time through alarm_history, whose reads run on job_pool
+ * and land through history_updated_cb().  Only the rows on screen
+ * exist as LVGL objects: a fixed pool of LOG_ROW_POOL rows is positioned
+ * over a spacer as tall as the loaded history and rebound on scroll, so
+ * days of history cost the same memory and frame time as a few minutes.
+ *
  * Layout (800x480):
  *   +--------------------------------------------------------------+
  *   | ALARM BAR (32px)                                             |
@@ -28,23 +35,52 @@
 #include "widget_alarm_banner.h"
 #include "widget_nav_bar.h"
 #include "theme_vitals.h"
-#include "vitals_provider.h"
 #include "alarm_engine.h"
 #include "patient_data.h"
+#include "alarm_history.h"
+#include "trend_db.h"
+#include "data_thread.h"
+#include "status_board.h"
 #include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* -- Alarm history list -------------------------------------------- */
+
+#define LOG_ROW_H     28      /* Fixed row pitch, px */
+#define LOG_ROW_POOL  16      /* Row objects; more than fit on screen */
+
+typedef struct {
+    lv_obj_t *row;
+    lv_obj_t *time_lbl;
+    lv_obj_t *sev_lbl;
+    lv_obj_t *msg_lbl;
+    int       bound;          /* History index shown, -1: none */
+} log_row_t;
 
 /* -- Module state -------------------------------------------------- */
 
 static widget_alarm_banner_t *alarm_banner;
 static widget_nav_bar_t      *nav_bar;
 static lv_obj_t              *log_list;
+static lv_obj_t              *log_title;
+static lv_obj_t              *log_spacer;
+static lv_obj_t              *log_empty;
+static log_row_t              log_rows[LOG_ROW_POOL];
+static int                    pending_new;    /* Recorded since opened */
 static lv_obj_t              *status_label;
 static lv_timer_t            *refresh_timer;
-static int                    last_log_count;
+/* Presses the data thread's call queue turned away, retried by the timer */
+static bool                   ack_pending;
+static bool                   silence_pending;
 
 /* -- Forward declarations ------------------------------------------ */
 
 static void build_alarm_log_list(lv_obj_t *parent);
+static void open_alarm_history(void);
+static void history_updated_cb(void *user_data);
+static void bind_visible_rows(void);
+static void log_scroll_cb(lv_event_t *e);
 static void build_alarm_limits_table(lv_obj_t *parent);
 static void refresh_timer_cb(lv_timer_t *timer);
 static const char *severity_str(vm_alarm_severity_t s);
@@ -125,7 +161,7 @@ lv_obj_t *screen_alarms_create(void) {
     lv_obj_set_flex_flow(left_panel, LV_FLEX_FLOW_COLUMN);
 
     /* Title */
-    lv_obj_t *log_title = lv_label_create(left_panel);
+    log_title = lv_label_create(left_panel);
     lv_label_set_text(log_title, "Alarm History");
     lv_obj_set_style_text_font(log_title, VM_FONT_BODY, 0);
     lv_obj_set_style_text_color(log_title, VM_COLOR_TEXT_PRIMARY, 0);
@@ -195,8 +231,6 @@ lv_obj_t *screen_alarms_create(void) {
     build_alarm_limits_table(right_panel);
 
     /* Refresh timer to check for new alarms and update status */
-    const vitals_alarm_log_t *alog = vitals_provider_get_alarm_log();
-    last_log_count = alog->count;
     refresh_timer = lv_timer_create(refresh_timer_cb, 2000, NULL);
 
     /* -- Nav bar (bottom) ------------------------------------------ */
@@ -218,10 +252,17 @@ void screen_alarms_destroy(void) {
     }
     widget_alarm_banner_free(alarm_banner);
     widget_nav_bar_free(nav_bar);
+    alarm_history_set_callback(NULL, NULL);
+    alarm_history_close();
     alarm_banner = NULL;
     nav_bar      = NULL;
     log_list     = NULL;
+    log_title    = NULL;
+    log_spacer   = NULL;
+    log_empty    = NULL;
+    memset(log_rows, 0, sizeof(log_rows));
     status_label = NULL;
+    ack_pending = silence_pending = false;
     printf("[alarms] Screen destroyed\n");
 }
 
@@ -242,18 +283,63 @@ static lv_color_t severity_color(vm_alarm_severity_t s) {
 
 /* -- Button callbacks ---------------------------------------------- */
 
+/*
+ * The alarm engine belongs to the data thread: acknowledge and silence
+ * run there, and the status label catches up from status_board on its
+ * next refresh.  Only in inline mode (no data thread) do they run here.
+ * If the call queue is full the press is kept, shown on the status
+ * label, and retried by the refresh timer.
+ */
+
+static void ack_all_call(void *arg) {
+    (void)arg;
+    bool acked = alarm_engine_acknowledge_all();
+    printf("[alarms] Ack All, result=%d\n", acked);
+}
+
+static void silence_all_call(void *arg) {
+    (void)arg;
+    bool silenced = alarm_engine_silence_all(120);
+    printf("[alarms] Silence 2min, result=%d\n", silenced);
+}
+
+/** Run `fn` where the engine lives. @return false if the queue is full. */
+static bool call_engine(data_call_fn_t fn) {
+    if (data_thread_call(fn, NULL)) return true;
+    if (data_thread_is_running()) return false;
+    fn(NULL);
+    return true;
+}
+
+/** Retry presses the call queue turned away. */
+static void retry_pending_actions(void) {
+    if (ack_pending) ack_pending = !call_engine(ack_all_call);
+    if (silence_pending) silence_pending = !call_engine(silence_all_call);
+}
+
+static void show_pending_actions(void) {
+    if (!status_label || (!ack_pending && !silence_pending)) return;
+    lv_label_set_text(status_label, ack_pending && silence_pending
+                      ? "Status: Busy, retrying Ack All and Silence"
+                      : ack_pending ? "Status: Busy, retrying Ack All"
+                                    : "Status: Busy, retrying Silence");
+    lv_obj_set_style_text_color(status_label, VM_COLOR_ALARM_MEDIUM, 0);
+}
+
 static void ack_all_cb(lv_event_t *e) {
     (void)e;
-    bool acked = alarm_engine_acknowledge_all();
-    printf("[alarms] Ack All pressed, result=%d\n", acked);
+    ack_pending = !call_engine(ack_all_call);
+    if (ack_pending) printf("[alarms] Ack All deferred: call queue full\n");
     update_status_label();
+    show_pending_actions();
 }
 
 static void silence_all_cb(lv_event_t *e) {
     (void)e;
-    bool silenced = alarm_engine_silence_all(120);
-    printf("[alarms] Silence 2min pressed, result=%d\n", silenced);
+    silence_pending = !call_engine(silence_all_call);
+    if (silence_pending) printf("[alarms] Silence deferred: call queue full\n");
     update_status_label();
+    show_pending_actions();
 }
 
 /* -- Status label update ------------------------------------------- */
@@ -261,10 +347,11 @@ static void silence_all_cb(lv_event_t *e) {
 static void update_status_label(void) {
     if (!status_label) return;
 
-    const alarm_engine_state_t *state = alarm_engine_get_state();
-
-    if (state->highest_active == ALARM_SEV_NONE &&
-        state->highest_any == ALARM_SEV_NONE) {
+    /* Summary the data thread published with the last evaluation */
+    status_alarms_t state;
+    if (!status_board_read_alarms(0, &state) ||
+        (state.highest_active == ALARM_SEV_NONE &&
+         state.highest_any == ALARM_SEV_NONE)) {
         lv_label_set_text(status_label, "Status: All clear");
         lv_obj_set_style_text_color(status_label, VM_COLOR_ALARM_NONE, 0);
         return;
@@ -276,11 +363,11 @@ static void update_status_label(void) {
     int off = 0;
 
     for (int i = 0; i < ALARM_PARAM_COUNT; i++) {
-        if (state->params[i].state != ALARM_STATE_INACTIVE) {
+        if (state.state[i] != ALARM_STATE_INACTIVE) {
             const char *sev_name = "---";
             lv_color_t  sev_col  = VM_COLOR_TEXT_SECONDARY;
 
-            switch (state->params[i].severity) {
+            switch (state.severity[i]) {
                 case ALARM_SEV_HIGH:
                     sev_name = "HIGH";
                     sev_col  = VM_COLOR_ALARM_HIGH;
@@ -302,15 +389,15 @@ static void update_status_label(void) {
                 off = snprintf(buf, sizeof(buf), "Status: %s %s [%s]",
                                alarm_param_name((alarm_param_t)i),
                                sev_name,
-                               alarm_state_str(state->params[i].state));
+                               alarm_state_str((alarm_state_t)state.state[i]));
                 lv_obj_set_style_text_color(status_label, sev_col, 0);
             }
         }
     }
 
     /* Fallback: use highest_message if no per-param match found */
-    if (off == 0 && state->highest_message) {
-        snprintf(buf, sizeof(buf), "Status: %s", state->highest_message);
+    if (off == 0 && state.highest_message[0]) {
+        snprintf(buf, sizeof(buf), "Status: %s", state.highest_message);
         lv_obj_set_style_text_color(status_label, VM_COLOR_ALARM_MEDIUM, 0);
     } else if (off == 0) {
         snprintf(buf, sizeof(buf), "Status: All clear");
@@ -322,70 +409,174 @@ static void update_status_label(void) {
 
 /* -- Alarm log list ------------------------------------------------ */
 
-static void add_log_entry_to_list(const vitals_alarm_entry_t *entry) {
-    if (!log_list) return;
-
-    lv_obj_t *row = lv_obj_create(log_list);
-    lv_obj_remove_flag(row, LV_OBJ_FLAG_SCROLLABLE);
-    lv_obj_set_width(row, lv_pct(100));
-    lv_obj_set_height(row, 28);
-    lv_obj_set_style_bg_opa(row, LV_OPA_TRANSP, 0);
-    lv_obj_set_style_border_width(row, 0, 0);
-    lv_obj_set_style_pad_all(row, 0, 0);
-    lv_obj_set_flex_flow(row, LV_FLEX_FLOW_ROW);
-    lv_obj_set_style_pad_gap(row, VM_PAD_NORMAL, 0);
-    lv_obj_set_flex_align(row, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+static void create_log_row(log_row_t *r) {
+    r->row = lv_obj_create(log_list);
+    lv_obj_remove_flag(r->row, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_remove_flag(r->row, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_flag(r->row, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_set_width(r->row, lv_pct(100));
+    lv_obj_set_height(r->row, LOG_ROW_H);
+    lv_obj_set_style_bg_opa(r->row, LV_OPA_TRANSP, 0);
+    lv_obj_set_style_border_width(r->row, 0, 0);
+    lv_obj_set_style_pad_all(r->row, 0, 0);
+    lv_obj_set_flex_flow(r->row, LV_FLEX_FLOW_ROW);
+    lv_obj_set_style_pad_gap(r->row, VM_PAD_NORMAL, 0);
+    lv_obj_set_flex_align(r->row, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
 
     /* Time */
-    lv_obj_t *time_lbl = lv_label_create(row);
-    lv_label_set_text(time_lbl, entry->time_str);
-    lv_obj_set_style_text_font(time_lbl, VM_FONT_SMALL, 0);
-    lv_obj_set_style_text_color(time_lbl, VM_COLOR_TEXT_SECONDARY, 0);
-    lv_obj_set_width(time_lbl, 44);
+    r->time_lbl = lv_label_create(r->row);
+    lv_obj_set_style_text_font(r->time_lbl, VM_FONT_SMALL, 0);
+    lv_obj_set_style_text_color(r->time_lbl, VM_COLOR_TEXT_SECONDARY, 0);
+    lv_obj_set_width(r->time_lbl, 76);
 
     /* Severity badge */
-    lv_obj_t *sev_lbl = lv_label_create(row);
-    lv_label_set_text(sev_lbl, severity_str((vm_alarm_severity_t)entry->severity));
-    lv_obj_set_style_text_font(sev_lbl, VM_FONT_SMALL, 0);
-    lv_obj_set_style_text_color(sev_lbl, severity_color((vm_alarm_severity_t)entry->severity), 0);
-    lv_obj_set_width(sev_lbl, 40);
+    r->sev_lbl = lv_label_create(r->row);
+    lv_obj_set_style_text_font(r->sev_lbl, VM_FONT_SMALL, 0);
+    lv_obj_set_width(r->sev_lbl, 40);
 
     /* Message */
-    lv_obj_t *msg_lbl = lv_label_create(row);
-    lv_label_set_text(msg_lbl, entry->message);
-    lv_obj_set_style_text_font(msg_lbl, VM_FONT_SMALL, 0);
-    lv_obj_set_style_text_color(msg_lbl, VM_COLOR_TEXT_PRIMARY, 0);
-    lv_obj_set_flex_grow(msg_lbl, 1);
+    r->msg_lbl = lv_label_create(r->row);
+    lv_label_set_long_mode(r->msg_lbl, LV_LABEL_LONG_DOT);
+    lv_obj_set_style_text_font(r->msg_lbl, VM_FONT_SMALL, 0);
+    lv_obj_set_flex_grow(r->msg_lbl, 1);
+
+    r->bound = -1;
+}
+
+/** Show history event `index` in row `r` (texts only change on rebind). */
+static void bind_log_row(log_row_t *r, int index, const alarm_event_t *evt) {
+    lv_obj_set_y(r->row, index * LOG_ROW_H);
+    lv_obj_remove_flag(r->row, LV_OBJ_FLAG_HIDDEN);
+    if (r->bound == index) return;
+    r->bound = index;
+
+    char buf[96];
+    time_t t = (time_t)evt->time_s;
+    struct tm tm_info;
+    localtime_r(&t, &tm_info);
+    strftime(buf, sizeof(buf), "%d/%m %H:%M:%S", &tm_info);
+    lv_label_set_text(r->time_lbl, buf);
+
+    vm_alarm_severity_t sev = (vm_alarm_severity_t)evt->severity;
+    lv_label_set_text(r->sev_lbl, severity_str(sev));
+    lv_obj_set_style_text_color(r->sev_lbl, severity_color(sev), 0);
+
+    /* Operator actions and clears are quieter than alarm onsets */
+    bool alerting = evt->kind == ALARM_EVT_ONSET ||
+                    evt->kind == ALARM_EVT_ESCALATE ||
+                    evt->kind == ALARM_EVT_REALERT;
+    alarm_engine_format_event(evt, buf, sizeof(buf));
+    lv_label_set_text(r->msg_lbl, buf);
+    lv_obj_set_style_text_color(r->msg_lbl, alerting ? VM_COLOR_TEXT_PRIMARY
+                                                     : VM_COLOR_TEXT_SECONDARY, 0);
+}
+
+/**
+ * Bind the rows in view, requesting further pages as the end nears.  Rows
+ * whose page is still being read stay as they are until it arrives.
+ */
+static void bind_visible_rows(void) {
+    static bool binding;
+    if (!log_list || binding) return;
+    binding = true;     /* Without job_pool, reads complete in here */
+
+    int32_t y = lv_obj_get_scroll_y(log_list);
+    int first = y > 0 ? (int)(y / LOG_ROW_H) : 0;
+    int shown = (int)(lv_obj_get_content_height(log_list) / LOG_ROW_H) + 2;
+    if (shown > LOG_ROW_POOL) shown = LOG_ROW_POOL;
+
+    if (first + shown >= alarm_history_count()) alarm_history_load_more();
+
+    /* Row i % LOG_ROW_POOL keeps an index for as long as it is in view */
+    bool used[LOG_ROW_POOL] = { false };
+    int count = alarm_history_count();
+    for (int i = first; i < first + shown && i < count; i++) {
+        log_row_t *r = &log_rows[i % LOG_ROW_POOL];
+        const alarm_event_t *evt = alarm_history_get(i);
+        if (evt) {
+            bind_log_row(r, i, evt);
+        } else if (r->bound != i) {
+            continue;           /* Page in flight (or purged): hide */
+        }
+        used[i % LOG_ROW_POOL] = true;
+    }
+    for (int k = 0; k < LOG_ROW_POOL; k++) {
+        if (!used[k] && log_rows[k].row) {
+            lv_obj_add_flag(log_rows[k].row, LV_OBJ_FLAG_HIDDEN);
+            log_rows[k].bound = -1;
+        }
+    }
+    binding = false;
+}
+
+/**
+ * (Re)open the active patient's history.  The rows keep their old text
+ * until the newest page arrives, so a refresh does not flash empty.
+ */
+static void open_alarm_history(void) {
+    pending_new = 0;
+    for (int k = 0; k < LOG_ROW_POOL; k++) log_rows[k].bound = -1;
+    if (log_title) lv_label_set_text(log_title, "Alarm History");
+    alarm_history_open(trend_db_slot_patient(0));
+}
+
+/** A history read completed (LVGL thread): resize and rebind. */
+static void history_updated_cb(void *user_data) {
+    (void)user_data;
+    if (!log_list) return;
+
+    int count = alarm_history_count();
+    lv_obj_set_height(log_spacer, count * LOG_ROW_H);
+    if (count == 0 && !alarm_history_has_more()) {
+        lv_obj_remove_flag(log_empty, LV_OBJ_FLAG_HIDDEN);
+    } else {
+        lv_obj_add_flag(log_empty, LV_OBJ_FLAG_HIDDEN);
+    }
+    bind_visible_rows();
+}
+
+static void log_scroll_cb(lv_event_t *e) {
+    (void)e;
+    /* Back at the top: take in what was recorded meanwhile */
+    if (pending_new > 0 && lv_obj_get_scroll_y(log_list) < LOG_ROW_H) {
+        open_alarm_history();
+        return;
+    }
+    bind_visible_rows();
 }
 
 static void build_alarm_log_list(lv_obj_t *parent) {
-    /* Scrollable list container */
+    /* Scrollable list container; rows are placed by hand, not by flex */
     log_list = lv_obj_create(parent);
     lv_obj_set_width(log_list, lv_pct(100));
     lv_obj_set_flex_grow(log_list, 1);
     lv_obj_set_style_bg_opa(log_list, LV_OPA_TRANSP, 0);
     lv_obj_set_style_border_width(log_list, 0, 0);
     lv_obj_set_style_pad_all(log_list, 0, 0);
-    lv_obj_set_style_pad_gap(log_list, 2, 0);
-    lv_obj_set_flex_flow(log_list, LV_FLEX_FLOW_COLUMN);
     lv_obj_add_flag(log_list, LV_OBJ_FLAG_SCROLLABLE);
-
-    const vitals_alarm_log_t *alog = vitals_provider_get_alarm_log();
-
-    if (alog->count == 0) {
-        lv_obj_t *empty = lv_label_create(log_list);
-        lv_label_set_text(empty, "No alarms recorded");
-        lv_obj_set_style_text_font(empty, VM_FONT_CAPTION, 0);
-        lv_obj_set_style_text_color(empty, VM_COLOR_TEXT_DISABLED, 0);
-        return;
-    }
-
-    /* Show entries newest-first */
-    int total = alog->count < VITALS_ALARM_LOG_MAX ? alog->count : VITALS_ALARM_LOG_MAX;
-    for (int i = total - 1; i >= 0; i--) {
-        int idx = (alog->write_idx - 1 - (total - 1 - i) + VITALS_ALARM_LOG_MAX) % VITALS_ALARM_LOG_MAX;
-        add_log_entry_to_list(&alog->entries[idx]);
-    }
+    lv_obj_set_scroll_dir(log_list, LV_DIR_VER);
+    lv_obj_add_event_cb(log_list, log_scroll_cb, LV_EVENT_SCROLL, NULL);
+
+    /* Gives the list the scroll height of every loaded event */
+    log_spacer = lv_obj_create(log_list);
+    lv_obj_remove_flag(log_spacer, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_set_style_bg_opa(log_spacer, LV_OPA_TRANSP, 0);
+    lv_obj_set_style_border_width(log_spacer, 0, 0);
+    lv_obj_set_pos(log_spacer, 0, 0);
+    lv_obj_set_size(log_spacer, 1, 0);
+
+    log_empty = lv_label_create(log_list);
+    lv_label_set_text(log_empty, "No alarms recorded");
+    lv_obj_add_flag(log_empty, LV_OBJ_FLAG_HIDDEN);    /* Until read */
+    lv_obj_set_style_text_font(log_empty, VM_FONT_CAPTION, 0);
+    lv_obj_set_style_text_color(log_empty, VM_COLOR_TEXT_DISABLED, 0);
+
+    for (int k = 0; k < LOG_ROW_POOL; k++) create_log_row(&log_rows[k]);
+
+    /* Row count in view depends on the final panel height */
+    lv_obj_update_layout(log_list);
+    alarm_history_set_callback(history_updated_cb, NULL);
+    open_alarm_history();
 }
 
 /* -- Alarm limits table (dynamic from alarm_engine) ---------------- */
@@ -489,18 +680,24 @@ static void refresh_timer_cb(lv_timer_t *timer) {
     (void)timer;
 
     /* Update status label with current alarm engine state */
+    retry_pending_actions();
     update_status_label();
+    show_pending_actions();
 
-    /* Check for new alarm log entries */
-    const vitals_alarm_log_t *alog = vitals_provider_get_alarm_log();
-    if (alog->count > last_log_count && log_list) {
-        /* New alarm entries -- add them to the list */
-        int new_count = alog->count - last_log_count;
-        if (new_count > VITALS_ALARM_LOG_MAX) new_count = VITALS_ALARM_LOG_MAX;
-        for (int i = 0; i < new_count; i++) {
-            int idx = (alog->write_idx - new_count + i + VITALS_ALARM_LOG_MAX) % VITALS_ALARM_LOG_MAX;
-            add_log_entry_to_list(&alog->entries[idx]);
-        }
-        last_log_count = alog->count;
+    if (!log_list) return;
+
+    /* Re-request rows in view whose read failed (no-op when all bound) */
+    bind_visible_rows();
+
+    /* New events (as of the previous poll): show them at once if the
+       newest are in view, else note them until scrolled back to the top */
+    int fresh = alarm_history_poll_new();
+    if (fresh == 0) return;
+    if (lv_obj_get_scroll_y(log_list) < LOG_ROW_H) {
+        open_alarm_history();
+    } else if (fresh != pending_new) {
+        pending_new = fresh;
+        lv_label_set_text_fmt(log_title, "Alarm History (%d%s new)", fresh,
+                              fresh >= ALARM_HISTORY_PAGE_ROWS ? "+" : "");
     }
 }
@@ -4,6 +4,7 @@
  */
 
 #include "screen_manager.h"
+#include "ui_heap.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -19,9 +20,17 @@ static bool         screen_registered[SCREEN_ID_COUNT];
 static lv_timer_t *auto_return_timer = NULL;
 static uint32_t    auto_return_timeout_ms = 0;
 
+/* LVGL heap: allocations are tagged with the screen; optional arenas */
+#define SCREEN_HEAP_TAG(id)   ((uint16_t)((id) + 1))
+
+typedef char screen_heap_tags_fit[(SCREEN_ID_COUNT < UI_HEAP_MAX_TAGS) ? 1 : -1];
+
+static bool arenas_enabled = false;
+
 /* ── Forward declarations ──────────────────────────────────── */
 
 static void load_screen(screen_id_t id);
+static void destroy_current(void);
 static void auto_return_cb(lv_timer_t *timer);
 static void reset_auto_return(void);
 
@@ -54,12 +63,7 @@ void screen_manager_push(screen_id_t id) {
     }
 
     /* Call destroy on current screen if there is one */
-    if (nav_stack_top >= 0) {
-        screen_id_t current = nav_stack[nav_stack_top];
-        if (screen_registry[current].destroy) {
-            screen_registry[current].destroy();
-        }
-    }
+    destroy_current();
 
     nav_stack_top++;
     nav_stack[nav_stack_top] = id;
@@ -78,10 +82,7 @@ void screen_manager_pop(void) {
     }
 
     /* Call destroy on current screen */
-    screen_id_t current = nav_stack[nav_stack_top];
-    if (screen_registry[current].destroy) {
-        screen_registry[current].destroy();
-    }
+    destroy_current();
 
     nav_stack_top--;
     screen_id_t prev = nav_stack[nav_stack_top];
@@ -94,12 +95,7 @@ void screen_manager_pop(void) {
 }
 
 void screen_manager_go_home(void) {
-    if (nav_stack_top >= 0) {
-        screen_id_t current = nav_stack[nav_stack_top];
-        if (screen_registry[current].destroy) {
-            screen_registry[current].destroy();
-        }
-    }
+    destroy_current();
 
     /* Reset stack to just home */
     nav_stack_top = 0;
@@ -140,11 +136,68 @@ void screen_manager_set_auto_return(uint32_t timeout_ms) {
     }
 }
 
+void screen_manager_set_arenas(bool enable) {
+    arenas_enabled = enable;
+    printf("[screen_mgr] Screen heap arenas %s\n", enable ? "on" : "off");
+}
+
+void screen_manager_print_mem(const char *tag) {
+    for (int id = 0; id < SCREEN_ID_COUNT; id++) {
+        ui_heap_tag_stats_t st;
+        if (!screen_registered[id] || !ui_heap_get_tag_stats(SCREEN_HEAP_TAG(id), &st)) {
+            continue;
+        }
+        if (st.peak == 0) continue;         /* Never shown */
+        printf("[%s] LVGL screen %-12s %4u KB in %u blocks, peak %u KB",
+               tag, screen_registry[id].name, (unsigned)(st.bytes / 1024),
+               st.blocks, (unsigned)(st.peak / 1024));
+        if (st.spilled) printf(", %u spilled from arena", st.spilled);
+        printf("\n");
+    }
+
+    for (int i = 0; i < UI_HEAP_MAX_ARENAS; i++) {
+        ui_heap_arena_info_t a;
+        if (!ui_heap_get_arena(i, &a) || a.open) continue;
+        int id = (int)a.tag - 1;
+        printf("[%s] LVGL arena of %s pinned by %u blocks after its screen closed\n",
+               tag, (id >= 0 && id < SCREEN_ID_COUNT) ? screen_registry[id].name : "?",
+               a.blocks);
+    }
+
+    ui_heap_stats_t hs;
+    ui_heap_get_stats(&hs);
+    if (hs.arenas_opened || hs.arenas_failed) {
+        printf("[%s] LVGL arenas opened %u released %u refused %u\n", tag,
+               hs.arenas_opened, hs.arenas_released, hs.arenas_failed);
+    }
+}
+
 /* ── Private helpers ───────────────────────────────────────── */
 
+/** Run the current screen's cleanup; its arena drains as LVGL deletes it. */
+static void destroy_current(void) {
+    if (nav_stack_top < 0) return;
+
+    screen_id_t current = nav_stack[nav_stack_top];
+    if (screen_registry[current].destroy) {
+        screen_registry[current].destroy();
+    }
+    ui_heap_arena_close(SCREEN_HEAP_TAG(current));
+    ui_heap_set_tag(UI_HEAP_TAG_SHARED);
+}
+
 static void load_screen(screen_id_t id) {
     if (!screen_registered[id] || !screen_registry[id].create) return;
 
+    /* Everything allocated from here until the next navigation is the
+     * screen's, including widget updates while it is shown */
+    ui_heap_set_tag(SCREEN_HEAP_TAG(id));
+    if (arenas_enabled && screen_registry[id].arena_bytes > 0 &&
+        !ui_heap_arena_open(SCREEN_HEAP_TAG(id), screen_registry[id].arena_bytes)) {
+        printf("[screen_mgr] No arena for %s, using the shared heap\n",
+               screen_registry[id].name);
+    }
+
     lv_obj_t *new_scr = screen_registry[id].create();
     if (!new_scr) {
         printf("[screen_mgr] Screen create returned NULL for %s\n",
@@ -5,6 +5,10 @@
  * Provides push/pop navigation between screens with auto-return to the
  * main vitals screen after a configurable timeout. Screens are created
  * fresh on each navigation and auto-deleted by LVGL on transition.
+ *
+ * LVGL allocations are charged to the active screen (ui_heap.h).  With
+ * arenas enabled, a screen with `arena_bytes` set allocates from its own
+ * arena, released in one piece once the screen is deleted.
  */
 
 #ifndef SCREEN_MANAGER_H
@@ -40,6 +44,7 @@ typedef struct {
     screen_create_fn_t  create;
     screen_destroy_fn_t destroy;   /* NULL if no cleanup needed */
     const char         *name;      /* For logging/debug */
+    uint32_t            arena_bytes; /* Arena size; 0: shared LVGL heap */
 } screen_reg_t;
 
 /** Initialize the screen manager. Call once at startup. */
@@ -67,4 +72,17 @@ screen_id_t screen_manager_get_active(void);
  */
 void screen_manager_set_auto_return(uint32_t timeout_ms);
 
+/**
+ * Give screens that have `arena_bytes` their own heap arena from the next
+ * navigation on.  Off by default.
+ */
+void screen_manager_set_arenas(bool enable);
+
+/**
+ * Print LVGL heap use per screen (now, high-water mark, arena spills) and
+ * arenas still held after their screen was deleted.
+ * @param tag  Module tag, e.g. "mem".
+ */
+void screen_manager_print_mem(const char *tag);
+
 #endif /* SCREEN_MANAGER_H */
@@ -28,9 +28,11 @@
 #include "widget_alarm_banner.h"
 #include "widget_nav_bar.h"
 #include "theme_vitals.h"
-#include "vitals_provider.h"
 #include "patient_data.h"
+#include "trend_db.h"
+#include "status_board.h"
 #include <stdio.h>
+#include <string.h>
 
 /* -- Module state --------------------------------------------------- */
 
@@ -151,17 +153,19 @@ lv_obj_t * screen_patient_create(void) {
     lv_obj_set_style_text_font(vt, VM_FONT_BODY, 0);
     lv_obj_set_style_text_color(vt, VM_COLOR_TEXT_PRIMARY, 0);
 
-    const vitals_data_t *data = vitals_provider_get_current(0);
+    /* Latest values the data thread published */
+    status_vitals_t data;
+    if (!status_board_read_vitals(0, &data)) memset(&data, 0, sizeof(data));
     char buf[64];
-    snprintf(buf, sizeof(buf), "%d bpm", data->hr);
+    snprintf(buf, sizeof(buf), "%d bpm", data.hr);
     add_info_row(vitals_panel, "HR",   buf, VM_COLOR_HR);
-    snprintf(buf, sizeof(buf), "%d %%", data->spo2);
+    snprintf(buf, sizeof(buf), "%d %%", data.spo2);
     add_info_row(vitals_panel, "SpO2", buf, VM_COLOR_SPO2);
-    snprintf(buf, sizeof(buf), "%d/%d (%d) mmHg", data->nibp_sys, data->nibp_dia, data->nibp_map);
+    snprintf(buf, sizeof(buf), "%d/%d (%d) mmHg", data.nibp_sys, data.nibp_dia, data.nibp_map);
     add_info_row(vitals_panel, "NIBP", buf, VM_COLOR_NIBP);
-    snprintf(buf, sizeof(buf), "%.1f \xc2\xb0""C", (double)data->temp);
+    snprintf(buf, sizeof(buf), "%.1f \xc2\xb0""C", data.temp_x10 / 10.0);
     add_info_row(vitals_panel, "Temp", buf, VM_COLOR_TEMP);
-    snprintf(buf, sizeof(buf), "%d /min", data->rr);
+    snprintf(buf, sizeof(buf), "%d /min", data.rr);
     add_info_row(vitals_panel, "RR",   buf, VM_COLOR_RR);
 
     /* Clinical notes */
@@ -222,8 +226,12 @@ static void discharge_cb(lv_event_t *e) {
     (void)e;
     const patient_t *pt = patient_data_get_active(0);
     if (pt) {
-        printf("[patient] Discharging patient id=%d (%s)\n", (int)pt->id, pt->name);
-        patient_data_discharge(pt->id);
+        int32_t id = pt->id;
+        printf("[patient] Discharging patient id=%d (%s)\n", (int)id, pt->name);
+        patient_data_discharge(id);
+        /* Keep the trends for review; new data goes to the slot's
+         * anonymous partition until the next admission */
+        trend_db_archive_patient(id);
         /* Refresh the screen to reflect the change */
         screen_manager_push(SCREEN_ID_PATIENT);
     }
@@ -6,13 +6,13 @@
  *   ┌──────────────────────────────────────────────────────────────┐
  *   │ ALARM BAR (32px)                                            │
  *   ├──────────────────────────────────────────────────────────────┤
- *   │  Trends  [1h] [4h] [8h] [12h] [24h] [72h]                  │
+ *   │  Trends  [1h] [4h] [8h] [12h] [24h] [72h]  [USB]           │
  *   │ ┌────┬──────────────────────────────────────────────────────┐│
- *   │ │ HR │  green line + red/yellow threshold lines             ││
+ *   │ │ HR │  green line + red/yellow alarm limit lines           ││
  *   │ ├────┼──────────────────────────────────────────────────────┤│
- *   │ │SpO2│  cyan line + threshold lines                        ││
+ *   │ │SpO2│  cyan line + alarm limit lines                      ││
  *   │ ├────┼──────────────────────────────────────────────────────┤│
- *   │ │ RR │  yellow line + threshold lines                      ││
+ *   │ │ RR │  yellow line + alarm limit lines                    ││
  *   │ ├────┼──────────────────────────────────────────────────────┤│
  *   │ │BP/T│  white NIBP scatter + orange Temp overlay           ││
  *   │ └────┴──────────────────────────────────────────────────────┘│
@@ -20,11 +20,43 @@
  *   │ NAV BAR (48px)                                              │
  *   └──────────────────────────────────────────────────────────────┘
  *
- * Data source:
- *   - ≤2h ranges: vitals_raw table (1-sec resolution, downsampled)
- *   - >2h ranges: vitals_1min table (1-min aggregates, downsampled)
+ * Data source (tier chosen per tile by trend_viewport):
+ *   - <8h views: vitals_raw_min table (1-sec samples packed per minute)
+ *     while the samples are within raw retention
+ *   - otherwise: vitals_1min table (1-min aggregates, downsampled)
  *   - NIBP: nibp_measurements table (discrete events)
  *   - Alarms: alarm_events table (vertical markers on HR chart)
+ *
+ * Downsampling is per chart: HR, SpO2 and RR default to LTTB so short
+ * spikes and desaturations keep their height and timing; Temp/BP uses
+ * bucket averages.  Tapping a chart's label toggles its mode.
+ *
+ * Zoom and pan: dragging a chart sideways pans the window along the last
+ * 72 h; dragging it up or down zooms in or out about the press point.
+ * The range buttons jump back to a live window of that length.  Every
+ * gesture frame is redrawn from the tiles trend_viewport holds, never
+ * from SQLite; on release the span snaps to a zoom level and missing
+ * tiles are requested.
+ *
+ * Queries go through trend_query (worker thread, read-only connection),
+ * one tile at a time.  A tile under the window is requested
+ * progressively: rollups paint within a frame or two, then full
+ * resolution replaces them.  Once the window is complete the tiles either
+ * side are prefetched.  A tile under the window preempts a prefetch;
+ * screen teardown cancels whatever is in flight.  The 10 s refresh moves
+ * a live window and refetches only its newest tile.
+ *
+ * Static layer: each chart's grid and the current alarm limits (from
+ * alarm_engine) are drawn once into a narrow ARGB8888 strip that is tiled
+ * across the chart as its background image, under the data series.  The
+ * strip is redrawn only when the chart's height or the limits change
+ * (checked on the 10 s refresh), so a redraw paints the data series and
+ * one image, not a 480-point series per limit line.
+ *
+ * [USB] writes the last 72 h of slot 0's partition to the removable
+ * drive as gzipped CSV (trend_export, background job).  The button shows
+ * progress while it runs; tapping it again cancels.  The export outlives
+ * the screen, which only polls its status.
  */
 
 #include "screen_trends.h"
@@ -32,8 +64,13 @@
 #include "widget_alarm_banner.h"
 #include "widget_nav_bar.h"
 #include "theme_vitals.h"
-#include "vitals_provider.h"
 #include "trend_db.h"
+#include "trend_query.h"
+#include "trend_viewport.h"
+#include "trend_export.h"
+#include "alarm_engine.h"
+#include "status_board.h"
+#include "mem_budget.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -43,20 +80,19 @@
 #define RANGE_COUNT         6
 #define MAX_ALARM_MARKERS   20
 #define REFRESH_INTERVAL_MS 10000  /* 10 seconds */
+#define EXPORT_POLL_MS      500
+#define EXPORT_RANGE_S      (72u * 3600u)
 
-/* Alarm threshold values (must match main.c evaluate_alarms) */
-#define THRESH_HR_CRIT_HI   150
-#define THRESH_HR_WARN_HI   120
-#define THRESH_HR_WARN_LO    50
-#define THRESH_HR_CRIT_LO    40
-
-#define THRESH_SPO2_CRIT_LO  85
-#define THRESH_SPO2_WARN_LO  90
+/* Drag gestures */
+#define DRAG_SLOP_PX        8      /* Movement before a drag picks an axis */
+#define ZOOM_PX             120    /* Vertical drag that doubles/halves span */
 
-#define THRESH_RR_CRIT_HI    30
-#define THRESH_RR_WARN_HI    24
-#define THRESH_RR_WARN_LO    10
-#define THRESH_RR_CRIT_LO     8
+/* Static chart layer */
+#define LAYER_STRIP_W       16     /* Image width, tiled across the chart */
+#define LAYER_PIXELS        (LAYER_STRIP_W * 128)  /* Taller: narrower strip */
+#define GRID_LINES          3
+#define GRID_COLOR          lv_color_hex(0x222222)
+#define NO_ALARM_PARAM      (-1)   /* Grid only */
 
 /* Time range presets */
 static const trend_range_t range_values[RANGE_COUNT] = {
@@ -72,7 +108,8 @@ static const char *range_texts[RANGE_COUNT] = {
 static widget_alarm_banner_t *alarm_banner;
 static widget_nav_bar_t      *nav_bar;
 
-/* Time range selector */
+/* Time range selector (-1: zoomed to a span with no button) */
+static lv_obj_t *title_label;
 static lv_obj_t *range_btns[RANGE_COUNT];
 static lv_obj_t *range_btn_labels[RANGE_COUNT];
 static int       active_range_idx = 0;
@@ -80,46 +117,88 @@ static int       active_range_idx = 0;
 /* Charts */
 static lv_obj_t *hr_chart, *spo2_chart, *rr_chart, *nibp_temp_chart;
 
-/* Data series (added last so they draw on top of thresholds) */
+/* Per-chart downsampling (kept across screen visits) and mode labels */
+static const char *chart_titles[TREND_PARAM_COUNT] = {
+    "HR", "SpO2", "RR", "BP/T"
+};
+static trend_downsample_t chart_ds[TREND_PARAM_COUNT] = {
+    TREND_DS_LTTB, TREND_DS_LTTB, TREND_DS_LTTB, TREND_DS_AVG
+};
+static lv_obj_t *chart_labels[TREND_PARAM_COUNT];
+
+/* Data series */
 static lv_chart_series_t *hr_series;
 static lv_chart_series_t *spo2_series;
 static lv_chart_series_t *rr_series;
 static lv_chart_series_t *nibp_sys_series, *nibp_dia_series;
 static lv_chart_series_t *temp_series;
 
-/* Threshold series (added first so they draw behind data) */
-static lv_chart_series_t *hr_th[4];    /* hi-crit, hi-warn, lo-warn, lo-crit */
-static lv_chart_series_t *spo2_th[2];  /* lo-crit, lo-warn */
-static lv_chart_series_t *rr_th[4];    /* hi-crit, hi-warn, lo-warn, lo-crit */
-
-/* Alarm event markers (thin colored bars on HR chart) */
+/*
+ * Grid and alarm limit lines of one chart, all horizontal: one strip
+ * as tall as the chart, tiled as its background image.  It is
+ * LAYER_STRIP_W wide up to 128 px of chart and narrower above, so the
+ * tile never repeats vertically.  Kept across visits (8 KB each).
+ */
+typedef struct {
+    lv_obj_t       *chart;
+    int             alarm_param;    /* alarm_param_t, or NO_ALARM_PARAM */
+    int             y_min, y_max;
+    int32_t         height;         /* Chart height drawn for (0: not yet) */
+    int32_t         width;          /* Strip width for that height */
+    alarm_limits_t  limits;         /* Limits drawn */
+    lv_image_dsc_t  image;
+    uint32_t        px[LAYER_PIXELS];   /* ARGB8888, width x height */
+} chart_layer_t;
+
+static chart_layer_t layers[TREND_PARAM_COUNT];
+MEM_BUDGET_ASSERT(trend_layers, sizeof(layers), MEM_BUDGET_TREND_LAYERS);
+
+/* Alarm event markers (thin colored bars on HR chart), hidden when unused */
 static lv_obj_t *alarm_markers[MAX_ALARM_MARKERS];
 static int       alarm_marker_count = 0;
 
+/* Drag gesture in progress: the axis is picked once past DRAG_SLOP_PX */
+typedef enum { DRAG_NONE = 0, DRAG_PAN, DRAG_ZOOM } drag_mode_t;
+
+static drag_mode_t drag_mode = DRAG_NONE;
+static lv_point_t  drag_total;          /* Movement since press (px) */
+static int32_t     drag_panned_s;       /* Pan applied so far */
+static uint32_t    drag_span_s;         /* Span at press */
+static uint32_t    drag_anchor_ts;      /* Time under the press point */
+
+/* Tile being fetched (valid while trend_query_busy()) */
+static trend_viewport_fetch_t inflight;
+
 /* Refresh timer */
 static lv_timer_t *refresh_timer;
 
-/* Static query result buffers (avoids heap allocation) */
-static trend_query_result_t query_buf;
-static trend_nibp_result_t  nibp_buf;
-static trend_alarm_result_t alarm_buf;
+/* USB export */
+static lv_obj_t   *export_btn;
+static lv_obj_t   *export_label;
+static lv_timer_t *export_timer;
+
 
 /* ── Forward declarations ──────────────────────────────────── */
 
-static lv_obj_t * create_trend_chart(lv_obj_t *parent, const char *title,
-                                      lv_color_t color, int y_min, int y_max);
-static lv_chart_series_t * add_threshold_series(lv_obj_t *chart, int value,
-                                                 lv_color_t color);
-static void populate_chart_from_db(lv_obj_t *chart, lv_chart_series_t *series,
-                                    trend_param_t param,
-                                    uint32_t start_ts, uint32_t end_ts);
-static void populate_nibp_from_db(uint32_t start_ts, uint32_t end_ts);
-static void populate_temp_from_db(uint32_t start_ts, uint32_t end_ts);
-static void update_alarm_markers(uint32_t start_ts, uint32_t end_ts);
-static void clear_alarm_markers(void);
-static void refresh_all_charts(void);
+static lv_obj_t * create_trend_chart(lv_obj_t *parent, trend_param_t param,
+                                      int alarm_param, lv_color_t color,
+                                      int y_min, int y_max);
+static void update_layers(void);
+static void chart_size_cb(lv_event_t *e);
+static void render_series(lv_obj_t *chart, lv_chart_series_t *series,
+                          trend_param_t param);
+static void render_nibp(void);
+static void render_alarm_markers(void);
+static void render_view(void);
+static void on_tile_result(const trend_query_set_t *set, void *user_data);
+static void fetch_next(void);
+static void chart_drag_cb(lv_event_t *e);
 static void refresh_timer_cb(lv_timer_t *timer);
 static void range_btn_cb(lv_event_t *e);
+static void export_btn_cb(lv_event_t *e);
+static void export_timer_cb(lv_timer_t *timer);
+static void chart_label_cb(lv_event_t *e);
+static void update_chart_label(trend_param_t param);
 static void update_range_highlight(void);
 static uint32_t get_current_ts(void);
 
@@ -158,11 +237,11 @@ lv_obj_t * screen_trends_create(void) {
     lv_obj_set_flex_align(title_row, LV_FLEX_ALIGN_START,
                           LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
 
-    lv_obj_t *title = lv_label_create(title_row);
-    lv_label_set_text(title, "Trends");
-    lv_obj_set_style_text_font(title, VM_FONT_BODY, 0);
-    lv_obj_set_style_text_color(title, VM_COLOR_TEXT_PRIMARY, 0);
-    lv_obj_set_width(title, 65);
+    title_label = lv_label_create(title_row);
+    lv_label_set_text(title_label, "Trends");
+    lv_obj_set_style_text_font(title_label, VM_FONT_BODY, 0);
+    lv_obj_set_style_text_color(title_label, VM_COLOR_TEXT_PRIMARY, 0);
+    lv_obj_set_width(title_label, 65);
 
     for (int i = 0; i < RANGE_COUNT; i++) {
         range_btns[i] = lv_button_create(title_row);
@@ -182,33 +261,48 @@ lv_obj_t * screen_trends_create(void) {
                             LV_EVENT_CLICKED, (void *)(intptr_t)i);
     }
 
+    export_btn = lv_button_create(title_row);
+    lv_obj_set_size(export_btn, 56, 24);
+    lv_obj_set_style_radius(export_btn, 4, 0);
+    lv_obj_set_style_pad_all(export_btn, 2, 0);
+    lv_obj_set_style_bg_color(export_btn, VM_COLOR_BG, 0);
+    lv_obj_set_style_border_width(export_btn, 1, 0);
+    lv_obj_set_style_border_color(export_btn, VM_COLOR_BG_PANEL_BORDER, 0);
+
+    export_label = lv_label_create(export_btn);
+    lv_obj_set_style_text_font(export_label, VM_FONT_SMALL, 0);
+    lv_obj_set_style_text_color(export_label, VM_COLOR_TEXT_SECONDARY, 0);
+    lv_obj_center(export_label);
+    lv_obj_add_event_cb(export_btn, export_btn_cb, LV_EVENT_CLICKED, NULL);
+
+    export_timer = lv_timer_create(export_timer_cb, EXPORT_POLL_MS, NULL);
+    export_timer_cb(export_timer);
+
     active_range_idx = 0;
+    trend_viewport_set_patient(trend_db_slot_patient(0));
+    trend_viewport_reset((uint32_t)range_values[active_range_idx],
+                         get_current_ts());
     update_range_highlight();
 
     /* ── HR chart ────────────────────────────────────────── */
-    hr_chart = create_trend_chart(content, "HR", VM_COLOR_HR, 40, 160);
-    hr_th[0] = add_threshold_series(hr_chart, THRESH_HR_CRIT_HI, VM_COLOR_ALARM_HIGH);
-    hr_th[1] = add_threshold_series(hr_chart, THRESH_HR_WARN_HI, VM_COLOR_ALARM_MEDIUM);
-    hr_th[2] = add_threshold_series(hr_chart, THRESH_HR_WARN_LO, VM_COLOR_ALARM_MEDIUM);
-    hr_th[3] = add_threshold_series(hr_chart, THRESH_HR_CRIT_LO, VM_COLOR_ALARM_HIGH);
+    hr_chart = create_trend_chart(content, TREND_PARAM_HR, ALARM_PARAM_HR,
+                                  VM_COLOR_HR, 40, 160);
     hr_series = lv_chart_add_series(hr_chart, VM_COLOR_HR, LV_CHART_AXIS_PRIMARY_Y);
 
     /* ── SpO2 chart ──────────────────────────────────────── */
-    spo2_chart = create_trend_chart(content, "SpO2", VM_COLOR_SPO2, 80, 100);
-    spo2_th[0] = add_threshold_series(spo2_chart, THRESH_SPO2_CRIT_LO, VM_COLOR_ALARM_HIGH);
-    spo2_th[1] = add_threshold_series(spo2_chart, THRESH_SPO2_WARN_LO, VM_COLOR_ALARM_MEDIUM);
+    spo2_chart = create_trend_chart(content, TREND_PARAM_SPO2, ALARM_PARAM_SPO2,
+                                    VM_COLOR_SPO2, 80, 100);
     spo2_series = lv_chart_add_series(spo2_chart, VM_COLOR_SPO2, LV_CHART_AXIS_PRIMARY_Y);
 
     /* ── RR chart ────────────────────────────────────────── */
-    rr_chart = create_trend_chart(content, "RR", VM_COLOR_RR, 5, 35);
-    rr_th[0] = add_threshold_series(rr_chart, THRESH_RR_CRIT_HI, VM_COLOR_ALARM_HIGH);
-    rr_th[1] = add_threshold_series(rr_chart, THRESH_RR_WARN_HI, VM_COLOR_ALARM_MEDIUM);
-    rr_th[2] = add_threshold_series(rr_chart, THRESH_RR_WARN_LO, VM_COLOR_ALARM_MEDIUM);
-    rr_th[3] = add_threshold_series(rr_chart, THRESH_RR_CRIT_LO, VM_COLOR_ALARM_HIGH);
+    rr_chart = create_trend_chart(content, TREND_PARAM_RR, ALARM_PARAM_RR,
+                                  VM_COLOR_RR, 5, 35);
     rr_series = lv_chart_add_series(rr_chart, VM_COLOR_RR, LV_CHART_AXIS_PRIMARY_Y);
 
     /* ── NIBP + Temperature chart ────────────────────────── */
-    nibp_temp_chart = create_trend_chart(content, "BP/T", VM_COLOR_NIBP, 40, 200);
+    nibp_temp_chart = create_trend_chart(content, TREND_PARAM_TEMP,
+                                         NO_ALARM_PARAM, VM_COLOR_NIBP,
+                                         40, 200);
     lv_chart_set_range(nibp_temp_chart, LV_CHART_AXIS_SECONDARY_Y, 350, 400);
     nibp_sys_series = lv_chart_add_series(nibp_temp_chart, VM_COLOR_NIBP,
                                            LV_CHART_AXIS_PRIMARY_Y);
@@ -218,8 +312,12 @@ lv_obj_t * screen_trends_create(void) {
     temp_series = lv_chart_add_series(nibp_temp_chart, VM_COLOR_TEMP,
                                        LV_CHART_AXIS_SECONDARY_Y);
 
-    /* Initial data load */
-    refresh_all_charts();
+    /* Initial data load: tiles kept from a previous visit draw at once */
+    for (int p = 0; p < TREND_PARAM_COUNT; p++) {
+        trend_query_set_downsample((trend_param_t)p, chart_ds[p]);
+    }
+    render_view();
+    fetch_next();
 
     /* Auto-refresh every 10 seconds */
     refresh_timer = lv_timer_create(refresh_timer_cb, REFRESH_INTERVAL_MS, NULL);
@@ -238,19 +336,32 @@ void screen_trends_destroy(void) {
         lv_timer_delete(refresh_timer);
         refresh_timer = NULL;
     }
+    if (export_timer) {
+        lv_timer_delete(export_timer);
+        export_timer = NULL;
+    }
     widget_alarm_banner_free(alarm_banner);
     widget_nav_bar_free(nav_bar);
 
     alarm_banner = NULL;
     nav_bar = NULL;
+    title_label = NULL;
+    export_btn = export_label = NULL;
     hr_chart = spo2_chart = rr_chart = nibp_temp_chart = NULL;
+    memset(chart_labels, 0, sizeof(chart_labels));
     hr_series = spo2_series = rr_series = NULL;
     nibp_sys_series = nibp_dia_series = temp_series = NULL;
-    memset(hr_th, 0, sizeof(hr_th));
-    memset(spo2_th, 0, sizeof(spo2_th));
-    memset(rr_th, 0, sizeof(rr_th));
+    for (int p = 0; p < TREND_PARAM_COUNT; p++) {
+        layers[p].chart = NULL;
+        layers[p].height = 0;
+    }
     alarm_marker_count = 0;
     memset(alarm_markers, 0, sizeof(alarm_markers));
+    drag_mode = DRAG_NONE;
+
+    /* Any query still running belongs to this instance; drop its result.
+     * Tiles already held stay in trend_viewport for the next visit. */
+    trend_query_cancel();
 
     printf("[trends] Screen destroyed\n");
 }
@@ -258,13 +369,34 @@ void screen_trends_destroy(void) {
 /* ── Private helpers ───────────────────────────────────────── */
 
 static uint32_t get_current_ts(void) {
-    const vitals_data_t *d = vitals_provider_get_current(0);
-    return d ? (uint32_t)(d->timestamp_ms / 1000) : 0;
+    /* Written by the data thread; the provider's snapshot is not ours */
+    status_vitals_t v;
+    return status_board_read_vitals(0, &v) ? (uint32_t)(v.timestamp_ms / 1000) : 0;
 }
 
 /* ── Time range selector ──────────────────────────────────── */
 
+/** Highlight the button matching the span; the title shows how far back. */
 static void update_range_highlight(void) {
+    uint32_t span = trend_viewport_span();
+    active_range_idx = -1;
+    for (int i = 0; i < RANGE_COUNT; i++) {
+        if ((uint32_t)range_values[i] == span) active_range_idx = i;
+    }
+
+    if (title_label) {
+        if (trend_viewport_is_live()) {
+            lv_label_set_text(title_label, "Trends");
+        } else {
+            uint32_t end;
+            trend_viewport_get_window(NULL, &end);
+            uint32_t back_m = (get_current_ts() - end) / 60;
+            lv_label_set_text_fmt(title_label, "-%uh%02u",
+                                  (unsigned)(back_m / 60),
+                                  (unsigned)(back_m % 60));
+        }
+    }
+
     for (int i = 0; i < RANGE_COUNT; i++) {
         if (i == active_range_idx) {
             lv_obj_set_style_bg_color(range_btns[i], VM_COLOR_BG_PANEL_BORDER, 0);
@@ -278,18 +410,90 @@ static void update_range_highlight(void) {
 
 static void range_btn_cb(lv_event_t *e) {
     int idx = (int)(intptr_t)lv_event_get_user_data(e);
-    if (idx < 0 || idx >= RANGE_COUNT || idx == active_range_idx) return;
+    if (idx < 0 || idx >= RANGE_COUNT) return;
+    if (idx == active_range_idx && trend_viewport_is_live()) return;
 
-    active_range_idx = idx;
+    /* Back to a live window of that length */
+    trend_viewport_reset((uint32_t)range_values[idx], get_current_ts());
     update_range_highlight();
-    refresh_all_charts();
+    render_view();
+    fetch_next();
     printf("[trends] Range changed to %s\n", range_texts[idx]);
 }
 
+/* ── USB export ───────────────────────────────────────────── */
+
+static void export_btn_cb(lv_event_t *e) {
+    (void)e;
+    if (trend_export_busy()) {
+        trend_export_cancel();
+        printf("[trends] USB export cancel requested\n");
+        return;
+    }
+
+    uint32_t now = get_current_ts();
+    uint32_t start_ts = (now > EXPORT_RANGE_S) ? now - EXPORT_RANGE_S : 0;
+    int32_t pid = trend_db_slot_patient(0);
+    char path[TREND_EXPORT_PATH_MAX];
+
+    if (!trend_export_make_path(path, sizeof(path), TREND_EXPORT_USB_DIR,
+                                pid, now, TREND_EXPORT_CSV, true) ||
+        !trend_export_start(pid, start_ts, now, TREND_EXPORT_CSV, true,
+                            path, NULL, NULL)) {
+        printf("[trends] USB export could not start\n");
+    }
+    export_timer_cb(export_timer);
+}
+
+static void export_timer_cb(lv_timer_t *timer) {
+    (void)timer;
+    if (!export_label) return;
+
+    trend_export_status_t st = trend_export_get_status();
+    switch (st.state) {
+    case TREND_EXPORT_RUNNING:
+        lv_label_set_text_fmt(export_label, "%d%%", (int)st.percent);
+        break;
+    case TREND_EXPORT_DONE:
+        lv_label_set_text(export_label, "Saved");
+        break;
+    case TREND_EXPORT_FAILED:
+        lv_label_set_text(export_label, "Failed");
+        break;
+    default:
+        lv_label_set_text(export_label, "USB");
+        break;
+    }
+}
+
+/* ── Downsampling selector ────────────────────────────────── */
+
+static void update_chart_label(trend_param_t param) {
+    if (!chart_labels[param]) return;
+    lv_label_set_text_fmt(chart_labels[param], "%s\n%s",
+                          chart_titles[param],
+                          chart_ds[param] == TREND_DS_LTTB ? "lttb" : "avg");
+}
+
+static void chart_label_cb(lv_event_t *e) {
+    trend_param_t param = (trend_param_t)(intptr_t)lv_event_get_user_data(e);
+    if (param < 0 || param >= TREND_PARAM_COUNT) return;
+
+    chart_ds[param] = (chart_ds[param] == TREND_DS_LTTB)
+                      ? TREND_DS_AVG : TREND_DS_LTTB;
+    trend_query_set_downsample(param, chart_ds[param]);
+    update_chart_label(param);
+    trend_viewport_expire();    /* Old samples stay up until replaced */
+    fetch_next();
+    printf("[trends] %s downsampling: %s\n", chart_titles[param],
+           chart_ds[param] == TREND_DS_LTTB ? "LTTB" : "average");
+}
+
 /* ── Chart creation ───────────────────────────────────────── */
 
-static lv_obj_t * create_trend_chart(lv_obj_t *parent, const char *title,
-                                      lv_color_t color, int y_min, int y_max) {
+static lv_obj_t * create_trend_chart(lv_obj_t *parent, trend_param_t param,
+                                      int alarm_param, lv_color_t color,
+                                      int y_min, int y_max) {
     /* Row container: label on left, chart fills rest */
     lv_obj_t *row = lv_obj_create(parent);
     lv_obj_remove_flag(row, LV_OBJ_FLAG_SCROLLABLE);
@@ -304,14 +508,18 @@ static lv_obj_t * create_trend_chart(lv_obj_t *parent, const char *title,
     lv_obj_set_flex_flow(row, LV_FLEX_FLOW_ROW);
     lv_obj_set_style_pad_gap(row, VM_PAD_SMALL, 0);
 
-    /* Label column */
+    /* Label column: title + downsampling mode, tap to toggle */
     lv_obj_t *lbl = lv_label_create(row);
-    lv_label_set_text(lbl, title);
     lv_obj_set_style_text_font(lbl, VM_FONT_CAPTION, 0);
     lv_obj_set_style_text_color(lbl, color, 0);
     lv_obj_set_width(lbl, 38);
     lv_obj_set_style_text_align(lbl, LV_TEXT_ALIGN_LEFT, 0);
     lv_obj_set_style_pad_top(lbl, VM_PAD_NORMAL, 0);
+    lv_obj_add_flag(lbl, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_event_cb(lbl, chart_label_cb, LV_EVENT_CLICKED,
+                        (void *)(intptr_t)param);
+    chart_labels[param] = lbl;
+    update_chart_label(param);
 
     /* Chart */
     lv_obj_t *chart = lv_chart_create(row);
@@ -320,7 +528,7 @@ static lv_obj_t * create_trend_chart(lv_obj_t *parent, const char *title,
     lv_chart_set_type(chart, LV_CHART_TYPE_LINE);
     lv_chart_set_point_count(chart, CHART_POINTS);
     lv_chart_set_range(chart, LV_CHART_AXIS_PRIMARY_Y, y_min, y_max);
-    lv_chart_set_div_line_count(chart, 3, 0);
+    lv_chart_set_div_line_count(chart, 0, 0);   /* Grid is in the layer */
 
     /* Chart styling */
     lv_obj_set_style_bg_color(chart, VM_COLOR_BG, 0);
@@ -331,155 +539,330 @@ static lv_obj_t * create_trend_chart(lv_obj_t *parent, const char *title,
     lv_obj_set_style_line_width(chart, 2, LV_PART_ITEMS);
     lv_obj_set_style_size(chart, 0, 0, LV_PART_INDICATOR);
 
+    /* Drag to pan/zoom; keep the drag even if the finger leaves the chart */
+    lv_obj_add_flag(chart, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_PRESS_LOCK);
+    lv_obj_remove_flag(chart, LV_OBJ_FLAG_GESTURE_BUBBLE);
+    lv_obj_add_event_cb(chart, chart_drag_cb, LV_EVENT_PRESSED, NULL);
+    lv_obj_add_event_cb(chart, chart_drag_cb, LV_EVENT_PRESSING, NULL);
+    lv_obj_add_event_cb(chart, chart_drag_cb, LV_EVENT_RELEASED, NULL);
+    lv_obj_add_event_cb(chart, chart_drag_cb, LV_EVENT_PRESS_LOST, NULL);
+
+    /* Static layer, drawn once the chart has a size */
+    chart_layer_t *l = &layers[param];
+    l->chart = chart;
+    l->alarm_param = alarm_param;
+    l->y_min = y_min;
+    l->y_max = y_max;
+    l->height = 0;
+    lv_obj_set_style_bg_image_tiled(chart, true, 0);
+    lv_obj_add_event_cb(chart, chart_size_cb, LV_EVENT_SIZE_CHANGED, NULL);
+
     return chart;
 }
 
-static lv_chart_series_t * add_threshold_series(lv_obj_t *chart, int value,
-                                                 lv_color_t color) {
-    lv_chart_series_t *ser = lv_chart_add_series(chart, color,
-                                                  LV_CHART_AXIS_PRIMARY_Y);
-    int32_t *y = lv_chart_get_series_y_array(chart, ser);
-    for (int i = 0; i < CHART_POINTS; i++) {
-        y[i] = value;
+/* ── Static chart layer (grid + alarm limits) ────────────── */
+
+static void layer_fill_row(chart_layer_t *l, int32_t y, uint32_t argb) {
+    if (y < 0 || y >= l->height) return;
+    for (int32_t x = 0; x < l->width; x++) {
+        l->px[y * l->width + x] = argb;
     }
-    return ser;
 }
 
-/* ── Data population from SQLite ──────────────────────────── */
+/**
+ * A limit as a 2 px line where lv_chart would draw that value (rows y - 1
+ * and y).  Limits outside the chart's range (SpO2's 9999) are skipped.
+ */
+static void layer_limit_line(chart_layer_t *l, int32_t pad_top, int32_t h,
+                             int value, lv_color_t color) {
+    if (value < l->y_min || value > l->y_max || l->y_max <= l->y_min) return;
+    int32_t y = pad_top + h -
+                (int32_t)((int64_t)(value - l->y_min) * h /
+                          (l->y_max - l->y_min));
+    uint32_t argb = lv_color_to_u32(color);
+    layer_fill_row(l, y - 1, argb);
+    layer_fill_row(l, y, argb);
+}
 
-static void populate_chart_from_db(lv_obj_t *chart, lv_chart_series_t *series,
-                                    trend_param_t param,
-                                    uint32_t start_ts, uint32_t end_ts) {
-    if (!chart || !series) return;
+static bool limits_equal(const alarm_limits_t *a, const alarm_limits_t *b) {
+    return a->critical_high == b->critical_high &&
+           a->critical_low  == b->critical_low  &&
+           a->warning_high  == b->warning_high  &&
+           a->warning_low   == b->warning_low   &&
+           a->enabled       == b->enabled;
+}
 
-    trend_db_query_param(param, start_ts, end_ts, CHART_POINTS, &query_buf);
+static const alarm_limits_t *layer_limits(const chart_layer_t *l) {
+    if (l->alarm_param == NO_ALARM_PARAM) return NULL;
+    return alarm_engine_get_limits((alarm_param_t)l->alarm_param);
+}
 
-    int32_t *y = lv_chart_get_series_y_array(chart, series);
+static int32_t layer_height(const chart_layer_t *l) {
+    return lv_obj_get_height(l->chart);
+}
 
-    /* Leading gap filled with NONE (no data yet for that time window) */
-    int gap = CHART_POINTS - query_buf.count;
-    for (int i = 0; i < gap; i++) {
-        y[i] = LV_CHART_POINT_NONE;
+/** Redraw the strip for the chart's current height and limits. */
+static void build_layer(chart_layer_t *l) {
+    int32_t height = layer_height(l);
+    if (height <= 0) return;
+    l->height = height;
+
+    const alarm_limits_t *lim = layer_limits(l);
+    memset(&l->limits, 0, sizeof(l->limits));
+    if (lim) l->limits = *lim;
+
+    /* Even a 1 px strip is too short: lv_chart's own grid, no limits */
+    if (height > LAYER_PIXELS) {
+        printf("[trends] Chart taller than static layer (%d px)\n",
+               LAYER_PIXELS);
+        l->width = 0;
+        lv_obj_set_style_bg_image_src(l->chart, NULL, 0);
+        lv_chart_set_div_line_count(l->chart, GRID_LINES, 0);
+        return;
     }
-    for (int i = 0; i < query_buf.count; i++) {
-        y[gap + i] = query_buf.value[i];
+    l->width = LV_MIN(LAYER_STRIP_W, LAYER_PIXELS / height);
+    lv_chart_set_div_line_count(l->chart, 0, 0);
+
+    uint32_t bg = lv_color_to_u32(VM_COLOR_BG);
+    for (int32_t y = 0; y < height; y++) layer_fill_row(l, y, bg);
+
+    /* Where lv_chart puts its division lines */
+    int32_t pad_top = lv_obj_get_style_pad_top(l->chart, LV_PART_MAIN);
+    int32_t h = lv_obj_get_content_height(l->chart);
+    uint32_t grid = lv_color_to_u32(GRID_COLOR);
+    for (int i = 0; i < GRID_LINES; i++) {
+        layer_fill_row(l, pad_top + h * i / (GRID_LINES - 1), grid);
     }
-    lv_chart_refresh(chart);
-}
 
-static void populate_nibp_from_db(uint32_t start_ts, uint32_t end_ts) {
-    if (!nibp_temp_chart || !nibp_sys_series || !nibp_dia_series) return;
-
-    trend_db_query_nibp(start_ts, end_ts, &nibp_buf);
+    /* Warning lines first so critical ones win where they meet */
+    if (lim && lim->enabled) {
+        layer_limit_line(l, pad_top, h, lim->warning_high,  VM_COLOR_ALARM_MEDIUM);
+        layer_limit_line(l, pad_top, h, lim->warning_low,   VM_COLOR_ALARM_MEDIUM);
+        layer_limit_line(l, pad_top, h, lim->critical_high, VM_COLOR_ALARM_HIGH);
+        layer_limit_line(l, pad_top, h, lim->critical_low,  VM_COLOR_ALARM_HIGH);
+    }
 
-    int32_t *sys_y = lv_chart_get_series_y_array(nibp_temp_chart, nibp_sys_series);
-    int32_t *dia_y = lv_chart_get_series_y_array(nibp_temp_chart, nibp_dia_series);
+    l->image.header.magic  = LV_IMAGE_HEADER_MAGIC;
+    l->image.header.cf     = LV_COLOR_FORMAT_ARGB8888;
+    l->image.header.flags  = 0;
+    l->image.header.w      = (uint32_t)l->width;
+    l->image.header.h      = (uint32_t)height;
+    l->image.header.stride = (uint32_t)l->width * sizeof(uint32_t);
+    l->image.data_size     = (uint32_t)(height * l->width) * sizeof(uint32_t);
+    l->image.data          = (const uint8_t *)l->px;
+
+    /* Same source pointer, new pixels: drop anything decoded from it */
+    lv_image_cache_drop(&l->image);
+    lv_obj_set_style_bg_image_src(l->chart, &l->image, 0);
+    lv_obj_invalidate(l->chart);
+}
 
-    /* All points start as NONE (NIBP is sparse) */
-    for (int i = 0; i < CHART_POINTS; i++) {
-        sys_y[i] = LV_CHART_POINT_NONE;
-        dia_y[i] = LV_CHART_POINT_NONE;
-    }
+/** Rebuild the layers whose chart height or alarm limits changed. */
+static void update_layers(void) {
+    for (int p = 0; p < TREND_PARAM_COUNT; p++) {
+        chart_layer_t *l = &layers[p];
+        if (!l->chart) continue;
 
-    uint32_t range = end_ts - start_ts;
-    if (range == 0) return;
-
-    for (int i = 0; i < nibp_buf.count; i++) {
-        int pos = (int)((uint64_t)(nibp_buf.timestamp_s[i] - start_ts)
-                        * CHART_POINTS / range);
-        if (pos >= 0 && pos < CHART_POINTS) {
-            sys_y[pos] = nibp_buf.sys[i];
-            dia_y[pos] = nibp_buf.dia[i];
+        const alarm_limits_t *lim = layer_limits(l);
+        if (layer_height(l) != l->height ||
+            (lim && !limits_equal(lim, &l->limits))) {
+            build_layer(l);
         }
     }
-    lv_chart_refresh(nibp_temp_chart);
 }
 
-static void populate_temp_from_db(uint32_t start_ts, uint32_t end_ts) {
-    if (!nibp_temp_chart || !temp_series) return;
+static void chart_size_cb(lv_event_t *e) {
+    (void)e;
+    update_layers();
+}
 
-    trend_db_query_param(TREND_PARAM_TEMP, start_ts, end_ts,
-                          CHART_POINTS, &query_buf);
+/* ── Rendering from held tiles (no queries) ──────────────── */
 
-    int32_t *y = lv_chart_get_series_y_array(nibp_temp_chart, temp_series);
+static void render_series(lv_obj_t *chart, lv_chart_series_t *series,
+                          trend_param_t param) {
+    if (!chart || !series) return;
+    trend_viewport_render(param, lv_chart_get_series_y_array(chart, series),
+                          CHART_POINTS, LV_CHART_POINT_NONE);
+    lv_chart_refresh(chart);
+}
 
-    int gap = CHART_POINTS - query_buf.count;
-    for (int i = 0; i < gap; i++) {
-        y[i] = LV_CHART_POINT_NONE;
-    }
-    for (int i = 0; i < query_buf.count; i++) {
-        y[gap + i] = query_buf.value[i];  /* Already x10 from DB */
-    }
+static void render_nibp(void) {
+    if (!nibp_temp_chart || !nibp_sys_series || !nibp_dia_series) return;
+    trend_viewport_render_nibp(
+        lv_chart_get_series_y_array(nibp_temp_chart, nibp_sys_series),
+        lv_chart_get_series_y_array(nibp_temp_chart, nibp_dia_series),
+        CHART_POINTS, LV_CHART_POINT_NONE);
     lv_chart_refresh(nibp_temp_chart);
 }
 
 /* ── Alarm event markers ──────────────────────────────────── */
 
-static void clear_alarm_markers(void) {
-    for (int i = 0; i < alarm_marker_count; i++) {
-        if (alarm_markers[i]) {
-            lv_obj_delete(alarm_markers[i]);
-            alarm_markers[i] = NULL;
-        }
-    }
-    alarm_marker_count = 0;
-}
-
-static void update_alarm_markers(uint32_t start_ts, uint32_t end_ts) {
-    clear_alarm_markers();
+/** Place markers from a pool that grows to MAX_ALARM_MARKERS, hiding spares. */
+static void render_alarm_markers(void) {
     if (!hr_chart) return;
 
-    trend_db_query_alarms(start_ts, end_ts, &alarm_buf);
-    if (alarm_buf.count == 0) return;
+    trend_viewport_mark_t marks[MAX_ALARM_MARKERS];
+    int n = trend_viewport_marks(marks, MAX_ALARM_MARKERS);
 
     lv_obj_update_layout(hr_chart);
     int32_t chart_w = lv_obj_get_content_width(hr_chart);
     int32_t chart_h = lv_obj_get_content_height(hr_chart);
+    uint32_t start_ts, end_ts;
+    trend_viewport_get_window(&start_ts, &end_ts);
     uint32_t range = end_ts - start_ts;
-    if (range == 0 || chart_w <= 0 || chart_h <= 0) return;
+    if (range == 0 || chart_w <= 0 || chart_h <= 0) n = 0;
 
-    int limit = alarm_buf.count < MAX_ALARM_MARKERS
-              ? alarm_buf.count : MAX_ALARM_MARKERS;
-
-    for (int i = 0; i < limit; i++) {
-        if (alarm_buf.timestamp_s[i] < start_ts) continue;
-        int x = (int)((uint64_t)(alarm_buf.timestamp_s[i] - start_ts)
+    int shown = 0;
+    for (int i = 0; i < n; i++) {
+        int x = (int)((uint64_t)(marks[i].timestamp_s - start_ts)
                        * chart_w / range);
         if (x < 0 || x >= chart_w) continue;
 
-        lv_obj_t *m = lv_obj_create(hr_chart);
-        lv_obj_remove_flag(m, LV_OBJ_FLAG_SCROLLABLE | LV_OBJ_FLAG_CLICKABLE);
+        if (shown == alarm_marker_count) {
+            lv_obj_t *m = lv_obj_create(hr_chart);
+            lv_obj_remove_flag(m, LV_OBJ_FLAG_SCROLLABLE | LV_OBJ_FLAG_CLICKABLE);
+            lv_obj_set_style_border_width(m, 0, 0);
+            lv_obj_set_style_radius(m, 0, 0);
+            lv_obj_set_style_bg_opa(m, LV_OPA_50, 0);
+            alarm_markers[alarm_marker_count++] = m;
+        }
+        lv_obj_t *m = alarm_markers[shown++];
         lv_obj_set_size(m, 2, chart_h);
         lv_obj_set_pos(m, x, 0);
-        lv_obj_set_style_border_width(m, 0, 0);
-        lv_obj_set_style_radius(m, 0, 0);
-        lv_obj_set_style_bg_opa(m, LV_OPA_50, 0);
+        lv_obj_set_style_bg_color(m, (marks[i].severity >= VM_ALARM_HIGH)
+                                     ? VM_COLOR_ALARM_HIGH
+                                     : VM_COLOR_ALARM_MEDIUM, 0);
+        lv_obj_remove_flag(m, LV_OBJ_FLAG_HIDDEN);
+    }
+    for (int i = shown; i < alarm_marker_count; i++) {
+        lv_obj_add_flag(alarm_markers[i], LV_OBJ_FLAG_HIDDEN);
+    }
+}
 
-        lv_color_t color = (alarm_buf.severity[i] >= VM_ALARM_HIGH)
-                            ? VM_COLOR_ALARM_HIGH : VM_COLOR_ALARM_MEDIUM;
-        lv_obj_set_style_bg_color(m, color, 0);
+/** Redraw every chart for the current window (runs on each drag frame). */
+static void render_view(void) {
+    if (!hr_chart) return;
+    render_series(hr_chart,   hr_series,   TREND_PARAM_HR);
+    render_series(spo2_chart, spo2_series, TREND_PARAM_SPO2);
+    render_series(rr_chart,   rr_series,   TREND_PARAM_RR);
+    render_series(nibp_temp_chart, temp_series, TREND_PARAM_TEMP);
+    render_nibp();
+    render_alarm_markers();
+}
 
-        alarm_markers[alarm_marker_count++] = m;
+/* ── Drag to pan / zoom ───────────────────────────────────── */
+
+static void chart_drag_cb(lv_event_t *e) {
+    lv_event_code_t code = lv_event_get_code(e);
+    lv_obj_t *chart = lv_event_get_target(e);
+    lv_indev_t *indev = lv_indev_active();
+    if (!indev) return;
+
+    int32_t chart_w = lv_obj_get_content_width(chart);
+    if (chart_w <= 0) return;
+
+    if (code == LV_EVENT_PRESSED) {
+        lv_point_t p;
+        lv_area_t area;
+        lv_indev_get_point(indev, &p);
+        lv_obj_get_content_coords(chart, &area);
+
+        uint32_t start_ts;
+        trend_viewport_get_window(&start_ts, NULL);
+        drag_mode = DRAG_NONE;
+        drag_total.x = drag_total.y = 0;
+        drag_panned_s = 0;
+        drag_span_s = trend_viewport_span();
+        int32_t px = LV_CLAMP(0, p.x - area.x1, chart_w);
+        drag_anchor_ts = start_ts +
+                         (uint32_t)((uint64_t)px * drag_span_s / chart_w);
+        return;
+    }
+
+    if (code == LV_EVENT_PRESSING) {
+        lv_point_t v;
+        lv_indev_get_vect(indev, &v);
+        drag_total.x += v.x;
+        drag_total.y += v.y;
+
+        if (drag_mode == DRAG_NONE) {
+            if (LV_ABS(drag_total.x) < DRAG_SLOP_PX &&
+                LV_ABS(drag_total.y) < DRAG_SLOP_PX) {
+                return;
+            }
+            drag_mode = (LV_ABS(drag_total.x) >= LV_ABS(drag_total.y))
+                        ? DRAG_PAN : DRAG_ZOOM;
+        }
+
+        if (drag_mode == DRAG_PAN) {
+            /* Content follows the finger: drag right shows earlier data */
+            int32_t want_s = (int32_t)(-(int64_t)drag_total.x *
+                                       drag_span_s / chart_w);
+            if (want_s == drag_panned_s) return;
+            trend_viewport_pan(want_s - drag_panned_s);
+            drag_panned_s = want_s;
+        } else {
+            /* Up zooms in, down zooms out; ZOOM_PX per factor of two */
+            int32_t dy = drag_total.y;
+            uint64_t span = (dy >= 0)
+                ? (uint64_t)drag_span_s * (ZOOM_PX + dy) / ZOOM_PX
+                : (uint64_t)drag_span_s * ZOOM_PX / (ZOOM_PX - dy);
+            if (span > UINT32_MAX) span = UINT32_MAX;
+            trend_viewport_zoom((uint32_t)span, drag_anchor_ts);
+        }
+        render_view();
+        return;
     }
+
+    /* LV_EVENT_RELEASED / LV_EVENT_PRESS_LOST */
+    if (drag_mode == DRAG_NONE) return;
+    drag_mode = DRAG_NONE;
+    trend_viewport_settle();
+    update_range_highlight();
+    render_view();
+    fetch_next();
+    printf("[trends] View %us, %s\n", (unsigned)trend_viewport_span(),
+           trend_viewport_is_live() ? "live" : "history");
 }
 
-/* ── Refresh orchestration ────────────────────────────────── */
+/* ── Tile fetching ────────────────────────────────────────── */
 
-static void refresh_all_charts(void) {
-    uint32_t now = get_current_ts();
-    uint32_t range_s = (uint32_t)range_values[active_range_idx];
-    uint32_t start_ts = (now > range_s) ? now - range_s : 0;
-
-    populate_chart_from_db(hr_chart,   hr_series,   TREND_PARAM_HR,   start_ts, now);
-    populate_chart_from_db(spo2_chart, spo2_series, TREND_PARAM_SPO2, start_ts, now);
-    populate_chart_from_db(rr_chart,   rr_series,   TREND_PARAM_RR,   start_ts, now);
-    populate_nibp_from_db(start_ts, now);
-    populate_temp_from_db(start_ts, now);
-    update_alarm_markers(start_ts, now);
+/** LVGL thread: keep a COARSE or FULL tile; continue once it is full. */
+static void on_tile_result(const trend_query_set_t *set, void *user_data) {
+    (void)user_data;
+    trend_viewport_store(set);
+    render_view();
+    if (set->stage == TREND_STAGE_FULL) fetch_next();
+}
+
+/**
+ * Request the next tile trend_viewport wants.  A prefetch waits for the
+ * query in flight (whose completion calls back here); a tile under the
+ * window replaces it.
+ */
+static void fetch_next(void) {
+    trend_viewport_fetch_t f;
+    if (!trend_viewport_next_fetch(&f)) return;
+
+    if (trend_query_busy()) {
+        if (!f.visible) return;
+        if (f.start_ts == inflight.start_ts && f.end_ts == inflight.end_ts) {
+            return;
+        }
+    }
+    inflight = f;
+    trend_query_request(f.start_ts, f.end_ts, f.points, f.tier,
+                        f.visible && !f.refresh, on_tile_result, NULL);
 }
 
 static void refresh_timer_cb(lv_timer_t *timer) {
     (void)timer;
-    if (!hr_chart) return;
-    refresh_all_charts();
+    if (!hr_chart || drag_mode != DRAG_NONE) return;
+
+    trend_viewport_set_patient(trend_db_slot_patient(0));
+    trend_viewport_set_now(get_current_ts());
+    update_range_highlight();
+    update_layers();
+    render_view();
+    fetch_next();
 }
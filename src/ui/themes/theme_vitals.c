@@ -1,9 +1,66 @@
 /**
  * @file theme_vitals.c
  * @brief Vitals monitor theme initialization and helpers
+ *
+ * The glyph cache wraps each value font in a copy whose get_glyph_bitmap
+ * consults glyph_cache first.  Glyphs are keyed by glyph index per font;
+ * label images by their text per font.  LVGL's draw thread fetches glyphs
+ * while the UI thread renders label images, so the cache is locked.
+ * Pinned glyphs are returned in place; any other hit is copied into the
+ * renderer's buffer, since it may be evicted once the lock is released.
  */
 
 #include "theme_vitals.h"
+#include "glyph_cache.h"
+#include "mem_budget.h"
+#include "vclock.h"
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+/* ── Glyph cache state ─────────────────────────────────────── */
+
+#define GLYPH_POOL_BYTES        (64 * 1024)
+#define MAX_TEXT_FONTS          8
+#define TEXT_FONT_ID_BASE       16
+
+/* Pre-rasterized and pinned: everything a vital value is made of */
+#define VALUE_GLYPHS            "0123456789-/.:%"
+
+typedef struct {
+    lv_font_t        font;      /* Copy of base with the caching bitmap hook */
+    const lv_font_t *base;
+    uint32_t         id;
+} cached_font_t;
+
+/* Caller space of each cache entry */
+typedef struct {
+    glyph_bitmap_t *bm;
+    bool            is_text;
+    bool            pinned;
+    union {
+        lv_draw_buf_t  glyph;   /* Glyphs: the bitmap as a draw buffer */
+        lv_image_dsc_t text;    /* Labels: the bitmap as an image */
+    } u;
+} cache_slot_t;
+
+static cached_font_t cached_fonts[] = {
+    { .base = VM_FONT_VALUE_LARGE,  .id = 0 },
+    { .base = VM_FONT_VALUE_MEDIUM, .id = 1 },
+    { .base = VM_FONT_LABEL,        .id = 2 },
+};
+#define CACHED_FONT_COUNT ((int)(sizeof(cached_fonts) / sizeof(cached_fonts[0])))
+
+static const lv_font_t *text_fonts[MAX_TEXT_FONTS];
+
+static uint64_t            cache_mem[GLYPH_POOL_BYTES / sizeof(uint64_t)];
+static glyph_cache_t       cache;
+static pthread_mutex_t     cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static bool                cache_enabled = false;
+static theme_glyph_stats_t glyph_stats;
+
+MEM_BUDGET_ASSERT(glyph_cache, sizeof(cache_mem) + sizeof(cache), MEM_BUDGET_GLYPH_CACHE);
 
 void theme_vitals_init(void) {
     lv_obj_t *scr = lv_screen_active();
@@ -19,3 +76,271 @@ lv_color_t theme_vitals_alarm_color(vm_alarm_severity_t severity) {
         default:              return VM_COLOR_ALARM_NONE;
     }
 }
+
+/* ── Glyph cache helpers ───────────────────────────────────── */
+
+static cache_slot_t *slot_of(glyph_bitmap_t *bm) {
+    return (cache_slot_t *)bm->user;
+}
+
+static void on_evict(glyph_bitmap_t *bm, void *user_data) {
+    (void)user_data;
+    cache_slot_t *slot = slot_of(bm);
+    if (slot->is_text) lv_image_cache_drop(&slot->u.text);
+}
+
+static void glyph_key(char *key, size_t size, uint32_t index) {
+    snprintf(key, size, "#%u", (unsigned)index);
+}
+
+/** Rasterize with the base font's hook, timed. */
+static const void *rasterize(const cached_font_t *cf, lv_font_glyph_dsc_t *g,
+                             lv_draw_buf_t *draw_buf) {
+    uint64_t t0 = vclock_real_us();
+    const void *r = cf->base->get_glyph_bitmap(g, draw_buf);
+    uint64_t dt = vclock_real_us() - t0;
+
+    pthread_mutex_lock(&cache_lock);
+    glyph_stats.rasterized++;
+    glyph_stats.raster_us += dt;
+    pthread_mutex_unlock(&cache_lock);
+    return r;
+}
+
+/** Copy an A8 glyph from `draw_buf` into the cache.  Lock held. */
+static void store_glyph(const cached_font_t *cf, const char *key,
+                        const lv_font_glyph_dsc_t *g, const lv_draw_buf_t *draw_buf,
+                        uint8_t flags) {
+    glyph_bitmap_t *bm = glyph_cache_add(&cache, cf->id, key, g->box_w, g->box_h,
+                                         sizeof(cache_slot_t), flags);
+    if (!bm) return;
+
+    for (uint16_t y = 0; y < bm->h; y++) {
+        memcpy(bm->data + (size_t)y * bm->stride,
+               draw_buf->data + (size_t)y * draw_buf->header.stride, bm->w);
+    }
+    cache_slot_t *slot = slot_of(bm);
+    slot->bm = bm;
+    slot->is_text = false;
+    slot->pinned = (flags & GLYPH_CACHE_PIN) != 0;
+    lv_draw_buf_init(&slot->u.glyph, bm->w, bm->h, LV_COLOR_FORMAT_A8, bm->stride,
+                     bm->data, (uint32_t)bm->stride * bm->h);
+}
+
+/** get_glyph_bitmap of the wrapped fonts. */
+static const void *cached_glyph_bitmap(lv_font_glyph_dsc_t *g, lv_draw_buf_t *draw_buf) {
+    const cached_font_t *cf = g->resolved_font->user_data;
+
+    char key[16];
+    glyph_key(key, sizeof(key), g->gid.index);
+
+    pthread_mutex_lock(&cache_lock);
+    glyph_stats.fetches++;
+    bool use_cache = cache_enabled && !g->req_raw_bitmap && draw_buf;
+    glyph_bitmap_t *bm = use_cache ? glyph_cache_find(&cache, cf->id, key) : NULL;
+    if (bm) {
+        const void *r = draw_buf;
+        cache_slot_t *slot = slot_of(bm);
+        if (slot->pinned) {
+            r = &slot->u.glyph;
+        } else {
+            for (uint16_t y = 0; y < bm->h; y++) {
+                memcpy(draw_buf->data + (size_t)y * draw_buf->header.stride,
+                       bm->data + (size_t)y * bm->stride, bm->w);
+            }
+        }
+        glyph_stats.cached++;
+        pthread_mutex_unlock(&cache_lock);
+        return r;
+    }
+    pthread_mutex_unlock(&cache_lock);
+
+    const void *r = rasterize(cf, g, draw_buf);
+    if (use_cache && r == draw_buf) {
+        pthread_mutex_lock(&cache_lock);
+        if (!glyph_cache_find(&cache, cf->id, key)) store_glyph(cf, key, g, draw_buf, 0);
+        pthread_mutex_unlock(&cache_lock);
+    }
+    return r;
+}
+
+/** Rasterize and pin the value glyphs of one font. */
+static void prerender_numerals(cached_font_t *cf) {
+    for (const char *c = VALUE_GLYPHS; *c; c++) {
+        lv_font_glyph_dsc_t g;
+        if (!lv_font_get_glyph_dsc(&cf->font, &g, (uint8_t)*c, 0)) continue;
+        if (g.box_w == 0 || g.box_h == 0 || g.resolved_font != &cf->font) continue;
+
+        lv_draw_buf_t *scratch = lv_draw_buf_create(g.box_w, g.box_h,
+                                                    LV_COLOR_FORMAT_A8, LV_STRIDE_AUTO);
+        if (!scratch) return;
+        if (rasterize(cf, &g, scratch) == scratch) {
+            char key[16];
+            glyph_key(key, sizeof(key), g.gid.index);
+            pthread_mutex_lock(&cache_lock);
+            store_glyph(cf, key, &g, scratch, GLYPH_CACHE_PIN);
+            pthread_mutex_unlock(&cache_lock);
+        }
+        lv_draw_buf_destroy(scratch);
+    }
+}
+
+/** Cache key space of a font used for label images, or 0 if none left. */
+static uint32_t text_font_id(const lv_font_t *font) {
+    for (int i = 0; i < MAX_TEXT_FONTS; i++) {
+        if (!text_fonts[i]) text_fonts[i] = font;
+        if (text_fonts[i] == font) return TEXT_FONT_ID_BASE + (uint32_t)i;
+    }
+    return 0;
+}
+
+/** Draw `text` into `bm` glyph by glyph (coverage combined with max). */
+static void render_text(glyph_bitmap_t *bm, const char *text, const lv_font_t *font) {
+    int32_t x = 0;
+    int32_t top = lv_font_get_line_height(font) - font->base_line;
+    uint32_t i = 0;
+    uint32_t letter = lv_text_encoded_next(text, &i);
+
+    while (letter) {
+        uint32_t next = lv_text_encoded_next(text, &i);
+        lv_font_glyph_dsc_t g;
+        if (lv_font_get_glyph_dsc(font, &g, letter, next) && g.box_w && g.box_h) {
+            lv_draw_buf_t *scratch = lv_draw_buf_create(g.box_w, g.box_h,
+                                                        LV_COLOR_FORMAT_A8, LV_STRIDE_AUTO);
+            const lv_draw_buf_t *src = scratch ? lv_font_get_glyph_bitmap(&g, scratch) : NULL;
+            int32_t gx = x + g.ofs_x;
+            int32_t gy = top - g.box_h - g.ofs_y;
+
+            for (int32_t y = 0; src && y < g.box_h; y++) {
+                if (gy + y < 0 || gy + y >= bm->h) continue;
+                const uint8_t *s = src->data + (size_t)y * src->header.stride;
+                uint8_t *d = bm->data + (size_t)(gy + y) * bm->stride;
+                for (int32_t px = 0; px < g.box_w; px++) {
+                    if (gx + px < 0 || gx + px >= bm->w) continue;
+                    if (s[px] > d[gx + px]) d[gx + px] = s[px];
+                }
+            }
+            lv_font_glyph_release_draw_data(&g);
+            if (scratch) lv_draw_buf_destroy(scratch);
+        }
+        x += lv_font_get_glyph_width(font, letter, next);
+        letter = next;
+    }
+}
+
+/* ── Glyph cache API ───────────────────────────────────────── */
+
+void theme_vitals_set_glyph_cache(bool enable) {
+    for (int i = 0; i < CACHED_FONT_COUNT; i++) {
+        cached_font_t *cf = &cached_fonts[i];
+        cf->font = *cf->base;
+        cf->font.get_glyph_bitmap = cached_glyph_bitmap;
+        cf->font.user_data = cf;
+    }
+
+    pthread_mutex_lock(&cache_lock);
+    cache_enabled = enable &&
+        glyph_cache_init(&cache, cache_mem, sizeof(cache_mem), on_evict, NULL);
+    pthread_mutex_unlock(&cache_lock);
+    if (!cache_enabled) {
+        printf("[theme] Glyph cache off\n");
+        return;
+    }
+
+    for (int i = 0; i < CACHED_FONT_COUNT; i++) prerender_numerals(&cached_fonts[i]);
+
+    glyph_cache_stats_t s = glyph_cache_get_stats(&cache);
+    printf("[theme] Glyph cache: %u numerals pinned, %u/%u KB\n",
+           (unsigned)s.pinned, (unsigned)(s.bytes / 1024), (unsigned)(s.capacity / 1024));
+}
+
+const lv_font_t * theme_vitals_value_font(const lv_font_t *font) {
+    for (int i = 0; i < CACHED_FONT_COUNT; i++) {
+        if (cached_fonts[i].base == font && cached_fonts[i].font.get_glyph_bitmap) {
+            return &cached_fonts[i].font;
+        }
+    }
+    return font;
+}
+
+const lv_image_dsc_t * theme_vitals_text_image(const char *text, const lv_font_t *font) {
+    if (!text || !*text || !font) return NULL;
+
+    pthread_mutex_lock(&cache_lock);
+    uint32_t id = cache_enabled ? text_font_id(font) : 0;
+    glyph_bitmap_t *bm = id ? glyph_cache_find(&cache, id, text) : NULL;
+    if (bm) {
+        glyph_cache_ref(&cache, bm);
+        pthread_mutex_unlock(&cache_lock);
+        return &slot_of(bm)->u.text;
+    }
+    pthread_mutex_unlock(&cache_lock);
+    if (!id) return NULL;
+
+    int32_t w = lv_text_get_width(text, (uint32_t)strlen(text), font, 0);
+    int32_t h = lv_font_get_line_height(font);
+    if (w <= 0 || h <= 0 || w > UINT16_MAX || h > UINT16_MAX) return NULL;
+
+    /* Referenced at once, so glyph fetches while it is drawn cannot evict it */
+    pthread_mutex_lock(&cache_lock);
+    bm = glyph_cache_add(&cache, id, text, (uint16_t)w, (uint16_t)h,
+                         sizeof(cache_slot_t), 0);
+    if (bm) glyph_cache_ref(&cache, bm);
+    pthread_mutex_unlock(&cache_lock);
+    if (!bm) return NULL;
+
+    render_text(bm, text, font);
+
+    cache_slot_t *slot = slot_of(bm);
+    slot->bm = bm;
+    slot->is_text = true;
+    slot->pinned = false;
+    lv_image_dsc_t *img = &slot->u.text;
+    img->header.magic = LV_IMAGE_HEADER_MAGIC;
+    img->header.cf = LV_COLOR_FORMAT_A8;
+    img->header.w = bm->w;
+    img->header.h = bm->h;
+    img->header.stride = bm->stride;
+    img->data_size = (uint32_t)bm->stride * bm->h;
+    img->data = bm->data;
+
+    pthread_mutex_lock(&cache_lock);
+    glyph_stats.text_images++;
+    pthread_mutex_unlock(&cache_lock);
+    return img;
+}
+
+void theme_vitals_text_image_release(const lv_image_dsc_t *img) {
+    if (!img) return;
+    cache_slot_t *slot = (cache_slot_t *)((uint8_t *)img - offsetof(cache_slot_t, u.text));
+    pthread_mutex_lock(&cache_lock);
+    glyph_cache_unref(&cache, slot->bm);
+    pthread_mutex_unlock(&cache_lock);
+}
+
+void theme_vitals_get_glyph_stats(theme_glyph_stats_t *out) {
+    pthread_mutex_lock(&cache_lock);
+    *out = glyph_stats;
+    pthread_mutex_unlock(&cache_lock);
+}
+
+void theme_vitals_print_glyph_stats(const char *tag, uint32_t frames) {
+    theme_glyph_stats_t st;
+    glyph_cache_stats_t cs;
+    pthread_mutex_lock(&cache_lock);
+    st = glyph_stats;
+    cs = glyph_cache_get_stats(&cache);
+    pthread_mutex_unlock(&cache_lock);
+
+    if (frames == 0) frames = 1;
+    printf("[%s] glyphs per frame %.1f (%.1f cached, %.1f rasterized), "
+           "raster %.1f us/frame\n", tag,
+           (double)st.fetches / frames, (double)st.cached / frames,
+           (double)st.rasterized / frames, (double)st.raster_us / frames);
+    if (cache_enabled) {
+        printf("[%s] glyph cache %u entries (%u pinned, %u labels), %u/%u KB, "
+               "%u evictions\n", tag, (unsigned)cs.entries, (unsigned)cs.pinned,
+               (unsigned)st.text_images, (unsigned)(cs.bytes / 1024),
+               (unsigned)(cs.capacity / 1024), (unsigned)cs.evictions);
+    }
+}
@@ -14,6 +14,8 @@
 #define THEME_VITALS_H
 
 #include "lvgl.h"
+#include <stdbool.h>
+#include <stdint.h>
 
 /* ============================================================
  *  Screen Dimensions (configure for target hardware)
@@ -146,4 +148,63 @@ void theme_vitals_init(void);
 /** Get the LVGL color for a given alarm severity. */
 lv_color_t theme_vitals_alarm_color(vm_alarm_severity_t severity);
 
+/* ============================================================
+ *  Glyph Cache
+ *
+ *  Value text is redrawn every second on the main vitals screen,
+ *  and each redraw rasterizes every glyph again.  The value fonts
+ *  (VM_FONT_VALUE_LARGE, VM_FONT_VALUE_MEDIUM, VM_FONT_LABEL) are
+ *  therefore wrapped so glyph bitmaps come from a fixed-budget
+ *  cache (glyph_cache.h): numerals are rasterized at startup and
+ *  pinned, other glyphs are kept least-recently-used.
+ *
+ *  Static labels can be drawn as whole A8 images rendered once
+ *  into the same cache.  Labels in scripts that need shaping, such
+ *  as Devanagari, are shaped offline into the font's presentation
+ *  forms; the image then holds the shaped result, so nothing is
+ *  shaped or rasterized per frame.
+ *
+ *  Glyph fetches and rasterization time are counted whether the
+ *  cache is enabled or not, so both builds can be compared.
+ * ============================================================ */
+
+typedef struct {
+    uint32_t fetches;           /* Glyph bitmaps the renderer asked for */
+    uint32_t cached;            /* ...served from the cache */
+    uint32_t rasterized;        /* ...rasterized by the font */
+    uint64_t raster_us;         /* Time spent rasterizing */
+    uint32_t text_images;       /* Label images rendered */
+} theme_glyph_stats_t;
+
+/**
+ * Enable or disable the glyph cache (call once, after theme_vitals_init()
+ * and before any screen is created).  Enabling pre-rasterizes the
+ * numerals of the value fonts.
+ */
+void theme_vitals_set_glyph_cache(bool enable);
+
+/**
+ * The cached wrapper of a value font, or `font` itself for fonts that
+ * are not wrapped.  Use it wherever a value font is set on a label.
+ */
+const lv_font_t * theme_vitals_value_font(const lv_font_t *font);
+
+/**
+ * An A8 image of `text` in `font`, for an lv_image drawn with
+ * image_recolor (as the Phosphor icons are).  Each call takes a
+ * reference; release it with theme_vitals_text_image_release() once
+ * the image object is deleted.
+ * @return NULL if the cache is disabled or full: use a label instead.
+ */
+const lv_image_dsc_t * theme_vitals_text_image(const char *text, const lv_font_t *font);
+
+/** Drop a reference taken by theme_vitals_text_image(). */
+void theme_vitals_text_image_release(const lv_image_dsc_t *img);
+
+/** Counters since startup. */
+void theme_vitals_get_glyph_stats(theme_glyph_stats_t *out);
+
+/** Print glyph work per rendered frame, and cache occupancy. */
+void theme_vitals_print_glyph_stats(const char *tag, uint32_t frames);
+
 #endif /* THEME_VITALS_H */
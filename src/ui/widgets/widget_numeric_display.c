@@ -7,6 +7,10 @@
  *   │  HR            bpm   │  ← top row: label (left) + unit (right)
  *   │         72           │  ← value (centered, large font)
  *   └──────────────────────┘
+ *
+ * The value is drawn in the cached value font, and the static label and
+ * unit as text images from the glyph cache (theme_vitals.h) when it has
+ * room; otherwise as ordinary labels.
  */
 
 #include "widget_numeric_display.h"
@@ -24,6 +28,8 @@ struct widget_numeric_display {
     lv_obj_t *label_obj;
     lv_obj_t *value_obj;
     lv_obj_t *unit_obj;
+    const lv_image_dsc_t *label_img;    /* Cached text images, or NULL */
+    const lv_image_dsc_t *unit_img;
     lv_color_t param_color;
     vm_alarm_severity_t alarm_state;
 };
@@ -44,6 +50,29 @@ static widget_numeric_display_t * pool_alloc(void) {
     return NULL;
 }
 
+/**
+ * Static text: a recolored image from the glyph cache, or a label if the
+ * cache has no room for it.
+ */
+static lv_obj_t * create_static_text(lv_obj_t *parent, const char *text,
+                                     const lv_font_t *font, lv_color_t color,
+                                     const lv_image_dsc_t **img_out) {
+    lv_obj_t *obj;
+    *img_out = theme_vitals_text_image(text, font);
+    if (*img_out) {
+        obj = lv_image_create(parent);
+        lv_image_set_src(obj, *img_out);
+        lv_obj_set_style_image_recolor(obj, color, 0);
+        lv_obj_set_style_image_recolor_opa(obj, LV_OPA_COVER, 0);
+    } else {
+        obj = lv_label_create(parent);
+        lv_label_set_text(obj, text);
+        lv_obj_set_style_text_font(obj, font, 0);
+        lv_obj_set_style_text_color(obj, color, 0);
+    }
+    return obj;
+}
+
 /* ── Public API ────────────────────────────────────────────── */
 
 widget_numeric_display_t * widget_numeric_display_create(
@@ -145,21 +174,17 @@ widget_numeric_display_t * widget_numeric_display_create(
     }
 
     /* Label */
-    w->label_obj = lv_label_create(left_group);
-    lv_label_set_text(w->label_obj, label_text);
-    lv_obj_set_style_text_font(w->label_obj, label_font, 0);
-    lv_obj_set_style_text_color(w->label_obj, color, 0);
+    w->label_obj = create_static_text(left_group, label_text, label_font,
+                                      color, &w->label_img);
 
     /* Unit (right side, smaller, secondary color) */
-    w->unit_obj = lv_label_create(w->top_row);
-    lv_label_set_text(w->unit_obj, unit_text);
-    lv_obj_set_style_text_font(w->unit_obj, VM_FONT_UNIT, 0);
-    lv_obj_set_style_text_color(w->unit_obj, VM_COLOR_TEXT_SECONDARY, 0);
+    w->unit_obj = create_static_text(w->top_row, unit_text, VM_FONT_UNIT,
+                                     VM_COLOR_TEXT_SECONDARY, &w->unit_img);
 
     /* ── Value (large centered number, fills remaining space) ── */
     w->value_obj = lv_label_create(w->container);
     lv_label_set_text(w->value_obj, "---");
-    lv_obj_set_style_text_font(w->value_obj, value_font, 0);
+    lv_obj_set_style_text_font(w->value_obj, theme_vitals_value_font(value_font), 0);
     lv_obj_set_style_text_color(w->value_obj, color, 0);
     lv_obj_set_style_text_align(w->value_obj, LV_TEXT_ALIGN_CENTER, 0);
     lv_obj_set_width(w->value_obj, lv_pct(100));
@@ -195,6 +220,10 @@ lv_obj_t * widget_numeric_display_get_obj(widget_numeric_display_t *w) {
 
 void widget_numeric_display_free(widget_numeric_display_t *w) {
     if (!w) return;
+    theme_vitals_text_image_release(w->label_img);
+    theme_vitals_text_image_release(w->unit_img);
+    w->label_img = NULL;
+    w->unit_img = NULL;
     w->in_use = false;
     w->container = NULL;
     w->top_row = NULL;
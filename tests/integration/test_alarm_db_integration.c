@@ -3,16 +3,47 @@
  * @brief Integration tests: alarm_engine + trend_db
  *
  * Verifies that alarm events triggered by alarm_engine are correctly
- * recorded in trend_db and can be queried back. Uses in-memory SQLite
- * databases for fast, isolated tests.
+ * recorded in trend_db and can be queried back, by parameter and
+ * severity from their indexes, and that text alarms written by older
+ * builds are converted.  Uses in-memory SQLite databases for fast,
+ * isolated tests, except where a database must be reopened.
  */
 
 #include "test_framework.h"
 #include "alarm_engine.h"
 #include "trend_db.h"
+#include "db_schema.h"
 #include "vitals_provider.h"
+#include "sqlite3.h"
 #include <time.h>
 #include <string.h>
+#include <unistd.h>
+
+#define AD_TEST_DB  "/tmp/test_alarm_db.db"
+
+static trend_alarm_result_t alarms;
+
+/* ── Helper: record engine transitions as the application does ── */
+
+static void record_event(const alarm_event_t *evt, void *user_data) {
+    (void)user_data;
+    trend_db_insert_alarm(0, evt->time_s, evt);
+}
+
+static alarm_event_t make_event(alarm_param_t param, alarm_severity_t sev,
+                                int32_t value, int32_t threshold) {
+    alarm_event_t evt = {
+        .param = param, .severity = sev, .kind = ALARM_EVT_ONSET,
+        .value = value, .threshold = threshold, .has_reading = true,
+    };
+    return evt;
+}
+
+static void remove_db(void) {
+    unlink(AD_TEST_DB);
+    unlink(AD_TEST_DB "-wal");
+    unlink(AD_TEST_DB "-shm");
+}
 
 /* ── Helper: create normal vitals data ─────────────────────── */
 
@@ -67,6 +98,7 @@ static void test_alarm_triggers_db_event(void) {
     bool db_ok = trend_db_init(":memory:");
     ASSERT_TRUE(db_ok);
     alarm_engine_init();
+    alarm_engine_set_event_callback(record_event, NULL);
 
     uint32_t now = (uint32_t)time(NULL);
 
@@ -85,18 +117,27 @@ static void test_alarm_triggers_db_event(void) {
     ASSERT_EQ_INT(state->highest_active, ALARM_SEV_HIGH);
     ASSERT_EQ_INT(state->params[ALARM_PARAM_HR].state, ALARM_STATE_ACTIVE);
 
-    /* Manually record the alarm event to trend_db (simulating what
-       the application layer does when alarm_engine fires) */
-    trend_db_insert_alarm(now + 1, VM_ALARM_HIGH,
-                          state->params[ALARM_PARAM_HR].message);
-
-    /* Query back alarm events from DB */
-    trend_alarm_result_t alarms;
-    int count = trend_db_query_alarms(now - 10, now + 100, &alarms);
+    /* The onset went to trend_db through the event callback */
+    int count = trend_db_query_alarms(0, now - 10, now + 100, &alarms);
     ASSERT_EQ_INT(count, 1);
     ASSERT_EQ_INT(alarms.severity[0], VM_ALARM_HIGH);
-    ASSERT_GT_INT((int)strlen(alarms.message[0]), 0);
+    ASSERT_EQ_INT(alarms.param[0], ALARM_PARAM_HR);
+    ASSERT_EQ_INT(alarms.kind[0], ALARM_EVT_ONSET);
+    ASSERT_EQ_INT(alarms.value[0], 200);
+    ASSERT_EQ_INT(alarms.threshold[0], 150);
+    ASSERT_EQ_INT((int)alarms.timestamp_s[0], (int)(now + 1));
+
+    /* Acknowledge and recovery follow as further events */
+    alarm_engine_acknowledge(ALARM_PARAM_HR);
+    vitals_data_t normal2 = make_normal_vitals();
+    alarm_engine_evaluate(&normal2, now + 31);
+    count = trend_db_query_alarms(0, now - 10, now + 100, &alarms);
+    ASSERT_EQ_INT(count, 3);
+    ASSERT_EQ_INT(alarms.kind[1], ALARM_EVT_ACK);
+    ASSERT_EQ_INT(alarms.kind[2], ALARM_EVT_CLEAR);
+    ASSERT_EQ_INT((int)alarms.duration_s[2], 30);
 
+    alarm_engine_set_event_callback(NULL, NULL);
     alarm_engine_deinit();
     trend_db_close();
 }
@@ -112,13 +153,15 @@ static void test_query_alarm_events(void) {
     uint32_t now = (uint32_t)time(NULL);
 
     /* Insert several alarm events at different times */
-    trend_db_insert_alarm(now,     VM_ALARM_HIGH,   "HR > 150 bpm");
-    trend_db_insert_alarm(now + 1, VM_ALARM_MEDIUM, "SpO2 < 90%");
-    trend_db_insert_alarm(now + 2, VM_ALARM_LOW,    "HR > 120 bpm");
+    alarm_event_t e1 = make_event(ALARM_PARAM_HR, ALARM_SEV_HIGH, 155, 150);
+    alarm_event_t e2 = make_event(ALARM_PARAM_SPO2, ALARM_SEV_MEDIUM, 89, 90);
+    alarm_event_t e3 = make_event(ALARM_PARAM_HR, ALARM_SEV_LOW, 121, 120);
+    trend_db_insert_alarm(0, now,     &e1);
+    trend_db_insert_alarm(0, now + 1, &e2);
+    trend_db_insert_alarm(0, now + 2, &e3);
 
     /* Query all */
-    trend_alarm_result_t alarms;
-    int count = trend_db_query_alarms(now - 10, now + 100, &alarms);
+    int count = trend_db_query_alarms(0, now - 10, now + 100, &alarms);
     ASSERT_EQ_INT(count, 3);
 
     /* Verify severity values are correct */
@@ -127,7 +170,7 @@ static void test_query_alarm_events(void) {
     ASSERT_EQ_INT(alarms.severity[2], VM_ALARM_LOW);
 
     /* Query a narrower time range */
-    count = trend_db_query_alarms(now + 1, now + 2, &alarms);
+    count = trend_db_query_alarms(0, now + 1, now + 2, &alarms);
     ASSERT_GE_INT(count, 1);
 
     alarm_engine_deinit();
@@ -145,19 +188,25 @@ static void test_alarm_state_persists(void) {
     uint32_t now = (uint32_t)time(NULL);
 
     /* Record an alarm event */
-    trend_db_insert_alarm(now, VM_ALARM_HIGH, "HR critical alarm");
+    alarm_event_t e = make_event(ALARM_PARAM_HR, ALARM_SEV_HIGH, 165, 150);
+    trend_db_insert_alarm(0, now, &e);
 
     /* Deinit and reinit alarm engine */
     alarm_engine_deinit();
     alarm_engine_init();
 
     /* The alarm event in the DB should still be queryable */
-    trend_alarm_result_t alarms;
-    int count = trend_db_query_alarms(now - 10, now + 100, &alarms);
+    int count = trend_db_query_alarms(0, now - 10, now + 100, &alarms);
     ASSERT_EQ_INT(count, 1);
-    ASSERT_STR_EQ(alarms.message[0], "HR critical alarm");
     ASSERT_EQ_INT(alarms.severity[0], VM_ALARM_HIGH);
 
+    /* Text is rendered from the stored fields */
+    char text[96];
+    trend_db_alarm_event(&alarms, 0, &e);
+    ASSERT_EQ_INT((int)e.time_s, (int)now);
+    alarm_engine_format_event(&e, text, sizeof(text));
+    ASSERT_STR_EQ(text, "HR Very High 165 (>150)");
+
     /* The alarm engine state itself resets (stateless re-init) */
     const alarm_engine_state_t *state = alarm_engine_get_state();
     ASSERT_EQ_INT(state->highest_active, ALARM_SEV_NONE);
@@ -185,6 +234,7 @@ static void test_alarm_limits_and_trends(void) {
         .enabled       = true
     };
     alarm_engine_set_limits(ALARM_PARAM_HR, &hr_limits);
+    alarm_engine_set_event_callback(record_event, NULL);
 
     /* Verify limits were set */
     const alarm_limits_t *lim = alarm_engine_get_limits(ALARM_PARAM_HR);
@@ -197,28 +247,26 @@ static void test_alarm_limits_and_trends(void) {
     d.hr = 135;  /* Above the new critical_high of 130 */
 
     alarm_engine_evaluate(&d, now);
-    trend_db_insert_sample(now, d.hr, d.spo2, d.rr, d.temp);
+    trend_db_insert_sample(0, now, d.hr, d.spo2, d.rr, d.temp);
 
     /* Alarm should have triggered */
     const alarm_engine_state_t *state = alarm_engine_get_state();
     ASSERT_EQ_INT(state->params[ALARM_PARAM_HR].state, ALARM_STATE_ACTIVE);
     ASSERT_EQ_INT(state->params[ALARM_PARAM_HR].severity, ALARM_SEV_HIGH);
 
-    /* Record alarm to DB */
-    trend_db_insert_alarm(now, VM_ALARM_HIGH,
-                          state->params[ALARM_PARAM_HR].message);
-
     /* Verify both the vitals sample and alarm event are in the DB */
     trend_query_result_t trend_result;
-    int trend_count = trend_db_query_param(TREND_PARAM_HR, now - 10,
+    int trend_count = trend_db_query_param(0, TREND_PARAM_HR, now - 10,
                                            now + 10, 100, &trend_result);
     ASSERT_GE_INT(trend_count, 1);
     ASSERT_EQ_INT(trend_result.value[0], 135);
 
     trend_alarm_result_t alarm_result;
-    int alarm_count = trend_db_query_alarms(now - 10, now + 10, &alarm_result);
+    int alarm_count = trend_db_query_alarms(0, now - 10, now + 10, &alarm_result);
     ASSERT_EQ_INT(alarm_count, 1);
+    ASSERT_EQ_INT(alarm_result.threshold[0], 130);
 
+    alarm_engine_set_event_callback(NULL, NULL);
     alarm_engine_deinit();
     trend_db_close();
 }
@@ -238,8 +286,9 @@ static void test_multiple_alarms_with_trends(void) {
     d.hr   = 180;  /* Critical high */
     d.spo2 = 80;   /* Critical low */
 
+    alarm_engine_set_event_callback(record_event, NULL);
     alarm_engine_evaluate(&d, now);
-    trend_db_insert_sample(now, d.hr, d.spo2, d.rr, d.temp);
+    trend_db_insert_sample(0, now, d.hr, d.spo2, d.rr, d.temp);
 
     const alarm_engine_state_t *state = alarm_engine_get_state();
 
@@ -247,15 +296,8 @@ static void test_multiple_alarms_with_trends(void) {
     ASSERT_EQ_INT(state->params[ALARM_PARAM_HR].state, ALARM_STATE_ACTIVE);
     ASSERT_EQ_INT(state->params[ALARM_PARAM_SPO2].state, ALARM_STATE_ACTIVE);
 
-    /* Record both alarm events */
-    trend_db_insert_alarm(now, VM_ALARM_HIGH,
-                          state->params[ALARM_PARAM_HR].message);
-    trend_db_insert_alarm(now + 1, VM_ALARM_HIGH,
-                          state->params[ALARM_PARAM_SPO2].message);
-
-    /* Query alarm events */
-    trend_alarm_result_t alarms;
-    int count = trend_db_query_alarms(now - 10, now + 100, &alarms);
+    /* Both onsets were recorded */
+    int count = trend_db_query_alarms(0, now - 10, now + 100, &alarms);
     ASSERT_EQ_INT(count, 2);
 
     /* Acknowledge all and verify they transition */
@@ -265,11 +307,196 @@ static void test_multiple_alarms_with_trends(void) {
     state = alarm_engine_get_state();
     ASSERT_EQ_INT(state->params[ALARM_PARAM_HR].state, ALARM_STATE_ACKNOWLEDGED);
     ASSERT_EQ_INT(state->params[ALARM_PARAM_SPO2].state, ALARM_STATE_ACKNOWLEDGED);
+    ASSERT_EQ_INT(trend_db_query_alarms(0, now - 10, now + 100, &alarms), 4);
 
+    alarm_engine_set_event_callback(NULL, NULL);
     alarm_engine_deinit();
     trend_db_close();
 }
 
+/* ── Test: filtered queries use their indexes ──────────── */
+
+/** EXPLAIN QUERY PLAN detail rows of `sql`, joined. */
+static void query_plan(const char *sql, char *out, size_t size) {
+    sqlite3 *conn = NULL;
+    sqlite3_stmt *st = NULL;
+    out[0] = '\0';
+    char eqp[512];
+    snprintf(eqp, sizeof(eqp), "EXPLAIN QUERY PLAN %s", sql);
+    if (sqlite3_open(AD_TEST_DB, &conn) == SQLITE_OK &&
+        sqlite3_prepare_v2(conn, eqp, -1, &st, NULL) == SQLITE_OK) {
+        while (sqlite3_step(st) == SQLITE_ROW) {
+            const char *d = (const char *)sqlite3_column_text(st, 3);
+            size_t n = strlen(out);
+            snprintf(out + n, size - n, "%s;", d ? d : "");
+        }
+    }
+    sqlite3_finalize(st);
+    sqlite3_close(conn);
+}
+
+static void test_filtered_queries(void) {
+    printf("  test_filtered_queries\n");
+    remove_db();
+    ASSERT_TRUE(trend_db_init(AD_TEST_DB));
+    trend_db_bind_slot(0, 7);
+
+    /* A day of mixed events, every 10th an SpO2 critical */
+    const uint32_t t0 = 1700000000u;
+    int spo2_high = 0, hr_any = 0, high_any = 0;
+    for (uint32_t i = 0; i < 2000; i++) {
+        alarm_param_t p = (i % 10 == 0) ? ALARM_PARAM_SPO2
+                        : (alarm_param_t)(i % 3 == 0 ? ALARM_PARAM_HR
+                                                     : ALARM_PARAM_RR);
+        alarm_severity_t sev = (i % 10 == 0 || i % 4 == 0) ? ALARM_SEV_HIGH
+                                                           : ALARM_SEV_MEDIUM;
+        alarm_event_t e = make_event(p, sev, 80, 85);
+        trend_db_insert_alarm(0, t0 + i * 43, &e);
+        if (p == ALARM_PARAM_SPO2 && sev == ALARM_SEV_HIGH) spo2_high++;
+        if (p == ALARM_PARAM_HR) hr_any++;
+        if (sev == ALARM_SEV_HIGH) high_any++;
+    }
+
+    trend_alarm_filter_t f = { .param = ALARM_PARAM_SPO2,
+                               .severity = ALARM_SEV_HIGH };
+    ASSERT_EQ_INT(trend_db_query_alarms_filtered(7, t0, t0 + 86400, &f,
+                                                 &alarms), spo2_high);
+    for (int i = 0; i < alarms.count; i++) {
+        ASSERT_EQ_INT(alarms.param[i], ALARM_PARAM_SPO2);
+        ASSERT_EQ_INT(alarms.severity[i], ALARM_SEV_HIGH);
+    }
+
+    f.severity = -1;
+    f.param = ALARM_PARAM_HR;
+    int n = trend_db_query_alarms_filtered(7, t0, t0 + 86400, &f, &alarms);
+    ASSERT_EQ_INT(n, hr_any < TREND_DB_MAX_POINTS ? hr_any
+                                                  : TREND_DB_MAX_POINTS);
+    ASSERT_EQ_INT(alarms.param[n - 1], ALARM_PARAM_HR);
+
+    f.param = -1;
+    f.severity = ALARM_SEV_HIGH;
+    n = trend_db_query_alarms_filtered(7, t0, t0 + 86400, &f, &alarms);
+    ASSERT_EQ_INT(n, high_any < TREND_DB_MAX_POINTS ? high_any
+                                                    : TREND_DB_MAX_POINTS);
+    ASSERT_TRUE(alarms.timestamp_s[0] <= alarms.timestamp_s[n - 1]);
+    trend_db_close();
+
+    /* Each filter is answered from the matching index */
+    char plan[512];
+    query_plan("SELECT * FROM alarm_events WHERE patient_id = 7 AND "
+               "param = 1 AND timestamp_s >= 0 AND timestamp_s <= 9 "
+               "ORDER BY timestamp_s", plan, sizeof(plan));
+    ASSERT_TRUE(strstr(plan, "idx_alarm_param_ts") != NULL);
+    ASSERT_TRUE(strstr(plan, "TEMP B-TREE") == NULL);
+    query_plan("SELECT * FROM alarm_events WHERE patient_id = 7 AND "
+               "severity = 3 AND timestamp_s >= 0 AND timestamp_s <= 9 "
+               "ORDER BY timestamp_s", plan, sizeof(plan));
+    ASSERT_TRUE(strstr(plan, "idx_alarm_severity_ts") != NULL);
+    ASSERT_TRUE(strstr(plan, "TEMP B-TREE") == NULL);
+    remove_db();
+}
+
+/* ── Test: text alarms from an older build are converted ─── */
+
+static void test_text_alarm_upgrade(void) {
+    printf("  test_text_alarm_upgrade\n");
+    remove_db();
+
+    /* The partitioned layout before structured events, stamped v1 */
+    sqlite3 *conn = NULL;
+    ASSERT_EQ_INT(sqlite3_open(AD_TEST_DB, &conn), SQLITE_OK);
+    char sql[256];
+    snprintf(sql, sizeof(sql), "PRAGMA user_version = %d;",
+             (1 << 16) | DB_SCHEMA_TREND);
+    sqlite3_exec(conn,
+        "CREATE TABLE alarm_events (id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        " patient_id INTEGER NOT NULL DEFAULT 0,"
+        " timestamp_s INTEGER NOT NULL, severity INTEGER NOT NULL,"
+        " message TEXT NOT NULL);"
+        "CREATE INDEX idx_alarm_patient_ts"
+        " ON alarm_events(patient_id, timestamp_s);"
+        "INSERT INTO alarm_events (patient_id, timestamp_s, severity, message)"
+        " VALUES (4, 100, 3, 'HR Very High'), (4, 200, 2, 'SpO2 Low'),"
+        " (4, 300, 1, 'NIBP Dia High'), (4, 400, 2, 'Lead off');",
+        NULL, NULL, NULL);
+    sqlite3_exec(conn, sql, NULL, NULL, NULL);
+    sqlite3_close(conn);
+
+    ASSERT_TRUE(trend_db_init(AD_TEST_DB));
+    ASSERT_EQ_INT(trend_db_query_alarms(4, 0, 1000, &alarms), 4);
+    ASSERT_EQ_INT(alarms.param[0], ALARM_PARAM_HR);
+    ASSERT_EQ_INT(alarms.severity[0], ALARM_SEV_HIGH);
+    ASSERT_EQ_INT(alarms.param[1], ALARM_PARAM_SPO2);
+    ASSERT_EQ_INT(alarms.param[2], ALARM_PARAM_NIBP_DIA);
+    ASSERT_EQ_INT(alarms.param[3], ALARM_PARAM_COUNT);
+
+    /* Unknown fields render from the severity alone */
+    alarm_event_t e;
+    char text[96];
+    trend_db_alarm_event(&alarms, 1, &e);
+    alarm_engine_format_event(&e, text, sizeof(text));
+    ASSERT_STR_EQ(text, "SpO2 Warning");
+    trend_db_alarm_event(&alarms, 3, &e);
+    alarm_engine_format_event(&e, text, sizeof(text));
+    ASSERT_STR_EQ(text, "Alarm Warning");
+
+    /* New events go in after the converted ones */
+    alarm_event_t add = make_event(ALARM_PARAM_RR, ALARM_SEV_LOW, 7, 8);
+    trend_db_bind_slot(0, 4);
+    trend_db_insert_alarm(0, 500, &add);
+    ASSERT_EQ_INT(trend_db_query_alarms(4, 0, 1000, &alarms), 5);
+    trend_db_close();
+    remove_db();
+}
+
+/* ── Test: events from before has_reading keep their readings ── */
+
+static void test_reading_flag_upgrade(void) {
+    printf("  test_reading_flag_upgrade\n");
+    remove_db();
+
+    /* Structured events without has_reading, stamped v2 */
+    sqlite3 *conn = NULL;
+    ASSERT_EQ_INT(sqlite3_open(AD_TEST_DB, &conn), SQLITE_OK);
+    char sql[256];
+    snprintf(sql, sizeof(sql), "PRAGMA user_version = %d;",
+             (2 << 16) | DB_SCHEMA_TREND);
+    sqlite3_exec(conn,
+        "CREATE TABLE alarm_events (id INTEGER PRIMARY KEY,"
+        " patient_id INTEGER NOT NULL DEFAULT 0,"
+        " timestamp_s INTEGER NOT NULL, param INTEGER NOT NULL,"
+        " severity INTEGER NOT NULL, kind INTEGER NOT NULL,"
+        " value INTEGER NOT NULL DEFAULT 0,"
+        " threshold INTEGER NOT NULL DEFAULT 0,"
+        " user_id INTEGER NOT NULL DEFAULT 0,"
+        " duration_s INTEGER NOT NULL DEFAULT 0);"
+        "INSERT INTO alarm_events (patient_id, timestamp_s, param, severity,"
+        " kind, value, threshold)"
+        " VALUES (4, 100, 0, 3, 0, 165, 150), (4, 200, 1, 2, 0, 0, 0);",
+        NULL, NULL, NULL);
+    sqlite3_exec(conn, sql, NULL, NULL, NULL);
+    sqlite3_close(conn);
+
+    ASSERT_TRUE(trend_db_init(AD_TEST_DB));
+    ASSERT_EQ_INT(trend_db_query_alarms(4, 0, 1000, &alarms), 2);
+    ASSERT_EQ_INT(alarms.has_reading[0], 1);
+    ASSERT_EQ_INT(alarms.has_reading[1], 0);
+
+    /* A zero reading round-trips as a reading */
+    alarm_event_t cold = make_event(ALARM_PARAM_TEMP, ALARM_SEV_HIGH, 0, 300);
+    trend_db_bind_slot(0, 4);
+    trend_db_insert_alarm(0, 300, &cold);
+    ASSERT_EQ_INT(trend_db_query_alarms(4, 0, 1000, &alarms), 3);
+    alarm_event_t e;
+    char text[96];
+    trend_db_alarm_event(&alarms, 2, &e);
+    ASSERT_TRUE(e.has_reading);
+    alarm_engine_format_event(&e, text, sizeof(text));
+    ASSERT_STR_EQ(text, "Temp Very Low 0.0 (<30.0)");
+    trend_db_close();
+    remove_db();
+}
+
 /* ── Public entry point ──────────────────────────────────── */
 
 void test_alarm_db_integration(void) {
@@ -279,4 +506,7 @@ void test_alarm_db_integration(void) {
     test_alarm_state_persists();
     test_alarm_limits_and_trends();
     test_multiple_alarms_with_trends();
+    test_filtered_queries();
+    test_text_alarm_upgrade();
+    test_reading_flag_upgrade();
 }
@@ -0,0 +1,272 @@
+/**
+ * @file test_alarm_history_integration.c
+ * @brief Integration tests: alarm_history + trend_db (paged alarm log)
+ *
+ * Verifies that paging through a long alarm history returns every event
+ * once, newest first, including runs of events within one second that
+ * straddle a page boundary; that a page deep in the history is re-read
+ * with one query; that events recorded after opening are reported
+ * without disturbing the view; and that with job_pool running every read
+ * arrives through the completion, never on the calling thread.
+ */
+
+#include "test_framework.h"
+#include "alarm_history.h"
+#include "job_pool.h"
+#include <time.h>
+#include <unistd.h>
+
+#define AH_EVENTS  10000
+
+/* ── Helpers ─────────────────────────────────────────────── */
+
+static const uint32_t base = 1700000000u;
+
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000;
+}
+
+/** Event number `seq`, identifiable by its value. */
+static void insert_event(uint8_t slot, uint32_t ts, int seq) {
+    alarm_event_t e = {
+        .param = (alarm_param_t)(seq % ALARM_PARAM_COUNT),
+        .severity = ALARM_SEV_MEDIUM, .kind = ALARM_EVT_ONSET,
+        .value = seq, .threshold = 1, .has_reading = true,
+    };
+    trend_db_insert_alarm(slot, ts, &e);
+}
+
+/** Every event through alarm_history, checking newest-first order. */
+static int walk_all(int first_seq) {
+    int seen = 0;
+    for (int i = 0;; i++) {
+        if (i >= alarm_history_count() && !alarm_history_load_more()) break;
+        const alarm_event_t *e = alarm_history_get(i);
+        if (!e) break;
+        if (e->value != first_seq - i) {
+            ASSERT_EQ_INT(e->value, first_seq - i);
+            break;
+        }
+        seen++;
+    }
+    return seen;
+}
+
+/* ── Test: empty history ─────────────────────────────────── */
+
+static void test_empty(void) {
+    printf("  test_empty\n");
+    trend_db_init(":memory:");
+    alarm_history_open(1);
+    ASSERT_EQ_INT(alarm_history_count(), 0);
+    ASSERT_FALSE(alarm_history_has_more());
+    ASSERT_FALSE(alarm_history_load_more());
+    ASSERT_NULL(alarm_history_get(0));
+    ASSERT_EQ_INT(alarm_history_poll_new(), 0);
+    alarm_history_close();
+    trend_db_close();
+}
+
+/* ── Test: the whole history, in order, once ─────────────── */
+
+static void test_page_through(void) {
+    printf("  test_page_through\n");
+    trend_db_init(":memory:");
+    trend_db_bind_slot(0, 2);
+    trend_db_bind_slot(1, 3);
+    for (int s = 0; s < AH_EVENTS; s++) {
+        insert_event(0, base + (uint32_t)s * 20, s);
+        if (s % 7 == 0) insert_event(1, base + (uint32_t)s * 20, -s);
+    }
+
+    alarm_history_open(2);
+    ASSERT_EQ_INT(alarm_history_count(), ALARM_HISTORY_PAGE_ROWS);
+    ASSERT_TRUE(alarm_history_has_more());
+    ASSERT_EQ_INT(walk_all(AH_EVENTS - 1), AH_EVENTS);
+    ASSERT_EQ_INT(alarm_history_count(), AH_EVENTS);
+    ASSERT_FALSE(alarm_history_has_more());
+
+    /* One query per page, each page read once on the way down */
+    alarm_history_stats_t st = alarm_history_get_stats();
+    int pages = (AH_EVENTS + ALARM_HISTORY_PAGE_ROWS - 1) /
+                ALARM_HISTORY_PAGE_ROWS;
+    ASSERT_EQ_INT((int)st.page_reads, pages);
+    ASSERT_EQ_INT((int)st.cache_hits, AH_EVENTS);
+
+    /* Jumping back re-reads one page from its bookmark */
+    const alarm_event_t *e = alarm_history_get(40);
+    ASSERT_NOT_NULL(e);
+    if (e) ASSERT_EQ_INT(e->value, AH_EVENTS - 1 - 40);
+    ASSERT_EQ_INT((int)alarm_history_get_stats().page_reads, pages + 1);
+    e = alarm_history_get(41);
+    ASSERT_EQ_INT((int)alarm_history_get_stats().page_reads, pages + 1);
+    alarm_history_close();
+    trend_db_close();
+}
+
+/* ── Test: same-second runs across page boundaries ───────── */
+
+static void test_same_second(void) {
+    printf("  test_same_second\n");
+    trend_db_init(":memory:");
+
+    /* 100 events in three seconds: pages end mid-second */
+    for (int s = 0; s < 100; s++) {
+        insert_event(0, base + (uint32_t)(s / 40), s);
+    }
+    alarm_history_open(trend_db_slot_patient(0));
+    ASSERT_EQ_INT(walk_all(99), 100);
+    ASSERT_EQ_INT(alarm_history_count(), 100);
+    alarm_history_close();
+    trend_db_close();
+}
+
+/* ── Test: deep pages cost what the first one does ───────── */
+
+static void test_deep_page_cost(void) {
+    printf("  test_deep_page_cost\n");
+    trend_db_init(":memory:");
+    for (int s = 0; s < AH_EVENTS; s++) {
+        insert_event(0, base + (uint32_t)s * 20, s);
+    }
+    alarm_history_open(trend_db_slot_patient(0));
+    walk_all(AH_EVENTS - 1);
+
+    /* Alternate first and last pages so each get is a cache miss */
+    uint64_t first_us = 0, deep_us = 0;
+    for (int r = 0; r < 50; r++) {
+        uint64_t t0 = now_us();
+        alarm_history_get(0);
+        uint64_t t1 = now_us();
+        alarm_history_get(AH_EVENTS - 1);
+        uint64_t t2 = now_us();
+        alarm_history_get(ALARM_HISTORY_PAGE_ROWS * 100);
+        first_us += t1 - t0;
+        deep_us  += t2 - t1;
+    }
+    printf("    page read: first %.1f us, last of %d %.1f us\n",
+           first_us / 50.0, AH_EVENTS, deep_us / 50.0);
+    ASSERT_TRUE(deep_us < first_us * 4 + 50 * 200);
+    alarm_history_close();
+    trend_db_close();
+}
+
+/* ── Test: new events are reported, view unchanged ───────── */
+
+static void test_new_events(void) {
+    printf("  test_new_events\n");
+    trend_db_init(":memory:");
+    for (int s = 0; s < 50; s++) insert_event(0, base + (uint32_t)s, s);
+
+    int32_t pid = trend_db_slot_patient(0);
+    alarm_history_open(pid);
+    ASSERT_EQ_INT(alarm_history_poll_new(), 0);
+
+    /* Two later, one in the same second as the newest */
+    insert_event(0, base + 49, 50);
+    insert_event(0, base + 60, 51);
+    ASSERT_EQ_INT(alarm_history_poll_new(), 2);
+    ASSERT_EQ_INT(alarm_history_count(), ALARM_HISTORY_PAGE_ROWS);
+    const alarm_event_t *e = alarm_history_get(0);
+    ASSERT_NOT_NULL(e);
+    if (e) ASSERT_EQ_INT(e->value, 49);
+
+    alarm_history_open(pid);
+    ASSERT_EQ_INT(alarm_history_poll_new(), 0);
+    e = alarm_history_get(0);
+    ASSERT_NOT_NULL(e);
+    if (e) ASSERT_EQ_INT(e->value, 51);
+    ASSERT_EQ_INT(walk_all(51), 52);
+    alarm_history_close();
+    trend_db_close();
+}
+
+/* ── Test: reads run on job_pool ─────────────────────────── */
+
+static int updates;
+
+static void count_update(void *user_data) {
+    (void)user_data;
+    updates++;
+}
+
+/** Dispatch completions until no read is in flight. */
+static bool settle(void) {
+    for (int i = 0; i < 5000; i++) {
+        job_pool_dispatch_completions();
+        if (!alarm_history_busy()) return true;
+        usleep(1000);
+    }
+    return false;
+}
+
+static void test_async_reads(void) {
+    printf("  test_async_reads\n");
+    trend_db_init(":memory:");
+    for (int s = 0; s < 100; s++) insert_event(0, base + (uint32_t)s, s);
+    ASSERT_TRUE(job_pool_init(0));
+    alarm_history_set_callback(count_update, NULL);
+    updates = 0;
+
+    /* Nothing lands before the completion is dispatched */
+    alarm_history_open(trend_db_slot_patient(0));
+    ASSERT_EQ_INT(alarm_history_count(), 0);
+    ASSERT_TRUE(alarm_history_has_more());
+    ASSERT_TRUE(settle());
+    ASSERT_EQ_INT(updates, 1);
+    ASSERT_EQ_INT(alarm_history_count(), ALARM_HISTORY_PAGE_ROWS);
+
+    /* Two more pages push page 0 out of the cache */
+    ASSERT_TRUE(alarm_history_load_more());
+    ASSERT_TRUE(alarm_history_load_more());     /* Already in flight */
+    ASSERT_TRUE(settle());
+    ASSERT_TRUE(alarm_history_load_more());
+    ASSERT_TRUE(settle());
+    ASSERT_EQ_INT(alarm_history_count(), 3 * ALARM_HISTORY_PAGE_ROWS);
+    ASSERT_EQ_INT(updates, 3);
+
+    /* An evicted page is requested, then served from the cache */
+    ASSERT_NULL(alarm_history_get(0));
+    ASSERT_TRUE(settle());
+    ASSERT_EQ_INT(updates, 4);
+    const alarm_event_t *e = alarm_history_get(0);
+    ASSERT_NOT_NULL(e);
+    if (e) ASSERT_EQ_INT(e->value, 99);
+
+    /* The short last page ends the history */
+    ASSERT_TRUE(alarm_history_load_more());
+    ASSERT_TRUE(settle());
+    ASSERT_EQ_INT(alarm_history_count(), 100);
+    ASSERT_FALSE(alarm_history_has_more());
+
+    /* A poll reports on a later call */
+    insert_event(0, base + 200, 100);
+    ASSERT_EQ_INT(alarm_history_poll_new(), 0);
+    ASSERT_TRUE(settle());
+    ASSERT_EQ_INT(alarm_history_poll_new(), 1);
+
+    /* A read still running when the view is reopened is dropped */
+    alarm_history_open(trend_db_slot_patient(0));
+    alarm_history_close();
+    int before = updates;
+    ASSERT_TRUE(settle());
+    ASSERT_EQ_INT(updates, before);
+    ASSERT_EQ_INT(alarm_history_count(), 0);
+
+    alarm_history_set_callback(NULL, NULL);
+    job_pool_deinit();
+    trend_db_close();
+}
+
+/* ── Public entry point ──────────────────────────────────── */
+
+void test_alarm_history_integration(void) {
+    test_empty();
+    test_page_through();
+    test_same_second();
+    test_deep_page_cost();
+    test_new_events();
+    test_async_reads();
+}
@@ -0,0 +1,238 @@
+/**
+ * @file test_db_backup_integration.c
+ * @brief Integration tests: db_backup + trend_db + job_pool
+ *
+ * Backs up a live trend database while samples keep arriving and checks
+ * that the copy is complete, consistent and frozen at the backup's
+ * snapshot, that inserts stay fast meanwhile, that a paused run lets the
+ * WAL be truncated and resumes from a new snapshot, and that a cancelled
+ * or failed run leaves the previous backup in place.
+ */
+
+#include "test_framework.h"
+#include "db_backup.h"
+#include "trend_db.h"
+#include "job_pool.h"
+#include "sqlite3.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BK_TEST_DB   "/tmp/test_db_backup.db"
+#define BK_DEST      "/tmp/test_db_backup.bak"
+#define BK_PART      BK_DEST ".part"
+
+/* Slow enough that a run spans many slices */
+#define BK_BUDGET    (256u * 1024u)
+
+/* ── Helpers ─────────────────────────────────────────────── */
+
+static const uint32_t base = 1700000000u - (1700000000u % 3600);
+static uint32_t next_ts;
+
+static void remove_files(void) {
+    const char *files[] = { BK_TEST_DB, BK_TEST_DB "-wal", BK_TEST_DB "-shm",
+                            BK_DEST, BK_PART, BK_PART "-journal" };
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+        unlink(files[i]);
+    }
+}
+
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000;
+}
+
+/** Record `minutes` of 1 Hz samples; returns the slowest insert (us). */
+static uint32_t record_minutes(int minutes) {
+    uint32_t worst = 0;
+    for (int m = 0; m < minutes; m++) {
+        for (int s = 0; s < 60; s++) {
+            next_ts++;
+            uint64_t t0 = now_us();
+            trend_db_insert_sample(0, next_ts, 70 + s % 5, 97, 15, 36.9f);
+            uint32_t us = (uint32_t)(now_us() - t0);
+            if (us > worst) worst = us;
+        }
+        trend_db_aggregate_minute(next_ts);
+    }
+    return worst;
+}
+
+static int count_rows(const char *path, const char *sql) {
+    sqlite3 *c = NULL;
+    sqlite3_stmt *st = NULL;
+    int n = -1;
+    if (sqlite3_open_v2(path, &c, SQLITE_OPEN_READONLY, NULL) == SQLITE_OK &&
+        sqlite3_prepare_v2(c, sql, -1, &st, NULL) == SQLITE_OK &&
+        sqlite3_step(st) == SQLITE_ROW) {
+        n = sqlite3_column_int(st, 0);
+    }
+    sqlite3_finalize(st);
+    sqlite3_close(c);
+    return n;
+}
+
+static bool integrity_ok(const char *path) {
+    sqlite3 *c = NULL;
+    sqlite3_stmt *st = NULL;
+    bool ok = false;
+    if (sqlite3_open_v2(path, &c, SQLITE_OPEN_READONLY, NULL) == SQLITE_OK &&
+        sqlite3_prepare_v2(c, "PRAGMA integrity_check", -1, &st, NULL) == SQLITE_OK &&
+        sqlite3_step(st) == SQLITE_ROW) {
+        ok = strcmp((const char *)sqlite3_column_text(st, 0), "ok") == 0;
+    }
+    sqlite3_finalize(st);
+    sqlite3_close(c);
+    return ok;
+}
+
+static bool wait_until(bool (*cond)(void)) {
+    for (int i = 0; i < 10000; i++) {
+        job_pool_dispatch_completions();
+        if (cond()) return true;
+        usleep(1000);
+    }
+    return false;
+}
+
+static bool is_idle(void)    { return !db_backup_busy(); }
+static bool has_pages(void)  { return db_backup_get_status().pages_done > 0; }
+static bool is_paused(void)  {
+    return db_backup_get_status().state == DB_BACKUP_PAUSED;
+}
+
+#define MINUTES_SQL "SELECT COUNT(*) FROM vitals_1min"
+
+/* ── Test: copy of a live database ───────────────────────── */
+
+static void test_live_backup(void) {
+    printf("  test_live_backup\n");
+    uint32_t baseline = record_minutes(10);
+
+    ASSERT_TRUE(db_backup_start(BK_TEST_DB, BK_DEST, BK_BUDGET, NULL, NULL));
+    ASSERT_FALSE(db_backup_start(BK_TEST_DB, BK_DEST, BK_BUDGET, NULL, NULL));
+    ASSERT_TRUE(wait_until(has_pages));
+    int snapshot_rows = count_rows(BK_TEST_DB, MINUTES_SQL);
+
+    /* Keep writing while the copy runs */
+    uint32_t during = 0;
+    while (db_backup_busy()) {
+        uint32_t w = record_minutes(1);
+        if (w > during) during = w;
+        job_pool_dispatch_completions();
+        usleep(20000);
+    }
+    printf("    slowest insert: %u us before, %u us during backup\n",
+           (unsigned)baseline, (unsigned)during);
+
+    db_backup_status_t st = db_backup_get_status();
+    ASSERT_EQ_INT(st.state, DB_BACKUP_DONE);
+    ASSERT_EQ_INT(st.percent, 100);
+    ASSERT_GT_INT((int)st.slices, 1);
+    ASSERT_EQ_INT((int)st.pages_done, (int)st.pages_total);
+
+    /* Frozen at the snapshot, even though writes continued */
+    ASSERT_TRUE(integrity_ok(BK_DEST));
+    ASSERT_EQ_INT(count_rows(BK_DEST, MINUTES_SQL), snapshot_rows);
+    ASSERT_GT_INT(count_rows(BK_TEST_DB, MINUTES_SQL), snapshot_rows);
+    ASSERT_TRUE(access(BK_PART, F_OK) != 0);
+
+    /* Inserts never wait on the copy */
+    ASSERT_TRUE(during < 50000);
+}
+
+/* ── Test: pause releases the snapshot ───────────────────── */
+
+static void test_pause_resume(void) {
+    printf("  test_pause_resume\n");
+    ASSERT_FALSE(db_backup_resume());
+    ASSERT_TRUE(db_backup_start(BK_TEST_DB, BK_DEST, BK_BUDGET, NULL, NULL));
+    ASSERT_TRUE(wait_until(has_pages));
+
+    db_backup_pause();
+    ASSERT_TRUE(wait_until(is_paused));
+    uint32_t at = db_backup_get_status().pages_done;
+    record_minutes(2);
+    for (int i = 0; i < 20; i++) {
+        job_pool_dispatch_completions();
+        usleep(1000);
+    }
+    ASSERT_EQ_INT((int)db_backup_get_status().pages_done, (int)at);
+    ASSERT_TRUE(db_backup_busy());
+
+    /* Nothing pins the WAL while paused */
+    ASSERT_EQ_INT((int)trend_db_checkpoint(true), 0);
+
+    /* The copy has the rows written during the pause */
+    int rows = count_rows(BK_TEST_DB, MINUTES_SQL);
+    ASSERT_TRUE(db_backup_resume());
+    ASSERT_TRUE(wait_until(is_idle));
+    ASSERT_EQ_INT(db_backup_get_status().state, DB_BACKUP_DONE);
+    ASSERT_TRUE(integrity_ok(BK_DEST));
+    ASSERT_EQ_INT(count_rows(BK_DEST, MINUTES_SQL), rows);
+}
+
+/* ── Test: cancel and failure keep the old backup ────────── */
+
+static db_backup_state_t cb_state = DB_BACKUP_IDLE;
+
+static void on_done(const db_backup_status_t *st, void *user_data) {
+    (void)user_data;
+    cb_state = st->state;
+}
+
+static void test_cancel_keeps_previous(void) {
+    printf("  test_cancel_keeps_previous\n");
+    int kept = count_rows(BK_DEST, MINUTES_SQL);
+    ASSERT_GT_INT(kept, 0);
+
+    ASSERT_TRUE(db_backup_start(BK_TEST_DB, BK_DEST, BK_BUDGET, on_done, NULL));
+    ASSERT_TRUE(wait_until(has_pages));
+    db_backup_cancel();
+    ASSERT_TRUE(wait_until(is_idle));
+    ASSERT_EQ_INT(cb_state, DB_BACKUP_CANCELLED);
+    ASSERT_TRUE(access(BK_PART, F_OK) != 0);
+    ASSERT_EQ_INT(count_rows(BK_DEST, MINUTES_SQL), kept);
+
+    /* Cancelling while paused finishes at once */
+    ASSERT_TRUE(db_backup_start(BK_TEST_DB, BK_DEST, BK_BUDGET, on_done, NULL));
+    db_backup_pause();
+    ASSERT_TRUE(wait_until(is_paused));
+    db_backup_cancel();
+    ASSERT_FALSE(db_backup_busy());
+    ASSERT_EQ_INT(cb_state, DB_BACKUP_CANCELLED);
+
+    /* Unwritable destination */
+    ASSERT_TRUE(db_backup_start(BK_TEST_DB, "/nonexistent-dir/x.bak", 0,
+                                on_done, NULL));
+    ASSERT_TRUE(wait_until(is_idle));
+    ASSERT_EQ_INT(cb_state, DB_BACKUP_FAILED);
+    ASSERT_TRUE(integrity_ok(BK_DEST));
+}
+
+/* ── Public entry point ──────────────────────────────────── */
+
+void test_db_backup_integration(void) {
+    remove_files();
+    trend_db_init(BK_TEST_DB);
+    job_pool_init(0);
+    trend_db_bind_slot(0, 5);
+    next_ts = base;
+
+    /* ~400 KB of history: the copy takes many steps and slices */
+    for (int i = 0; i < 6; i++) {
+        trend_db_insert_nibp(0, base + (uint32_t)i, 120, 80, 93);
+    }
+    record_minutes(600);
+
+    test_live_backup();
+    test_pause_resume();
+    test_cancel_keeps_previous();
+
+    job_pool_deinit();
+    trend_db_close();
+    remove_files();
+}
@@ -9,6 +9,17 @@
  *   - alarm_engine + trend_db (alarm persistence)
  *   - auth_manager + audit_log (authentication audit trail)
  *   - patient_data + trend_db (patient vitals association)
+ *   - trend_query + job_pool + trend_db (asynchronous trend queries)
+ *   - trend_cache + trend_db (result cache and invalidation)
+ *   - trend_raw_pack + trend_db (packed per-minute raw samples)
+ *   - trend_db partitions (per-patient storage, discharge)
+ *   - trend_segment + trend_db (bed transfer export/import)
+ *   - trend_export + job_pool + trend_db (streaming USB export)
+ *   - db_backup + job_pool + trend_db (online backup of a live database)
+ *   - trend_db storage (auto_vacuum, size cap)
+ *   - recovery + alarm_engine + trend_db (restore after SIGKILL)
+ *   - alarm_history + trend_db (keyset-paged alarm log)
+ *   - trend_viewport + trend_query + trend_db (zoom/pan tiles, prefetch)
  */
 
 #include "test_framework.h"
@@ -22,6 +33,17 @@ int tf_fail  = 0;
 extern void test_alarm_db_integration(void);
 extern void test_auth_audit_integration(void);
 extern void test_patient_trends_integration(void);
+extern void test_trend_query_integration(void);
+extern void test_trend_cache_integration(void);
+extern void test_trend_raw_integration(void);
+extern void test_trend_partition_integration(void);
+extern void test_trend_segment_integration(void);
+extern void test_trend_export_integration(void);
+extern void test_db_backup_integration(void);
+extern void test_trend_storage_integration(void);
+extern void test_recovery_integration(void);
+extern void test_alarm_history_integration(void);
+extern void test_trend_viewport_integration(void);
 
 int main(void) {
     printf("========================================\n");
@@ -31,6 +53,17 @@ int main(void) {
     RUN_SUITE(test_alarm_db_integration);
     RUN_SUITE(test_auth_audit_integration);
     RUN_SUITE(test_patient_trends_integration);
+    RUN_SUITE(test_trend_query_integration);
+    RUN_SUITE(test_trend_cache_integration);
+    RUN_SUITE(test_trend_raw_integration);
+    RUN_SUITE(test_trend_partition_integration);
+    RUN_SUITE(test_trend_segment_integration);
+    RUN_SUITE(test_trend_export_integration);
+    RUN_SUITE(test_db_backup_integration);
+    RUN_SUITE(test_trend_storage_integration);
+    RUN_SUITE(test_recovery_integration);
+    RUN_SUITE(test_alarm_history_integration);
+    RUN_SUITE(test_trend_viewport_integration);
 
     TEST_SUMMARY();
 
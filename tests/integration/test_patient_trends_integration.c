@@ -72,12 +72,12 @@ static void test_admit_and_record_vitals(void) {
     /* Record vitals data into trend_db */
     uint32_t now = (uint32_t)time(NULL);
     for (int i = 0; i < 10; i++) {
-        trend_db_insert_sample(now + i, 72 + i, 97, 16, 37.0f);
+        trend_db_insert_sample(0, now + i, 72 + i, 97, 16, 37.0f);
     }
 
     /* Query trends */
     trend_query_result_t result;
-    int count = trend_db_query_param(TREND_PARAM_HR, now - 10,
+    int count = trend_db_query_param(0, TREND_PARAM_HR, now - 10,
                                      now + 100, 100, &result);
     ASSERT_EQ_INT(count, 10);
     ASSERT_EQ_INT(result.value[0], 72);
@@ -103,7 +103,7 @@ static void test_discharge_preserves_trends(void) {
     /* Record vitals */
     uint32_t now = (uint32_t)time(NULL);
     for (int i = 0; i < 5; i++) {
-        trend_db_insert_sample(now + i, 80, 95 + i, 18, 37.2f);
+        trend_db_insert_sample(0, now + i, 80, 95 + i, 18, 37.2f);
     }
 
     /* Discharge the patient */
@@ -119,12 +119,12 @@ static void test_discharge_preserves_trends(void) {
 
     /* Trend data should still be in the DB */
     trend_query_result_t result;
-    int count = trend_db_query_param(TREND_PARAM_HR, now - 10,
+    int count = trend_db_query_param(0, TREND_PARAM_HR, now - 10,
                                      now + 100, 100, &result);
     ASSERT_EQ_INT(count, 5);
 
     /* SpO2 data should also persist */
-    count = trend_db_query_param(TREND_PARAM_SPO2, now - 10,
+    count = trend_db_query_param(0, TREND_PARAM_SPO2, now - 10,
                                  now + 100, 100, &result);
     ASSERT_EQ_INT(count, 5);
     ASSERT_EQ_INT(result.value[0], 95);
@@ -150,17 +150,17 @@ static void test_query_trends_timeframe(void) {
 
     /* Phase 1: normal vitals (base to base+10) */
     for (int i = 0; i < 10; i++) {
-        trend_db_insert_sample(base + i, 70, 98, 14, 36.8f);
+        trend_db_insert_sample(0, base + i, 70, 98, 14, 36.8f);
     }
 
     /* Phase 2: elevated vitals (base+100 to base+110) */
     for (int i = 0; i < 10; i++) {
-        trend_db_insert_sample(base + 100 + i, 110, 92, 22, 38.5f);
+        trend_db_insert_sample(0, base + 100 + i, 110, 92, 22, 38.5f);
     }
 
     /* Query only phase 1 */
     trend_query_result_t result;
-    int count = trend_db_query_param(TREND_PARAM_HR, base - 1,
+    int count = trend_db_query_param(0, TREND_PARAM_HR, base - 1,
                                      base + 11, 100, &result);
     ASSERT_EQ_INT(count, 10);
     for (int i = 0; i < count; i++) {
@@ -168,7 +168,7 @@ static void test_query_trends_timeframe(void) {
     }
 
     /* Query only phase 2 */
-    count = trend_db_query_param(TREND_PARAM_HR, base + 99,
+    count = trend_db_query_param(0, TREND_PARAM_HR, base + 99,
                                  base + 111, 100, &result);
     ASSERT_EQ_INT(count, 10);
     for (int i = 0; i < count; i++) {
@@ -176,7 +176,7 @@ static void test_query_trends_timeframe(void) {
     }
 
     /* Query temperature for phase 2 */
-    count = trend_db_query_param(TREND_PARAM_TEMP, base + 99,
+    count = trend_db_query_param(0, TREND_PARAM_TEMP, base + 99,
                                  base + 111, 100, &result);
     ASSERT_EQ_INT(count, 10);
     /* Temp stored as x10: 38.5 -> 385 */
@@ -217,12 +217,12 @@ static void test_multiple_patients(void) {
 
     /* Record vitals (note: trend_db is global, not per-patient) */
     uint32_t now = (uint32_t)time(NULL);
-    trend_db_insert_sample(now, 75, 98, 16, 37.0f);
-    trend_db_insert_sample(now + 1, 90, 94, 20, 37.5f);
+    trend_db_insert_sample(0, now, 75, 98, 16, 37.0f);
+    trend_db_insert_sample(0, now + 1, 90, 94, 20, 37.5f);
 
     /* Both samples are in the DB */
     trend_query_result_t result;
-    int count = trend_db_query_param(TREND_PARAM_HR, now - 10,
+    int count = trend_db_query_param(0, TREND_PARAM_HR, now - 10,
                                      now + 10, 100, &result);
     ASSERT_EQ_INT(count, 2);
 
@@ -250,13 +250,13 @@ static void test_nibp_with_patient(void) {
     uint32_t now = (uint32_t)time(NULL);
 
     /* Record NIBP measurements */
-    trend_db_insert_nibp(now,     120, 80, 93);
-    trend_db_insert_nibp(now + 60, 135, 88, 104);
-    trend_db_insert_nibp(now + 120, 140, 90, 107);
+    trend_db_insert_nibp(0, now,     120, 80, 93);
+    trend_db_insert_nibp(0, now + 60, 135, 88, 104);
+    trend_db_insert_nibp(0, now + 120, 140, 90, 107);
 
     /* Query NIBP data */
     trend_nibp_result_t nibp_result;
-    int count = trend_db_query_nibp(now - 10, now + 200, &nibp_result);
+    int count = trend_db_query_nibp(0, now - 10, now + 200, &nibp_result);
     ASSERT_EQ_INT(count, 3);
     ASSERT_EQ_INT(nibp_result.sys[0], 120);
     ASSERT_EQ_INT(nibp_result.dia[0], 80);
@@ -287,7 +287,7 @@ static void test_patient_crud_with_trends(void) {
 
     /* Record some vitals */
     uint32_t now = (uint32_t)time(NULL);
-    trend_db_insert_sample(now, 72, 97, 15, 36.9f);
+    trend_db_insert_sample(0, now, 72, 97, 15, 36.9f);
 
     /* Find by MRN */
     patient_t found;
@@ -309,7 +309,7 @@ static void test_patient_crud_with_trends(void) {
 
     /* Trends remain untouched after patient update */
     trend_query_result_t result;
-    int count = trend_db_query_param(TREND_PARAM_HR, now - 10,
+    int count = trend_db_query_param(0, TREND_PARAM_HR, now - 10,
                                      now + 10, 100, &result);
     ASSERT_EQ_INT(count, 1);
     ASSERT_EQ_INT(result.value[0], 72);
@@ -0,0 +1,321 @@
+/**
+ * @file test_recovery_integration.c
+ * @brief Integration tests: recovery + alarm_engine + trend_db
+ *
+ * A forked child records vitals and is killed with SIGKILL, so nothing
+ * it held in memory reaches the disk by any path other than the recovery
+ * snapshot.  Verifies that the partial minute and alarm state come back
+ * after an unclean stop, that a clean shutdown and a long outage restore
+ * nothing, that a corrupt snapshot is ignored, and times recovery after
+ * kills at random points.
+ */
+
+#include "test_framework.h"
+#include "recovery.h"
+#include "job_pool.h"
+#include "crc32.h"
+#include "sqlite3.h"
+#include <stddef.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define RC_TEST_DB   "/tmp/test_recovery.db"
+#define RC_SNAP      "/tmp/test_recovery.snap"
+#define RC_KILLS     12
+
+/* ── Helpers ─────────────────────────────────────────────── */
+
+static const uint32_t base = 1700000000u - (1700000000u % 60);
+static trend_query_result_t res;
+
+static void remove_files(void) {
+    unlink(RC_TEST_DB);
+    unlink(RC_TEST_DB "-wal");
+    unlink(RC_TEST_DB "-shm");
+    unlink(RC_SNAP);
+    unlink(RC_SNAP ".tmp");
+}
+
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000;
+}
+
+static vitals_data_t make_vitals(int hr) {
+    vitals_data_t v;
+    memset(&v, 0, sizeof(v));
+    v.hr = hr;
+    v.spo2 = 97;
+    v.rr = 16;
+    v.temp = 36.8f;
+    v.nibp_sys = 120;
+    v.nibp_dia = 80;
+    return v;
+}
+
+static bool integrity_ok(void) {
+    sqlite3 *c = NULL;
+    sqlite3_stmt *st = NULL;
+    bool ok = false;
+    if (sqlite3_open(RC_TEST_DB, &c) == SQLITE_OK &&
+        sqlite3_prepare_v2(c, "PRAGMA integrity_check;", -1, &st,
+                           NULL) == SQLITE_OK &&
+        sqlite3_step(st) == SQLITE_ROW) {
+        ok = strcmp((const char *)sqlite3_column_text(st, 0), "ok") == 0;
+    }
+    sqlite3_finalize(st);
+    sqlite3_close(c);
+    return ok;
+}
+
+/** Open everything the way the simulator boots. */
+static const recovery_report_t *reopen(void) {
+    trend_db_init(RC_TEST_DB);
+    alarm_engine_init();
+    recovery_init(RC_SNAP);
+    return recovery_get_report();
+}
+
+static void close_all(void) {
+    alarm_engine_deinit();
+    trend_db_close();
+}
+
+/**
+ * Child: 30 s of HR 160 into a new minute, acknowledge the alarm, save a
+ * snapshot, then wait to be killed.  Returns once the child is dead.
+ */
+static void run_and_kill(void) {
+    int fds[2];
+    if (pipe(fds) != 0) return;
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        reopen();
+        vitals_data_t v = make_vitals(160);
+        for (uint32_t t = 1; t <= 30; t++) {
+            trend_db_insert_sample(0, base + t, v.hr, v.spo2, v.rr, v.temp);
+        }
+        alarm_engine_evaluate(&v, 30);
+        alarm_engine_acknowledge(ALARM_PARAM_HR);
+        recovery_save_now();
+        char c = 1;
+        if (write(fds[1], &c, 1) != 1) _exit(1);
+        for (;;) pause();
+    }
+    close(fds[1]);
+    char c;
+    if (read(fds[0], &c, 1) != 1) c = 0;
+    close(fds[0]);
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, 0);
+}
+
+/** Make the snapshot on disk `age_s` seconds older (CRC kept valid). */
+static void age_snapshot(int64_t age_s) {
+    static recovery_snapshot_t s;
+    FILE *f = fopen(RC_SNAP, "r+b");
+    if (!f) return;
+    if (fread(&s, sizeof(s), 1, f) == 1) {
+        s.wall_s -= age_s;
+        s.crc = crc32_update(0, &s, offsetof(recovery_snapshot_t, crc));
+        rewind(f);
+        fwrite(&s, sizeof(s), 1, f);
+    }
+    fclose(f);
+}
+
+/* ── Test: partial minute and alarms survive SIGKILL ─────── */
+
+static void test_unclean_restore(void) {
+    printf("  test_unclean_restore\n");
+    remove_files();
+    run_and_kill();
+
+    const recovery_report_t *r = reopen();
+    ASSERT_TRUE(r->found);
+    ASSERT_FALSE(r->clean);
+    ASSERT_TRUE(r->alarms_restored);
+    ASSERT_EQ_INT(r->minutes_restored, 1);
+    ASSERT_TRUE(integrity_ok());
+
+    const alarm_engine_state_t *st = alarm_engine_get_state();
+    ASSERT_EQ_INT(st->params[ALARM_PARAM_HR].state, ALARM_STATE_ACKNOWLEDGED);
+    ASSERT_EQ_INT(st->highest_any, ALARM_SEV_HIGH);
+
+    int n = trend_db_query_param_tier(0, TREND_PARAM_HR, base + 1, base + 60,
+                                      TREND_DB_MAX_POINTS, TREND_TIER_RAW,
+                                      &res);
+    ASSERT_EQ_INT(n, 30);
+    ASSERT_EQ_INT(res.value[29], 160);
+
+    /* The restored minute is aggregated as well */
+    n = trend_db_query_param_tier(0, TREND_PARAM_HR, base, base + 60,
+                                  TREND_DB_MAX_POINTS, TREND_TIER_1MIN, &res);
+    ASSERT_EQ_INT(n, 1);
+    close_all();
+}
+
+/* ── Test: clean shutdown restores nothing ───────────────── */
+
+static void test_clean_shutdown(void) {
+    printf("  test_clean_shutdown\n");
+    remove_files();
+    run_and_kill();
+    reopen();
+    recovery_shutdown();
+
+    /* Truncated on the way down */
+    trend_db_storage_t storage;
+    ASSERT_TRUE(trend_db_get_storage(&storage));
+    ASSERT_EQ_INT((int)storage.wal_bytes, 0);
+    close_all();
+
+    const recovery_report_t *r = reopen();
+    ASSERT_TRUE(r->found);
+    ASSERT_TRUE(r->clean);
+    ASSERT_FALSE(r->alarms_restored);
+    ASSERT_EQ_INT(r->minutes_restored, 0);
+    ASSERT_EQ_INT(alarm_engine_get_state()->highest_any, ALARM_SEV_NONE);
+
+    /* Data restored by the previous boot is still there */
+    int n = trend_db_query_param_tier(0, TREND_PARAM_HR, base + 1, base + 60,
+                                      TREND_DB_MAX_POINTS, TREND_TIER_RAW,
+                                      &res);
+    ASSERT_EQ_INT(n, 30);
+    close_all();
+}
+
+/* ── Test: long outage keeps samples, drops alarm state ──── */
+
+static void test_long_outage(void) {
+    printf("  test_long_outage\n");
+    remove_files();
+    run_and_kill();
+    age_snapshot(RECOVERY_MAX_OUTAGE_S + 90);
+
+    const recovery_report_t *r = reopen();
+    ASSERT_FALSE(r->clean);
+    ASSERT_TRUE(r->outage_s > RECOVERY_MAX_OUTAGE_S);
+    ASSERT_FALSE(r->alarms_restored);
+    ASSERT_EQ_INT(r->minutes_restored, 1);
+    ASSERT_EQ_INT(alarm_engine_get_state()->params[ALARM_PARAM_HR].state,
+                  ALARM_STATE_INACTIVE);
+    close_all();
+}
+
+/* ── Test: corrupt snapshot is ignored and replaced ──────── */
+
+static void test_corrupt_snapshot(void) {
+    printf("  test_corrupt_snapshot\n");
+    remove_files();
+    run_and_kill();
+
+    FILE *f = fopen(RC_SNAP, "r+b");
+    ASSERT_NOT_NULL(f);
+    if (f) {
+        fseek(f, 40, SEEK_SET);
+        fputc(0x5A, f);
+        fclose(f);
+    }
+
+    const recovery_report_t *r = reopen();
+    ASSERT_FALSE(r->found);
+    ASSERT_FALSE(r->alarms_restored);
+    ASSERT_EQ_INT(r->minutes_restored, 0);
+    close_all();
+
+    /* A fresh snapshot was written in its place */
+    r = reopen();
+    ASSERT_TRUE(r->found);
+    close_all();
+}
+
+/* ── Test: SIGKILL at random points ──────────────────────── */
+
+/** Child: record at full speed through the real tick path until killed. */
+static void record_until_killed(int ready_fd, uint32_t from) {
+    reopen();
+    job_pool_init(1);
+    char c = 1;
+    if (write(ready_fd, &c, 1) != 1) _exit(1);
+
+    vitals_data_t v = make_vitals(80);
+    for (uint32_t t = from;; t++) {
+        v.hr = 60 + (int)(t % 100);
+        trend_db_insert_sample(0, t, v.hr, v.spo2, v.rr, v.temp);
+        alarm_engine_evaluate(&v, t - from);
+        if (t % 60 == 0) trend_db_aggregate_minute(t);
+        if (t % 10 == 0) {
+            job_pool_dispatch_completions();
+            recovery_tick();
+        }
+        usleep(100);
+    }
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void test_kill_benchmark(void) {
+    printf("  test_kill_benchmark\n");
+    remove_files();
+    srand(88);
+
+    uint32_t reopen_us[RC_KILLS];
+    uint64_t wal_max = 0;
+    int unclean = 0;
+    for (int k = 0; k < RC_KILLS; k++) {
+        int fds[2];
+        if (pipe(fds) != 0) break;
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(fds[0]);
+            record_until_killed(fds[1], base + (uint32_t)k * 100000u + 1);
+            _exit(0);
+        }
+        close(fds[1]);
+        char c;
+        if (read(fds[0], &c, 1) != 1) c = 0;
+        close(fds[0]);
+        usleep(10000 + (unsigned)(rand() % 90000));
+        kill(pid, SIGKILL);
+        waitpid(pid, NULL, 0);
+
+        uint64_t t0 = now_us();
+        const recovery_report_t *r = reopen();
+        reopen_us[k] = (uint32_t)(now_us() - t0);
+        if (r->found && !r->clean) unclean++;
+        if (r->wal_bytes > wal_max) wal_max = r->wal_bytes;
+        ASSERT_TRUE(integrity_ok());
+        close_all();
+    }
+    ASSERT_EQ_INT(unclean, RC_KILLS);
+    ASSERT_TRUE(wal_max <= RECOVERY_WAL_MAX_BYTES);
+
+    qsort(reopen_us, RC_KILLS, sizeof(reopen_us[0]), cmp_u32);
+    printf("    %d kills: reopen p50 %u us, max %u us, WAL max %llu KB\n",
+           RC_KILLS, (unsigned)reopen_us[RC_KILLS / 2],
+           (unsigned)reopen_us[RC_KILLS - 1],
+           (unsigned long long)(wal_max / 1024));
+    ASSERT_TRUE(reopen_us[RC_KILLS - 1] < 2000000u);
+}
+
+/* ── Public entry point ──────────────────────────────────── */
+
+void test_recovery_integration(void) {
+    test_unclean_restore();
+    test_clean_shutdown();
+    test_long_outage();
+    test_corrupt_snapshot();
+    test_kill_benchmark();
+    remove_files();
+}
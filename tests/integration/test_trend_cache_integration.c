@@ -0,0 +1,249 @@
+/**
+ * @file test_trend_cache_integration.c
+ * @brief Integration tests: trend_cache + trend_db + trend_query
+ *
+ * Verifies round-tripping of cached results, LRU eviction within the
+ * memory budget, invalidation when trend_db writes a minute aggregate,
+ * that a result read across an invalidation is not stored, and that a
+ * repeated trend_query request is served from the cache.
+ */
+
+#include "test_framework.h"
+#include "trend_cache.h"
+#include "trend_query.h"
+#include "job_pool.h"
+#include <unistd.h>
+
+#define TC_TEST_DB  "/tmp/test_trend_cache.db"
+
+/* ── Helpers ─────────────────────────────────────────────── */
+
+static trend_query_result_t res_in;
+static trend_query_result_t res_out;
+
+static trend_cache_key_t make_key(trend_param_t p, uint32_t range_s,
+                                  uint32_t end_ts) {
+    trend_cache_key_t key;
+    key.patient_id = 0;
+    key.param      = p;
+    key.tier       = TREND_TIER_1MIN;
+    key.range_s    = range_s;
+    key.bucket_s   = 60;
+    key.end_ts     = end_ts;
+    key.max_points = TREND_DB_MAX_POINTS;
+    key.ds         = TREND_DS_AVG;
+    return key;
+}
+
+/** Miss, then store: the order trend_query uses. */
+static bool store(const trend_cache_key_t *key) {
+    uint32_t gen;
+    trend_cache_lookup(key, &res_out, &gen);
+    return trend_cache_store(key, &res_in, gen);
+}
+
+static void fill_result(int count, int32_t base_val) {
+    for (int i = 0; i < count; i++) {
+        res_in.timestamp_s[i] = 1000u + (uint32_t)i * 60;
+        res_in.value[i]       = base_val + i;
+        res_in.value_min[i]   = base_val + i - 1;
+        res_in.value_max[i]   = base_val + i + 1;
+    }
+    res_in.count = count;
+    res_in.bucket_s = 60;
+}
+
+static int query_done = 0;
+
+static void count_cb(const trend_query_set_t *set, void *user_data) {
+    (void)set;
+    (void)user_data;
+    query_done++;
+}
+
+static bool wait_idle(void) {
+    for (int i = 0; i < 2000; i++) {
+        job_pool_dispatch_completions();
+        if (!trend_query_busy()) return true;
+        usleep(1000);
+    }
+    return false;
+}
+
+/* ── Test: store then lookup returns identical points ─────── */
+
+static void test_store_lookup(void) {
+    printf("  test_store_lookup\n");
+    trend_cache_clear();
+
+    trend_cache_key_t key = make_key(TREND_PARAM_HR, 3600, 60000);
+    trend_cache_stats_t before = trend_cache_get_stats();
+
+    uint32_t gen;
+    ASSERT_FALSE(trend_cache_lookup(&key, &res_out, &gen));
+
+    fill_result(100, 70);
+    ASSERT_TRUE(trend_cache_store(&key, &res_in, gen));
+    ASSERT_TRUE(trend_cache_lookup(&key, &res_out, NULL));
+    ASSERT_EQ_INT(res_out.count, 100);
+    ASSERT_EQ_INT((int)res_out.bucket_s, 60);
+    ASSERT_EQ_INT(res_out.value[0], 70);
+    ASSERT_EQ_INT(res_out.value[99], 169);
+    ASSERT_EQ_INT(res_out.value_min[50], 119);
+    ASSERT_EQ_INT(res_out.value_max[50], 121);
+    ASSERT_EQ_INT((int)res_out.timestamp_s[99], 1000 + 99 * 60);
+
+    /* A different key component is a different entry */
+    trend_cache_key_t other = key;
+    other.param = TREND_PARAM_SPO2;
+    ASSERT_FALSE(trend_cache_lookup(&other, &res_out, NULL));
+
+    trend_cache_stats_t after = trend_cache_get_stats();
+    ASSERT_EQ_INT((int)(after.hits - before.hits), 1);
+    ASSERT_EQ_INT((int)(after.misses - before.misses), 2);
+    ASSERT_EQ_INT((int)after.entries, 1);
+
+    trend_cache_clear();
+    ASSERT_EQ_INT((int)trend_cache_get_stats().entries, 0);
+    ASSERT_EQ_INT((int)trend_cache_get_stats().bytes_used, 0);
+}
+
+/* ── Test: budget exhaustion evicts least recently used ───── */
+
+static void test_lru_eviction(void) {
+    printf("  test_lru_eviction\n");
+    trend_cache_clear();
+
+    fill_result(TREND_DB_MAX_POINTS, 50);
+    uint32_t before = trend_cache_get_stats().evictions;
+
+    /* Store full-size entries until the budget forces evictions,
+     * touching entry 0 after every store so it stays recent */
+    trend_cache_key_t first = make_key(TREND_PARAM_HR, 3600, 60);
+    ASSERT_TRUE(store(&first));
+    int stored = 1;
+    while (trend_cache_get_stats().evictions == before && stored < 200) {
+        trend_cache_key_t k = make_key(TREND_PARAM_HR, 3600,
+                                       60 + (uint32_t)stored * 60);
+        ASSERT_TRUE(store(&k));
+        ASSERT_TRUE(trend_cache_lookup(&first, &res_out, NULL));
+        stored++;
+    }
+    ASSERT_GT_INT((int)trend_cache_get_stats().evictions, (int)before);
+    ASSERT_TRUE(trend_cache_get_stats().bytes_used <= TREND_CACHE_BUDGET_BYTES);
+
+    /* Entry 1 was the least recently used; entry 0 survived */
+    trend_cache_key_t second = make_key(TREND_PARAM_HR, 3600, 120);
+    ASSERT_FALSE(trend_cache_lookup(&second, &res_out, NULL));
+    ASSERT_TRUE(trend_cache_lookup(&first, &res_out, NULL));
+    ASSERT_EQ_INT(res_out.count, TREND_DB_MAX_POINTS);
+
+    trend_cache_clear();
+}
+
+/* ── Test: invalidation drops only overlapping entries ────── */
+
+static void test_invalidate_range(void) {
+    printf("  test_invalidate_range\n");
+    trend_cache_clear();
+
+    fill_result(10, 80);
+    trend_cache_key_t old_view = make_key(TREND_PARAM_HR, 3600, 7200);
+    trend_cache_key_t new_view = make_key(TREND_PARAM_HR, 3600, 14400);
+    ASSERT_TRUE(store(&old_view));
+    ASSERT_TRUE(store(&new_view));
+
+    /* A minute aggregate at 14400 touches only the view ending there */
+    trend_cache_invalidate_range(14400 - 59, UINT32_MAX);
+    ASSERT_TRUE(trend_cache_lookup(&old_view, &res_out, NULL));
+    ASSERT_FALSE(trend_cache_lookup(&new_view, &res_out, NULL));
+
+    trend_cache_clear();
+}
+
+/* ── Test: a read spanning an invalidation is not stored ─── */
+
+static void test_stale_store(void) {
+    printf("  test_stale_store\n");
+    trend_cache_clear();
+
+    fill_result(10, 90);
+    trend_cache_key_t key = make_key(TREND_PARAM_HR, 3600, 21600);
+    uint32_t before = trend_cache_get_stats().stale_stores;
+
+    /* Miss, then a minute aggregate lands while the scan runs */
+    uint32_t gen;
+    ASSERT_FALSE(trend_cache_lookup(&key, &res_out, &gen));
+    trend_cache_invalidate_range(21600 - 59, UINT32_MAX);
+    ASSERT_FALSE(trend_cache_store(&key, &res_in, gen));
+    ASSERT_FALSE(trend_cache_lookup(&key, &res_out, &gen));
+    ASSERT_EQ_INT((int)(trend_cache_get_stats().stale_stores - before), 1);
+
+    /* A fresh miss stores normally */
+    ASSERT_TRUE(trend_cache_store(&key, &res_in, gen));
+    ASSERT_TRUE(trend_cache_lookup(&key, &res_out, NULL));
+
+    trend_cache_clear();
+}
+
+/* ── Test: repeated request is served from the cache ─────── */
+
+static void test_repeated_request_hits(void) {
+    printf("  test_repeated_request_hits\n");
+    unlink(TC_TEST_DB);
+    unlink(TC_TEST_DB "-wal");
+    unlink(TC_TEST_DB "-shm");
+    trend_db_init(TC_TEST_DB);
+    job_pool_init(0);
+
+    uint32_t base = 1700000000u - (1700000000u % 60);
+    for (uint32_t t = 0; t < 600; t++) {
+        trend_db_insert_sample(0, base + t, 75, 98, 15, 36.9f);
+    }
+    for (uint32_t m = 1; m <= 10; m++) {
+        trend_db_aggregate_minute(base + m * 60);
+    }
+
+    query_done = 0;
+    trend_cache_stats_t s0 = trend_cache_get_stats();
+
+    /* End time mid-minute: aligned back to base + 600 */
+    trend_query_request(base, base + 630, 300, TREND_TIER_AUTO, false,
+                        count_cb, NULL);
+    ASSERT_TRUE(wait_idle());
+    trend_cache_stats_t s1 = trend_cache_get_stats();
+    ASSERT_EQ_INT((int)(s1.misses - s0.misses), TREND_PARAM_COUNT);
+    ASSERT_EQ_INT((int)(s1.hits - s0.hits), 0);
+
+    trend_query_request(base + 5, base + 635, 300, TREND_TIER_AUTO, false,
+                        count_cb, NULL);
+    ASSERT_TRUE(wait_idle());
+    trend_cache_stats_t s2 = trend_cache_get_stats();
+    ASSERT_EQ_INT((int)(s2.hits - s1.hits), TREND_PARAM_COUNT);
+    ASSERT_EQ_INT((int)(s2.misses - s1.misses), 0);
+
+    /* A new aggregate covering the window forces a re-query */
+    trend_db_aggregate_minute(base + 600);
+    trend_query_request(base, base + 630, 300, TREND_TIER_AUTO, false,
+                        count_cb, NULL);
+    ASSERT_TRUE(wait_idle());
+    trend_cache_stats_t s3 = trend_cache_get_stats();
+    ASSERT_EQ_INT((int)(s3.misses - s2.misses), TREND_PARAM_COUNT);
+    ASSERT_EQ_INT(query_done, 3);
+
+    job_pool_deinit();
+    trend_db_close();
+    unlink(TC_TEST_DB);
+    unlink(TC_TEST_DB "-wal");
+    unlink(TC_TEST_DB "-shm");
+}
+
+/* ── Public entry point ──────────────────────────────────── */
+
+void test_trend_cache_integration(void) {
+    test_store_lookup();
+    test_lru_eviction();
+    test_invalidate_range();
+    test_stale_store();
+    test_repeated_request_hits();
+}
@@ -0,0 +1,287 @@
+/**
+ * @file test_trend_export_integration.c
+ * @brief Integration tests: trend_export + trend_db + job_pool
+ *
+ * Verifies that a CSV export merges vitals, NIBP and alarms in time
+ * order with one line per record, that an hour with more alarms than one
+ * query returns is exported in full, that NDJSON output is gzip-framed when
+ * compression is on, that progress reaches 100 %, that interrupting trend
+ * scans never shortens an export, and that a cancelled export reports
+ * CANCELLED and leaves no file behind.
+ */
+
+#include "test_framework.h"
+#include "trend_export.h"
+#include "trend_db.h"
+#include "job_pool.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TE_TEST_DB   "/tmp/test_trend_export.db"
+#define TE_OUT_DIR   "/tmp"
+
+/* ── Helpers ─────────────────────────────────────────────── */
+
+static const uint32_t base = 1700000000u - (1700000000u % 3600);
+
+static trend_export_status_t last_status;
+static int done_calls = 0;
+
+static void done_cb(const trend_export_status_t *st, void *user_data) {
+    (void)user_data;
+    last_status = *st;
+    done_calls++;
+}
+
+static bool wait_done(void) {
+    for (int i = 0; i < 5000; i++) {
+        job_pool_dispatch_completions();
+        if (!trend_export_busy()) return true;
+        usleep(1000);
+    }
+    return false;
+}
+
+static void remove_db(void) {
+    unlink(TE_TEST_DB);
+    unlink(TE_TEST_DB "-wal");
+    unlink(TE_TEST_DB "-shm");
+}
+
+/** Two hours of 1 Hz vitals, hourly NIBP and two alarms for patient 3. */
+static void record_history(void) {
+    trend_db_bind_slot(0, 3);
+    for (uint32_t t = 1; t <= 7200; t++) {
+        trend_db_insert_sample(0, base + t, 72, 97, 15, 36.8f);
+        if (t % 60 == 0) trend_db_aggregate_minute(base + t);
+    }
+    trend_db_insert_nibp(0, base + 1800, 118, 77, 91);
+    trend_db_insert_nibp(0, base + 5400, 121, 79, 93);
+    alarm_event_t hr = {
+        .param = ALARM_PARAM_HR, .severity = ALARM_SEV_HIGH,
+        .kind = ALARM_EVT_ESCALATE, .value = 131, .threshold = 130,
+        .has_reading = true,
+    };
+    alarm_event_t rr = {
+        .param = ALARM_PARAM_RR, .severity = ALARM_SEV_LOW,
+        .kind = ALARM_EVT_ONSET, .value = 7, .threshold = 8,
+        .has_reading = true,
+    };
+    trend_db_insert_alarm(0, base + 1800, &hr);
+    trend_db_insert_alarm(0, base + 3000, &rr);
+}
+
+static int count_lines(const char *path, char *first, char *match,
+                       const char *needle) {
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+    char buf[512];
+    int n = 0;
+    while (fgets(buf, sizeof(buf), f)) {
+        if (n == 0 && first) strcpy(first, buf);
+        if (match && needle && strstr(buf, needle)) strcpy(match, buf);
+        n++;
+    }
+    fclose(f);
+    return n;
+}
+
+/* Parks the single worker so the next job stays queued */
+static volatile bool gate_open = false;
+
+static void gate_job(void *arg) {
+    (void)arg;
+    while (!gate_open) usleep(1000);
+}
+
+/* ── Test: CSV merges records in time order ──────────────── */
+
+static void test_csv_export(void) {
+    printf("  test_csv_export\n");
+    char path[TREND_EXPORT_PATH_MAX];
+    ASSERT_TRUE(trend_export_make_path(path, sizeof(path), TE_OUT_DIR, 3,
+                                       base + 7200, TREND_EXPORT_CSV, false));
+    ASSERT_STR_EQ(path + strlen(path) - 4, ".csv");
+
+    done_calls = 0;
+    ASSERT_TRUE(trend_export_start(3, base, base + 7199, TREND_EXPORT_CSV,
+                                   false, path, done_cb, NULL));
+    ASSERT_FALSE(trend_export_start(3, base, base + 7199, TREND_EXPORT_CSV,
+                                    false, path, done_cb, NULL));
+    ASSERT_TRUE(wait_done());
+    ASSERT_EQ_INT(done_calls, 1);
+    ASSERT_EQ_INT(last_status.state, TREND_EXPORT_DONE);
+    ASSERT_EQ_INT(last_status.percent, 100);
+
+    /* 119 minutes (the 120th lies past the range), 2 NIBP, 2 alarms */
+    ASSERT_EQ_INT((int)last_status.records, 119 + 2 + 2);
+
+    char first[512], alarm[512], nibp[512];
+    ASSERT_EQ_INT(count_lines(path, first, alarm, "alarm,"), 1 + 123);
+    ASSERT_TRUE(strncmp(first, "record,timestamp_s,time_utc,hr,", 31) == 0);
+    ASSERT_TRUE(strstr(alarm, ",low,\"RR Low 7 (<8)\"") != NULL);
+    count_lines(path, NULL, nibp, "nibp,");
+    ASSERT_TRUE(strstr(nibp, ",121,79,93,,") != NULL);
+
+    /* Rendered text is quoted, and vitals sort before an alarm at the
+       same second */
+    FILE *f = fopen(path, "r");
+    char buf[512], prev[512] = "";
+    bool seen = false;
+    while (f && fgets(buf, sizeof(buf), f)) {
+        if (strstr(buf, ",high,\"HR Very High 131 (>130), escalated\"")) {
+            seen = true;
+            ASSERT_TRUE(strncmp(prev, "nibp,", 5) == 0);
+        }
+        strcpy(prev, buf);
+    }
+    if (f) fclose(f);
+    ASSERT_TRUE(seen);
+    unlink(path);
+}
+
+/* ── Test: busy hour is not truncated ────────────────────── */
+
+static void test_busy_hour(void) {
+    printf("  test_busy_hour\n");
+
+    /* 600 alarms within one hour for patient 4 */
+    trend_db_bind_slot(1, 4);
+    alarm_event_t spo2 = {
+        .param = ALARM_PARAM_SPO2, .severity = ALARM_SEV_MEDIUM,
+        .kind = ALARM_EVT_ONSET, .value = 89, .threshold = 90,
+        .has_reading = true,
+    };
+    for (uint32_t i = 0; i < 600; i++) {
+        trend_db_insert_alarm(1, base + i * 5, &spo2);
+    }
+
+    char path[TREND_EXPORT_PATH_MAX];
+    ASSERT_TRUE(trend_export_make_path(path, sizeof(path), TE_OUT_DIR, 4,
+                                       base + 3600, TREND_EXPORT_CSV, false));
+    ASSERT_TRUE(trend_export_start(4, base, base + 3599, TREND_EXPORT_CSV,
+                                   false, path, done_cb, NULL));
+    ASSERT_TRUE(wait_done());
+    ASSERT_EQ_INT(last_status.state, TREND_EXPORT_DONE);
+    ASSERT_EQ_INT((int)last_status.records, 600);
+    ASSERT_EQ_INT(count_lines(path, NULL, NULL, NULL), 1 + 600);
+
+    /* Still in time order across the split */
+    FILE *f = fopen(path, "r");
+    char buf[512];
+    unsigned prev = 0;
+    bool ordered = true;
+    if (f && fgets(buf, sizeof(buf), f)) {          /* Header */
+        while (fgets(buf, sizeof(buf), f)) {
+            unsigned ts = 0;
+            sscanf(buf, "alarm,%u,", &ts);
+            if (ts < prev) ordered = false;
+            prev = ts;
+        }
+    }
+    if (f) fclose(f);
+    ASSERT_TRUE(ordered);
+    ASSERT_EQ_INT((int)prev, (int)(base + 599 * 5));
+    unlink(path);
+}
+
+/* ── Test: NDJSON with on-the-fly gzip ───────────────────── */
+
+static void test_ndjson_gzip(void) {
+    printf("  test_ndjson_gzip\n");
+    char path[TREND_EXPORT_PATH_MAX];
+    trend_export_make_path(path, sizeof(path), TE_OUT_DIR, 3, base + 7200,
+                           TREND_EXPORT_NDJSON, true);
+    ASSERT_STR_EQ(path + strlen(path) - 10, ".ndjson.gz");
+
+    ASSERT_TRUE(trend_export_start(3, base, base + 7199, TREND_EXPORT_NDJSON,
+                                   true, path, done_cb, NULL));
+    ASSERT_TRUE(wait_done());
+    ASSERT_EQ_INT(last_status.state, TREND_EXPORT_DONE);
+
+    FILE *f = fopen(path, "rb");
+    ASSERT_NOT_NULL(f);
+    unsigned char hdr[2] = { 0, 0 };
+    if (f) {
+        ASSERT_EQ_INT((int)fread(hdr, 1, 2, f), 2);
+        fseek(f, 0, SEEK_END);
+        ASSERT_EQ_INT((int)ftell(f), (int)last_status.bytes);
+        fclose(f);
+    }
+    ASSERT_EQ_INT(hdr[0], 0x1F);
+    ASSERT_EQ_INT(hdr[1], 0x8B);
+    /* ~30 KB of JSON lines shrinks well */
+    ASSERT_TRUE(last_status.bytes > 0 && last_status.bytes < 8000);
+    unlink(path);
+}
+
+/* ── Test: trend scan interrupts leave exports whole ─────── */
+
+static void test_scan_interrupts(void) {
+    printf("  test_scan_interrupts\n");
+    char path[TREND_EXPORT_PATH_MAX];
+    trend_export_make_path(path, sizeof(path), TE_OUT_DIR, 3, 2,
+                           TREND_EXPORT_CSV, false);
+
+    /* What a trend range switch does while the export reads */
+    ASSERT_TRUE(trend_export_start(3, base, base + 7199, TREND_EXPORT_CSV,
+                                   false, path, done_cb, NULL));
+    for (int i = 0; i < 5000 && trend_export_busy(); i++) {
+        trend_db_interrupt_scans();
+        job_pool_dispatch_completions();
+        usleep(100);
+    }
+    ASSERT_TRUE(wait_done());
+    ASSERT_EQ_INT(last_status.state, TREND_EXPORT_DONE);
+    ASSERT_EQ_INT((int)last_status.records, 119 + 2 + 2);
+    unlink(path);
+}
+
+/* ── Test: cancellation removes the partial file ─────────── */
+
+static void test_cancel(void) {
+    printf("  test_cancel\n");
+    char path[TREND_EXPORT_PATH_MAX];
+    trend_export_make_path(path, sizeof(path), TE_OUT_DIR, 3, 1,
+                           TREND_EXPORT_CSV, false);
+
+    gate_open = false;
+    ASSERT_TRUE(job_pool_submit(JOB_PRIO_LOW, gate_job, NULL, NULL));
+    ASSERT_TRUE(trend_export_start(3, base, base + 72u * 3600u,
+                                   TREND_EXPORT_CSV, false, path,
+                                   done_cb, NULL));
+    ASSERT_EQ_INT(trend_export_get_status().state, TREND_EXPORT_RUNNING);
+    trend_export_cancel();
+    gate_open = true;
+
+    ASSERT_TRUE(wait_done());
+    ASSERT_EQ_INT(last_status.state, TREND_EXPORT_CANCELLED);
+    ASSERT_TRUE(access(path, F_OK) != 0);
+
+    /* Unwritable destination fails cleanly */
+    ASSERT_TRUE(trend_export_start(3, base, base + 60, TREND_EXPORT_CSV,
+                                   false, "/nonexistent-dir/x.csv",
+                                   done_cb, NULL));
+    ASSERT_TRUE(wait_done());
+    ASSERT_EQ_INT(last_status.state, TREND_EXPORT_FAILED);
+}
+
+/* ── Public entry point ──────────────────────────────────── */
+
+void test_trend_export_integration(void) {
+    remove_db();
+    trend_db_init(TE_TEST_DB);
+    job_pool_init(1);
+    record_history();
+
+    test_csv_export();
+    test_busy_hour();
+    test_ndjson_gzip();
+    test_scan_interrupts();
+    test_cancel();
+
+    job_pool_deinit();
+    trend_db_close();
+    remove_db();
+}
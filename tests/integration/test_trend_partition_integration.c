@@ -0,0 +1,248 @@
+/**
+ * @file test_trend_partition_integration.c
+ * @brief Integration tests: per-patient partitions in trend_db
+ *
+ * Verifies that two slots bound to different patients write to separate
+ * partitions, that discharge by archive keeps the old patient's history
+ * out of the next admission (and retention later forgets it), that a
+ * dropped partition disappears from every table, and that tables from
+ * an unpartitioned build are adopted into partition 0.
+ */
+
+#include "test_framework.h"
+#include "trend_db.h"
+#include "sqlite3.h"
+#include <unistd.h>
+
+#define TP_TEST_DB  "/tmp/test_trend_partition.db"
+
+/* ── Helpers ─────────────────────────────────────────────── */
+
+static trend_query_result_t res;
+static trend_nibp_result_t  nibp_res;
+static trend_alarm_result_t alarm_res;
+
+static void remove_db(void) {
+    unlink(TP_TEST_DB);
+    unlink(TP_TEST_DB "-wal");
+    unlink(TP_TEST_DB "-shm");
+}
+
+/** Single integer result, read with a separate connection. */
+static int count_rows(const char *sql) {
+    sqlite3 *conn = NULL;
+    sqlite3_stmt *st = NULL;
+    int n = -1;
+    if (sqlite3_open(TP_TEST_DB, &conn) == SQLITE_OK &&
+        sqlite3_prepare_v2(conn, sql, -1, &st, NULL) == SQLITE_OK &&
+        sqlite3_step(st) == SQLITE_ROW) {
+        n = sqlite3_column_int(st, 0);
+    }
+    sqlite3_finalize(st);
+    sqlite3_close(conn);
+    return n;
+}
+
+static const uint32_t base = 1700000000u - (1700000000u % 60);
+
+/** HR over the first two minutes (raw: one point per second). */
+static int query_hr(int32_t patient_id, trend_tier_t tier) {
+    return trend_db_query_param_tier(patient_id, TREND_PARAM_HR, base + 1,
+                                     base + 120, TREND_DB_MAX_POINTS, tier,
+                                     &res);
+}
+
+/* ── Test: two slots write to separate partitions ────────── */
+
+static void test_slot_isolation(void) {
+    printf("  test_slot_isolation\n");
+    trend_db_init(":memory:");
+
+    ASSERT_TRUE(trend_db_bind_slot(0, 5));
+    ASSERT_EQ_INT((int)trend_db_slot_patient(0), 5);
+    ASSERT_EQ_INT((int)trend_db_slot_patient(1), (int)TREND_DB_ANON_PATIENT(1));
+
+    for (uint32_t t = 1; t <= 60; t++) {
+        trend_db_insert_sample(0, base + t, 70, 98, 14, 36.8f);
+        trend_db_insert_sample(1, base + t, 120, 91, 24, 38.2f);
+    }
+    trend_db_insert_nibp(0, base + 30, 118, 76, 90);
+    alarm_event_t evt = { .param = ALARM_PARAM_HR, .severity = ALARM_SEV_HIGH };
+    trend_db_insert_alarm(1, base + 40, &evt);
+    trend_db_aggregate_minute(base + 60);
+
+    ASSERT_EQ_INT(query_hr(5, TREND_TIER_RAW), 60);
+    ASSERT_EQ_INT(res.value[0], 70);
+    ASSERT_EQ_INT(query_hr(TREND_DB_ANON_PATIENT(1), TREND_TIER_RAW), 60);
+    ASSERT_EQ_INT(res.value[0], 120);
+
+    /* Each slot's minute aggregate lands in its own partition */
+    ASSERT_EQ_INT(query_hr(5, TREND_TIER_1MIN), 1);
+    ASSERT_EQ_INT(res.value[0], 70);
+    ASSERT_EQ_INT(query_hr(TREND_DB_ANON_PATIENT(1), TREND_TIER_1MIN), 1);
+    ASSERT_EQ_INT(res.value[0], 120);
+
+    ASSERT_EQ_INT(trend_db_query_nibp(5, base, base + 60, &nibp_res), 1);
+    ASSERT_EQ_INT(trend_db_query_nibp(TREND_DB_ANON_PATIENT(1), base,
+                                      base + 60, &nibp_res), 0);
+    ASSERT_EQ_INT(trend_db_query_alarms(5, base, base + 60, &alarm_res), 0);
+    ASSERT_EQ_INT(trend_db_query_alarms(TREND_DB_ANON_PATIENT(1), base,
+                                        base + 60, &alarm_res), 1);
+
+    /* Nothing reached the unbound slot-0 partition */
+    ASSERT_EQ_INT(query_hr(TREND_DB_ANON_PATIENT(0), TREND_TIER_RAW), 0);
+
+    /* Binding a patient to the other slot moves them off the first */
+    ASSERT_TRUE(trend_db_bind_slot(1, 5));
+    ASSERT_EQ_INT((int)trend_db_slot_patient(0), (int)TREND_DB_ANON_PATIENT(0));
+    ASSERT_EQ_INT((int)trend_db_slot_patient(1), 5);
+
+    trend_db_close();
+}
+
+/* ── Test: archive on discharge, then re-admit ───────────── */
+
+static void test_archive_and_readmit(void) {
+    printf("  test_archive_and_readmit\n");
+    remove_db();
+    trend_db_init(TP_TEST_DB);
+
+    ASSERT_TRUE(trend_db_bind_slot(0, 7));
+    for (uint32_t t = 1; t <= 90; t++) {
+        trend_db_insert_sample(0, base + t, 65, 97, 13, 36.6f);
+    }
+    ASSERT_TRUE(trend_db_archive_patient(7));
+    ASSERT_EQ_INT((int)trend_db_slot_patient(0), (int)TREND_DB_ANON_PATIENT(0));
+    ASSERT_EQ_INT(count_rows("SELECT archived FROM trend_partitions "
+                             "WHERE patient_id = 7"), 1);
+
+    /* The next admission starts with an empty history */
+    ASSERT_TRUE(trend_db_bind_slot(0, 8));
+    trend_db_insert_sample(0, base + 100, 99, 96, 18, 37.1f);
+    ASSERT_EQ_INT(query_hr(8, TREND_TIER_RAW), 1);
+    ASSERT_EQ_INT(res.value[0], 99);
+
+    /* The archived partition stays queryable, buffered minute included */
+    ASSERT_EQ_INT(query_hr(7, TREND_TIER_RAW), 90);
+    ASSERT_EQ_INT(res.value[89], 65);
+
+    /* Once retention empties it, the archived partition is forgotten */
+    trend_db_purge_old(base + 4u * 86400u);
+    ASSERT_EQ_INT(query_hr(7, TREND_TIER_RAW), 0);
+    ASSERT_EQ_INT(count_rows("SELECT COUNT(*) FROM trend_partitions "
+                             "WHERE patient_id = 7"), 0);
+    ASSERT_EQ_INT(count_rows("SELECT COUNT(*) FROM trend_partitions "
+                             "WHERE patient_id = 8"), 1);
+
+    trend_db_close();
+    remove_db();
+}
+
+/* ── Test: drop removes the partition from every table ───── */
+
+static void test_drop_patient(void) {
+    printf("  test_drop_patient\n");
+    remove_db();
+    trend_db_init(TP_TEST_DB);
+
+    ASSERT_TRUE(trend_db_bind_slot(0, 9));
+    ASSERT_TRUE(trend_db_bind_slot(1, 10));
+    for (uint32_t t = 1; t <= 60; t++) {
+        trend_db_insert_sample(0, base + t, 80, 95, 16, 37.0f);
+        trend_db_insert_sample(1, base + t, 60, 99, 12, 36.4f);
+    }
+    trend_db_insert_nibp(0, base + 10, 130, 85, 100);
+    alarm_event_t evt = { .param = ALARM_PARAM_SPO2,
+                          .severity = ALARM_SEV_MEDIUM };
+    trend_db_insert_alarm(0, base + 20, &evt);
+    trend_db_aggregate_minute(base + 60);
+
+    ASSERT_TRUE(trend_db_drop_patient(9));
+    ASSERT_FALSE(trend_db_drop_patient(0));
+    ASSERT_EQ_INT((int)trend_db_slot_patient(0), (int)TREND_DB_ANON_PATIENT(0));
+
+    ASSERT_EQ_INT(query_hr(9, TREND_TIER_RAW), 0);
+    ASSERT_EQ_INT(query_hr(9, TREND_TIER_1MIN), 0);
+    ASSERT_EQ_INT(trend_db_query_nibp(9, base, base + 60, &nibp_res), 0);
+    ASSERT_EQ_INT(trend_db_query_alarms(9, base, base + 60, &alarm_res), 0);
+
+    /* The other slot's patient is untouched */
+    ASSERT_EQ_INT(query_hr(10, TREND_TIER_RAW), 60);
+    ASSERT_EQ_INT(query_hr(10, TREND_TIER_1MIN), 1);
+
+    trend_db_close();
+    ASSERT_EQ_INT(count_rows("SELECT COUNT(*) FROM vitals_raw_min "
+                             "WHERE patient_id = 9"), 0);
+    ASSERT_EQ_INT(count_rows("SELECT COUNT(*) FROM trend_partitions "
+                             "WHERE patient_id = 9"), 0);
+    remove_db();
+}
+
+/* ── Test: unpartitioned tables are adopted into partition 0 ─ */
+
+static void test_unpartitioned_upgrade(void) {
+    printf("  test_unpartitioned_upgrade\n");
+    remove_db();
+
+    sqlite3 *conn = NULL;
+    ASSERT_EQ_INT(sqlite3_open(TP_TEST_DB, &conn), SQLITE_OK);
+    sqlite3_exec(conn,
+        "CREATE TABLE vitals_1min (minute_ts INTEGER PRIMARY KEY,"
+        " hr_avg INTEGER, hr_min INTEGER, hr_max INTEGER,"
+        " spo2_avg INTEGER, spo2_min INTEGER, spo2_max INTEGER,"
+        " rr_avg INTEGER, rr_min INTEGER, rr_max INTEGER,"
+        " temp_avg_x10 INTEGER, temp_min_x10 INTEGER, temp_max_x10 INTEGER);"
+        "CREATE TABLE nibp_measurements (timestamp_s INTEGER PRIMARY KEY,"
+        " sys INTEGER NOT NULL, dia INTEGER NOT NULL,"
+        " map_val INTEGER NOT NULL);"
+        "CREATE TABLE alarm_events (id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        " timestamp_s INTEGER NOT NULL, severity INTEGER NOT NULL,"
+        " message TEXT NOT NULL);",
+        NULL, NULL, NULL);
+    char sql[160];
+    for (uint32_t m = 1; m <= 3; m++) {
+        snprintf(sql, sizeof(sql),
+                 "INSERT INTO vitals_1min VALUES (%u, %u, 60, 90,"
+                 " 97, 95, 99, 15, 12, 18, 368, 365, 371);",
+                 (unsigned)(base + m * 60), (unsigned)(70 + m));
+        sqlite3_exec(conn, sql, NULL, NULL, NULL);
+    }
+    snprintf(sql, sizeof(sql),
+             "INSERT INTO nibp_measurements VALUES (%u, 121, 79, 93);",
+             (unsigned)(base + 90));
+    sqlite3_exec(conn, sql, NULL, NULL, NULL);
+    snprintf(sql, sizeof(sql),
+             "INSERT INTO alarm_events (timestamp_s, severity, message)"
+             " VALUES (%u, 2, 'SpO2 Low');", (unsigned)(base + 100));
+    sqlite3_exec(conn, sql, NULL, NULL, NULL);
+    sqlite3_close(conn);
+
+    ASSERT_TRUE(trend_db_init(TP_TEST_DB));
+    int n = trend_db_query_param_tier(TREND_DB_ANON_PATIENT(0), TREND_PARAM_HR,
+                                      base, base + 3600, TREND_DB_MAX_POINTS,
+                                      TREND_TIER_1MIN, &res);
+    ASSERT_EQ_INT(n, 3);
+    ASSERT_EQ_INT(res.value[0], 71);
+    ASSERT_EQ_INT(res.value[2], 73);
+    ASSERT_EQ_INT(trend_db_query_nibp(TREND_DB_ANON_PATIENT(0), base,
+                                      base + 3600, &nibp_res), 1);
+    ASSERT_EQ_INT(nibp_res.sys[0], 121);
+    ASSERT_EQ_INT(trend_db_query_alarms(TREND_DB_ANON_PATIENT(0), base,
+                                        base + 3600, &alarm_res), 1);
+    ASSERT_EQ_INT(alarm_res.param[0], ALARM_PARAM_SPO2);
+    ASSERT_EQ_INT(alarm_res.severity[0], ALARM_SEV_MEDIUM);
+    trend_db_close();
+
+    ASSERT_EQ_INT(count_rows("SELECT COUNT(*) FROM sqlite_master "
+                             "WHERE name LIKE '%_unpartitioned'"), 0);
+    remove_db();
+}
+
+/* ── Public entry point ──────────────────────────────────── */
+
+void test_trend_partition_integration(void) {
+    test_slot_isolation();
+    test_archive_and_readmit();
+    test_drop_patient();
+    test_unpartitioned_upgrade();
+}
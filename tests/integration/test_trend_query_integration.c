@@ -0,0 +1,230 @@
+/**
+ * @file test_trend_query_integration.c
+ * @brief Integration tests: trend_query + job_pool + trend_db
+ *
+ * Verifies that trend queries run on the worker pool against the
+ * read-only connection, deliver COARSE then FULL results for progressive
+ * requests, that superseded or cancelled requests never call back, and
+ * that LTTB downsampling keeps a spike that bucket averaging flattens.
+ *
+ * Uses a file database (WAL needs one for the reader connection).
+ */
+
+#include "test_framework.h"
+#include "trend_query.h"
+#include "job_pool.h"
+#include <unistd.h>
+
+#define TQ_TEST_DB  "/tmp/test_trend_query.db"
+
+/* ── Test fixtures ───────────────────────────────────────── */
+
+typedef struct {
+    int           calls;
+    trend_stage_t stages[4];
+    int           hr_count[4];
+    uint32_t      hr_bucket[4];
+    int           nibp_count[4];
+} cb_log_t;
+
+static cb_log_t log_a;
+static cb_log_t log_b;
+
+static void record_cb(const trend_query_set_t *set, void *user_data) {
+    cb_log_t *log = (cb_log_t *)user_data;
+    if (log->calls < 4) {
+        log->stages[log->calls]     = set->stage;
+        log->hr_count[log->calls]   = set->param[TREND_PARAM_HR].count;
+        log->hr_bucket[log->calls]  = set->param[TREND_PARAM_HR].bucket_s;
+        log->nibp_count[log->calls] = set->nibp.count;
+    }
+    log->calls++;
+}
+
+/** Dispatch completions until no request is busy or ~2 s elapsed. */
+static bool wait_idle(void) {
+    for (int i = 0; i < 2000; i++) {
+        job_pool_dispatch_completions();
+        if (!trend_query_busy()) return true;
+        usleep(1000);
+    }
+    return false;
+}
+
+/** Ten minutes of 1 Hz samples starting on a minute boundary, aggregated. */
+static uint32_t seed_ten_minutes(void) {
+    uint32_t base = 1700000000u - (1700000000u % 60);
+    for (uint32_t t = 0; t < 600; t++) {
+        trend_db_insert_sample(0, base + t, 70 + (int)(t % 10), 97, 16, 37.0f);
+    }
+    for (uint32_t m = 1; m <= 10; m++) {
+        trend_db_aggregate_minute(base + m * 60);
+    }
+    trend_db_insert_nibp(0, base + 120, 120, 80, 93);
+    return base;
+}
+
+static void setup(void) {
+    unlink(TQ_TEST_DB);
+    unlink(TQ_TEST_DB "-wal");
+    unlink(TQ_TEST_DB "-shm");
+    log_a.calls = 0;
+    log_b.calls = 0;
+    trend_db_init(TQ_TEST_DB);
+    job_pool_init(0);
+}
+
+static void teardown(void) {
+    job_pool_deinit();
+    trend_db_close();
+    unlink(TQ_TEST_DB);
+    unlink(TQ_TEST_DB "-wal");
+    unlink(TQ_TEST_DB "-shm");
+}
+
+/* ── Test: progressive request delivers COARSE then FULL ───── */
+
+static void test_progressive_stages(void) {
+    printf("  test_progressive_stages\n");
+    setup();
+
+    uint32_t base = seed_ten_minutes();
+    uint32_t ticket = trend_query_request(base, base + 600, 300,
+                                          TREND_TIER_AUTO, true,
+                                          record_cb, &log_a);
+    ASSERT_GT_INT((int)ticket, 0);
+    ASSERT_TRUE(wait_idle());
+
+    ASSERT_EQ_INT(log_a.calls, 2);
+    ASSERT_EQ_INT(log_a.stages[0], TREND_STAGE_COARSE);
+    ASSERT_EQ_INT(log_a.stages[1], TREND_STAGE_FULL);
+
+    /* Coarse stage reads the 1-min tier, full buckets raw samples */
+    ASSERT_EQ_INT(log_a.hr_count[0], 10);
+    ASSERT_EQ_INT((int)log_a.hr_bucket[0], 60);
+    ASSERT_EQ_INT(log_a.hr_count[1], 300);
+    ASSERT_EQ_INT((int)log_a.hr_bucket[1], 2);
+
+    /* NIBP fetched once, in the first stage */
+    ASSERT_EQ_INT(log_a.nibp_count[0], 1);
+
+    teardown();
+}
+
+/* ── Test: non-progressive request delivers FULL only ──────── */
+
+static void test_full_only(void) {
+    printf("  test_full_only\n");
+    setup();
+
+    uint32_t base = seed_ten_minutes();
+    trend_query_request(base, base + 600, 100, TREND_TIER_AUTO, false,
+                        record_cb, &log_a);
+    ASSERT_TRUE(wait_idle());
+
+    ASSERT_EQ_INT(log_a.calls, 1);
+    ASSERT_EQ_INT(log_a.stages[0], TREND_STAGE_FULL);
+    ASSERT_GT_INT(log_a.hr_count[0], 0);
+    ASSERT_TRUE(log_a.hr_count[0] <= 100);
+    ASSERT_EQ_INT(log_a.nibp_count[0], 1);
+
+    teardown();
+}
+
+/* ── Test: a newer request supersedes the one in flight ───── */
+
+static void test_superseded_request(void) {
+    printf("  test_superseded_request\n");
+    setup();
+
+    uint32_t base = seed_ten_minutes();
+    uint32_t t1 = trend_query_request(base, base + 600, 300,
+                                      TREND_TIER_AUTO, true,
+                                      record_cb, &log_a);
+    uint32_t t2 = trend_query_request(base, base + 600, 300,
+                                      TREND_TIER_AUTO, false,
+                                      record_cb, &log_b);
+    ASSERT_TRUE(t2 != t1);
+    ASSERT_TRUE(wait_idle());
+
+    ASSERT_EQ_INT(log_a.calls, 0);
+    ASSERT_EQ_INT(log_b.calls, 1);
+    ASSERT_EQ_INT(log_b.stages[0], TREND_STAGE_FULL);
+    ASSERT_EQ_INT(log_b.hr_count[0], 300);
+
+    teardown();
+}
+
+/* ── Test: cancel suppresses all callbacks ─────────────────── */
+
+static void test_cancel(void) {
+    printf("  test_cancel\n");
+    setup();
+
+    uint32_t base = seed_ten_minutes();
+    trend_query_request(base, base + 600, 300, TREND_TIER_AUTO, true,
+                        record_cb, &log_a);
+    trend_query_cancel();
+    ASSERT_TRUE(wait_idle());
+
+    ASSERT_EQ_INT(log_a.calls, 0);
+    ASSERT_FALSE(trend_query_busy());
+
+    teardown();
+}
+
+/* ── Test: LTTB parameter keeps a spike the average hides ── */
+
+static void test_lttb_keeps_spike(void) {
+    printf("  test_lttb_keeps_spike\n");
+    setup();
+
+    uint32_t base = 1700000000u - (1700000000u % 60);
+    for (uint32_t t = 0; t < 3600; t++) {
+        int hr = (t >= 1800 && t < 1803) ? 160 : 72;
+        trend_db_insert_sample(0, base + t, hr, 97, 16, 37.0f);
+    }
+
+    static trend_query_result_t avg, lttb;
+    trend_db_query_param_tier(0, TREND_PARAM_HR, base, base + 3600, 120,
+                              TREND_TIER_AUTO, &avg);
+    trend_db_query_param_lttb(0, TREND_PARAM_HR, base, base + 3600, 120,
+                              TREND_TIER_AUTO, &lttb);
+
+    int avg_peak = 0, lttb_peak = 0;
+    uint32_t lttb_peak_ts = 0;
+    for (int i = 0; i < avg.count; i++) {
+        if (avg.value[i] > avg_peak) avg_peak = avg.value[i];
+    }
+    for (int i = 0; i < lttb.count; i++) {
+        if (lttb.value[i] > lttb_peak) {
+            lttb_peak = lttb.value[i];
+            lttb_peak_ts = lttb.timestamp_s[i];
+        }
+    }
+    ASSERT_TRUE(lttb.count <= 120);
+    ASSERT_TRUE(avg_peak < 160);
+    ASSERT_EQ_INT(lttb_peak, 160);
+    ASSERT_TRUE(lttb_peak_ts >= base + 1800 && lttb_peak_ts < base + 1803);
+
+    /* Per-parameter mode is carried through trend_query */
+    trend_query_set_downsample(TREND_PARAM_HR, TREND_DS_LTTB);
+    trend_query_request(base, base + 3600, 120, TREND_TIER_AUTO, false,
+                        record_cb, &log_a);
+    ASSERT_TRUE(wait_idle());
+    ASSERT_EQ_INT(log_a.calls, 1);
+    ASSERT_EQ_INT(log_a.hr_count[0], lttb.count);
+    trend_query_set_downsample(TREND_PARAM_HR, TREND_DS_AVG);
+
+    teardown();
+}
+
+/* ── Public entry point ──────────────────────────────────── */
+
+void test_trend_query_integration(void) {
+    test_progressive_stages();
+    test_full_only();
+    test_superseded_request();
+    test_cancel();
+    test_lttb_keeps_spike();
+}
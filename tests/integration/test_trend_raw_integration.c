@@ -0,0 +1,173 @@
+/**
+ * @file test_trend_raw_integration.c
+ * @brief Integration tests: trend_raw_pack + trend_db
+ *
+ * Verifies that packed per-minute raw rows decode transparently in
+ * queries (including the unflushed current minute), that minute
+ * aggregation reads the blobs, that a partial minute survives close,
+ * and that a per-second vitals_raw table from an older build migrates.
+ */
+
+#include "test_framework.h"
+#include "trend_db.h"
+#include "sqlite3.h"
+#include <unistd.h>
+
+#define TR_TEST_DB  "/tmp/test_trend_raw.db"
+
+/* ── Helpers ─────────────────────────────────────────────── */
+
+static trend_query_result_t res;
+
+static void remove_db(void) {
+    unlink(TR_TEST_DB);
+    unlink(TR_TEST_DB "-wal");
+    unlink(TR_TEST_DB "-shm");
+}
+
+/** Row count of a table, read with a separate connection. */
+static int count_rows(const char *sql) {
+    sqlite3 *conn = NULL;
+    sqlite3_stmt *st = NULL;
+    int n = -1;
+    if (sqlite3_open(TR_TEST_DB, &conn) == SQLITE_OK &&
+        sqlite3_prepare_v2(conn, sql, -1, &st, NULL) == SQLITE_OK &&
+        sqlite3_step(st) == SQLITE_ROW) {
+        n = sqlite3_column_int(st, 0);
+    }
+    sqlite3_finalize(st);
+    sqlite3_close(conn);
+    return n;
+}
+
+static const uint32_t base = 1700000000u - (1700000000u % 60);
+
+/* ── Test: samples round-trip, current minute included ───── */
+
+static void test_raw_roundtrip(void) {
+    printf("  test_raw_roundtrip\n");
+    remove_db();
+    trend_db_init(TR_TEST_DB);
+
+    /* Two full minutes plus 30 s of a third, still buffered */
+    for (uint32_t t = 1; t <= 150; t++) {
+        trend_db_insert_sample(0, base + t, 60 + (int)(t % 50), 97, 14, 36.5f);
+    }
+
+    int n = trend_db_query_param_tier(0, TREND_PARAM_HR, base + 1, base + 150,
+                                      TREND_DB_MAX_POINTS, TREND_TIER_RAW,
+                                      &res);
+    ASSERT_EQ_INT(n, 150);
+    ASSERT_EQ_INT((int)res.bucket_s, 1);
+    ASSERT_EQ_INT((int)res.timestamp_s[0], (int)(base + 1));
+    ASSERT_EQ_INT(res.value[0], 61);
+    ASSERT_EQ_INT((int)res.timestamp_s[149], (int)(base + 150));
+    ASSERT_EQ_INT(res.value[149], 60);
+    ASSERT_EQ_INT(res.value[139], 100);     /* t = 140, unflushed */
+
+    /* Sub-range inside a minute is trimmed to the exact seconds */
+    n = trend_db_query_param_tier(0, TREND_PARAM_TEMP, base + 70, base + 79,
+                                  TREND_DB_MAX_POINTS, TREND_TIER_RAW, &res);
+    ASSERT_EQ_INT(n, 10);
+    ASSERT_EQ_INT(res.value[0], 365);
+
+    /* One row per completed minute */
+    ASSERT_EQ_INT(count_rows("SELECT COUNT(*) FROM vitals_raw_min"), 2);
+
+    /* The partial minute is written on close */
+    trend_db_close();
+    ASSERT_EQ_INT(count_rows("SELECT COUNT(*) FROM vitals_raw_min"), 3);
+
+    trend_db_init(TR_TEST_DB);
+    n = trend_db_query_param_lttb(0, TREND_PARAM_HR, base + 1, base + 150,
+                                  TREND_DB_MAX_POINTS, TREND_TIER_RAW, &res);
+    ASSERT_EQ_INT(n, 150);
+
+    /* A late sample merges into the stored minute */
+    trend_db_insert_sample(0, base + 200, 88, 97, 14, 36.5f);
+    trend_db_insert_sample(0, base + 145, 120, 97, 14, 36.5f);
+    n = trend_db_query_param_tier(0, TREND_PARAM_HR, base + 141, base + 200,
+                                  TREND_DB_MAX_POINTS, TREND_TIER_RAW, &res);
+    ASSERT_EQ_INT(n, 11);
+    ASSERT_EQ_INT(res.value[4], 120);
+    ASSERT_EQ_INT(res.value[10], 88);
+
+    trend_db_close();
+    remove_db();
+}
+
+/* ── Test: minute aggregate computed from the blob ───────── */
+
+static void test_aggregate_from_blob(void) {
+    printf("  test_aggregate_from_blob\n");
+    trend_db_init(":memory:");
+
+    for (uint32_t t = 1; t <= 60; t++) {
+        trend_db_insert_sample(0, base + t, 59 + (int)t, 95, 12, 37.0f);
+    }
+    trend_db_aggregate_minute(base + 60);
+
+    int n = trend_db_query_param_tier(0, TREND_PARAM_HR, base, base + 3600,
+                                      TREND_DB_MAX_POINTS, TREND_TIER_1MIN,
+                                      &res);
+    ASSERT_EQ_INT(n, 1);
+    ASSERT_EQ_INT(res.value[0], 89);        /* 60..119 */
+    ASSERT_EQ_INT(res.value_min[0], 60);
+    ASSERT_EQ_INT(res.value_max[0], 119);
+
+    /* Bucketed raw query sees the same minute */
+    n = trend_db_query_param_tier(0, TREND_PARAM_HR, base + 1, base + 60,
+                                  6, TREND_TIER_RAW, &res);
+    ASSERT_EQ_INT(n, 6);
+    ASSERT_EQ_INT((int)res.bucket_s, 9);
+
+    trend_db_close();
+}
+
+/* ── Test: per-second table from an older build migrates ─── */
+
+static void test_legacy_migration(void) {
+    printf("  test_legacy_migration\n");
+    remove_db();
+
+    sqlite3 *conn = NULL;
+    ASSERT_EQ_INT(sqlite3_open(TR_TEST_DB, &conn), SQLITE_OK);
+    sqlite3_exec(conn,
+        "CREATE TABLE vitals_raw (timestamp_s INTEGER PRIMARY KEY,"
+        " hr INTEGER NOT NULL, spo2 INTEGER NOT NULL,"
+        " rr INTEGER NOT NULL, temp_x10 INTEGER NOT NULL);",
+        NULL, NULL, NULL);
+    sqlite3_stmt *ins = NULL;
+    sqlite3_prepare_v2(conn, "INSERT INTO vitals_raw VALUES (?1, ?2, 98, 16, 368)",
+                       -1, &ins, NULL);
+    for (uint32_t t = 1; t <= 120; t++) {
+        sqlite3_reset(ins);
+        sqlite3_bind_int(ins, 1, (int)(base + t));
+        sqlite3_bind_int(ins, 2, 70 + (int)(t % 7));
+        sqlite3_step(ins);
+    }
+    sqlite3_finalize(ins);
+    sqlite3_close(conn);
+
+    ASSERT_TRUE(trend_db_init(TR_TEST_DB));
+    int n = trend_db_query_param_tier(0, TREND_PARAM_HR, base + 1, base + 120,
+                                      TREND_DB_MAX_POINTS, TREND_TIER_RAW,
+                                      &res);
+    ASSERT_EQ_INT(n, 120);
+    ASSERT_EQ_INT(res.value[6], 70);
+    ASSERT_EQ_INT(res.value[7], 71);
+    trend_db_close();
+
+    ASSERT_EQ_INT(count_rows("SELECT COUNT(*) FROM vitals_raw_min"), 2);
+    ASSERT_EQ_INT(count_rows("SELECT COUNT(*) FROM sqlite_master "
+                             "WHERE name = 'vitals_raw'"), 0);
+    remove_db();
+}
+
+/* ── Public entry point ──────────────────────────────────── */
+
+void test_trend_raw_integration(void) {
+    test_raw_roundtrip();
+    test_aggregate_from_blob();
+    test_legacy_migration();
+}
@@ -0,0 +1,169 @@
+/**
+ * @file test_trend_segment_integration.c
+ * @brief Integration tests: trend_segment + trend_db (bed transfer)
+ *
+ * Verifies that 72 h of a patient's history exported on one monitor and
+ * imported on another answers the same queries, including the unflushed
+ * raw minute, alarm events and NIBP, within the transfer time budget; and
+ * that a damaged segment is refused without touching the database.
+ */
+
+#include "test_framework.h"
+#include "trend_db.h"
+#include "trend_segment.h"
+#include <string.h>
+#include <time.h>
+
+/* ── Helpers ─────────────────────────────────────────────── */
+
+static uint8_t segment[TREND_DB_SEGMENT_MAX_BYTES];
+static trend_query_result_t before, after;
+static trend_nibp_result_t  nibp_res;
+static trend_alarm_result_t alarm_res;
+
+static const uint32_t base = 1700000000u - (1700000000u % 3600);
+#define HISTORY_S  (72u * 3600u)
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+/** 72 h of 1 Hz samples on slot 0, aggregated and purged as in service. */
+static void record_history(int32_t patient_id) {
+    trend_db_bind_slot(0, patient_id);
+    for (uint32_t t = 1; t <= HISTORY_S + 30; t++) {
+        trend_db_insert_sample(0, base + t, 60 + (int)((t / 97) % 40),
+                               95 + (int)((t / 601) % 5), 14, 36.9f);
+        if (t % 60 == 0) trend_db_aggregate_minute(base + t);
+        if (t % 1800 == 0) {
+            trend_db_insert_nibp(0, base + t, 120, 80, 93);
+        }
+    }
+    alarm_event_t evt = {
+        .param = ALARM_PARAM_HR, .severity = ALARM_SEV_HIGH,
+        .kind = ALARM_EVT_ONSET, .value = 131, .threshold = 130,
+        .has_reading = true,
+    };
+    trend_db_insert_alarm(0, base + 5000, &evt);
+    evt.kind = ALARM_EVT_ACK;
+    evt.user_id = 42;
+    trend_db_insert_alarm(0, base + 5005, &evt);
+    evt.kind = ALARM_EVT_CLEAR;
+    evt.duration_s = 4000;
+    trend_db_insert_alarm(0, base + 9000, &evt);
+    trend_db_purge_old(base + HISTORY_S);
+}
+
+static bool same_result(const trend_query_result_t *a,
+                        const trend_query_result_t *b) {
+    if (a->count != b->count) return false;
+    for (int i = 0; i < a->count; i++) {
+        if (a->timestamp_s[i] != b->timestamp_s[i] ||
+            a->value[i] != b->value[i] ||
+            a->value_min[i] != b->value_min[i] ||
+            a->value_max[i] != b->value_max[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* ── Test: 72 h history moves to another monitor ─────────── */
+
+static void test_transfer_roundtrip(void) {
+    printf("  test_transfer_roundtrip\n");
+    trend_db_init(":memory:");
+    record_history(11);
+
+    uint32_t end = base + HISTORY_S + 30;
+    trend_db_query_param_tier(11, TREND_PARAM_HR, base, end,
+                              TREND_DB_MAX_POINTS, TREND_TIER_1MIN, &before);
+    ASSERT_GT_INT(before.count, 0);
+
+    double t0 = now_ms();
+    size_t len = trend_db_export_patient(11, segment, sizeof(segment));
+    double t_export = now_ms() - t0;
+    ASSERT_GT_INT((int)len, TREND_SEG_HEADER_BYTES);
+    trend_db_close();
+
+    /* Receiving monitor: the patient has a different local id */
+    trend_db_init(":memory:");
+    t0 = now_ms();
+    ASSERT_TRUE(trend_db_import_patient(4, segment, len));
+    double t_import = now_ms() - t0;
+    printf("    %zu bytes, export %.1f ms, import %.1f ms\n",
+           len, t_export, t_import);
+    ASSERT_TRUE(t_export + t_import < 1000.0);
+
+    trend_db_query_param_tier(4, TREND_PARAM_HR, base, end,
+                              TREND_DB_MAX_POINTS, TREND_TIER_1MIN, &after);
+    ASSERT_TRUE(same_result(&before, &after));
+    ASSERT_GT_INT(trend_db_query_param_tier(4, TREND_PARAM_SPO2, base, end, 72,
+                                            TREND_TIER_1HOUR, &after), 70);
+
+    /* Last raw seconds, including the minute that was still buffered */
+    int n = trend_db_query_param_tier(4, TREND_PARAM_HR, end - 89, end,
+                                      TREND_DB_MAX_POINTS, TREND_TIER_RAW,
+                                      &after);
+    ASSERT_EQ_INT(n, 90);
+    ASSERT_EQ_INT((int)after.timestamp_s[89], (int)end);
+    ASSERT_EQ_INT(after.value[89], 60 + (int)(((end - base) / 97) % 40));
+
+    ASSERT_EQ_INT(trend_db_query_nibp(4, base, end, &nibp_res), 144);
+    ASSERT_EQ_INT(trend_db_query_alarms(4, base, end, &alarm_res), 3);
+    alarm_event_t evt;
+    trend_db_alarm_event(&alarm_res, 0, &evt);
+    ASSERT_EQ_INT(evt.param, ALARM_PARAM_HR);
+    ASSERT_EQ_INT(evt.value, 131);
+    ASSERT_EQ_INT(evt.threshold, 130);
+    trend_db_alarm_event(&alarm_res, 1, &evt);
+    ASSERT_EQ_INT(evt.kind, ALARM_EVT_ACK);
+    ASSERT_EQ_INT(evt.user_id, 42);
+    trend_db_alarm_event(&alarm_res, 2, &evt);
+    ASSERT_EQ_INT(evt.kind, ALARM_EVT_CLEAR);
+    ASSERT_EQ_INT((int)evt.duration_s, 4000);
+
+    trend_db_close();
+}
+
+/* ── Test: a damaged segment changes nothing ─────────────── */
+
+static void test_reject_damaged(void) {
+    printf("  test_reject_damaged\n");
+    trend_db_init(":memory:");
+    trend_db_bind_slot(0, 21);
+    for (uint32_t t = 1; t <= 120; t++) {
+        trend_db_insert_sample(0, base + t, 75, 98, 15, 37.0f);
+    }
+    trend_db_aggregate_minute(base + 60);
+    trend_db_aggregate_minute(base + 120);
+    size_t len = trend_db_export_patient(21, segment, sizeof(segment));
+    ASSERT_GT_INT((int)len, 0);
+
+    /* Too small a buffer is reported, not truncated */
+    ASSERT_EQ_INT((int)trend_db_export_patient(21, segment, 64), 0);
+    len = trend_db_export_patient(21, segment, sizeof(segment));
+
+    segment[len / 2] ^= 0x40;
+    ASSERT_FALSE(trend_db_import_patient(22, segment, len));
+    ASSERT_EQ_INT(trend_db_query_param_tier(22, TREND_PARAM_HR, base,
+                                            base + 3600, 60, TREND_TIER_1MIN,
+                                            &after), 0);
+    segment[len / 2] ^= 0x40;
+    ASSERT_FALSE(trend_db_import_patient(0, segment, len));
+    ASSERT_TRUE(trend_db_import_patient(22, segment, len));
+    ASSERT_EQ_INT(trend_db_query_param_tier(22, TREND_PARAM_HR, base,
+                                            base + 3600, 60, TREND_TIER_1MIN,
+                                            &after), 2);
+
+    trend_db_close();
+}
+
+/* ── Public entry point ──────────────────────────────────── */
+
+void test_trend_segment_integration(void) {
+    test_transfer_roundtrip();
+    test_reject_damaged();
+}
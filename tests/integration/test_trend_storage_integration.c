@@ -0,0 +1,187 @@
+/**
+ * @file test_trend_storage_integration.c
+ * @brief Integration tests: trend_db storage bounds
+ *
+ * Verifies that new and older database files end up with incremental
+ * auto_vacuum, that purged pages are returned to the filesystem by
+ * trend_db_vacuum_step() / trend_db_maintain(), and that the size cap
+ * purges the oldest history early without touching the last
+ * TREND_DB_MIN_RETAIN_S.
+ */
+
+#include "test_framework.h"
+#include "trend_db.h"
+#include "db_schema.h"
+#include "sqlite3.h"
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define ST_TEST_DB   "/tmp/test_trend_storage.db"
+
+/* ── Helpers ─────────────────────────────────────────────── */
+
+static const uint32_t base = 1700000000u - (1700000000u % 3600);
+static uint32_t last_ts;
+
+static void remove_db(void) {
+    unlink(ST_TEST_DB);
+    unlink(ST_TEST_DB "-wal");
+    unlink(ST_TEST_DB "-shm");
+}
+
+/** One integer from a fresh connection to the test file. */
+static int query_int(const char *sql) {
+    sqlite3 *c = NULL;
+    sqlite3_stmt *st = NULL;
+    int v = -1;
+    if (sqlite3_open(ST_TEST_DB, &c) == SQLITE_OK &&
+        sqlite3_prepare_v2(c, sql, -1, &st, NULL) == SQLITE_OK &&
+        sqlite3_step(st) == SQLITE_ROW) {
+        v = sqlite3_column_int(st, 0);
+    }
+    sqlite3_finalize(st);
+    sqlite3_close(c);
+    return v;
+}
+
+/** `hours` of samples after last_ts, every `step` seconds. */
+static void record_hours(int hours, uint32_t step) {
+    uint32_t from = last_ts;
+    for (uint32_t t = step; t <= (uint32_t)hours * 3600; t += step) {
+        last_ts = from + t;
+        trend_db_insert_sample(0, last_ts, 60 + t % 40, 95 + t % 5, 14, 36.7f);
+        if (last_ts % 60 == 0) trend_db_aggregate_minute(last_ts);
+    }
+}
+
+static int minutes_from(uint32_t ts) {
+    char sql[96];
+    snprintf(sql, sizeof(sql),
+             "SELECT COUNT(*) FROM vitals_1min WHERE minute_ts >= %u",
+             (unsigned)ts);
+    return query_int(sql);
+}
+
+/* ── Test: auto_vacuum on new and older files ────────────── */
+
+static void test_auto_vacuum_mode(void) {
+    printf("  test_auto_vacuum_mode\n");
+    remove_db();
+    ASSERT_TRUE(trend_db_init(ST_TEST_DB));
+    trend_db_close();
+    ASSERT_EQ_INT(query_int("PRAGMA auto_vacuum"), 2);
+
+    /* A file from an older build, created without auto_vacuum */
+    remove_db();
+    sqlite3 *c = NULL;
+    sqlite3_open(ST_TEST_DB, &c);
+    sqlite3_exec(c, "PRAGMA journal_mode=WAL;"
+                    "CREATE TABLE users (id INTEGER PRIMARY KEY, name TEXT);"
+                    "INSERT INTO users (name) VALUES ('a'), ('b'), ('c');",
+                 NULL, NULL, NULL);
+    sqlite3_close(c);
+    ASSERT_EQ_INT(query_int("PRAGMA auto_vacuum"), 0);
+
+    ASSERT_TRUE(trend_db_init(ST_TEST_DB));
+    trend_db_close();
+    ASSERT_EQ_INT(query_int("PRAGMA auto_vacuum"), 2);
+    ASSERT_EQ_INT(query_int("SELECT COUNT(*) FROM users"), 3);
+
+    /* Converted and stamped: the next init skips schema and upgrades */
+    ASSERT_EQ_INT(query_int("PRAGMA user_version"),
+                  (DB_SCHEMA_VERSION << 16) | DB_SCHEMA_TREND);
+    ASSERT_TRUE(trend_db_init(ST_TEST_DB));
+    trend_db_insert_nibp(0, base, 120, 80, 93);
+    trend_db_close();
+    ASSERT_EQ_INT(query_int("SELECT COUNT(*) FROM nibp_measurements"), 1);
+}
+
+/* ── Test: purged pages leave the file ───────────────────── */
+
+static void test_vacuum_after_purge(void) {
+    printf("  test_vacuum_after_purge\n");
+    remove_db();
+    trend_db_init(ST_TEST_DB);
+    last_ts = base;
+    record_hours(10, 1);
+
+    trend_db_storage_t before, mid, after;
+    ASSERT_TRUE(trend_db_get_storage(&before));
+    ASSERT_GT_INT((int)before.page_count, 20);
+    ASSERT_EQ_INT((int)before.used_bytes,
+                  (int)((before.page_count - before.freelist_count) *
+                        before.page_size));
+
+    /* Drop all raw minutes and the first five hours of aggregates */
+    trend_db_purge_old(base + 5 * 3600 + 72 * 3600);
+    ASSERT_TRUE(trend_db_get_storage(&mid));
+    ASSERT_GT_INT((int)mid.freelist_count, 16);
+    ASSERT_TRUE(mid.used_bytes < before.used_bytes);
+
+    ASSERT_EQ_INT(trend_db_vacuum_step(8), 8);
+    trend_db_maintain(base + 5 * 3600 + 72 * 3600);
+    ASSERT_TRUE(trend_db_get_storage(&after));
+    ASSERT_EQ_INT((int)after.freelist_count, 0);
+    ASSERT_TRUE(after.page_count < before.page_count);
+
+    /* Checkpointed: the main file holds exactly the pages in use */
+    struct stat st;
+    ASSERT_EQ_INT(stat(ST_TEST_DB, &st), 0);
+    ASSERT_EQ_INT((int)st.st_size,
+                  (int)(after.page_count * after.page_size));
+    trend_db_close();
+}
+
+/* ── Test: size cap purges the oldest history early ──────── */
+
+static void test_size_cap(void) {
+    printf("  test_size_cap\n");
+    remove_db();
+    trend_db_init(ST_TEST_DB);
+
+    /* 40 h of minute samples, then an hour at 1 Hz */
+    last_ts = base;
+    record_hours(40, 60);
+    record_hours(1, 1);
+
+    /* Within the cap: maintenance keeps all 72 h retention */
+    trend_db_maintain(last_ts);
+    ASSERT_EQ_INT(minutes_from(0), 41 * 60);
+
+    /* Eight pages over the cap */
+    trend_db_storage_t st;
+    trend_db_get_storage(&st);
+    uint64_t cap = st.used_bytes - 8 * st.page_size;
+    trend_db_set_size_cap(cap);
+    trend_db_maintain(last_ts);
+
+    trend_db_storage_t capped;
+    trend_db_get_storage(&capped);
+    ASSERT_TRUE(capped.used_bytes <= cap);
+    int kept = minutes_from(0);
+    ASSERT_TRUE(kept < 41 * 60 && kept > TREND_DB_MIN_RETAIN_S / 60);
+    /* Whole hours from the oldest end, newest data untouched */
+    ASSERT_EQ_INT(kept % 60, 1);
+    ASSERT_EQ_INT(minutes_from(last_ts - 3600 + 60), 60);
+
+    /* An impossible cap still keeps the minimum retention */
+    int floor_rows = minutes_from(last_ts - TREND_DB_MIN_RETAIN_S);
+    trend_db_set_size_cap(1);
+    trend_db_maintain(last_ts);
+    ASSERT_EQ_INT(minutes_from(0), floor_rows);
+    ASSERT_EQ_INT(floor_rows, TREND_DB_MIN_RETAIN_S / 60 + 1);
+
+    trend_db_set_size_cap(0);
+    trend_db_close();
+}
+
+/* ── Public entry point ──────────────────────────────────── */
+
+void test_trend_storage_integration(void) {
+    test_auto_vacuum_mode();
+    test_vacuum_after_purge();
+    test_size_cap();
+    remove_db();
+}
@@ -0,0 +1,459 @@
+/**
+ * @file test_trend_viewport_integration.c
+ * @brief Integration tests: trend_viewport + trend_query + trend_db
+ *
+ * Tests window clamping and live following, anchored zoom and settling
+ * on zoom levels, tier choice per tile, fetch order (window, then
+ * neighbours, then periodic refresh of the newest tile), and rendering
+ * from held tiles: panning shifts samples without a fetch, a full tile
+ * replaces its preview, and an older zoom level fills in until the new
+ * tiles arrive.  Finally the fetch loop runs against a real database
+ * through trend_query, and a pan onto a prefetched tile needs no query.
+ */
+
+#include "test_framework.h"
+#include "trend_viewport.h"
+#include "job_pool.h"
+#include <string.h>
+#include <unistd.h>
+
+#define NONE        INT32_MAX
+#define PTS         TREND_VIEWPORT_POINTS
+#define TV_TEST_DB  "/tmp/test_trend_viewport.db"
+
+static trend_query_set_t set;
+static int32_t y[PTS];
+
+/* Whole hours, so tiles of every zoom level line up with it */
+static const uint32_t now = 1700002800u;
+
+/* ── Helpers ─────────────────────────────────────────────── */
+
+/** Result for [start, end): HR `value` at every `step_s`, avg buckets. */
+static const trend_query_set_t *make_set(uint32_t start, uint32_t end,
+                                         trend_stage_t stage,
+                                         uint32_t step_s, int32_t value) {
+    memset(&set, 0, sizeof(set));
+    set.start_ts = start;
+    set.end_ts   = end;
+    set.stage    = stage;
+    trend_query_result_t *r = &set.param[TREND_PARAM_HR];
+    r->bucket_s = step_s;
+    for (uint32_t t = start; t < end && r->count < TREND_DB_MAX_POINTS;
+         t += step_s) {
+        r->timestamp_s[r->count] = t;
+        r->value[r->count++] = value;
+    }
+    return &set;
+}
+
+static int count_value(int32_t v) {
+    int n = 0;
+    for (int i = 0; i < PTS; i++) n += (y[i] == v);
+    return n;
+}
+
+/** Fresh state: new patient drops every tile; live 1 h window. */
+static void fresh(void) {
+    trend_viewport_set_patient(-99);
+    trend_viewport_set_patient(0);
+    trend_viewport_reset(TREND_RANGE_1H, now);
+}
+
+/* ── Test: window clamping and live mode ─────────────────── */
+
+static void test_window(void) {
+    printf("  test_window\n");
+    fresh();
+    uint32_t s, e;
+    trend_viewport_get_window(&s, &e);
+    ASSERT_TRUE(e == now && s == now - 3600);
+    ASSERT_TRUE(trend_viewport_is_live());
+
+    /* Live window follows the clock */
+    trend_viewport_set_now(now + 60);
+    trend_viewport_get_window(&s, &e);
+    ASSERT_TRUE(e == now + 60);
+
+    /* Panning back leaves live mode; the clock no longer moves it */
+    trend_viewport_pan(-600);
+    ASSERT_FALSE(trend_viewport_is_live());
+    trend_viewport_set_now(now + 120);
+    trend_viewport_get_window(&s, &e);
+    ASSERT_TRUE(e == now + 60 - 600);
+
+    /* Cannot pan past now; reaching it rejoins live */
+    trend_viewport_pan(100000);
+    trend_viewport_get_window(&s, &e);
+    ASSERT_TRUE(e == now + 120);
+    ASSERT_TRUE(trend_viewport_is_live());
+
+    /* Cannot pan past 72 h of history */
+    trend_viewport_pan(-(int32_t)(100 * 3600));
+    trend_viewport_get_window(&s, &e);
+    ASSERT_TRUE(s == now + 120 - TREND_VIEWPORT_MAX_SPAN_S);
+
+    /* Clock near zero (fresh simulator): window starts at 0 */
+    trend_viewport_reset(TREND_RANGE_1H, 100);
+    trend_viewport_get_window(&s, &e);
+    ASSERT_TRUE(s == 0 && e == 3600);
+}
+
+/* ── Test: anchored zoom and settling ────────────────────── */
+
+static void test_zoom(void) {
+    printf("  test_zoom\n");
+    fresh();
+    trend_viewport_pan(-7200);              /* [now-3h, now-2h] */
+    uint32_t s, e;
+    uint32_t anchor = now - 3 * 3600 + 900; /* A quarter in */
+
+    trend_viewport_zoom(1800, anchor);
+    trend_viewport_get_window(&s, &e);
+    ASSERT_EQ_INT((int)(e - s), 1800);
+    ASSERT_TRUE(anchor - s == 450);         /* Still a quarter in */
+
+    /* Clamped to 10 min .. 72 h */
+    trend_viewport_zoom(60, anchor);
+    ASSERT_EQ_INT((int)trend_viewport_span(), TREND_VIEWPORT_MIN_SPAN_S);
+    trend_viewport_zoom(1000000, anchor);
+    ASSERT_EQ_INT((int)trend_viewport_span(), TREND_VIEWPORT_MAX_SPAN_S);
+
+    /* Settling snaps to the nearest level by ratio */
+    trend_viewport_reset(TREND_RANGE_1H, now);
+    trend_viewport_pan(-7200);
+    trend_viewport_zoom(5000, 0);
+    ASSERT_EQ_INT((int)trend_viewport_settle(), 3600);
+    trend_viewport_zoom(5500, 0);
+    ASSERT_EQ_INT((int)trend_viewport_settle(), 7200);
+    trend_viewport_zoom(30 * 3600, 0);
+    ASSERT_EQ_INT((int)trend_viewport_settle(), 86400);
+
+    /* A live window zooms about its end */
+    trend_viewport_reset(TREND_RANGE_1H, now);
+    trend_viewport_zoom(1200, now - 3000);
+    trend_viewport_get_window(&s, &e);
+    ASSERT_TRUE(e == now && s == now - 1200);
+    ASSERT_EQ_INT((int)trend_viewport_settle(), 900);
+    ASSERT_TRUE(trend_viewport_is_live());
+}
+
+/* ── Test: tier per tile ─────────────────────────────────── */
+
+static void test_tier(void) {
+    printf("  test_tier\n");
+    /* Raw while 1-min rows would leave points empty and samples exist */
+    ASSERT_EQ_INT(trend_viewport_tier(3600, now - 3600, now), TREND_TIER_RAW);
+    ASSERT_EQ_INT(trend_viewport_tier(14400, now - 14400, now),
+                  TREND_TIER_RAW);
+    ASSERT_EQ_INT(trend_viewport_tier(3600, now - 5 * 3600, now),
+                  TREND_TIER_1MIN);
+    ASSERT_EQ_INT(trend_viewport_tier(28800, now - 28800 + 3600, now),
+                  TREND_TIER_1MIN);
+    ASSERT_EQ_INT(trend_viewport_tier(TREND_VIEWPORT_MAX_SPAN_S, 0, now),
+                  TREND_TIER_1MIN);
+    ASSERT_EQ_INT(trend_viewport_tier(3600u * PTS, 0, now),
+                  TREND_TIER_1HOUR);
+}
+
+/* ── Test: fetch order ───────────────────────────────────── */
+
+static void test_fetch_order(void) {
+    printf("  test_fetch_order\n");
+    fresh();
+    trend_viewport_set_now(now + 1800);     /* Window straddles two tiles */
+    trend_viewport_fetch_t f;
+
+    /* The two tiles under the window, progressive */
+    ASSERT_TRUE(trend_viewport_next_fetch(&f));
+    ASSERT_TRUE(f.start_ts == now - 3600 && f.end_ts == now);
+    ASSERT_TRUE(f.visible && !f.refresh);
+    ASSERT_EQ_INT(f.tier, TREND_TIER_RAW);
+    ASSERT_EQ_INT(f.points, 450);           /* 8 s buckets reach the end */
+
+    /* A preview does not complete a tile */
+    trend_viewport_store(make_set(f.start_ts, f.end_ts, TREND_STAGE_COARSE,
+                                  60, 70));
+    ASSERT_TRUE(trend_viewport_next_fetch(&f));
+    ASSERT_TRUE(f.start_ts == now - 3600);
+    trend_viewport_store(make_set(f.start_ts, f.end_ts, TREND_STAGE_FULL,
+                                  8, 70));
+
+    ASSERT_TRUE(trend_viewport_next_fetch(&f));
+    ASSERT_TRUE(f.start_ts == now && f.visible);
+    trend_viewport_store(make_set(f.start_ts, f.end_ts, TREND_STAGE_FULL,
+                                  8, 70));
+
+    /* Then the earlier neighbour (no later one: it is in the future) */
+    ASSERT_TRUE(trend_viewport_next_fetch(&f));
+    ASSERT_TRUE(f.start_ts == now - 7200 && !f.visible);
+    trend_viewport_store(make_set(f.start_ts, f.end_ts, TREND_STAGE_FULL,
+                                  8, 70));
+    ASSERT_FALSE(trend_viewport_next_fetch(&f));
+
+    /* The newest tile is refreshed as the clock moves on */
+    trend_viewport_set_now(now + 1800 + TREND_VIEWPORT_REFRESH_S);
+    ASSERT_TRUE(trend_viewport_next_fetch(&f));
+    ASSERT_TRUE(f.start_ts == now && f.refresh);
+    trend_viewport_store(make_set(f.start_ts, f.end_ts, TREND_STAGE_FULL,
+                                  8, 70));
+    ASSERT_FALSE(trend_viewport_next_fetch(&f));
+
+    /* Nothing is fetched mid-gesture */
+    trend_viewport_zoom(2000, now);
+    ASSERT_FALSE(trend_viewport_next_fetch(&f));
+    trend_viewport_settle();
+    ASSERT_TRUE(trend_viewport_next_fetch(&f));
+
+    /* Expired tiles are refetched without a preview */
+    trend_viewport_reset(TREND_RANGE_1H, now + 1800);
+    trend_viewport_expire();
+    ASSERT_TRUE(trend_viewport_next_fetch(&f));
+    ASSERT_TRUE(f.start_ts == now - 3600 && f.refresh);
+}
+
+/* ── Test: panning redraws from held tiles ───────────────── */
+
+static void test_pan_render(void) {
+    printf("  test_pan_render\n");
+    fresh();
+    /* Two full tiles: 70 bpm then 90 bpm */
+    trend_viewport_store(make_set(now - 7200, now - 3600, TREND_STAGE_FULL,
+                                  60, 70));
+    trend_viewport_store(make_set(now - 3600, now, TREND_STAGE_FULL,
+                                  60, 90));
+
+    trend_viewport_render(TREND_PARAM_HR, y, PTS, NONE);
+    ASSERT_EQ_INT(count_value(90), PTS);
+
+    /* Half a window back: half of each, no gaps, no fetch needed */
+    trend_viewport_pan(-1800);
+    trend_viewport_render(TREND_PARAM_HR, y, PTS, NONE);
+    ASSERT_EQ_INT(count_value(70), PTS / 2);
+    ASSERT_EQ_INT(count_value(90), PTS / 2);
+    ASSERT_EQ_INT(y[0], 70);
+    ASSERT_EQ_INT(y[PTS - 1], 90);
+
+    /* Beyond held tiles: empty, not stretched */
+    trend_viewport_pan(-3600);
+    trend_viewport_render(TREND_PARAM_HR, y, PTS, NONE);
+    ASSERT_EQ_INT(count_value(70), PTS / 2);
+    ASSERT_EQ_INT(count_value(NONE), PTS / 2);
+
+    /* Another patient's tiles are never drawn */
+    trend_viewport_set_patient(7);
+    trend_viewport_render(TREND_PARAM_HR, y, PTS, NONE);
+    ASSERT_EQ_INT(count_value(NONE), PTS);
+    trend_viewport_store(make_set(now - 3600, now, TREND_STAGE_FULL, 60, 90));
+    trend_viewport_render(TREND_PARAM_HR, y, PTS, NONE);
+    ASSERT_EQ_INT(count_value(NONE), PTS);
+}
+
+/* ── Test: LTTB tiles meet without a break ───────────────── */
+
+static void test_lttb_seam(void) {
+    printf("  test_lttb_seam\n");
+    fresh();
+    trend_viewport_pan(-1800);
+    const trend_query_set_t *a = make_set(now - 7200, now - 3600,
+                                          TREND_STAGE_FULL, 30, 80);
+    set.ds[TREND_PARAM_HR] = TREND_DS_LTTB;
+    trend_viewport_store(a);
+    const trend_query_set_t *b = make_set(now - 3600, now,
+                                          TREND_STAGE_FULL, 30, 80);
+    set.ds[TREND_PARAM_HR] = TREND_DS_LTTB;
+    trend_viewport_store(b);
+
+    trend_viewport_render(TREND_PARAM_HR, y, PTS, NONE);
+    ASSERT_EQ_INT(count_value(80), PTS);
+}
+
+/* ── Test: preview, then full; old zoom fills in ─────────── */
+
+static void test_refine(void) {
+    printf("  test_refine\n");
+    fresh();
+    trend_viewport_store(make_set(now - 3600, now, TREND_STAGE_COARSE,
+                                  600, 60));
+    trend_viewport_render(TREND_PARAM_HR, y, PTS, NONE);
+    ASSERT_EQ_INT(count_value(60), PTS);
+
+    /* Full result replaces the preview; a late preview does not undo it */
+    trend_viewport_store(make_set(now - 3600, now, TREND_STAGE_FULL, 8, 75));
+    trend_viewport_store(make_set(now - 3600, now, TREND_STAGE_COARSE,
+                                  600, 60));
+    trend_viewport_render(TREND_PARAM_HR, y, PTS, NONE);
+    ASSERT_EQ_INT(count_value(75), PTS);
+
+    /* Zoom in to 30 min: the 1 h tile is stretched until 30 min tiles land */
+    trend_viewport_zoom(1800, now);
+    trend_viewport_settle();
+    trend_viewport_render(TREND_PARAM_HR, y, PTS, NONE);
+    ASSERT_EQ_INT(count_value(75), PTS);
+
+    trend_viewport_store(make_set(now - 1800, now, TREND_STAGE_FULL, 4, 99));
+    trend_viewport_render(TREND_PARAM_HR, y, PTS, NONE);
+    ASSERT_EQ_INT(count_value(99), PTS);
+
+    /* Zoom out to 2 h: the finer 30 min tile wins where it covers */
+    trend_viewport_zoom(7200, now);
+    trend_viewport_settle();
+    trend_viewport_render(TREND_PARAM_HR, y, PTS, NONE);
+    ASSERT_EQ_INT(count_value(99), PTS / 4);
+    ASSERT_EQ_INT(count_value(75), PTS / 4);
+    ASSERT_EQ_INT(count_value(NONE), PTS / 2);
+}
+
+/* ── Test: eviction keeps what is on screen ──────────────── */
+
+static void test_eviction(void) {
+    printf("  test_eviction\n");
+    fresh();
+    /* Fill every slot with off-screen history, then the window */
+    for (int i = 0; i < TREND_VIEWPORT_TILES; i++) {
+        uint32_t s = now - (uint32_t)(i + 3) * 3600;
+        trend_viewport_store(make_set(s, s + 3600, TREND_STAGE_FULL, 60, 50));
+    }
+    trend_viewport_store(make_set(now - 3600, now, TREND_STAGE_FULL, 60, 90));
+    trend_viewport_store(make_set(now - 7200, now - 3600, TREND_STAGE_FULL,
+                                  60, 80));
+
+    trend_viewport_render(TREND_PARAM_HR, y, PTS, NONE);
+    ASSERT_EQ_INT(count_value(90), PTS);
+    trend_viewport_fetch_t f;
+    ASSERT_FALSE(trend_viewport_next_fetch(&f));
+}
+
+/* ── Test: NIBP and alarm markers ────────────────────────── */
+
+static void test_sparse(void) {
+    printf("  test_sparse\n");
+    fresh();
+    make_set(now - 3600, now, TREND_STAGE_FULL, 60, 70);
+    set.nibp.timestamp_s[0] = now - 1800;
+    set.nibp.sys[0] = 120;
+    set.nibp.dia[0] = 80;
+    set.nibp.count = 1;
+    uint8_t kinds[3] = { ALARM_EVT_ONSET, ALARM_EVT_ACK, ALARM_EVT_REALERT };
+    for (int i = 0; i < 3; i++) {
+        set.alarms.timestamp_s[i] = now - 3000 + (uint32_t)i * 60;
+        set.alarms.kind[i] = kinds[i];
+        set.alarms.severity[i] = ALARM_SEV_HIGH;
+    }
+    set.alarms.count = 3;
+    trend_viewport_store(&set);
+
+    int32_t dia[PTS];
+    trend_viewport_render_nibp(y, dia, PTS, NONE);
+    ASSERT_EQ_INT(count_value(120), 1);
+    ASSERT_EQ_INT(y[PTS / 2], 120);
+    ASSERT_EQ_INT(dia[PTS / 2], 80);
+
+    /* Acks are not marked */
+    trend_viewport_mark_t marks[8];
+    ASSERT_EQ_INT(trend_viewport_marks(marks, 8), 2);
+    ASSERT_TRUE(marks[1].timestamp_s == now - 3000 + 120);
+
+    /* Panned off screen */
+    trend_viewport_pan(-3600);
+    ASSERT_EQ_INT(trend_viewport_marks(marks, 8), 0);
+}
+
+/* ── Test: fetch loop against trend_db ───────────────────── */
+
+static int stores = 0;
+
+static void store_cb(const trend_query_set_t *qs, void *user_data) {
+    (void)user_data;
+    trend_viewport_store(qs);
+    stores++;
+}
+
+static bool wait_idle(void) {
+    for (int i = 0; i < 2000; i++) {
+        job_pool_dispatch_completions();
+        if (!trend_query_busy()) return true;
+        usleep(1000);
+    }
+    return false;
+}
+
+/** Request tiles until the viewport wants no more.  @return fetches. */
+static int fetch_all(void) {
+    trend_viewport_fetch_t f;
+    int n = 0;
+    while (n < 10 && trend_viewport_next_fetch(&f)) {
+        trend_query_request(f.start_ts, f.end_ts, f.points, f.tier,
+                            f.visible && !f.refresh, store_cb, NULL);
+        if (!wait_idle()) break;
+        n++;
+    }
+    return n;
+}
+
+static void test_fetch_loop(void) {
+    printf("  test_fetch_loop\n");
+    unlink(TV_TEST_DB);
+    unlink(TV_TEST_DB "-wal");
+    unlink(TV_TEST_DB "-shm");
+    trend_db_init(TV_TEST_DB);
+    job_pool_init(0);
+
+    /* Two hours of 1 Hz samples up to now */
+    uint32_t base = now - 7200;
+    for (uint32_t t = 0; t < 7200; t++) {
+        trend_db_insert_sample(0, base + t, 60 + (int)(t / 60) % 40, 97, 16,
+                               37.0f);
+        if (t % 60 == 59) trend_db_aggregate_minute(base + t + 1);
+    }
+
+    fresh();
+    trend_viewport_set_patient(trend_db_slot_patient(0));
+    stores = 0;
+
+    /* Window tile (preview + full), then the earlier neighbour */
+    ASSERT_EQ_INT(fetch_all(), 2);
+    ASSERT_EQ_INT(stores, 3);
+    trend_viewport_render(TREND_PARAM_HR, y, PTS, NONE);
+    ASSERT_EQ_INT(count_value(NONE), 0);
+
+    /* Panning onto the prefetched tile needs no query */
+    trend_viewport_pan(-2700);
+    trend_viewport_render(TREND_PARAM_HR, y, PTS, NONE);
+    ASSERT_EQ_INT(count_value(NONE), 0);
+    ASSERT_EQ_INT(y[0], 60 + 15);           /* Minute 15 of the seed */
+
+    /* Then the next neighbour back (before the seed: no data) */
+    ASSERT_EQ_INT(fetch_all(), 1);
+    trend_viewport_render(TREND_PARAM_HR, y, PTS, NONE);
+    ASSERT_EQ_INT(count_value(NONE), 0);
+
+    /* Zoom into 10 min: raw samples, one per second */
+    trend_viewport_reset(TREND_RANGE_1H, now);
+    trend_viewport_zoom(600, now);
+    trend_viewport_settle();
+    ASSERT_GT_INT(fetch_all(), 0);
+    trend_viewport_render(TREND_PARAM_HR, y, PTS, NONE);
+    ASSERT_EQ_INT(count_value(NONE), 0);
+
+    job_pool_deinit();
+    trend_db_close();
+    unlink(TV_TEST_DB);
+    unlink(TV_TEST_DB "-wal");
+    unlink(TV_TEST_DB "-shm");
+}
+
+/* ── Public entry point ──────────────────────────────────── */
+
+void test_trend_viewport_integration(void) {
+    test_window();
+    test_zoom();
+    test_tier();
+    test_fetch_order();
+    test_pan_render();
+    test_lttb_seam();
+    test_refine();
+    test_eviction();
+    test_sparse();
+    test_fetch_loop();
+}
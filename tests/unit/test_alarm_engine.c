@@ -3,7 +3,8 @@
  * @brief Unit tests for alarm_engine module
  *
  * Tests alarm threshold evaluation, state machine transitions,
- * acknowledge/silence workflows, custom limits, and audio pause.
+ * acknowledge/silence workflows, custom limits, audio pause, and the
+ * transition events and their display text.
  */
 
 #include "test_framework.h"
@@ -643,6 +644,180 @@ static void test_null_data_safe(void) {
     alarm_engine_deinit();
 }
 
+/* ── Test: save/restore across a restart ────────────────── */
+
+static void test_save_restore(void) {
+    printf("  test_save_restore\n");
+
+    alarm_engine_init();
+    alarm_limits_t hr = *alarm_engine_get_limits(ALARM_PARAM_HR);
+    hr.critical_high = 140;
+    alarm_engine_set_limits(ALARM_PARAM_HR, &hr);
+
+    /* HR alarm at t=100, silenced until t=220 */
+    vitals_data_t v = make_normal_vitals();
+    v.hr = 145;
+    alarm_engine_evaluate(&v, 100);
+    ASSERT_TRUE(alarm_engine_silence(ALARM_PARAM_HR, 120));
+
+    alarm_engine_snapshot_t snap;
+    alarm_engine_save(&snap);
+    ASSERT_EQ_INT((int)snap.time_s, 100);
+    alarm_engine_deinit();
+
+    /* Restart: the time base begins again at 1, after a 10 s outage */
+    alarm_engine_init();
+    alarm_engine_restore(&snap, 10);
+    const alarm_engine_state_t *state = alarm_engine_get_state();
+    ASSERT_EQ_INT(alarm_engine_get_limits(ALARM_PARAM_HR)->critical_high, 140);
+    ASSERT_EQ_INT(state->params[ALARM_PARAM_HR].state, ALARM_STATE_SILENCED);
+    ASSERT_EQ_INT(state->highest_any, ALARM_SEV_HIGH);
+
+    /* 120 s silence - 10 s outage = 110 s left from t=1 */
+    alarm_engine_evaluate(&v, 1);
+    ASSERT_EQ_INT((int)state->params[ALARM_PARAM_HR].silence_until_s, 111);
+    ASSERT_EQ_INT((int)state->params[ALARM_PARAM_HR].trigger_time_s, 1);
+    alarm_engine_evaluate(&v, 110);
+    ASSERT_EQ_INT(state->params[ALARM_PARAM_HR].state, ALARM_STATE_SILENCED);
+    alarm_engine_evaluate(&v, 112);
+    ASSERT_EQ_INT(state->params[ALARM_PARAM_HR].state, ALARM_STATE_ACTIVE);
+
+    /* A fresh init forgets the restore */
+    alarm_engine_deinit();
+    alarm_engine_init();
+    ASSERT_EQ_INT(alarm_engine_get_limits(ALARM_PARAM_HR)->critical_high, 150);
+    alarm_engine_deinit();
+}
+
+/* ── Test: transition events ─────────────────────────────── */
+
+static alarm_event_t events[16];
+static int event_count;
+
+static void collect_event(const alarm_event_t *evt, void *user_data) {
+    (void)user_data;
+    if (event_count < 16) events[event_count++] = *evt;
+}
+
+static void test_transition_events(void) {
+    printf("  test_transition_events\n");
+
+    alarm_engine_init();
+    event_count = 0;
+    alarm_engine_set_event_callback(collect_event, NULL);
+
+    vitals_data_t v = make_normal_vitals();
+    alarm_engine_evaluate(&v, 10);
+    ASSERT_EQ_INT(event_count, 0);
+
+    v.hr = 130;                                 /* Warning: onset */
+    alarm_engine_evaluate(&v, 11);
+    v.hr = 131;                                 /* Same severity: nothing */
+    alarm_engine_evaluate(&v, 12);
+    v.hr = 160;                                 /* Critical: escalate */
+    alarm_engine_evaluate(&v, 13);
+    alarm_engine_acknowledge(ALARM_PARAM_HR);
+    alarm_engine_silence(ALARM_PARAM_HR, 60);
+    alarm_engine_evaluate(&v, 80);              /* Silence over: re-alert */
+    v.hr = 72;
+    alarm_engine_evaluate(&v, 90);              /* Normal: clear */
+
+    ASSERT_EQ_INT(event_count, 6);
+    ASSERT_EQ_INT(events[0].kind, ALARM_EVT_ONSET);
+    ASSERT_EQ_INT(events[0].param, ALARM_PARAM_HR);
+    ASSERT_EQ_INT(events[0].severity, ALARM_SEV_MEDIUM);
+    ASSERT_EQ_INT(events[0].value, 130);
+    ASSERT_EQ_INT(events[0].threshold, 120);
+    ASSERT_TRUE(events[0].has_reading);
+    ASSERT_EQ_INT((int)events[0].time_s, 11);
+    ASSERT_EQ_INT(events[1].kind, ALARM_EVT_ESCALATE);
+    ASSERT_EQ_INT(events[1].threshold, 150);
+    ASSERT_EQ_INT(events[2].kind, ALARM_EVT_ACK);
+    ASSERT_EQ_INT(events[3].kind, ALARM_EVT_SILENCE);
+    ASSERT_EQ_INT((int)events[3].duration_s, 60);
+    ASSERT_EQ_INT(events[4].kind, ALARM_EVT_REALERT);
+    ASSERT_EQ_INT(events[4].severity, ALARM_SEV_HIGH);
+    ASSERT_EQ_INT(events[5].kind, ALARM_EVT_CLEAR);
+    ASSERT_EQ_INT(events[5].severity, ALARM_SEV_HIGH);
+    ASSERT_EQ_INT((int)events[5].duration_s, 10);   /* Since the re-alert */
+    ASSERT_FALSE(events[5].has_reading);
+
+    /* Disabling an alarming parameter clears it too */
+    v.spo2 = 80;
+    alarm_engine_evaluate(&v, 100);
+    alarm_limits_t lim = *alarm_engine_get_limits(ALARM_PARAM_SPO2);
+    lim.enabled = false;
+    alarm_engine_set_limits(ALARM_PARAM_SPO2, &lim);
+    alarm_engine_evaluate(&v, 105);
+    ASSERT_EQ_INT(event_count, 8);
+    ASSERT_EQ_INT(events[7].kind, ALARM_EVT_CLEAR);
+    ASSERT_EQ_INT(events[7].param, ALARM_PARAM_SPO2);
+
+    alarm_engine_set_event_callback(NULL, NULL);
+    alarm_engine_deinit();
+}
+
+/* ── Test: event text ─────────────────────────────────────── */
+
+static void test_format_event(void) {
+    printf("  test_format_event\n");
+
+    char buf[96];
+    alarm_event_t e = {
+        .param = ALARM_PARAM_HR, .severity = ALARM_SEV_HIGH,
+        .kind = ALARM_EVT_ONSET, .value = 165, .threshold = 150,
+        .has_reading = true,
+    };
+    alarm_engine_format_event(&e, buf, sizeof(buf));
+    ASSERT_STR_EQ(buf, "HR Very High 165 (>150)");
+
+    e.kind = ALARM_EVT_ESCALATE;
+    alarm_engine_format_event(&e, buf, sizeof(buf));
+    ASSERT_STR_EQ(buf, "HR Very High 165 (>150), escalated");
+
+    e.kind = ALARM_EVT_SILENCE;
+    e.duration_s = 120;
+    alarm_engine_format_event(&e, buf, sizeof(buf));
+    ASSERT_STR_EQ(buf, "HR Very High silenced for 120 s");
+
+    e.kind = ALARM_EVT_CLEAR;
+    e.duration_s = 95;
+    alarm_engine_format_event(&e, buf, sizeof(buf));
+    ASSERT_STR_EQ(buf, "HR alarm cleared after 95 s");
+
+    /* Temperature is x10; low side */
+    alarm_event_t t = {
+        .param = ALARM_PARAM_TEMP, .severity = ALARM_SEV_MEDIUM,
+        .kind = ALARM_EVT_ONSET, .value = 354, .threshold = 355,
+        .has_reading = true,
+    };
+    alarm_engine_format_event(&t, buf, sizeof(buf));
+    ASSERT_STR_EQ(buf, "Temp Low 35.4 (<35.5)");
+
+    /* Sign kept below one degree; zero is a reading, not "unknown" */
+    t.value = -5;
+    t.threshold = 0;
+    alarm_engine_format_event(&t, buf, sizeof(buf));
+    ASSERT_STR_EQ(buf, "Temp Low -0.5 (<0.0)");
+
+    t.value = -15;
+    alarm_engine_format_event(&t, buf, sizeof(buf));
+    ASSERT_STR_EQ(buf, "Temp Low -1.5 (<0.0)");
+
+    /* Unknown parameter and reading (converted rows) */
+    alarm_event_t u = { .param = ALARM_PARAM_COUNT,
+                        .severity = ALARM_SEV_LOW,
+                        .kind = ALARM_EVT_ONSET };
+    alarm_engine_format_event(&u, buf, sizeof(buf));
+    ASSERT_STR_EQ(buf, "Alarm Advisory");
+
+    /* Truncation follows snprintf */
+    char small[8];
+    int n = alarm_engine_format_event(&e, small, sizeof(small));
+    ASSERT_EQ_INT(n, (int)strlen("HR alarm cleared after 95 s"));
+    ASSERT_STR_EQ(small, "HR alar");
+}
+
 /* ── Public entry point ──────────────────────────────────── */
 
 void test_alarm_engine(void) {
@@ -671,4 +846,7 @@ void test_alarm_engine(void) {
     test_temperature_alarm();
     test_nibp_alarms();
     test_null_data_safe();
+    test_save_restore();
+    test_transition_events();
+    test_format_event();
 }
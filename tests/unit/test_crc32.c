@@ -0,0 +1,32 @@
+/**
+ * @file test_crc32.c
+ * @brief Unit tests for crc32 module
+ *
+ * Tests the standard check value and incremental updates.
+ */
+
+#include "test_framework.h"
+#include "crc32.h"
+
+/* ── Test: CRC-32 standard check value ───────────────────── */
+
+static void test_check_value(void) {
+    printf("  test_check_value\n");
+    ASSERT_TRUE(crc32_update(0, "123456789", 9) == 0xCBF43926u);
+    ASSERT_TRUE(crc32_update(0, "", 0) == 0);
+}
+
+/* ── Test: incremental equals one-shot ───────────────────── */
+
+static void test_incremental(void) {
+    printf("  test_incremental\n");
+    uint32_t crc = crc32_update(0, "1234", 4);
+    ASSERT_TRUE(crc32_update(crc, "56789", 5) == 0xCBF43926u);
+}
+
+/* ── Suite entry point ───────────────────────────────────── */
+
+void test_crc32(void) {
+    test_check_value();
+    test_incremental();
+}
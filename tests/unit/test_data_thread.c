@@ -0,0 +1,177 @@
+/**
+ * @file test_data_thread.c
+ * @brief Unit tests for data_thread module
+ *
+ * Tests argument checks, inline mode driven by data_thread_poll(),
+ * tasks and calls on the data thread, skipping of overrun periods, and
+ * calls left queued at shutdown.
+ */
+
+#include "test_framework.h"
+#include "data_thread.h"
+#include <pthread.h>
+#include <unistd.h>
+
+/* ── Test fixtures ───────────────────────────────────────── */
+
+static int  task_runs = 0;              /* __atomic */
+static int  call_runs = 0;              /* __atomic */
+static bool task_on_data = true;
+static bool call_on_data = true;
+static pthread_t test_thread;
+
+static void reset_fixtures(void) {
+    __atomic_store_n(&task_runs, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&call_runs, 0, __ATOMIC_RELAXED);
+    task_on_data = true;
+    call_on_data = true;
+    test_thread = pthread_self();
+}
+
+static void count_task(uint64_t due_us) {
+    (void)due_us;
+    if (!data_thread_is_current()) task_on_data = false;
+    __atomic_add_fetch(&task_runs, 1, __ATOMIC_RELEASE);
+}
+
+static void slow_task(uint64_t due_us) {
+    (void)due_us;
+    if (__atomic_add_fetch(&task_runs, 1, __ATOMIC_RELEASE) == 1) {
+        usleep(30000);          /* Overrun six 5 ms periods once */
+    }
+}
+
+static void count_call(void *arg) {
+    (void)arg;
+    if (!data_thread_is_current()) call_on_data = false;
+    __atomic_add_fetch(&call_runs, 1, __ATOMIC_RELEASE);
+}
+
+static bool wait_for(int *counter, int n) {
+    for (int i = 0; i < 200 && __atomic_load_n(counter, __ATOMIC_ACQUIRE) < n; i++) {
+        usleep(5000);
+    }
+    return __atomic_load_n(counter, __ATOMIC_ACQUIRE) >= n;
+}
+
+/* ── Test: invalid arguments, not running ────────────────── */
+
+static void test_invalid(void) {
+    printf("  test_invalid\n");
+    reset_fixtures();
+
+    ASSERT_EQ_INT(data_thread_add_task("x", 0, count_task), -1);
+    ASSERT_EQ_INT(data_thread_add_task("x", 10, NULL), -1);
+    ASSERT_FALSE(data_thread_is_running());
+    ASSERT_FALSE(data_thread_call(count_call, NULL));
+    ASSERT_FALSE(data_thread_get_task_stats(0, NULL));
+    ASSERT_FALSE(data_thread_is_current());
+}
+
+/* ── Test: inline mode runs tasks from poll() ────────────── */
+
+static void test_inline(void) {
+    printf("  test_inline\n");
+    reset_fixtures();
+
+    int id = data_thread_add_task("count", 10, count_task);
+    ASSERT_EQ_INT(id, 0);
+    ASSERT_TRUE(data_thread_start(false));
+    ASSERT_TRUE(data_thread_is_running());
+
+    /* Nothing runs until polled */
+    usleep(25000);
+    ASSERT_EQ_INT(__atomic_load_n(&task_runs, __ATOMIC_ACQUIRE), 0);
+
+    ASSERT_TRUE(data_thread_call(count_call, NULL));
+    uint32_t wait_ms = data_thread_poll();
+    ASSERT_EQ_INT(__atomic_load_n(&call_runs, __ATOMIC_ACQUIRE), 1);
+    ASSERT_EQ_INT(__atomic_load_n(&task_runs, __ATOMIC_ACQUIRE), 1);
+    ASSERT_TRUE(wait_ms <= 10);
+    ASSERT_TRUE(task_on_data);
+    ASSERT_TRUE(call_on_data);
+    ASSERT_FALSE(data_thread_is_current());
+
+    data_task_stats_t st;
+    ASSERT_TRUE(data_thread_get_task_stats(id, &st));
+    ASSERT_STR_EQ(st.name, "count");
+    ASSERT_EQ_INT(st.runs, 1);
+    /* Two periods were missed while nobody polled */
+    ASSERT_GE_INT((int)st.skipped, 1);
+
+    data_thread_stop();
+    ASSERT_FALSE(data_thread_is_running());
+    ASSERT_EQ_INT(data_thread_task_count(), 0);
+}
+
+/* ── Test: tasks and calls run on the data thread ────────── */
+
+static void test_threaded(void) {
+    printf("  test_threaded\n");
+    reset_fixtures();
+
+    ASSERT_TRUE(data_thread_start(true));
+    ASSERT_EQ_INT(data_thread_poll(), (int)UINT32_MAX);
+
+    /* Added while running */
+    int id = data_thread_add_task("count", 5, count_task);
+    ASSERT_GE_INT(id, 0);
+    ASSERT_TRUE(wait_for(&task_runs, 5));
+
+    ASSERT_TRUE(data_thread_call(count_call, NULL));
+    ASSERT_TRUE(data_thread_call(count_call, NULL));
+    ASSERT_TRUE(wait_for(&call_runs, 2));
+
+    ASSERT_TRUE(task_on_data);
+    ASSERT_TRUE(call_on_data);
+    ASSERT_FALSE(data_thread_is_current());
+
+    data_thread_stop();
+    int runs = __atomic_load_n(&task_runs, __ATOMIC_ACQUIRE);
+    usleep(20000);
+    ASSERT_EQ_INT(__atomic_load_n(&task_runs, __ATOMIC_ACQUIRE), runs);
+}
+
+/* ── Test: an overrun skips periods instead of catching up ─ */
+
+static void test_overrun_skips(void) {
+    printf("  test_overrun_skips\n");
+    reset_fixtures();
+
+    int id = data_thread_add_task("slow", 5, slow_task);
+    ASSERT_TRUE(data_thread_start(true));
+    ASSERT_TRUE(wait_for(&task_runs, 3));
+
+    data_task_stats_t st;
+    ASSERT_TRUE(data_thread_get_task_stats(id, &st));
+    ASSERT_GE_INT((int)st.skipped, 4);
+    ASSERT_GE_INT((int)st.max_run_us, 30000);
+
+    data_thread_stop();
+}
+
+/* ── Test: calls still queued at stop run on the caller ──── */
+
+static void test_stop_runs_calls(void) {
+    printf("  test_stop_runs_calls\n");
+    reset_fixtures();
+
+    ASSERT_TRUE(data_thread_start(false));
+    ASSERT_TRUE(data_thread_call(count_call, NULL));
+    ASSERT_TRUE(data_thread_call(count_call, NULL));
+    ASSERT_EQ_INT(__atomic_load_n(&call_runs, __ATOMIC_ACQUIRE), 0);
+
+    data_thread_stop();
+    ASSERT_EQ_INT(__atomic_load_n(&call_runs, __ATOMIC_ACQUIRE), 2);
+    ASSERT_FALSE(data_thread_call(count_call, NULL));
+}
+
+/* ── Public entry point ──────────────────────────────────── */
+
+void test_data_thread(void) {
+    test_invalid();
+    test_inline();
+    test_threaded();
+    test_overrun_skips();
+    test_stop_runs_calls();
+}
@@ -0,0 +1,119 @@
+/**
+ * @file test_db_schema.c
+ * @brief Unit tests for db_schema module
+ *
+ * Tests the per-module bits of the user_version stamp, that a stamp from
+ * another schema version counts as stale, and that a module's second
+ * init on a stamped file skips its DDL but still works.
+ */
+
+#include "test_framework.h"
+#include "db_schema.h"
+#include "settings_store.h"
+#include "patient_data.h"
+#include <unistd.h>
+
+#define DS_TEST_DB   "/tmp/test_db_schema.db"
+
+/* ── Helpers ─────────────────────────────────────────────── */
+
+static void remove_db(void) {
+    unlink(DS_TEST_DB);
+    unlink(DS_TEST_DB "-wal");
+    unlink(DS_TEST_DB "-shm");
+}
+
+static int user_version(sqlite3 *c) {
+    sqlite3_stmt *st = NULL;
+    int v = -1;
+    if (sqlite3_prepare_v2(c, "PRAGMA user_version", -1, &st, NULL) == SQLITE_OK &&
+        sqlite3_step(st) == SQLITE_ROW) {
+        v = sqlite3_column_int(st, 0);
+    }
+    sqlite3_finalize(st);
+    return v;
+}
+
+/* ── Test: bits per module ───────────────────────────────── */
+
+static void test_part_bits(void) {
+    printf("  test_part_bits\n");
+    sqlite3 *c = NULL;
+    sqlite3_open(":memory:", &c);
+
+    ASSERT_FALSE(db_schema_is_current(c, DB_SCHEMA_AUDIT));
+    ASSERT_TRUE(db_schema_mark_current(c, DB_SCHEMA_AUDIT));
+    ASSERT_TRUE(db_schema_mark_current(c, DB_SCHEMA_SYNC));
+    ASSERT_TRUE(db_schema_is_current(c, DB_SCHEMA_AUDIT));
+    ASSERT_TRUE(db_schema_is_current(c, DB_SCHEMA_SYNC));
+    ASSERT_FALSE(db_schema_is_current(c, DB_SCHEMA_AUTH));
+    ASSERT_EQ_INT(user_version(c), (DB_SCHEMA_VERSION << 16) |
+                                   DB_SCHEMA_AUDIT | DB_SCHEMA_SYNC);
+
+    /* A stamp from another version: every module runs its DDL again */
+    char sql[48];
+    snprintf(sql, sizeof(sql), "PRAGMA user_version=%d",
+             ((DB_SCHEMA_VERSION + 1) << 16) | DB_SCHEMA_AUDIT);
+    sqlite3_exec(c, sql, NULL, NULL, NULL);
+    ASSERT_FALSE(db_schema_is_current(c, DB_SCHEMA_AUDIT));
+    ASSERT_TRUE(db_schema_mark_current(c, DB_SCHEMA_AUTH));
+    ASSERT_FALSE(db_schema_is_current(c, DB_SCHEMA_AUDIT));
+    ASSERT_TRUE(db_schema_is_current(c, DB_SCHEMA_AUTH));
+
+    ASSERT_FALSE(db_schema_is_current(NULL, DB_SCHEMA_AUTH));
+    sqlite3_close(c);
+}
+
+/* ── Test: ensure runs the DDL once ──────────────────────── */
+
+static void test_ensure(void) {
+    printf("  test_ensure\n");
+    sqlite3 *c = NULL;
+    sqlite3_open(":memory:", &c);
+
+    ASSERT_TRUE(db_schema_ensure(c, DB_SCHEMA_SYNC,
+                                 "CREATE TABLE t (x INTEGER);", "test"));
+    ASSERT_TRUE(db_schema_is_current(c, DB_SCHEMA_SYNC));
+    /* Stamped: the (now failing) script is not run again */
+    ASSERT_TRUE(db_schema_ensure(c, DB_SCHEMA_SYNC,
+                                 "CREATE TABLE t (x INTEGER);", "test"));
+
+    /* Failing DDL leaves the bit clear */
+    ASSERT_FALSE(db_schema_ensure(c, DB_SCHEMA_AUDIT, "CREATE TABLE t (y);",
+                                  "test"));
+    ASSERT_FALSE(db_schema_is_current(c, DB_SCHEMA_AUDIT));
+    sqlite3_close(c);
+}
+
+/* ── Test: modules sharing one file ──────────────────────── */
+
+static void test_shared_file(void) {
+    printf("  test_shared_file\n");
+    remove_db();
+
+    ASSERT_TRUE(settings_store_init(DS_TEST_DB));
+    settings_set_int(SETTINGS_KEY_BRIGHTNESS, 42);
+    settings_store_close();
+    ASSERT_TRUE(patient_data_init(DS_TEST_DB));
+    patient_data_close();
+
+    sqlite3 *c = NULL;
+    sqlite3_open(DS_TEST_DB, &c);
+    ASSERT_EQ_INT(user_version(c), (DB_SCHEMA_VERSION << 16) |
+                                   DB_SCHEMA_SETTINGS | DB_SCHEMA_PATIENT);
+    sqlite3_close(c);
+
+    /* Second boot: DDL skipped, data and statements intact */
+    ASSERT_TRUE(settings_store_init(DS_TEST_DB));
+    ASSERT_EQ_INT(settings_get_int(SETTINGS_KEY_BRIGHTNESS, -1), 42);
+    settings_store_close();
+    remove_db();
+}
+
+/* ── Public entry point ──────────────────────────────────── */
+
+void test_db_schema(void) {
+    test_part_bits();
+    test_ensure();
+    test_shared_file();
+}
@@ -0,0 +1,169 @@
+/**
+ * @file test_glyph_cache.c
+ * @brief Unit tests for glyph_cache module
+ *
+ * Tests lookup by font and key, LRU eviction order within the byte budget
+ * and the entry limit, pinned and referenced entries surviving pressure,
+ * the eviction callback, and rejection when nothing can be evicted.
+ */
+
+#include "test_framework.h"
+#include "glyph_cache.h"
+#include <stdint.h>
+#include <string.h>
+
+/* ── Test fixtures ───────────────────────────────────────── */
+
+#define CACHE_BYTES (16 * 1024)
+
+static uint64_t      cache_mem[CACHE_BYTES / sizeof(uint64_t)];
+static glyph_cache_t cache;
+static int           evicted_count = 0;
+static uint8_t       evicted_first = 0;
+
+static void on_evict(glyph_bitmap_t *bm, void *user_data) {
+    (void)user_data;
+    if (evicted_count++ == 0) evicted_first = bm->data[0];
+}
+
+static void reset(void) {
+    evicted_count = 0;
+    evicted_first = 0;
+    ASSERT_TRUE(glyph_cache_init(&cache, cache_mem, sizeof(cache_mem), on_evict, NULL));
+}
+
+/** Add a w x w bitmap whose first byte is `mark`. */
+static glyph_bitmap_t *add(uint32_t font, const char *key, uint16_t w,
+                           uint8_t mark, uint8_t flags) {
+    glyph_bitmap_t *bm = glyph_cache_add(&cache, font, key, w, w, 0, flags);
+    if (bm) bm->data[0] = mark;
+    return bm;
+}
+
+/* ── Test: add and find ──────────────────────────────────── */
+
+static void test_add_find(void) {
+    printf("  test_add_find\n");
+    reset();
+
+    ASSERT_NULL(glyph_cache_find(&cache, 1, "7"));
+    glyph_bitmap_t *bm = glyph_cache_add(&cache, 1, "7", 20, 30, 40, 0);
+    ASSERT_NOT_NULL(bm);
+    ASSERT_EQ_INT(bm->w, 20);
+    ASSERT_EQ_INT(bm->h, 30);
+    ASSERT_EQ_INT(bm->stride, 20);
+    ASSERT_NOT_NULL(bm->user);
+    ASSERT_EQ_INT((int)((uintptr_t)bm->user % 8), 0);
+    ASSERT_EQ_INT(bm->data[599], 0);                /* Zeroed */
+    memset(bm->user, 0xEE, 40);                     /* Caller space is its own */
+    memset(bm->data, 0x80, 600);
+
+    ASSERT_TRUE(glyph_cache_find(&cache, 1, "7") == bm);
+    ASSERT_NULL(glyph_cache_find(&cache, 2, "7"));  /* Other font */
+    ASSERT_NULL(glyph_cache_find(&cache, 1, "77"));
+
+    /* Long keys: whole strings, up to the limit */
+    char key[GLYPH_CACHE_KEY_MAX + 1];
+    memset(key, 'a', sizeof(key) - 1);
+    key[sizeof(key) - 1] = '\0';
+    ASSERT_NULL(glyph_cache_add(&cache, 1, key, 4, 4, 0, 0));
+    key[GLYPH_CACHE_KEY_MAX - 1] = '\0';
+    ASSERT_NOT_NULL(glyph_cache_add(&cache, 1, key, 4, 4, 0, 0));
+    ASSERT_NOT_NULL(glyph_cache_find(&cache, 1, key));
+
+    glyph_cache_stats_t s = glyph_cache_get_stats(&cache);
+    ASSERT_EQ_INT(s.entries, 2);
+    ASSERT_EQ_INT(s.hits, 2);
+    ASSERT_EQ_INT(s.misses, 3);
+    ASSERT_EQ_INT(s.rejected, 1);
+    ASSERT_TRUE(s.bytes > 600 && s.bytes < s.capacity);
+}
+
+/* ── Test: least recently used goes first ────────────────── */
+
+static void test_lru_order(void) {
+    printf("  test_lru_order\n");
+    reset();
+
+    /* Three 64x64 bitmaps fill most of the 16 KB budget */
+    ASSERT_NOT_NULL(add(1, "A", 64, 'A', 0));
+    ASSERT_NOT_NULL(add(1, "B", 64, 'B', 0));
+    ASSERT_NOT_NULL(add(1, "C", 64, 'C', 0));
+    ASSERT_EQ_INT(evicted_count, 0);
+
+    /* Touch A: B is now least recent.  D (63x63) is too big for the free
+     * tail but fits in B's place */
+    ASSERT_NOT_NULL(glyph_cache_find(&cache, 1, "A"));
+    ASSERT_NOT_NULL(add(1, "D", 63, 'D', 0));
+    ASSERT_EQ_INT(evicted_count, 1);
+    ASSERT_EQ_INT(evicted_first, 'B');
+    ASSERT_NULL(glyph_cache_find(&cache, 1, "B"));
+    ASSERT_NOT_NULL(glyph_cache_find(&cache, 1, "A"));
+    ASSERT_NOT_NULL(glyph_cache_find(&cache, 1, "C"));
+
+    /* A big entry evicts as many as it needs */
+    ASSERT_NOT_NULL(add(1, "E", 120, 'E', 0));
+    ASSERT_EQ_INT(glyph_cache_get_stats(&cache).entries, 1);
+    ASSERT_EQ_INT(glyph_cache_get_stats(&cache).evictions, 4);
+}
+
+/* ── Test: pinned and referenced entries stay ────────────── */
+
+static void test_pin_and_ref(void) {
+    printf("  test_pin_and_ref\n");
+    reset();
+
+    ASSERT_NOT_NULL(add(1, "0", 30, '0', GLYPH_CACHE_PIN));
+    glyph_bitmap_t *label = add(2, "Heart rate", 30, 'L', 0);
+    ASSERT_NOT_NULL(label);
+    glyph_cache_ref(&cache, label);
+
+    /* Churn far past the budget */
+    char key[8];
+    for (int i = 0; i < 50; i++) {
+        snprintf(key, sizeof(key), "x%d", i);
+        ASSERT_NOT_NULL(add(3, key, 30, 'x', 0));
+    }
+    ASSERT_NOT_NULL(glyph_cache_find(&cache, 1, "0"));
+    ASSERT_TRUE(glyph_cache_find(&cache, 2, "Heart rate") == label);
+    ASSERT_EQ_INT(label->data[0], 'L');
+    ASSERT_EQ_INT(glyph_cache_get_stats(&cache).pinned, 1);
+
+    /* Nothing evictable left for a request this large */
+    ASSERT_NULL(add(3, "huge", 127, 'h', 0));
+    ASSERT_EQ_INT(glyph_cache_get_stats(&cache).rejected, 1);
+
+    /* Unreferenced, the label is the most recent entry, not the first out */
+    glyph_cache_unref(&cache, label);
+    ASSERT_NOT_NULL(add(3, "y", 30, 'y', 0));
+    ASSERT_NOT_NULL(glyph_cache_find(&cache, 2, "Heart rate"));
+    glyph_cache_unref(&cache, label);               /* Extra unref ignored */
+}
+
+/* ── Test: entry limit ───────────────────────────────────── */
+
+static void test_entry_limit(void) {
+    printf("  test_entry_limit\n");
+    reset();
+
+    char key[8];
+    for (int i = 0; i < GLYPH_CACHE_MAX_ENTRIES + 10; i++) {
+        snprintf(key, sizeof(key), "%d", i);
+        ASSERT_NOT_NULL(glyph_cache_add(&cache, 1, key, 1, 1, 0, 0));
+    }
+    glyph_cache_stats_t s = glyph_cache_get_stats(&cache);
+    ASSERT_EQ_INT(s.entries, GLYPH_CACHE_MAX_ENTRIES);
+    ASSERT_EQ_INT(s.evictions, 10);
+    ASSERT_NULL(glyph_cache_find(&cache, 1, "9"));
+    ASSERT_NOT_NULL(glyph_cache_find(&cache, 1, "10"));
+    ASSERT_TRUE(tlsf_check(&cache.pool));
+}
+
+/* ── Suite entry point ───────────────────────────────────── */
+
+void test_glyph_cache(void) {
+    test_add_find();
+    test_lru_order();
+    test_pin_and_ref();
+    test_entry_limit();
+}
@@ -0,0 +1,200 @@
+/**
+ * @file test_gzip_writer.c
+ * @brief Unit tests for gzip_writer module
+ *
+ * Output is decoded with a minimal fixed-Huffman inflater below and
+ * compared with the input: empty input, text spanning several blocks,
+ * long runs and incompressible bytes.  Also checks the gzip header and
+ * trailer, the compression ratio on CSV-like text and sink failure.
+ */
+
+#include "test_framework.h"
+#include "gzip_writer.h"
+#include "crc32.h"
+#include <string.h>
+
+/* ── Helpers ─────────────────────────────────────────────── */
+
+static gzip_writer_t gz;
+static uint8_t packed[120000];
+static size_t  packed_len;
+static uint8_t input[100000];
+static uint8_t unpacked[100000];
+
+static bool mem_sink(const uint8_t *data, size_t len, void *ctx) {
+    (void)ctx;
+    if (packed_len + len > sizeof(packed)) return false;
+    memcpy(packed + packed_len, data, len);
+    packed_len += len;
+    return true;
+}
+
+static bool failing_sink(const uint8_t *data, size_t len, void *ctx) {
+    (void)data;
+    (void)len;
+    (void)ctx;
+    return false;
+}
+
+/* Bit reader for the test inflater */
+static size_t bit_pos;
+
+static uint32_t get_bits(int n) {
+    uint32_t v = 0;
+    for (int i = 0; i < n; i++, bit_pos++) {
+        v |= (uint32_t)((packed[bit_pos >> 3] >> (bit_pos & 7)) & 1) << i;
+    }
+    return v;
+}
+
+static uint32_t get_code(int n) {
+    uint32_t v = 0;
+    for (int i = 0; i < n; i++) v = (v << 1) | get_bits(1);
+    return v;
+}
+
+/** Fixed-Huffman literal/length symbol. */
+static int get_litlen(void) {
+    uint32_t c = get_code(7);
+    if (c <= 0x17) return 256 + (int)c;
+    c = (c << 1) | get_bits(1);
+    if (c >= 0x30 && c <= 0xBF) return (int)(c - 0x30);
+    if (c >= 0xC0 && c <= 0xC7) return 280 + (int)(c - 0xC0);
+    c = (c << 1) | get_bits(1);
+    return 144 + (int)(c - 0x190);
+}
+
+/** Inflate the deflate stream after the 10-byte header; -1 on error. */
+static long inflate_fixed(void) {
+    static const uint16_t lbase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15,
+        17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195,
+        227, 258 };
+    static const uint8_t lextra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1,
+        2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    static const uint16_t dbase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33,
+        49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073,
+        4097, 6145, 8193, 12289, 16385, 24577 };
+    static const uint8_t dextra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4,
+        5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+    size_t out = 0;
+    bit_pos = 10 * 8;
+    for (;;) {
+        uint32_t final = get_bits(1);
+        if (get_bits(2) != 1) return -1;
+        for (;;) {
+            int sym = get_litlen();
+            if (sym < 256) {
+                if (out >= sizeof(unpacked)) return -1;
+                unpacked[out++] = (uint8_t)sym;
+            } else if (sym == 256) {
+                break;
+            } else {
+                int li = sym - 257;
+                size_t len = lbase[li] + get_bits(lextra[li]);
+                int di = (int)get_code(5);
+                size_t dist = dbase[di] + get_bits(dextra[di]);
+                if (dist > out || out + len > sizeof(unpacked)) return -1;
+                for (size_t k = 0; k < len; k++, out++) {
+                    unpacked[out] = unpacked[out - dist];
+                }
+            }
+        }
+        if (final) break;
+    }
+    bit_pos = (bit_pos + 7) & ~(size_t)7;
+    return (long)out;
+}
+
+static uint32_t le32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/** Compress `len` bytes of `input` in uneven pieces, then check round trip. */
+static void roundtrip(size_t len) {
+    packed_len = 0;
+    ASSERT_TRUE(gzip_writer_init(&gz, mem_sink, NULL));
+    size_t off = 0, piece = 1;
+    while (off < len) {
+        size_t n = (len - off < piece) ? len - off : piece;
+        ASSERT_TRUE(gzip_writer_write(&gz, input + off, n));
+        off += n;
+        piece = piece * 3 + 7;
+    }
+    ASSERT_TRUE(gzip_writer_finish(&gz));
+    ASSERT_EQ_INT((int)gz.bytes_out, (int)packed_len);
+
+    ASSERT_EQ_INT(packed[0], 0x1F);
+    ASSERT_EQ_INT(packed[1], 0x8B);
+    ASSERT_EQ_INT(packed[2], 8);
+
+    long n = inflate_fixed();
+    ASSERT_EQ_INT((int)n, (int)len);
+    ASSERT_TRUE(memcmp(unpacked, input, len) == 0);
+
+    /* Trailer: CRC-32 and length of the original */
+    ASSERT_EQ_INT((int)(bit_pos / 8 + 8), (int)packed_len);
+    ASSERT_TRUE(le32(packed + packed_len - 8) == crc32_update(0, input, len));
+    ASSERT_TRUE(le32(packed + packed_len - 4) == (uint32_t)len);
+}
+
+/* ── Test: empty input is a valid member ─────────────────── */
+
+static void test_empty(void) {
+    printf("  test_empty\n");
+    roundtrip(0);
+    ASSERT_EQ_INT((int)packed_len, 20);
+}
+
+/* ── Test: CSV-like text across several blocks ───────────── */
+
+static void test_text_blocks(void) {
+    printf("  test_text_blocks\n");
+    size_t len = 0;
+    for (int i = 0; len < sizeof(input) - 64; i++) {
+        len += (size_t)snprintf((char *)input + len, sizeof(input) - len,
+                                "vitals,%d,%d,%d,%d,36.%d\n",
+                                1700000000 + i * 60, 70 + (i * 7) % 9,
+                                95 + i % 4, 14 + i % 3, i % 10);
+    }
+    roundtrip(len);
+    ASSERT_TRUE(packed_len * 3 < len);
+}
+
+/* ── Test: long runs and incompressible bytes ────────────── */
+
+static void test_runs_and_noise(void) {
+    printf("  test_runs_and_noise\n");
+    memset(input, 'a', 40000);
+    roundtrip(40000);
+    ASSERT_TRUE(packed_len < 400);
+
+    uint32_t x = 12345;
+    for (size_t i = 0; i < 30000; i++) {
+        x = x * 1103515245u + 12345u;
+        input[i] = (uint8_t)(x >> 16);
+    }
+    roundtrip(30000);
+}
+
+/* ── Test: a failing sink is reported ────────────────────── */
+
+static void test_sink_failure(void) {
+    printf("  test_sink_failure\n");
+    ASSERT_FALSE(gzip_writer_init(&gz, NULL, NULL));
+
+    gzip_writer_init(&gz, failing_sink, NULL);
+    memset(input, 'x', GZIP_WRITER_BLOCK * 3);
+    gzip_writer_write(&gz, input, GZIP_WRITER_BLOCK * 3);
+    ASSERT_FALSE(gzip_writer_finish(&gz));
+}
+
+/* ── Public entry point ──────────────────────────────────── */
+
+void test_gzip_writer(void) {
+    test_empty();
+    test_text_blocks();
+    test_runs_and_noise();
+    test_sink_failure();
+}
@@ -0,0 +1,206 @@
+/**
+ * @file test_input_script.c
+ * @brief Unit tests for input_script module
+ *
+ * Tests parsing (steps, labels, comments, repeat, errors), tap and drag
+ * playback with their triggers, phases that are never skipped however
+ * late the sample, and repeated passes.
+ */
+
+#include "test_framework.h"
+#include "input_script.h"
+
+static input_script_t script;
+
+/* ── Test: parse steps, labels and comments ──────────────── */
+
+static void test_parse(void) {
+    printf("  test_parse\n");
+    int err = -1;
+    const char *text =
+        "# Navigation\n"
+        "\n"
+        "repeat 3\n"
+        "wait 250\n"
+        "tap 352 456 open_trends   # Trends tab\n"
+        "tap 10 20\n"
+        "drag 400 200 200 210 300 pan_trends_press_feedback\n";
+    ASSERT_TRUE(input_script_parse(&script, text, &err));
+    ASSERT_EQ_INT(err, 0);
+    ASSERT_EQ_INT(script.repeat, 3);
+    ASSERT_EQ_INT(script.step_count, 4);
+
+    ASSERT_EQ_INT(script.steps[0].kind, INPUT_STEP_WAIT);
+    ASSERT_EQ_INT((int)script.steps[0].ms, 250);
+
+    ASSERT_EQ_INT(script.steps[1].kind, INPUT_STEP_TAP);
+    ASSERT_EQ_INT(script.steps[1].x0, 352);
+    ASSERT_EQ_INT(script.steps[1].y0, 456);
+    ASSERT_STR_EQ(script.steps[1].label, "open_trends");
+
+    ASSERT_STR_EQ(script.steps[2].label, "");
+
+    ASSERT_EQ_INT(script.steps[3].kind, INPUT_STEP_DRAG);
+    ASSERT_EQ_INT(script.steps[3].x1, 200);
+    ASSERT_EQ_INT(script.steps[3].y1, 210);
+    ASSERT_EQ_INT((int)script.steps[3].ms, 300);
+    ASSERT_STR_EQ(script.steps[3].label, "pan_trends_press_feedback");
+}
+
+/* ── Test: syntax errors report their line ───────────────── */
+
+static void test_parse_errors(void) {
+    printf("  test_parse_errors\n");
+    int err = 0;
+    ASSERT_FALSE(input_script_parse(&script, "wait 10\nswipe 1 2\n", &err));
+    ASSERT_EQ_INT(err, 2);
+    ASSERT_EQ_INT(script.step_count, 0);
+
+    ASSERT_FALSE(input_script_parse(&script, "tap 5\n", &err));
+    ASSERT_EQ_INT(err, 1);
+    ASSERT_FALSE(input_script_parse(&script, "wait -1\n", &err));
+    ASSERT_FALSE(input_script_parse(&script, "repeat 0\n", &err));
+    ASSERT_FALSE(input_script_parse(&script, NULL, &err));
+
+    /* Too many steps */
+    static char big[(INPUT_SCRIPT_MAX_STEPS + 1) * 8 + 1];
+    big[0] = '\0';
+    for (int i = 0; i <= INPUT_SCRIPT_MAX_STEPS; i++) strcat(big, "wait 1\n");
+    ASSERT_FALSE(input_script_parse(&script, big, &err));
+    ASSERT_EQ_INT(err, INPUT_SCRIPT_MAX_STEPS + 1);
+}
+
+/* ── Test: tap presses, releases and triggers on release ─── */
+
+static void test_tap(void) {
+    printf("  test_tap\n");
+    ASSERT_TRUE(input_script_parse(&script, "tap 100 50 ack\n", NULL));
+    input_script_start(&script, 1000);
+
+    input_point_t p;
+    const char *trig = "x";
+    ASSERT_TRUE(input_script_sample(&script, 1000, &p, &trig));
+    ASSERT_TRUE(p.pressed);
+    ASSERT_EQ_INT(p.x, 100);
+    ASSERT_EQ_INT(p.y, 50);
+    ASSERT_TRUE(trig == NULL);
+
+    ASSERT_TRUE(input_script_sample(&script, 1030, &p, &trig));
+    ASSERT_TRUE(p.pressed);
+
+    /* Release: the trigger, reported once */
+    ASSERT_TRUE(input_script_sample(&script, 1000 + INPUT_SCRIPT_PRESS_MS, &p, &trig));
+    ASSERT_FALSE(p.pressed);
+    ASSERT_TRUE(trig != NULL);
+    ASSERT_STR_EQ(trig, "ack");
+    ASSERT_TRUE(input_script_sample(&script, 1070, &p, &trig));
+    ASSERT_TRUE(trig == NULL);
+
+    /* Finished after the gap; pointer stays up where it was */
+    ASSERT_FALSE(input_script_sample(&script, 1200, &p, &trig));
+    ASSERT_FALSE(p.pressed);
+    ASSERT_EQ_INT(p.x, 100);
+    ASSERT_TRUE(input_script_done(&script));
+}
+
+/* ── Test: a late sample never skips a press ─────────────── */
+
+static void test_no_skip(void) {
+    printf("  test_no_skip\n");
+    ASSERT_TRUE(input_script_parse(&script,
+        "tap 1 1 a\n"
+        "tap 2 2 b\n", NULL));
+    input_script_start(&script, 0);
+
+    input_point_t p;
+    const char *trig;
+    /* Each sample arrives far too late, yet every phase is seen in order */
+    ASSERT_TRUE(input_script_sample(&script, 0, &p, &trig));
+    ASSERT_TRUE(p.pressed && p.x == 1);
+    ASSERT_TRUE(input_script_sample(&script, 5000, &p, &trig));
+    ASSERT_TRUE(!p.pressed && p.x == 1);
+    ASSERT_STR_EQ(trig, "a");
+    ASSERT_TRUE(input_script_sample(&script, 10000, &p, &trig));
+    ASSERT_TRUE(p.pressed && p.x == 2);
+    ASSERT_TRUE(input_script_sample(&script, 15000, &p, &trig));
+    ASSERT_TRUE(!p.pressed && p.x == 2);
+    ASSERT_STR_EQ(trig, "b");
+    ASSERT_FALSE(input_script_sample(&script, 20000, &p, &trig));
+}
+
+/* ── Test: drag interpolates and triggers on first move ──── */
+
+static void test_drag(void) {
+    printf("  test_drag\n");
+    ASSERT_TRUE(input_script_parse(&script, "drag 400 200 200 300 100 pan\n", NULL));
+    input_script_start(&script, 0);
+
+    input_point_t p;
+    const char *trig;
+    ASSERT_TRUE(input_script_sample(&script, 0, &p, &trig));
+    ASSERT_TRUE(p.pressed && p.x == 400 && p.y == 200);
+
+    /* Move phase starts here: still at the start point, no trigger yet */
+    uint32_t t = INPUT_SCRIPT_PRESS_MS;
+    ASSERT_TRUE(input_script_sample(&script, t, &p, &trig));
+    ASSERT_TRUE(p.pressed && p.x == 400);
+    ASSERT_TRUE(trig == NULL);
+
+    ASSERT_TRUE(input_script_sample(&script, t + 50, &p, &trig));
+    ASSERT_TRUE(p.pressed);
+    ASSERT_EQ_INT(p.x, 300);
+    ASSERT_EQ_INT(p.y, 250);
+    ASSERT_STR_EQ(trig, "pan");
+
+    ASSERT_TRUE(input_script_sample(&script, t + 99, &p, &trig));
+    ASSERT_TRUE(trig == NULL);
+
+    /* Release at the end point */
+    ASSERT_TRUE(input_script_sample(&script, t + 100, &p, &trig));
+    ASSERT_FALSE(p.pressed);
+    ASSERT_EQ_INT(p.x, 200);
+    ASSERT_EQ_INT(p.y, 300);
+    ASSERT_FALSE(input_script_sample(&script, t + 1000, &p, &trig));
+}
+
+/* ── Test: repeat runs every pass, wait keeps pointer up ─── */
+
+static void test_repeat(void) {
+    printf("  test_repeat\n");
+    ASSERT_TRUE(input_script_parse(&script,
+        "repeat 3\n"
+        "wait 100\n"
+        "tap 5 5 t\n", NULL));
+    input_script_start(&script, 0);
+
+    input_point_t p;
+    const char *trig;
+    int triggers = 0;
+    int samples = 0;
+    for (uint32_t now = 0; samples < 1000; now += 10, samples++) {
+        bool more = input_script_sample(&script, now, &p, &trig);
+        if (trig) triggers++;
+        if (!more) break;
+    }
+    ASSERT_EQ_INT(triggers, 3);
+    ASSERT_TRUE(input_script_done(&script));
+    /* Three passes of 100 + PRESS + GAP ms, sampled every 10 ms */
+    ASSERT_TRUE(samples * 10 >= 3 * (100 + INPUT_SCRIPT_PRESS_MS + INPUT_SCRIPT_GAP_MS));
+
+    /* Restart plays it again */
+    input_script_start(&script, 0);
+    ASSERT_FALSE(input_script_done(&script));
+    ASSERT_TRUE(input_script_sample(&script, 0, &p, &trig));
+    ASSERT_FALSE(p.pressed);
+}
+
+/* ── Suite entry point ───────────────────────────────────── */
+
+void test_input_script(void) {
+    test_parse();
+    test_parse_errors();
+    test_tap();
+    test_no_skip();
+    test_drag();
+    test_repeat();
+}
@@ -0,0 +1,159 @@
+/**
+ * @file test_job_pool.c
+ * @brief Unit tests for job_pool module
+ *
+ * Tests submission before init, run/done hand-off to the dispatching
+ * thread, priority ordering, slot exhaustion, and completion delivery
+ * during shutdown.
+ */
+
+#include "test_framework.h"
+#include "job_pool.h"
+#include <pthread.h>
+#include <unistd.h>
+
+/* ── Test fixtures ───────────────────────────────────────── */
+
+static volatile int gate_open = 0;
+static int  run_order[8];
+static int  run_order_count = 0;
+static int  done_count = 0;
+static bool done_on_main = true;
+static pthread_t main_thread;
+static pthread_mutex_t order_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void reset_fixtures(void) {
+    gate_open = 0;
+    run_order_count = 0;
+    done_count = 0;
+    done_on_main = true;
+    main_thread = pthread_self();
+}
+
+/** Blocks its worker until gate_open is set. */
+static void gate_run(void *arg) {
+    (void)arg;
+    while (!__atomic_load_n(&gate_open, __ATOMIC_ACQUIRE)) {
+        usleep(1000);
+    }
+}
+
+static void record_run(void *arg) {
+    pthread_mutex_lock(&order_lock);
+    if (run_order_count < 8) {
+        run_order[run_order_count++] = (int)(intptr_t)arg;
+    }
+    pthread_mutex_unlock(&order_lock);
+}
+
+static void count_done(void *arg) {
+    (void)arg;
+    done_count++;
+    if (!pthread_equal(pthread_self(), main_thread)) done_on_main = false;
+}
+
+/** Dispatch completions until `n` have arrived or ~2 s elapsed. */
+static bool wait_for_done(int n) {
+    for (int i = 0; i < 2000 && done_count < n; i++) {
+        job_pool_dispatch_completions();
+        if (done_count < n) usleep(1000);
+    }
+    return done_count >= n;
+}
+
+/* ── Test: submit is rejected when not running ───────────── */
+
+static void test_submit_not_running(void) {
+    printf("  test_submit_not_running\n");
+    reset_fixtures();
+
+    ASSERT_FALSE(job_pool_is_running());
+    ASSERT_FALSE(job_pool_submit(JOB_PRIO_HIGH, record_run, count_done, NULL));
+    ASSERT_EQ_INT(job_pool_dispatch_completions(), 0);
+}
+
+/* ── Test: run on worker, done on dispatching thread ─────── */
+
+static void test_run_and_done(void) {
+    printf("  test_run_and_done\n");
+    reset_fixtures();
+
+    ASSERT_TRUE(job_pool_init(0));
+    ASSERT_TRUE(job_pool_is_running());
+
+    for (int i = 0; i < 5; i++) {
+        ASSERT_TRUE(job_pool_submit(JOB_PRIO_LOW, record_run, count_done,
+                                    (void *)(intptr_t)i));
+    }
+
+    ASSERT_TRUE(wait_for_done(5));
+    ASSERT_EQ_INT(run_order_count, 5);
+    ASSERT_TRUE(done_on_main);
+    ASSERT_EQ_INT(job_pool_outstanding(), 0);
+
+    job_pool_stats_t st = job_pool_get_stats();
+    ASSERT_EQ_INT(st.submitted, 5);
+    ASSERT_EQ_INT(st.completed, 5);
+
+    job_pool_deinit();
+    ASSERT_FALSE(job_pool_is_running());
+}
+
+/* ── Test: HIGH jobs run before queued LOW jobs ──────────── */
+
+static void test_priority_order(void) {
+    printf("  test_priority_order\n");
+    reset_fixtures();
+
+    ASSERT_TRUE(job_pool_init(1));
+
+    /* Occupy the only worker, then queue LOW before HIGH */
+    ASSERT_TRUE(job_pool_submit(JOB_PRIO_LOW, gate_run, count_done, NULL));
+    usleep(20000);
+    ASSERT_TRUE(job_pool_submit(JOB_PRIO_LOW,  record_run, count_done, (void *)1));
+    ASSERT_TRUE(job_pool_submit(JOB_PRIO_LOW,  record_run, count_done, (void *)2));
+    ASSERT_TRUE(job_pool_submit(JOB_PRIO_HIGH, record_run, count_done, (void *)3));
+
+    __atomic_store_n(&gate_open, 1, __ATOMIC_RELEASE);
+    ASSERT_TRUE(wait_for_done(4));
+
+    ASSERT_EQ_INT(run_order_count, 3);
+    ASSERT_EQ_INT(run_order[0], 3);
+    ASSERT_EQ_INT(run_order[1], 1);
+    ASSERT_EQ_INT(run_order[2], 2);
+
+    job_pool_deinit();
+}
+
+/* ── Test: slot exhaustion rejects further jobs ──────────── */
+
+static void test_pool_full(void) {
+    printf("  test_pool_full\n");
+    reset_fixtures();
+
+    ASSERT_TRUE(job_pool_init(1));
+
+    ASSERT_TRUE(job_pool_submit(JOB_PRIO_LOW, gate_run, count_done, NULL));
+    for (int i = 1; i < JOB_POOL_MAX_JOBS; i++) {
+        ASSERT_TRUE(job_pool_submit(JOB_PRIO_LOW, record_run, NULL, NULL));
+    }
+    ASSERT_FALSE(job_pool_submit(JOB_PRIO_HIGH, record_run, NULL, NULL));
+    ASSERT_EQ_INT(job_pool_get_stats().rejected, 1);
+    ASSERT_EQ_INT(job_pool_outstanding(), JOB_POOL_MAX_JOBS);
+
+    __atomic_store_n(&gate_open, 1, __ATOMIC_RELEASE);
+
+    /* Shutdown runs the queued jobs and dispatches their completions */
+    job_pool_deinit();
+    ASSERT_EQ_INT(done_count, 1);
+    ASSERT_EQ_INT(job_pool_outstanding(), 0);
+}
+
+/* ── Public entry point ──────────────────────────────────── */
+
+void test_job_pool(void) {
+    test_submit_not_running();
+    test_run_and_done();
+    test_priority_order();
+    test_pool_full();
+}
@@ -0,0 +1,83 @@
+/**
+ * @file test_latency_hist.c
+ * @brief Unit tests for latency_hist module
+ *
+ * Tests the empty histogram, exact min/max/mean, percentile bounds on a
+ * uniform spread, and values at the top of the range.
+ */
+
+#include "test_framework.h"
+#include "latency_hist.h"
+
+static latency_hist_t h;
+
+/* ── Test: empty histogram ───────────────────────────────── */
+
+static void test_empty(void) {
+    printf("  test_empty\n");
+    latency_hist_reset(&h);
+    ASSERT_EQ_INT(h.count, 0);
+    ASSERT_EQ_INT(latency_hist_percentile(&h, 50), 0);
+    ASSERT_EQ_INT(latency_hist_mean(&h), 0);
+}
+
+/* ── Test: small values are exact ────────────────────────── */
+
+static void test_exact_small(void) {
+    printf("  test_exact_small\n");
+    latency_hist_reset(&h);
+    latency_hist_add(&h, 3);
+    latency_hist_add(&h, 1);
+    latency_hist_add(&h, 2);
+
+    ASSERT_EQ_INT(h.count, 3);
+    ASSERT_EQ_INT(h.min_us, 1);
+    ASSERT_EQ_INT(h.max_us, 3);
+    ASSERT_EQ_INT(latency_hist_mean(&h), 2);
+    ASSERT_EQ_INT(latency_hist_percentile(&h, 0), 1);
+    ASSERT_EQ_INT(latency_hist_percentile(&h, 50), 2);
+    ASSERT_EQ_INT(latency_hist_percentile(&h, 100), 3);
+}
+
+/* ── Test: percentiles within one bucket (25 %) ──────────── */
+
+static void test_percentile_bounds(void) {
+    printf("  test_percentile_bounds\n");
+    latency_hist_reset(&h);
+    for (uint32_t us = 1; us <= 10000; us++) {
+        latency_hist_add(&h, us);
+    }
+
+    static const unsigned pcts[] = { 50, 90, 95, 99 };
+    for (int i = 0; i < 4; i++) {
+        uint32_t exact = 100u * pcts[i];
+        uint32_t got = latency_hist_percentile(&h, pcts[i]);
+        /* Reported as its bucket's upper bound: never below, < 25 % above */
+        ASSERT_GE_INT((int)got, (int)exact);
+        ASSERT_TRUE(got <= exact + exact / 4);
+    }
+    ASSERT_EQ_INT(latency_hist_percentile(&h, 100), 10000);
+    ASSERT_EQ_INT(latency_hist_mean(&h), 5000);
+}
+
+/* ── Test: top of the range ──────────────────────────────── */
+
+static void test_large_values(void) {
+    printf("  test_large_values\n");
+    latency_hist_reset(&h);
+    latency_hist_add(&h, UINT32_MAX);
+    latency_hist_add(&h, 0x80000000u);
+
+    ASSERT_TRUE(h.max_us == UINT32_MAX);
+    ASSERT_TRUE(latency_hist_percentile(&h, 100) == UINT32_MAX);
+    ASSERT_TRUE(latency_hist_percentile(&h, 50) >= 0x80000000u);
+}
+
+/* ── Public entry point ──────────────────────────────────── */
+
+void test_latency_hist(void) {
+    test_empty();
+    test_exact_small();
+    test_percentile_bounds();
+    test_large_values();
+}
@@ -0,0 +1,137 @@
+/**
+ * @file test_mem_report.c
+ * @brief Unit tests for mem_report module
+ *
+ * Tests region classification of a recorded smaps file (executable image,
+ * data and the .bss mapping after it, heap, thread stacks, libraries,
+ * shared memory), the peak from a status file, and a live sample of this
+ * process.
+ */
+
+#include "test_framework.h"
+#include "mem_report.h"
+#include "mem_budget.h"
+#include <stdio.h>
+
+#define SMAPS_PATH  "/tmp/test_mem_report.smaps"
+#define STATUS_PATH "/tmp/test_mem_report.status"
+#define EXE         "/opt/vitals-monitor/bin/vitals-ui"
+
+static void write_file(const char *path, const char *text) {
+    FILE *f = fopen(path, "w");
+    if (f) {
+        fputs(text, f);
+        fclose(f);
+    }
+}
+
+/* ── Test: mappings are summed by region ─────────────────── */
+
+static void test_parse_regions(void) {
+    printf("  test_parse_regions\n");
+    write_file(SMAPS_PATH,
+        "00400000-00500000 r-xp 00000000 b3:02 1234   " EXE "\n"
+        "Size:               1024 kB\n"
+        "Rss:                 800 kB\n"
+        "AnonHugePages:         0 kB\n"
+        "00500000-00510000 rw-p 00100000 b3:02 1234   " EXE "\n"
+        "Rss:                  40 kB\n"
+        "00510000-00600000 rw-p 00000000 00:00 0 \n"
+        "Rss:                 900 kB\n"
+        "01000000-02000000 rw-p 00000000 00:00 0      [heap]\n"
+        "Rss:                3000 kB\n"
+        "7f000000-7f800000 rw-p 00000000 00:00 0 \n"
+        "Rss:                  64 kB\n"
+        "7f900000-7fa00000 r-xp 00000000 b3:02 99     /usr/lib/libSDL2-2.0.so.0.2800.5\n"
+        "Rss:                 500 kB\n"
+        "7fb00000-7fb01000 rw-s 00000000 00:18 7      /dev/shm/vitals_status (deleted)\n"
+        "Rss:                   4 kB\n"
+        "7fc00000-7fc01000 rw-s 00000000 b3:02 55     /data/vitals_trends.db-shm\n"
+        "Rss:                  32 kB\n"
+        "7ffd0000-7fff0000 rw-p 00000000 00:00 0      [stack]\n"
+        "Rss:                  24 kB\n"
+        "VmFlags: rd wr mr mw me gd ac\n");
+    write_file(STATUS_PATH,
+        "Name:\tvitals-ui\n"
+        "VmPeak:\t  200000 kB\n"
+        "VmHWM:\t    6000 kB\n"
+        "VmRSS:\t    5364 kB\n");
+
+    mem_report_t r;
+    ASSERT_TRUE(mem_report_parse(SMAPS_PATH, STATUS_PATH, EXE, &r));
+    ASSERT_EQ_INT((int)r.rss_kb[MEM_REGION_IMAGE], 800);
+    ASSERT_EQ_INT((int)r.rss_kb[MEM_REGION_STATIC], 940);    /* .data + .bss */
+    ASSERT_EQ_INT((int)r.rss_kb[MEM_REGION_HEAP], 3000);
+    ASSERT_EQ_INT((int)r.rss_kb[MEM_REGION_ANON], 64);
+    ASSERT_EQ_INT((int)r.rss_kb[MEM_REGION_LIBS], 500);
+    ASSERT_EQ_INT((int)r.rss_kb[MEM_REGION_SHM], 4);
+    ASSERT_EQ_INT((int)r.rss_kb[MEM_REGION_OTHER], 32);
+    ASSERT_EQ_INT((int)r.rss_kb[MEM_REGION_STACK], 24);
+    ASSERT_EQ_INT((int)r.rss_total_kb, 5364);
+    ASSERT_EQ_INT((int)r.rss_peak_kb, 6000);
+
+    /* Without the executable path its mappings are just files / anon */
+    ASSERT_TRUE(mem_report_parse(SMAPS_PATH, NULL, NULL, &r));
+    ASSERT_EQ_INT((int)r.rss_kb[MEM_REGION_STATIC], 0);
+    ASSERT_EQ_INT((int)r.rss_kb[MEM_REGION_OTHER], 800 + 40 + 32);
+    ASSERT_EQ_INT((int)r.rss_kb[MEM_REGION_ANON], 900 + 64);
+    ASSERT_EQ_INT((int)r.rss_peak_kb, 0);
+
+    remove(SMAPS_PATH);
+    remove(STATUS_PATH);
+}
+
+/* ── Test: missing file ──────────────────────────────────── */
+
+static void test_parse_missing(void) {
+    printf("  test_parse_missing\n");
+    mem_report_t r;
+    ASSERT_FALSE(mem_report_parse("/tmp/no_such_smaps", NULL, NULL, &r));
+    ASSERT_EQ_INT((int)r.rss_total_kb, 0);
+}
+
+/* ── Test: live sample of this process ───────────────────── */
+
+static void test_sample_self(void) {
+    printf("  test_sample_self\n");
+    /* SQLite is already initialised by earlier suites unless run alone */
+    bool tracked = mem_report_track_sqlite();
+
+    mem_report_t r;
+    bool ok = mem_report_sample(&r);
+#ifdef __linux__
+    ASSERT_TRUE(ok);
+    ASSERT_TRUE(r.rss_total_kb > 0);
+    ASSERT_TRUE(r.rss_kb[MEM_REGION_IMAGE] > 0);
+    ASSERT_TRUE(r.rss_peak_kb >= r.rss_total_kb / 2);
+#else
+    (void)ok;
+#endif
+    if (tracked) {
+        ASSERT_TRUE(r.sqlite_used >= 0);
+    } else {
+        ASSERT_TRUE(r.sqlite_used == -1);
+    }
+    mem_report_print(&r, "mem");
+}
+
+/* ── Test: region names and budget arithmetic ────────────── */
+
+static void test_names_and_budgets(void) {
+    printf("  test_names_and_budgets\n");
+    ASSERT_STR_EQ(mem_report_region_name(MEM_REGION_STATIC), "static");
+    ASSERT_STR_EQ(mem_report_region_name(MEM_REGION_OTHER), "other");
+    ASSERT_STR_EQ(mem_report_region_name(MEM_REGION_COUNT), "?");
+
+    /* Static budgets leave most of the process limit for heap and stacks */
+    ASSERT_TRUE(MEM_BUDGET_STATIC_TOTAL / 1024 < MEM_BUDGET_PROCESS_KB / 8);
+}
+
+/* ── Suite entry point ───────────────────────────────────── */
+
+void test_mem_report(void) {
+    test_parse_regions();
+    test_parse_missing();
+    test_sample_self();
+    test_names_and_budgets();
+}
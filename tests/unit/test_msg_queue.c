@@ -0,0 +1,145 @@
+/**
+ * @file test_msg_queue.c
+ * @brief Unit tests for msg_queue module
+ *
+ * Tests FIFO order across wrap-around, rejection when full, counters,
+ * and hand-off between a producer thread and the consumer.
+ */
+
+#include "test_framework.h"
+#include "msg_queue.h"
+#include <pthread.h>
+#include <unistd.h>
+
+/* ── Test fixtures ───────────────────────────────────────── */
+
+typedef struct {
+    int  seq;
+    char tag[12];
+} test_msg_t;
+
+#define QUEUE_LEN   4
+
+static msg_queue_t q;
+static test_msg_t  q_buf[QUEUE_LEN];
+
+/* ── Test: invalid arguments ─────────────────────────────── */
+
+static void test_init_invalid(void) {
+    printf("  test_init_invalid\n");
+    ASSERT_FALSE(msg_queue_init(&q, NULL, sizeof(test_msg_t), QUEUE_LEN));
+    ASSERT_FALSE(msg_queue_init(&q, q_buf, 0, QUEUE_LEN));
+    ASSERT_FALSE(msg_queue_init(&q, q_buf, sizeof(test_msg_t), 0));
+}
+
+/* ── Test: FIFO order, including wrap-around ─────────────── */
+
+static void test_fifo_wrap(void) {
+    printf("  test_fifo_wrap\n");
+    ASSERT_TRUE(msg_queue_init(&q, q_buf, sizeof(test_msg_t), QUEUE_LEN));
+
+    test_msg_t m = { 0, "" };
+    int next_in = 0;
+    int next_out = 0;
+    for (int round = 0; round < 5; round++) {
+        for (int i = 0; i < 3; i++) {
+            m.seq = next_in++;
+            snprintf(m.tag, sizeof(m.tag), "m%d", m.seq);
+            ASSERT_TRUE(msg_queue_push(&q, &m));
+        }
+        ASSERT_EQ_INT(msg_queue_count(&q), 3);
+        for (int i = 0; i < 3; i++) {
+            test_msg_t out;
+            ASSERT_TRUE(msg_queue_pop(&q, &out));
+            ASSERT_EQ_INT(out.seq, next_out);
+            next_out++;
+        }
+    }
+
+    test_msg_t out;
+    ASSERT_FALSE(msg_queue_pop(&q, &out));
+    ASSERT_EQ_INT(msg_queue_count(&q), 0);
+    msg_queue_destroy(&q);
+}
+
+/* ── Test: full queue drops and counts ───────────────────── */
+
+static void test_full_drops(void) {
+    printf("  test_full_drops\n");
+    ASSERT_TRUE(msg_queue_init(&q, q_buf, sizeof(test_msg_t), QUEUE_LEN));
+
+    test_msg_t m = { 0, "x" };
+    for (int i = 0; i < QUEUE_LEN; i++) {
+        m.seq = i;
+        ASSERT_TRUE(msg_queue_push(&q, &m));
+    }
+    m.seq = 99;
+    ASSERT_FALSE(msg_queue_push(&q, &m));
+    ASSERT_FALSE(msg_queue_push(&q, &m));
+
+    msg_queue_stats_t st = msg_queue_get_stats(&q);
+    ASSERT_EQ_INT(st.pushed, QUEUE_LEN);
+    ASSERT_EQ_INT(st.dropped, 2);
+    ASSERT_EQ_INT(st.high_water, QUEUE_LEN);
+
+    /* Oldest message is still first; the dropped one never appears */
+    test_msg_t out;
+    ASSERT_TRUE(msg_queue_pop(&q, &out));
+    ASSERT_EQ_INT(out.seq, 0);
+    ASSERT_TRUE(msg_queue_push(&q, &m));
+    int last = -1;
+    while (msg_queue_pop(&q, &out)) last = out.seq;
+    ASSERT_EQ_INT(last, 99);
+    ASSERT_EQ_INT(msg_queue_get_stats(&q).popped, QUEUE_LEN + 1);
+
+    msg_queue_destroy(&q);
+    ASSERT_FALSE(msg_queue_push(&q, &m));
+}
+
+/* ── Test: producer thread to consumer ───────────────────── */
+
+#define XFER_COUNT  2000
+
+static void *producer(void *arg) {
+    (void)arg;
+    test_msg_t m = { 0, "p" };
+    for (int i = 0; i < XFER_COUNT; i++) {
+        m.seq = i;
+        while (!msg_queue_push(&q, &m)) usleep(100);
+    }
+    return NULL;
+}
+
+static void test_cross_thread(void) {
+    printf("  test_cross_thread\n");
+    ASSERT_TRUE(msg_queue_init(&q, q_buf, sizeof(test_msg_t), QUEUE_LEN));
+
+    pthread_t t;
+    ASSERT_EQ_INT(pthread_create(&t, NULL, producer, NULL), 0);
+
+    int expected = 0;
+    bool in_order = true;
+    while (expected < XFER_COUNT) {
+        test_msg_t out;
+        if (msg_queue_pop(&q, &out)) {
+            if (out.seq != expected) in_order = false;
+            expected++;
+        } else {
+            usleep(50);
+        }
+    }
+    pthread_join(t, NULL);
+
+    ASSERT_TRUE(in_order);
+    ASSERT_EQ_INT(msg_queue_get_stats(&q).popped, XFER_COUNT);
+    msg_queue_destroy(&q);
+}
+
+/* ── Public entry point ──────────────────────────────────── */
+
+void test_msg_queue(void) {
+    test_init_invalid();
+    test_fifo_wrap();
+    test_full_drops();
+    test_cross_thread();
+}
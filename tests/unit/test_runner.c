@@ -19,6 +19,26 @@ extern void test_patient_data(void);
 extern void test_settings_store(void);
 extern void test_auth_manager(void);
 extern void test_audit_log(void);
+extern void test_status_board(void);
+extern void test_job_pool(void);
+extern void test_trend_lttb(void);
+extern void test_trend_raw_pack(void);
+extern void test_crc32(void);
+extern void test_trend_segment(void);
+extern void test_gzip_writer(void);
+extern void test_startup(void);
+extern void test_db_schema(void);
+extern void test_msg_queue(void);
+extern void test_latency_hist(void);
+extern void test_data_thread(void);
+extern void test_vclock(void);
+extern void test_input_script(void);
+extern void test_mem_report(void);
+extern void test_tlsf(void);
+extern void test_ui_heap(void);
+extern void test_glyph_cache(void);
+extern void test_tile_codec(void);
+extern void test_screen_stream(void);
 
 int main(void) {
     printf("========================================\n");
@@ -30,6 +50,26 @@ int main(void) {
     RUN_SUITE(test_settings_store);
     RUN_SUITE(test_auth_manager);
     RUN_SUITE(test_audit_log);
+    RUN_SUITE(test_status_board);
+    RUN_SUITE(test_job_pool);
+    RUN_SUITE(test_trend_lttb);
+    RUN_SUITE(test_trend_raw_pack);
+    RUN_SUITE(test_crc32);
+    RUN_SUITE(test_trend_segment);
+    RUN_SUITE(test_gzip_writer);
+    RUN_SUITE(test_startup);
+    RUN_SUITE(test_db_schema);
+    RUN_SUITE(test_msg_queue);
+    RUN_SUITE(test_latency_hist);
+    RUN_SUITE(test_data_thread);
+    RUN_SUITE(test_vclock);
+    RUN_SUITE(test_input_script);
+    RUN_SUITE(test_mem_report);
+    RUN_SUITE(test_tlsf);
+    RUN_SUITE(test_ui_heap);
+    RUN_SUITE(test_glyph_cache);
+    RUN_SUITE(test_tile_codec);
+    RUN_SUITE(test_screen_stream);
 
     TEST_SUMMARY();
 
@@ -0,0 +1,238 @@
+/**
+ * @file test_screen_stream.c
+ * @brief Unit tests for screen_stream module
+ *
+ * Tests the full screen sent to a new viewer, only changed tiles after
+ * that, catching up after the socket backs up, viewer disconnect, and a
+ * viewer connecting over TCP.  The viewer side uses the module's own
+ * parse functions on a socketpair.
+ */
+
+#include "test_framework.h"
+#include "screen_stream.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/* ── Test fixtures ───────────────────────────────────────── */
+
+/* 3 x 2 tiles, the last column and row partial */
+#define W 40
+#define H 24
+
+static screen_stream_t stream;
+static uint32_t        fb[W * H];
+static uint16_t        mirror[W * H];
+static uint8_t         rx[256 * 1024];
+static size_t          rx_len;
+static int             viewer_fd = -1;
+static uint16_t        hello_w, hello_h;
+
+static void setup(void) {
+    ASSERT_TRUE(screen_stream_init(&stream, W, H));
+    for (int i = 0; i < W * H; i++) fb[i] = 0x0A0A0A;
+    memset(mirror, 0, sizeof(mirror));
+    rx_len = 0;
+    hello_w = hello_h = 0;
+
+    int sv[2];
+    ASSERT_EQ_INT(socketpair(AF_UNIX, SOCK_STREAM, 0, sv), 0);
+    viewer_fd = sv[1];
+    screen_stream_attach(&stream, sv[0]);
+}
+
+static void teardown(void) {
+    screen_stream_close(&stream);
+    if (viewer_fd >= 0) close(viewer_fd);
+    viewer_fd = -1;
+}
+
+/** Read what has arrived and apply whole messages; tiles applied or -1. */
+static int receive(void) {
+    for (;;) {
+        ssize_t n = recv(viewer_fd, rx + rx_len, sizeof(rx) - rx_len, MSG_DONTWAIT);
+        if (n <= 0) break;
+        rx_len += (size_t)n;
+    }
+
+    int tiles = 0;
+    size_t off = 0;
+    while (rx_len - off >= SCREEN_STREAM_HDR_BYTES) {
+        uint8_t type;
+        uint32_t len;
+        if (!screen_stream_parse_header(rx + off, &type, &len)) return -1;
+        if (rx_len - off < SCREEN_STREAM_HDR_BYTES + len) break;
+
+        const uint8_t *p = rx + off + SCREEN_STREAM_HDR_BYTES;
+        if (type == SCREEN_STREAM_MSG_HELLO) {
+            if (!screen_stream_parse_hello(p, len, &hello_w, &hello_h)) return -1;
+        } else {
+            int t = screen_stream_apply_frame(p, len, mirror, W, H);
+            if (t < 0) return -1;
+            tiles += t;
+        }
+        off += SCREEN_STREAM_HDR_BYTES + len;
+    }
+    memmove(rx, rx + off, rx_len - off);
+    rx_len -= off;
+    return tiles;
+}
+
+static bool mirror_matches(void) {
+    for (int i = 0; i < W * H; i++) {
+        if (mirror[i] != tile_rgb565(fb[i])) return false;
+    }
+    return true;
+}
+
+/** Redraw of the whole screen, as LVGL reports it. */
+static void frame(void) {
+    screen_stream_capture(&stream, fb, W, 0, 0, W - 1, H - 1);
+    screen_stream_frame_end(&stream, fb, W);
+}
+
+/* ── Test: a new viewer gets the whole screen ────────────── */
+
+static void test_full_screen(void) {
+    printf("  test_full_screen\n");
+    setup();
+    fb[W * 20 + 35] = 0x00CC00;
+
+    ASSERT_TRUE(screen_stream_connected(&stream));
+    screen_stream_frame_end(&stream, fb, W);
+    ASSERT_EQ_INT(receive(), 6);
+    ASSERT_EQ_INT(hello_w, W);
+    ASSERT_EQ_INT(hello_h, H);
+    ASSERT_TRUE(mirror_matches());
+
+    screen_stream_stats_t st = screen_stream_get_stats(&stream);
+    ASSERT_EQ_INT(st.connects, 1);
+    ASSERT_EQ_INT(st.frames_sent, 1);
+    ASSERT_EQ_INT(st.tiles_sent, 6);
+    ASSERT_EQ_INT(stream.capture_hist.count, 1);
+    teardown();
+}
+
+/* ── Test: then only what changed ────────────────────────── */
+
+static void test_only_changes(void) {
+    printf("  test_only_changes\n");
+    setup();
+    screen_stream_frame_end(&stream, fb, W);
+    ASSERT_EQ_INT(receive(), 6);
+
+    /* Redrawn but identical: just the round-robin refresh */
+    frame();
+    ASSERT_EQ_INT(receive(), SCREEN_STREAM_REFRESH_TILES);
+
+    /* One pixel in the partial corner tile */
+    fb[W * 20 + 35] = 0x00CC00;
+    screen_stream_capture(&stream, fb, W, 35, 20, 35, 20);
+    screen_stream_frame_end(&stream, fb, W);
+    ASSERT_EQ_INT(receive(), 1 + SCREEN_STREAM_REFRESH_TILES);
+    ASSERT_TRUE(mirror_matches());
+
+    /* Changes outside the reported area are not looked for */
+    fb[0] = 0xFFFFFF;
+    screen_stream_capture(&stream, fb, W, 20, 0, 30, 10);
+    screen_stream_frame_end(&stream, fb, W);
+    ASSERT_EQ_INT(receive(), SCREEN_STREAM_REFRESH_TILES);
+    teardown();
+}
+
+/* ── Test: a backed-up viewer catches up ─────────────────── */
+
+static void test_backpressure(void) {
+    printf("  test_backpressure\n");
+    setup();
+
+    /* Every tile changes every frame and nobody reads */
+    uint32_t seed = 1;
+    for (int f = 0; f < 400; f++) {
+        for (int i = 0; i < W * H; i++) {
+            seed = seed * 1103515245u + 12345u;
+            fb[i] = seed >> 8;
+        }
+        frame();
+    }
+    ASSERT_TRUE(screen_stream_connected(&stream));
+    screen_stream_stats_t st = screen_stream_get_stats(&stream);
+    ASSERT_TRUE(st.frames_sent < st.frames);        /* Frames were skipped */
+
+    /* Reading again, the viewer ends up with the latest screen */
+    for (int f = 0; f < 20; f++) {
+        ASSERT_TRUE(receive() >= 0);
+        frame();
+    }
+    ASSERT_TRUE(receive() >= 0);
+    ASSERT_TRUE(mirror_matches());
+    teardown();
+}
+
+/* ── Test: viewer goes away ──────────────────────────────── */
+
+static void test_disconnect(void) {
+    printf("  test_disconnect\n");
+    setup();
+    screen_stream_frame_end(&stream, fb, W);
+    close(viewer_fd);
+    viewer_fd = -1;
+
+    frame();
+    frame();
+    ASSERT_FALSE(screen_stream_connected(&stream));
+
+    /* Nothing measured without a viewer */
+    uint32_t count = stream.capture_hist.count;
+    frame();
+    ASSERT_EQ_INT(stream.capture_hist.count, count);
+    teardown();
+}
+
+/* ── Test: viewer over TCP ───────────────────────────────── */
+
+static void test_tcp_viewer(void) {
+    printf("  test_tcp_viewer\n");
+    ASSERT_TRUE(screen_stream_init(&stream, W, H));
+    ASSERT_FALSE(screen_stream_listen(&stream, "not-an-address", 0));
+    ASSERT_TRUE(screen_stream_listen(&stream, "127.0.0.1", 0));
+
+    struct sockaddr_in sa;
+    socklen_t sa_len = sizeof(sa);
+    ASSERT_EQ_INT(getsockname(stream.listen_fd, (struct sockaddr *)&sa, &sa_len), 0);
+    viewer_fd = socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_EQ_INT(connect(viewer_fd, (struct sockaddr *)&sa, sa_len), 0);
+
+    /* Accepted at the next frame */
+    ASSERT_FALSE(screen_stream_connected(&stream));
+    for (int i = 0; i < W * H; i++) fb[i] = 0x1A1A1A;
+    rx_len = 0;
+    hello_w = 0;
+    screen_stream_frame_end(&stream, fb, W);
+    ASSERT_TRUE(screen_stream_connected(&stream));
+
+    int tiles = 0;
+    for (int i = 0; i < 100 && tiles < 6; i++) {
+        int t = receive();
+        ASSERT_TRUE(t >= 0);
+        if (t > 0) tiles += t;
+        else usleep(1000);
+    }
+    ASSERT_EQ_INT(tiles, 6);
+    ASSERT_EQ_INT(hello_w, W);
+    ASSERT_TRUE(mirror_matches());
+    teardown();
+}
+
+/* ── Suite entry point ───────────────────────────────────── */
+
+void test_screen_stream(void) {
+    test_full_screen();
+    test_only_changes();
+    test_backpressure();
+    test_disconnect();
+    test_tcp_viewer();
+}
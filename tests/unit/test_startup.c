@@ -0,0 +1,175 @@
+/**
+ * @file test_startup.c
+ * @brief Unit tests for startup module
+ *
+ * Tests table validation, dependency ordering within and across stages,
+ * skipping of dependents after a failure, one-at-a-time deferred steps,
+ * cycle handling, and milestone recording.
+ */
+
+#include "test_framework.h"
+#include "startup.h"
+#include <string.h>
+
+/* ── Helpers ─────────────────────────────────────────────── */
+
+static char order[32];
+static int  order_len = 0;
+
+static void reset_order(void) {
+    memset(order, 0, sizeof(order));
+    order_len = 0;
+}
+
+#define STEP_FN(c, result) \
+    static bool step_##c(void) { order[order_len++] = #c[0]; return result; }
+
+STEP_FN(a, true)
+STEP_FN(b, true)
+STEP_FN(c, true)
+STEP_FN(d, true)
+STEP_FN(e, true)
+STEP_FN(f, false)
+
+/* ── Test: invalid tables are refused ────────────────────── */
+
+static void test_validation(void) {
+    printf("  test_validation\n");
+
+    const startup_step_t self_dep[] = {
+        { "a", step_a, STARTUP_DEP(0), STARTUP_STAGE_FIRST_FRAME },
+    };
+    ASSERT_FALSE(startup_begin(self_dep, 1));
+
+    const startup_step_t out_of_range[] = {
+        { "a", step_a, STARTUP_DEP(3), STARTUP_STAGE_FIRST_FRAME },
+    };
+    ASSERT_FALSE(startup_begin(out_of_range, 1));
+
+    /* The first frame cannot wait for a deferred step */
+    const startup_step_t backwards[] = {
+        { "a", step_a, STARTUP_DEP(1), STARTUP_STAGE_FIRST_FRAME },
+        { "b", step_b, 0,              STARTUP_STAGE_DEFERRED },
+    };
+    ASSERT_FALSE(startup_begin(backwards, 2));
+    ASSERT_FALSE(startup_begin(NULL, 1));
+    ASSERT_TRUE(startup_begin(backwards, 0));
+}
+
+/* ── Test: dependencies decide the order ─────────────────── */
+
+static void test_dependency_order(void) {
+    printf("  test_dependency_order\n");
+    reset_order();
+
+    /* Listed out of order: a needs c, c needs b */
+    const startup_step_t table[] = {
+        { "a", step_a, STARTUP_DEP(2), STARTUP_STAGE_FIRST_FRAME },
+        { "b", step_b, 0,              STARTUP_STAGE_FIRST_FRAME },
+        { "c", step_c, STARTUP_DEP(1), STARTUP_STAGE_FIRST_FRAME },
+        { "d", step_d, STARTUP_DEP(0), STARTUP_STAGE_DEFERRED },
+        { "e", step_e, 0,              STARTUP_STAGE_DEFERRED },
+    };
+    ASSERT_TRUE(startup_begin(table, 5));
+
+    /* Deferred steps wait for the first-frame stage */
+    ASSERT_FALSE(startup_run_next());
+    ASSERT_STR_EQ(order, "");
+
+    ASSERT_EQ_INT(startup_run_stage(STARTUP_STAGE_FIRST_FRAME), 0);
+    ASSERT_STR_EQ(order, "bca");
+    ASSERT_FALSE(startup_done());
+
+    /* One deferred step per call */
+    ASSERT_TRUE(startup_run_next());
+    ASSERT_STR_EQ(order, "bcad");
+    ASSERT_TRUE(startup_run_next());
+    ASSERT_STR_EQ(order, "bcade");
+    ASSERT_FALSE(startup_run_next());
+    ASSERT_TRUE(startup_done());
+    ASSERT_EQ_INT(startup_step_state(4), STARTUP_STEP_OK);
+
+    const startup_event_t *ev = NULL;
+    ASSERT_EQ_INT(startup_events(&ev), 5);
+    ASSERT_STR_EQ(ev[0].name, "b");
+    ASSERT_TRUE(ev[1].start_us >= ev[0].start_us + ev[0].dur_us);
+}
+
+/* ── Test: a failure skips its dependents only ───────────── */
+
+static void test_failure_skips_dependents(void) {
+    printf("  test_failure_skips_dependents\n");
+    reset_order();
+
+    const startup_step_t table[] = {
+        { "f", step_f, 0,              STARTUP_STAGE_FIRST_FRAME },
+        { "a", step_a, STARTUP_DEP(0), STARTUP_STAGE_FIRST_FRAME },
+        { "b", step_b, 0,              STARTUP_STAGE_FIRST_FRAME },
+        { "c", step_c, STARTUP_DEP(1), STARTUP_STAGE_DEFERRED },
+        { "d", step_d, 0,              STARTUP_STAGE_DEFERRED },
+    };
+    ASSERT_TRUE(startup_begin(table, 5));
+    ASSERT_EQ_INT(startup_run_stage(STARTUP_STAGE_FIRST_FRAME), 2);
+    ASSERT_STR_EQ(order, "fb");
+    ASSERT_EQ_INT(startup_step_state(0), STARTUP_STEP_FAILED);
+    ASSERT_EQ_INT(startup_step_state(1), STARTUP_STEP_SKIPPED);
+
+    /* The skipped c does not use up the call: d runs */
+    ASSERT_TRUE(startup_run_next());
+    ASSERT_STR_EQ(order, "fbd");
+    ASSERT_EQ_INT(startup_step_state(3), STARTUP_STEP_SKIPPED);
+    ASSERT_FALSE(startup_run_next());
+    ASSERT_TRUE(startup_done());
+}
+
+/* ── Test: cycles are skipped, the rest still runs ───────── */
+
+static void test_cycle(void) {
+    printf("  test_cycle\n");
+    reset_order();
+
+    const startup_step_t table[] = {
+        { "a", step_a, STARTUP_DEP(1), STARTUP_STAGE_DEFERRED },
+        { "b", step_b, STARTUP_DEP(0), STARTUP_STAGE_DEFERRED },
+        { "c", step_c, 0,              STARTUP_STAGE_DEFERRED },
+    };
+    ASSERT_TRUE(startup_begin(table, 3));
+    ASSERT_EQ_INT(startup_run_stage(STARTUP_STAGE_DEFERRED), 2);
+    ASSERT_STR_EQ(order, "c");
+    ASSERT_EQ_INT(startup_step_state(0), STARTUP_STEP_SKIPPED);
+    ASSERT_TRUE(startup_done());
+}
+
+/* ── Test: milestones ────────────────────────────────────── */
+
+static void test_milestones(void) {
+    printf("  test_milestones\n");
+
+    const startup_step_t table[] = {
+        { "a", step_a, 0, STARTUP_STAGE_FIRST_FRAME },
+    };
+    ASSERT_TRUE(startup_begin(table, 1));
+    ASSERT_EQ_INT(startup_milestone_ms("first_frame"), -1);
+
+    startup_run_stage(STARTUP_STAGE_FIRST_FRAME);
+    startup_mark("first_frame");
+    startup_mark("first_frame");        /* Second mark is ignored */
+    ASSERT_GE_INT(startup_milestone_ms("first_frame"), 0);
+
+    const startup_event_t *ev = NULL;
+    ASSERT_EQ_INT(startup_events(&ev), 2);
+    ASSERT_TRUE(ev[1].milestone);
+    ASSERT_EQ_INT((int)ev[1].dur_us, 0);
+    ASSERT_TRUE(startup_elapsed_ms() < 1000);
+    startup_report();
+}
+
+/* ── Public entry point ──────────────────────────────────── */
+
+void test_startup(void) {
+    test_validation();
+    test_dependency_order();
+    test_failure_skips_dependents();
+    test_cycle();
+    test_milestones();
+}
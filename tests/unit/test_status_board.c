@@ -0,0 +1,243 @@
+/**
+ * @file test_status_board.c
+ * @brief Unit tests for status_board module
+ *
+ * Tests record write/read round-trips, never-written and out-of-range
+ * records, sequence numbering, conversion helpers, persistence of a
+ * named shared-memory region across detach/re-attach, and per-record
+ * writer ownership across processes.
+ */
+
+#include "test_framework.h"
+#include "status_board.h"
+#include "ipc_messages.h"
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+/* ── Test: in-process open and close ─────────────────────── */
+
+static void test_open_close(void) {
+    printf("  test_open_close\n");
+
+    ASSERT_FALSE(status_board_is_open());
+    bool ok = status_board_open(NULL, true);
+    ASSERT_TRUE(ok);
+    ASSERT_TRUE(status_board_is_open());
+
+    status_board_close();
+    ASSERT_FALSE(status_board_is_open());
+}
+
+/* ── Test: never-written records and bounds ──────────────── */
+
+static void test_unwritten_and_bounds(void) {
+    printf("  test_unwritten_and_bounds\n");
+
+    status_vitals_t v;
+    status_alarms_t a;
+    status_service_t s;
+
+    /* Not attached */
+    ASSERT_FALSE(status_board_read_vitals(0, &v));
+
+    status_board_open(NULL, true);
+
+    ASSERT_FALSE(status_board_read_vitals(0, &v));
+    ASSERT_FALSE(status_board_read_alarms(1, &a));
+    ASSERT_FALSE(status_board_read_service(STATUS_SVC_ALARM, &s));
+    ASSERT_EQ_INT(status_board_vitals_seq(0), 0);
+
+    memset(&v, 0, sizeof(v));
+    ASSERT_FALSE(status_board_write_vitals(STATUS_BOARD_SLOTS, &v));
+    ASSERT_FALSE(status_board_read_vitals(STATUS_BOARD_SLOTS, &v));
+    ASSERT_FALSE(status_board_write_service(STATUS_SVC_COUNT, &s));
+
+    status_board_close();
+}
+
+/* ── Test: vitals round trip and sequence numbers ────────── */
+
+static void test_vitals_round_trip(void) {
+    printf("  test_vitals_round_trip\n");
+
+    status_board_open(NULL, true);
+
+    status_vitals_t in;
+    memset(&in, 0, sizeof(in));
+    in.hr = 88;
+    in.spo2 = 95;
+    in.temp_x10 = 372;
+    in.timestamp_ms = 123456789ULL;
+
+    ASSERT_TRUE(status_board_write_vitals(1, &in));
+    ASSERT_EQ_INT(status_board_vitals_seq(1), 2);
+
+    status_vitals_t out;
+    ASSERT_TRUE(status_board_read_vitals(1, &out));
+    ASSERT_EQ_INT(out.hr, 88);
+    ASSERT_EQ_INT(out.spo2, 95);
+    ASSERT_EQ_INT(out.temp_x10, 372);
+    ASSERT_TRUE(out.timestamp_ms == 123456789ULL);
+
+    /* Other slot untouched */
+    ASSERT_FALSE(status_board_read_vitals(0, &out));
+
+    in.hr = 90;
+    status_board_write_vitals(1, &in);
+    ASSERT_EQ_INT(status_board_vitals_seq(1), 4);
+    status_board_read_vitals(1, &out);
+    ASSERT_EQ_INT(out.hr, 90);
+
+    status_board_close();
+}
+
+/* ── Test: conversion helpers ────────────────────────────── */
+
+static void test_conversion_helpers(void) {
+    printf("  test_conversion_helpers\n");
+
+    vitals_data_t data;
+    memset(&data, 0, sizeof(data));
+    data.hr = 72;
+    data.spo2 = 98;
+    data.rr = 16;
+    data.temp = 36.8f;
+    data.nibp_sys = 120;
+    data.nibp_dia = 80;
+    data.nibp_map = 93;
+    data.timestamp_ms = 5000;
+
+    status_vitals_t v;
+    status_board_vitals_from_data(&data, &v);
+    ASSERT_EQ_INT(v.hr, 72);
+    ASSERT_EQ_INT(v.temp_x10, 368);
+    ASSERT_EQ_INT(v.nibp_map, 93);
+    ASSERT_EQ_INT(v.sensor_state[IPC_SENSOR_ECG],  IPC_SENSOR_CONNECTED);
+    ASSERT_EQ_INT(v.sensor_state[IPC_SENSOR_SPO2], IPC_SENSOR_CONNECTED);
+    ASSERT_EQ_INT(v.sensor_state[IPC_SENSOR_NIBP], IPC_SENSOR_CONNECTED);
+    ASSERT_EQ_INT(v.sensor_state[IPC_SENSOR_TEMP], IPC_SENSOR_CONNECTED);
+
+    vitals_data_t off;
+    memset(&off, 0, sizeof(off));
+    off.ecg_lead_off = true;
+    status_board_vitals_from_data(&off, &v);
+    ASSERT_EQ_INT(v.sensor_state[IPC_SENSOR_ECG],  IPC_SENSOR_ERROR);
+    ASSERT_EQ_INT(v.sensor_state[IPC_SENSOR_SPO2], IPC_SENSOR_DISCONNECTED);
+    ASSERT_EQ_INT(v.sensor_state[IPC_SENSOR_NIBP], IPC_SENSOR_DISCONNECTED);
+    ASSERT_EQ_INT(v.sensor_state[IPC_SENSOR_TEMP], IPC_SENSOR_DISCONNECTED);
+
+    alarm_engine_init();
+    data.hr = 160;  /* Critical high */
+    alarm_engine_evaluate(&data, 10);
+
+    status_alarms_t a;
+    status_board_alarms_from_engine(alarm_engine_get_state(), 10, &a);
+    ASSERT_EQ_INT(a.state[ALARM_PARAM_HR], ALARM_STATE_ACTIVE);
+    ASSERT_EQ_INT(a.severity[ALARM_PARAM_HR], ALARM_SEV_HIGH);
+    ASSERT_EQ_INT(a.highest_active, ALARM_SEV_HIGH);
+    ASSERT_STR_EQ(a.highest_message, "HR Very High");
+    ASSERT_EQ_INT(a.updated_s, 10);
+    alarm_engine_deinit();
+
+    ASSERT_EQ_INT(status_board_service_id("alarm-service"), STATUS_SVC_ALARM);
+    ASSERT_EQ_INT(status_board_service_id("vitals-ui"), STATUS_SVC_UI);
+    ASSERT_EQ_INT(status_board_service_id("unknown"), STATUS_SVC_COUNT);
+    ASSERT_EQ_INT(status_board_service_id(NULL), STATUS_SVC_COUNT);
+}
+
+/* ── Test: named region persists across re-attach ────────── */
+
+static void test_named_region(void) {
+    printf("  test_named_region\n");
+
+    char name[64];
+    snprintf(name, sizeof(name), "/vm-test-status-%d", (int)getpid());
+    status_board_unlink(name);
+
+    /* Reader cannot attach before a writer created the region */
+    ASSERT_FALSE(status_board_open(name, false));
+
+    ASSERT_TRUE(status_board_open(name, true));
+
+    status_service_t s;
+    memset(&s, 0, sizeof(s));
+    strncpy(s.name, "alarm-service", sizeof(s.name) - 1);
+    s.state = 2;
+    s.last_heartbeat_s = 42;
+    ASSERT_TRUE(status_board_write_service(STATUS_SVC_ALARM, &s));
+    status_board_close();
+
+    /* Re-attach read-only: record survives, writes are refused */
+    ASSERT_TRUE(status_board_open(name, false));
+    status_service_t out;
+    ASSERT_TRUE(status_board_read_service(STATUS_SVC_ALARM, &out));
+    ASSERT_STR_EQ(out.name, "alarm-service");
+    ASSERT_EQ_INT(out.last_heartbeat_s, 42);
+    ASSERT_FALSE(status_board_write_service(STATUS_SVC_ALARM, &s));
+    status_board_close();
+
+    status_board_unlink(name);
+}
+
+/* ── Test: one writer process per record ─────────────────── */
+
+static void test_writer_ownership(void) {
+    printf("  test_writer_ownership\n");
+
+    char name[64];
+    snprintf(name, sizeof(name), "/vm-test-owner-%d", (int)getpid());
+    status_board_unlink(name);
+
+    ASSERT_TRUE(status_board_open(name, true));
+    status_vitals_t v;
+    memset(&v, 0, sizeof(v));
+    v.hr = 77;
+    ASSERT_TRUE(status_board_write_vitals(0, &v));
+
+    /* Second writer process: its open must not wipe slot 0, it may not
+       write slot 0 while we are alive, and it claims slot 1 */
+    pid_t child = fork();
+    if (child == 0) {
+        int fail = 0;
+        status_vitals_t cv;
+        if (!status_board_open(name, true)) _exit(1);
+        if (!status_board_read_vitals(0, &cv) || cv.hr != 77) fail |= 2;
+        cv.hr = 55;
+        if (status_board_write_vitals(0, &cv)) fail |= 4;
+        if (!status_board_write_vitals(1, &cv)) fail |= 8;
+        _exit(fail);
+    }
+    ASSERT_TRUE(child > 0);
+    int status = -1;
+    waitpid(child, &status, 0);
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ_INT(WEXITSTATUS(status), 0);
+
+    status_vitals_t out;
+    ASSERT_TRUE(status_board_read_vitals(0, &out));
+    ASSERT_EQ_INT(out.hr, 77);
+    ASSERT_TRUE(status_board_read_vitals(1, &out));
+    ASSERT_EQ_INT(out.hr, 55);
+
+    /* The child's record is taken over now that it has exited */
+    v.hr = 66;
+    ASSERT_TRUE(status_board_write_vitals(1, &v));
+    ASSERT_TRUE(status_board_read_vitals(1, &out));
+    ASSERT_EQ_INT(out.hr, 66);
+    ASSERT_EQ_INT(status_board_vitals_seq(1), 4);
+
+    status_board_close();
+    status_board_unlink(name);
+}
+
+/* ── Public entry point ──────────────────────────────────── */
+
+void test_status_board(void) {
+    test_open_close();
+    test_unwritten_and_bounds();
+    test_vitals_round_trip();
+    test_conversion_helpers();
+    test_named_region();
+    test_writer_ownership();
+}
@@ -0,0 +1,149 @@
+/**
+ * @file test_tile_codec.c
+ * @brief Unit tests for tile_codec module
+ *
+ * Tests that each kind of content picks the expected encoding and round
+ * trips to the same RGB565 pixels, partial edge tiles, and rejection of
+ * malformed data.
+ */
+
+#include "test_framework.h"
+#include "tile_codec.h"
+#include <string.h>
+
+/* ── Test fixtures ───────────────────────────────────────── */
+
+#define FB_STRIDE 40
+
+static uint32_t fb[TILE_SIZE * FB_STRIDE];
+static uint8_t  enc[TILE_CODEC_MAX_BYTES];
+static uint16_t dec[TILE_PIXELS];
+
+static void fill(uint32_t c) {
+    for (size_t i = 0; i < sizeof(fb) / sizeof(fb[0]); i++) fb[i] = c;
+}
+
+/** Encode the w x h tile at column 3, decode it, compare. */
+static size_t round_trip(int w, int h) {
+    const uint32_t *px = fb + 3;
+    size_t len = tile_encode(px, FB_STRIDE, w, h, enc);
+    memset(dec, 0xAB, sizeof(dec));
+    ASSERT_TRUE(tile_decode(enc, len, w, h, dec, (size_t)w));
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            if (dec[y * w + x] != tile_rgb565(px[y * FB_STRIDE + x])) {
+                ASSERT_EQ_INT(dec[y * w + x], tile_rgb565(px[y * FB_STRIDE + x]));
+                return len;
+            }
+        }
+    }
+    return len;
+}
+
+/* ── Test: colour conversion ─────────────────────────────── */
+
+static void test_rgb565(void) {
+    printf("  test_rgb565\n");
+    ASSERT_EQ_INT(tile_rgb565(0x000000), 0x0000);
+    ASSERT_EQ_INT(tile_rgb565(0xFFFFFF), 0xFFFF);
+    ASSERT_EQ_INT(tile_rgb565(0xFF0000), 0xF800);
+    ASSERT_EQ_INT(tile_rgb565(0x00FF00), 0x07E0);
+    ASSERT_EQ_INT(tile_rgb565(0x0000FF), 0x001F);
+}
+
+/* ── Test: one encoding per kind of content ──────────────── */
+
+static void test_encodings(void) {
+    printf("  test_encodings\n");
+
+    /* Screen background */
+    fill(0x0A0A0A);
+    ASSERT_EQ_INT(round_trip(TILE_SIZE, TILE_SIZE), 3);
+    ASSERT_EQ_INT(enc[0], TILE_ENC_SOLID);
+
+    /* Anti-aliased text: a few levels of one colour */
+    for (int y = 0; y < TILE_SIZE; y++) {
+        for (int x = 0; x < FB_STRIDE; x++) {
+            fb[y * FB_STRIDE + x] = (uint32_t)(((x * 3 + y) % 8) * 0x200000);
+        }
+    }
+    size_t len = round_trip(TILE_SIZE, TILE_SIZE);
+    ASSERT_EQ_INT(enc[0], TILE_ENC_PALETTE);
+    ASSERT_EQ_INT((int)len, 1 + 1 + 8 * 2 + TILE_PIXELS * 4 / 8);
+
+    /* Two colours: one bit per pixel */
+    for (int i = 0; i < TILE_SIZE * FB_STRIDE; i++) fb[i] = (i % 3) ? 0x00CC00 : 0;
+    len = round_trip(TILE_SIZE, TILE_SIZE);
+    ASSERT_EQ_INT(enc[0], TILE_ENC_PALETTE);
+    ASSERT_EQ_INT((int)len, 1 + 1 + 2 * 2 + TILE_PIXELS / 8);
+
+    /* Many colours in long runs: horizontal bands */
+    for (int y = 0; y < TILE_SIZE; y++) {
+        for (int x = 0; x < FB_STRIDE; x++) {
+            fb[y * FB_STRIDE + x] = (uint32_t)y * 0x0F0F0F + 0x10;
+        }
+    }
+    len = round_trip(TILE_SIZE, TILE_SIZE);
+    ASSERT_EQ_INT(enc[0], TILE_ENC_RLE);
+    ASSERT_EQ_INT((int)len, 1 + TILE_SIZE * 3);
+
+    /* Noise */
+    uint32_t seed = 12345;
+    for (int i = 0; i < TILE_SIZE * FB_STRIDE; i++) {
+        seed = seed * 1103515245u + 12345u;
+        fb[i] = seed >> 8;
+    }
+    len = round_trip(TILE_SIZE, TILE_SIZE);
+    ASSERT_EQ_INT(enc[0], TILE_ENC_RAW);
+    ASSERT_EQ_INT((int)len, TILE_CODEC_MAX_BYTES);
+}
+
+/* ── Test: partial tiles at the screen edge ──────────────── */
+
+static void test_edge_tiles(void) {
+    printf("  test_edge_tiles\n");
+    for (int i = 0; i < TILE_SIZE * FB_STRIDE; i++) fb[i] = (i % 5) ? 0xFFFFFF : 0x00CCFF;
+    round_trip(5, TILE_SIZE);
+    round_trip(TILE_SIZE, 3);
+    round_trip(1, 1);
+    ASSERT_EQ_INT(enc[0], TILE_ENC_SOLID);
+
+    /* Size must match what was encoded */
+    size_t len = tile_encode(fb, FB_STRIDE, 5, 7, enc);
+    ASSERT_EQ_INT(enc[0], TILE_ENC_PALETTE);
+    ASSERT_FALSE(tile_decode(enc, len, 6, 7, dec, 6));
+}
+
+/* ── Test: malformed input ───────────────────────────────── */
+
+static void test_malformed(void) {
+    printf("  test_malformed\n");
+    fill(0);
+    for (int i = 0; i < TILE_SIZE * FB_STRIDE; i += 7) fb[i] = 0xFF8800;
+    size_t len = tile_encode(fb, FB_STRIDE, TILE_SIZE, TILE_SIZE, enc);
+    ASSERT_EQ_INT(enc[0], TILE_ENC_PALETTE);
+
+    ASSERT_FALSE(tile_decode(enc, len - 1, TILE_SIZE, TILE_SIZE, dec, TILE_SIZE));
+    ASSERT_FALSE(tile_decode(enc, 0, TILE_SIZE, TILE_SIZE, dec, TILE_SIZE));
+    ASSERT_FALSE(tile_decode(enc, len, TILE_SIZE + 1, TILE_SIZE, dec, TILE_SIZE));
+
+    enc[1] = 1;                                     /* Palette of one */
+    ASSERT_FALSE(tile_decode(enc, len, TILE_SIZE, TILE_SIZE, dec, TILE_SIZE));
+
+    enc[0] = TILE_ENC_COUNT;
+    ASSERT_FALSE(tile_decode(enc, len, TILE_SIZE, TILE_SIZE, dec, TILE_SIZE));
+
+    /* Runs longer than the tile */
+    uint8_t rle[] = { TILE_ENC_RLE, 255, 0, 0, 0, 0, 0 };
+    ASSERT_TRUE(tile_decode(rle, 4, TILE_SIZE, TILE_SIZE, dec, TILE_SIZE));
+    ASSERT_FALSE(tile_decode(rle, sizeof(rle), TILE_SIZE, TILE_SIZE, dec, TILE_SIZE));
+}
+
+/* ── Suite entry point ───────────────────────────────────── */
+
+void test_tile_codec(void) {
+    test_rgb565();
+    test_encodings();
+    test_edge_tiles();
+    test_malformed();
+}
@@ -0,0 +1,232 @@
+/**
+ * @file test_tlsf.c
+ * @brief Unit tests for tlsf module
+ *
+ * Tests alignment and tags, coalescing back to one free block, in-place
+ * and moving realloc, exhaustion, and a long random churn checked for
+ * consistency and for recovering the whole pool at the end.
+ */
+
+#include "test_framework.h"
+#include "tlsf.h"
+#include <stdint.h>
+#include <string.h>
+
+/* ── Test fixtures ───────────────────────────────────────── */
+
+#define POOL_SIZE   (64 * 1024)
+
+static uint64_t pool_mem[POOL_SIZE / sizeof(uint64_t)];
+static tlsf_t   t;
+
+static uint32_t rng_state = 12345;
+
+static uint32_t rng(void) {
+    rng_state = rng_state * 1103515245u + 12345u;
+    return rng_state >> 8;
+}
+
+/* ── Test: init ──────────────────────────────────────────── */
+
+static void test_init(void) {
+    printf("  test_init\n");
+    ASSERT_FALSE(tlsf_init(&t, pool_mem, 16));
+    ASSERT_TRUE(tlsf_init(&t, pool_mem, POOL_SIZE));
+    ASSERT_TRUE(tlsf_check(&t));
+
+    tlsf_stats_t s;
+    tlsf_get_stats(&t, &s);
+    ASSERT_EQ_INT(s.free_blocks, 1);
+    ASSERT_EQ_INT(s.used_blocks, 0);
+    ASSERT_EQ_INT((int)s.largest_free, (int)s.capacity);
+    ASSERT_EQ_INT(s.frag_pct, 0);
+    ASSERT_TRUE(s.capacity > POOL_SIZE - 64);
+}
+
+/* ── Test: alignment, sizes and tags ─────────────────────── */
+
+static void test_alloc_basic(void) {
+    printf("  test_alloc_basic\n");
+    ASSERT_TRUE(tlsf_init(&t, pool_mem, POOL_SIZE));
+
+    ASSERT_NULL(tlsf_malloc(&t, 0, 0));
+    ASSERT_NULL(tlsf_malloc(&t, POOL_SIZE, 0));
+
+    void *a = tlsf_malloc(&t, 1, 3);
+    void *b = tlsf_malloc(&t, 100, 4);
+    void *c = tlsf_malloc(&t, 5000, 5);
+    ASSERT_NOT_NULL(a);
+    ASSERT_NOT_NULL(b);
+    ASSERT_NOT_NULL(c);
+    ASSERT_EQ_INT((int)((uintptr_t)a % TLSF_ALIGN), 0);
+    ASSERT_EQ_INT((int)((uintptr_t)b % TLSF_ALIGN), 0);
+    ASSERT_EQ_INT((int)((uintptr_t)c % TLSF_ALIGN), 0);
+    ASSERT_TRUE(tlsf_size_of(a) >= 1);
+    ASSERT_TRUE(tlsf_size_of(b) >= 100);
+    ASSERT_TRUE(tlsf_size_of(c) >= 5000);
+    ASSERT_EQ_INT(tlsf_tag_of(a), 3);
+    ASSERT_EQ_INT(tlsf_tag_of(c), 5);
+    ASSERT_TRUE(tlsf_owns(&t, b));
+    ASSERT_FALSE(tlsf_owns(&t, &t));
+
+    /* Blocks do not overlap */
+    memset(a, 0xAA, tlsf_size_of(a));
+    memset(b, 0xBB, tlsf_size_of(b));
+    memset(c, 0xCC, tlsf_size_of(c));
+    ASSERT_EQ_INT(((uint8_t *)a)[0], 0xAA);
+    ASSERT_EQ_INT(((uint8_t *)b)[99], 0xBB);
+    ASSERT_TRUE(tlsf_check(&t));
+
+    tlsf_stats_t s;
+    tlsf_get_stats(&t, &s);
+    ASSERT_EQ_INT(s.used_blocks, 3);
+    ASSERT_EQ_INT((int)s.used,
+                  (int)(tlsf_size_of(a) + tlsf_size_of(b) + tlsf_size_of(c)));
+}
+
+/* ── Test: free coalesces with both neighbours ───────────── */
+
+static void test_coalesce(void) {
+    printf("  test_coalesce\n");
+    ASSERT_TRUE(tlsf_init(&t, pool_mem, POOL_SIZE));
+
+    void *p[5];
+    for (int i = 0; i < 5; i++) p[i] = tlsf_malloc(&t, 256, 0);
+
+    /* Free alternate blocks: holes that cannot merge */
+    tlsf_free(&t, p[1]);
+    tlsf_free(&t, p[3]);
+    tlsf_stats_t s;
+    tlsf_get_stats(&t, &s);
+    ASSERT_EQ_INT(s.free_blocks, 3);
+    ASSERT_TRUE(s.frag_pct > 0);
+
+    /* Freeing the block between them merges all three */
+    tlsf_free(&t, p[2]);
+    tlsf_get_stats(&t, &s);
+    ASSERT_EQ_INT(s.free_blocks, 2);
+    ASSERT_TRUE(tlsf_check(&t));
+
+    tlsf_free(&t, p[0]);
+    tlsf_free(&t, p[4]);
+    tlsf_get_stats(&t, &s);
+    ASSERT_EQ_INT(s.free_blocks, 1);
+    ASSERT_EQ_INT((int)s.largest_free, (int)s.capacity);
+    ASSERT_EQ_INT((int)s.used, 0);
+    ASSERT_TRUE(tlsf_check(&t));
+}
+
+/* ── Test: realloc ───────────────────────────────────────── */
+
+static void test_realloc(void) {
+    printf("  test_realloc\n");
+    ASSERT_TRUE(tlsf_init(&t, pool_mem, POOL_SIZE));
+
+    uint8_t *a = tlsf_malloc(&t, 64, 7);
+    for (int i = 0; i < 64; i++) a[i] = (uint8_t)i;
+
+    /* Grows in place into the free space after it */
+    uint8_t *g = tlsf_realloc(&t, a, 1000);
+    ASSERT_TRUE(g == a);
+    ASSERT_TRUE(tlsf_size_of(g) >= 1000);
+
+    /* Shrinks in place */
+    g = tlsf_realloc(&t, g, 32);
+    ASSERT_TRUE(g == a);
+    ASSERT_TRUE(tlsf_size_of(g) < 1000);
+
+    /* Blocked by a neighbour: moves, keeping contents and tag */
+    void *wall = tlsf_malloc(&t, 64, 0);
+    uint8_t *m = tlsf_realloc(&t, g, 2000);
+    ASSERT_NOT_NULL(m);
+    ASSERT_TRUE(m != a);
+    for (int i = 0; i < 32; i++) ASSERT_EQ_INT(m[i], i);
+    ASSERT_EQ_INT(tlsf_tag_of(m), 7);
+
+    /* Too large: fails, original kept */
+    ASSERT_NULL(tlsf_realloc(&t, m, POOL_SIZE * 2));
+    ASSERT_EQ_INT(m[31], 31);
+
+    tlsf_free(&t, m);
+    tlsf_free(&t, wall);
+    ASSERT_TRUE(tlsf_check(&t));
+    tlsf_stats_t s;
+    tlsf_get_stats(&t, &s);
+    ASSERT_EQ_INT(s.free_blocks, 1);
+}
+
+/* ── Test: exhaustion ────────────────────────────────────── */
+
+static void test_exhaustion(void) {
+    printf("  test_exhaustion\n");
+    ASSERT_TRUE(tlsf_init(&t, pool_mem, POOL_SIZE));
+
+    int n = 0;
+    void *p[1024];
+    while (n < 1024 && (p[n] = tlsf_malloc(&t, 512, 0)) != NULL) n++;
+    ASSERT_TRUE(n > 100 && n < 1024);
+    ASSERT_TRUE(tlsf_check(&t));
+
+    while (n > 0) tlsf_free(&t, p[--n]);
+    tlsf_stats_t s;
+    tlsf_get_stats(&t, &s);
+    ASSERT_EQ_INT(s.free_blocks, 1);
+    ASSERT_TRUE(s.used_peak > POOL_SIZE / 2);
+}
+
+/* ── Test: random churn ──────────────────────────────────── */
+
+static void test_churn(void) {
+    printf("  test_churn\n");
+    ASSERT_TRUE(tlsf_init(&t, pool_mem, POOL_SIZE));
+
+    enum { SLOTS = 128 };
+    uint8_t *p[SLOTS] = { 0 };
+    size_t   n[SLOTS] = { 0 };
+    bool consistent = true;
+
+    for (int round = 0; round < 20000; round++) {
+        int i = (int)(rng() % SLOTS);
+        if (p[i]) {
+            /* Contents survive other blocks' traffic */
+            if (p[i][0] != (uint8_t)i || p[i][n[i] - 1] != (uint8_t)i) consistent = false;
+            if (rng() % 4 == 0) {
+                size_t sz = 1 + rng() % 600;
+                uint8_t *q = tlsf_realloc(&t, p[i], sz);
+                if (q) {
+                    p[i] = q;
+                    n[i] = sz;
+                    memset(q, i, sz);
+                }
+            } else {
+                tlsf_free(&t, p[i]);
+                p[i] = NULL;
+            }
+        } else {
+            n[i] = 1 + rng() % (rng() % 8 == 0 ? 4000 : 200);
+            p[i] = tlsf_malloc(&t, n[i], (uint16_t)i);
+            if (p[i]) memset(p[i], i, n[i]);
+        }
+        if (round % 1000 == 0 && !tlsf_check(&t)) consistent = false;
+    }
+    ASSERT_TRUE(consistent);
+    ASSERT_TRUE(tlsf_check(&t));
+
+    for (int i = 0; i < SLOTS; i++) tlsf_free(&t, p[i]);
+    tlsf_stats_t s;
+    tlsf_get_stats(&t, &s);
+    ASSERT_EQ_INT(s.free_blocks, 1);
+    ASSERT_EQ_INT(s.used_blocks, 0);
+    ASSERT_EQ_INT((int)s.largest_free, (int)s.capacity);
+}
+
+/* ── Suite entry point ───────────────────────────────────── */
+
+void test_tlsf(void) {
+    test_init();
+    test_alloc_basic();
+    test_coalesce();
+    test_realloc();
+    test_exhaustion();
+    test_churn();
+}
@@ -0,0 +1,170 @@
+/**
+ * @file test_trend_lttb.c
+ * @brief Unit tests for trend_lttb module
+ *
+ * Tests pass-through of sparse input, spike preservation, first/last
+ * retention, bucket envelopes, gaps, and bucket compaction.
+ */
+
+#include "test_framework.h"
+#include "trend_lttb.h"
+
+/* ── Test fixtures ───────────────────────────────────────── */
+
+#define OUT_CAP  480
+
+static uint32_t out_ts[OUT_CAP];
+static int32_t  out_val[OUT_CAP];
+static int32_t  out_min[OUT_CAP];
+static int32_t  out_max[OUT_CAP];
+static trend_lttb_t lttb;
+
+static void start(uint32_t start_ts, uint32_t end_ts, int max_points) {
+    trend_lttb_init(&lttb, start_ts, end_ts, max_points,
+                    out_ts, out_val, out_min, out_max);
+}
+
+static bool strictly_increasing(int n) {
+    for (int i = 1; i < n; i++) {
+        if (out_ts[i] <= out_ts[i - 1]) return false;
+    }
+    return true;
+}
+
+/* ── Test: fewer samples than buckets pass through ───────── */
+
+static void test_sparse_passthrough(void) {
+    printf("  test_sparse_passthrough\n");
+    start(0, 3599, OUT_CAP);
+
+    for (int i = 0; i < 10; i++) {
+        trend_lttb_push(&lttb, (uint32_t)i * 300, 60 + i, 60 + i, 60 + i);
+    }
+    int n = trend_lttb_finish(&lttb);
+
+    ASSERT_EQ_INT(n, 10);
+    for (int i = 0; i < n; i++) {
+        ASSERT_EQ_INT((int)out_ts[i], i * 300);
+        ASSERT_EQ_INT(out_val[i], 60 + i);
+    }
+}
+
+/* ── Test: short spike survives 15:1 reduction ───────────── */
+
+static void test_spike_preserved(void) {
+    printf("  test_spike_preserved\n");
+    start(0, 7199, OUT_CAP);
+
+    for (uint32_t t = 0; t < 7200; t++) {
+        int32_t v = (t >= 3000 && t < 3005) ? 150 : 70;
+        if (t >= 5000 && t < 5003) v = 40;
+        trend_lttb_push(&lttb, t, v, v, v);
+    }
+    int n = trend_lttb_finish(&lttb);
+
+    ASSERT_TRUE(n <= OUT_CAP);
+    ASSERT_GT_INT(n, 400);
+    ASSERT_TRUE(strictly_increasing(n));
+
+    bool saw_peak = false, saw_trough = false;
+    for (int i = 0; i < n; i++) {
+        if (out_val[i] == 150) {
+            saw_peak = true;
+            ASSERT_TRUE(out_ts[i] >= 3000 && out_ts[i] < 3005);
+        }
+        if (out_val[i] == 40) {
+            saw_trough = true;
+            ASSERT_TRUE(out_ts[i] >= 5000 && out_ts[i] < 5003);
+        }
+    }
+    ASSERT_TRUE(saw_peak);
+    ASSERT_TRUE(saw_trough);
+}
+
+/* ── Test: first and last samples are always kept ────────── */
+
+static void test_first_last_kept(void) {
+    printf("  test_first_last_kept\n");
+    start(100, 1099, 10);
+
+    for (uint32_t t = 100; t < 1100; t++) {
+        trend_lttb_push(&lttb, t, (int32_t)(t % 17), 0, 0);
+    }
+    int n = trend_lttb_finish(&lttb);
+
+    ASSERT_TRUE(n <= 10);
+    ASSERT_EQ_INT((int)out_ts[0], 100);
+    ASSERT_EQ_INT((int)out_ts[n - 1], 1099);
+    ASSERT_TRUE(strictly_increasing(n));
+}
+
+/* ── Test: output carries each bucket's min/max envelope ── */
+
+static void test_envelope(void) {
+    printf("  test_envelope\n");
+    start(0, 599, 12);      /* 10 buckets of 60 s */
+
+    /* 1-min aggregate rows: avg flat, one row with a wide range */
+    for (uint32_t t = 0; t < 600; t += 10) {
+        int32_t lo = (t == 250) ? 30 : 68;
+        int32_t hi = (t == 250) ? 180 : 72;
+        trend_lttb_push(&lttb, t, 70, lo, hi);
+    }
+    int n = trend_lttb_finish(&lttb);
+
+    bool found = false;
+    for (int i = 0; i < n; i++) {
+        if (out_ts[i] >= 240 && out_ts[i] < 300) {
+            ASSERT_EQ_INT(out_min[i], 30);
+            ASSERT_EQ_INT(out_max[i], 180);
+            found = true;
+        }
+    }
+    ASSERT_TRUE(found);
+}
+
+/* ── Test: no points are invented inside a data gap ──────── */
+
+static void test_gap(void) {
+    printf("  test_gap\n");
+    start(0, 3599, 62);     /* 60 buckets of 60 s */
+
+    for (uint32_t t = 0; t < 1200; t++) trend_lttb_push(&lttb, t, 80, 80, 80);
+    for (uint32_t t = 2400; t < 3600; t++) trend_lttb_push(&lttb, t, 90, 90, 90);
+    int n = trend_lttb_finish(&lttb);
+
+    for (int i = 0; i < n; i++) {
+        ASSERT_TRUE(out_ts[i] < 1200 || out_ts[i] >= 2400);
+    }
+    ASSERT_TRUE(strictly_increasing(n));
+}
+
+/* ── Test: overfull bucket keeps its extremes ────────────── */
+
+static void test_bucket_compaction(void) {
+    printf("  test_bucket_compaction\n");
+    start(0, 999, 3);       /* One bucket holding 998 interior samples */
+
+    for (uint32_t t = 0; t < 1000; t++) {
+        int32_t v = (t == 700) ? 200 : 50;
+        trend_lttb_push(&lttb, t, v, v, v);
+    }
+    int n = trend_lttb_finish(&lttb);
+
+    ASSERT_EQ_INT(n, 3);
+    ASSERT_EQ_INT((int)out_ts[1], 700);
+    ASSERT_EQ_INT(out_val[1], 200);
+    ASSERT_EQ_INT(out_min[1], 50);
+    ASSERT_EQ_INT(out_max[1], 200);
+}
+
+/* ── Public entry point ──────────────────────────────────── */
+
+void test_trend_lttb(void) {
+    test_sparse_passthrough();
+    test_spike_preserved();
+    test_first_last_kept();
+    test_envelope();
+    test_gap();
+    test_bucket_compaction();
+}
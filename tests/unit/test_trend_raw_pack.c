@@ -0,0 +1,125 @@
+/**
+ * @file test_trend_raw_pack.c
+ * @brief Unit tests for trend_raw_pack module
+ *
+ * Tests minute keys and slots, the minute buffer, blob round-tripping,
+ * short blobs, and per-channel statistics.
+ */
+
+#include "test_framework.h"
+#include "trend_raw_pack.h"
+
+/* ── Test: keys follow the (M - 60, M] convention ────────── */
+
+static void test_minute_key(void) {
+    printf("  test_minute_key\n");
+
+    ASSERT_EQ_INT((int)trend_raw_minute_key(600), 600);
+    ASSERT_EQ_INT((int)trend_raw_minute_key(541), 600);
+    ASSERT_EQ_INT((int)trend_raw_minute_key(601), 660);
+
+    ASSERT_EQ_INT(trend_raw_slot(541), 0);
+    ASSERT_EQ_INT(trend_raw_slot(600), 59);
+    ASSERT_EQ_INT(trend_raw_slot(601), 0);
+
+    ASSERT_EQ_INT((int)trend_raw_slot_ts(600, 0), 541);
+    ASSERT_EQ_INT((int)trend_raw_slot_ts(600, 59), 600);
+}
+
+/* ── Test: buffer counts distinct seconds ────────────────── */
+
+static void test_minute_put(void) {
+    printf("  test_minute_put\n");
+    trend_raw_minute_t m;
+    trend_raw_minute_reset(&m, 1200);
+
+    ASSERT_TRUE(m.active);
+    ASSERT_EQ_INT(m.count, 0);
+    ASSERT_EQ_INT(m.v[0][10], TREND_RAW_MISSING);
+
+    int32_t a[TREND_RAW_CHANNELS] = { 72, 98, 16, 369 };
+    int32_t b[TREND_RAW_CHANNELS] = { 75, 97, 17, 370 };
+    trend_raw_minute_put(&m, 1150, a);
+    trend_raw_minute_put(&m, 1150, b);      /* Overwrite, not a new sample */
+    trend_raw_minute_put(&m, 1200, a);
+
+    ASSERT_EQ_INT(m.count, 2);
+    ASSERT_EQ_INT(m.v[0][trend_raw_slot(1150)], 75);
+    ASSERT_EQ_INT(m.v[3][trend_raw_slot(1150)], 370);
+    ASSERT_EQ_INT(m.v[1][59], 98);
+
+    /* Out-of-range values clamp without becoming the sentinel */
+    int32_t big[TREND_RAW_CHANNELS] = { 100000, -100000, 0, 0 };
+    trend_raw_minute_put(&m, 1141, big);
+    ASSERT_EQ_INT(m.v[0][0], INT16_MAX);
+    ASSERT_TRUE(m.v[1][0] != TREND_RAW_MISSING);
+}
+
+/* ── Test: encode/decode round trip ──────────────────────── */
+
+static void test_blob_roundtrip(void) {
+    printf("  test_blob_roundtrip\n");
+    int16_t in[TREND_RAW_SAMPLES], out[TREND_RAW_SAMPLES];
+    uint8_t blob[TREND_RAW_BLOB_BYTES];
+
+    for (int i = 0; i < TREND_RAW_SAMPLES; i++) {
+        in[i] = (int16_t)((i % 3 == 0) ? TREND_RAW_MISSING : -300 + i * 17);
+    }
+    trend_raw_encode(in, blob);
+
+    /* Little-endian on the wire */
+    ASSERT_EQ_INT(blob[2], (uint8_t)((uint16_t)in[1] & 0xFF));
+    ASSERT_EQ_INT(blob[3], (uint8_t)((uint16_t)in[1] >> 8));
+
+    int present = trend_raw_decode(blob, TREND_RAW_BLOB_BYTES, out);
+    ASSERT_EQ_INT(present, 40);
+    for (int i = 0; i < TREND_RAW_SAMPLES; i++) {
+        ASSERT_EQ_INT(out[i], in[i]);
+    }
+}
+
+/* ── Test: short or missing blob decodes as gaps ─────────── */
+
+static void test_short_blob(void) {
+    printf("  test_short_blob\n");
+    int16_t out[TREND_RAW_SAMPLES];
+    uint8_t blob[4] = { 0x48, 0x00, 0x49, 0x00 };
+
+    ASSERT_EQ_INT(trend_raw_decode(blob, sizeof(blob), out), 2);
+    ASSERT_EQ_INT(out[0], 72);
+    ASSERT_EQ_INT(out[1], 73);
+    ASSERT_EQ_INT(out[2], TREND_RAW_MISSING);
+
+    ASSERT_EQ_INT(trend_raw_decode(NULL, 0, out), 0);
+    ASSERT_EQ_INT(out[59], TREND_RAW_MISSING);
+}
+
+/* ── Test: statistics skip missing slots ─────────────────── */
+
+static void test_channel_stats(void) {
+    printf("  test_channel_stats\n");
+    int16_t v[TREND_RAW_SAMPLES];
+    for (int i = 0; i < TREND_RAW_SAMPLES; i++) v[i] = TREND_RAW_MISSING;
+
+    trend_raw_stats_t empty = trend_raw_channel_stats(v);
+    ASSERT_EQ_INT(empty.n, 0);
+
+    v[5] = 60;
+    v[6] = 80;
+    v[50] = 101;
+    trend_raw_stats_t st = trend_raw_channel_stats(v);
+    ASSERT_EQ_INT(st.n, 3);
+    ASSERT_EQ_INT(st.avg, 80);          /* 241 / 3, truncated */
+    ASSERT_EQ_INT(st.min, 60);
+    ASSERT_EQ_INT(st.max, 101);
+}
+
+/* ── Public entry point ──────────────────────────────────── */
+
+void test_trend_raw_pack(void) {
+    test_minute_key();
+    test_minute_put();
+    test_blob_roundtrip();
+    test_short_blob();
+    test_channel_stats();
+}
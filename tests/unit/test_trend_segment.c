@@ -0,0 +1,173 @@
+/**
+ * @file test_trend_segment.c
+ * @brief Unit tests for trend_segment module
+ *
+ * Tests row/bytes/series round-tripping, delta compactness, skipping of
+ * unknown sections, and rejection of corrupt, truncated, newer-version
+ * and overflowing segments.
+ */
+
+#include "test_framework.h"
+#include "trend_segment.h"
+#include <string.h>
+
+static uint8_t seg[4096];
+
+/* ── Test: rows, byte strings and series round-trip ──────── */
+
+static void test_roundtrip(void) {
+    printf("  test_roundtrip\n");
+    trend_seg_writer_t w;
+    trend_seg_writer_init(&w, seg, sizeof(seg));
+
+    ASSERT_TRUE(trend_seg_begin_section(&w, TREND_SEG_ALARM, 2));
+    int64_t a0[2] = { 1700000000, 3 };
+    int64_t a1[2] = { 1699999000, 1 };      /* Negative delta */
+    trend_seg_put_row(&w, a0);
+    trend_seg_put_bytes(&w, "HR HIGH", 7);
+    trend_seg_put_row(&w, a1);
+    trend_seg_put_bytes(&w, "", 0);
+
+    ASSERT_TRUE(trend_seg_begin_section(&w, TREND_SEG_RAW, 1));
+    int16_t series[5] = { 72, 73, -32768, 32767, 70 };
+    int64_t r0[1] = { 1700000040 };
+    trend_seg_put_row(&w, r0);
+    trend_seg_put_series(&w, series, 5);
+
+    size_t len = trend_seg_finish(&w, 42, 1699999000, 1700000040);
+    ASSERT_GT_INT((int)len, TREND_SEG_HEADER_BYTES);
+
+    trend_seg_reader_t r;
+    trend_seg_header_t hdr;
+    ASSERT_TRUE(trend_seg_reader_init(&r, seg, len, &hdr));
+    ASSERT_EQ_INT(hdr.patient_id, 42);
+    ASSERT_EQ_INT(hdr.sections, 2);
+    ASSERT_TRUE(hdr.first_ts == 1699999000u);
+    ASSERT_TRUE(hdr.last_ts == 1700000040u);
+
+    uint8_t id;
+    int cols;
+    uint32_t rows;
+    int64_t v[TREND_SEG_MAX_COLS];
+    const uint8_t *text;
+
+    ASSERT_TRUE(trend_seg_next_section(&r, &id, &cols, &rows));
+    ASSERT_EQ_INT(id, TREND_SEG_ALARM);
+    ASSERT_EQ_INT(cols, 2);
+    ASSERT_EQ_INT((int)rows, 2);
+    ASSERT_TRUE(trend_seg_get_row(&r, v));
+    ASSERT_TRUE(v[0] == 1700000000);
+    ASSERT_EQ_INT((int)v[1], 3);
+    ASSERT_EQ_INT((int)trend_seg_get_bytes(&r, &text), 7);
+    ASSERT_TRUE(memcmp(text, "HR HIGH", 7) == 0);
+    ASSERT_TRUE(trend_seg_get_row(&r, v));
+    ASSERT_TRUE(v[0] == 1699999000);
+    ASSERT_EQ_INT((int)trend_seg_get_bytes(&r, &text), 0);
+    ASSERT_FALSE(r.error);
+    ASSERT_FALSE(trend_seg_get_row(&r, v));
+
+    int16_t out[5];
+    ASSERT_TRUE(trend_seg_next_section(&r, &id, &cols, &rows));
+    ASSERT_EQ_INT(id, TREND_SEG_RAW);
+    ASSERT_TRUE(trend_seg_get_row(&r, v));
+    ASSERT_TRUE(trend_seg_get_series(&r, out, 5));
+    for (int i = 0; i < 5; i++) ASSERT_EQ_INT(out[i], series[i]);
+
+    ASSERT_FALSE(trend_seg_next_section(&r, &id, &cols, &rows));
+    ASSERT_FALSE(r.error);
+}
+
+/* ── Test: steady series cost about a byte per value ─────── */
+
+static void test_delta_compact(void) {
+    printf("  test_delta_compact\n");
+    trend_seg_writer_t w;
+    trend_seg_writer_init(&w, seg, sizeof(seg));
+
+    trend_seg_begin_section(&w, TREND_SEG_1MIN, 13);
+    for (int m = 0; m < 100; m++) {
+        int64_t row[13];
+        row[0] = 1700000040 + m * 60;
+        for (int c = 1; c < 13; c++) row[c] = 70 + (m % 3);
+        trend_seg_put_row(&w, row);
+    }
+    size_t len = trend_seg_finish(&w, 1, 0, 0);
+    ASSERT_GT_INT((int)len, 0);
+    ASSERT_TRUE(len <= TREND_SEG_HEADER_BYTES + 10 + 100 * 13 + 16);
+}
+
+/* ── Test: unread rows and unknown sections are skipped ──── */
+
+static void test_skip_sections(void) {
+    printf("  test_skip_sections\n");
+    trend_seg_writer_t w;
+    trend_seg_writer_init(&w, seg, sizeof(seg));
+
+    trend_seg_begin_section(&w, 200, 3);    /* From a newer exporter */
+    int64_t junk[3] = { 1, 2, 3 };
+    trend_seg_put_row(&w, junk);
+    trend_seg_put_row(&w, junk);
+    trend_seg_begin_section(&w, TREND_SEG_NIBP, 4);
+    int64_t nibp[4] = { 1000, 120, 80, 93 };
+    trend_seg_put_row(&w, nibp);
+    size_t len = trend_seg_finish(&w, 1, 1000, 1000);
+
+    trend_seg_reader_t r;
+    uint8_t id;
+    int cols;
+    uint32_t rows;
+    int64_t v[TREND_SEG_MAX_COLS];
+    ASSERT_TRUE(trend_seg_reader_init(&r, seg, len, NULL));
+    ASSERT_TRUE(trend_seg_next_section(&r, &id, &cols, &rows));
+    ASSERT_EQ_INT(id, 200);
+    ASSERT_TRUE(trend_seg_next_section(&r, &id, &cols, &rows));
+    ASSERT_EQ_INT(id, TREND_SEG_NIBP);
+    ASSERT_TRUE(trend_seg_get_row(&r, v));
+    ASSERT_EQ_INT((int)v[1], 120);
+}
+
+/* ── Test: damaged segments are refused ──────────────────── */
+
+static void test_reject_invalid(void) {
+    printf("  test_reject_invalid\n");
+    trend_seg_writer_t w;
+    trend_seg_writer_init(&w, seg, sizeof(seg));
+    trend_seg_begin_section(&w, TREND_SEG_NIBP, 4);
+    int64_t nibp[4] = { 1000, 120, 80, 93 };
+    trend_seg_put_row(&w, nibp);
+    size_t len = trend_seg_finish(&w, 7, 1000, 1000);
+
+    trend_seg_reader_t r;
+    ASSERT_TRUE(trend_seg_reader_init(&r, seg, len, NULL));
+
+    /* Flipped payload bit */
+    seg[len - 1] ^= 0x01;
+    ASSERT_FALSE(trend_seg_reader_init(&r, seg, len, NULL));
+    seg[len - 1] ^= 0x01;
+
+    /* Truncated */
+    ASSERT_FALSE(trend_seg_reader_init(&r, seg, len - 1, NULL));
+    ASSERT_FALSE(trend_seg_reader_init(&r, seg, 10, NULL));
+
+    /* Newer format version */
+    seg[4] = TREND_SEG_VERSION + 1;
+    ASSERT_FALSE(trend_seg_reader_init(&r, seg, len, NULL));
+    seg[4] = TREND_SEG_VERSION;
+    ASSERT_TRUE(trend_seg_reader_init(&r, seg, len, NULL));
+
+    /* Writer reports a buffer that is too small */
+    uint8_t small[40];
+    trend_seg_writer_init(&w, small, sizeof(small));
+    trend_seg_begin_section(&w, TREND_SEG_NIBP, 4);
+    for (int i = 0; i < 10; i++) trend_seg_put_row(&w, nibp);
+    ASSERT_EQ_INT((int)trend_seg_finish(&w, 7, 0, 0), 0);
+}
+
+/* ── Public entry point ──────────────────────────────────── */
+
+void test_trend_segment(void) {
+    test_roundtrip();
+    test_delta_compact();
+    test_skip_sections();
+    test_reject_invalid();
+}
@@ -0,0 +1,198 @@
+/**
+ * @file test_ui_heap.c
+ * @brief Unit tests for ui_heap module
+ *
+ * Tests per-tag accounting and high-water marks, arena routing, wholesale
+ * release once a closed arena drains, spill when an arena is full, and a
+ * pinned arena outliving its screen.
+ */
+
+#include "test_framework.h"
+#include "ui_heap.h"
+#include <stdint.h>
+#include <string.h>
+
+/* ── Test fixtures ───────────────────────────────────────── */
+
+#define POOL_SIZE   (64 * 1024)
+
+static uint64_t pool_mem[POOL_SIZE / sizeof(uint64_t)];
+
+static int arenas_in_use(void) {
+    int n = 0;
+    ui_heap_arena_info_t info;
+    for (int i = 0; i < UI_HEAP_MAX_ARENAS; i++) {
+        if (ui_heap_get_arena(i, &info)) n++;
+    }
+    return n;
+}
+
+/* ── Test: tags ──────────────────────────────────────────── */
+
+static void test_tag_accounting(void) {
+    printf("  test_tag_accounting\n");
+    ASSERT_TRUE(ui_heap_init(pool_mem, POOL_SIZE));
+    ASSERT_EQ_INT(ui_heap_get_tag(), UI_HEAP_TAG_SHARED);
+
+    void *shared = ui_heap_alloc(100);
+    ui_heap_set_tag(2);
+    void *a = ui_heap_alloc(1000);
+    void *b = ui_heap_alloc(3000);
+
+    ui_heap_tag_stats_t s;
+    ASSERT_TRUE(ui_heap_get_tag_stats(2, &s));
+    ASSERT_EQ_INT(s.blocks, 2);
+    ASSERT_TRUE(s.bytes >= 4000);
+    size_t peak = s.bytes;
+
+    /* Frees are charged to the allocating tag, whatever is active now */
+    ui_heap_set_tag(3);
+    ui_heap_free(b);
+    ASSERT_TRUE(ui_heap_get_tag_stats(2, &s));
+    ASSERT_EQ_INT(s.blocks, 1);
+    ASSERT_TRUE(s.bytes < 2000);
+    ASSERT_EQ_INT((int)s.peak, (int)peak);
+
+    /* Realloc keeps the tag */
+    a = ui_heap_realloc(a, 5000);
+    ASSERT_NOT_NULL(a);
+    ASSERT_TRUE(ui_heap_get_tag_stats(2, &s));
+    ASSERT_EQ_INT(s.blocks, 1);
+    ASSERT_TRUE(s.bytes >= 5000);
+    ASSERT_TRUE(ui_heap_get_tag_stats(3, &s));
+    ASSERT_EQ_INT(s.blocks, 0);
+
+    ASSERT_TRUE(ui_heap_get_tag_stats(UI_HEAP_TAG_SHARED, &s));
+    ASSERT_EQ_INT(s.blocks, 1);
+    ASSERT_FALSE(ui_heap_get_tag_stats(UI_HEAP_MAX_TAGS, &s));
+
+    ui_heap_free(a);
+    ui_heap_free(shared);
+    ASSERT_TRUE(ui_heap_check());
+}
+
+/* ── Test: arena is released whole when drained ──────────── */
+
+static void test_arena_release(void) {
+    printf("  test_arena_release\n");
+    ASSERT_TRUE(ui_heap_init(pool_mem, POOL_SIZE));
+
+    ASSERT_TRUE(ui_heap_arena_open(1, 16 * 1024));
+    ASSERT_FALSE(ui_heap_arena_open(1, 1024));      /* Already open */
+    ui_heap_set_tag(1);
+
+    void *p[20];
+    for (int i = 0; i < 20; i++) p[i] = ui_heap_alloc(200);
+
+    ui_heap_arena_info_t info;
+    ASSERT_TRUE(ui_heap_get_arena(0, &info));
+    ASSERT_EQ_INT(info.tag, 1);
+    ASSERT_TRUE(info.open);
+    ASSERT_EQ_INT(info.blocks, 20);
+
+    /* Shared allocations stay outside */
+    ui_heap_set_tag(UI_HEAP_TAG_SHARED);
+    void *shared = ui_heap_alloc(200);
+    ASSERT_TRUE(ui_heap_get_arena(0, &info));
+    ASSERT_EQ_INT(info.blocks, 20);
+
+    /* Closed: stays until its last block goes */
+    ui_heap_arena_close(1);
+    ASSERT_TRUE(ui_heap_get_arena(0, &info));
+    ASSERT_FALSE(info.open);
+    for (int i = 0; i < 19; i++) ui_heap_free(p[i]);
+    ASSERT_EQ_INT(arenas_in_use(), 1);
+    ui_heap_free(p[19]);
+    ASSERT_EQ_INT(arenas_in_use(), 0);
+
+    ui_heap_stats_t st;
+    ui_heap_get_stats(&st);
+    ASSERT_EQ_INT(st.arenas_opened, 1);
+    ASSERT_EQ_INT(st.arenas_released, 1);
+    ASSERT_EQ_INT(st.pool.used_blocks, 1);          /* Only `shared` */
+
+    /* An empty arena goes at close */
+    ASSERT_TRUE(ui_heap_arena_open(4, 4096));
+    ui_heap_arena_close(4);
+    ASSERT_EQ_INT(arenas_in_use(), 0);
+
+    ui_heap_free(shared);
+    ASSERT_TRUE(ui_heap_check());
+}
+
+/* ── Test: full arena spills to the pool ─────────────────── */
+
+static void test_arena_spill(void) {
+    printf("  test_arena_spill\n");
+    ASSERT_TRUE(ui_heap_init(pool_mem, POOL_SIZE));
+    ASSERT_TRUE(ui_heap_arena_open(5, 2048));
+    ui_heap_set_tag(5);
+
+    void *p[8];
+    for (int i = 0; i < 8; i++) p[i] = ui_heap_alloc(500);
+    for (int i = 0; i < 8; i++) ASSERT_NOT_NULL(p[i]);
+
+    ui_heap_tag_stats_t s;
+    ASSERT_TRUE(ui_heap_get_tag_stats(5, &s));
+    ASSERT_EQ_INT(s.blocks, 8);
+    ASSERT_TRUE(s.spilled >= 4);
+
+    /* Growing past the arena moves the block out */
+    p[0] = ui_heap_realloc(p[0], 4000);
+    ASSERT_NOT_NULL(p[0]);
+    ASSERT_TRUE(ui_heap_get_tag_stats(5, &s));
+    ASSERT_EQ_INT(s.blocks, 8);
+
+    ui_heap_arena_close(5);
+    for (int i = 0; i < 8; i++) ui_heap_free(p[i]);
+    ASSERT_EQ_INT(arenas_in_use(), 0);
+    ASSERT_TRUE(ui_heap_get_tag_stats(5, &s));
+    ASSERT_EQ_INT((int)s.bytes, 0);
+    ASSERT_TRUE(ui_heap_check());
+}
+
+/* ── Test: pinned arena, slots and pool limits ───────────── */
+
+static void test_arena_pinned(void) {
+    printf("  test_arena_pinned\n");
+    ASSERT_TRUE(ui_heap_init(pool_mem, POOL_SIZE));
+
+    /* Screen 1 leaves a block behind; screen 2 transitions in */
+    ASSERT_TRUE(ui_heap_arena_open(1, 8192));
+    ui_heap_set_tag(1);
+    void *leak = ui_heap_alloc(64);
+    ui_heap_arena_close(1);
+    ASSERT_TRUE(ui_heap_arena_open(1, 8192));       /* Same screen again */
+    ASSERT_TRUE(ui_heap_arena_open(2, 8192));
+    ASSERT_EQ_INT(arenas_in_use(), 3);
+
+    /* No room in the pool: refused, the screen uses the pool */
+    ASSERT_FALSE(ui_heap_arena_open(3, POOL_SIZE));
+    ASSERT_TRUE(ui_heap_arena_open(3, 1024));
+    ASSERT_FALSE(ui_heap_arena_open(4, 1024));      /* No slot */
+
+    ui_heap_stats_t st;
+    ui_heap_get_stats(&st);
+    ASSERT_EQ_INT(st.arenas_failed, 2);
+
+    ui_heap_arena_close(1);
+    ui_heap_arena_close(2);
+    ui_heap_arena_close(3);
+    ASSERT_EQ_INT(arenas_in_use(), 1);              /* Pinned by `leak` */
+    ui_heap_free(leak);
+    ASSERT_EQ_INT(arenas_in_use(), 0);
+
+    ui_heap_get_stats(&st);
+    ASSERT_EQ_INT(st.pool.used_blocks, 0);
+    ASSERT_EQ_INT(st.pool.free_blocks, 1);
+    ASSERT_TRUE(ui_heap_check());
+}
+
+/* ── Suite entry point ───────────────────────────────────── */
+
+void test_ui_heap(void) {
+    test_tag_accounting();
+    test_arena_release();
+    test_arena_spill();
+    test_arena_pinned();
+}
@@ -0,0 +1,102 @@
+/**
+ * @file test_vclock.c
+ * @brief Unit tests for vclock module
+ *
+ * Tests the real source against the system clocks, virtual time that only
+ * moves when advanced, wall time derived from the start time, and the data
+ * thread falling back to inline mode under a virtual clock.
+ */
+
+#include "test_framework.h"
+#include "vclock.h"
+#include "data_thread.h"
+#include <time.h>
+#include <unistd.h>
+
+/* ── Test: real mode follows the system clocks ───────────── */
+
+static void test_real(void) {
+    printf("  test_real\n");
+    vclock_init(VCLOCK_REAL, 0);
+    ASSERT_FALSE(vclock_is_virtual());
+
+    int64_t wall = vclock_wall_s();
+    int64_t sys = (int64_t)time(NULL);
+    ASSERT_TRUE(wall >= sys - 1 && wall <= sys + 1);
+
+    uint64_t t0 = vclock_mono_us();
+    usleep(5000);
+    ASSERT_GE_INT((int)(vclock_mono_us() - t0), 5000);
+
+    /* Real time cannot be moved */
+    ASSERT_FALSE(vclock_advance_us(1000));
+}
+
+/* ── Test: virtual time stands still until advanced ──────── */
+
+static void test_virtual(void) {
+    printf("  test_virtual\n");
+    vclock_init(VCLOCK_VIRTUAL, 1767225600);
+    ASSERT_TRUE(vclock_is_virtual());
+    ASSERT_EQ_INT(vclock_get_mode(), VCLOCK_VIRTUAL);
+
+    uint64_t t0 = vclock_mono_us();
+    ASSERT_TRUE(vclock_wall_s() == 1767225600);
+    usleep(2000);
+    ASSERT_TRUE(vclock_mono_us() == t0);
+
+    ASSERT_TRUE(vclock_advance_us(1500));
+    ASSERT_TRUE(vclock_mono_us() == t0 + 1500);
+    ASSERT_TRUE(vclock_wall_ms() == 1767225600ULL * 1000 + 1);
+
+    /* An hour of sleep costs no real time */
+    uint64_t r0 = vclock_real_us();
+    for (int i = 0; i < 3600; i++) vclock_sleep_ms(1000);
+    ASSERT_TRUE(vclock_real_us() - r0 < 1000000);
+    ASSERT_TRUE(vclock_wall_s() == 1767225600 + 3600);
+    ASSERT_TRUE(vclock_mono_ms() == (uint32_t)((t0 + 1500 + 3600000000ULL) / 1000));
+
+    vclock_init(VCLOCK_REAL, 0);
+}
+
+/* ── Test: data tasks run inline on virtual time ─────────── */
+
+static int vtask_runs = 0;
+
+static void vtask(uint64_t due_us) {
+    (void)due_us;
+    vtask_runs++;
+}
+
+static void test_data_thread_virtual(void) {
+    printf("  test_data_thread_virtual\n");
+    vclock_init(VCLOCK_VIRTUAL, 1767225600);
+    vtask_runs = 0;
+
+    data_thread_add_task("v", 1000, vtask);
+    ASSERT_TRUE(data_thread_start(true));
+    ASSERT_EQ_INT(data_thread_poll(), 1000);
+
+    /* Ten virtual seconds, one per poll's requested sleep */
+    for (int i = 0; i < 10; i++) {
+        vclock_sleep_ms(data_thread_poll());
+    }
+    data_thread_poll();
+    ASSERT_EQ_INT(vtask_runs, 10);
+
+    data_task_stats_t st;
+    ASSERT_TRUE(data_thread_get_task_stats(0, &st));
+    ASSERT_EQ_INT(st.skipped, 0);
+    ASSERT_EQ_INT(st.max_late_us, 0);
+
+    data_thread_stop();
+    vclock_init(VCLOCK_REAL, 0);
+}
+
+/* ── Public entry point ──────────────────────────────────── */
+
+void test_vclock(void) {
+    test_real();
+    test_virtual();
+    test_data_thread_virtual();
+}